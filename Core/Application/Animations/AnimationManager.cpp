@@ -3,6 +3,7 @@
 #include "Animations.h"
 #include "AnimationsReader/AnimationsReader.h"
 #include "Application.h"
+#include "Profiler.h"
 
 OAnimationManager::OAnimationManager()
 {
@@ -26,6 +27,8 @@ void OAnimationManager::SaveAnimations()
 		animations.push_back(anim);
 	}
 	AnimationsReader->SaveAnimations(animations);
+	BuildTracks();
+	AnimationsReader->SaveTracks(Runtime.GetTracks());
 }
 
 void OAnimationManager::LoadAnimations()
@@ -36,4 +39,30 @@ void OAnimationManager::LoadAnimations()
 	{
 		Animations[anim->GetName()] = anim;
 	}
+
+	// Tracks are replaced by name, players on them keep running
+	for (auto& track : AnimationsReader->ReadTracks())
+	{
+		Runtime.AddTrack(std::move(track));
+	}
+	BuildTracks();
+}
+
+void OAnimationManager::Update(float DeltaTime, OTransformHierarchy& Hierarchy)
+{
+	PROFILE_SCOPE();
+	Runtime.Update(DeltaTime, Hierarchy);
+}
+
+OAnimationRuntime& OAnimationManager::GetRuntime()
+{
+	return Runtime;
+}
+
+void OAnimationManager::BuildTracks()
+{
+	for (const auto& [name, anim] : Animations)
+	{
+		Runtime.AddTrack(SAnimationTrack::Build(WStringToUTF8(name), anim->BuildKeys(), EAnimationCompression::Quantized));
+	}
 }
\ No newline at end of file
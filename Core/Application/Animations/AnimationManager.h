@@ -1,8 +1,10 @@
 #pragma once
+#include "AnimationRuntime.h"
 #include "Types.h"
 
 class OAnimation;
 class OAnimationsReader;
+class OTransformHierarchy;
 class OAnimationManager
 {
 public:
@@ -14,7 +16,15 @@ public:
 	void SaveAnimations();
 	void LoadAnimations();
 
+	/** @brief Samples the playing tracks into their transform nodes */
+	void Update(float DeltaTime, OTransformHierarchy& Hierarchy);
+	OAnimationRuntime& GetRuntime();
+
 private:
+	// Tracks of the JSON animations replace binary tracks with the same name
+	void BuildTracks();
+
 	unique_ptr<OAnimationsReader> AnimationsReader;
 	unordered_map<wstring, shared_ptr<OAnimation>> Animations;
+	OAnimationRuntime Runtime;
 };
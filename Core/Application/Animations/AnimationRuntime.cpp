@@ -0,0 +1,795 @@
+#include "AnimationRuntime.h"
+
+#include "SceneGraph/TransformHierarchy.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <istream>
+#include <ostream>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define ANIMATION_RUNTIME_SSE 1
+#include <emmintrin.h>
+#else
+#define ANIMATION_RUNTIME_SSE 0
+#endif
+
+namespace
+{
+using TClock = std::chrono::high_resolution_clock;
+
+constexpr float QuantizedRange = 65535.0f;
+
+// The three smallest components of a unit quaternion lie within +-1/sqrt(2), 15 bits each
+constexpr float SmallestThreeRange = 32767.0f;
+constexpr float SmallestThreeBound = 0.70710678f;
+
+// Guards Read against corrupt files
+constexpr uint32_t MaxStreamSize = 1u << 26;
+
+constexpr uint32_t ChannelComponents[SAnimationTrack::NumChannels] = { 3, 4, 3 };
+
+uint16_t Quantize(float Value, float Min, float Extent)
+{
+	if (Extent <= 0.0f)
+	{
+		return 0;
+	}
+	return static_cast<uint16_t>(std::lround(std::clamp((Value - Min) / Extent, 0.0f, 1.0f) * QuantizedRange));
+}
+
+float Dequantize(uint16_t Value, float Min, float Extent)
+{
+	return Min + static_cast<float>(Value) * (Extent / QuantizedRange);
+}
+
+void EncodeRotation(const float Rotation[4], uint16_t Out[3])
+{
+	uint32_t largest = 0;
+	for (uint32_t component = 1; component < 4; component++)
+	{
+		if (std::abs(Rotation[component]) > std::abs(Rotation[largest]))
+		{
+			largest = component;
+		}
+	}
+
+	// q and -q are the same rotation, the dropped component is restored as positive
+	const float sign = Rotation[largest] < 0.0f ? -1.0f : 1.0f;
+	uint32_t written = 0;
+	for (uint32_t component = 0; component < 4; component++)
+	{
+		if (component == largest)
+		{
+			continue;
+		}
+		const float normalized = std::clamp(Rotation[component] * sign / SmallestThreeBound, -1.0f, 1.0f) * 0.5f + 0.5f;
+		Out[written++] = static_cast<uint16_t>(std::lround(normalized * SmallestThreeRange));
+	}
+
+	// Index of the dropped component in the top bits of the first two values
+	Out[0] |= static_cast<uint16_t>((largest >> 1) << 15);
+	Out[1] |= static_cast<uint16_t>((largest & 1) << 15);
+}
+
+void DecodeRotation(const uint16_t In[3], float Out[4])
+{
+	const uint32_t largest = ((In[0] >> 15) << 1) | (In[1] >> 15);
+	float sum = 0.0f;
+	uint32_t read = 0;
+	for (uint32_t component = 0; component < 4; component++)
+	{
+		if (component == largest)
+		{
+			continue;
+		}
+		const float value = ((In[read++] & 0x7fff) / SmallestThreeRange * 2.0f - 1.0f) * SmallestThreeBound;
+		Out[component] = value;
+		sum += value * value;
+	}
+	Out[largest] = std::sqrt(std::max(1.0f - sum, 0.0f));
+}
+
+void NormalizeRotation(float Rotation[4])
+{
+	const float length = std::sqrt(Rotation[0] * Rotation[0] + Rotation[1] * Rotation[1] + Rotation[2] * Rotation[2] + Rotation[3] * Rotation[3]);
+	const float scale = length > 0.0f ? 1.0f / length : 0.0f;
+	for (uint32_t component = 0; component < 4; component++)
+	{
+		Rotation[component] *= scale;
+	}
+	if (length == 0.0f)
+	{
+		Rotation[3] = 1.0f;
+	}
+}
+
+const float* GetChannel(const SAnimationKey& Key, uint32_t Channel)
+{
+	return Channel == SAnimationTrack::PositionChannel ? Key.Position : Channel == SAnimationTrack::RotationChannel ? Key.Rotation : Key.Scale;
+}
+
+bool IsConstant(const std::vector<SAnimationKey>& Keys, uint32_t Channel, float Tolerance)
+{
+	const float* first = GetChannel(Keys[0], Channel);
+	for (const auto& key : Keys)
+	{
+		const float* values = GetChannel(key, Channel);
+		if (Channel == SAnimationTrack::RotationChannel)
+		{
+			const float dot = first[0] * values[0] + first[1] * values[1] + first[2] * values[2] + first[3] * values[3];
+			if (std::abs(dot) < 1.0f - Tolerance)
+			{
+				return false;
+			}
+			continue;
+		}
+		for (uint32_t component = 0; component < ChannelComponents[Channel]; component++)
+		{
+			if (std::abs(values[component] - first[component]) > Tolerance)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void QuantizeChannel(const std::vector<float>& Values, std::vector<uint16_t>& Out, float Min[3], float Extent[3])
+{
+	const size_t numKeys = Values.size() / 3;
+	for (uint32_t component = 0; component < 3; component++)
+	{
+		float low = Values[component];
+		float high = Values[component];
+		for (size_t key = 1; key < numKeys; key++)
+		{
+			low = std::min(low, Values[key * 3 + component]);
+			high = std::max(high, Values[key * 3 + component]);
+		}
+		Min[component] = low;
+		Extent[component] = high - low;
+	}
+
+	Out.resize(Values.size());
+	for (size_t key = 0; key < numKeys; key++)
+	{
+		for (uint32_t component = 0; component < 3; component++)
+		{
+			Out[key * 3 + component] = Quantize(Values[key * 3 + component], Min[component], Extent[component]);
+		}
+	}
+}
+
+// Decodes the channel key the time key maps to, writes 3 or 4 floats with a stride of Stride
+void DecodeChannel(const SAnimationTrack& Track, uint32_t Channel, uint32_t TimeKey, float* Out, uint32_t Stride)
+{
+	const uint32_t key = Track.NumChannelKeys[Channel] > 1 ? TimeKey : 0;
+	if (Track.Compression == EAnimationCompression::None)
+	{
+		const auto& stream = Channel == SAnimationTrack::PositionChannel ? Track.Positions : Channel == SAnimationTrack::RotationChannel ? Track.Rotations : Track.Scales;
+		const uint32_t components = ChannelComponents[Channel];
+		for (uint32_t component = 0; component < components; component++)
+		{
+			Out[component * Stride] = stream[key * components + component];
+		}
+		return;
+	}
+
+	if (Channel == SAnimationTrack::RotationChannel)
+	{
+		float rotation[4];
+		DecodeRotation(&Track.QuantizedRotations[key * 3], rotation);
+		for (uint32_t component = 0; component < 4; component++)
+		{
+			Out[component * Stride] = rotation[component];
+		}
+		return;
+	}
+
+	const bool bPosition = Channel == SAnimationTrack::PositionChannel;
+	const auto& stream = bPosition ? Track.QuantizedPositions : Track.QuantizedScales;
+	const float* min = bPosition ? Track.PositionMin : Track.ScaleMin;
+	const float* extent = bPosition ? Track.PositionExtent : Track.ScaleExtent;
+	for (uint32_t component = 0; component < 3; component++)
+	{
+		Out[component * Stride] = Dequantize(stream[key * 3 + component], min[component], extent[component]);
+	}
+}
+
+template<typename T>
+void WriteValue(std::ostream& Stream, const T& Value)
+{
+	Stream.write(reinterpret_cast<const char*>(&Value), sizeof(T));
+}
+
+template<typename T>
+bool ReadValue(std::istream& Stream, T& Value)
+{
+	return static_cast<bool>(Stream.read(reinterpret_cast<char*>(&Value), sizeof(T)));
+}
+
+template<typename T>
+void WriteStream(std::ostream& Stream, const std::vector<T>& Values)
+{
+	WriteValue(Stream, static_cast<uint32_t>(Values.size()));
+	Stream.write(reinterpret_cast<const char*>(Values.data()), static_cast<std::streamsize>(sizeof(T) * Values.size()));
+}
+
+template<typename T>
+bool ReadStream(std::istream& Stream, std::vector<T>& Values)
+{
+	uint32_t size = 0;
+	if (!ReadValue(Stream, size) || size > MaxStreamSize)
+	{
+		return false;
+	}
+	Values.resize(size);
+	return static_cast<bool>(Stream.read(reinterpret_cast<char*>(Values.data()), static_cast<std::streamsize>(sizeof(T) * size)));
+}
+
+#if ANIMATION_RUNTIME_SSE
+// Four players side by side, lets the SIMD and the scalar path share the blend below
+struct SLanes
+{
+	__m128 V;
+};
+
+SLanes operator+(SLanes A, SLanes B)
+{
+	return { _mm_add_ps(A.V, B.V) };
+}
+
+SLanes operator-(SLanes A, SLanes B)
+{
+	return { _mm_sub_ps(A.V, B.V) };
+}
+
+SLanes operator*(SLanes A, SLanes B)
+{
+	return { _mm_mul_ps(A.V, B.V) };
+}
+
+SLanes Load(SLanes, const float* Values)
+{
+	return { _mm_loadu_ps(Values) };
+}
+
+void Store(SLanes Value, float* Out)
+{
+	_mm_storeu_ps(Out, Value.V);
+}
+
+SLanes Splat(SLanes, float Value)
+{
+	return { _mm_set1_ps(Value) };
+}
+
+SLanes Abs(SLanes Value)
+{
+	return { _mm_andnot_ps(_mm_set1_ps(-0.0f), Value.V) };
+}
+
+SLanes NegateIfNegative(SLanes Value, SLanes Sign)
+{
+	const __m128 negative = _mm_cmplt_ps(Sign.V, _mm_setzero_ps());
+	return { _mm_xor_ps(Value.V, _mm_and_ps(negative, _mm_set1_ps(-0.0f))) };
+}
+
+SLanes InverseLength(SLanes SquaredLength)
+{
+	return { _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(SquaredLength.V)) };
+}
+
+constexpr uint32_t NumLanes = 4;
+#else
+float Load(float, const float* Values)
+{
+	return *Values;
+}
+
+void Store(float Value, float* Out)
+{
+	*Out = Value;
+}
+
+float Splat(float, float Value)
+{
+	return Value;
+}
+
+float Abs(float Value)
+{
+	return std::abs(Value);
+}
+
+float NegateIfNegative(float Value, float Sign)
+{
+	return Sign < 0.0f ? -Value : Value;
+}
+
+float InverseLength(float SquaredLength)
+{
+	return 1.0f / std::sqrt(SquaredLength);
+}
+
+constexpr uint32_t NumLanes = 1;
+#endif
+
+/*
+ * Linear position and scale, normalized linear rotation along the shorter arc. The rotation alpha is bent by a fitted
+ * polynomial of the key angle so the nlerp follows the constant angular speed of a slerp without its trigonometry.
+ * Keys hold 10 streams of four lanes: position, rotation, scale.
+ */
+template<typename T>
+void Blend(const float From[10][4], const float To[10][4], const float Alpha[4], float Out[10][4])
+{
+	for (uint32_t lane = 0; lane < 4; lane += NumLanes)
+	{
+		const T alpha = Load(T{}, &Alpha[lane]);
+		for (uint32_t stream : { 0u, 1u, 2u, 7u, 8u, 9u })
+		{
+			const T from = Load(T{}, &From[stream][lane]);
+			Store(from + (Load(T{}, &To[stream][lane]) - from) * alpha, &Out[stream][lane]);
+		}
+
+		T from[4];
+		T to[4];
+		for (uint32_t component = 0; component < 4; component++)
+		{
+			from[component] = Load(T{}, &From[3 + component][lane]);
+			to[component] = Load(T{}, &To[3 + component][lane]);
+		}
+		const T dot = from[0] * to[0] + from[1] * to[1] + from[2] * to[2] + from[3] * to[3];
+		const T cosine = Abs(dot);
+		const T half = alpha - Splat(T{}, 0.5f);
+		const T a = Splat(T{}, 1.0904f) + cosine * (Splat(T{}, -3.2452f) + cosine * (Splat(T{}, 3.55645f) - cosine * Splat(T{}, 1.43519f)));
+		const T b = Splat(T{}, 0.848013f) + cosine * (Splat(T{}, -1.06021f) + cosine * Splat(T{}, 0.215638f));
+		const T k = a * half * half + b;
+		const T bent = alpha + alpha * half * (alpha - Splat(T{}, 1.0f)) * k;
+
+		T rotation[4];
+		for (uint32_t component = 0; component < 4; component++)
+		{
+			rotation[component] = from[component] + (NegateIfNegative(to[component], dot) - from[component]) * bent;
+		}
+		const T scale = InverseLength(rotation[0] * rotation[0] + rotation[1] * rotation[1] + rotation[2] * rotation[2] + rotation[3] * rotation[3]);
+		for (uint32_t component = 0; component < 4; component++)
+		{
+			Store(rotation[component] * scale, &Out[3 + component][lane]);
+		}
+	}
+}
+
+#if ANIMATION_RUNTIME_SSE
+using TLanes = SLanes;
+#else
+using TLanes = float;
+#endif
+} // namespace
+
+SAnimationTrack SAnimationTrack::Build(const std::string& Name, const std::vector<SAnimationKey>& Keys, EAnimationCompression Compression, float Tolerance)
+{
+	SAnimationTrack track;
+	track.Name = Name;
+	track.Compression = Compression;
+
+	std::vector<SAnimationKey> keys = Keys.empty() ? std::vector<SAnimationKey>(1) : Keys;
+	for (size_t index = 0; index < keys.size(); index++)
+	{
+		NormalizeRotation(keys[index].Rotation);
+		track.Times.push_back(index > 0 ? std::max(keys[index].Time, track.Times.back()) : keys[index].Time);
+	}
+	track.Duration = track.Times.back();
+
+	std::vector<float> channels[NumChannels];
+	for (uint32_t channel = 0; channel < NumChannels; channel++)
+	{
+		const bool bConstant = IsConstant(keys, channel, Tolerance);
+		track.NumChannelKeys[channel] = bConstant ? 1 : static_cast<uint32_t>(keys.size());
+		for (uint32_t key = 0; key < track.NumChannelKeys[channel]; key++)
+		{
+			const float* values = GetChannel(keys[key], channel);
+			channels[channel].insert(channels[channel].end(), values, values + ChannelComponents[channel]);
+		}
+	}
+
+	if (Compression == EAnimationCompression::None)
+	{
+		track.Positions = std::move(channels[PositionChannel]);
+		track.Rotations = std::move(channels[RotationChannel]);
+		track.Scales = std::move(channels[ScaleChannel]);
+		return track;
+	}
+
+	QuantizeChannel(channels[PositionChannel], track.QuantizedPositions, track.PositionMin, track.PositionExtent);
+	QuantizeChannel(channels[ScaleChannel], track.QuantizedScales, track.ScaleMin, track.ScaleExtent);
+	track.QuantizedRotations.resize(track.NumChannelKeys[RotationChannel] * 3);
+	for (uint32_t key = 0; key < track.NumChannelKeys[RotationChannel]; key++)
+	{
+		EncodeRotation(&channels[RotationChannel][key * 4], &track.QuantizedRotations[key * 3]);
+	}
+	return track;
+}
+
+SAnimationKey SAnimationTrack::GetKey(uint32_t Index) const
+{
+	SAnimationKey key;
+	if (Index >= Times.size())
+	{
+		return key;
+	}
+	key.Time = Times[Index];
+	DecodeChannel(*this, PositionChannel, Index, key.Position, 1);
+	DecodeChannel(*this, RotationChannel, Index, key.Rotation, 1);
+	DecodeChannel(*this, ScaleChannel, Index, key.Scale, 1);
+	return key;
+}
+
+uint32_t SAnimationTrack::GetNumKeys() const
+{
+	return static_cast<uint32_t>(Times.size());
+}
+
+size_t SAnimationTrack::GetSizeInBytes() const
+{
+	return sizeof(float) * (Times.size() + Positions.size() + Rotations.size() + Scales.size())
+	       + sizeof(uint16_t) * (QuantizedPositions.size() + QuantizedRotations.size() + QuantizedScales.size());
+}
+
+void SAnimationTrack::Write(std::ostream& Stream) const
+{
+	WriteValue(Stream, static_cast<uint32_t>(Name.size()));
+	Stream.write(Name.data(), static_cast<std::streamsize>(Name.size()));
+	WriteValue(Stream, Compression);
+	WriteValue(Stream, Duration);
+	WriteValue(Stream, NumChannelKeys);
+	WriteStream(Stream, Times);
+	if (Compression == EAnimationCompression::None)
+	{
+		WriteStream(Stream, Positions);
+		WriteStream(Stream, Rotations);
+		WriteStream(Stream, Scales);
+		return;
+	}
+	WriteValue(Stream, PositionMin);
+	WriteValue(Stream, PositionExtent);
+	WriteValue(Stream, ScaleMin);
+	WriteValue(Stream, ScaleExtent);
+	WriteStream(Stream, QuantizedPositions);
+	WriteStream(Stream, QuantizedRotations);
+	WriteStream(Stream, QuantizedScales);
+}
+
+bool SAnimationTrack::Read(std::istream& Stream)
+{
+	*this = SAnimationTrack();
+	uint32_t nameSize = 0;
+	if (!ReadValue(Stream, nameSize) || nameSize > MaxStreamSize)
+	{
+		return false;
+	}
+	Name.resize(nameSize);
+	if (!Stream.read(Name.data(), nameSize) || !ReadValue(Stream, Compression) || !ReadValue(Stream, Duration) || !ReadValue(Stream, NumChannelKeys) || !ReadStream(Stream, Times))
+	{
+		return false;
+	}
+
+	bool bRead = false;
+	if (Compression == EAnimationCompression::None)
+	{
+		bRead = ReadStream(Stream, Positions) && ReadStream(Stream, Rotations) && ReadStream(Stream, Scales);
+	}
+	else if (Compression == EAnimationCompression::Quantized)
+	{
+		bRead = ReadValue(Stream, PositionMin) && ReadValue(Stream, PositionExtent) && ReadValue(Stream, ScaleMin) && ReadValue(Stream, ScaleExtent)
+		        && ReadStream(Stream, QuantizedPositions) && ReadStream(Stream, QuantizedRotations) && ReadStream(Stream, QuantizedScales);
+	}
+	if (!bRead || Times.empty() || !std::is_sorted(Times.begin(), Times.end()))
+	{
+		return false;
+	}
+
+	// Sampling indexes the streams without checks
+	const bool bQuantized = Compression == EAnimationCompression::Quantized;
+	const size_t sizes[NumChannels] = {
+		bQuantized ? QuantizedPositions.size() : Positions.size(),
+		bQuantized ? QuantizedRotations.size() : Rotations.size(),
+		bQuantized ? QuantizedScales.size() : Scales.size()
+	};
+	for (uint32_t channel = 0; channel < NumChannels; channel++)
+	{
+		const uint32_t numKeys = NumChannelKeys[channel];
+		const uint32_t components = bQuantized ? 3 : ChannelComponents[channel];
+		if ((numKeys != 1 && numKeys != Times.size()) || sizes[channel] != static_cast<size_t>(numKeys) * components)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+uint32_t OAnimationRuntime::AddTrack(SAnimationTrack&& Track)
+{
+	const auto found = TrackNames.find(Track.Name);
+	if (found != TrackNames.end())
+	{
+		Tracks[found->second] = std::move(Track);
+
+		// The key count may have changed
+		for (size_t player = 0; player < PlayerTracks.size(); player++)
+		{
+			if (PlayerTracks[player] == found->second)
+			{
+				PlayerCursors[player] = 0;
+				PlayerFlags[player] &= ~KeysCached;
+			}
+		}
+		return found->second;
+	}
+
+	const auto index = static_cast<uint32_t>(Tracks.size());
+	TrackNames[Track.Name] = index;
+	Tracks.push_back(std::move(Track));
+	return index;
+}
+
+uint32_t OAnimationRuntime::FindTrack(const std::string& Name) const
+{
+	const auto found = TrackNames.find(Name);
+	return found != TrackNames.end() ? found->second : InvalidTrack;
+}
+
+const SAnimationTrack& OAnimationRuntime::GetTrack(uint32_t Track) const
+{
+	return Tracks[Track];
+}
+
+const std::vector<SAnimationTrack>& OAnimationRuntime::GetTracks() const
+{
+	return Tracks;
+}
+
+void OAnimationRuntime::ClearTracks()
+{
+	StopAll();
+	Tracks.clear();
+	TrackNames.clear();
+}
+
+void OAnimationRuntime::Play(uint32_t Track, uint32_t Node, bool bLoop, float Speed, float StartTime)
+{
+	if (Track >= Tracks.size() || Node == OTransformHierarchy::InvalidNode)
+	{
+		return;
+	}
+
+	uint32_t player;
+	const auto found = NodeToPlayer.find(Node);
+	if (found != NodeToPlayer.end())
+	{
+		player = found->second;
+	}
+	else
+	{
+		player = static_cast<uint32_t>(PlayerNodes.size());
+		NodeToPlayer[Node] = player;
+		PlayerTracks.push_back(0);
+		PlayerNodes.push_back(Node);
+		PlayerCursors.push_back(0);
+		PlayerTimes.push_back(0.0f);
+		PlayerSpeeds.push_back(0.0f);
+		PlayerFlags.push_back(0);
+		PlayerKeys.resize(PlayerKeys.size() + KeyFloats * 2);
+	}
+
+	PlayerTracks[player] = Track;
+	PlayerCursors[player] = 0;
+	PlayerTimes[player] = std::clamp(StartTime, 0.0f, Tracks[Track].Duration);
+	PlayerSpeeds[player] = Speed;
+	PlayerFlags[player] = bLoop ? Loop : 0;
+}
+
+void OAnimationRuntime::Stop(uint32_t Node)
+{
+	const auto found = NodeToPlayer.find(Node);
+	if (found != NodeToPlayer.end())
+	{
+		RemovePlayer(found->second);
+	}
+}
+
+void OAnimationRuntime::StopAll()
+{
+	for (auto* stream : { &PlayerTracks, &PlayerNodes, &PlayerCursors })
+	{
+		stream->clear();
+	}
+	PlayerTimes.clear();
+	PlayerSpeeds.clear();
+	PlayerFlags.clear();
+	PlayerKeys.clear();
+	NodeToPlayer.clear();
+}
+
+bool OAnimationRuntime::IsPlaying(uint32_t Node) const
+{
+	return NodeToPlayer.contains(Node);
+}
+
+void OAnimationRuntime::Update(float DeltaTime, OTransformHierarchy& Hierarchy)
+{
+	const auto start = TClock::now();
+	const auto numPlayers = static_cast<uint32_t>(PlayerNodes.size());
+	const uint32_t maxThreads = NumThreads > 0 ? NumThreads : std::max(std::thread::hardware_concurrency(), 1u);
+	const uint32_t numThreads = std::clamp(numPlayers / std::max(MinPlayersPerThread, 1u), 1u, maxThreads);
+
+	// Players only touch their own node, whole groups of four per thread
+	const uint32_t playersPerThread = ((numPlayers + numThreads - 1) / numThreads + 3) & ~3u;
+	std::vector<std::future<uint32_t>> futures;
+	for (uint32_t thread = 1; thread < numThreads; thread++)
+	{
+		const uint32_t rangeFirst = thread * playersPerThread;
+		const uint32_t rangeLast = std::min(rangeFirst + playersPerThread, numPlayers);
+		if (rangeFirst < rangeLast)
+		{
+			futures.push_back(std::async(std::launch::async, [this, rangeFirst, rangeLast, DeltaTime, &Hierarchy]() {
+				uint32_t numFinished = 0;
+				for (uint32_t player = rangeFirst; player < rangeLast; player += 4)
+				{
+					numFinished += UpdateGroup(player, std::min(player + 4, rangeLast), DeltaTime, Hierarchy);
+				}
+				return numFinished;
+			}));
+		}
+	}
+
+	Stats.NumFinished = 0;
+	const uint32_t localLast = std::min(playersPerThread, numPlayers);
+	for (uint32_t player = 0; player < localLast; player += 4)
+	{
+		Stats.NumFinished += UpdateGroup(player, std::min(player + 4, localLast), DeltaTime, Hierarchy);
+	}
+	for (auto& future : futures)
+	{
+		Stats.NumFinished += future.get();
+	}
+
+	// The finished players wrote their last key, they are no longer needed
+	if (Stats.NumFinished > 0)
+	{
+		for (uint32_t player = numPlayers; player-- > 0;)
+		{
+			if (PlayerFlags[player] & Finished)
+			{
+				RemovePlayer(player);
+			}
+		}
+	}
+
+	Stats.NumPlayers = numPlayers;
+	Stats.NumThreads = numThreads;
+	Stats.Milliseconds = std::chrono::duration<float, std::milli>(TClock::now() - start).count();
+}
+
+size_t OAnimationRuntime::GetNumPlayers() const
+{
+	return PlayerNodes.size();
+}
+
+const SAnimationStats& OAnimationRuntime::GetStats() const
+{
+	return Stats;
+}
+
+uint32_t OAnimationRuntime::UpdateGroup(uint32_t First, uint32_t Last, float DeltaTime, OTransformHierarchy& Hierarchy)
+{
+	// Unused lanes repeat the last player and are not written back
+	float from[KeyFloats][4];
+	float to[KeyFloats][4];
+	float alpha[4] = {};
+	uint32_t numFinished = 0;
+	for (uint32_t lane = 0; lane < 4; lane++)
+	{
+		const uint32_t player = First + std::min(lane, Last - First - 1);
+		const auto& track = Tracks[PlayerTracks[player]];
+		float time = PlayerTimes[player];
+		if (lane < Last - First)
+		{
+			const float speed = PlayerSpeeds[player];
+			time += DeltaTime * speed;
+			if ((speed > 0.0f && time >= track.Duration) || (speed < 0.0f && time <= 0.0f))
+			{
+				if ((PlayerFlags[player] & Loop) && track.Duration > 0.0f)
+				{
+					time = std::fmod(time, track.Duration);
+					time = time < 0.0f ? time + track.Duration : time;
+				}
+				else
+				{
+					time = std::clamp(time, 0.0f, track.Duration);
+					PlayerFlags[player] |= Finished;
+					numFinished++;
+				}
+			}
+			PlayerTimes[player] = time;
+		}
+
+		// Players mostly move forward a key at a time, the cursor starts over after a wrap
+		const auto numKeys = static_cast<uint32_t>(track.Times.size());
+		const uint32_t cursor = PlayerCursors[player];
+		uint32_t key = cursor < numKeys && track.Times[cursor] <= time ? cursor : 0;
+		while (key + 1 < numKeys && track.Times[key + 1] <= time)
+		{
+			key++;
+		}
+		PlayerCursors[player] = key;
+
+		// Both keys stay decoded until the player moves past them
+		const uint32_t next = std::min(key + 1, numKeys - 1);
+		float* keys = &PlayerKeys[static_cast<size_t>(player) * KeyFloats * 2];
+		if (key != cursor || !(PlayerFlags[player] & KeysCached))
+		{
+			for (uint32_t channel = 0, stream = 0; channel < SAnimationTrack::NumChannels; stream += ChannelComponents[channel], channel++)
+			{
+				DecodeChannel(track, channel, key, &keys[stream], 1);
+				DecodeChannel(track, channel, next, &keys[KeyFloats + stream], 1);
+			}
+			PlayerFlags[player] |= KeysCached;
+		}
+		for (uint32_t stream = 0; stream < KeyFloats; stream++)
+		{
+			from[stream][lane] = keys[stream];
+			to[stream][lane] = keys[KeyFloats + stream];
+		}
+
+		const float span = track.Times[next] - track.Times[key];
+		alpha[lane] = span > 0.0f ? std::clamp((time - track.Times[key]) / span, 0.0f, 1.0f) : 0.0f;
+	}
+
+	float sampled[KeyFloats][4];
+	Blend<TLanes>(from, to, alpha, sampled);
+
+	for (uint32_t lane = 0; lane < Last - First; lane++)
+	{
+		SLocalTransform local;
+		for (uint32_t component = 0; component < 3; component++)
+		{
+			local.Position[component] = sampled[component][lane];
+			local.Scale[component] = sampled[7 + component][lane];
+		}
+		for (uint32_t component = 0; component < 4; component++)
+		{
+			local.Rotation[component] = sampled[3 + component][lane];
+		}
+		Hierarchy.SetLocal(PlayerNodes[First + lane], local);
+	}
+	return numFinished;
+}
+
+void OAnimationRuntime::RemovePlayer(uint32_t Player)
+{
+	NodeToPlayer.erase(PlayerNodes[Player]);
+	const auto last = static_cast<uint32_t>(PlayerNodes.size() - 1);
+	if (Player != last)
+	{
+		PlayerTracks[Player] = PlayerTracks[last];
+		PlayerNodes[Player] = PlayerNodes[last];
+		PlayerCursors[Player] = PlayerCursors[last];
+		PlayerTimes[Player] = PlayerTimes[last];
+		PlayerSpeeds[Player] = PlayerSpeeds[last];
+		PlayerFlags[Player] = PlayerFlags[last];
+		std::copy_n(&PlayerKeys[static_cast<size_t>(last) * KeyFloats * 2], KeyFloats * 2, &PlayerKeys[static_cast<size_t>(Player) * KeyFloats * 2]);
+		NodeToPlayer[PlayerNodes[Player]] = Player;
+	}
+	PlayerTracks.pop_back();
+	PlayerNodes.pop_back();
+	PlayerCursors.pop_back();
+	PlayerTimes.pop_back();
+	PlayerSpeeds.pop_back();
+	PlayerFlags.pop_back();
+	PlayerKeys.resize(PlayerKeys.size() - KeyFloats * 2);
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Keyframe tracks stored as structure of arrays and the players that drive transform hierarchy nodes with them.
+ * A track is a list of keys sharing one time stream, channels that never change keep a single key.
+ * Quantized tracks store positions and scales as 16 bit values inside the channel bounds and rotations as the smallest three
+ * quaternion components, 6 bytes per channel and key instead of 12 or 16.
+ * Update samples every player four at a time and splits large batches between threads. No D3D dependencies.
+ */
+
+class OTransformHierarchy;
+
+struct SAnimationKey
+{
+	float Time = 0.0f;
+	float Position[3] = { 0.0f, 0.0f, 0.0f };
+
+	// Quaternion
+	float Rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	float Scale[3] = { 1.0f, 1.0f, 1.0f };
+};
+
+enum class EAnimationCompression : uint8_t
+{
+	None,
+	Quantized
+};
+
+struct SAnimationTrack
+{
+	enum EChannel : uint8_t
+	{
+		PositionChannel,
+		RotationChannel,
+		ScaleChannel,
+		NumChannels
+	};
+
+	/** @brief Keys have to be sorted by time, channels are collapsed to one key when they stay within Tolerance */
+	static SAnimationTrack Build(const std::string& Name, const std::vector<SAnimationKey>& Keys, EAnimationCompression Compression, float Tolerance = 1.0e-5f);
+
+	/** @brief Key at the given index, constant channels return their only key */
+	SAnimationKey GetKey(uint32_t Index) const;
+
+	uint32_t GetNumKeys() const;
+	size_t GetSizeInBytes() const;
+
+	void Write(std::ostream& Stream) const;
+	bool Read(std::istream& Stream);
+
+	std::string Name;
+	EAnimationCompression Compression = EAnimationCompression::None;
+	float Duration = 0.0f;
+	std::vector<float> Times;
+
+	// One key per channel when constant, otherwise one per time
+	uint32_t NumChannelKeys[NumChannels] = {};
+
+	// Uncompressed, position xyz, rotation xyzw and scale xyz per key
+	std::vector<float> Positions;
+	std::vector<float> Rotations;
+	std::vector<float> Scales;
+
+	// Quantized, three values per key
+	std::vector<uint16_t> QuantizedPositions;
+	std::vector<uint16_t> QuantizedRotations;
+	std::vector<uint16_t> QuantizedScales;
+	float PositionMin[3] = {};
+	float PositionExtent[3] = {};
+	float ScaleMin[3] = {};
+	float ScaleExtent[3] = {};
+};
+
+struct SAnimationStats
+{
+	uint32_t NumPlayers = 0;
+	uint32_t NumFinished = 0;
+	uint32_t NumThreads = 0;
+	float Milliseconds = 0.0f;
+};
+
+class OAnimationRuntime
+{
+public:
+	static constexpr uint32_t InvalidTrack = UINT32_MAX;
+
+	/** @brief A track with the same name is replaced, players keep using it */
+	uint32_t AddTrack(SAnimationTrack&& Track);
+	uint32_t FindTrack(const std::string& Name) const;
+	const SAnimationTrack& GetTrack(uint32_t Track) const;
+	const std::vector<SAnimationTrack>& GetTracks() const;
+
+	/** @brief Stops every player */
+	void ClearTracks();
+
+	/** @brief A node is driven by one player at most, playing on an animated node restarts it with the new track */
+	void Play(uint32_t Track, uint32_t Node, bool bLoop = true, float Speed = 1.0f, float StartTime = 0.0f);
+	void Stop(uint32_t Node);
+	void StopAll();
+	bool IsPlaying(uint32_t Node) const;
+
+	/** @brief Advances the players and writes the sampled local transforms into their nodes, finished players are removed */
+	void Update(float DeltaTime, OTransformHierarchy& Hierarchy);
+
+	size_t GetNumPlayers() const;
+	const SAnimationStats& GetStats() const;
+
+	// 0 - use all hardware threads
+	uint32_t NumThreads = 0;
+
+	// Player count under which the batch stays on the calling thread
+	uint32_t MinPlayersPerThread = 2048;
+
+private:
+	enum EFlags : uint8_t
+	{
+		Loop = 1 << 0,
+		Finished = 1 << 1,
+		KeysCached = 1 << 2
+	};
+
+	// Position, rotation and scale of a decoded key
+	static constexpr uint32_t KeyFloats = 10;
+
+	// Up to four players, returns how many of them finished
+	uint32_t UpdateGroup(uint32_t First, uint32_t Last, float DeltaTime, OTransformHierarchy& Hierarchy);
+	void RemovePlayer(uint32_t Player);
+
+	std::vector<SAnimationTrack> Tracks;
+	std::unordered_map<std::string, uint32_t> TrackNames;
+
+	// Indexed by player
+	std::vector<uint32_t> PlayerTracks;
+	std::vector<uint32_t> PlayerNodes;
+	std::vector<uint32_t> PlayerCursors;
+	std::vector<float> PlayerTimes;
+	std::vector<float> PlayerSpeeds;
+	std::vector<uint8_t> PlayerFlags;
+
+	// The two keys around the player time, KeyFloats each
+	std::vector<float> PlayerKeys;
+
+	std::unordered_map<uint32_t, uint32_t> NodeToPlayer;
+	SAnimationStats Stats;
+};
@@ -1,36 +1,27 @@
 
 #include "Animations.h"
 
-#include "Engine/Engine.h"
-#include "Logger.h"
 #include "MathUtils.h"
 
 STransform OAnimation::PerfomAnimation(const float DeltaTime)
 {
 	using namespace Utils::Math;
-	const auto currentAnimPos = Frames[CurrentIndex].Transform.Position;
-	const auto currentAnimRot = DegreesToRadians(Frames[CurrentIndex].Transform.Rotation);
-	const auto currentAnimScale = Frames[CurrentIndex].Transform.Scale;
-
-	const auto startAnimPos = StartTransform.Position;
-	const auto startAnimRot = StartTransform.Rotation;
-	const auto startAnimScale = StartTransform.Scale;
-	const auto duration = Frames[CurrentIndex].Duration;
-
+	if (FrameRotations.size() != Frames.size())
+	{
+		// Frames were edited while playing
+		CacheFrameRotations();
+	}
+	const auto& frame = Frames[CurrentIndex];
 	ElapsedTime += DeltaTime;
-	bool hasTimedOut = ElapsedTime >= duration;
-	float interpolationFactor = hasTimedOut ? 1 : (ElapsedTime / duration);
-
-	const auto newRot = XMQuaternionSlerp(startAnimRot,
-	                                      XMQuaternionRotationRollPitchYawFromVector(currentAnimRot),
-	                                      interpolationFactor);
+	const bool hasTimedOut = ElapsedTime >= frame.Duration;
+	const float interpolationFactor = hasTimedOut ? 1 : (ElapsedTime / frame.Duration);
 
-	const auto newPos = XMVectorLerp(startAnimPos, currentAnimPos, interpolationFactor);
-	const auto newScale = XMVectorLerp(startAnimScale, currentAnimScale, interpolationFactor);
+	const auto newRot = XMQuaternionSlerp(StartTransform.Rotation, FrameRotations[CurrentIndex], interpolationFactor);
+	const auto newPos = XMVectorLerp(StartTransform.Position, frame.Transform.Position, interpolationFactor);
+	const auto newScale = XMVectorLerp(StartTransform.Scale, frame.Transform.Scale, interpolationFactor);
 	if (hasTimedOut)
 	{
-		StartTransform = Frames[CurrentIndex].Transform;
-		StartTransform.Rotation = newRot;
+		StartTransform = STransform(newPos, newRot, newScale);
 		CurrentIndex++;
 		ElapsedTime = 0.0f;
 	}
@@ -44,11 +35,33 @@ STransform OAnimation::PerfomAnimation(const float DeltaTime)
 	auto float3Scale = XMFLOAT3();
 	Put(float3Scale, newScale);
 
-	OEngine::Get()->DrawDebugBox(float3Pos, { 100, 100, 100 }, { 1, 0, 0, 1 }, SColor::Red, 5);
-
 	return STransform{ float3Pos, float4Rot, float3Scale };
 }
 
+vector<SAnimationKey> OAnimation::BuildKeys() const
+{
+	using namespace Utils::Math;
+	vector<SAnimationKey> keys;
+	keys.reserve(Frames.size());
+	float time = 0.0f;
+	for (const auto& frame : Frames)
+	{
+		SAnimationKey key;
+		time += keys.empty() ? 0.0f : std::max(frame.Duration, 0.0f);
+		key.Time = time;
+
+		XMFLOAT4 rotation;
+		XMStoreFloat4(&rotation, XMQuaternionRotationRollPitchYawFromVector(DegreesToRadians(frame.Transform.Rotation)));
+		const auto position = frame.Transform.GetFloat3Position();
+		const auto scale = frame.Transform.GetFloat3Scale();
+		std::memcpy(key.Position, &position, sizeof(key.Position));
+		std::memcpy(key.Rotation, &rotation, sizeof(key.Rotation));
+		std::memcpy(key.Scale, &scale, sizeof(key.Scale));
+		keys.push_back(key);
+	}
+	return keys;
+}
+
 bool OAnimation::IsFinished() const
 {
 	return CurrentIndex == Frames.size();
@@ -82,6 +95,7 @@ vector<SAnimationFrame>& OAnimation::GetFrames()
 void OAnimation::StartAnimation(const STransform& InCurrentTransform)
 {
 	StartTransform = InCurrentTransform;
+	CacheFrameRotations();
 	bIsPlaying = true;
 	CurrentIndex = 0;
 	ElapsedTime = 0.0f;
@@ -102,4 +116,16 @@ void OAnimation::PauseAnimation()
 bool OAnimation::IsPlaying() const
 {
 	return bIsPlaying;
+}
+
+void OAnimation::CacheFrameRotations()
+{
+	using namespace Utils::Math;
+
+	// The frames keep Euler degrees for editing, they are converted once per playback instead of every tick
+	FrameRotations.clear();
+	for (const auto& frame : Frames)
+	{
+		FrameRotations.push_back(XMQuaternionRotationRollPitchYawFromVector(DegreesToRadians(frame.Transform.Rotation)));
+	}
 }
\ No newline at end of file
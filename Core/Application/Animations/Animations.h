@@ -1,4 +1,5 @@
 #pragma once
+#include "AnimationRuntime.h"
 #include "Transform.h"
 #include "Types.h"
 
@@ -31,11 +32,19 @@ public:
 	void PauseAnimation();
 	bool IsPlaying() const;
 
+	/** @brief Keys for the animation runtime, frame rotations are Euler degrees and every frame is reached after its duration */
+	vector<SAnimationKey> BuildKeys() const;
+
 private:
+	void CacheFrameRotations();
+
 	STransform StartTransform;
 	bool bIsPlaying = false;
 	wstring Name;
 	vector<SAnimationFrame> Frames;
+
+	// Frame rotations as quaternions, built when the animation starts
+	vector<DirectX::XMVECTOR> FrameRotations;
 	uint32_t CurrentIndex = 0;
 	float ElapsedTime = 0.0f;
 };
@@ -81,6 +81,7 @@ inline int OApplication::Run()
 		}
 		else
 		{
+			Timer.SetFixedDeltaTime(Engine->GetSessionReplay()->GetFixedDeltaTime());
 			Timer.Tick();
 			CalculateFrameStats();
 			if (bIsAppPaused)
@@ -91,6 +91,15 @@ void OCamera::LookAt(const DirectX::XMFLOAT3& Pos, const DirectX::XMFLOAT3& Targ
 	bViewDirty = true;
 }
 
+void OCamera::SetBasis(const DirectX::XMFLOAT3& Pos, const DirectX::XMFLOAT3& Look, const DirectX::XMFLOAT3& InRight, const DirectX::XMFLOAT3& InUp)
+{
+	Position = Pos;
+	Target = Look;
+	Right = InRight;
+	Up = InUp;
+	bViewDirty = true;
+}
+
 DirectX::XMFLOAT4X4 OCamera::GetView4x4f() const
 {
 	return ViewMatrix;
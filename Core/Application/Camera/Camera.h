@@ -54,6 +54,9 @@ public:
 	void LookAt(DirectX::FXMVECTOR Pos, DirectX::FXMVECTOR Target, DirectX::FXMVECTOR Up);
 	void LookAt(const DirectX::XMFLOAT3& Pos, const DirectX::XMFLOAT3& Target, const DirectX::XMFLOAT3& Up);
 
+	// Position and basis as they were read from another camera, used by session replays
+	void SetBasis(const DirectX::XMFLOAT3& Pos, const DirectX::XMFLOAT3& Look, const DirectX::XMFLOAT3& InRight, const DirectX::XMFLOAT3& InUp);
+
 	DirectX::XMFLOAT4X4 GetView4x4f() const;
 	DirectX::XMMATRIX GetView() const;
 
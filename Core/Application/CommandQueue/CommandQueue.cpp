@@ -56,6 +56,7 @@ uint64_t OCommandQueue::ExecuteCommandList()
 
 	CommandQueue->ExecuteCommandLists(1, commandLists);
 	uint64_t fenceValue = Signal();
+	OnCommandListExecuted.Broadcast(fenceValue);
 	return fenceValue;
 }
 
@@ -99,6 +100,11 @@ void OCommandQueue::WaitForFenceValue(uint64_t FenceValue)
 	}
 }
 
+void OCommandQueue::WaitForQueue(const OCommandQueue* Other, uint64_t FenceValue) const
+{
+	THROW_IF_FAILED(CommandQueue->Wait(Other->Fence.Get(), FenceValue));
+}
+
 /*
  * This function is a combination of the previous two, signaling a fence and then waiting for its completion.
  * Purpose: Used to ensure that all previously submitted commands on a command queue are completed before the CPU proceeds.
@@ -309,13 +315,21 @@ void OCommandQueue::SetRenderToDSVOnly(const SDescriptorPair& DSV) const
 
 void OCommandQueue::ResetQueueState()
 {
-	CurrentRenderTarget->UnsetRenderTarget(this);
-	CurrentRenderTarget = nullptr;
+	UnsetRenderTarget();
 	CurrentPSO = nullptr;
 	SetResources.clear();
 	CurrentObjectHeap = nullptr;
 }
 
+void OCommandQueue::UnsetRenderTarget()
+{
+	if (CurrentRenderTarget)
+	{
+		CurrentRenderTarget->UnsetRenderTarget(this);
+	}
+	CurrentRenderTarget = nullptr;
+}
+
 void OCommandQueue::SetViewportScissors(const D3D12_VIEWPORT& Viewport, const D3D12_RECT& Scissors) const
 {
 	CommandList->RSSetViewports(1, &Viewport);
@@ -1,5 +1,6 @@
 #pragma once
 #include "Color.h"
+#include "Delegate.h"
 #include "DirectX/DXHelper.h"
 #include "Engine/RenderTarget/RenderTarget.h"
 #include "Types.h"
@@ -22,9 +23,15 @@ public:
 	uint64_t Signal();
 
 	void WaitForFenceValue(uint64_t FenceValue);
+
+	/** @brief The GPU holds back the work submitted to this queue afterwards until the fence of Other reaches FenceValue */
+	void WaitForQueue(const OCommandQueue* Other, uint64_t FenceValue) const;
 	void Flush();
 	void TryResetCommandList();
 	ComPtr<ID3D12Fence> GetFence() const;
+	uint64_t GetLastFenceValue() const { return FenceValue; }
+	D3D12_COMMAND_LIST_TYPE GetType() const { return CommandListType; }
+	ORenderTargetBase* GetCurrentRenderTarget() const { return CurrentRenderTarget; }
 	void SetPipelineState(SPSODescriptionBase* PSOInfo);
 	D3D12_RESOURCE_STATES ResourceBarrier(ORenderTargetBase* Resource, D3D12_RESOURCE_STATES StateBefore, D3D12_RESOURCE_STATES StateAfter) const;
 	D3D12_RESOURCE_STATES ResourceBarrier(ORenderTargetBase* Resource, D3D12_RESOURCE_STATES StateAfter) const;
@@ -42,6 +49,9 @@ public:
 	void SetRenderToRTVOnly(const SDescriptorPair& RTV) const;
 	void SetRenderToDSVOnly(const SDescriptorPair& DSV) const;
 	void ResetQueueState();
+
+	/** @brief Forgets the bound render target, the next SetRenderTarget prepares its target again */
+	void UnsetRenderTarget();
 	void SetViewportScissors(const D3D12_VIEWPORT& Viewport, const D3D12_RECT& Scissors) const;
 	void SetResource(const string& Name, D3D12_GPU_VIRTUAL_ADDRESS Resource, SPSODescriptionBase* PSO);
 	void SetResource(const string& Name, D3D12_GPU_DESCRIPTOR_HANDLE Resource, SPSODescriptionBase* PSO);
@@ -50,6 +60,9 @@ public:
 	template<typename T>
 	T* GetCommandListAs();
 
+	// Fence value of every executed command list, the upload ring retires its staging memory with it
+	SDelegate<void, uint64_t> OnCommandListExecuted;
+
 protected:
 	ComPtr<ID3D12CommandAllocator> CreateCommandAllocator();
 	ComPtr<ID3D12GraphicsCommandList> CreateCommandList(ComPtr<ID3D12CommandAllocator> Allocator);
@@ -0,0 +1,131 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Owns all components of one type. They are constructed in fixed size blocks, so addresses stay valid for the lifetime of a component.
+ * Live components are listed densely for the update passes, removal swaps the last one into the freed entry.
+ */
+template<typename T>
+class TComponentPool
+{
+public:
+	TComponentPool() = default;
+	TComponentPool(const TComponentPool&) = delete;
+	TComponentPool& operator=(const TComponentPool&) = delete;
+	~TComponentPool();
+
+	template<typename... Args>
+	T* Create(Args&&... Arg);
+
+	void Remove(T* Component);
+	void Clear();
+
+	size_t Size() const { return Active.size(); }
+	bool Contains(const T* Component) const { return FindSlot(Component) != InvalidSlot; }
+
+	auto begin() const { return Active.begin(); }
+	auto end() const { return Active.end(); }
+
+private:
+	static constexpr size_t BlockSize = 64;
+	static constexpr size_t InvalidSlot = SIZE_MAX;
+
+	struct SStorage
+	{
+		alignas(T) std::byte Bytes[sizeof(T)];
+	};
+
+	T* GetSlot(size_t Slot) const;
+	size_t FindSlot(const T* Component) const;
+
+	std::vector<std::unique_ptr<SStorage[]>> Blocks;
+	std::vector<size_t> FreeSlots;
+
+	// Dense list of the live components and the position of every slot in it
+	std::vector<T*> Active;
+	std::vector<size_t> SlotToActive;
+};
+
+template<typename T>
+TComponentPool<T>::~TComponentPool()
+{
+	Clear();
+}
+
+template<typename T>
+template<typename... Args>
+T* TComponentPool<T>::Create(Args&&... Arg)
+{
+	if (FreeSlots.empty())
+	{
+		const size_t first = Blocks.size() * BlockSize;
+		Blocks.push_back(std::make_unique<SStorage[]>(BlockSize));
+		SlotToActive.resize(first + BlockSize, InvalidSlot);
+		for (size_t slot = first + BlockSize; slot > first; slot--)
+		{
+			FreeSlots.push_back(slot - 1);
+		}
+	}
+
+	const size_t slot = FreeSlots.back();
+	T* component = new (GetSlot(slot)) T(std::forward<Args>(Arg)...);
+	FreeSlots.pop_back();
+	SlotToActive[slot] = Active.size();
+	Active.push_back(component);
+	return component;
+}
+
+template<typename T>
+void TComponentPool<T>::Remove(T* Component)
+{
+	const size_t slot = FindSlot(Component);
+	if (slot == InvalidSlot)
+	{
+		return;
+	}
+
+	const size_t index = SlotToActive[slot];
+	Active[index] = Active.back();
+	SlotToActive[FindSlot(Active[index])] = index;
+	Active.pop_back();
+	SlotToActive[slot] = InvalidSlot;
+
+	Component->~T();
+	FreeSlots.push_back(slot);
+}
+
+template<typename T>
+void TComponentPool<T>::Clear()
+{
+	while (!Active.empty())
+	{
+		Remove(Active.back());
+	}
+}
+
+template<typename T>
+T* TComponentPool<T>::GetSlot(size_t Slot) const
+{
+	return reinterpret_cast<T*>(Blocks[Slot / BlockSize][Slot % BlockSize].Bytes);
+}
+
+template<typename T>
+size_t TComponentPool<T>::FindSlot(const T* Component) const
+{
+	// Only a handful of blocks, removal is rare compared to the update passes
+	const auto address = reinterpret_cast<const std::byte*>(Component);
+	for (size_t block = 0; block < Blocks.size(); block++)
+	{
+		const auto first = reinterpret_cast<const std::byte*>(Blocks[block].get());
+		if (address >= first && address < first + BlockSize * sizeof(SStorage))
+		{
+			const size_t slot = block * BlockSize + static_cast<size_t>(address - first) / sizeof(SStorage);
+			return SlotToActive[slot] != InvalidSlot ? slot : InvalidSlot;
+		}
+	}
+	return InvalidSlot;
+}
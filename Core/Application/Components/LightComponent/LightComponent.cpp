@@ -6,6 +6,16 @@
 #include "MathUtils.h"
 #include "Profiler.h"
 #include "Window/Window.h"
+
+namespace
+{
+[[maybe_unused]] const array CascadeColors = {
+	SColor::Red,
+	SColor::Blue,
+	SColor::Green,
+};
+} // namespace
+
 OLightComponent::OLightComponent()
 
 {
@@ -16,17 +26,19 @@ OLightComponent::OLightComponent()
 	});
 }
 
-void OLightComponent::Tick(UpdateEventArgs Arg)
+void OLightComponent::Tick(const UpdateEventArgs& Arg)
 {
 	PROFILE_SCOPE();
-	auto instance = Owner->GetDefaultInstance();
-	if (instance->HlslData.Position != Position || DirectX::XMQuaternionEqual(Load(instance->HlslData.Rotation), Load(Rotation)) || instance->HlslData.Scale != Scale) // make delegate based
+	const auto& hierarchy = OEngine::Get()->GetTransformHierarchy();
+	if (hierarchy.WasUpdated(TransformNode))
 	{
-		WorldMatrix = Owner->GetDefaultInstance()->HlslData.World;
-		DirectX::XMFLOAT4 pos{};
-		Position = instance->HlslData.Position;
-		Rotation = instance->HlslData.Rotation;
-		Scale = instance->HlslData.Scale;
+		static_assert(sizeof(STransformMatrix) == sizeof(DirectX::XMFLOAT4X4));
+		std::memcpy(WorldMatrix.m, hierarchy.GetWorld(TransformNode).M, sizeof(WorldMatrix.m));
+		DirectX::XMVECTOR scale, rotation, position;
+		DirectX::XMMatrixDecompose(&scale, &rotation, &position, Load(WorldMatrix));
+		Put(Position, position);
+		Put(Rotation, rotation);
+		Put(Scale, scale);
 		MarkDirty();
 	}
 }
@@ -43,9 +55,13 @@ DirectX::XMVECTOR OLightComponent::GetGlobalPosition() const
 
 bool OLightComponent::TryUpdate()
 {
-	bool res = NumFramesDirty > 0;
-	NumFramesDirty = 0;
-	return res;
+	// Every frame resource is written by the frame that updates it
+	if (NumFramesDirty > 0)
+	{
+		NumFramesDirty--;
+		return true;
+	}
+	return false;
 }
 
 void OLightComponent::MarkDirty()
@@ -89,6 +105,7 @@ void ODirectionalLightComponent::SetDirectionalLight(const SDirectionalLightPayl
 {
 	DirectionalLight.Direction = Light.Direction;
 	DirectionalLight.Intensity = Light.Intensity;
+	bCascadesDirty = true;
 	UpdateLightData();
 }
 int32_t ODirectionalLightComponent::GetLightIndex() const
@@ -110,27 +127,80 @@ void ODirectionalLightComponent::SetPassConstant(SPassConstants& OutConstant)
 {
 }
 
-void ODirectionalLightComponent::Tick(UpdateEventArgs Arg)
+void ODirectionalLightComponent::Tick(const UpdateEventArgs& Arg)
 {
+	PROFILE_SCOPE();
 	OLightComponent::Tick(Arg);
-	MarkDirty();
-	auto angles = NormalizedToAngles(DirectionalLight.Direction);
+	if (AnimationDelta != DirectX::XMFLOAT3{ 0.0f, 0.0f, 0.0f })
+	{
+		auto angles = NormalizedToAngles(DirectionalLight.Direction);
+
+		auto light = angles + AnimationDelta * Arg.Timer.GetDeltaTime();
+		auto isInRange = [](float val) { return val >= -180 && val <= 180; };
+		if (!isInRange(light.x))
+		{
+			AnimationDelta.x *= -1;
+		}
+		if (!isInRange(light.y))
+		{
+			AnimationDelta.y *= -1;
+		}
+		if (!isInRange(light.z))
+		{
+			AnimationDelta.z *= -1; //todo optimize
+		}
+		DirectionalLight.Direction = AnglesToNormalized(light);
+		bCascadesDirty = true;
+	}
 
-	auto light = angles + AnimationDelta * Arg.Timer.GetDeltaTime();
-	auto isInRange = [](float val) { return val >= -180 && val <= 180; };
-	if (!isInRange(light.x))
+	// Cascades follow the camera and are recomputed only when something they depend on changed, otherwise only the dynamic casters are culled again
+	const auto engine = OEngine::Get();
+	const auto camera = engine->GetWindow().lock()->GetCamera().lock();
+	DirectX::XMFLOAT4X4 viewProj;
+	Put(viewProj, camera->GetView() * camera->GetProj());
+	if (bCascadesDirty || CascadeStaticGeneration != engine->GetStaticShadowCastersGeneration() || CascadeSceneRadius != engine->GetSceneBounds().Radius
+	    || std::memcmp(&viewProj, &CascadeViewProj, sizeof(viewProj)) != 0)
 	{
-		AnimationDelta.x *= -1;
+		SetLightSourceData();
 	}
-	if (!isInRange(light.y))
+	else
 	{
-		AnimationDelta.y *= -1;
+		RefreshCascades();
 	}
-	if (!isInRange(light.z))
+}
+
+const OShadowCascadeCache& ODirectionalLightComponent::GetCascadeCache() const
+{
+	return CascadeCache;
+}
+
+void ODirectionalLightComponent::InvalidateCascadeCache()
+{
+	CascadeCache.InvalidateAll();
+	bCascadesDirty = true;
+}
+
+void ODirectionalLightComponent::MarkCascadesDirty()
+{
+	bCascadesDirty = true;
+}
+
+void ODirectionalLightComponent::RefreshCascades()
+{
+	PROFILE_SCOPE();
+	for (int i = 0; i < MAX_CSM_PER_FRAME; i++)
 	{
-		AnimationDelta.z *= -1; //todo optimize
+		const auto shadowMap = CSM.lock()->GetShadowMap(i).lock();
+		if (!shadowMap->bDrawShadowMap)
+		{
+			continue;
+		}
+		if (shadowMap->bDrawBoundingGeometry)
+		{
+			DEBUG_DRAW(Box(CascadeBounds[i].Center, CascadeBounds[i].Extents, CascadeBounds[i].Orientation, CascadeColors[i]));
+		}
+		shadowMap->RefreshDynamicCasters();
 	}
-	DirectionalLight.Direction = AnglesToNormalized(light);
 }
 
 void ODirectionalLightComponent::SetCSM(const weak_ptr<OCSM>& InCSM)
@@ -151,6 +221,7 @@ void ODirectionalLightComponent::SetCascadeLambda(float InLambda)
 {
 	CascadeSplitLambda = InLambda;
 	UpdateCascadeSplits();
+	InvalidateCascadeCache();
 	MarkDirty();
 }
 
@@ -301,17 +372,19 @@ void ODirectionalLightComponent::SetLightSourceData()
 		arrayedCorners[i] = HLSL::FrustumCornens[i];
 	}
 
-	array colors = {
-		SColor::Red,
-		SColor::Blue,
-		SColor::Green,
-	};
+	const auto staticGeneration = OEngine::Get()->GetStaticShadowCastersGeneration();
+	bCascadesDirty = false;
+	CascadeStaticGeneration = staticGeneration;
+	CascadeSceneRadius = OEngine::Get()->GetSceneBounds().Radius;
+	Put(CascadeViewProj, viewProj);
+	bool cascadesChanged = false;
 
 	//Calculate shadow matrices, view and proj for light based on the splits
 	float lastSplitDist = 0.0f;
 	for (int i = 0; i < MAX_CSM_PER_FRAME; i++)
 	{
-		if (!CSM.lock()->GetShadowMap(i).lock()->bDrawShadowMap)
+		const auto shadowMap = CSM.lock()->GetShadowMap(i).lock();
+		if (!shadowMap->bDrawShadowMap)
 		{
 			continue;
 		}
@@ -351,6 +424,34 @@ void ODirectionalLightComponent::SetLightSourceData()
 		}
 		radius = std::ceil(radius * 16.0f) / 16.0f;
 
+		SShadowCascadeKey key;
+		key.LightDirection = { DirectionalLight.Direction.x, DirectionalLight.Direction.y, DirectionalLight.Direction.z };
+		key.Center = { XMVectorGetX(center), XMVectorGetY(center), XMVectorGetZ(center) };
+		key.Radius = radius;
+		key.StaticGeneration = staticGeneration;
+
+		if (!shadowMap->UseStaticCache())
+		{
+			CascadeCache.Invalidate(i);
+		}
+		else if (!CascadeCache.NeedsRebuild(i, key))
+		{
+			// Matrices of the cached layer are kept, only the dynamic casters are re-culled
+			if (shadowMap->bDrawBoundingGeometry)
+			{
+				DEBUG_DRAW(Box(CascadeBounds[i].Center, CascadeBounds[i].Extents, CascadeBounds[i].Orientation, CascadeColors[i]));
+			}
+			shadowMap->RefreshDynamicCasters();
+			lastSplitDist = CascadeSplits[i];
+			continue;
+		}
+		else
+		{
+			// Pad the cascade so it stays valid while the camera moves within the texel threshold
+			radius = CascadeCache.Commit(i, key);
+		}
+		cascadesChanged = true;
+
 		float texelSize = 1.0f / static_cast<float>(SRenderConstants::ShadowMapSize);
 		float scale = radius * 2.0f;
 		scale /= texelSize;
@@ -376,16 +477,17 @@ void ODirectionalLightComponent::SetLightSourceData()
 		worldbound.Extents = XMFLOAT3(radius + 100 * RadiusScale, depth, radius + 100 * RadiusScale);
 		Put(worldbound.Orientation, XMQuaternionRotationMatrix(lightView));
 		Put(worldbound.Center, center);
-		if (CSM.lock()->GetShadowMap(i).lock()->bDrawBoundingGeometry)
+		CascadeBounds[i] = worldbound;
+		if (shadowMap->bDrawBoundingGeometry)
 		{
-			OEngine::Get()->DrawDebugBox(worldbound.Center, worldbound.Extents, worldbound.Orientation, colors[i], 0.1);
+			DEBUG_DRAW(Box(worldbound.Center, worldbound.Extents, worldbound.Orientation, CascadeColors[i]));
 		}
 
 		// Compute the center of the bounding box
 		BoundingOrientedBox localBound;
 		worldbound.Transform(localBound, lightView);
 		OBoundingOrientedBox boundingBox{ localBound };
-		CSM.lock()->GetShadowMap(i).lock()->UpdateBoundingGeometry(&boundingBox, lightView);
+		shadowMap->UpdateBoundingGeometry(&boundingBox, lightView);
 
 		const XMMATRIX T{
 			0.5f, 0.0f, 0.0f, 0.0f, 0.0f, -0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.5f, 0.5f, 0.0f, 1.0f
@@ -403,9 +505,14 @@ void ODirectionalLightComponent::SetLightSourceData()
 		const XMMATRIX S = lightViewProj * T;
 		Put(DirectionalLight.ShadowMapData[i].Transform, Transpose(S));
 
-		CSM.lock()->GetShadowMap(i).lock()->SetPassConstants(passConstants);
+		shadowMap->SetPassConstants(passConstants);
 		lastSplitDist = CascadeSplits[i];
 	}
+
+	if (cascadesChanged)
+	{
+		NumFramesDirty = SRenderConstants::NumFrameResources;
+	}
 }
 
 void OSpotLightComponent::SetLightSourceData()
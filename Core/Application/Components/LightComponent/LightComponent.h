@@ -2,6 +2,7 @@
 #pragma once
 #include "DirectX/HLSL/HlslTypes.h"
 #include "DirectX/Light/Light.h"
+#include "Engine/RenderTarget/CSM/ShadowCascadeCache.h"
 #include "Engine/RenderTarget/RenderObject/RenderObject.h"
 #include "RenderItemComponentBase.h"
 
@@ -35,7 +36,7 @@ class OLightComponent : public OSceneComponent
 public:
 	OLightComponent();
 
-	void Tick(UpdateEventArgs Arg) override;
+	void Tick(const UpdateEventArgs& Arg) override;
 	void Init(ORenderItem* Other) override;
 	virtual void SetLightSourceData() = 0;
 
@@ -70,7 +71,7 @@ public:
 	int32_t GetLightIndex() const override;
 	void UpdateFrameResource(const SFrameResource* FrameResource) override;
 	void SetPassConstant(SPassConstants& OutConstant) override;
-	void Tick(UpdateEventArgs Arg) override;
+	void Tick(const UpdateEventArgs& Arg) override;
 	void SetDirectionalLight(const SDirectionalLightPayload& Light);
 	void InitFrameResource(const TUploadBufferData<HLSL::DirectionalLight>& Spot);
 	void SetCSM(const weak_ptr<OCSM>& InCSM);
@@ -87,7 +88,23 @@ public:
 	float RadiusScale = 1.f;
 	DirectX::XMFLOAT3 AnimationDelta = { 0.0f, 0.0f, 0.0f };
 
+	const OShadowCascadeCache& GetCascadeCache() const;
+	void InvalidateCascadeCache();
+
+	// Shadow map settings changed, the cascades are rebuilt on the next tick
+	void MarkCascadesDirty();
+
 private:
+	void RefreshCascades();
+
+	// Set when the light changes, the camera, the static casters and the scene bounds are compared against the last rebuild
+	bool bCascadesDirty = true;
+	DirectX::XMFLOAT4X4 CascadeViewProj = {};
+	uint64_t CascadeStaticGeneration = 0;
+	float CascadeSceneRadius = 0.0f;
+
+	OShadowCascadeCache CascadeCache{ MAX_CSM_PER_FRAME, { SRenderConstants::ShadowMapSize } };
+	array<DirectX::BoundingOrientedBox, MAX_CSM_PER_FRAME> CascadeBounds;
 	float CascadeSplitLambda = 0.65;
 	TUploadBufferData<HLSL::DirectionalLight> DirLightBufferInfo;
 	HLSL::DirectionalLight DirectionalLight;
@@ -1,5 +1,7 @@
 #include "RenderItemComponentBase.h"
 
+#include "Engine/Engine.h"
+
 void OComponentBase::Init(ORenderItem* Other)
 {
 	Owner = Other;
@@ -9,3 +11,15 @@ string OComponentBase::GetName() const
 {
 	return Name;
 }
+
+void OSceneComponent::Init(ORenderItem* Other)
+{
+	OComponentBase::Init(Other);
+	const auto instance = Owner->GetDefaultInstance();
+	TransformNode = OEngine::Get()->GetTransformHierarchy().Add(instance ? instance->TransformNode : OTransformHierarchy::InvalidNode);
+}
+
+uint32_t OSceneComponent::GetTransformNode() const
+{
+	return TransformNode;
+}
@@ -9,7 +9,7 @@ class OComponentBase
 public:
 	virtual ~OComponentBase() = default;
 	virtual void Init(ORenderItem* Other);
-	virtual void Tick(UpdateEventArgs Arg) {}
+	virtual void Tick(const UpdateEventArgs& Arg) {}
 	string GetName() const;
 
 protected:
@@ -21,8 +21,12 @@ class OSceneComponent : public OComponentBase
 {
 public:
 	OSceneComponent() { Name = "SceneComponent"; }
+	void Init(ORenderItem* Other) override;
+	uint32_t GetTransformNode() const;
 
 protected:
+	// Attached to the default instance of the owner, the engine removes it together with the owner
+	uint32_t TransformNode = UINT32_MAX;
 	DirectX::XMFLOAT4X4 WorldMatrix = {};
 
 	DirectX::XMFLOAT3 Position = {};
@@ -0,0 +1,182 @@
+#include "DebugDraw.h"
+
+#if ENABLE_DEBUG_DRAW
+#include "Engine/UploadBuffer/UploadManager.h"
+#include "Profiler.h"
+#include "imgui.h"
+
+#include <DirectXCollision.h>
+
+using namespace DirectX;
+
+namespace
+{
+constexpr uint32_t SphereSegments = 24;
+
+// Corners in the order of BoundingOrientedBox::GetCorners, the first four have z = 1
+constexpr XMFLOAT3 CubeCorners[8] = {
+	{ -1.0f, -1.0f, 1.0f }, { 1.0f, -1.0f, 1.0f }, { 1.0f, 1.0f, 1.0f }, { -1.0f, 1.0f, 1.0f },
+	{ -1.0f, -1.0f, -1.0f }, { 1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, -1.0f }, { -1.0f, 1.0f, -1.0f }
+};
+
+constexpr uint32_t NumEdgeVertices = 24;
+constexpr uint32_t CubeEdges[NumEdgeVertices] = { 0, 1, 1, 2, 2, 3, 3, 0, 4, 5, 5, 6, 6, 7, 7, 4, 0, 4, 1, 5, 2, 6, 3, 7 };
+
+void WriteCubeEdges(SDebugVertex* Vertices, const XMFLOAT3 (&Corners)[8], const XMFLOAT3& Color)
+{
+	for (uint32_t idx = 0; idx < NumEdgeVertices; idx++)
+	{
+		Vertices[idx] = { Corners[CubeEdges[idx]], Color };
+	}
+}
+} // namespace
+
+void ODebugDraw::Line(const XMFLOAT3& From, const XMFLOAT3& To, SColor Color, float Duration)
+{
+	auto* vertices = AddVertices(2, Duration);
+	vertices[0] = { From, Color.ToFloat3() };
+	vertices[1] = { To, Color.ToFloat3() };
+}
+
+void ODebugDraw::Box(const XMFLOAT3& Center, const XMFLOAT3& Extents, const XMFLOAT4& Orientation, SColor Color, float Duration)
+{
+	XMFLOAT3 corners[8];
+	BoundingOrientedBox(Center, Extents, Orientation).GetCorners(corners);
+	WriteCubeEdges(AddVertices(NumEdgeVertices, Duration), corners, Color.ToFloat3());
+}
+
+void ODebugDraw::Frustum(const XMFLOAT4X4& InvViewProjection, SColor Color, float Duration)
+{
+	// Clip space depth goes from 0 at the near plane to 1 at the far plane
+	const auto invViewProjection = XMLoadFloat4x4(&InvViewProjection);
+	XMFLOAT3 corners[8];
+	for (uint32_t idx = 0; idx < std::size(corners); idx++)
+	{
+		const auto& ndc = CubeCorners[idx];
+		XMStoreFloat3(&corners[idx], XMVector3TransformCoord(XMVectorSet(ndc.x, ndc.y, ndc.z > 0 ? 1.0f : 0.0f, 1.0f), invViewProjection));
+	}
+	WriteCubeEdges(AddVertices(NumEdgeVertices, Duration), corners, Color.ToFloat3());
+}
+
+void ODebugDraw::Sphere(const XMFLOAT3& Center, float Radius, SColor Color, float Duration)
+{
+	// One circle around each axis
+	auto* vertices = AddVertices(3 * SphereSegments * 2, Duration);
+	const auto color = Color.ToFloat3();
+	auto point = [&](uint32_t Circle, uint32_t Segment) {
+		const float angle = XM_2PI * Segment / SphereSegments;
+		const float cos = std::cos(angle) * Radius;
+		const float sin = std::sin(angle) * Radius;
+		return Circle == 0   ? XMFLOAT3(Center.x + cos, Center.y + sin, Center.z)
+		       : Circle == 1 ? XMFLOAT3(Center.x + cos, Center.y, Center.z + sin)
+		                     : XMFLOAT3(Center.x, Center.y + cos, Center.z + sin);
+	};
+	for (uint32_t circle = 0; circle < 3; circle++)
+	{
+		for (uint32_t segment = 0; segment < SphereSegments; segment++)
+		{
+			*vertices++ = { point(circle, segment), color };
+			*vertices++ = { point(circle, segment + 1), color };
+		}
+	}
+}
+
+void ODebugDraw::Text(const XMFLOAT3& Position, string Message, SColor Color, float Duration)
+{
+	TextMarkers.push_back({ Position, std::move(Message), Color, Time + std::max(Duration, 0.0f) });
+}
+
+void ODebugDraw::Tick(float DeltaTime)
+{
+	PROFILE_SCOPE();
+	Time += DeltaTime;
+	FrameVertices.clear();
+	std::erase_if(TextMarkers, [this](const STextMarker& Marker) { return Marker.ExpireTime <= Time; });
+	if (NextExpireTime > Time)
+	{
+		return;
+	}
+
+	// The ranges that are still alive are moved down in order
+	size_t readVertex = 0;
+	size_t writeVertex = 0;
+	size_t numRanges = 0;
+	NextExpireTime = std::numeric_limits<double>::max();
+	for (size_t idx = 0; idx < TimedRanges.size(); idx++)
+	{
+		const auto range = TimedRanges[idx];
+		if (range.ExpireTime > Time)
+		{
+			std::copy_n(TimedVertices.begin() + readVertex, range.NumVertices, TimedVertices.begin() + writeVertex);
+			writeVertex += range.NumVertices;
+			TimedRanges[numRanges++] = range;
+			NextExpireTime = std::min(NextExpireTime, range.ExpireTime);
+		}
+		readVertex += range.NumVertices;
+	}
+	TimedVertices.resize(writeVertex);
+	TimedRanges.resize(numRanges);
+}
+
+void ODebugDraw::CollectVertices(vector<SDebugVertex>& OutVertices) const
+{
+	OutVertices.resize(FrameVertices.size() + TimedVertices.size());
+	std::ranges::copy(FrameVertices, OutVertices.begin());
+	std::ranges::copy(TimedVertices, OutVertices.begin() + FrameVertices.size());
+}
+
+void ODebugDraw::Draw(ID3D12GraphicsCommandList* CommandList, OUploadManager* Uploads, const vector<SDebugVertex>& Vertices)
+{
+	PROFILE_SCOPE();
+	const uint32_t numVertices = static_cast<uint32_t>(Vertices.size());
+	if (numVertices == 0)
+	{
+		return;
+	}
+
+	// The vertices only live in the ring until the frame completes
+	const uint64_t size = numVertices * sizeof(SDebugVertex);
+	const auto allocation = Uploads->Allocate(size);
+	std::ranges::copy(Vertices, reinterpret_cast<SDebugVertex*>(allocation.CPUAddress));
+
+	D3D12_VERTEX_BUFFER_VIEW view;
+	view.BufferLocation = allocation.GPUAddress;
+	view.SizeInBytes = static_cast<UINT>(size);
+	view.StrideInBytes = sizeof(SDebugVertex);
+	CommandList->IASetVertexBuffers(0, 1, &view);
+	CommandList->IASetIndexBuffer(nullptr);
+	CommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_LINELIST);
+	CommandList->DrawInstanced(numVertices, 1, 0, 0);
+}
+
+void ODebugDraw::DrawTextMarkers(ImDrawList* List, const XMFLOAT4X4& ViewProjection, float Width, float Height) const
+{
+	const auto viewProjection = XMLoadFloat4x4(&ViewProjection);
+	for (const auto& marker : TextMarkers)
+	{
+		XMFLOAT4 clip;
+		XMStoreFloat4(&clip, XMVector4Transform(XMVectorSet(marker.Position.x, marker.Position.y, marker.Position.z, 1.0f), viewProjection));
+		if (clip.w <= 0.0f)
+		{
+			continue;
+		}
+
+		const ImVec2 screen((clip.x / clip.w * 0.5f + 0.5f) * Width, (0.5f - clip.y / clip.w * 0.5f) * Height);
+		List->AddText(screen, IM_COL32(marker.Color.R, marker.Color.G, marker.Color.B, marker.Color.A), marker.Text.c_str());
+	}
+}
+
+SDebugVertex* ODebugDraw::AddVertices(uint32_t Count, float Duration)
+{
+	if (Duration <= 0)
+	{
+		FrameVertices.resize(FrameVertices.size() + Count);
+		return FrameVertices.data() + FrameVertices.size() - Count;
+	}
+
+	TimedRanges.push_back({ Time + Duration, Count });
+	NextExpireTime = std::min(NextExpireTime, Time + Duration);
+	TimedVertices.resize(TimedVertices.size() + Count);
+	return TimedVertices.data() + TimedVertices.size() - Count;
+}
+#endif
@@ -0,0 +1,82 @@
+#pragma once
+#include "Color.h"
+#include "Defines.h"
+#include "Types.h"
+
+#include <DirectXMath.h>
+#include <d3d12.h>
+#include <limits>
+
+// The class, its node and its pipeline only exist in builds with debug draw
+#if ENABLE_DEBUG_DRAW
+class OUploadManager;
+struct ImDrawList;
+
+struct SDebugVertex
+{
+	DirectX::XMFLOAT3 Position;
+	DirectX::XMFLOAT3 Color;
+};
+
+/**
+ * @brief Immediate mode lines, boxes, frustums, spheres and text markers.
+ * Primitives without a duration are drawn in the current frame only, the others stay in a timed list until they expire.
+ * Every primitive is turned into lines, the update stage collects them into the frame packet and the record stage copies
+ * them into the shared upload ring and draws them in a single draw, text markers are drawn by the UI.
+ */
+class ODebugDraw
+{
+public:
+	void Line(const DirectX::XMFLOAT3& From, const DirectX::XMFLOAT3& To, SColor Color, float Duration = 0);
+	void Box(const DirectX::XMFLOAT3& Center, const DirectX::XMFLOAT3& Extents, const DirectX::XMFLOAT4& Orientation, SColor Color, float Duration = 0);
+	void Frustum(const DirectX::XMFLOAT4X4& InvViewProjection, SColor Color, float Duration = 0);
+	void Sphere(const DirectX::XMFLOAT3& Center, float Radius, SColor Color, float Duration = 0);
+	void Text(const DirectX::XMFLOAT3& Position, string Message, SColor Color, float Duration = 0);
+
+	/** @brief Starts a frame, drops the primitives of the last one and the timed primitives that expired */
+	void Tick(float DeltaTime);
+
+	/** @brief Lines of the frame and the timed lines that are still alive */
+	void CollectVertices(vector<SDebugVertex>& OutVertices) const;
+
+	/** @brief Expects a pipeline reading SDebugVertex as a line list */
+	static void Draw(ID3D12GraphicsCommandList* CommandList, OUploadManager* Uploads, const vector<SDebugVertex>& Vertices);
+	void DrawTextMarkers(ImDrawList* List, const DirectX::XMFLOAT4X4& ViewProjection, float Width, float Height) const;
+
+	uint32_t GetNumVertices() const { return static_cast<uint32_t>(FrameVertices.size() + TimedVertices.size()); }
+
+private:
+	SDebugVertex* AddVertices(uint32_t Count, float Duration);
+
+	struct STimedRange
+	{
+		double ExpireTime;
+		uint32_t NumVertices;
+	};
+
+	struct STextMarker
+	{
+		DirectX::XMFLOAT3 Position;
+		string Text;
+		SColor Color;
+		double ExpireTime;
+	};
+
+	vector<SDebugVertex> FrameVertices;
+
+	// Ranges follow the order of their vertices, expired ones are compacted away in one pass
+	vector<SDebugVertex> TimedVertices;
+	vector<STimedRange> TimedRanges;
+	double NextExpireTime = std::numeric_limits<double>::max();
+
+	vector<STextMarker> TextMarkers;
+	double Time = 0;
+};
+#endif
+
+// Arguments are not evaluated when debug draw is compiled out
+#if ENABLE_DEBUG_DRAW
+#define DEBUG_DRAW(Call) OEngine::Get()->GetDebugDraw()->Call
+#else
+#define DEBUG_DRAW(Call)
+#endif
@@ -26,6 +26,8 @@
 
 #include <DirectXMath.h>
 
+#include <bit>
+#include <cstring>
 #include <numeric>
 #include <ranges>
 
@@ -61,6 +63,10 @@ bool OEngine::Initialize()
 		DirectCommandQueue = make_unique<OCommandQueue>(device, D3D12_COMMAND_LIST_TYPE_DIRECT);
 		ComputeCommandQueue = make_unique<OCommandQueue>(device, D3D12_COMMAND_LIST_TYPE_COMPUTE);
 		CopyCommandQueue = make_unique<OCommandQueue>(device, D3D12_COMMAND_LIST_TYPE_COPY);
+		GpuProfiler = make_unique<OGpuProfiler>(device, DirectCommandQueue->GetCommandQueue().Get());
+		UploadManager = make_unique<OUploadManager>(device, DirectCommandQueue.get(), SRenderConstants::UploadRingSize);
+		TransientResources = make_unique<OTransientResourcePool>(device, SRenderConstants::TransientHeapSize);
+		TransientResources->OnCompiled.AddMember(this, &OEngine::RebuildTransientViews);
 
 		RTVDescriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
 		DSVDescriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
@@ -84,8 +90,8 @@ void OEngine::InitManagers()
 {
 	InitPipelineManager();
 	InitRenderGraph();
-	MeshGenerator = make_unique<OMeshGenerator>(Device->GetDevice(), GetCommandQueue());
-	TextureManager = make_shared<OTextureManager>(Device->GetDevice(), GetCommandQueue());
+	MeshGenerator = make_unique<OMeshGenerator>(UploadManager.get());
+	TextureManager = make_shared<OTextureManager>(Device->GetDevice(), GetCommandQueue(), UploadManager.get());
 	TextureManager->InitRenderObject();
 	MaterialManager = make_shared<OMaterialManager>();
 	MaterialManager->LoadMaterialsFromCache();
@@ -101,6 +107,7 @@ void OEngine::PostInitialize()
 	BuildFilters();
 	BuildOffscreenRT();
 	BuildSSAO();
+	BuildClusteredLighting();
 	BuildNormalTangentDebugTarget();
 }
 
@@ -109,6 +116,11 @@ void OEngine::BuildSSAO()
 	SSAORT = BuildRenderObject<OSSAORenderTarget>(RenderTargets, Device, Window->GetWidth(), Window->GetHeight(), SRenderConstants::NormalMapFormat);
 }
 
+void OEngine::BuildClusteredLighting()
+{
+	ClusteredLighting = BuildRenderObject<OClusteredLighting>(None, Device);
+}
+
 void OEngine::BuildNormalTangentDebugTarget()
 {
 	NormalTangentDebugTarget = BuildRenderObject<ONormalTangentDebugTarget>(RenderTargets, Device, Window->GetWidth(), Window->GetHeight(), SRenderConstants::BackBufferFormat);
@@ -121,6 +133,20 @@ void OEngine::BuildFilters()
 	BilateralFilterUUID = AddFilter<OBilateralBlurFilter>();
 }
 
+void OEngine::RebuildTransientViews()
+{
+	// Placing before the heaps are filled leaves the views to FillDescriptorHeaps
+	if (!GetDescriptorHeap())
+	{
+		return;
+	}
+
+	for (const auto uuid : { BlurFilterUUID, SobelFilterUUID, BilateralFilterUUID })
+	{
+		GetObjectByUUID<OFilterBase>(uuid)->BuildDescriptors();
+	}
+}
+
 TUUID OEngine::AddRenderObject(ERenderGroup Group, IRenderObject* RenderObject)
 {
 	const auto uuid = GenerateUUID();
@@ -193,7 +219,7 @@ void OEngine::DrawRenderItems(SPSODescriptionBase* Desc, const string& RenderLay
 	payload.RenderLayer = RenderLayer;
 	payload.Description = Desc;
 	payload.bForceDrawAll = ForceDrawAll;
-	payload.InstanceBuffer = &CameraRenderedItems;
+	payload.InstanceBuffer = &RecordPacket->CameraRenderedItems;
 	DrawRenderItemsImpl(payload);
 }
 
@@ -250,11 +276,10 @@ void OEngine::UpdateMaterialCB() const
 				Put(matConstants.MatTransform, Transpose(matTransform));
 				LOG(Material, Log, "Updated material: {} Index :{}", TEXT(material->Name), TEXT(material->MaterialCBIndex));
 				updatedIndices.insert(material->MaterialCBIndex);
-				for (auto& cb : FrameResources)
-				{
-					cb->MaterialBuffer->CopyData(material->MaterialCBIndex, matConstants);
-					material->NumFramesDirty--;
-				}
+
+				// Every frame resource is written by the frame that updates it
+				UpdatingFrameResource->MaterialBuffer->CopyData(material->MaterialCBIndex, matConstants);
+				material->NumFramesDirty--;
 			}
 		}
 	}
@@ -267,42 +292,48 @@ void OEngine::UpdateMaterialCB() const
 	LOG(Material, Log, "Updated materials till {}.", updatedIndices.size());
 }
 
+void OEngine::UpdateLightSlots()
+{
+	PROFILE_SCOPE();
+	LightSlotKeys.clear();
+	for (const auto component : LightComponents)
+	{
+		LightSlotKeys.push_back({ static_cast<uint32_t>(component->GetLightType()), static_cast<uint32_t>(component->GetLightIndex()) });
+	}
+	LightSlots.Assign(LightSlotKeys);
+
+	// A removed light moves the later lights of its type down, their new slots still hold other data
+	for (uint32_t i = 0; i < LightComponents.size(); i++)
+	{
+		if (LightSlots.IsMoved(i))
+		{
+			LightComponents[i]->NumFramesDirty = SRenderConstants::NumFrameResources;
+		}
+	}
+}
+
 void OEngine::UpdateLightCB(const UpdateEventArgs& Args) const
 {
 	PROFILE_SCOPE();
 
-	uint32_t dirIndex = 0;
-	uint32_t pointIndex = 0;
-	uint32_t spotIndex = 0;
-	for (const auto component : LightComponents)
+	for (uint32_t i = 0; i < LightComponents.size(); i++)
 	{
+		const auto component = LightComponents[i];
 		if (component->TryUpdate())
 		{
-			for (auto& cb : FrameResources)
-			{
-				switch (component->GetLightType())
-				{
-				case ELightType::Directional:
-					cb->DirectionalLightBuffer->CopyData(dirIndex, Cast<ODirectionalLightComponent>(component)->GetDirectionalLight());
-					break;
-				case ELightType::Point:
-					cb->PointLightBuffer->CopyData(pointIndex, Cast<OPointLightComponent>(component)->GetPointLight());
-					break;
-				case ELightType::Spot:
-					cb->SpotLightBuffer->CopyData(spotIndex, Cast<OSpotLightComponent>(component)->GetSpotLight());
-					break;
-				}
-			}
-			switch (component->GetLightType()) // todo make it more generic
+			// The clustered light lists index the buffers by the same slots, see OClusteredLighting::Update
+			const auto cb = UpdatingFrameResource;
+			const auto slot = LightSlots.GetSlot(i);
+			switch (component->GetLightType())
 			{
 			case ELightType::Directional:
-				dirIndex++;
+				cb->DirectionalLightBuffer->CopyData(slot, Cast<ODirectionalLightComponent>(component)->GetDirectionalLight());
 				break;
 			case ELightType::Point:
-				pointIndex++;
+				cb->PointLightBuffer->CopyData(slot, Cast<OPointLightComponent>(component)->GetPointLight());
 				break;
 			case ELightType::Spot:
-				spotIndex++;
+				cb->SpotLightBuffer->CopyData(slot, Cast<OSpotLightComponent>(component)->GetSpotLight());
 				break;
 			}
 		}
@@ -314,48 +345,76 @@ void OEngine::DrawRenderItemsImpl(const SDrawPayload& Payload)
 	PROFILE_SCOPE();
 	auto cmd = GetCommandQueue()->GetCommandList();
 	auto graphicsPSO = Cast<SPSOGraphicsDescription>(Payload.Description);
-	auto& layerRenderItems = GetRenderItems(Payload.RenderLayer);
-	for (const auto& val : layerRenderItems)
+	const auto layer = RecordPacket->RenderLayers.find(Payload.RenderLayer);
+	if (layer == RecordPacket->RenderLayers.end())
 	{
-		if (!Payload.InstanceBuffer->Items.contains(val) && !Payload.bForceDrawAll)
+		return;
+	}
+	for (const auto& draw : layer->second)
+	{
+		const auto culledIt = Payload.InstanceBuffer->Items.find(draw.Item);
+		const bool bCulled = culledIt != Payload.InstanceBuffer->Items.end();
+		if (!bCulled && !Payload.bForceDrawAll)
 		{
 			continue;
 		}
 
-		auto [item, startInstanceLocation, visibleInstanceCount] = Payload.InstanceBuffer->Items.at(val);
-		if (item.expired())
+		// Expired items leave the layers between frames, the update of the next frame may run while this one is recorded
+		if (draw.Item.expired())
 		{
-			layerRenderItems.erase(item);
 			continue;
 		}
+		static const SCulledRenderItem notCulled;
+		const auto& culled = bCulled ? culledIt->second : notCulled;
 
 		//extract overridden geometry
-		const auto renderItem = item.lock();
-		const auto geometry = !Payload.OverrideGeometry.expired() ? Payload.OverrideGeometry : renderItem->Geometry;
-		const auto submesh = !Payload.OverrideSubmesh.expired() ? Payload.OverrideSubmesh : renderItem->ChosenSubmesh;
+		const auto geometry = !Payload.OverrideGeometry.expired() ? Payload.OverrideGeometry : draw.Geometry;
+		const auto submesh = !Payload.OverrideSubmesh.expired() ? Payload.OverrideSubmesh : draw.Submesh;
 
 		//check if frustum-culled
-		auto visibleInstances = Payload.bForceDrawAll ? renderItem->Instances.size() : visibleInstanceCount;
-		if (!renderItem->IsValidChecked() || visibleInstances == 0)
+		auto visibleInstances = Payload.bForceDrawAll ? draw.NumInstances : culled.VisibleInstanceCount;
+		if (!draw.bValid || visibleInstances == 0)
 		{
 			continue;
 		}
 
 		//draw
-		PROFILE_BLOCK_START(renderItem->Name.c_str());
-		if (!renderItem->Instances.empty() && !renderItem->Geometry.expired())
+		PROFILE_BLOCK_START(draw.Name.c_str());
+		if (!draw.Geometry.expired())
 		{
 			cmd->IASetPrimitiveTopology(graphicsPSO->PrimitiveTopologyType);
 			BindMesh(geometry.lock().get());
 			auto instanceBuffer = GetCurrentFrameInstBuffer(Payload.InstanceBuffer->BufferId);
-			auto location = instanceBuffer->GetGPUAddress() + startInstanceLocation * sizeof(HLSL::InstanceData);
-			GetCommandQueue()->SetResource(STRINGIFY_MACRO(INSTANCE_DATA), location, Payload.Description);
-			cmd->DrawIndexedInstanced(
-			    submesh.lock()->IndexCount,
-			    visibleInstances,
-			    submesh.lock()->StartIndexLocation,
-			    submesh.lock()->BaseVertexLocation,
-			    0);
+			auto extraBuffer = GetCurrentFrameInstExtraBuffer(Payload.InstanceBuffer->BufferId);
+			const auto drawnSubmesh = submesh.lock();
+
+			// Instances are grouped by LOD, every group is drawn with its own index range
+			const bool bDrawLODs = Payload.OverrideSubmesh.expired() && !Payload.bForceDrawAll && culled.LODInstanceCounts[0] != visibleInstances;
+			UINT startInstance = culled.StartInstanceLocation;
+			for (size_t lod = 0; lod <= drawnSubmesh->LODs.size(); lod++)
+			{
+				const UINT numInstances = bDrawLODs ? culled.LODInstanceCounts[lod] : visibleInstances;
+				if (numInstances == 0)
+				{
+					continue;
+				}
+
+				const auto location = instanceBuffer->GetGPUAddress() + startInstance * sizeof(HLSL::InstanceData);
+				const auto extraLocation = extraBuffer->GetGPUAddress() + startInstance * sizeof(HLSL::InstanceExtraData);
+				GetCommandQueue()->SetResource(STRINGIFY_MACRO(INSTANCE_DATA), location, Payload.Description);
+				GetCommandQueue()->SetResource(STRINGIFY_MACRO(INSTANCE_EXTRA_DATA), extraLocation, Payload.Description);
+				cmd->DrawIndexedInstanced(
+				    lod == 0 ? drawnSubmesh->IndexCount : drawnSubmesh->LODs[lod - 1].IndexCount,
+				    numInstances,
+				    lod == 0 ? drawnSubmesh->StartIndexLocation : drawnSubmesh->LODs[lod - 1].StartIndexLocation,
+				    drawnSubmesh->BaseVertexLocation,
+				    0);
+				if (!bDrawLODs)
+				{
+					break;
+				}
+				startInstance += numInstances;
+			}
 		}
 		PROFILE_BLOCK_END();
 	}
@@ -368,9 +427,10 @@ void OEngine::DrawAABBOfRenderItems(SPSODescriptionBase* Desc)
 	commandList->IASetIndexBuffer(nullptr);
 	commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_POINTLIST);
 	auto instanceBuffer = GetCurrentFrameInstBuffer(CameraInstanceBufferID);
-	auto location = instanceBuffer->GetGPUAddress();
-	GetCommandQueue()->SetResource(STRINGIFY_MACRO(INSTANCE_DATA), location, Desc);
-	commandList->DrawInstanced(1, CameraRenderedItems.InstanceCount, 0, 0);
+	auto extraBuffer = GetCurrentFrameInstExtraBuffer(CameraInstanceBufferID);
+	GetCommandQueue()->SetResource(STRINGIFY_MACRO(INSTANCE_DATA), instanceBuffer->GetGPUAddress(), Desc);
+	GetCommandQueue()->SetResource(STRINGIFY_MACRO(INSTANCE_EXTRA_DATA), extraBuffer->GetGPUAddress(), Desc);
+	commandList->DrawInstanced(1, RecordPacket->CameraRenderedItems.InstanceCount, 0, 0);
 }
 
 weak_ptr<OOffscreenTexture> OEngine::GetOffscreenRT() const
@@ -396,18 +456,6 @@ void OEngine::DrawOnePoint()
 	commandList->DrawInstanced(1, 1, 0, 0);
 }
 
-void OEngine::DrawBox(SPSODescriptionBase* Desc)
-{
-	SDrawPayload payload;
-	payload.Description = Desc;
-	payload.RenderLayer = SRenderLayers::Opaque;
-	payload.bForceDrawAll = true;
-	payload.InstanceBuffer = &CameraRenderedItems;
-	payload.OverrideGeometry = DebugBoxRenderItem.lock()->Geometry;
-
-	DrawRenderItemsImpl(payload);
-}
-
 void OEngine::InitUIManager()
 {
 	UIManager.lock()->InitContext(Device->GetDevice(), Window->GetHWND(), SRenderConstants::NumFrameResources, GetDescriptorHeap().Get(), DefaultGlobalHeap, this);
@@ -446,23 +494,23 @@ void OEngine::TryCreateFrameResources()
 			auto frameResource = make_unique<SFrameResource>(Device, GetWindow());
 			FrameResources.push_back(std::move(frameResource));
 		}
+		FramePackets.resize(FrameResources.size());
+		FramePipeline.Initialize(static_cast<uint32_t>(FrameResources.size()));
 	}
 }
 void OEngine::BuildDebugGeometry()
 {
 }
 
-vector<OUploadBuffer<HLSL::InstanceData>*> OEngine::GetInstanceBuffersByUUID(TUUID Id) const
+void OEngine::UploadInstance(const SInstanceParams& Params, int32_t Index, OUploadBuffer<HLSL::InstanceData>* Buffer, OUploadBuffer<HLSL::InstanceExtraData>* ExtraBuffer) const
 {
-	vector<OUploadBuffer<HLSL::InstanceData>*> result;
-	for (const auto& frame : FrameResources)
+	// The side buffer is only touched by the instances that read it
+	const bool bExtraData = bUploadInstanceBounds || Params.NeedsExtraData();
+	Buffer->CopyData(Index, Params.Pack(bExtraData));
+	if (bExtraData)
 	{
-		if (frame->InstanceBuffers.contains(Id))
-		{
-			result.push_back(frame->InstanceBuffers.at(Id).get());
-		}
+		ExtraBuffer->CopyData(Index, Params.PackExtraData());
 	}
-	return result;
 }
 
 void OEngine::SetFogColor(DirectX::XMFLOAT4 Color)
@@ -503,7 +551,7 @@ TUUID OEngine::AddInstanceBuffer(const wstring& Name)
 	TryCreateFrameResources();
 	for (auto& frame : FrameResources)
 	{
-		frame->AddNewInstanceBuffer(Name, GetTotalNumberOfInstances(), newid);
+		frame->AddNewInstanceBuffer(Name, std::max(InstanceCapacity, GetTotalNumberOfInstances()), newid);
 	}
 	return newid;
 }
@@ -534,7 +582,7 @@ void OEngine::BuildDescriptorHeaps()
 		SetObjectDescriptor(heap);
 	};
 
-	build(DefaultGlobalHeap, EResourceHeapType::Default, L"GlobalHeap", UIManager.lock()->GetNumSRVRequired() + TEXTURE_MAPS_NUM + 2);
+	build(DefaultGlobalHeap, EResourceHeapType::Default, L"GlobalHeap", UIManager.lock()->GetNumSRVRequired() + TEXTURE_MAPS_NUM + SRenderConstants::NumTransientSRVs + 2);
 }
 
 void OEngine::PostTestInit()
@@ -572,9 +620,10 @@ OCommandQueue* OEngine::GetCommandQueue(D3D12_COMMAND_LIST_TYPE Type)
 	return nullptr;
 }
 
-void OEngine::OnEnd() const
+void OEngine::OnEnd()
 {
 	FlushGPU();
+	SessionReplay.StopCapture();
 }
 
 void OEngine::RemoveRenderItems()
@@ -584,21 +633,91 @@ void OEngine::RemoveRenderItems()
 	{
 		for (auto& item : PendingRemoveItems)
 		{
+			if (item->bStaticShadowCaster)
+			{
+				InvalidateStaticShadowCasters();
+			}
+			for (const auto& instance : item->Instances)
+			{
+				ReleaseTransformNode(instance.TransformNode);
+			}
+			for (const auto component : item->GetComponents())
+			{
+				if (const auto sceneComponent = dynamic_cast<OSceneComponent*>(component))
+				{
+					ReleaseTransformNode(sceneComponent->GetTransformNode());
+				}
+				if (const auto light = dynamic_cast<OLightComponent*>(component))
+				{
+					std::erase(LightComponents, light);
+					FreeLightIndices.push_back(static_cast<uint32_t>(light->GetLightIndex()));
+				}
+				if (const auto light = dynamic_cast<ODirectionalLightComponent*>(component))
+				{
+					DirectionalLightPool.Remove(light);
+				}
+				else if (const auto light = dynamic_cast<OPointLightComponent*>(component))
+				{
+					PointLightPool.Remove(light);
+				}
+				else if (const auto light = dynamic_cast<OSpotLightComponent*>(component))
+				{
+					SpotLightPool.Remove(light);
+				}
+			}
+			TimedRenderItems.erase(item.get());
+			if (item->bRegistered)
+			{
+				item->bRegistered = false;
+				OnInstanceCountChanged(-static_cast<int64_t>(item->Instances.size()));
+			}
 			erase_if(AllRenderItems, [&item](const auto& val) { return val.get() == item.get(); });
 			SceneGeometry.erase(item->Geometry.lock()->Name);
 			LOG(Render, Log, "Removed item: {}", TEXT(item->Name)); // todo optimize
 		}
 		PendingRemoveItems.clear();
+
+		// Recording skips expired items, the layers are only changed between frames
+		for (auto& items : RenderLayers | std::views::values)
+		{
+			std::erase_if(items, [](const auto& Item) { return Item.expired(); });
+		}
 	}
 }
 
 void OEngine::TryRebuildFrameResource()
 {
-	LOG(Engine, Log, "Engine::RebuildFrameResource")
-	if (CurrentNumMaterials != MaterialManager->GetNumMaterials() || CurrentNumInstances * InstanceBufferMultiplier < GetTotalNumberOfInstances())
+	const bool bRebuild = CurrentNumMaterials != MaterialManager->GetNumMaterials() || CurrentNumLights < LightComponents.size();
+	if (!bRebuild && InstanceCapacity >= GetTotalNumberOfInstances())
+	{
+		return;
+	}
+
+	// The frame waiting to be recorded points at the buffers that are about to be replaced
+	FramePipeline.Drain([this](uint32_t FrameIndex) { Render(FrameIndex); });
+	if (bRebuild)
 	{
+		LOG(Engine, Log, "Engine::RebuildFrameResource")
 		RebuildFrameResource(PassCount);
 	}
+	else
+	{
+		GrowInstanceBuffers();
+	}
+}
+
+void OEngine::GrowInstanceBuffers()
+{
+	PROFILE_SCOPE();
+
+	// Doubling keeps the number of reallocations logarithmic while instances are spawned
+	InstanceCapacity = std::max(InstanceCapacity * 2, GetTotalNumberOfInstances() * InstanceBufferMultiplier);
+	LOG(Engine, Log, "Growing instance buffers to {} instances", TEXT(InstanceCapacity));
+	for (const auto& frame : FrameResources)
+	{
+		frame->RebuildInstanceBuffers(InstanceCapacity, UploadManager.get());
+	}
+	OnFrameResourceChanged.Broadcast();
 }
 
 void OEngine::UpdateBoundingSphere()
@@ -615,29 +734,36 @@ void OEngine::RebuildFrameResource(uint32_t Count)
 {
 	PassCount = Count;
 
-	CurrentNumInstances = GetTotalNumberOfInstances();
+	InstanceCapacity = GetTotalNumberOfInstances() * InstanceBufferMultiplier;
 	CurrentNumMaterials = MaterialManager->GetNumMaterials();
+	CurrentNumLights = GetLightComponentsCount();
 
 	for (const auto& frame : FrameResources)
 	{
 		frame->SetPass(PassCount);
-		frame->RebuildInstanceBuffers(CurrentNumInstances * InstanceBufferMultiplier);
+		frame->RebuildInstanceBuffers(InstanceCapacity, UploadManager.get());
 		frame->SetMaterials(CurrentNumMaterials);
-		frame->SetDirectionalLight(GetLightComponentsCount());
-		frame->SetPointLight(GetLightComponentsCount());
-		frame->SetSpotLight(GetLightComponentsCount());
+		frame->SetDirectionalLight(CurrentNumLights);
+		frame->SetPointLight(CurrentNumLights);
+		frame->SetSpotLight(CurrentNumLights);
 		frame->SetSSAO();
 		frame->SetFrusturmCorners();
 	}
+
+	// Rebuilt light buffers are empty
+	for (const auto light : LightComponents)
+	{
+		light->NumFramesDirty = SRenderConstants::NumFrameResources;
+	}
 	OnFrameResourceChanged.Broadcast();
 }
 
-void OEngine::SetDescriptorHeap(EResourceHeapType Type)
+void OEngine::SetDescriptorHeap(EResourceHeapType Type, OCommandQueue* Queue)
 {
 	switch (Type)
 	{
 	case EResourceHeapType::Default:
-		GetCommandQueue()->SetHeap(&DefaultGlobalHeap);
+		(Queue ? Queue : GetCommandQueue())->SetHeap(&DefaultGlobalHeap);
 		break;
 	}
 }
@@ -652,48 +778,109 @@ void OEngine::Draw(UpdateEventArgs& Args)
 	PROFILE_SCOPE()
 	if (HasInitializedTests)
 	{
+		// Neither pipeline stage runs here, this is where the scene, the UI and the frame resources may change
+		SessionReplay.BeginFrame(this, Args.Timer.GetDeltaTime());
+		Args.IsUIInfocus = UIManager.lock()->IsInFocus();
+		TickTimer = Args.Timer;
 		RemoveRenderItems();
-		DirectCommandQueue->TryResetCommandList();
-		SetDescriptorHeap(EResourceHeapType::Default);
-		Update(Args);
-		Render(Args);
+		if (ReloadShadersRequested)
+		{
+			RenderGraph->ReloadShaders();
+			ReloadShadersRequested = false;
+		}
+		TryRebuildFrameResource();
+		UpdateFrameResource();
+		RenderGraph->PrepareFrame();
+		FramePipeline.Tick([this, &Args](uint32_t FrameIndex) { Update(Args, FrameIndex); }, [this](uint32_t FrameIndex) { Render(FrameIndex); });
+		SessionReplay.EndFrame(this);
 	}
+	OFrameProfiler::Get().EndFrame();
 }
 
-void OEngine::Render(UpdateEventArgs& Args)
+void OEngine::Render(uint32_t FrameIndex)
 {
 	PROFILE_SCOPE()
-	auto manager = UIManager.lock();
-
-	Args.IsUIInfocus = manager->IsInFocus();
-
-	TickTimer = Args.Timer;
+	RecordPacket = &FramePackets[FrameIndex];
+	CurrentFrameResourceIndex = FrameIndex;
+	CurrentFrameResource = FrameResources[FrameIndex].get();
+	DirectCommandQueue->TryResetCommandList();
+	SetDescriptorHeap(EResourceHeapType::Default);
 	RenderGraph->Execute();
 	DirectCommandQueue->ResetQueueState();
+
+	// Descriptors freed since the last frame was submitted are only referenced by this frame and the ones before it
+	TextureDescriptors.EndFrame(CurrentFrameResource->Fence);
 }
 
-void OEngine::Update(UpdateEventArgs& Args)
+void OEngine::Update(UpdateEventArgs& Args, uint32_t FrameIndex)
 {
-	auto manager = UIManager.lock();
 	PROFILE_SCOPE()
-	Args.IsUIInfocus = manager->IsInFocus();
+	UpdatePacket = &FramePackets[FrameIndex];
 	OnUpdate(Args);
 	SceneManager->Update(Args);
+
+	// Shadow maps hand over what has to be drawn, the record stage never reads their culling state
+	UpdatePacket->ShadowMaps.clear();
+	for (const auto& weak : ShadowMaps)
+	{
+		SShadowMapDraw draw;
+		if (const auto map = weak.lock(); map && map->FillDraw(draw))
+		{
+			UpdatePacket->ShadowMaps.push_back(std::move(draw));
+		}
+	}
+	FillRenderItemDraws();
+#if ENABLE_DEBUG_DRAW
+	DebugDraw.CollectVertices(UpdatePacket->DebugVertices);
+#endif
+}
+
+void OEngine::FillRenderItemDraws()
+{
+	PROFILE_SCOPE()
+
+	// Layers and items change while the previous frame is recorded, the record stage draws the copies
+	for (auto& draws : UpdatePacket->RenderLayers | std::views::values)
+	{
+		draws.clear();
+	}
+	for (const auto& [layer, items] : RenderLayers)
+	{
+		auto& draws = UpdatePacket->RenderLayers[layer];
+		draws.reserve(items.size());
+		for (const auto& weak : items)
+		{
+			const auto item = weak.lock();
+			if (!item)
+			{
+				continue;
+			}
+			auto& draw = draws.emplace_back();
+			draw.Item = item;
+			draw.Geometry = item->Geometry;
+			draw.Submesh = item->ChosenSubmesh;
+			draw.Name = item->Name;
+			draw.NumInstances = static_cast<UINT>(item->Instances.size());
+			draw.bValid = item->IsValidChecked();
+		}
+	}
 }
 
 void OEngine::UpdateFrameResource()
 {
 	PROFILE_SCOPE()
-	CurrentFrameResourceIndex = (CurrentFrameResourceIndex + 1) % SRenderConstants::NumFrameResources;
-	CurrentFrameResource = FrameResources[CurrentFrameResourceIndex].get();
+	UpdatingFrameResourceIndex = FramePipeline.GetNextUpdateSlot();
+	UpdatingFrameResource = FrameResources[UpdatingFrameResourceIndex].get();
 
-	// Has the GPU finished processing the commands of the current frame
-	// resource. If not, wait until the GPU has completed commands up to
-	// this fence point.
-	if (CurrentFrameResource->Fence != 0 && GetCommandQueue()->GetFence()->GetCompletedValue() < CurrentFrameResource->Fence)
+	// Has the GPU finished processing the commands of the frame resource
+	// the update writes next. If not, wait until the GPU has completed
+	// commands up to this fence point.
+	if (UpdatingFrameResource->Fence != 0 && GetCommandQueue()->GetFence()->GetCompletedValue() < UpdatingFrameResource->Fence)
 	{
-		GetCommandQueue()->WaitForFenceValue(CurrentFrameResource->Fence);
+		GetCommandQueue()->WaitForFenceValue(UpdatingFrameResource->Fence);
 	}
+	TextureDescriptors.Retire(GetCommandQueue()->GetFence()->GetCompletedValue());
+	UploadManager->Retire();
 }
 
 void OEngine::InitRenderGraph()
@@ -704,7 +891,13 @@ void OEngine::InitRenderGraph()
 
 uint32_t OEngine::GetLightComponentsCount() const
 {
-	return 10; // todo fix
+	// Light buffers grow in powers of two, the shaders only touch the lights of their cluster
+	return std::max<uint32_t>(SRenderConstants::MaxLights, std::bit_ceil(static_cast<uint32_t>(LightComponents.size())));
+}
+
+const vector<OLightComponent*>& OEngine::GetLightComponents() const
+{
+	return LightComponents;
 }
 
 void OEngine::CheckRaytracingSupport()
@@ -729,18 +922,15 @@ IDXGIFactory4* OEngine::GetFactory()
 
 void OEngine::UpdateCameraCB()
 {
-	for (auto& frame : FrameResources)
-	{
-		HLSL::CameraMatrixBuffer cb;
-		auto camera = Window->GetCamera().lock();
-		const auto view = camera->GetView();
-		const auto proj = camera->GetProj();
-		const auto viewProj = XMMatrixMultiply(view, proj);
-		const auto invViewProj = Inverse(viewProj);
-		Put(cb.gCamViewProj, Transpose(viewProj));
-		Put(cb.gCamInvViewProj, Transpose(invViewProj));
-		frame->CameraMatrixBuffer->CopyData(0, cb);
-	}
+	HLSL::CameraMatrixBuffer cb;
+	auto camera = Window->GetCamera().lock();
+	const auto view = camera->GetView();
+	const auto proj = camera->GetProj();
+	const auto viewProj = XMMatrixMultiply(view, proj);
+	const auto invViewProj = Inverse(viewProj);
+	Put(cb.gCamViewProj, Transpose(viewProj));
+	Put(cb.gCamInvViewProj, Transpose(invViewProj));
+	UpdatingFrameResource->CameraMatrixBuffer->CopyData(0, cb);
 }
 
 weak_ptr<OUIManager> OEngine::GetUIManager() const
@@ -756,7 +946,7 @@ void OEngine::RemoveRenderObject(TUUID UUID)
 
 void OEngine::UpdateObjectCB() const
 {
-	auto res = CurrentFrameResource->PassCB.get();
+	auto res = UpdatingFrameResource->PassCB.get();
 
 	int32_t idx = 1; // TODO calc frame resource automatically and calc frame resources
 	for (auto& val : RenderObjects | std::views::values)
@@ -781,46 +971,117 @@ void OEngine::UpdateObjectCB() const
 	}
 }
 
-void OEngine::RemoveItemInstances(UpdateEventArgs& Args)
+void OEngine::UpdateInstanceLifetimes(const UpdateEventArgs& Args)
 {
-	for (const auto& item : AllRenderItems)
+	PROFILE_SCOPE();
+	const float deltaTime = Args.Timer.GetDeltaTime();
+	for (auto it = TimedRenderItems.begin(); it != TimedRenderItems.end();)
 	{
-		item->Update(Args);
-		for (auto it = item->Instances.begin(); it != item->Instances.end();)
+		auto item = *it;
+		auto& instances = item->Instances;
+		bool bHasTimedInstances = false;
+		for (size_t i = 0; i < instances.size();)
 		{
-			if (it->Lifetime.has_value())
+			auto& lifetime = instances[i].Lifetime;
+			if (!lifetime.has_value())
 			{
-				it->Lifetime = it->Lifetime.value() - Args.Timer.GetDeltaTime();
-				if (it->Lifetime.value() <= 0)
-				{
-					it = item->Instances.erase(it);
-					if (item->Instances.empty())
-					{
-						PendingRemoveItems.insert(item);
-					}
-					continue;
-				}
+				i++;
+				continue;
+			}
+
+			*lifetime -= deltaTime;
+			if (*lifetime > 0)
+			{
+				bHasTimedInstances = true;
+				i++;
+				continue;
+			}
+
+			// Instance order is not kept, the last instance takes the place of the expired one
+			ReleaseTransformNode(instances[i].TransformNode);
+			if (i + 1 < instances.size())
+			{
+				instances[i] = std::move(instances.back());
+			}
+			instances.pop_back();
+			if (item->bRegistered)
+			{
+				OnInstanceCountChanged(-1);
 			}
-			++it;
 		}
-		//LOG(Render, Log, "Removed instances from item: {}", TEXT(item->Name));
+
+		if (instances.empty())
+		{
+			const auto owner = std::ranges::find_if(AllRenderItems, [item](const auto& Other) { return Other.get() == item; });
+			if (owner != AllRenderItems.end())
+			{
+				PendingRemoveItems.insert(*owner);
+			}
+		}
+		it = bHasTimedInstances ? std::next(it) : TimedRenderItems.erase(it);
+	}
+}
+
+void OEngine::UpdateComponents(const UpdateEventArgs& Args)
+{
+	PROFILE_SCOPE();
+
+	// One pass per component type, the light classes are final so the calls are resolved statically
+	for (const auto light : DirectionalLightPool)
+	{
+		light->Tick(Args);
+	}
+	for (const auto light : PointLightPool)
+	{
+		light->Tick(Args);
+	}
+	for (const auto light : SpotLightPool)
+	{
+		light->Tick(Args);
 	}
 }
 
+void OEngine::TrackInstanceLifetimes(ORenderItem* Item)
+{
+	TimedRenderItems.insert(Item);
+}
+
 void OEngine::OnUpdate(UpdateEventArgs& Args)
 {
 	PROFILE_SCOPE();
 
-	RemoveItemInstances(Args);
+#if ENABLE_DEBUG_DRAW
+	// Before anything queues the debug primitives of this frame
+	DebugDraw.Tick(Args.Timer.GetDeltaTime());
+	SessionReplay.ApplyDebugDraw();
+#endif
+
+	// Before the components tick so they see this frame's transforms
+	UpdateAnimations(Args);
+	UpdateTransforms();
+	UpdateComponents(Args);
+	UpdateInstanceLifetimes(Args);
 	UpdateBoundingSphere();
-	TryRebuildFrameResource();
-	UpdateFrameResource();
 
-	if (CurrentFrameResource)
+	if (UpdatingFrameResource)
 	{
 		auto camera = Window->GetCamera().lock();
-		CameraRenderedItems = PerformFrustumCulling(&camera->GetFrustum(), Inverse(camera->GetView()), CameraInstanceBufferID);
-
+		UpdateOcclusionCulling();
+
+		SLODSelection lodSelection;
+		lodSelection.EyePosition = camera->GetPosition3f();
+		lodSelection.ProjScale = camera->GetProj4x4f()._22;
+		lodSelection.ViewportHeight = static_cast<float>(Window->GetHeight());
+		lodSelection.PixelError = LODPixelError;
+		lodSelection.Hysteresis = LODHysteresis;
+		UpdatePacket->CameraRenderedItems = PerformFrustumCulling(&camera->GetFrustum(),
+		                                                          Inverse(camera->GetView()),
+		                                                          CameraInstanceBufferID,
+		                                                          bOcclusionCullingEnabled ? &OcclusionCuller : nullptr,
+		                                                          bLODEnabled ? &lodSelection : nullptr);
+
+		UpdateLightSlots();
+		UpdateClusteredLighting();
 		UpdateMainPass(Args.Timer);
 		UpdateMaterialCB();
 		UpdateObjectCB();
@@ -833,11 +1094,6 @@ void OEngine::OnUpdate(UpdateEventArgs& Args)
 	{
 		val->Update(Args);
 	}
-	if (ReloadShadersRequested)
-	{
-		RenderGraph->ReloadShaders();
-		ReloadShadersRequested = false;
-	}
 }
 
 void OEngine::UpdateSSAOCB()
@@ -870,7 +1126,7 @@ void OEngine::UpdateSSAOCB()
 	constants.OcclusionFadeStart = ssao->OcclusionFadeStart;
 	constants.OcclusionFadeEnd = ssao->OcclusionFadeEnd;
 	constants.SurfaceEpsilon = ssao->SurfaceEpsilon;
-	CurrentFrameResource->SsaoCB->CopyData(0, constants);
+	UpdatingFrameResource->SsaoCB->CopyData(0, constants);
 }
 
 void OEngine::DestroyWindow()
@@ -884,62 +1140,32 @@ void OEngine::OnWindowDestroyed()
 
 void OEngine::DrawDebugBox(DirectX::XMFLOAT3 Center, DirectX::XMFLOAT3 Extents, DirectX::XMFLOAT4 Orientation, SColor Color, float Duration)
 {
-	auto world = BuildWorldMatrix(Center, Extents, Orientation);
-
-	SInstanceData data;
-	data.HlslData.OverrideColor = Color.ToFloat3();
-	data.HlslData.Position = Center;
-	data.HlslData.Scale = Extents;
-	data.HlslData.Rotation = Orientation;
-	Put(data.HlslData.World, world);
-	data.Lifetime = Duration;
-	data.HlslData.BoundingBoxCenter = Center;
-	data.HlslData.BoundingBoxExtents = Extents;
-	if (DebugBoxRenderItem.expired())
-	{
-		SRenderItemParams params;
-		params.OverrideLayer = SRenderLayers::DebugBox;
-		params.bFrustumCoolingEnabled = false;
-		params.Lifetime = Duration;
-		DebugBoxRenderItem = CreateBoxRenderItem("Debug_Box", params);
-		return;
+	SessionReplay.RecordDebugBox(Center, Extents, Orientation, Color, Duration);
+	if (SessionReplay.AcceptsLiveInput())
+	{
+		DEBUG_DRAW(Box(Center, Extents, Orientation, Color, Duration));
 	}
-	DebugBoxRenderItem.lock()->AddInstance(data);
-	LOG(Render, Log, "Added debug box instance")
 }
 
-void OEngine::DrawDebugFrustum(const DirectX::XMFLOAT4X4& InvViewProjection, const SColor Color, float Duration)
+void OEngine::DrawDebugFrustum(const DirectX::XMFLOAT4X4& InvViewProjection, SColor Color, float Duration)
 {
-	auto world = BuildWorldMatrix(XMFLOAT3(0, 0, 0), XMFLOAT3(1, 1, 1), XMFLOAT4(0, 0, 0, 0));
-
-	SInstanceData data;
-	data.HlslData.OverrideColor = Color.ToFloat3();
-	data.HlslData.Position = XMFLOAT3(0, 0, 0);
-	data.HlslData.Scale = XMFLOAT3(1, 1, 1);
-	data.HlslData.Rotation = XMFLOAT4(0, 0, 0, 0);
-	Put(data.HlslData.World, world);
-	data.Lifetime = Duration;
-	data.HlslData.BoundingBoxCenter = XMFLOAT3(0, 0, 0);
-	data.HlslData.BoundingBoxExtents = XMFLOAT3(1, 1, 1);
-	data.HlslData.InvViewProjection = InvViewProjection;
-	if (DebugFrustumRenderItem.expired())
+	SessionReplay.RecordDebugFrustum(InvViewProjection, Color, Duration);
+	if (SessionReplay.AcceptsLiveInput())
 	{
-		SRenderItemParams params;
-		params.OverrideLayer = SRenderLayers::FrustumDebug;
-		params.bFrustumCoolingEnabled = false;
-		params.Lifetime = Duration;
-		DebugFrustumRenderItem = CreateBoxRenderItem("Debug_Frustum", params);
-		return;
+		DEBUG_DRAW(Frustum(InvViewProjection, Color, Duration));
 	}
-	DebugFrustumRenderItem.lock()->AddInstance(data);
-	LOG(Render, Log, "Added debug frustum instance")
 }
 
 void OEngine::OnKeyPressed(KeyEventArgs& Args)
 {
+	if (!SessionReplay.AcceptsLiveInput())
+	{
+		return;
+	}
 	auto manager = UIManager.lock();
 
 	Args.IsUIInfocus = manager->IsInFocus();
+	SessionReplay.RecordKey(Args);
 	auto window = GetWindowByHWND(Args.WindowHandle);
 	if (!window.expired())
 	{
@@ -951,9 +1177,14 @@ void OEngine::OnKeyPressed(KeyEventArgs& Args)
 
 void OEngine::OnKeyReleased(KeyEventArgs& Args)
 {
+	if (!SessionReplay.AcceptsLiveInput())
+	{
+		return;
+	}
 	auto manager = UIManager.lock();
 
 	Args.IsUIInfocus = manager->IsInFocus();
+	SessionReplay.RecordKey(Args);
 	auto window = GetWindowByHWND(Args.WindowHandle);
 	if (!window.expired())
 	{
@@ -964,9 +1195,14 @@ void OEngine::OnKeyReleased(KeyEventArgs& Args)
 
 void OEngine::OnMouseMoved(MouseMotionEventArgs& Args)
 {
+	if (!SessionReplay.AcceptsLiveInput())
+	{
+		return;
+	}
 	auto manager = UIManager.lock();
 
 	Args.IsUIInfocus = manager->IsInFocus();
+	SessionReplay.RecordMouseMove(Args);
 	const auto window = GetWindowByHWND(Args.WindowHandle);
 	if (!window.expired())
 	{
@@ -976,8 +1212,13 @@ void OEngine::OnMouseMoved(MouseMotionEventArgs& Args)
 
 void OEngine::OnMouseButtonPressed(MouseButtonEventArgs& Args)
 {
+	if (!SessionReplay.AcceptsLiveInput())
+	{
+		return;
+	}
 	auto manager = UIManager.lock();
 	Args.IsUIInfocus = manager->IsInFocus();
+	SessionReplay.RecordMouseButton(Args);
 	manager->OnMouseButtonPressed(Args);
 	const auto window = GetWindowByHWND(Args.WindowHandle);
 	if (!window.expired())
@@ -988,8 +1229,13 @@ void OEngine::OnMouseButtonPressed(MouseButtonEventArgs& Args)
 
 void OEngine::OnMouseButtonReleased(MouseButtonEventArgs& Args)
 {
+	if (!SessionReplay.AcceptsLiveInput())
+	{
+		return;
+	}
 	auto manager = UIManager.lock();
 	Args.IsUIInfocus = manager->IsInFocus();
+	SessionReplay.RecordMouseButton(Args);
 	manager->OnMouseButtonReleased(Args);
 	const auto window = GetWindowByHWND(Args.WindowHandle);
 	if (!window.expired())
@@ -1001,6 +1247,11 @@ void OEngine::OnMouseButtonReleased(MouseButtonEventArgs& Args)
 void OEngine::OnMouseWheel(MouseWheelEventArgs& Args)
 {
 	LOG(Engine, Log, "Engine::OnMouseWheel")
+	if (!SessionReplay.AcceptsLiveInput())
+	{
+		return;
+	}
+	SessionReplay.RecordMouseWheel(Args);
 	UIManager.lock()->OnMouseWheel(Args);
 	const auto window = GetWindowByHWND(Args.WindowHandle);
 	if (!window.expired())
@@ -1053,10 +1304,14 @@ void OEngine::OnResizeRequest(HWND& WindowHandle)
 	{
 		SSAORT.lock()->OnResize(args);
 	}
+
+	// The filters declared their new targets, place them all at once
+	TransientResources->Compile();
 }
 
 void OEngine::OnUpdateWindowSize(ResizeEventArgs& Args)
 {
+	SessionReplay.RecordResize(Args);
 	const auto window = GetWindowByHWND(Args.WindowHandle);
 	window.lock()->OnUpdateWindowSize(Args);
 }
@@ -1071,6 +1326,11 @@ weak_ptr<OSSAORenderTarget> OEngine::GetSSAORT() const
 	return SSAORT;
 }
 
+weak_ptr<OClusteredLighting> OEngine::GetClusteredLighting() const
+{
+	return ClusteredLighting;
+}
+
 void OEngine::CreateWindow()
 {
 	Window = OApplication::Get()->CreateWindow();
@@ -1105,53 +1365,55 @@ OUploadBuffer<HLSL::InstanceData>* OEngine::GetCurrentFrameInstBuffer(const TUUI
 	return nullptr;
 }
 
+OUploadBuffer<HLSL::InstanceExtraData>* OEngine::GetCurrentFrameInstExtraBuffer(const TUUID& Id) const
+{
+	if (CurrentFrameResource && CurrentFrameResource->InstanceExtraBuffers.contains(Id))
+	{
+		return CurrentFrameResource->InstanceExtraBuffers.at(Id).get();
+	}
+	return nullptr;
+}
+
+OUploadBuffer<HLSL::InstanceData>* OEngine::GetUpdatingFrameInstBuffer(const TUUID& Id) const
+{
+	if (UpdatingFrameResource && UpdatingFrameResource->InstanceBuffers.contains(Id))
+	{
+		return UpdatingFrameResource->InstanceBuffers.at(Id).get();
+	}
+	return nullptr;
+}
+
+OUploadBuffer<HLSL::InstanceExtraData>* OEngine::GetUpdatingFrameInstExtraBuffer(const TUUID& Id) const
+{
+	if (UpdatingFrameResource && UpdatingFrameResource->InstanceExtraBuffers.contains(Id))
+	{
+		return UpdatingFrameResource->InstanceExtraBuffers.at(Id).get();
+	}
+	return nullptr;
+}
+
 void OEngine::FillDescriptorHeaps()
 {
 	PROFILE_SCOPE();
-	// Textures, SRV offset only
-	uint32_t texturesCounter = 0;
-	auto whiteTex = TextureManager->FindTextureByName("white1x1");
-	auto buildSRV = [&, whiteTex](STexture* Texture) {
-		Texture = Texture ? Texture : whiteTex;
-		auto pair = DefaultGlobalHeap.SRVHandle.Offset();
-		auto resourceSRV = Texture->GetSRVDesc();
-		LOG(Render, Log, "Building SRV for texture: {} of type {} at srv address {} ", TEXT(Texture->Name), TEXT(Texture->Type), TEXT(pair.Index));
-		Device->GetDevice()->CreateShaderResourceView(Texture->Resource.Resource.Get(), &resourceSRV, pair.CPUHandle);
-		Texture->TextureIndex = texturesCounter;
-		Texture->SRV = pair;
-		texturesCounter++;
-	};
-
-	auto build2DTextures = [&]() {
-		for (auto& texture : TextureManager->GetTextures() | std::views::values)
-		{
-			if (texture->ViewType != STextureViewType::Texture2D)
-			{
-				continue;
-			}
-			buildSRV(texture.get());
-		}
-		while (texturesCounter < TEXTURE_MAPS_NUM)
-		{
-			buildSRV(nullptr);
-		}
-	};
+	// Textures live in the bindless region at the start of the heap, the transient ring follows it
+	TexturesStartAddress = DefaultGlobalHeap.SRVHandle.Offset(TEXTURE_MAPS_NUM + SRenderConstants::NumTransientSRVs);
+	TextureDescriptors.Init(TexturesStartAddress.Index, TEXTURE_MAPS_NUM, SRenderConstants::NumTransientSRVs);
 
-	auto build3DTextures = [&]() {
-		for (const auto& texture : TextureManager->GetTextures() | std::views::values)
+	// white1x1 takes index 0 which the shaders read as a disabled map, the slots not in use sample it as well
+	auto whiteTex = TextureManager->FindTextureByName("white1x1");
+	if (whiteTex && AddTextureDescriptor(whiteTex))
+	{
+		const auto whiteSRV = whiteTex->GetSRVDesc();
+		for (uint32_t idx = 1; idx < TEXTURE_MAPS_NUM; idx++)
 		{
-			if (texture->ViewType == STextureViewType::Texture2D)
-			{
-				continue;
-			}
-			buildSRV(texture.get());
+			Device->GetDevice()->CreateShaderResourceView(whiteTex->Resource.Resource.Get(), &whiteSRV, GetGlobalSRV(TexturesStartAddress.Index + idx).CPUHandle);
 		}
-	};
+	}
 
-	auto handle = DefaultGlobalHeap.SRVHandle;
-	TexturesStartAddress = handle.Offset();
-	build2DTextures();
-	build3DTextures();
+	for (auto& texture : TextureManager->GetTextures() | std::views::values)
+	{
+		AddTextureDescriptor(texture.get());
+	}
 
 	std::ranges::for_each(RenderGroups, [&](const auto& objects) {
 		if (objects.first == ERenderGroup::None)
@@ -1202,17 +1464,35 @@ unordered_set<weak_ptr<ORenderItem>>& OEngine::GetRenderItems(const string& Type
 
 void OEngine::AddRenderItem(string Category, shared_ptr<ORenderItem> RenderItem)
 {
+	if (RenderItem->bStaticShadowCaster)
+	{
+		InvalidateStaticShadowCasters();
+	}
 	RenderLayers[Category].insert(RenderItem);
-	AllRenderItems.insert(move(RenderItem));
+	RegisterRenderItem(move(RenderItem));
 }
 
 void OEngine::AddRenderItem(const vector<string>& Categories, const shared_ptr<ORenderItem>& RenderItem)
 {
+	if (RenderItem->bStaticShadowCaster)
+	{
+		InvalidateStaticShadowCasters();
+	}
 	for (auto category : Categories)
 	{
 		RenderLayers[category].insert(RenderItem);
 	}
-	AllRenderItems.insert(RenderItem);
+	RegisterRenderItem(RenderItem);
+}
+
+void OEngine::RegisterRenderItem(shared_ptr<ORenderItem> RenderItem)
+{
+	if (!RenderItem->bRegistered)
+	{
+		RenderItem->bRegistered = true;
+		OnInstanceCountChanged(static_cast<int64_t>(RenderItem->Instances.size()));
+	}
+	AllRenderItems.insert(move(RenderItem));
 }
 
 void OEngine::MoveRIToNewLayer(weak_ptr<ORenderItem> Item, const SRenderLayer& NewLayer, const SRenderLayer& OldLayer)
@@ -1303,7 +1583,7 @@ void OEngine::Pick(int32_t SX, int32_t SY)
 		}
 
 		auto geometry = item.lock()->Geometry;
-		auto world = XMLoadFloat4x4(&item.lock()->Instances[0].HlslData.World);
+		auto world = XMLoadFloat4x4(&item.lock()->Instances[0].Params.World);
 		auto worldDet = XMMatrixDeterminant(world);
 		auto Invworld = XMMatrixInverse(&worldDet, world);
 
@@ -1326,20 +1606,24 @@ void OEngine::Pick(int32_t SX, int32_t SY)
 		{
 			for (auto& submesh : geometry.lock()->GetDrawArgs() | std::views::values)
 			{
-				auto indices = submesh->Indices.get();
-				auto vertices = submesh->Vertices.get();
-				auto triCount = indices->size() / 3;
+				SCollisionGeometry collision;
+				if (!submesh->GetCollisionGeometry(collision, CollisionPositions, CollisionIndices))
+				{
+					continue;
+				}
+				auto triCount = collision.NumIndices / 3;
+				auto positions = reinterpret_cast<const XMFLOAT3*>(collision.Positions);
 
 				tmin = INFINITE;
 				for (size_t i = 0; i < triCount; i++)
 				{
-					auto i0 = indices->at(i * 3);
-					auto i1 = indices->at(i * 3 + 1);
-					auto i2 = indices->at(i * 3 + 2);
+					auto i0 = collision.Indices[i * 3];
+					auto i1 = collision.Indices[i * 3 + 1];
+					auto i2 = collision.Indices[i * 3 + 2];
 
-					auto v0 = XMLoadFloat3(&vertices->at(i0));
-					auto v1 = XMLoadFloat3(&vertices->at(i1));
-					auto v2 = XMLoadFloat3(&vertices->at(i2));
+					auto v0 = XMLoadFloat3(&positions[i0]);
+					auto v1 = XMLoadFloat3(&positions[i1]);
+					auto v2 = XMLoadFloat3(&positions[i2]);
 
 					if (float t = 0.0f; TriangleTests::Intersects(origin, dir, v0, v1, v2, t))
 					{
@@ -1373,6 +1657,67 @@ D3D12_GPU_DESCRIPTOR_HANDLE OEngine::GetSRVDescHandleForTexture(STexture* Textur
 	return Texture->SRV.GPUHandle;
 }
 
+bool OEngine::AddTextureDescriptor(STexture* Texture)
+{
+	// Textures created before the heaps are filled get their index in FillDescriptorHeaps
+	if (!Texture || !TextureDescriptors.IsInitialized())
+	{
+		return false;
+	}
+	if (TextureDescriptors.IsValid(Texture->DescriptorID))
+	{
+		return true;
+	}
+
+	const auto id = TextureDescriptors.Allocate();
+	if (!TextureDescriptors.IsValid(id))
+	{
+		LOG(Render, Error, "No free bindless texture slot for {}", TEXT(Texture->Name));
+		return false;
+	}
+
+	const auto pair = GetGlobalSRV(TextureDescriptors.GetIndex(id));
+	const auto resourceSRV = Texture->GetSRVDesc();
+	LOG(Render, Log, "Building SRV for texture: {} of type {} at srv address {} ", TEXT(Texture->Name), TEXT(Texture->Type), TEXT(pair.Index));
+	Device->GetDevice()->CreateShaderResourceView(Texture->Resource.Resource.Get(), &resourceSRV, pair.CPUHandle);
+	Texture->DescriptorID = id;
+	Texture->TextureIndex = pair.Index - TextureDescriptors.GetBaseIndex();
+	Texture->SRV = pair;
+	return true;
+}
+
+void OEngine::RemoveTextureDescriptor(STexture* Texture)
+{
+	if (!Texture || !TextureDescriptors.IsValid(Texture->DescriptorID))
+	{
+		return;
+	}
+	TextureDescriptors.Free(Texture->DescriptorID);
+	Texture->DescriptorID = {};
+	Texture->TextureIndex = -1;
+	Texture->SRV = {};
+}
+
+SDescriptorPair OEngine::AllocateTransientSRV(uint32_t Count)
+{
+	const auto index = TextureDescriptors.AllocateTransient(Count);
+	if (index == ODescriptorAllocator::InvalidIndex)
+	{
+		LOG(Render, Error, "Transient descriptor ring is full, {} descriptors requested", TEXT(Count));
+		return {};
+	}
+	return GetGlobalSRV(index);
+}
+
+SDescriptorPair OEngine::GetGlobalSRV(uint32_t Index) const
+{
+	SDescriptorPair pair;
+	pair.CPUHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(DefaultGlobalHeap.SRVHeap->GetCPUDescriptorHandleForHeapStart(), Index, CBVSRVUAVDescriptorSize);
+	pair.GPUHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(DefaultGlobalHeap.SRVHeap->GetGPUDescriptorHandleForHeapStart(), Index, CBVSRVUAVDescriptorSize);
+	pair.Index = Index;
+	return pair;
+}
+
 D3D12_GPU_DESCRIPTOR_HANDLE OEngine::GetSRVDescHandle(int64_t Index) const
 {
 	auto desc = DefaultGlobalHeap.SRVHeap->GetGPUDescriptorHandleForHeapStart();
@@ -1385,6 +1730,28 @@ OMeshGenerator* OEngine::GetMeshGenerator() const
 	return MeshGenerator.get();
 }
 
+OUploadManager* OEngine::GetUploadManager() const
+{
+	return UploadManager.get();
+}
+
+OTransientResourcePool* OEngine::GetTransientResources() const
+{
+	return TransientResources.get();
+}
+
+#if ENABLE_DEBUG_DRAW
+ODebugDraw* OEngine::GetDebugDraw()
+{
+	return &DebugDraw;
+}
+#endif
+
+OSessionReplay* OEngine::GetSessionReplay()
+{
+	return &SessionReplay;
+}
+
 void OEngine::TryUpdateGeometry()
 {
 	if (GeometryToRebuild.has_value())
@@ -1414,20 +1781,238 @@ OEngine::TRenderLayer& OEngine::GetRenderLayers()
 	return RenderLayers;
 }
 
-SCulledInstancesInfo OEngine::PerformFrustumCulling(IBoundingGeometry* BoundingGeometry, const DirectX::XMMATRIX& ViewMatrix, const TUUID& BufferId) const
+namespace
+{
+SOcclusionMatrix ToOcclusionMatrix(const XMMATRIX& Matrix)
+{
+	static_assert(sizeof(SOcclusionMatrix) == sizeof(XMFLOAT4X4));
+	XMFLOAT4X4 stored;
+	XMStoreFloat4x4(&stored, Matrix);
+	SOcclusionMatrix result;
+	std::memcpy(result.M, stored.m, sizeof(result.M));
+	return result;
+}
+
+uint8_t SelectLOD(const SSubmeshGeometry& Submesh, const BoundingBox& Bounds, const XMMATRIX& World, uint8_t Current, const SLODSelection& Selection)
+{
+	const float scale = std::max({ XMVectorGetX(XMVector3Length(World.r[0])), XMVectorGetX(XMVector3Length(World.r[1])), XMVectorGetX(XMVector3Length(World.r[2])) });
+	const float radius = XMVectorGetX(XMVector3Length(XMLoadFloat3(&Bounds.Extents))) * scale;
+	const auto center = XMVector3Transform(XMLoadFloat3(&Bounds.Center), World);
+	const float distance = XMVectorGetX(XMVector3Length(XMVectorSubtract(center, XMLoadFloat3(&Selection.EyePosition)))) - radius;
+	if (distance <= 0.0f)
+	{
+		return 0;
+	}
+
+	// Errors are relative to the radius, scaling them by the projected sphere gives pixels
+	const float screenSize = radius * Selection.ProjScale / distance;
+	const float pixelsPerError = screenSize * Selection.ViewportHeight * 0.5f;
+	for (size_t lod = Submesh.LODs.size(); lod > 0; lod--)
+	{
+		const float threshold = lod > Current ? Selection.PixelError * (1.0f - Selection.Hysteresis) : Selection.PixelError;
+		if (Submesh.LODs[lod - 1].Error * pixelsPerError <= threshold)
+		{
+			return static_cast<uint8_t>(lod);
+		}
+	}
+	return 0;
+}
+
+SLocalTransform ToLocalTransform(const XMFLOAT3& Position, const XMFLOAT4& Rotation, const XMFLOAT3& Scale)
+{
+	SLocalTransform local;
+	std::memcpy(local.Position, &Position, sizeof(local.Position));
+	std::memcpy(local.Rotation, &Rotation, sizeof(local.Rotation));
+	std::memcpy(local.Scale, &Scale, sizeof(local.Scale));
+	return local;
+}
+} // namespace
+
+void OEngine::UpdateAnimations(const UpdateEventArgs& Args)
+{
+	AnimationManager->Update(Args.Timer.GetDeltaTime(), TransformHierarchy);
+}
+
+void OEngine::UpdateTransforms()
+{
+	PROFILE_SCOPE();
+	TransformHierarchy.Update();
+	if (TransformHierarchy.GetStats().NumUpdated == 0)
+	{
+		return;
+	}
+
+	static_assert(sizeof(STransformMatrix) == sizeof(XMFLOAT4X4));
+	for (const auto& item : AllRenderItems)
+	{
+		bool bMoved = false;
+		for (auto& instance : item->Instances)
+		{
+			if (TransformHierarchy.IsValid(instance.TransformNode) && TransformHierarchy.WasUpdated(instance.TransformNode))
+			{
+				std::memcpy(instance.Params.World.m, TransformHierarchy.GetWorld(instance.TransformNode).M, sizeof(XMFLOAT4X4));
+				bMoved = true;
+			}
+		}
+		if (bMoved && item->bStaticShadowCaster)
+		{
+			InvalidateStaticShadowCasters();
+		}
+	}
+}
+
+OTransformHierarchy& OEngine::GetTransformHierarchy()
+{
+	return TransformHierarchy;
+}
+
+OGpuProfiler* OEngine::GetGpuProfiler() const
+{
+	return GpuProfiler.get();
+}
+
+void OEngine::SetInstanceTransform(SInstanceData& Instance, const XMFLOAT3& Position, const XMFLOAT4& Rotation, const XMFLOAT3& Scale)
+{
+	Instance.Params.Position = Position;
+	Instance.Params.Rotation = Rotation;
+	Instance.Params.Scale = Scale;
+	if (TransformHierarchy.IsValid(Instance.TransformNode))
+	{
+		// World follows on the next update together with everything attached to the instance
+		TransformHierarchy.SetLocal(Instance.TransformNode, ToLocalTransform(Position, Rotation, Scale));
+	}
+	else
+	{
+		Put(Instance.Params.World, BuildWorldMatrix(Position, Scale, Rotation));
+	}
+}
+
+void OEngine::AttachInstance(const SInstanceData& Child, const SInstanceData& Parent)
+{
+	if (!TransformHierarchy.IsValid(Child.TransformNode) || !TransformHierarchy.IsValid(Parent.TransformNode))
+	{
+		LOG(Engine, Warning, "Cannot attach instances without transform nodes");
+		return;
+	}
+	TransformHierarchy.SetParent(Child.TransformNode, Parent.TransformNode);
+}
+
+void OEngine::PlayInstanceAnimation(const SInstanceData& Instance, const wstring& Name, bool bLoop, float Speed)
+{
+	auto& runtime = AnimationManager->GetRuntime();
+	const uint32_t track = runtime.FindTrack(WStringToUTF8(Name));
+	if (track == OAnimationRuntime::InvalidTrack || !TransformHierarchy.IsValid(Instance.TransformNode))
+	{
+		LOG(Engine, Warning, "Cannot play animation {} on the instance", Name);
+		return;
+	}
+	runtime.Play(track, Instance.TransformNode, bLoop, Speed);
+}
+
+void OEngine::StopInstanceAnimation(const SInstanceData& Instance)
+{
+	AnimationManager->GetRuntime().Stop(Instance.TransformNode);
+}
+
+void OEngine::ReleaseTransformNode(uint32_t Node)
+{
+	AnimationManager->GetRuntime().Stop(Node);
+	TransformHierarchy.Remove(Node);
+}
+
+void OEngine::UpdateOcclusionCulling()
+{
+	PROFILE_SCOPE();
+	OcclusionCuller.Clear();
+	if (!bOcclusionCullingEnabled)
+	{
+		return;
+	}
+
+	const auto camera = Window->GetCamera().lock();
+	const auto viewProj = XMMatrixMultiply(camera->GetView(), camera->GetProj());
+	XMStoreFloat4x4(&OcclusionViewProj, viewProj);
+
+	// Opaque meshes covering enough of the screen, the largest ones are rasterized first
+	struct SOccluderCandidate
+	{
+		shared_ptr<SSubmeshGeometry> Submesh;
+		SOcclusionMatrix LocalToClip;
+		float Area;
+	};
+	vector<SOccluderCandidate> candidates;
+	const auto& params = OcclusionCuller.GetParams();
+	for (const auto& item : AllRenderItems)
+	{
+		if (!item->bFrustumCoolingEnabled || item->RenderLayer != SRenderLayers::Opaque)
+		{
+			continue;
+		}
+		const auto submesh = item->ChosenSubmesh.lock();
+		if (!submesh || !submesh->HasCollisionGeometry())
+		{
+			continue;
+		}
+		for (const auto& instance : item->Instances)
+		{
+			const auto localToClip = ToOcclusionMatrix(XMMatrixMultiply(Load(instance.Params.World), viewProj));
+			const float area = OcclusionCuller.GetScreenArea(localToClip, &item->Bounds.Center.x, &item->Bounds.Extents.x);
+			if (area >= params.MinOccluderArea)
+			{
+				candidates.push_back({ submesh, localToClip, area });
+			}
+		}
+	}
+	std::ranges::sort(candidates, std::greater{}, &SOccluderCandidate::Area);
+
+	uint32_t numOccluders = 0;
+	size_t numTriangles = 0;
+	for (const auto& candidate : candidates)
+	{
+		if (numOccluders >= params.MaxOccluders)
+		{
+			break;
+		}
+		if (numTriangles + candidate.Submesh->IndexCount / 3 > params.MaxOccluderTriangles)
+		{
+			continue;
+		}
+
+		// Quantized positions move by half a step at most, far below a pixel of the occlusion buffer
+		SCollisionGeometry collision;
+		candidate.Submesh->GetCollisionGeometry(collision, CollisionPositions, CollisionIndices);
+		OcclusionCuller.RasterizeOccluder(candidate.LocalToClip, collision.Positions, collision.NumVertices, collision.Indices, collision.NumIndices);
+		numTriangles += collision.NumIndices / 3;
+		numOccluders++;
+	}
+	OcclusionCuller.Finalize();
+}
+
+OSoftwareOcclusionCuller& OEngine::GetOcclusionCuller()
+{
+	return OcclusionCuller;
+}
+
+SCulledInstancesInfo OEngine::PerformFrustumCulling(IBoundingGeometry* BoundingGeometry, const DirectX::XMMATRIX& ViewMatrix, const TUUID& BufferId, OSoftwareOcclusionCuller* Occlusion, const SLODSelection* LODSelection) const
 {
 	PROFILE_SCOPE();
 
-	if (CurrentFrameResource == nullptr)
+	if (UpdatingFrameResource == nullptr)
 	{
-		LOG(Engine, Error, "CurrentFrameResource is nullptr!")
+		LOG(Engine, Error, "UpdatingFrameResource is nullptr!")
 		return {};
 	}
 
 	SCulledInstancesInfo result;
 	result.BufferId = BufferId;
-	const auto& buffers = GetInstanceBuffersByUUID(BufferId);
+	const auto buffer = GetUpdatingFrameInstBuffer(BufferId);
+	const auto extraBuffer = GetUpdatingFrameInstExtraBuffer(BufferId);
+	const auto maxInstances = buffer->MaxOffset;
+	const auto occlusionViewProj = Load(OcclusionViewProj);
 	int32_t counter = 0;
+
+	// LOD and index of every visible instance of the current item
+	vector<pair<uint8_t, size_t>> visible;
 	for (auto& e : AllRenderItems)
 	{
 		const auto& instData = e->Instances;
@@ -1435,49 +2020,61 @@ SCulledInstancesInfo OEngine::PerformFrustumCulling(IBoundingGeometry* BoundingG
 		{
 			continue;
 		}
-		SCulledRenderItem item;
 
-		size_t visibleInstanceCount = 0;
+		const auto submesh = e->ChosenSubmesh.lock();
+		const bool bSelectLOD = LODSelection && e->bFrustumCoolingEnabled && submesh && !submesh->LODs.empty();
+		visible.clear();
 		for (size_t i = 0; i < instData.size(); i++)
 		{
-			if (visibleInstanceCount == 0)
-			{
-				if (counter >= GetCurrentFrameInstBuffer(BufferId)->MaxOffset)
-				{
-					LOG(Engine, Error, "Buffer size exceeded!")
-					break;
-				}
-				item.StartInstanceLocation = counter;
-			}
-			const auto world = Load(instData[i].HlslData.World);
+			const auto world = Load(instData[i].Params.World);
 			const auto invWorld = Inverse(world);
 			const auto viewToLocal = XMMatrixMultiply(invWorld, ViewMatrix);
 
-			if (!bFrustumCullingEnabled || !e->bFrustumCoolingEnabled || BoundingGeometry->Contains(viewToLocal, e->Bounds) != DISJOINT)
+			bool bVisible = !bFrustumCullingEnabled || !e->bFrustumCoolingEnabled || BoundingGeometry->Contains(viewToLocal, e->Bounds) != DISJOINT;
+			if (bVisible && Occlusion && e->bFrustumCoolingEnabled)
 			{
-				auto data = e->Instances[i];
-				Put(data.HlslData.World, Transpose(world));
-				Put(data.HlslData.TexTransform, Transpose(Load(instData[i].HlslData.TexTransform)));
-
-				data.HlslData.OverrideColor = instData[i].HlslData.OverrideColor;
-				data.HlslData.Position = instData[i].HlslData.Position;
-				data.HlslData.Scale = instData[i].HlslData.Scale;
-				data.HlslData.Rotation = instData[i].HlslData.Rotation;
-				data.HlslData.MaterialIndex = instData[i].HlslData.MaterialIndex;
+				const auto localToClip = ToOcclusionMatrix(XMMatrixMultiply(world, occlusionViewProj));
+				bVisible = Occlusion->IsVisible(localToClip, &e->Bounds.Center.x, &e->Bounds.Extents.x);
+			}
 
-				result.InstanceCount++;
-				for (auto* buffer : buffers)
+			if (bVisible)
+			{
+				if (bSelectLOD)
 				{
-					buffer->CopyData(counter, data.HlslData);
+					e->Instances[i].LOD = SelectLOD(*submesh, e->Bounds, world, e->Instances[i].LOD, *LODSelection);
 				}
-				counter++;
+				visible.emplace_back(bSelectLOD ? e->Instances[i].LOD : 0, i);
+			}
+		}
+		if (bSelectLOD)
+		{
+			std::ranges::stable_sort(visible, {}, &pair<uint8_t, size_t>::first);
+		}
 
-				visibleInstanceCount++;
+		SCulledRenderItem item;
+		item.StartInstanceLocation = counter;
+		for (const auto& [lod, i] : visible)
+		{
+			if (counter >= maxInstances)
+			{
+				LOG(Engine, Error, "Buffer size exceeded!")
+				break;
+			}
+
+			result.InstanceCount++;
+			UploadInstance(instData[i].Params, counter, buffer, extraBuffer);
+			counter++;
+
+			item.VisibleInstanceCount++;
+			item.LODInstanceCounts[lod]++;
+			if (submesh)
+			{
+				result.NumTrianglesBeforeLOD += submesh->IndexCount / 3;
+				result.NumTriangles += (lod == 0 ? submesh->IndexCount : submesh->LODs[lod - 1].IndexCount) / 3;
 			}
 		}
-		if (visibleInstanceCount > 0)
+		if (item.VisibleInstanceCount > 0)
 		{
-			item.VisibleInstanceCount = visibleInstanceCount;
 			item.Item = e;
 			result.Items[e] = item;
 		}
@@ -1486,13 +2083,13 @@ SCulledInstancesInfo OEngine::PerformFrustumCulling(IBoundingGeometry* BoundingG
 }
 
 //TODO fix boilerplate
-SCulledInstancesInfo OEngine::PerformBoundingBoxShadowCulling(const IBoundingGeometry* BoundingGeometry, const DirectX::XMMATRIX& ViewMatrix, const TUUID& BufferId) const // fix
+SCulledInstancesInfo OEngine::PerformBoundingBoxShadowCulling(const IBoundingGeometry* BoundingGeometry, const DirectX::XMMATRIX& ViewMatrix, const TUUID& BufferId, EShadowCasterFilter Filter, uint32_t StartInstance) const // fix
 {
 	PROFILE_SCOPE();
 
-	if (CurrentFrameResource == nullptr)
+	if (UpdatingFrameResource == nullptr)
 	{
-		LOG(Engine, Error, "CurrentFrameResource is nullptr!")
+		LOG(Engine, Error, "UpdatingFrameResource is nullptr!")
 		return {};
 	}
 	auto transformBoundingBox = [](BoundingBox Box, const XMMATRIX& Matrix) {
@@ -1503,8 +2100,9 @@ SCulledInstancesInfo OEngine::PerformBoundingBoxShadowCulling(const IBoundingGeo
 	};
 	SCulledInstancesInfo result;
 	result.BufferId = BufferId;
-	const auto& buffers = GetInstanceBuffersByUUID(BufferId);
-	int32_t counter = 0;
+	const auto buffer = GetUpdatingFrameInstBuffer(BufferId);
+	const auto extraBuffer = GetUpdatingFrameInstExtraBuffer(BufferId);
+	int32_t counter = StartInstance;
 	for (auto& e : AllRenderItems)
 	{
 		const auto& instData = e->Instances;
@@ -1512,6 +2110,10 @@ SCulledInstancesInfo OEngine::PerformBoundingBoxShadowCulling(const IBoundingGeo
 		{
 			continue;
 		}
+		if ((Filter == EShadowCasterFilter::Static && !e->bStaticShadowCaster) || (Filter == EShadowCasterFilter::Dynamic && e->bStaticShadowCaster))
+		{
+			continue;
+		}
 		SCulledRenderItem item;
 
 		size_t visibleInstanceCount = 0;
@@ -1519,7 +2121,7 @@ SCulledInstancesInfo OEngine::PerformBoundingBoxShadowCulling(const IBoundingGeo
 		{
 			if (visibleInstanceCount == 0)
 			{
-				if (counter >= GetCurrentFrameInstBuffer(BufferId)->MaxOffset)
+				if (counter >= buffer->MaxOffset)
 				{
 					LOG(Engine, Error, "Buffer size exceeded!")
 					break;
@@ -1527,24 +2129,10 @@ SCulledInstancesInfo OEngine::PerformBoundingBoxShadowCulling(const IBoundingGeo
 				item.StartInstanceLocation = counter;
 			}
 			BoundingBox viewBoundingBox = transformBoundingBox(e->Bounds, ViewMatrix);
-			const auto world = Load(instData[i].HlslData.World);
 			if (!bFrustumCullingEnabled || !e->bFrustumCoolingEnabled || BoundingGeometry->Contains(viewBoundingBox) != DISJOINT)
 			{
-				auto data = e->Instances[i];
-				Put(data.HlslData.World, Transpose(world));
-				Put(data.HlslData.TexTransform, Transpose(Load(instData[i].HlslData.TexTransform)));
-
-				data.HlslData.OverrideColor = instData[i].HlslData.OverrideColor;
-				data.HlslData.Position = instData[i].HlslData.Position;
-				data.HlslData.Scale = instData[i].HlslData.Scale;
-				data.HlslData.Rotation = instData[i].HlslData.Rotation;
-				data.HlslData.MaterialIndex = instData[i].HlslData.MaterialIndex;
-
 				result.InstanceCount++;
-				for (auto* buffer : buffers)
-				{
-					buffer->CopyData(counter, data.HlslData);
-				}
+				UploadInstance(instData[i].Params, counter, buffer, extraBuffer);
 				counter++;
 
 				visibleInstanceCount++;
@@ -1560,22 +2148,35 @@ SCulledInstancesInfo OEngine::PerformBoundingBoxShadowCulling(const IBoundingGeo
 	return result;
 }
 
+void OEngine::InvalidateStaticShadowCasters()
+{
+	StaticShadowCastersGeneration++;
+}
+
+uint64_t OEngine::GetStaticShadowCastersGeneration() const
+{
+	return StaticShadowCastersGeneration;
+}
+
 uint32_t OEngine::GetTotalNumberOfInstances() const
 {
-	uint32_t totalInstances = 0;
-	for (const auto& e : AllRenderItems)
-	{
-		totalInstances += e->Instances.size();
-	}
-	return totalInstances;
+	return TotalNumInstances;
 }
 
-void OEngine::RebuildGeometry(string Name)
+void OEngine::OnInstanceCountChanged(int64_t Delta)
 {
-	GetCommandQueue()->TryResetCommandList();
+	TotalNumInstances = static_cast<uint32_t>(TotalNumInstances + Delta);
+}
 
+void OEngine::RebuildGeometry(string Name)
+{
 	auto mesh = FindSceneGeometry(Name);
-	auto commandList = GetCommandQueue()->GetCommandList();
+	if (mesh->Residency != EMeshResidency::Full)
+	{
+		LOG(Engine, Warning, "Mesh {} released its CPU geometry and can not be rebuilt", TEXT(Name));
+		return;
+	}
+	GetCommandQueue()->TryResetCommandList();
 
 	vector<XMFLOAT3> vertices;
 	vector<std::uint16_t> indices;
@@ -1595,17 +2196,8 @@ void OEngine::RebuildGeometry(string Name)
 	THROW_IF_FAILED(D3DCreateBlob(ibByteSize, &mesh->IndexBufferCPU));
 	CopyMemory(mesh->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
 
-	mesh->VertexBufferGPU = Utils::CreateDefaultBuffer(Device->GetDevice(),
-	                                                   commandList.Get(),
-	                                                   vertices.data(),
-	                                                   vbByteSize,
-	                                                   mesh->VertexBufferUploader);
-
-	mesh->IndexBufferGPU = Utils::CreateDefaultBuffer(Device->GetDevice(),
-	                                                  commandList.Get(),
-	                                                  indices.data(),
-	                                                  ibByteSize,
-	                                                  mesh->IndexBufferUploader);
+	mesh->VertexBufferGPU = UploadManager->CreateDefaultBuffer(vertices.data(), vbByteSize);
+	mesh->IndexBufferGPU = UploadManager->CreateDefaultBuffer(indices.data(), ibByteSize, &mesh->UploadTicket);
 
 	GetCommandQueue()->WaitForFenceValue(GetCommandQueue()->ExecuteCommandList());
 }
@@ -1661,11 +2253,27 @@ void OEngine::UpdateMainPass(const STimer& Timer)
 	MainPassCB.TotalTime = Timer.GetTime();
 	MainPassCB.DeltaTime = Timer.GetDeltaTime();
 	MainPassCB.SSAOEnabled = SSAORT.lock()->IsEnabled();
+	if (const auto lighting = ClusteredLighting.lock())
+	{
+		lighting->SetPassConstants(MainPassCB);
+	}
 	GetNumLights(MainPassCB.NumPointLights, MainPassCB.NumSpotLights, MainPassCB.NumDirLights);
-	const auto currPassCB = CurrentFrameResource->PassCB.get();
+	const auto currPassCB = UpdatingFrameResource->PassCB.get();
 	currPassCB->CopyData(0, MainPassCB);
 }
 
+void OEngine::UpdateClusteredLighting()
+{
+	PROFILE_SCOPE();
+	const auto lighting = ClusteredLighting.lock();
+	if (!lighting)
+	{
+		return;
+	}
+	const auto camera = Window->GetCamera().lock();
+	lighting->Update(LightComponents, LightSlots, camera->GetView(), camera->GetProj4x4f(), camera->GetNearZ(), camera->GetFarZ(), UpdatingFrameResource);
+}
+
 void OEngine::GetNumLights(uint32_t& OutNumPointLights, uint32_t& OutNumSpotLights, uint32_t& OutNumDirLights) const
 {
 	OutNumPointLights = 0;
@@ -1788,6 +2396,7 @@ weak_ptr<ORenderItem> OEngine::BuildRenderItemFromMesh(const weak_ptr<SMeshGeome
 	auto newItem = make_shared<ORenderItem>();
 
 	newItem->bFrustumCoolingEnabled = Params.bFrustumCoolingEnabled;
+	newItem->bStaticShadowCaster = Params.bStaticShadowCaster;
 
 	uint32_t matIdx = 0;
 	SRenderLayer layer;
@@ -1804,19 +2413,27 @@ weak_ptr<ORenderItem> OEngine::BuildRenderItemFromMesh(const weak_ptr<SMeshGeome
 	auto submeshLock = submesh.lock();
 	layer = Params.OverrideLayer.value_or(layer);
 	SInstanceData defaultInstance;
-	defaultInstance.HlslData.MaterialIndex = matIdx;
+	defaultInstance.Params.MaterialIndex = matIdx;
 
-	defaultInstance.HlslData.Scale = Params.Scale.value_or(XMFLOAT3{ 1, 1, 1 });
-	defaultInstance.HlslData.Position = Params.Position.value_or(XMFLOAT3{ 0, 0, 0 });
-	defaultInstance.HlslData.Rotation = Params.Rotation.value_or(XMFLOAT4{ 0, 0, 0, 1 });
+	defaultInstance.Params.Scale = Params.Scale.value_or(XMFLOAT3{ 1, 1, 1 });
+	defaultInstance.Params.Position = Params.Position.value_or(XMFLOAT3{ 0, 0, 0 });
+	defaultInstance.Params.Rotation = Params.Rotation.value_or(XMFLOAT4{ 0, 0, 0, 1 });
 
-	defaultInstance.HlslData.OverrideColor = (Params.OverrideColor.value_or(SColor::White)).ToFloat3();
-	defaultInstance.HlslData.BoundingBoxCenter = submeshLock->Bounds.Center;
-	defaultInstance.HlslData.BoundingBoxExtents = submeshLock->Bounds.Extents;
+	defaultInstance.Params.OverrideColor = (Params.OverrideColor.value_or(SColor::White)).ToFloat3();
+	defaultInstance.Params.BoundingBoxCenter = submeshLock->Bounds.Center;
+	defaultInstance.Params.BoundingBoxExtents = submeshLock->Bounds.Extents;
 	defaultInstance.Lifetime = Params.Lifetime;
-	Put(defaultInstance.HlslData.World, BuildWorldMatrix(defaultInstance.HlslData.Position, defaultInstance.HlslData.Scale, defaultInstance.HlslData.Rotation));
+	Put(defaultInstance.Params.World, BuildWorldMatrix(defaultInstance.Params.Position, defaultInstance.Params.Scale, defaultInstance.Params.Rotation));
 
 	newItem->Instances.resize(Params.NumberOfInstances, defaultInstance);
+	for (auto& instance : newItem->Instances)
+	{
+		instance.TransformNode = TransformHierarchy.Add(OTransformHierarchy::InvalidNode, ToLocalTransform(instance.Params.Position, instance.Params.Rotation, instance.Params.Scale));
+	}
+	if (Params.Lifetime.has_value())
+	{
+		TrackInstanceLifetimes(newItem.get());
+	}
 	newItem->RenderLayer = layer;
 	newItem->bIsDisplayable = Params.Displayable;
 	newItem->Geometry = Mesh;
@@ -1853,10 +2470,20 @@ weak_ptr<OShadowMap> OEngine::CreateShadowMap()
 	return newMap;
 }
 
+uint32_t OEngine::AcquireLightIndex()
+{
+	if (FreeLightIndices.empty())
+	{
+		return NumLightIndices++;
+	}
+	const uint32_t index = FreeLightIndices.back();
+	FreeLightIndices.pop_back();
+	return index;
+}
+
 OSpotLightComponent* OEngine::AddSpotLightComponent(ORenderItem* Item)
 {
-	uint32_t componentNum = LightComponents.size();
-	const auto res = Item->AddComponent<OSpotLightComponent>(componentNum);
+	const auto res = Item->AddComponent(SpotLightPool, AcquireLightIndex());
 	LightComponents.push_back(res);
 	res->SetShadowMap(CreateShadowMap().lock());
 	return res;
@@ -1864,19 +2491,17 @@ OSpotLightComponent* OEngine::AddSpotLightComponent(ORenderItem* Item)
 
 OPointLightComponent* OEngine::AddPointLightComponent(ORenderItem* Item)
 {
-	uint32_t componentNum = LightComponents.size();
-	const auto res = Item->AddComponent<OPointLightComponent>(componentNum);
+	const auto res = Item->AddComponent(PointLightPool, AcquireLightIndex());
 	LightComponents.push_back(res);
-	auto newShadow = BuildRenderObject<OShadowMap>(ShadowTextures, Device, SRenderConstants::ShadowMapSize, DXGI_FORMAT_R24G8_TYPELESS);
-	ShadowMaps.push_back(newShadow);
-	newShadow.lock()->SetShadowMapIndex(componentNum);
+
+	// Shadow maps are indexed by their slot, not by the light
+	CreateShadowMap();
 	return res;
 }
 
 ODirectionalLightComponent* OEngine::AddDirectionalLightComponent(ORenderItem* Item)
 {
-	uint32_t componentNum = LightComponents.size();
-	auto light = Item->AddComponent<ODirectionalLightComponent>(componentNum);
+	auto light = Item->AddComponent(DirectionalLightPool, AcquireLightIndex());
 	LightComponents.push_back(light);
 	auto csm = BuildRenderObject<OCSM>(None, Device, DXGI_FORMAT_R24G8_TYPELESS);
 	light->SetCSM(csm);
@@ -1892,7 +2517,7 @@ void OEngine::BuildPickRenderItem()
 	newItem->bTraceable = false;
 
 	SInstanceData defaultInstance;
-	defaultInstance.HlslData.MaterialIndex = newItem->DefaultMaterial.lock()->MaterialCBIndex;
+	defaultInstance.Params.MaterialIndex = newItem->DefaultMaterial.lock()->MaterialCBIndex;
 
 	newItem->Instances.push_back(defaultInstance);
 	PickedItem = newItem.get();
@@ -1948,6 +2573,22 @@ void OEngine::BindMesh(const SMeshGeometry* Mesh)
 	list->IASetVertexBuffers(0, 1, &vertexBufferView);
 }
 
+const SCulledInstancesInfo& OEngine::GetRenderedItems() const
+{
+	static const SCulledInstancesInfo empty;
+	return UpdatePacket ? UpdatePacket->CameraRenderedItems : empty;
+}
+
+const SFramePacket* OEngine::GetRecordPacket() const
+{
+	return RecordPacket;
+}
+
+OFramePipeline& OEngine::GetFramePipeline()
+{
+	return FramePipeline;
+}
+
 vector<weak_ptr<OShadowMap>>& OEngine::GetShadowMaps()
 {
 	return ShadowMaps;
@@ -1,6 +1,7 @@
 #pragma once
 #include "Animations/AnimationManager.h"
 #include "Color.h"
+#include "DebugDraw/DebugDraw.h"
 #include "Device/Device.h"
 #include "DirectX/BoundingGeometry.h"
 #include "DirectX/FrameResource.h"
@@ -11,16 +12,26 @@
 #include "Engine/RenderTarget/Filters/Blur/BlurFilter.h"
 #include "Engine/RenderTarget/Filters/SobelFilter/SobelFilter.h"
 #include "Engine/RenderTarget/ShadowMap/ShadowMap.h"
+#include "Engine/UploadBuffer/UploadManager.h"
 #include "ExitHelper.h"
+#include "FramePipeline/FramePacket.h"
+#include "FramePipeline/FramePipeline.h"
 #include "GraphicsPipelineManager/GraphicsPipelineManager.h"
+#include "LightCulling/ClusteredLighting.h"
+#include "LightCulling/LightSlots.h"
 #include "MaterialManager/MaterialManager.h"
 #include "MeshGenerator/MeshGenerator.h"
+#include "OcclusionCulling/SoftwareOcclusion.h"
+#include "Profiling/GpuProfiler.h"
+#include "SceneGraph/TransformHierarchy.h"
 #include "Profiler.h"
 #include "RenderGraph/Graph/RenderGraph.h"
+#include "RenderGraph/Graph/TransientResourcePool.h"
 #include "RenderTarget/CSM/Csm.h"
 #include "RenderTarget/CubeMap/DynamicCubeMap/DynamicCubeMapTarget.h"
 #include "RenderTarget/NormalTangetDebugTarget/NormalTangentDebugTarget.h"
 #include "RenderTarget/RenderTarget.h"
+#include "Replay/SessionReplay.h"
 #include "Scene/SceneManager.h"
 #include "ShaderCompiler/Compiler.h"
 #include "TextureManager/TextureManager.h"
@@ -79,6 +90,10 @@ public:
 	SFrameResource* CurrentFrameResource = nullptr;
 	UINT CurrentFrameResourceIndex = 0;
 
+	// Frame resource the update stage writes, CurrentFrameResource is the one being recorded
+	SFrameResource* UpdatingFrameResource = nullptr;
+	UINT UpdatingFrameResourceIndex = 0;
+
 	inline static std::map<HWND, TWindowPtr> WindowsMap = {};
 
 	static void RemoveWindow(HWND Hwnd);
@@ -107,7 +122,6 @@ private:
 	void BuildDebugGeometry();
 
 public:
-	vector<OUploadBuffer<HLSL::InstanceData>*> GetInstanceBuffersByUUID(TUUID Id) const;
 	void SetFogColor(DirectX::XMFLOAT4 Color);
 	void SetFogStart(float Start);
 	void SetFogRange(float Range);
@@ -121,6 +135,7 @@ public:
 	void DestroyWindow();
 	void OnWindowDestroyed();
 
+	// Forward to the debug draw and the session capture from the update, nothing is drawn in builds without debug draw
 	void DrawDebugBox(DirectX::XMFLOAT3 Center, DirectX::XMFLOAT3 Extents, DirectX::XMFLOAT4 Orientation, SColor Color, float Duration);
 	void DrawDebugFrustum(const DirectX::XMFLOAT4X4& InvViewProjection, SColor Color, float Duration);
 
@@ -128,14 +143,18 @@ public:
 	OCommandQueue* GetCommandQueue(D3D12_COMMAND_LIST_TYPE Type = D3D12_COMMAND_LIST_TYPE_DIRECT);
 	CD3DX12_GPU_DESCRIPTOR_HANDLE GetRenderGroupStartAddress(ERenderGroup Group);
 
-	void OnEnd() const;
+	void OnEnd();
 	void RemoveRenderItems();
-	void RemoveItemInstances(UpdateEventArgs& Args);
+	void UpdateInstanceLifetimes(const UpdateEventArgs& Args);
+	void UpdateComponents(const UpdateEventArgs& Args);
+
+	// Items with instances that expire, only these are visited by UpdateInstanceLifetimes
+	void TrackInstanceLifetimes(ORenderItem* Item);
 	void TryRebuildFrameResource();
 	void UpdateBoundingSphere();
 	void Draw(UpdateEventArgs& Args);
-	void Render(UpdateEventArgs& Args);
-	void Update(UpdateEventArgs& Args);
+	void Render(uint32_t FrameIndex);
+	void Update(UpdateEventArgs& Args, uint32_t FrameIndex);
 	void OnUpdate(UpdateEventArgs& Args);
 	void OnKeyPressed(KeyEventArgs& Args);
 	void OnKeyReleased(KeyEventArgs& Args);
@@ -147,10 +166,25 @@ public:
 	void OnUpdateWindowSize(ResizeEventArgs& Args);
 	void SetWindowViewport();
 	weak_ptr<OSSAORenderTarget> GetSSAORT() const;
+	weak_ptr<OClusteredLighting> GetClusteredLighting() const;
+	OSoftwareOcclusionCuller& GetOcclusionCuller();
+	OTransformHierarchy& GetTransformHierarchy();
+	OGpuProfiler* GetGpuProfiler() const;
+
+	// Position, rotation and scale are relative to the parent node if the instance has one
+	void SetInstanceTransform(SInstanceData& Instance, const DirectX::XMFLOAT3& Position, const DirectX::XMFLOAT4& Rotation, const DirectX::XMFLOAT3& Scale);
+	void AttachInstance(const SInstanceData& Child, const SInstanceData& Parent);
+
+	// Drives the instance transform node with a track of the animation runtime until it finishes or is stopped
+	void PlayInstanceAnimation(const SInstanceData& Instance, const wstring& Name, bool bLoop = true, float Speed = 1.0f);
+	void StopInstanceAnimation(const SInstanceData& Instance);
 	void CreateWindow();
 	bool GetMSAAState(UINT& Quality) const;
 	void FillExpectedShadowMaps();
 	OUploadBuffer<HLSL::InstanceData>* GetCurrentFrameInstBuffer(const TUUID& Id) const;
+	OUploadBuffer<HLSL::InstanceExtraData>* GetCurrentFrameInstExtraBuffer(const TUUID& Id) const;
+	OUploadBuffer<HLSL::InstanceData>* GetUpdatingFrameInstBuffer(const TUUID& Id) const;
+	OUploadBuffer<HLSL::InstanceExtraData>* GetUpdatingFrameInstExtraBuffer(const TUUID& Id) const;
 	unordered_set<weak_ptr<ORenderItem>>& GetRenderItems(const SRenderLayer& Type);
 	D3D12_RENDER_TARGET_BLEND_DESC GetTransparentBlendState();
 	void FillDescriptorHeaps();
@@ -196,6 +230,7 @@ public:
 	OBilateralBlurFilter* GetBilateralBlurFilter();
 	OSobelFilter* GetSobelFilter();
 	void BuildFilters();
+	void RebuildTransientViews();
 
 	template<typename T, typename... Args>
 	weak_ptr<T> BuildRenderObject(ERenderGroup Group, Args&&... Params);
@@ -208,7 +243,6 @@ public:
 
 	void DrawFullScreenQuad(SPSODescriptionBase* Desc);
 	void DrawOnePoint();
-	void DrawBox(SPSODescriptionBase* Desc);
 	void DrawAABBOfRenderItems(SPSODescriptionBase* Desc);
 	template<typename T>
 	TUUID AddFilter();
@@ -219,6 +253,13 @@ public:
 	void SetObjectDescriptor(SRenderObjectHeap& Heap);
 	void BuildDescriptorHeaps();
 	D3D12_GPU_DESCRIPTOR_HANDLE GetSRVDescHandleForTexture(STexture* Texture) const;
+
+	// Bindless texture slots, TextureIndex stays valid until the texture is removed
+	bool AddTextureDescriptor(STexture* Texture);
+	void RemoveTextureDescriptor(STexture* Texture);
+
+	// Contiguous descriptors valid for the frame being recorded only
+	SDescriptorPair AllocateTransientSRV(uint32_t Count = 1);
 	D3D12_GPU_DESCRIPTOR_HANDLE GetSRVDescHandle(int64_t Index) const;
 	void SetAmbientLight(const DirectX::XMFLOAT4& Color);
 
@@ -232,11 +273,18 @@ public:
 	float GetTime() const;
 	TRenderLayer& GetRenderLayers();
 
-	SCulledInstancesInfo PerformFrustumCulling(IBoundingGeometry* BoundingGeometry, const DirectX::XMMATRIX& ViewMatrix, const TUUID& BufferId) const;
-	SCulledInstancesInfo PerformBoundingBoxShadowCulling(const IBoundingGeometry* BoundingGeometry, const DirectX::XMMATRIX& ViewMatrix, const TUUID& BufferId) const;
+	SCulledInstancesInfo PerformFrustumCulling(IBoundingGeometry* BoundingGeometry, const DirectX::XMMATRIX& ViewMatrix, const TUUID& BufferId, OSoftwareOcclusionCuller* Occlusion = nullptr, const SLODSelection* LODSelection = nullptr) const;
+	SCulledInstancesInfo PerformBoundingBoxShadowCulling(const IBoundingGeometry* BoundingGeometry, const DirectX::XMMATRIX& ViewMatrix, const TUUID& BufferId, EShadowCasterFilter Filter = EShadowCasterFilter::All, uint32_t StartInstance = 0) const;
 
 	uint32_t GetTotalNumberOfInstances() const;
 
+	// Instances added to or removed from items the engine lists
+	void OnInstanceCountChanged(int64_t Delta);
+
+	// Bumped every time a static shadow caster is added, removed or moved, invalidates the cached shadow layers
+	void InvalidateStaticShadowCasters();
+	uint64_t GetStaticShadowCastersGeneration() const;
+
 	shared_ptr<OMaterialManager> GetMaterialManager() const
 	{
 		return MaterialManager;
@@ -248,6 +296,12 @@ public:
 	}
 
 	OMeshGenerator* GetMeshGenerator() const;
+	OUploadManager* GetUploadManager() const;
+	OTransientResourcePool* GetTransientResources() const;
+#if ENABLE_DEBUG_DRAW
+	ODebugDraw* GetDebugDraw();
+#endif
+	OSessionReplay* GetSessionReplay();
 
 	void Pick(int32_t SX, int32_t SY);
 	ORenderItem* GetPickedItem() const;
@@ -262,11 +316,20 @@ public:
 private:
 	void DrawRenderItemsImpl(const SDrawPayload& Payload);
 
+	// Node handles are reused, the animation playing on the node has to stop with it
+	void ReleaseTransformNode(uint32_t Node);
+
 public:
 	void UpdateMaterialCB() const;
+	void UpdateLightSlots();
 	void UpdateLightCB(const UpdateEventArgs& Args) const;
+	void UpdateClusteredLighting();
+	void UpdateOcclusionCulling();
+	void UpdateAnimations(const UpdateEventArgs& Args);
+	void UpdateTransforms();
+	void UploadInstance(const SInstanceParams& Params, int32_t Index, OUploadBuffer<HLSL::InstanceData>* Buffer, OUploadBuffer<HLSL::InstanceExtraData>* ExtraBuffer) const;
 	void UpdateObjectCB() const;
-	void SetDescriptorHeap(EResourceHeapType Type);
+	void SetDescriptorHeap(EResourceHeapType Type, OCommandQueue* Queue = nullptr);
 	OShaderCompiler* GetShaderCompiler() const;
 	weak_ptr<OUIManager> GetUIManager() const;
 	vector<weak_ptr<OShadowMap>>& GetShadowMaps();
@@ -274,10 +337,11 @@ public:
 
 	SRenderObjectHeap DefaultGlobalHeap;
 
-	const auto& GetRenderedItems()
-	{
-		return CameraRenderedItems;
-	}
+	const SCulledInstancesInfo& GetRenderedItems() const;
+
+	// Packet of the frame being recorded, only valid inside the render graph execution
+	const SFramePacket* GetRecordPacket() const;
+	OFramePipeline& GetFramePipeline();
 	IDXGIFactory4* GetFactory();
 
 protected:
@@ -292,23 +356,32 @@ protected:
 	ComPtr<ID3D12Device2> CreateDevice(ComPtr<IDXGIAdapter4> Adapter);
 
 	void UpdateFrameResource();
+	void FillRenderItemDraws();
+	SDescriptorPair GetGlobalSRV(uint32_t Index) const;
 	void InitRenderGraph();
 	uint32_t GetLightComponentsCount() const;
+	const vector<OLightComponent*>& GetLightComponents() const;
 	void CheckRaytracingSupport();
 
 private:
 	void UpdateCameraCB();
 	void UpdateSSAOCB();
 	void BuildSSAO();
+	void BuildClusteredLighting();
 	void BuildNormalTangentDebugTarget();
 	void RemoveRenderObject(TUUID UUID);
 	void RebuildFrameResource(uint32_t Count = 1);
+	void GrowInstanceBuffers();
+	void RegisterRenderItem(shared_ptr<ORenderItem> RenderItem);
 
 	uint32_t InstanceBufferMultiplier = 3;
 	uint32_t PassCount = 1;
 	uint32_t CurrentPass = 0;
 	uint32_t CurrentNumMaterials = 0;
-	uint32_t CurrentNumInstances = 0;
+
+	// Elements of every instance buffer, only the instance buffers are reallocated when the instances outgrow it
+	uint32_t InstanceCapacity = 0;
+	uint32_t TotalNumInstances = 0;
 
 	OEngine() = default;
 	void UpdateMainPass(const STimer& Timer);
@@ -346,7 +419,6 @@ private:
 
 	std::optional<string> GeometryToRebuild;
 	DirectX::BoundingSphere SceneBounds;
-	SCulledInstancesInfo CameraRenderedItems;
 	ORenderItem* PickedItem = nullptr;
 
 	unique_ptr<OShaderCompiler> ShaderCompiler;
@@ -362,24 +434,72 @@ private:
 	unique_ptr<OCommandQueue> DirectCommandQueue;
 	unique_ptr<OCommandQueue> ComputeCommandQueue;
 	unique_ptr<OCommandQueue> CopyCommandQueue;
+	unique_ptr<OGpuProfiler> GpuProfiler;
+
+	// Staging of every upload recorded on the direct queue, declared after the queue it listens to
+	unique_ptr<OUploadManager> UploadManager;
 
+	// Post process targets aliased in shared heaps, placed by the render graph
+	unique_ptr<OTransientResourcePool> TransientResources;
+
+	TComponentPool<ODirectionalLightComponent> DirectionalLightPool;
+	TComponentPool<OPointLightComponent> PointLightPool;
+	TComponentPool<OSpotLightComponent> SpotLightPool;
 	vector<OLightComponent*> LightComponents;
+
+	// Indices of removed lights are handed out again, a live light keeps its index
+	vector<uint32_t> FreeLightIndices;
+	uint32_t NumLightIndices = 0;
+
+	// Buffer slot of every light in LightComponents, refreshed each update
+	OLightSlots LightSlots;
+	vector<SLightSlotKey> LightSlotKeys;
 	vector<weak_ptr<OShadowMap>> ShadowMaps;
 
 	weak_ptr<ONormalTangentDebugTarget> NormalTangentDebugTarget;
-	weak_ptr<ORenderItem> DebugBoxRenderItem;
-	weak_ptr<ORenderItem> DebugFrustumRenderItem;
 	weak_ptr<ORenderItem> QuadRenderItem;
 	weak_ptr<ODynamicCubeMapRenderTarget> CubeRenderTarget;
 	weak_ptr<OUIManager> UIManager;
 	weak_ptr<OSSAORenderTarget> SSAORT;
+	weak_ptr<OClusteredLighting> ClusteredLighting;
+	OSoftwareOcclusionCuller OcclusionCuller;
+
+	// Compact submesh geometry decoded for picking and occlusion
+	vector<float> CollisionPositions;
+	vector<uint32_t> CollisionIndices;
+#if ENABLE_DEBUG_DRAW
+	ODebugDraw DebugDraw;
+#endif
+	OTransformHierarchy TransformHierarchy;
+	OSessionReplay SessionReplay;
+
+	// The update of the next frame overlaps the recording of the last one, each owns the packet of its frame resource
+	OFramePipeline FramePipeline;
+	vector<SFramePacket> FramePackets;
+	SFramePacket* UpdatePacket = nullptr;
+	const SFramePacket* RecordPacket = nullptr;
+
+	// Texture SRVs indexed by TextureIndex and the per frame transient ring, both in DefaultGlobalHeap
+	ODescriptorAllocator TextureDescriptors;
+
+	// Camera view projection the occlusion buffer was rasterized with
+	DirectX::XMFLOAT4X4 OcclusionViewProj = Utils::Math::Identity4x4();
 	weak_ptr<OOffscreenTexture> OffscreenRT;
 
 	uint32_t GarbageMaxItems = 100;
+	uint64_t StaticShadowCastersGeneration = 0;
+	uint32_t CurrentNumLights = 0;
 
 public:
 	TUUID CameraInstanceBufferID;
 	bool bFrustumCullingEnabled = true;
+	bool bOcclusionCullingEnabled = true;
+	bool bLODEnabled = true;
+	float LODPixelError = 1.0f;
+	float LODHysteresis = 0.25f;
+
+	// Set by the AABB visualizer, every visible instance then writes its bounds to the extra data
+	bool bUploadInstanceBounds = false;
 	bool ReloadShadersRequested = false;
 	SDescriptorPair NullCubeSRV;
 	SDescriptorPair NullTexSRV;
@@ -390,7 +510,9 @@ public:
 	void ReloadShaders();
 	OAnimationManager* GetAnimationManager() const;
 	weak_ptr<OShadowMap> CreateShadowMap();
+	uint32_t AcquireLightIndex();
 	unordered_set<shared_ptr<ORenderItem>> PendingRemoveItems;
+	unordered_set<ORenderItem*> TimedRenderItems;
 };
 
 template<typename T, typename... Args>
@@ -0,0 +1,31 @@
+#pragma once
+#include "DirectX/RenderItem/RenderItem.h"
+#include "Engine/DebugDraw/DebugDraw.h"
+#include "Engine/RenderTarget/ShadowMap/ShadowMap.h"
+
+// What the record stage needs of a render item, the item itself keeps changing on the update thread
+struct SRenderItemDraw
+{
+	weak_ptr<ORenderItem> Item;
+	weak_ptr<SMeshGeometry> Geometry;
+	weak_ptr<SSubmeshGeometry> Submesh;
+	string Name;
+	UINT NumInstances = 0;
+	bool bValid = false;
+};
+
+/**
+ * @brief Everything the record stage of a frame reads that the update stage of the next frame would overwrite.
+ * One packet per frame resource, filled by the update stage and only read while the frame is recorded.
+ */
+struct SFramePacket
+{
+	SCulledInstancesInfo CameraRenderedItems;
+	vector<SShadowMapDraw> ShadowMaps;
+#if ENABLE_DEBUG_DRAW
+	vector<SDebugVertex> DebugVertices;
+#endif
+
+	// Render items of every layer as the update stage left them
+	unordered_map<SRenderLayer, vector<SRenderItemDraw>> RenderLayers;
+};
@@ -0,0 +1,143 @@
+#include "FramePipeline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace
+{
+using SClock = std::chrono::steady_clock;
+
+double GetMilliseconds(SClock::time_point Start)
+{
+	return std::chrono::duration<double, std::milli>(SClock::now() - Start).count();
+}
+} // namespace
+
+OFramePipeline::~OFramePipeline()
+{
+	if (!Worker.joinable())
+	{
+		return;
+	}
+	{
+		std::lock_guard lock(WorkerMutex);
+		bStopWorker = true;
+	}
+	WorkerWake.notify_one();
+	Worker.join();
+}
+
+void OFramePipeline::RunWorker()
+{
+	std::unique_lock lock(WorkerMutex);
+	while (true)
+	{
+		WorkerWake.wait(lock, [this]() { return PostedUpdate != nullptr || bStopWorker; });
+		if (bStopWorker)
+		{
+			return;
+		}
+
+		const auto* update = PostedUpdate;
+		const uint32_t slot = PostedSlot;
+		lock.unlock();
+		const auto start = SClock::now();
+		std::exception_ptr error;
+		try
+		{
+			(*update)(slot);
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+		const double milliseconds = GetMilliseconds(start);
+		lock.lock();
+
+		PostedUpdateMs = milliseconds;
+		PostedError = error;
+		PostedUpdate = nullptr;
+		WorkerDone.notify_one();
+	}
+}
+
+double OFramePipeline::WaitForWorker()
+{
+	std::unique_lock lock(WorkerMutex);
+	WorkerDone.wait(lock, [this]() { return PostedUpdate == nullptr; });
+	if (PostedError)
+	{
+		std::rethrow_exception(std::exchange(PostedError, nullptr));
+	}
+	return PostedUpdateMs;
+}
+
+void OFramePipeline::Initialize(uint32_t InDepth)
+{
+	Depth = std::max(InDepth, 1u);
+	NumUpdated = 0;
+	NumRecorded = 0;
+}
+
+void OFramePipeline::Drain(const TStage& Record)
+{
+	if (!HasPendingFrame())
+	{
+		return;
+	}
+	const auto start = SClock::now();
+	Record(static_cast<uint32_t>(NumRecorded % Depth));
+	NumRecorded++;
+	Stats.RecordMs += GetMilliseconds(start);
+}
+
+void OFramePipeline::Tick(const TStage& Update, const TStage& Record)
+{
+	const auto start = SClock::now();
+	const uint32_t updateSlot = GetNextUpdateSlot();
+	Stats.UpdateMs = 0.0;
+	Stats.RecordMs = 0.0;
+	Stats.bThreaded = IsThreaded();
+
+	auto update = [&]() {
+		const auto updateStart = SClock::now();
+		Update(updateSlot);
+		return GetMilliseconds(updateStart);
+	};
+
+	if (!Stats.bThreaded)
+	{
+		Drain(Record);
+		Stats.UpdateMs = update();
+		NumUpdated++;
+		Drain(Record);
+	}
+	else
+	{
+		if (!Worker.joinable())
+		{
+			Worker = std::thread(&OFramePipeline::RunWorker, this);
+		}
+		{
+			std::lock_guard lock(WorkerMutex);
+			PostedUpdate = &Update;
+			PostedSlot = updateSlot;
+		}
+		WorkerWake.notify_one();
+
+		// The pending frame is in another slot, the update can not reach it before the worker is done
+		try
+		{
+			Drain(Record);
+		}
+		catch (...)
+		{
+			WaitForWorker();
+			throw;
+		}
+		Stats.UpdateMs = WaitForWorker();
+		NumUpdated++;
+	}
+	Stats.TickMs = GetMilliseconds(start);
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/*
+ * Two stage frame pipeline. The update of frame N + 1 fills its own slot on a worker thread while the calling thread
+ * records frame N from the slot the previous tick filled, so a tick takes about max(update, record) instead of their sum.
+ * Frame N lives in slot N % Depth, the update never writes the slot being recorded and never overwrites a frame that was
+ * not recorded yet. Both stages are joined before Tick returns, state both of them read may only change between ticks.
+ * Updates run on one worker thread that lives as long as the pipeline, each tick hands it the stage and waits for it.
+ * Threaded ticks need two slots, with one slot or threading disabled every tick updates and records the same frame.
+ * No D3D dependencies.
+ */
+
+struct SFramePipelineStats
+{
+	// Milliseconds of the last tick, the stages overlap in threaded ticks
+	double UpdateMs = 0.0;
+	double RecordMs = 0.0;
+	double TickMs = 0.0;
+	bool bThreaded = false;
+};
+
+class OFramePipeline
+{
+public:
+	using TStage = std::function<void(uint32_t Slot)>;
+
+	OFramePipeline() = default;
+	OFramePipeline(const OFramePipeline&) = delete;
+	OFramePipeline& operator=(const OFramePipeline&) = delete;
+	~OFramePipeline();
+
+	void Initialize(uint32_t InDepth);
+
+	/** @brief Takes effect on the next tick, a frame still waiting to be recorded is recorded first */
+	void SetThreaded(bool bEnable) { bThreaded = bEnable; }
+	bool IsThreaded() const { return bThreaded && Depth > 1; }
+
+	/** @brief Updates the next frame and records the one the last tick updated, threaded ticks record one frame behind */
+	void Tick(const TStage& Update, const TStage& Record);
+
+	/** @brief Records the frame the last tick updated, if there is one */
+	void Drain(const TStage& Record);
+
+	/** @brief Slot the next tick updates, the caller may wait for the GPU to release it between ticks */
+	uint32_t GetNextUpdateSlot() const { return static_cast<uint32_t>(NumUpdated % Depth); }
+
+	bool HasPendingFrame() const { return NumRecorded < NumUpdated; }
+	uint32_t GetDepth() const { return Depth; }
+	uint64_t GetNumUpdated() const { return NumUpdated; }
+	uint64_t GetNumRecorded() const { return NumRecorded; }
+	const SFramePipelineStats& GetStats() const { return Stats; }
+
+private:
+	void RunWorker();
+	double WaitForWorker();
+
+	uint32_t Depth = 1;
+	uint64_t NumUpdated = 0;
+	uint64_t NumRecorded = 0;
+	bool bThreaded = true;
+	SFramePipelineStats Stats;
+
+	// Handoff to the update worker, a posted stage stays valid until the worker reports it done
+	std::thread Worker;
+	std::mutex WorkerMutex;
+	std::condition_variable WorkerWake;
+	std::condition_variable WorkerDone;
+	const TStage* PostedUpdate = nullptr;
+	uint32_t PostedSlot = 0;
+	double PostedUpdateMs = 0.0;
+	std::exception_ptr PostedError;
+	bool bStopWorker = false;
+};
@@ -0,0 +1,329 @@
+#include "ClusteredLightBinner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define CLUSTER_BINNER_SSE 1
+#include <emmintrin.h>
+#else
+#define CLUSTER_BINNER_SSE 0
+#endif
+
+uint32_t SClusterGridParams::GetNumClusters() const
+{
+	return TilesX * TilesY * SlicesZ;
+}
+
+uint32_t SClusterGridParams::GetClusterIndex(uint32_t X, uint32_t Y, uint32_t Slice) const
+{
+	return (Slice * TilesY + Y) * TilesX + X;
+}
+
+float SClusterGridParams::GetDepthScale() const
+{
+	return static_cast<float>(SlicesZ) / std::log(FarZ / NearZ);
+}
+
+float SClusterGridParams::GetDepthBias() const
+{
+	return static_cast<float>(SlicesZ) * std::log(NearZ) / std::log(FarZ / NearZ);
+}
+
+float SClusterGridParams::GetSliceDepth(uint32_t Slice) const
+{
+	return NearZ * std::pow(FarZ / NearZ, static_cast<float>(Slice) / static_cast<float>(SlicesZ));
+}
+
+int32_t SClusterGridParams::GetSlice(float ViewZ) const
+{
+	if (ViewZ < NearZ)
+	{
+		return -1;
+	}
+	if (ViewZ >= FarZ)
+	{
+		return static_cast<int32_t>(SlicesZ);
+	}
+	const auto slice = static_cast<int32_t>(std::floor(std::log(ViewZ) * GetDepthScale() - GetDepthBias()));
+	return std::clamp(slice, 0, static_cast<int32_t>(SlicesZ) - 1);
+}
+
+void OClusteredLightBinner::SetGridParams(const SClusterGridParams& InParams)
+{
+	if (Params == InParams && !Cells.empty())
+	{
+		return;
+	}
+	Params = InParams;
+	BuildClusterBounds();
+
+	const auto numClusters = Params.GetNumClusters();
+	Cells.assign(numClusters, {});
+	ScratchCounts.assign(numClusters, 0);
+	ScratchIndices.resize(static_cast<size_t>(numClusters) * Params.MaxLightsPerCluster);
+	LightIndices.clear();
+}
+
+const SClusterGridParams& OClusteredLightBinner::GetGridParams() const
+{
+	return Params;
+}
+
+void OClusteredLightBinner::BuildClusterBounds()
+{
+	RowStride = (Params.TilesX + 3) & ~3u;
+	const size_t numRows = static_cast<size_t>(Params.TilesY) * Params.SlicesZ;
+	const size_t size = numRows * RowStride;
+
+	// Padding lanes never intersect anything
+	MinX.assign(size, FLT_MAX);
+	MinY.assign(size, FLT_MAX);
+	MinZ.assign(size, FLT_MAX);
+	MaxX.assign(size, -FLT_MAX);
+	MaxY.assign(size, -FLT_MAX);
+	MaxZ.assign(size, -FLT_MAX);
+
+	for (uint32_t slice = 0; slice < Params.SlicesZ; slice++)
+	{
+		const float zNear = Params.GetSliceDepth(slice);
+		const float zFar = Params.GetSliceDepth(slice + 1);
+		for (uint32_t y = 0; y < Params.TilesY; y++)
+		{
+			// Tile rows go from the top of the screen
+			const float ndcTop = 1.0f - 2.0f * static_cast<float>(y) / Params.TilesY;
+			const float ndcBottom = 1.0f - 2.0f * static_cast<float>(y + 1) / Params.TilesY;
+			const float minY = std::min(ndcBottom * zNear, ndcBottom * zFar) / Params.ProjScaleY;
+			const float maxY = std::max(ndcTop * zNear, ndcTop * zFar) / Params.ProjScaleY;
+
+			const size_t row = (static_cast<size_t>(slice) * Params.TilesY + y) * RowStride;
+			for (uint32_t x = 0; x < Params.TilesX; x++)
+			{
+				const float ndcLeft = -1.0f + 2.0f * static_cast<float>(x) / Params.TilesX;
+				const float ndcRight = -1.0f + 2.0f * static_cast<float>(x + 1) / Params.TilesX;
+				MinX[row + x] = std::min(ndcLeft * zNear, ndcLeft * zFar) / Params.ProjScaleX;
+				MaxX[row + x] = std::max(ndcRight * zNear, ndcRight * zFar) / Params.ProjScaleX;
+				MinY[row + x] = minY;
+				MaxY[row + x] = maxY;
+				MinZ[row + x] = zNear;
+				MaxZ[row + x] = zFar;
+			}
+		}
+	}
+}
+
+bool OClusteredLightBinner::ComputeLightRange(const SClusterLight& Light, SLightRange& OutRange) const
+{
+	const float cx = Light.Position[0];
+	const float cy = Light.Position[1];
+	const float cz = Light.Position[2];
+	const float r = Light.Radius;
+
+	if (r <= 0.0f || cz + r < Params.NearZ || cz - r > Params.FarZ)
+	{
+		return false;
+	}
+
+	const float zMin = std::max(cz - r, Params.NearZ);
+	const float zMax = std::min(cz + r, Params.FarZ);
+
+	// x / z is monotonic along z, so the corners of the sphere box bound its projection
+	const float ndcMinX = std::min((cx - r) / zMin, (cx - r) / zMax) * Params.ProjScaleX;
+	const float ndcMaxX = std::max((cx + r) / zMin, (cx + r) / zMax) * Params.ProjScaleX;
+	const float ndcMinY = std::min((cy - r) / zMin, (cy - r) / zMax) * Params.ProjScaleY;
+	const float ndcMaxY = std::max((cy + r) / zMin, (cy + r) / zMax) * Params.ProjScaleY;
+
+	if (ndcMaxX < -1.0f || ndcMinX > 1.0f || ndcMaxY < -1.0f || ndcMinY > 1.0f)
+	{
+		return false;
+	}
+
+	auto toTile = [](float Value, uint32_t NumTiles) {
+		return std::clamp(static_cast<int32_t>(std::floor(Value * NumTiles)), 0, static_cast<int32_t>(NumTiles) - 1);
+	};
+
+	OutRange.MinX = toTile((ndcMinX + 1.0f) * 0.5f, Params.TilesX);
+	OutRange.MaxX = toTile((ndcMaxX + 1.0f) * 0.5f, Params.TilesX);
+	OutRange.MinY = toTile((1.0f - ndcMaxY) * 0.5f, Params.TilesY);
+	OutRange.MaxY = toTile((1.0f - ndcMinY) * 0.5f, Params.TilesY);
+	OutRange.MinSlice = std::max(Params.GetSlice(zMin), 0);
+	OutRange.MaxSlice = std::min(Params.GetSlice(zMax), static_cast<int32_t>(Params.SlicesZ) - 1);
+	return OutRange.MinSlice <= OutRange.MaxSlice;
+}
+
+void OClusteredLightBinner::Bin(const std::vector<SClusterLight>& Lights)
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	Stats = {};
+	Stats.NumLights = static_cast<uint32_t>(Lights.size());
+	std::fill(ScratchCounts.begin(), ScratchCounts.end(), 0);
+
+	Ranges.resize(Lights.size());
+	for (size_t i = 0; i < Lights.size(); i++)
+	{
+		if (ComputeLightRange(Lights[i], Ranges[i]))
+		{
+			Stats.NumVisibleLights++;
+		}
+		else
+		{
+			Ranges[i].MinSlice = 1;
+			Ranges[i].MaxSlice = 0;
+		}
+	}
+
+	uint32_t numThreads = NumThreads > 0 ? NumThreads : std::max(std::thread::hardware_concurrency(), 1u);
+	if (Stats.NumVisibleLights < MinLightsPerThread)
+	{
+		numThreads = 1;
+	}
+	numThreads = std::min(numThreads, Params.SlicesZ);
+	Stats.NumThreads = numThreads;
+
+	// Slices never share clusters, each thread owns a contiguous block of them
+	const uint32_t slicesPerThread = (Params.SlicesZ + numThreads - 1) / numThreads;
+	std::vector<std::future<void>> futures;
+	for (uint32_t thread = 1; thread < numThreads; thread++)
+	{
+		const uint32_t first = thread * slicesPerThread;
+		const uint32_t last = std::min(first + slicesPerThread, Params.SlicesZ);
+		if (first < last)
+		{
+			futures.push_back(std::async(std::launch::async, [this, first, last, &Lights]() { BinSlices(first, last, Lights); }));
+		}
+	}
+	BinSlices(0, std::min(slicesPerThread, Params.SlicesZ), Lights);
+	for (auto& future : futures)
+	{
+		future.get();
+	}
+
+	Compact();
+
+	const auto end = std::chrono::high_resolution_clock::now();
+	Stats.Milliseconds = std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+void OClusteredLightBinner::BinSlices(uint32_t FirstSlice, uint32_t LastSlice, const std::vector<SClusterLight>& Lights)
+{
+	const uint32_t maxPerCluster = Params.MaxLightsPerCluster;
+	auto append = [&](uint32_t Cluster, uint32_t LightIndex) {
+		auto& count = ScratchCounts[Cluster];
+		if (count < maxPerCluster)
+		{
+			ScratchIndices[static_cast<size_t>(Cluster) * maxPerCluster + count] = LightIndex;
+		}
+		// Counts past the capacity are kept to report overflows
+		count++;
+	};
+
+	for (uint32_t slice = FirstSlice; slice < LastSlice; slice++)
+	{
+		for (size_t i = 0; i < Lights.size(); i++)
+		{
+			const auto& range = Ranges[i];
+			if (static_cast<int32_t>(slice) < range.MinSlice || static_cast<int32_t>(slice) > range.MaxSlice)
+			{
+				continue;
+			}
+
+			const auto& light = Lights[i];
+			const float radiusSq = light.Radius * light.Radius;
+			for (int32_t y = range.MinY; y <= range.MaxY; y++)
+			{
+				const size_t row = (static_cast<size_t>(slice) * Params.TilesY + y) * RowStride;
+#if CLUSTER_BINNER_SSE
+				const __m128 zero = _mm_setzero_ps();
+				const __m128 cx = _mm_set1_ps(light.Position[0]);
+				const __m128 cy = _mm_set1_ps(light.Position[1]);
+				const __m128 cz = _mm_set1_ps(light.Position[2]);
+				const __m128 r2 = _mm_set1_ps(radiusSq);
+
+				// Rows are padded, the first lane is aligned down to keep the loads inside the row
+				for (int32_t x = range.MinX & ~3; x <= range.MaxX; x += 4)
+				{
+					const size_t idx = row + x;
+					const __m128 dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&MinX[idx]), cx), zero), _mm_max_ps(_mm_sub_ps(cx, _mm_loadu_ps(&MaxX[idx])), zero));
+					const __m128 dy = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&MinY[idx]), cy), zero), _mm_max_ps(_mm_sub_ps(cy, _mm_loadu_ps(&MaxY[idx])), zero));
+					const __m128 dz = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&MinZ[idx]), cz), zero), _mm_max_ps(_mm_sub_ps(cz, _mm_loadu_ps(&MaxZ[idx])), zero));
+					const __m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+					const int mask = _mm_movemask_ps(_mm_cmple_ps(distSq, r2));
+					if (mask == 0)
+					{
+						continue;
+					}
+					for (int32_t lane = 0; lane < 4; lane++)
+					{
+						const int32_t tile = x + lane;
+						if ((mask & (1 << lane)) && tile >= range.MinX && tile <= range.MaxX)
+						{
+							append(Params.GetClusterIndex(tile, y, slice), light.Index);
+						}
+					}
+				}
+#else
+				for (int32_t x = range.MinX; x <= range.MaxX; x++)
+				{
+					const size_t idx = row + x;
+					const float dx = std::max(MinX[idx] - light.Position[0], 0.0f) + std::max(light.Position[0] - MaxX[idx], 0.0f);
+					const float dy = std::max(MinY[idx] - light.Position[1], 0.0f) + std::max(light.Position[1] - MaxY[idx], 0.0f);
+					const float dz = std::max(MinZ[idx] - light.Position[2], 0.0f) + std::max(light.Position[2] - MaxZ[idx], 0.0f);
+					if (dx * dx + dy * dy + dz * dz <= radiusSq)
+					{
+						append(Params.GetClusterIndex(x, y, slice), light.Index);
+					}
+				}
+#endif
+			}
+		}
+	}
+}
+
+void OClusteredLightBinner::Compact()
+{
+	const uint32_t maxPerCluster = Params.MaxLightsPerCluster;
+	uint32_t offset = 0;
+	for (size_t cluster = 0; cluster < Cells.size(); cluster++)
+	{
+		const uint32_t count = ScratchCounts[cluster];
+		if (count > maxPerCluster)
+		{
+			Stats.NumOverflows++;
+		}
+		Stats.MaxLightsInCluster = std::max(Stats.MaxLightsInCluster, count);
+		Cells[cluster].Offset = offset;
+		Cells[cluster].Count = std::min(count, maxPerCluster);
+		offset += Cells[cluster].Count;
+	}
+
+	LightIndices.resize(offset);
+	for (size_t cluster = 0; cluster < Cells.size(); cluster++)
+	{
+		if (Cells[cluster].Count > 0)
+		{
+			std::memcpy(&LightIndices[Cells[cluster].Offset], &ScratchIndices[cluster * maxPerCluster], Cells[cluster].Count * sizeof(uint32_t));
+		}
+	}
+	Stats.NumLightIndices = offset;
+}
+
+const std::vector<SClusterCell>& OClusteredLightBinner::GetCells() const
+{
+	return Cells;
+}
+
+const std::vector<uint32_t>& OClusteredLightBinner::GetLightIndices() const
+{
+	return LightIndices;
+}
+
+const SClusterBinningStats& OClusteredLightBinner::GetStats() const
+{
+	return Stats;
+}
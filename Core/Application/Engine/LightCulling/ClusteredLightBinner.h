@@ -0,0 +1,110 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/*
+ * CPU reference of the clustered light culling.
+ * Lights are binned into a view space froxel grid: screen tiles along x/y and exponential slices along z.
+ * The result is a compact list of light indices per cluster. No D3D dependencies, view space is left handed (+z forward).
+ */
+
+struct SClusterGridParams
+{
+	uint32_t TilesX = 16;
+	uint32_t TilesY = 9;
+	uint32_t SlicesZ = 24;
+	float NearZ = 0.1f;
+	float FarZ = 5000.0f;
+
+	// Proj._11 and Proj._22 of the camera projection
+	float ProjScaleX = 1.0f;
+	float ProjScaleY = 1.0f;
+
+	uint32_t MaxLightsPerCluster = 128;
+
+	bool operator==(const SClusterGridParams&) const = default;
+
+	uint32_t GetNumClusters() const;
+	uint32_t GetClusterIndex(uint32_t X, uint32_t Y, uint32_t Slice) const;
+
+	// slice = log(z) * scale - bias
+	float GetDepthScale() const;
+	float GetDepthBias() const;
+	float GetSliceDepth(uint32_t Slice) const;
+	int32_t GetSlice(float ViewZ) const;
+};
+
+// Bounding sphere of a light in view space
+struct SClusterLight
+{
+	float Position[3] = { 0, 0, 0 };
+	float Radius = 0.0f;
+
+	// Opaque for the binner, written as is into the index list
+	uint32_t Index = 0;
+};
+
+struct SClusterCell
+{
+	uint32_t Offset = 0;
+	uint32_t Count = 0;
+};
+
+struct SClusterBinningStats
+{
+	uint32_t NumLights = 0;
+	uint32_t NumVisibleLights = 0;
+	uint32_t NumLightIndices = 0;
+	uint32_t NumOverflows = 0;
+	uint32_t MaxLightsInCluster = 0;
+	uint32_t NumThreads = 0;
+	float Milliseconds = 0.0f;
+};
+
+class OClusteredLightBinner
+{
+public:
+	void SetGridParams(const SClusterGridParams& Params);
+	const SClusterGridParams& GetGridParams() const;
+
+	/** @brief Bins the lights into the grid, the previous result is overwritten */
+	void Bin(const std::vector<SClusterLight>& Lights);
+
+	const std::vector<SClusterCell>& GetCells() const;
+	const std::vector<uint32_t>& GetLightIndices() const;
+	const SClusterBinningStats& GetStats() const;
+
+	// 0 - use all hardware threads
+	uint32_t NumThreads = 0;
+
+	// Light count under which binning stays on the calling thread
+	uint32_t MinLightsPerThread = 32;
+
+private:
+	struct SLightRange
+	{
+		int32_t MinX, MaxX;
+		int32_t MinY, MaxY;
+		int32_t MinSlice, MaxSlice;
+	};
+
+	void BuildClusterBounds();
+	bool ComputeLightRange(const SClusterLight& Light, SLightRange& OutRange) const;
+	void BinSlices(uint32_t FirstSlice, uint32_t LastSlice, const std::vector<SClusterLight>& Lights);
+	void Compact();
+
+	SClusterGridParams Params;
+
+	// SoA cluster bounds, rows along x are padded to a multiple of 4 for the SIMD path
+	uint32_t RowStride = 0;
+	std::vector<float> MinX, MinY, MinZ;
+	std::vector<float> MaxX, MaxY, MaxZ;
+
+	std::vector<SLightRange> Ranges;
+	std::vector<uint32_t> ScratchIndices;
+	std::vector<uint32_t> ScratchCounts;
+
+	std::vector<SClusterCell> Cells;
+	std::vector<uint32_t> LightIndices;
+	SClusterBinningStats Stats;
+};
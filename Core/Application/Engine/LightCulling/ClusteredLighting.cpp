@@ -0,0 +1,189 @@
+#include "ClusteredLighting.h"
+
+#include "CommandQueue/CommandQueue.h"
+#include "DirectX/FrameResource.h"
+#include "LightComponent/LightComponent.h"
+#include "MathUtils.h"
+#include "Profiler.h"
+
+#include <bit>
+
+static_assert(sizeof(SClusterCell) == sizeof(HLSL::ClusterLightGrid));
+
+OClusteredLighting::OClusteredLighting(const weak_ptr<ODevice>& InDevice)
+    : Device(InDevice)
+{
+}
+
+void OClusteredLighting::InitRenderObject()
+{
+	BuildResources();
+}
+
+void OClusteredLighting::BuildResources()
+{
+	constexpr uint64_t numClusters = CLUSTER_TILES_X * CLUSTER_TILES_Y * CLUSTER_SLICES_Z;
+	auto device = Device.lock()->GetDevice();
+	auto weak = weak_from_this();
+	GridUAV = Utils::CreateResource(weak,
+	                                L"ClusterGrid",
+	                                device,
+	                                D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS,
+	                                D3D12_RESOURCE_STATE_GENERIC_READ,
+	                                SRenderConstants::DefaultHeapProperties,
+	                                numClusters * sizeof(HLSL::ClusterLightGrid));
+
+	IndicesUAV = Utils::CreateResource(weak,
+	                                   L"ClusterLightIndices",
+	                                   device,
+	                                   D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS,
+	                                   D3D12_RESOURCE_STATE_GENERIC_READ,
+	                                   SRenderConstants::DefaultHeapProperties,
+	                                   numClusters * CLUSTER_MAX_LIGHTS * sizeof(uint32_t));
+}
+
+void OClusteredLighting::Update(const vector<OLightComponent*>& LightComponents, const OLightSlots& Slots, const DirectX::XMMATRIX& View, const DirectX::XMFLOAT4X4& Proj, float NearZ, float FarZ, SFrameResource* FrameResource)
+{
+	PROFILE_SCOPE();
+	using namespace DirectX;
+
+	SClusterGridParams params;
+	params.TilesX = CLUSTER_TILES_X;
+	params.TilesY = CLUSTER_TILES_Y;
+	params.SlicesZ = CLUSTER_SLICES_Z;
+	params.NearZ = NearZ;
+	params.FarZ = FarZ;
+	params.ProjScaleX = Proj._11;
+	params.ProjScaleY = Proj._22;
+	params.MaxLightsPerCluster = CLUSTER_MAX_LIGHTS;
+	Binner.SetGridParams(params);
+
+	Lights.clear();
+	ShaderLights.clear();
+	auto addLight = [&](const XMFLOAT3& Position, float Radius, uint32_t Index) {
+		XMFLOAT3 viewPos;
+		XMStoreFloat3(&viewPos, XMVector3TransformCoord(Load(Position), View));
+
+		SClusterLight& light = Lights.emplace_back();
+		light.Position[0] = viewPos.x;
+		light.Position[1] = viewPos.y;
+		light.Position[2] = viewPos.z;
+		light.Radius = Radius;
+		light.Index = Index;
+
+		HLSL::ClusterLight& shaderLight = ShaderLights.emplace_back();
+		shaderLight.Position = viewPos;
+		shaderLight.Radius = Radius;
+		shaderLight.Index = Index;
+	};
+
+	// The lists index the light buffers by the slots OEngine::UpdateLightCB writes
+	for (uint32_t i = 0; i < LightComponents.size(); i++)
+	{
+		const auto component = LightComponents[i];
+		switch (component->GetLightType())
+		{
+		case ELightType::Point:
+		{
+			const auto& light = Cast<OPointLightComponent>(component)->GetPointLight();
+			addLight(light.Position, light.FalloffEnd, Slots.GetSlot(i));
+			break;
+		}
+		case ELightType::Spot:
+		{
+			// The bounding sphere of the whole range is conservative for the cone
+			const auto& light = Cast<OSpotLightComponent>(component)->GetSpotLight();
+			addLight(light.Position, light.FalloffEnd, Slots.GetSlot(i) | CLUSTER_SPOT_LIGHT_BIT);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	const auto numClusters = params.GetNumClusters();
+	FrameResource->bClusterLightsOnGPU = Mode == EClusteredLightingMode::GPU;
+	if (!FrameResource->bClusterLightsOnGPU)
+	{
+		Binner.Bin(Lights);
+		const auto& cells = Binner.GetCells();
+		const auto& indices = Binner.GetLightIndices();
+		FrameResource->SetClusteredLights(ShaderLights.size(), numClusters, std::bit_ceil(std::max<uint32_t>(indices.size(), 1)));
+		FrameResource->ClusterGridBuffer->CopyData(0, reinterpret_cast<const HLSL::ClusterLightGrid*>(cells.data()), cells.size());
+		FrameResource->ClusterLightIndexBuffer->CopyData(0, indices.data(), indices.size());
+	}
+	else
+	{
+		FrameResource->SetClusteredLights(ShaderLights.size(), numClusters, 1);
+	}
+	FrameResource->ClusterLightBuffer->CopyData(0, ShaderLights.data(), ShaderLights.size());
+}
+
+void OClusteredLighting::SetPassConstants(SPassConstants& OutConstants) const
+{
+	const auto& params = Binner.GetGridParams();
+	OutConstants.ClusterDepthScale = params.GetDepthScale();
+	OutConstants.ClusterDepthBias = params.GetDepthBias();
+	OutConstants.NumClusterLights = GetNumLights();
+}
+
+void OClusteredLighting::Dispatch(OCommandQueue* Queue, SPSODescriptionBase* PSO, const SFrameResource* FrameResource) const
+{
+	PROFILE_SCOPE();
+	if (!FrameResource->bClusterLightsOnGPU)
+	{
+		return;
+	}
+
+	Queue->SetPipelineState(PSO);
+	Queue->SetResource(STRINGIFY_MACRO(CB_PASS), FrameResource->PassCB->GetGPUAddress(), PSO);
+	Queue->SetResource(STRINGIFY_MACRO(CLUSTER_LIGHTS), FrameResource->ClusterLightBuffer->GetGPUAddress(), PSO);
+	Queue->SetResource(STRINGIFY_MACRO(CLUSTER_LIGHT_GRID_UAV), GridUAV->Resource->GetGPUVirtualAddress(), PSO);
+	Queue->SetResource(STRINGIFY_MACRO(CLUSTER_LIGHT_INDICES_UAV), IndicesUAV->Resource->GetGPUVirtualAddress(), PSO);
+
+	// A compute list cannot name the pixel shader read states, buffers decay to common between submissions and the direct
+	// queue promotes them on first use
+	auto readState = D3D12_RESOURCE_STATE_GENERIC_READ;
+	if (Queue->GetType() == D3D12_COMMAND_LIST_TYPE_COMPUTE)
+	{
+		readState = D3D12_RESOURCE_STATE_COMMON;
+		GridUAV->CurrentState = D3D12_RESOURCE_STATE_COMMON;
+		IndicesUAV->CurrentState = D3D12_RESOURCE_STATE_COMMON;
+	}
+	Queue->ResourceBarrier(GridUAV.get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+	Queue->ResourceBarrier(IndicesUAV.get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+
+	constexpr uint32_t numClusters = CLUSTER_TILES_X * CLUSTER_TILES_Y * CLUSTER_SLICES_Z;
+	Queue->GetCommandList()->Dispatch((numClusters + CLUSTER_THREADS - 1) / CLUSTER_THREADS, 1, 1);
+
+	Queue->ResourceBarrier(GridUAV.get(), readState);
+	Queue->ResourceBarrier(IndicesUAV.get(), readState);
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS OClusteredLighting::GetGridAddress(const SFrameResource* FrameResource) const
+{
+	if (FrameResource->bClusterLightsOnGPU)
+	{
+		return GridUAV->Resource->GetGPUVirtualAddress();
+	}
+	return FrameResource->ClusterGridBuffer->GetGPUAddress();
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS OClusteredLighting::GetIndicesAddress(const SFrameResource* FrameResource) const
+{
+	if (FrameResource->bClusterLightsOnGPU)
+	{
+		return IndicesUAV->Resource->GetGPUVirtualAddress();
+	}
+	return FrameResource->ClusterLightIndexBuffer->GetGPUAddress();
+}
+
+OClusteredLightBinner& OClusteredLighting::GetBinner()
+{
+	return Binner;
+}
+
+uint32_t OClusteredLighting::GetNumLights() const
+{
+	return static_cast<uint32_t>(Lights.size());
+}
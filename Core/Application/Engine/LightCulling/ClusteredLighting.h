@@ -0,0 +1,55 @@
+#pragma once
+#include "ClusteredLightBinner.h"
+#include "DirectX/HLSL/HlslTypes.h"
+#include "DirectX/ObjectConstants.h"
+#include "Engine/RenderTarget/RenderObject/RenderObject.h"
+#include "LightSlots.h"
+
+class ODevice;
+class OCommandQueue;
+class OLightComponent;
+struct SFrameResource;
+struct SPSODescriptionBase;
+
+ENUM(EClusteredLightingMode,
+     CPU,
+     GPU)
+
+/**
+ * @brief Owns the clustered light grid of the main camera.
+ * The CPU mode bins the lights with OClusteredLightBinner and uploads the result with the frame resource,
+ * the GPU mode uploads the light spheres only and builds the grid in a compute pass.
+ */
+class OClusteredLighting : public ORenderObjectBase
+{
+public:
+	explicit OClusteredLighting(const weak_ptr<ODevice>& InDevice);
+
+	void InitRenderObject() override;
+	wstring GetName() const override { return L"ClusteredLighting"; }
+
+	void Update(const vector<OLightComponent*>& LightComponents, const OLightSlots& Slots, const DirectX::XMMATRIX& View, const DirectX::XMFLOAT4X4& Proj, float NearZ, float FarZ, SFrameResource* FrameResource);
+	void SetPassConstants(SPassConstants& OutConstants) const;
+	void Dispatch(OCommandQueue* Queue, SPSODescriptionBase* PSO, const SFrameResource* FrameResource) const;
+
+	D3D12_GPU_VIRTUAL_ADDRESS GetGridAddress(const SFrameResource* FrameResource) const;
+	D3D12_GPU_VIRTUAL_ADDRESS GetIndicesAddress(const SFrameResource* FrameResource) const;
+
+	OClusteredLightBinner& GetBinner();
+	uint32_t GetNumLights() const;
+
+	// Takes effect with the next Update, the frames already updated keep the grid they were built with
+	EClusteredLightingMode Mode = EClusteredLightingMode::CPU;
+
+private:
+	void BuildResources();
+
+	weak_ptr<ODevice> Device;
+	OClusteredLightBinner Binner;
+	vector<SClusterLight> Lights;
+	vector<HLSL::ClusterLight> ShaderLights;
+
+	// Written by the compute pass, every cluster owns CLUSTER_MAX_LIGHTS indices
+	TResourceInfo GridUAV;
+	TResourceInfo IndicesUAV;
+};
@@ -0,0 +1,51 @@
+#include "LightSlots.h"
+
+void OLightSlots::Assign(const std::vector<SLightSlotKey>& Lights)
+{
+	std::vector<uint32_t> numSlots(SlotIds.size(), 0);
+	Slots.resize(Lights.size());
+	Moved.resize(Lights.size());
+	for (uint32_t i = 0; i < Lights.size(); i++)
+	{
+		const auto& light = Lights[i];
+		if (light.Type >= SlotIds.size())
+		{
+			SlotIds.resize(light.Type + 1);
+			numSlots.resize(light.Type + 1, 0);
+		}
+
+		auto& ids = SlotIds[light.Type];
+		const uint32_t slot = numSlots[light.Type]++;
+		if (slot == ids.size())
+		{
+			ids.push_back(light.Id);
+			Moved[i] = true;
+		}
+		else
+		{
+			Moved[i] = ids[slot] != light.Id;
+			ids[slot] = light.Id;
+		}
+		Slots[i] = slot;
+	}
+
+	for (uint32_t type = 0; type < SlotIds.size(); type++)
+	{
+		SlotIds[type].resize(numSlots[type]);
+	}
+}
+
+uint32_t OLightSlots::GetSlot(uint32_t Light) const
+{
+	return Slots[Light];
+}
+
+bool OLightSlots::IsMoved(uint32_t Light) const
+{
+	return Moved[Light] != 0;
+}
+
+uint32_t OLightSlots::GetNumSlots(uint32_t Type) const
+{
+	return Type < SlotIds.size() ? static_cast<uint32_t>(SlotIds[Type].size()) : 0;
+}
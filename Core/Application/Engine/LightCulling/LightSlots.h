@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/*
+ * Slots of the lights in the per type light buffers. Lights of a type are packed in list order, so the shaders can loop over
+ * the light counts and the clustered light lists index the buffers by slot. Removing a light moves every later light of its
+ * type down one slot, those lights are reported as moved and have to be written again. No D3D dependencies.
+ */
+
+struct SLightSlotKey
+{
+	uint32_t Type = 0;
+
+	// Stable while the light lives, may be reused by a later light
+	uint32_t Id = 0;
+};
+
+class OLightSlots
+{
+public:
+	/** @brief Packs the lights in list order, a light is moved when its slot held another light at the previous call */
+	void Assign(const std::vector<SLightSlotKey>& Lights);
+
+	// By position in the list passed to the last Assign
+	uint32_t GetSlot(uint32_t Light) const;
+	bool IsMoved(uint32_t Light) const;
+
+	uint32_t GetNumSlots(uint32_t Type) const;
+
+private:
+	// Id of the light in every slot, per type
+	std::vector<std::vector<uint32_t>> SlotIds;
+	std::vector<uint32_t> Slots;
+	std::vector<uint8_t> Moved;
+};
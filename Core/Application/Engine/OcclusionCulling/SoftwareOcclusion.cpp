@@ -0,0 +1,415 @@
+#include "SoftwareOcclusion.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define SOFTWARE_OCCLUSION_SSE 1
+#include <emmintrin.h>
+#else
+#define SOFTWARE_OCCLUSION_SSE 0
+#endif
+
+namespace
+{
+using TClock = std::chrono::high_resolution_clock;
+
+float GetMilliseconds(TClock::time_point Start)
+{
+	return std::chrono::duration<float, std::milli>(TClock::now() - Start).count();
+}
+
+void TransformPoint(const SOcclusionMatrix& Matrix, float X, float Y, float Z, float* OutClip)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		OutClip[i] = X * Matrix.M[0][i] + Y * Matrix.M[1][i] + Z * Matrix.M[2][i] + Matrix.M[3][i];
+	}
+}
+} // namespace
+
+void OSoftwareOcclusionCuller::SetParams(const SOcclusionParams& InParams)
+{
+	if (Params == InParams && !Depth.empty())
+	{
+		return;
+	}
+	Params = InParams;
+	Params.Width = std::max((Params.Width + TileWidth - 1) / TileWidth * TileWidth, TileWidth);
+	Params.Height = std::max((Params.Height + TileHeight - 1) / TileHeight * TileHeight, TileHeight);
+	TilesX = Params.Width / TileWidth;
+	TilesY = Params.Height / TileHeight;
+	Depth.assign(static_cast<size_t>(Params.Width) * Params.Height, 1.0f);
+	TileDepth.assign(static_cast<size_t>(TilesX) * TilesY, 1.0f);
+}
+
+const SOcclusionParams& OSoftwareOcclusionCuller::GetParams() const
+{
+	return Params;
+}
+
+void OSoftwareOcclusionCuller::Clear()
+{
+	if (Depth.empty())
+	{
+		SetParams(Params);
+	}
+	std::ranges::fill(Depth, 1.0f);
+	std::ranges::fill(TileDepth, 1.0f);
+	Stats = {};
+}
+
+bool OSoftwareOcclusionCuller::ProjectBox(const SOcclusionMatrix& LocalToClip, const float Center[3], const float Extents[3], SScreenBounds& OutBounds) const
+{
+	float center[4];
+	float axes[3][4];
+	TransformPoint(LocalToClip, Center[0], Center[1], Center[2], center);
+	for (int axis = 0; axis < 3; axis++)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			axes[axis][i] = Extents[axis] * LocalToClip.M[axis][i];
+		}
+	}
+
+#if SOFTWARE_OCCLUSION_SSE
+	// Corners as two groups of four lanes, x and y signs alternate inside of a group, z sign is per group
+	const __m128 signX = _mm_setr_ps(-1.0f, 1.0f, -1.0f, 1.0f);
+	const __m128 signY = _mm_setr_ps(-1.0f, -1.0f, 1.0f, 1.0f);
+	__m128 clip[2][4];
+	for (int i = 0; i < 4; i++)
+	{
+		const __m128 xy = _mm_add_ps(_mm_add_ps(_mm_set1_ps(center[i]), _mm_mul_ps(signX, _mm_set1_ps(axes[0][i]))), _mm_mul_ps(signY, _mm_set1_ps(axes[1][i])));
+		clip[0][i] = _mm_sub_ps(xy, _mm_set1_ps(axes[2][i]));
+		clip[1][i] = _mm_add_ps(xy, _mm_set1_ps(axes[2][i]));
+	}
+
+	// Projection of a box crossing the near plane is unbounded
+	const __m128 epsilon = _mm_set1_ps(FLT_EPSILON);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 behind = _mm_or_ps(_mm_or_ps(_mm_cmple_ps(clip[0][3], epsilon), _mm_cmplt_ps(clip[0][2], zero)),
+	                                _mm_or_ps(_mm_cmple_ps(clip[1][3], epsilon), _mm_cmplt_ps(clip[1][2], zero)));
+	if (_mm_movemask_ps(behind) != 0)
+	{
+		return false;
+	}
+
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 width = _mm_set1_ps(static_cast<float>(Params.Width));
+	const __m128 height = _mm_set1_ps(static_cast<float>(Params.Height));
+	__m128 x[2], y[2], z[2];
+	for (int group = 0; group < 2; group++)
+	{
+		const __m128 invW = _mm_div_ps(_mm_set1_ps(1.0f), clip[group][3]);
+		x[group] = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(clip[group][0], invW), half), half), width);
+		y[group] = _mm_mul_ps(_mm_sub_ps(half, _mm_mul_ps(_mm_mul_ps(clip[group][1], invW), half)), height);
+		z[group] = _mm_mul_ps(clip[group][2], invW);
+	}
+
+	auto reduce = [](__m128 Value, auto Operation) {
+		Value = Operation(Value, _mm_shuffle_ps(Value, Value, _MM_SHUFFLE(1, 0, 3, 2)));
+		Value = Operation(Value, _mm_shuffle_ps(Value, Value, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_cvtss_f32(Value);
+	};
+	const auto min = [](__m128 A, __m128 B) { return _mm_min_ps(A, B); };
+	const auto max = [](__m128 A, __m128 B) { return _mm_max_ps(A, B); };
+	const float minX = reduce(_mm_min_ps(x[0], x[1]), min);
+	const float maxX = reduce(_mm_max_ps(x[0], x[1]), max);
+	const float minY = reduce(_mm_min_ps(y[0], y[1]), min);
+	const float maxY = reduce(_mm_max_ps(y[0], y[1]), max);
+	const float minZ = reduce(_mm_min_ps(z[0], z[1]), min);
+#else
+	float minX = FLT_MAX, minY = FLT_MAX, minZ = FLT_MAX;
+	float maxX = -FLT_MAX, maxY = -FLT_MAX;
+	for (int corner = 0; corner < 8; corner++)
+	{
+		float clip[4];
+		for (int i = 0; i < 4; i++)
+		{
+			clip[i] = center[i];
+			for (int axis = 0; axis < 3; axis++)
+			{
+				clip[i] += (corner & (1 << axis)) ? axes[axis][i] : -axes[axis][i];
+			}
+		}
+
+		// Projection of a box crossing the near plane is unbounded
+		if (clip[3] <= FLT_EPSILON || clip[2] < 0.0f)
+		{
+			return false;
+		}
+
+		const float invW = 1.0f / clip[3];
+		const float x = (clip[0] * invW * 0.5f + 0.5f) * Params.Width;
+		const float y = (0.5f - clip[1] * invW * 0.5f) * Params.Height;
+		minX = std::min(minX, x);
+		maxX = std::max(maxX, x);
+		minY = std::min(minY, y);
+		maxY = std::max(maxY, y);
+		minZ = std::min(minZ, clip[2] * invW);
+	}
+#endif
+	OutBounds = { minX, minY, maxX, maxY, minZ };
+	return true;
+}
+
+float OSoftwareOcclusionCuller::GetScreenArea(const SOcclusionMatrix& LocalToClip, const float Center[3], const float Extents[3]) const
+{
+	SScreenBounds bounds;
+	if (!ProjectBox(LocalToClip, Center, Extents, bounds))
+	{
+		return 1.0f;
+	}
+	const float width = static_cast<float>(Params.Width);
+	const float height = static_cast<float>(Params.Height);
+	const float sizeX = std::min(bounds.MaxX, width) - std::max(bounds.MinX, 0.0f);
+	const float sizeY = std::min(bounds.MaxY, height) - std::max(bounds.MinY, 0.0f);
+	if (sizeX <= 0.0f || sizeY <= 0.0f)
+	{
+		return 0.0f;
+	}
+	return sizeX * sizeY / (width * height);
+}
+
+void OSoftwareOcclusionCuller::RasterizeOccluder(const SOcclusionMatrix& LocalToClip, const float* Positions, uint32_t NumVertices, const uint32_t* Indices, uint32_t NumIndices)
+{
+	const auto start = TClock::now();
+	if (Depth.empty())
+	{
+		SetParams(Params);
+	}
+
+	// x, y in pixels, depth and a validity flag for the vertices behind the near plane
+	ScreenVertices.resize(static_cast<size_t>(NumVertices) * 4);
+	for (uint32_t i = 0; i < NumVertices; i++)
+	{
+		const float* position = Positions + static_cast<size_t>(i) * 3;
+		float clip[4];
+		TransformPoint(LocalToClip, position[0], position[1], position[2], clip);
+
+		float* out = &ScreenVertices[static_cast<size_t>(i) * 4];
+		if (clip[3] <= FLT_EPSILON || clip[2] < 0.0f)
+		{
+			out[3] = 0.0f;
+			continue;
+		}
+		const float invW = 1.0f / clip[3];
+		out[0] = (clip[0] * invW * 0.5f + 0.5f) * Params.Width;
+		out[1] = (0.5f - clip[1] * invW * 0.5f) * Params.Height;
+		out[2] = clip[2] * invW;
+		out[3] = 1.0f;
+	}
+
+	for (uint32_t i = 0; i + 2 < NumIndices; i += 3)
+	{
+		const uint32_t i0 = Indices[i];
+		const uint32_t i1 = Indices[i + 1];
+		const uint32_t i2 = Indices[i + 2];
+		if (i0 >= NumVertices || i1 >= NumVertices || i2 >= NumVertices)
+		{
+			continue;
+		}
+		const float* v0 = &ScreenVertices[static_cast<size_t>(i0) * 4];
+		const float* v1 = &ScreenVertices[static_cast<size_t>(i1) * 4];
+		const float* v2 = &ScreenVertices[static_cast<size_t>(i2) * 4];
+
+		// Clipping against the near plane is skipped, dropping a triangle only makes the result less aggressive
+		if (v0[3] == 0.0f || v1[3] == 0.0f || v2[3] == 0.0f)
+		{
+			continue;
+		}
+		RasterizeTriangle(v0, v1, v2);
+	}
+
+	Stats.NumOccluders++;
+	Stats.NumOccluderTriangles += NumIndices / 3;
+	Stats.RasterMilliseconds += GetMilliseconds(start);
+}
+
+void OSoftwareOcclusionCuller::RasterizeTriangle(const float* V0, const float* V1, const float* V2)
+{
+	// Screen space is y down, clockwise triangles have positive area
+	const float area = (V1[0] - V0[0]) * (V2[1] - V0[1]) - (V1[1] - V0[1]) * (V2[0] - V0[0]);
+	if (area <= 0.0f)
+	{
+		return;
+	}
+
+	// Pixel centers inside of the triangle bounds
+	const int32_t minX = std::max(static_cast<int32_t>(std::ceil(std::min({ V0[0], V1[0], V2[0] }) - 0.5f)), 0);
+	const int32_t maxX = std::min(static_cast<int32_t>(std::floor(std::max({ V0[0], V1[0], V2[0] }) - 0.5f)), static_cast<int32_t>(Params.Width) - 1);
+	const int32_t minY = std::max(static_cast<int32_t>(std::ceil(std::min({ V0[1], V1[1], V2[1] }) - 0.5f)), 0);
+	const int32_t maxY = std::min(static_cast<int32_t>(std::floor(std::max({ V0[1], V1[1], V2[1] }) - 0.5f)), static_cast<int32_t>(Params.Height) - 1);
+	if (minX > maxX || minY > maxY)
+	{
+		return;
+	}
+	Stats.NumRasterizedTriangles++;
+
+	// Edge functions A * x + B * y + C, each one is the barycentric weight of the opposite vertex scaled by the area
+	const float* edgeFrom[3] = { V1, V2, V0 };
+	const float* edgeTo[3] = { V2, V0, V1 };
+	float a[3], b[3], c[3];
+	for (int i = 0; i < 3; i++)
+	{
+		a[i] = edgeFrom[i][1] - edgeTo[i][1];
+		b[i] = edgeTo[i][0] - edgeFrom[i][0];
+		c[i] = -(a[i] * edgeFrom[i][0] + b[i] * edgeFrom[i][1]);
+	}
+
+	// Depth is affine in screen space, a pixel keeps the farthest depth the triangle has inside of it
+	const float invArea = 1.0f / area;
+	const float dzdx = (a[1] * (V1[2] - V0[2]) + a[2] * (V2[2] - V0[2])) * invArea;
+	const float dzdy = (b[1] * (V1[2] - V0[2]) + b[2] * (V2[2] - V0[2])) * invArea;
+	const float z0 = V0[2] - dzdx * V0[0] - dzdy * V0[1] + 0.5f * (std::abs(dzdx) + std::abs(dzdy));
+	const float maxZ = std::max({ V0[2], V1[2], V2[2] });
+
+	for (int32_t y = minY; y <= maxY; y++)
+	{
+		const float py = static_cast<float>(y) + 0.5f;
+		float* row = &Depth[static_cast<size_t>(y) * Params.Width];
+
+#if SOFTWARE_OCCLUSION_SSE
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 farDepth = _mm_set1_ps(FLT_MAX);
+		const __m128 maxDepth = _mm_set1_ps(maxZ);
+		const __m128 lanes = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+
+		// Rows are a multiple of the tile width, aligned groups never leave the row
+		const int32_t startX = minX & ~3;
+		__m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(startX)), lanes);
+		const __m128 step = _mm_set1_ps(4.0f);
+		for (int32_t x = startX; x <= maxX; x += 4)
+		{
+			const __m128 w0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[0]), px), _mm_set1_ps(b[0] * py + c[0]));
+			const __m128 w1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[1]), px), _mm_set1_ps(b[1] * py + c[1]));
+			const __m128 w2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[2]), px), _mm_set1_ps(b[2] * py + c[2]));
+			const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w0, zero), _mm_cmpge_ps(w1, zero)), _mm_cmpge_ps(w2, zero));
+			if (_mm_movemask_ps(inside) != 0)
+			{
+				const __m128 z = _mm_min_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(dzdx), px), _mm_set1_ps(dzdy * py + z0)), maxDepth);
+				const __m128 candidate = _mm_or_ps(_mm_and_ps(inside, z), _mm_andnot_ps(inside, farDepth));
+				_mm_storeu_ps(row + x, _mm_min_ps(_mm_loadu_ps(row + x), candidate));
+			}
+			px = _mm_add_ps(px, step);
+		}
+#else
+		for (int32_t x = minX; x <= maxX; x++)
+		{
+			const float px = static_cast<float>(x) + 0.5f;
+			if (a[0] * px + b[0] * py + c[0] >= 0.0f && a[1] * px + b[1] * py + c[1] >= 0.0f && a[2] * px + b[2] * py + c[2] >= 0.0f)
+			{
+				row[x] = std::min(row[x], std::min(dzdx * px + dzdy * py + z0, maxZ));
+			}
+		}
+#endif
+	}
+}
+
+void OSoftwareOcclusionCuller::Finalize()
+{
+	const auto start = TClock::now();
+	for (uint32_t ty = 0; ty < TilesY; ty++)
+	{
+		for (uint32_t tx = 0; tx < TilesX; tx++)
+		{
+			const float* tile = &Depth[static_cast<size_t>(ty) * TileHeight * Params.Width + tx * TileWidth];
+#if SOFTWARE_OCCLUSION_SSE
+			__m128 maxDepth = _mm_setzero_ps();
+			for (uint32_t y = 0; y < TileHeight; y++)
+			{
+				const float* row = tile + static_cast<size_t>(y) * Params.Width;
+				maxDepth = _mm_max_ps(maxDepth, _mm_max_ps(_mm_loadu_ps(row), _mm_loadu_ps(row + 4)));
+			}
+			maxDepth = _mm_max_ps(maxDepth, _mm_shuffle_ps(maxDepth, maxDepth, _MM_SHUFFLE(1, 0, 3, 2)));
+			maxDepth = _mm_max_ps(maxDepth, _mm_shuffle_ps(maxDepth, maxDepth, _MM_SHUFFLE(2, 3, 0, 1)));
+			TileDepth[ty * TilesX + tx] = _mm_cvtss_f32(maxDepth);
+#else
+			float maxDepth = 0.0f;
+			for (uint32_t y = 0; y < TileHeight; y++)
+			{
+				for (uint32_t x = 0; x < TileWidth; x++)
+				{
+					maxDepth = std::max(maxDepth, tile[static_cast<size_t>(y) * Params.Width + x]);
+				}
+			}
+			TileDepth[ty * TilesX + tx] = maxDepth;
+#endif
+		}
+	}
+	Stats.RasterMilliseconds += GetMilliseconds(start);
+}
+
+bool OSoftwareOcclusionCuller::IsVisible(const SOcclusionMatrix& LocalToClip, const float Center[3], const float Extents[3])
+{
+	if (Stats.NumOccluders == 0)
+	{
+		return true;
+	}
+
+	Stats.NumTests++;
+
+	bool bVisible = false;
+	SScreenBounds bounds;
+	if (!ProjectBox(LocalToClip, Center, Extents, bounds))
+	{
+		bVisible = true;
+	}
+	else
+	{
+		// Every pixel the bounds touch, bounds outside of the screen are left to the frustum culling
+		const int32_t minX = std::max(static_cast<int32_t>(std::floor(bounds.MinX)), 0);
+		const int32_t maxX = std::min(static_cast<int32_t>(std::ceil(bounds.MaxX)) - 1, static_cast<int32_t>(Params.Width) - 1);
+		const int32_t minY = std::max(static_cast<int32_t>(std::floor(bounds.MinY)), 0);
+		const int32_t maxY = std::min(static_cast<int32_t>(std::ceil(bounds.MaxY)) - 1, static_cast<int32_t>(Params.Height) - 1);
+		bVisible = minX > maxX || minY > maxY;
+
+		for (int32_t ty = minY / TileHeight; ty <= maxY / static_cast<int32_t>(TileHeight) && !bVisible; ty++)
+		{
+			for (int32_t tx = minX / TileWidth; tx <= maxX / static_cast<int32_t>(TileWidth) && !bVisible; tx++)
+			{
+				if (TileDepth[ty * TilesX + tx] < bounds.MinZ)
+				{
+					continue;
+				}
+
+				const int32_t x0 = std::max(minX, tx * static_cast<int32_t>(TileWidth));
+				const int32_t x1 = std::min(maxX, (tx + 1) * static_cast<int32_t>(TileWidth) - 1);
+				const int32_t y0 = std::max(minY, ty * static_cast<int32_t>(TileHeight));
+				const int32_t y1 = std::min(maxY, (ty + 1) * static_cast<int32_t>(TileHeight) - 1);
+				for (int32_t y = y0; y <= y1 && !bVisible; y++)
+				{
+					const float* row = &Depth[static_cast<size_t>(y) * Params.Width];
+					for (int32_t x = x0; x <= x1; x++)
+					{
+						if (row[x] >= bounds.MinZ)
+						{
+							bVisible = true;
+							break;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	Stats.NumOccluded += bVisible ? 0 : 1;
+	return bVisible;
+}
+
+const std::vector<float>& OSoftwareOcclusionCuller::GetDepth() const
+{
+	return Depth;
+}
+
+const std::vector<float>& OSoftwareOcclusionCuller::GetTileDepth() const
+{
+	return TileDepth;
+}
+
+const SOcclusionStats& OSoftwareOcclusionCuller::GetStats() const
+{
+	return Stats;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/*
+ * CPU occlusion culling against a low resolution depth buffer.
+ * Occluders are rasterized four pixels at a time, every pixel keeps the farthest depth the covering triangle has inside of it.
+ * The per tile maximum forms a coarse HiZ level: bounds are tested against the tiles and only the tiles that could not reject them are tested per pixel.
+ * Matrices use the DirectXMath row vector convention (clip = p * M), depth is 0 at the near plane and 1 at the far one. No D3D dependencies.
+ */
+
+struct SOcclusionMatrix
+{
+	float M[4][4] = {};
+};
+
+struct SOcclusionParams
+{
+	// Multiples of the tile size
+	uint32_t Width = 256;
+	uint32_t Height = 128;
+
+	// Projected bounds have to cover at least this fraction of the screen to be picked as an occluder
+	float MinOccluderArea = 0.02f;
+	uint32_t MaxOccluders = 32;
+	uint32_t MaxOccluderTriangles = 64 * 1024;
+
+	bool operator==(const SOcclusionParams&) const = default;
+};
+
+struct SOcclusionStats
+{
+	uint32_t NumOccluders = 0;
+	uint32_t NumOccluderTriangles = 0;
+	uint32_t NumRasterizedTriangles = 0;
+	uint32_t NumTests = 0;
+	uint32_t NumOccluded = 0;
+	float RasterMilliseconds = 0.0f;
+};
+
+class OSoftwareOcclusionCuller
+{
+public:
+	static constexpr uint32_t TileWidth = 8;
+	static constexpr uint32_t TileHeight = 4;
+
+	void SetParams(const SOcclusionParams& Params);
+	const SOcclusionParams& GetParams() const;
+
+	/** @brief Resets the depth buffer to the far plane and clears the stats */
+	void Clear();
+
+	/** @brief Fraction of the screen covered by the projected box: 0 if it is off screen, 1 if it crosses the near plane */
+	float GetScreenArea(const SOcclusionMatrix& LocalToClip, const float Center[3], const float Extents[3]) const;
+
+	/** @brief Rasterizes the clockwise triangles, indices are relative to Positions (xyz triplets) */
+	void RasterizeOccluder(const SOcclusionMatrix& LocalToClip, const float* Positions, uint32_t NumVertices, const uint32_t* Indices, uint32_t NumIndices);
+
+	/** @brief Builds the tile depth, has to be called after the last occluder */
+	void Finalize();
+
+	/** @brief False only if the box is hidden behind the occluders */
+	bool IsVisible(const SOcclusionMatrix& LocalToClip, const float Center[3], const float Extents[3]);
+
+	// Rows go from the top of the screen
+	const std::vector<float>& GetDepth() const;
+	const std::vector<float>& GetTileDepth() const;
+	const SOcclusionStats& GetStats() const;
+
+private:
+	struct SScreenBounds
+	{
+		float MinX, MinY, MaxX, MaxY;
+		float MinZ;
+	};
+
+	// False if the box crosses the near plane
+	bool ProjectBox(const SOcclusionMatrix& LocalToClip, const float Center[3], const float Extents[3], SScreenBounds& OutBounds) const;
+	void RasterizeTriangle(const float* V0, const float* V1, const float* V2);
+
+	SOcclusionParams Params;
+	uint32_t TilesX = 0;
+	uint32_t TilesY = 0;
+
+	std::vector<float> Depth;
+	std::vector<float> TileDepth;
+	std::vector<float> ScreenVertices;
+	SOcclusionStats Stats;
+};
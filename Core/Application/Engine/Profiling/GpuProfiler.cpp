@@ -0,0 +1,143 @@
+#include "GpuProfiler.h"
+
+#include "Exception.h"
+#include "FrameProfiler.h"
+#include "Logger.h"
+
+namespace
+{
+constexpr uint32_t QueriesPerFrame = OGpuProfiler::MaxScopes * 2;
+}
+
+OGpuProfiler::OGpuProfiler(ID3D12Device* Device, ID3D12CommandQueue* InQueue)
+    : Queue(InQueue)
+{
+	D3D12_QUERY_HEAP_DESC desc = {};
+	desc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+	desc.Count = QueriesPerFrame * SRenderConstants::NumFrameResources;
+	THROW_IF_FAILED(Device->CreateQueryHeap(&desc, IID_PPV_ARGS(&QueryHeap)));
+
+	const auto property = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK);
+	const auto buffer = CD3DX12_RESOURCE_DESC::Buffer(sizeof(uint64_t) * desc.Count);
+	THROW_IF_FAILED(Device->CreateCommittedResource(&property,
+	                                                D3D12_HEAP_FLAG_NONE,
+	                                                &buffer,
+	                                                D3D12_RESOURCE_STATE_COPY_DEST,
+	                                                nullptr,
+	                                                IID_PPV_ARGS(&ReadbackBuffer)));
+	ReadbackBuffer->SetName(L"GpuProfilerReadback");
+	Calibrate();
+}
+
+void OGpuProfiler::Calibrate()
+{
+	THROW_IF_FAILED(Queue->GetTimestampFrequency(&Frequency));
+	uint64_t cpuTicks = 0;
+	THROW_IF_FAILED(Queue->GetClockCalibration(&CalibrationGpuTicks, &cpuTicks));
+
+	// The calibration comes as a QPC value, take its distance to the steady clock from a fresh sample
+	LARGE_INTEGER counter;
+	LARGE_INTEGER counterFrequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&counterFrequency);
+	const uint64_t steady = OFrameProfiler::SteadyNanoseconds();
+	const auto sinceCalibration = static_cast<double>(counter.QuadPart - static_cast<int64_t>(cpuTicks)) * 1.0e9 / static_cast<double>(counterFrequency.QuadPart);
+	CalibrationNanoseconds = steady - static_cast<uint64_t>(sinceCalibration);
+}
+
+void OGpuProfiler::BeginFrame(uint32_t FrameResourceIndex)
+{
+	CurrentFrame = FrameResourceIndex % SRenderConstants::NumFrameResources;
+	auto& frame = Frames[CurrentFrame];
+	auto& profiler = OFrameProfiler::Get();
+	if (frame.bResolved && !frame.Scopes.empty() && profiler.IsEnabled())
+	{
+		const uint32_t first = CurrentFrame * QueriesPerFrame;
+		const D3D12_RANGE range = { first * sizeof(uint64_t), (first + frame.NumQueries) * sizeof(uint64_t) };
+		void* data = nullptr;
+		if (SUCCEEDED(ReadbackBuffer->Map(0, &range, &data)))
+		{
+			const auto timestamps = static_cast<const uint64_t*>(data) + first;
+			const double nanosecondsPerTick = 1.0e9 / static_cast<double>(Frequency);
+			for (const auto& scope : frame.Scopes)
+			{
+				const uint64_t start = timestamps[scope.Query];
+				const uint64_t end = timestamps[scope.Query + 1];
+				if (end < start)
+				{
+					continue;
+				}
+				const auto startNs = CalibrationNanoseconds + static_cast<int64_t>(static_cast<double>(static_cast<int64_t>(start - CalibrationGpuTicks)) * nanosecondsPerTick);
+				profiler.AddGpuScope(scope.Name, startNs, startNs + static_cast<uint64_t>(static_cast<double>(end - start) * nanosecondsPerTick));
+			}
+			const D3D12_RANGE written = { 0, 0 };
+			ReadbackBuffer->Unmap(0, &written);
+		}
+	}
+
+	frame.Scopes.clear();
+	frame.NumQueries = 0;
+	frame.bResolved = false;
+	OpenScopes.clear();
+
+	bRecording = profiler.IsEnabled();
+	if (bRecording)
+	{
+		// The clocks drift apart over a long session
+		Calibrate();
+	}
+}
+
+void OGpuProfiler::BeginScope(ID3D12GraphicsCommandList* CommandList, const string& Name)
+{
+	auto& frame = Frames[CurrentFrame];
+	if (!bRecording || frame.bResolved)
+	{
+		return;
+	}
+	if (frame.NumQueries + 2 > QueriesPerFrame)
+	{
+		LOG(Render, Warning, "Out of GPU profiler queries, scope {} is skipped", TEXT(Name));
+		return;
+	}
+
+	SScope scope;
+	scope.Name = OFrameProfiler::Get().InternName(Name);
+	scope.Query = frame.NumQueries;
+	frame.NumQueries += 2;
+	CommandList->EndQuery(QueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, CurrentFrame * QueriesPerFrame + scope.Query);
+	OpenScopes.push_back(static_cast<uint32_t>(frame.Scopes.size()));
+	frame.Scopes.push_back(scope);
+}
+
+void OGpuProfiler::EndScope(ID3D12GraphicsCommandList* CommandList)
+{
+	auto& frame = Frames[CurrentFrame];
+	if (!bRecording || frame.bResolved || OpenScopes.empty())
+	{
+		return;
+	}
+	const auto& scope = frame.Scopes[OpenScopes.back()];
+	OpenScopes.pop_back();
+	CommandList->EndQuery(QueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, CurrentFrame * QueriesPerFrame + scope.Query + 1);
+}
+
+void OGpuProfiler::Resolve(ID3D12GraphicsCommandList* CommandList)
+{
+	auto& frame = Frames[CurrentFrame];
+	if (!bRecording || frame.bResolved)
+	{
+		return;
+	}
+	while (!OpenScopes.empty())
+	{
+		EndScope(CommandList);
+	}
+	frame.bResolved = true;
+	if (frame.NumQueries == 0)
+	{
+		return;
+	}
+	const uint32_t first = CurrentFrame * QueriesPerFrame;
+	CommandList->ResolveQueryData(QueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, first, frame.NumQueries, ReadbackBuffer.Get(), first * sizeof(uint64_t));
+}
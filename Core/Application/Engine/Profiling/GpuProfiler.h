@@ -0,0 +1,56 @@
+#pragma once
+#include "DirectX/DXHelper.h"
+#include "DirectX/RenderConstants.h"
+#include "Types.h"
+
+/*
+ * Timestamp queries around the work recorded on the direct queue, one range of the query heap per frame resource.
+ * Results are read back once the frame resource is reused, converted to the steady clock and handed to OFrameProfiler.
+ * Only records while the frame profiler is enabled.
+ */
+class OGpuProfiler
+{
+public:
+	static constexpr uint32_t MaxScopes = 128;
+
+	OGpuProfiler(ID3D12Device* Device, ID3D12CommandQueue* Queue);
+
+	/** @brief Reads back the scopes of the previous use of the frame resource, its fence has to be completed */
+	void BeginFrame(uint32_t FrameResourceIndex);
+
+	void BeginScope(ID3D12GraphicsCommandList* CommandList, const string& Name);
+	void EndScope(ID3D12GraphicsCommandList* CommandList);
+
+	/** @brief Closes the open scopes and copies the timestamps to the readback buffer, scopes after it are ignored until the next frame */
+	void Resolve(ID3D12GraphicsCommandList* CommandList);
+
+private:
+	void Calibrate();
+
+	struct SScope
+	{
+		const char* Name = nullptr;
+		uint32_t Query = 0;
+	};
+
+	struct SFrame
+	{
+		vector<SScope> Scopes;
+		uint32_t NumQueries = 0;
+		bool bResolved = false;
+	};
+
+	ComPtr<ID3D12QueryHeap> QueryHeap;
+	ComPtr<ID3D12Resource> ReadbackBuffer;
+	ID3D12CommandQueue* Queue = nullptr;
+
+	array<SFrame, SRenderConstants::NumFrameResources> Frames;
+	vector<uint32_t> OpenScopes;
+	uint32_t CurrentFrame = 0;
+	bool bRecording = false;
+
+	// GPU ticks to steady clock nanoseconds
+	uint64_t Frequency = 1;
+	uint64_t CalibrationGpuTicks = 0;
+	uint64_t CalibrationNanoseconds = 0;
+};
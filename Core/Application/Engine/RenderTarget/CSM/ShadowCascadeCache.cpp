@@ -0,0 +1,198 @@
+#include "ShadowCascadeCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+using SVec3 = std::array<float, 3>;
+
+float Dot(const SVec3& A, const SVec3& B)
+{
+	return A[0] * B[0] + A[1] * B[1] + A[2] * B[2];
+}
+
+SVec3 Cross(const SVec3& A, const SVec3& B)
+{
+	return { A[1] * B[2] - A[2] * B[1], A[2] * B[0] - A[0] * B[2], A[0] * B[1] - A[1] * B[0] };
+}
+
+SVec3 Normalize(const SVec3& A)
+{
+	const float length = std::sqrt(Dot(A, A));
+	if (length <= 0.0f)
+	{
+		return { 0, 0, 1 };
+	}
+	return { A[0] / length, A[1] / length, A[2] / length };
+}
+
+// Builds the light space plane the shadow map is projected on, matches the look at basis used by the light
+void BuildLightBasis(const SVec3& Direction, SVec3& OutRight, SVec3& OutUp)
+{
+	const auto dir = Normalize(Direction);
+	SVec3 up = { 0, 1, 0 };
+	if (std::abs(Dot(dir, up)) > 0.999f)
+	{
+		up = { 0, 0, 1 };
+	}
+	OutRight = Normalize(Cross(up, dir));
+	OutUp = Cross(dir, OutRight);
+}
+} // namespace
+
+const char* ToString(EShadowCacheInvalidation Reason)
+{
+	switch (Reason)
+	{
+	case EShadowCacheInvalidation::None:
+		return "None";
+	case EShadowCacheInvalidation::Empty:
+		return "Empty";
+	case EShadowCacheInvalidation::Forced:
+		return "Forced";
+	case EShadowCacheInvalidation::LightDirection:
+		return "LightDirection";
+	case EShadowCacheInvalidation::Radius:
+		return "Radius";
+	case EShadowCacheInvalidation::Moved:
+		return "Moved";
+	case EShadowCacheInvalidation::StaticCasters:
+		return "StaticCasters";
+	}
+	return "Unknown";
+}
+
+OShadowCascadeCache::OShadowCascadeCache(uint32_t NumCascades, const SShadowCascadeCacheSettings& InSettings)
+    : Settings(InSettings), Cascades(NumCascades)
+{
+}
+
+EShadowCacheInvalidation OShadowCascadeCache::Evaluate(uint32_t Cascade, const SShadowCascadeKey& Key) const
+{
+	if (Cascade >= Cascades.size())
+	{
+		return EShadowCacheInvalidation::Forced;
+	}
+
+	const auto& cached = Cascades[Cascade];
+	if (!cached.bValid)
+	{
+		return EShadowCacheInvalidation::Empty;
+	}
+
+	if (cached.Key.StaticGeneration != Key.StaticGeneration)
+	{
+		return EShadowCacheInvalidation::StaticCasters;
+	}
+
+	if (1.0f - Dot(Normalize(cached.Key.LightDirection), Normalize(Key.LightDirection)) > Settings.DirectionTolerance)
+	{
+		return EShadowCacheInvalidation::LightDirection;
+	}
+
+	if (std::abs(cached.Key.Radius - Key.Radius) > Settings.RadiusTolerance * std::max(cached.Key.Radius, 1.0f))
+	{
+		return EShadowCacheInvalidation::Radius;
+	}
+
+	// A radius grown within the tolerance takes its share of the padding as well
+	const float texelWorldSize = 2.0f * cached.PaddedRadius / static_cast<float>(std::max(Settings.MapSize, 1u));
+	const float growth = std::max(Key.Radius - cached.Key.Radius, 0.0f) / texelWorldSize;
+	if (GetTexelDrift(Cascade, Key.Center) + growth > Settings.TexelThreshold)
+	{
+		return EShadowCacheInvalidation::Moved;
+	}
+
+	return EShadowCacheInvalidation::None;
+}
+
+bool OShadowCascadeCache::NeedsRebuild(uint32_t Cascade, const SShadowCascadeKey& Key)
+{
+	const auto reason = Evaluate(Cascade, Key);
+	if (Cascade < Cascades.size())
+	{
+		auto& cached = Cascades[Cascade];
+		if (reason == EShadowCacheInvalidation::None)
+		{
+			cached.NumHits++;
+		}
+		else
+		{
+			cached.LastInvalidation = reason;
+		}
+	}
+	return reason != EShadowCacheInvalidation::None;
+}
+
+float OShadowCascadeCache::Commit(uint32_t Cascade, const SShadowCascadeKey& Key)
+{
+	const float padded = GetPaddedRadius(Key.Radius);
+	if (Cascade >= Cascades.size())
+	{
+		return padded;
+	}
+
+	auto& cached = Cascades[Cascade];
+	cached.Key = Key;
+	cached.PaddedRadius = padded;
+	cached.bValid = true;
+	cached.NumRebuilds++;
+	return padded;
+}
+
+void OShadowCascadeCache::Invalidate(uint32_t Cascade)
+{
+	if (Cascade < Cascades.size())
+	{
+		Cascades[Cascade].bValid = false;
+	}
+}
+
+void OShadowCascadeCache::InvalidateAll()
+{
+	for (auto& cascade : Cascades)
+	{
+		cascade.bValid = false;
+	}
+}
+
+float OShadowCascadeCache::GetPaddedRadius(float Radius) const
+{
+	// The padding is expressed in texels of the padded map itself: padded = radius + threshold * (2 * padded / size)
+	const float fraction = 2.0f * Settings.TexelThreshold / static_cast<float>(std::max(Settings.MapSize, 1u));
+	if (fraction >= 0.5f)
+	{
+		return Radius * 2.0f;
+	}
+	return Radius / (1.0f - fraction);
+}
+
+float OShadowCascadeCache::GetTexelDrift(uint32_t Cascade, const std::array<float, 3>& Center) const
+{
+	if (Cascade >= Cascades.size() || !Cascades[Cascade].bValid || Cascades[Cascade].PaddedRadius <= 0.0f)
+	{
+		return std::numeric_limits<float>::max();
+	}
+
+	const auto& cached = Cascades[Cascade];
+	SVec3 right, up;
+	BuildLightBasis(cached.Key.LightDirection, right, up);
+
+	const SVec3 delta = { Center[0] - cached.Key.Center[0], Center[1] - cached.Key.Center[1], Center[2] - cached.Key.Center[2] };
+	const float texelWorldSize = 2.0f * cached.PaddedRadius / static_cast<float>(std::max(Settings.MapSize, 1u));
+
+	// Movement along the light direction is covered by the depth range of the cascade
+	return std::max(std::abs(Dot(delta, right)), std::abs(Dot(delta, up))) / texelWorldSize;
+}
+
+const SCachedShadowCascade& OShadowCascadeCache::GetCascade(uint32_t Cascade) const
+{
+	return Cascades.at(Cascade);
+}
+
+uint32_t OShadowCascadeCache::GetNumCascades() const
+{
+	return static_cast<uint32_t>(Cascades.size());
+}
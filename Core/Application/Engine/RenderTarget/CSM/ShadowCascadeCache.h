@@ -0,0 +1,83 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/*
+ * CPU side bookkeeping of the cached static shadow casters.
+ * Every cascade renders its static casters once into a cached depth layer with a slightly padded radius,
+ * the layer is reused until the cascade bounds drift further than the padding allows. No D3D dependencies.
+ */
+
+enum class EShadowCacheInvalidation : uint8_t
+{
+	None,
+	Empty,
+	Forced,
+	LightDirection,
+	Radius,
+	Moved,
+	StaticCasters
+};
+
+const char* ToString(EShadowCacheInvalidation Reason);
+
+struct SShadowCascadeKey
+{
+	std::array<float, 3> LightDirection = { 0, 0, 0 };
+	std::array<float, 3> Center = { 0, 0, 0 };
+	float Radius = 0.0f;
+	uint64_t StaticGeneration = 0;
+};
+
+struct SShadowCascadeCacheSettings
+{
+	uint32_t MapSize = 2048;
+
+	// How many texels the cascade center may drift before the cache is rebuilt
+	float TexelThreshold = 8.0f;
+
+	// 1 - dot(old, new)
+	float DirectionTolerance = 1e-5f;
+
+	// Relative to the cached radius
+	float RadiusTolerance = 1e-3f;
+};
+
+struct SCachedShadowCascade
+{
+	SShadowCascadeKey Key;
+	float PaddedRadius = 0.0f;
+	bool bValid = false;
+	uint32_t NumRebuilds = 0;
+	uint32_t NumHits = 0;
+	EShadowCacheInvalidation LastInvalidation = EShadowCacheInvalidation::Empty;
+};
+
+class OShadowCascadeCache
+{
+public:
+	explicit OShadowCascadeCache(uint32_t NumCascades, const SShadowCascadeCacheSettings& InSettings = {});
+
+	/** @brief Returns the reason the cascade has to be re-rendered, None if the cached layer can be reused */
+	EShadowCacheInvalidation Evaluate(uint32_t Cascade, const SShadowCascadeKey& Key) const;
+
+	/** @brief Evaluates the cascade and updates the statistics, returns true if the cascade has to be re-rendered */
+	bool NeedsRebuild(uint32_t Cascade, const SShadowCascadeKey& Key);
+
+	/** @brief Records that the cascade was rendered for the given key, returns the radius the cascade has to be rendered with */
+	float Commit(uint32_t Cascade, const SShadowCascadeKey& Key);
+
+	void Invalidate(uint32_t Cascade);
+	void InvalidateAll();
+
+	float GetPaddedRadius(float Radius) const;
+	float GetTexelDrift(uint32_t Cascade, const std::array<float, 3>& Center) const;
+	const SCachedShadowCascade& GetCascade(uint32_t Cascade) const;
+	uint32_t GetNumCascades() const;
+
+	SShadowCascadeCacheSettings Settings;
+
+private:
+	std::vector<SCachedShadowCascade> Cascades;
+};
@@ -38,7 +38,7 @@ void ODynamicCubeMapRenderTarget::SetBoundRenderItem(const shared_ptr<ORenderIte
 	OCubeRenderTarget::SetBoundRenderItem(Item);
 	Item->GetDefaultInstance()->PositionChanged.Add([this](STransform Transform) {
 		// Update the render item's world matrix.
-		Position = RenderItem.lock()->GetDefaultInstance()->HlslData.Position;
+		Position = RenderItem.lock()->GetDefaultInstance()->Params.Position;
 		CalculateCameras();
 	});
 }
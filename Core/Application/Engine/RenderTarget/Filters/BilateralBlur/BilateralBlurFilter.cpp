@@ -3,6 +3,7 @@
 #include "BilateralBlurFilter.h"
 
 #include "DirectX/ShaderTypes.h"
+#include "Engine/Engine.h"
 
 OBilateralBlurFilter::OBilateralBlurFilter(const weak_ptr<ODevice>& Device, OCommandQueue* Other, UINT Width, UINT Height, DXGI_FORMAT Format)
     : OFilterBase(Device, Other, Width, Height, Format)
@@ -76,10 +77,10 @@ void OBilateralBlurFilter::BuildResource()
 	texDesc.SampleDesc.Quality = 0;
 	texDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
 	texDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
-	auto device = Device.lock()->GetDevice();
+	auto transients = OEngine::Get()->GetTransientResources();
 	auto weak = weak_from_this();
-	OutputTexture = Utils::CreateResource(weak, L"OutupTexture", device, D3D12_HEAP_TYPE_DEFAULT, texDesc, D3D12_RESOURCE_STATE_COMMON);
-	InputTexture = Utils::CreateResource(weak, L"InputTexture", device, D3D12_HEAP_TYPE_DEFAULT, texDesc, D3D12_RESOURCE_STATE_COMMON);
+	OutputTexture = transients->Declare(weak, L"OutupTexture", texDesc, D3D12_RESOURCE_STATE_COMMON);
+	InputTexture = transients->Declare(weak, L"InputTexture", texDesc, D3D12_RESOURCE_STATE_COMMON);
 }
 
 bool OBilateralBlurFilter::Execute(const SPSODescriptionBase* PSO, SResourceInfo* Input)
@@ -2,6 +2,7 @@
 
 #include "DirectX/ShaderTypes.h"
 #include "Engine/Device/Device.h"
+#include "Engine/Engine.h"
 #include "Logger.h"
 
 OGaussianBlurFilter::OGaussianBlurFilter(const shared_ptr<ODevice>& Device, OCommandQueue* Other, UINT Width, UINT Height, DXGI_FORMAT Format)
@@ -75,12 +76,12 @@ void OGaussianBlurFilter::BuildResource()
 	texDesc.SampleDesc.Quality = 0;
 	texDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
 	texDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
-	auto device = Device.lock();
+	auto transients = OEngine::Get()->GetTransientResources();
 	auto weak = weak_from_this();
-	BlurMap0 = Utils::CreateResource(weak, L"BlurMap0", device->GetDevice(), D3D12_HEAP_TYPE_DEFAULT, texDesc, D3D12_RESOURCE_STATE_COMMON);
-	BlurMap1 = Utils::CreateResource(weak, L"BlurMap1", device->GetDevice(), D3D12_HEAP_TYPE_DEFAULT, texDesc, D3D12_RESOURCE_STATE_COMMON);
+	BlurMap0 = transients->Declare(weak, L"BlurMap0", texDesc, D3D12_RESOURCE_STATE_COMMON);
+	BlurMap1 = transients->Declare(weak, L"BlurMap1", texDesc, D3D12_RESOURCE_STATE_COMMON);
 
-	InputMap = Utils::CreateResource(weak, L"InputMap", device->GetDevice(), D3D12_HEAP_TYPE_DEFAULT, texDesc, D3D12_RESOURCE_STATE_COMMON);
+	InputMap = transients->Declare(weak, L"InputMap", texDesc, D3D12_RESOURCE_STATE_COMMON);
 }
 
 bool OGaussianBlurFilter::Execute(
@@ -28,8 +28,10 @@ public:
 		return FilterName;
 	}
 
-protected:
+	/** @brief Rewrites the views in place, the targets are transient and get new resources whenever the pool compiles */
 	virtual void BuildDescriptors() = 0;
+
+protected:
 	virtual void BuildResource() = 0;
 
 	OCommandQueue* Queue = nullptr;
@@ -52,7 +54,7 @@ inline void OFilterBase::OnResize(UINT NewWidth, UINT NewHeight)
 		Width = NewWidth;
 		Height = NewHeight;
 
+		// Views are rebuilt once the transient pool placed the new targets
 		BuildResource();
-		BuildDescriptors();
 	}
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "SobelFilter.h"
 
 #include "DirectX/ShaderTypes.h"
+#include "Engine/Engine.h"
 
 OSobelFilter::OSobelFilter(const weak_ptr<ODevice>& Device, OCommandQueue* Other, UINT Width, UINT Height, DXGI_FORMAT Format)
     : OFilterBase(Device, Other, Width, Height, Format)
@@ -48,10 +49,10 @@ void OSobelFilter::BuildResource()
 	texDesc.SampleDesc.Quality = 0;
 	texDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
 	texDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
-	auto device = Device.lock()->GetDevice();
+	auto transients = OEngine::Get()->GetTransientResources();
 	auto weak = weak_from_this();
-	Output = Utils::CreateResource(weak, L"Output", device, D3D12_HEAP_TYPE_DEFAULT, texDesc);
-	Input = Utils::CreateResource(weak, L"Input", device, D3D12_HEAP_TYPE_DEFAULT, texDesc);
+	Output = transients->Declare(weak, L"Output", texDesc, D3D12_RESOURCE_STATE_GENERIC_READ);
+	Input = transients->Declare(weak, L"Input", texDesc, D3D12_RESOURCE_STATE_GENERIC_READ);
 }
 
 bool OSobelFilter::Execute(SPSODescriptionBase* PSO, ORenderTargetBase* InTarget)
@@ -0,0 +1,239 @@
+#include "DescriptorAllocator.h"
+
+void ODescriptorAllocator::Init(uint32_t InBaseIndex, uint32_t InNumPersistent, uint32_t InNumTransient)
+{
+	Reset();
+	BaseIndex = InBaseIndex;
+	NumPersistent = InNumPersistent;
+	NumTransient = InNumTransient;
+
+	FreeSizeAtStart.assign(NumPersistent, 0);
+	FreeStartAtEnd.assign(NumPersistent, InvalidIndex);
+	NextFree.assign(NumPersistent, InvalidIndex);
+	PrevFree.assign(NumPersistent, InvalidIndex);
+	if (NumPersistent > 0)
+	{
+		LinkFreeRange(0, NumPersistent);
+		NumFree = NumPersistent;
+	}
+	Frames.emplace_back();
+}
+
+void ODescriptorAllocator::Reset()
+{
+	BaseIndex = 0;
+	NumPersistent = 0;
+	NumTransient = 0;
+	NumFree = 0;
+	NumLive = 0;
+	FreeSizeAtStart.clear();
+	FreeStartAtEnd.clear();
+	NextFree.clear();
+	PrevFree.clear();
+	FreeHead = InvalidIndex;
+	Slots.clear();
+	FreeSlots.clear();
+	TransientHead = 0;
+	TransientUsed = 0;
+	Frames.clear();
+}
+
+SDescriptorID ODescriptorAllocator::Allocate(uint32_t Count)
+{
+	if (Count == 0 || Count > NumFree)
+	{
+		return {};
+	}
+
+	// The head always fits a single descriptor, larger ranges walk the list
+	uint32_t offset = FreeHead;
+	while (offset != InvalidIndex && FreeSizeAtStart[offset] < Count)
+	{
+		offset = NextFree[offset];
+	}
+	if (offset == InvalidIndex)
+	{
+		return {};
+	}
+
+	const uint32_t size = FreeSizeAtStart[offset];
+	UnlinkFreeRange(offset);
+	if (size > Count)
+	{
+		LinkFreeRange(offset + Count, size - Count);
+	}
+	NumFree -= Count;
+
+	uint32_t slotIndex;
+	if (!FreeSlots.empty())
+	{
+		slotIndex = FreeSlots.back();
+		FreeSlots.pop_back();
+	}
+	else
+	{
+		slotIndex = static_cast<uint32_t>(Slots.size());
+		Slots.emplace_back();
+	}
+
+	auto& slot = Slots[slotIndex];
+	slot.Offset = offset;
+	slot.Count = Count;
+	slot.bLive = true;
+	NumLive++;
+	return { slotIndex, slot.Generation };
+}
+
+void ODescriptorAllocator::Free(SDescriptorID ID)
+{
+	if (!FindSlot(ID) || Frames.empty())
+	{
+		return;
+	}
+
+	auto& slot = Slots[ID.Slot];
+	slot.bLive = false;
+	slot.Generation = slot.Generation == UINT32_MAX ? 1 : slot.Generation + 1;
+	FreeSlots.push_back(ID.Slot);
+	NumLive--;
+	Frames.back().Frees.push_back({ slot.Offset, slot.Count });
+}
+
+bool ODescriptorAllocator::IsValid(SDescriptorID ID) const
+{
+	return FindSlot(ID) != nullptr;
+}
+
+uint32_t ODescriptorAllocator::GetIndex(SDescriptorID ID) const
+{
+	const auto slot = FindSlot(ID);
+	return slot ? BaseIndex + slot->Offset : InvalidIndex;
+}
+
+uint32_t ODescriptorAllocator::GetCount(SDescriptorID ID) const
+{
+	const auto slot = FindSlot(ID);
+	return slot ? slot->Count : 0;
+}
+
+uint32_t ODescriptorAllocator::AllocateTransient(uint32_t Count)
+{
+	if (Count == 0 || Frames.empty() || TransientUsed + Count > NumTransient)
+	{
+		return InvalidIndex;
+	}
+
+	// Ranges are contiguous, the tail of the ring is skipped and released along with the frame
+	uint32_t padding = 0;
+	if (TransientHead + Count > NumTransient)
+	{
+		padding = NumTransient - TransientHead;
+		if (TransientUsed + padding + Count > NumTransient)
+		{
+			return InvalidIndex;
+		}
+		TransientHead = 0;
+	}
+
+	const uint32_t offset = TransientHead;
+	TransientHead = (TransientHead + Count) % NumTransient;
+	TransientUsed += padding + Count;
+	Frames.back().TransientCount += padding + Count;
+	return BaseIndex + NumPersistent + offset;
+}
+
+void ODescriptorAllocator::EndFrame(uint64_t Fence)
+{
+	if (Frames.empty())
+	{
+		return;
+	}
+	Frames.back().Fence = Fence;
+	Frames.emplace_back();
+}
+
+void ODescriptorAllocator::Retire(uint64_t CompletedFence)
+{
+	while (Frames.size() > 1 && Frames.front().Fence <= CompletedFence)
+	{
+		const auto& frame = Frames.front();
+		for (const auto& range : frame.Frees)
+		{
+			ReleaseRange(range.Offset, range.Count);
+		}
+		TransientUsed -= frame.TransientCount;
+		Frames.pop_front();
+	}
+
+	if (TransientUsed == 0)
+	{
+		TransientHead = 0;
+	}
+}
+
+const ODescriptorAllocator::SSlot* ODescriptorAllocator::FindSlot(SDescriptorID ID) const
+{
+	if (ID.Slot >= Slots.size())
+	{
+		return nullptr;
+	}
+	const auto& slot = Slots[ID.Slot];
+	return slot.bLive && slot.Generation == ID.Generation ? &slot : nullptr;
+}
+
+void ODescriptorAllocator::LinkFreeRange(uint32_t Offset, uint32_t Count)
+{
+	FreeSizeAtStart[Offset] = Count;
+	FreeStartAtEnd[Offset + Count - 1] = Offset;
+	PrevFree[Offset] = InvalidIndex;
+	NextFree[Offset] = FreeHead;
+	if (FreeHead != InvalidIndex)
+	{
+		PrevFree[FreeHead] = Offset;
+	}
+	FreeHead = Offset;
+}
+
+void ODescriptorAllocator::UnlinkFreeRange(uint32_t Offset)
+{
+	const uint32_t count = FreeSizeAtStart[Offset];
+	FreeSizeAtStart[Offset] = 0;
+	FreeStartAtEnd[Offset + count - 1] = InvalidIndex;
+
+	const uint32_t prev = PrevFree[Offset];
+	const uint32_t next = NextFree[Offset];
+	if (prev != InvalidIndex)
+	{
+		NextFree[prev] = next;
+	}
+	else
+	{
+		FreeHead = next;
+	}
+	if (next != InvalidIndex)
+	{
+		PrevFree[next] = prev;
+	}
+}
+
+void ODescriptorAllocator::ReleaseRange(uint32_t Offset, uint32_t Count)
+{
+	uint32_t start = Offset;
+	uint32_t count = Count;
+	if (Offset > 0 && FreeStartAtEnd[Offset - 1] != InvalidIndex)
+	{
+		start = FreeStartAtEnd[Offset - 1];
+		count += FreeSizeAtStart[start];
+		UnlinkFreeRange(start);
+	}
+
+	const uint32_t end = Offset + Count;
+	if (end < NumPersistent && FreeSizeAtStart[end] != 0)
+	{
+		count += FreeSizeAtStart[end];
+		UnlinkFreeRange(end);
+	}
+
+	LinkFreeRange(start, count);
+	NumFree += Count;
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/*
+ * Index allocator for a region of the shader visible CBV/SRV/UAV heap, it hands out heap indices and never touches the heap itself.
+ * The region is split in a persistent part and a transient ring:
+ *	- persistent ranges come from a free list with boundary tags, single descriptors are taken from the head of the list and
+ *	  released ranges merge with their neighbours in constant time
+ *	- transient ranges live for one frame, EndFrame stamps them with the fence of the frame and Retire gives them back
+ * Persistent ranges are referenced through generational handles, a freed handle stops resolving at once while its range
+ * waits for the fence of the frame it was freed in. No D3D dependencies.
+ */
+
+struct SDescriptorID
+{
+	uint32_t Slot = UINT32_MAX;
+	uint32_t Generation = 0;
+
+	bool operator==(const SDescriptorID&) const = default;
+};
+
+class ODescriptorAllocator
+{
+public:
+	static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+	/** @brief BaseIndex is the heap index of the first persistent descriptor, the transient ring follows the persistent part */
+	void Init(uint32_t BaseIndex, uint32_t NumPersistent, uint32_t NumTransient = 0);
+	void Reset();
+	bool IsInitialized() const { return NumPersistent + NumTransient > 0; }
+
+	/** @brief First fit range of Count descriptors, an invalid handle when the persistent part is exhausted */
+	SDescriptorID Allocate(uint32_t Count = 1);
+
+	/** @brief The handle is stale right away, the range is reused once the fence of the current frame completes */
+	void Free(SDescriptorID ID);
+
+	bool IsValid(SDescriptorID ID) const;
+
+	/** @brief Heap index of the first descriptor of the range, InvalidIndex for stale handles */
+	uint32_t GetIndex(SDescriptorID ID) const;
+	uint32_t GetCount(SDescriptorID ID) const;
+
+	/** @brief Heap index of Count contiguous descriptors valid until the end of the current frame, InvalidIndex when the ring is full */
+	uint32_t AllocateTransient(uint32_t Count = 1);
+
+	/** @brief Closes the frame being recorded, its frees and transient ranges are released once Fence completes */
+	void EndFrame(uint64_t Fence);
+
+	/** @brief Releases everything of the frames whose fence is not above CompletedFence */
+	void Retire(uint64_t CompletedFence);
+
+	uint32_t GetBaseIndex() const { return BaseIndex; }
+	uint32_t GetNumPersistent() const { return NumPersistent; }
+	uint32_t GetNumTransient() const { return NumTransient; }
+	uint32_t GetNumFree() const { return NumFree; }
+	uint32_t GetNumTransientUsed() const { return TransientUsed; }
+	uint32_t GetNumLive() const { return NumLive; }
+	uint32_t GetNumPendingFrames() const { return Frames.empty() ? 0 : static_cast<uint32_t>(Frames.size() - 1); }
+
+private:
+	struct SSlot
+	{
+		uint32_t Offset = 0;
+		uint32_t Count = 0;
+		uint32_t Generation = 1;
+		bool bLive = false;
+	};
+
+	struct SPendingFree
+	{
+		uint32_t Offset;
+		uint32_t Count;
+	};
+
+	struct SFrame
+	{
+		uint64_t Fence = 0;
+		uint32_t TransientCount = 0;
+		std::vector<SPendingFree> Frees;
+	};
+
+	const SSlot* FindSlot(SDescriptorID ID) const;
+	void LinkFreeRange(uint32_t Offset, uint32_t Count);
+	void UnlinkFreeRange(uint32_t Offset);
+	void ReleaseRange(uint32_t Offset, uint32_t Count);
+
+	uint32_t BaseIndex = 0;
+	uint32_t NumPersistent = 0;
+	uint32_t NumTransient = 0;
+	uint32_t NumFree = 0;
+	uint32_t NumLive = 0;
+
+	// Boundary tags of the free ranges, the size is kept at the first descriptor and the start at the last one
+	std::vector<uint32_t> FreeSizeAtStart;
+	std::vector<uint32_t> FreeStartAtEnd;
+
+	// Doubly linked list of the free ranges, indexed by their first descriptor
+	std::vector<uint32_t> NextFree;
+	std::vector<uint32_t> PrevFree;
+	uint32_t FreeHead = InvalidIndex;
+
+	std::vector<SSlot> Slots;
+	std::vector<uint32_t> FreeSlots;
+
+	uint32_t TransientHead = 0;
+	uint32_t TransientUsed = 0;
+
+	// The frame being recorded is the last one, older ones wait for their fence
+	std::deque<SFrame> Frames;
+};
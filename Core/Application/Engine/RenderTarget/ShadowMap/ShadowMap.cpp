@@ -3,6 +3,7 @@
 
 #include "Engine/Engine.h"
 #include "LightComponent/LightComponent.h"
+#include "Profiler.h"
 void OShadowMap::BuildResource()
 {
 	D3D12_RESOURCE_DESC texDesc;
@@ -25,6 +26,9 @@ void OShadowMap::BuildResource()
 	optClear.DepthStencil.Stencil = 0;
 
 	RenderTarget = Utils::CreateResource(weak_from_this(), L"ShadowMap_RenderTarget", Device.lock()->GetDevice(), D3D12_HEAP_TYPE_DEFAULT, texDesc, D3D12_RESOURCE_STATE_GENERIC_READ, &optClear);
+
+	// Depth of the static casters only, copied into the render target before the dynamic casters are drawn
+	StaticCache = Utils::CreateResource(weak_from_this(), L"ShadowMap_StaticCache", Device.lock()->GetDevice(), D3D12_HEAP_TYPE_DEFAULT, texDesc, D3D12_RESOURCE_STATE_GENERIC_READ, &optClear);
 }
 
 OShadowMap::OShadowMap(const weak_ptr<ODevice>& Device, UINT ShadowMapSize, DXGI_FORMAT Format)
@@ -54,6 +58,7 @@ void OShadowMap::BuildDescriptors()
 	dsvDesc.Format = SRenderConstants::DepthBufferDSVFormat;
 	dsvDesc.Texture2D.MipSlice = 0;
 	device->CreateDepthStencilView(RenderTarget, dsvDesc, DSV);
+	device->CreateDepthStencilView(StaticCache, dsvDesc, StaticCacheDSV);
 }
 
 void OShadowMap::BuildDescriptors(IDescriptor* Descriptor)
@@ -63,6 +68,7 @@ void OShadowMap::BuildDescriptors(IDescriptor* Descriptor)
 	{
 		SRV = desc->SRVHandle.Offset();
 		DSV = desc->DSVHandle.Offset();
+		StaticCacheDSV = desc->DSVHandle.Offset();
 		BuildResource();
 		BuildDescriptors();
 	}
@@ -75,7 +81,7 @@ SDescriptorPair OShadowMap::GetSRV(uint32_t SubtargetIdx) const
 
 SDescriptorPair OShadowMap::GetDSV(uint32_t SubtargetIdx) const
 {
-	return DSV;
+	return SubtargetIdx == StaticCacheSubtarget ? StaticCacheDSV : DSV;
 }
 
 SResourceInfo* OShadowMap::GetResource()
@@ -91,7 +97,7 @@ void OShadowMap::PrepareRenderTarget(OCommandQueue* Queue, bool ClearRenderTarge
 	}
 	PreparedTaregts.insert(SubtargetIdx);
 	auto depthStencilView = GetDSV(SubtargetIdx);
-	Utils::ResourceBarrier(Queue->GetCommandList().Get(), GetResource(), D3D12_RESOURCE_STATE_DEPTH_WRITE);
+	Utils::ResourceBarrier(Queue->GetCommandList().Get(), GetSubtargetResource(SubtargetIdx), D3D12_RESOURCE_STATE_DEPTH_WRITE);
 	Queue->ClearDepthStencil(depthStencilView);
 	Queue->SetRenderToDSVOnly(depthStencilView);
 	LOG(Engine, Log, "Setting render target in {} with address: null and depth stencil: [{}]", GetName(), TEXT(depthStencilView.CPUHandle.ptr));
@@ -124,8 +130,11 @@ void OShadowMap::SetPassConstants(const SPassConstants& Pass)
 	PassConstant.InvRenderTargetSize = DirectX::XMFLOAT2(1.0f / Width, 1.0f / Height);
 	if (ShadowMapInstancesBufferId.has_value())
 	{
-		const auto view = LightView;
-		InstancesInfo = OEngine::Get()->PerformBoundingBoxShadowCulling(BoundingGeometry.get(), view, ShadowMapInstancesBufferId.value());
+		CullInstances(true);
+		if (bUseStaticCache)
+		{
+			bNeedToUpdateStaticCache = true;
+		}
 	}
 	else
 	{
@@ -134,6 +143,56 @@ void OShadowMap::SetPassConstants(const SPassConstants& Pass)
 	bNeedToUpdate = true;
 }
 
+void OShadowMap::CullInstances(bool bCullStatic)
+{
+	if (!ShadowMapInstancesBufferId.has_value() || !BoundingGeometry)
+	{
+		return;
+	}
+
+	const auto engine = OEngine::Get();
+	const auto view = LightView;
+	if (bUseStaticCache)
+	{
+		// Static casters go first in the instance buffer and stay there until the cache is rebuilt
+		if (bCullStatic)
+		{
+			StaticInstancesInfo = engine->PerformBoundingBoxShadowCulling(BoundingGeometry.get(), view, ShadowMapInstancesBufferId.value(), EShadowCasterFilter::Static);
+		}
+		DynamicInstancesInfo = engine->PerformBoundingBoxShadowCulling(BoundingGeometry.get(), view, ShadowMapInstancesBufferId.value(), EShadowCasterFilter::Dynamic, StaticInstancesInfo.InstanceCount);
+	}
+	else
+	{
+		InstancesInfo = engine->PerformBoundingBoxShadowCulling(BoundingGeometry.get(), view, ShadowMapInstancesBufferId.value());
+	}
+	FrameCullGenerations[engine->UpdatingFrameResourceIndex] = ++CullGeneration;
+}
+
+bool OShadowMap::FillDraw(SShadowMapDraw& OutDraw)
+{
+	if (!ConsumeUpdate() || !IsValid())
+	{
+		return false;
+	}
+
+	// The instance buffer of this frame resource was filled by an older culling
+	if (FrameCullGenerations[OEngine::Get()->UpdatingFrameResourceIndex] != CullGeneration)
+	{
+		CullInstances(true);
+	}
+
+	OutDraw.Target = RenderTarget;
+	OutDraw.StaticCache = StaticCache;
+	OutDraw.DSV = DSV;
+	OutDraw.StaticCacheDSV = StaticCacheDSV;
+	OutDraw.PassAddress = GetPassConstantAddresss();
+	OutDraw.bUseStaticCache = bUseStaticCache;
+	OutDraw.bRenderStaticCache = bUseStaticCache && ConsumeStaticCacheUpdate();
+	OutDraw.Instances = bUseStaticCache ? DynamicInstancesInfo : InstancesInfo;
+	OutDraw.StaticInstances = OutDraw.bRenderStaticCache ? StaticInstancesInfo : SCulledInstancesInfo{};
+	return true;
+}
+
 uint32_t OShadowMap::GetShadowMapIndex() const
 {
 	return ShadowMapIndex.value_or(-1);
@@ -171,7 +230,7 @@ const SCulledInstancesInfo* OShadowMap::GetCulledInstancesInfo() const
 
 uint32_t OShadowMap::GetNumDSVRequired() const
 {
-	return 1;
+	return 2;
 }
 
 uint32_t OShadowMap::GetNumSRVRequired() const
@@ -192,10 +251,76 @@ void OShadowMap::SetShadowMapIndex(uint32_t Idx)
 void OShadowMap::Update(const UpdateEventArgs& Event)
 {
 	ORenderTargetBase::Update(Event);
-	OEngine::Get()->DrawDebugFrustum(PassConstant.InvViewProj, SColor::Red, 0.05);
+	DEBUG_DRAW(Frustum(PassConstant.InvViewProj, SColor::Red));
 }
 
 D3D12_GPU_VIRTUAL_ADDRESS OShadowMap::GetPassConstantAddresss() const
 {
 	return PassConstantBuffer.Buffer->GetGPUAddress() + PassConstantBuffer.StartIndex * Utils::CalcBufferByteSize(sizeof(SPassConstants));
 }
+
+const SCulledInstancesInfo* OShadowMap::GetStaticInstancesInfo() const
+{
+	return &StaticInstancesInfo;
+}
+
+const SCulledInstancesInfo* OShadowMap::GetDynamicInstancesInfo() const
+{
+	return &DynamicInstancesInfo;
+}
+
+bool OShadowMap::UseStaticCache() const
+{
+	return bUseStaticCache;
+}
+
+bool OShadowMap::ConsumeStaticCacheUpdate()
+{
+	if (bNeedToUpdateStaticCache)
+	{
+		bNeedToUpdateStaticCache = false;
+		return true;
+	}
+	return false;
+}
+
+void OShadowMap::RefreshDynamicCasters()
+{
+	PROFILE_SCOPE();
+	if (!ShadowMapInstancesBufferId.has_value() || !BoundingGeometry)
+	{
+		return;
+	}
+
+	// Without the cache every caster is culled again and the whole map is redrawn
+	if (!bUseStaticCache)
+	{
+		CullInstances(true);
+		bNeedToUpdate = true;
+		return;
+	}
+
+	// Nothing moves in the cached layer and there were no dynamic casters to erase, the map is still up to date
+	const bool bHadDynamicCasters = DynamicInstancesInfo.InstanceCount > 0;
+	CullInstances(FrameCullGenerations[OEngine::Get()->UpdatingFrameResourceIndex] != CullGeneration);
+	if (bHadDynamicCasters || DynamicInstancesInfo.InstanceCount > 0)
+	{
+		bNeedToUpdate = true;
+	}
+}
+
+void OShadowMap::SetUseStaticCache(bool bEnable)
+{
+	if (bUseStaticCache != bEnable)
+	{
+		bUseStaticCache = bEnable;
+		bNeedToUpdateStaticCache = true;
+		CullGeneration++;
+		bNeedToUpdate = true;
+	}
+}
+
+SResourceInfo* OShadowMap::GetSubtargetResource(uint32_t SubtargetIdx) const
+{
+	return SubtargetIdx == StaticCacheSubtarget ? StaticCache.get() : RenderTarget.get();
+}
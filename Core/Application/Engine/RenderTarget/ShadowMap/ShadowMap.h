@@ -4,6 +4,25 @@
 #include "DirectX/RenderItem/RenderItem.h"
 #include "Engine/RenderTarget/RenderTarget.h"
 class OLightComponent;
+class OShadowMap;
+
+// What the shadow map node draws for one map, captured by the update stage of the frame.
+// The node binds the resources through these views, the map itself belongs to the update thread.
+struct SShadowMapDraw
+{
+	TResourceInfo Target;
+	TResourceInfo StaticCache;
+	SDescriptorPair DSV;
+	SDescriptorPair StaticCacheDSV;
+	D3D12_GPU_VIRTUAL_ADDRESS PassAddress = 0;
+	bool bUseStaticCache = false;
+	bool bRenderStaticCache = false;
+
+	// Every caster, or the dynamic casters only when the static cache is used
+	SCulledInstancesInfo Instances;
+	SCulledInstancesInfo StaticInstances;
+};
+
 class OShadowMap : public ORenderTargetBase
 {
 public:
@@ -25,6 +44,9 @@ public:
 	void SetShadowMapIndex(uint32_t Idx);
 	void Update(const UpdateEventArgs& Event) override;
 	bool ConsumeUpdate();
+
+	/** @brief Fills the draw of the frame resource being updated, false when the map does not need to be rendered */
+	bool FillDraw(SShadowMapDraw& OutDraw);
 	void UpdateLightSourceData();
 	void SetPassConstants(const SPassConstants&);
 	uint32_t GetShadowMapIndex() const;
@@ -35,17 +57,40 @@ public:
 	IBoundingGeometry* GetBoundingGeometry() const;
 	const SCulledInstancesInfo* GetCulledInstancesInfo() const;
 
+	// Static shadow caching
+	const SCulledInstancesInfo* GetStaticInstancesInfo() const;
+	const SCulledInstancesInfo* GetDynamicInstancesInfo() const;
+	bool UseStaticCache() const;
+	bool ConsumeStaticCacheUpdate();
+	void RefreshDynamicCasters();
+	void SetUseStaticCache(bool bEnable);
+
+	inline static constexpr uint32_t StaticCacheSubtarget = 1;
+
 	bool bDrawBoundingGeometry = false;
 	bool bDrawShadowMap = true;
 
 private:
+	SResourceInfo* GetSubtargetResource(uint32_t SubtargetIdx) const;
+	void CullInstances(bool bCullStatic);
+
 	optional<TUUID> ShadowMapInstancesBufferId;
 	SCulledInstancesInfo InstancesInfo;
+	SCulledInstancesInfo StaticInstancesInfo;
+	SCulledInstancesInfo DynamicInstancesInfo;
+	bool bUseStaticCache = true;
+	bool bNeedToUpdateStaticCache = true;
 	bool bNeedToUpdate = true;
+
+	// Culling uploads to the instance buffer of the frame resource being updated, the others keep the generation they saw
+	uint64_t CullGeneration = 0;
+	array<uint64_t, SRenderConstants::NumFrameResources> FrameCullGenerations = {};
 	SPassConstants PassConstant;
 	SDescriptorPair SRV;
 	SDescriptorPair DSV;
+	SDescriptorPair StaticCacheDSV;
 	TResourceInfo RenderTarget;
+	TResourceInfo StaticCache;
 	TUploadBufferData<SPassConstants> PassConstantBuffer;
 	std::optional<uint32_t> ShadowMapIndex;
 	UINT MapSize = 0;
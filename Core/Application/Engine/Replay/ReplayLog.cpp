@@ -0,0 +1,196 @@
+#include "ReplayLog.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+constexpr char Magic[4] = { 'D', 'X', 'R', 'L' };
+constexpr uint32_t Version = 1;
+constexpr size_t HeaderSize = sizeof(Magic) + sizeof(Version);
+} // namespace
+
+bool SReplayRecord::ReadEdit(std::string& OutName, const uint8_t*& OutState, uint32_t& OutSize) const
+{
+	if (Size < sizeof(uint16_t))
+	{
+		return false;
+	}
+	uint16_t length = 0;
+	std::memcpy(&length, Data, sizeof(length));
+	if (Size < sizeof(length) + length)
+	{
+		return false;
+	}
+	OutName.assign(reinterpret_cast<const char*>(Data + sizeof(length)), length);
+	OutState = Data + sizeof(length) + length;
+	OutSize = Size - static_cast<uint32_t>(sizeof(length) + length);
+	return true;
+}
+
+OReplayWriter::OReplayWriter()
+{
+	Bytes.resize(HeaderSize);
+	std::memcpy(Bytes.data(), Magic, sizeof(Magic));
+	std::memcpy(Bytes.data() + sizeof(Magic), &Version, sizeof(Version));
+}
+
+void OReplayWriter::Add(EReplayEvent Type, const void* Data, uint32_t Size)
+{
+	Bytes.push_back(static_cast<uint8_t>(Type));
+	uint32_t size = Size;
+	do
+	{
+		const uint8_t low = size & 0x7f;
+		size >>= 7;
+		Bytes.push_back(size ? low | 0x80 : low);
+	}
+	while (size);
+
+	const auto bytes = static_cast<const uint8_t*>(Data);
+	Bytes.insert(Bytes.end(), bytes, bytes + Size);
+}
+
+void OReplayWriter::AddEdit(EReplayEvent Type, const std::string& Name, const void* State, uint32_t Size)
+{
+	const auto length = static_cast<uint16_t>(std::min<size_t>(Name.size(), UINT16_MAX));
+	std::vector<uint8_t> payload(sizeof(length) + length + Size);
+	std::memcpy(payload.data(), &length, sizeof(length));
+	std::memcpy(payload.data() + sizeof(length), Name.data(), length);
+	if (Size > 0)
+	{
+		std::memcpy(payload.data() + sizeof(length) + length, State, Size);
+	}
+	Add(Type, payload.data(), static_cast<uint32_t>(payload.size()));
+}
+
+void OReplayWriter::CommitFrame(float DeltaTime)
+{
+	Add(EReplayEvent::Frame, SReplayFrame{ DeltaTime });
+	NumFrames++;
+}
+
+bool OReplayWriter::Save(const std::string& Path) const
+{
+	std::ofstream file(Path, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(Bytes.data()), static_cast<std::streamsize>(Bytes.size()));
+	return file.good();
+}
+
+bool OReplayReader::Load(const std::string& Path)
+{
+	std::ifstream file(Path, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+	return Open(std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()));
+}
+
+bool OReplayReader::Open(std::vector<uint8_t> InBytes)
+{
+	Bytes = std::move(InBytes);
+	NumFrames = 0;
+	Rewind();
+
+	uint32_t version = 0;
+	if (Bytes.size() < HeaderSize || std::memcmp(Bytes.data(), Magic, sizeof(Magic)) != 0)
+	{
+		Bytes.clear();
+		return false;
+	}
+	std::memcpy(&version, Bytes.data() + sizeof(Magic), sizeof(version));
+	if (version != Version)
+	{
+		Bytes.clear();
+		return false;
+	}
+
+	size_t offset = HeaderSize;
+	SReplayRecord record;
+	while (offset < Bytes.size())
+	{
+		if (!ReadRecord(offset, record))
+		{
+			Bytes.clear();
+			NumFrames = 0;
+			return false;
+		}
+		NumFrames += record.Type == EReplayEvent::Frame;
+	}
+	return true;
+}
+
+bool OReplayReader::NextFrame(SReplayFrame& OutFrame, std::vector<SReplayRecord>& OutRecords)
+{
+	OutRecords.clear();
+	if (FrameIndex >= NumFrames)
+	{
+		return false;
+	}
+
+	SReplayRecord record;
+	while (ReadRecord(Offset, record))
+	{
+		if (record.Type == EReplayEvent::Frame)
+		{
+			record.Read(OutFrame);
+			FrameIndex++;
+			return true;
+		}
+		OutRecords.push_back(record);
+	}
+	return false;
+}
+
+void OReplayReader::Rewind()
+{
+	Offset = HeaderSize;
+	FrameIndex = 0;
+}
+
+bool OReplayReader::ReadRecord(size_t& InOutOffset, SReplayRecord& OutRecord) const
+{
+	if (InOutOffset >= Bytes.size() || Bytes[InOutOffset] >= static_cast<uint8_t>(EReplayEvent::Count))
+	{
+		return false;
+	}
+	size_t offset = InOutOffset;
+	OutRecord.Type = static_cast<EReplayEvent>(Bytes[offset++]);
+
+	uint32_t size = 0;
+	for (uint32_t shift = 0;; shift += 7)
+	{
+		if (offset >= Bytes.size() || shift > 28)
+		{
+			return false;
+		}
+		const uint8_t byte = Bytes[offset++];
+		size |= static_cast<uint32_t>(byte & 0x7f) << shift;
+		if (!(byte & 0x80))
+		{
+			break;
+		}
+	}
+	if (size > Bytes.size() - offset)
+	{
+		return false;
+	}
+	OutRecord.Data = Bytes.data() + offset;
+	OutRecord.Size = size;
+	InOutOffset = offset + size;
+	return true;
+}
+
+bool WriteReplayTimings(const std::string& Path, const std::vector<SReplayFrameTiming>& Timings)
+{
+	std::ofstream csv(Path, std::ios::trunc);
+	csv << "frame,frame_ms,update_ms,record_ms,tick_ms,instances,triangles\n";
+	for (const auto& timing : Timings)
+	{
+		csv << timing.Frame << ',' << timing.FrameMs << ',' << timing.UpdateMs << ',' << timing.RecordMs << ',' << timing.TickMs << ','
+		    << timing.Instances << ',' << timing.Triangles << '\n';
+	}
+	return csv.good();
+}
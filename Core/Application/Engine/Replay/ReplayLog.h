@@ -0,0 +1,194 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Binary log of a session: input events and scene edits grouped by frame. A record is its type, its payload size as a
+ * varint and the payload. The events of a frame are followed by the frame record holding its delta time, events after
+ * the last frame record belong to a frame that was never closed and are not replayed. Payloads are the raw records
+ * below, edits of named objects carry the name before the raw state of the object. No D3D dependencies.
+ */
+
+enum class EReplayEvent : uint8_t
+{
+	Frame,
+	Key,
+	MouseMove,
+	MouseButton,
+	MouseWheel,
+	Resize,
+	Camera,
+	Material,
+	Light,
+	DebugBox,
+	DebugFrustum,
+	Count
+};
+
+struct SReplayFrame
+{
+	float DeltaTime = 0.0f;
+};
+
+struct SReplayModifiers
+{
+	static constexpr uint8_t Control = 1 << 0;
+	static constexpr uint8_t Shift = 1 << 1;
+	static constexpr uint8_t Alt = 1 << 2;
+	static constexpr uint8_t UIInFocus = 1 << 3;
+};
+
+struct SReplayKey
+{
+	uint32_t Key = 0;
+	uint32_t Char = 0;
+	uint8_t bPressed = 0;
+	uint8_t Modifiers = 0;
+};
+
+struct SReplayMouse
+{
+	int32_t X = 0;
+	int32_t Y = 0;
+	float WheelDelta = 0.0f;
+	uint8_t Button = 0;
+	uint8_t bPressed = 0;
+
+	// Left, middle and right button down in bits 0 to 2
+	uint8_t Buttons = 0;
+	uint8_t Modifiers = 0;
+};
+
+struct SReplayResize
+{
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+};
+
+struct SReplayCamera
+{
+	float Position[3] = {};
+	float Look[3] = {};
+	float Right[3] = {};
+	float Up[3] = {};
+
+	bool operator==(const SReplayCamera& Other) const { return std::memcmp(this, &Other, sizeof(SReplayCamera)) == 0; }
+};
+
+// Debug draw commands issued during the update of the frame, drawn again after the replayed frame starts its debug draw
+struct SReplayDebugBox
+{
+	float Center[3] = {};
+	float Extents[3] = {};
+	float Orientation[4] = {};
+	uint8_t Color[4] = {};
+	float Duration = 0.0f;
+};
+
+struct SReplayDebugFrustum
+{
+	float InvViewProjection[16] = {};
+	uint8_t Color[4] = {};
+	float Duration = 0.0f;
+};
+
+struct SReplayRecord
+{
+	EReplayEvent Type = EReplayEvent::Frame;
+	const uint8_t* Data = nullptr;
+	uint32_t Size = 0;
+
+	/** @brief False when the payload is not a T, logs of another build may have changed the record */
+	template<typename T>
+	bool Read(T& Out) const;
+
+	/** @brief Name of an edited object and its raw state */
+	bool ReadEdit(std::string& OutName, const uint8_t*& OutState, uint32_t& OutSize) const;
+};
+
+class OReplayWriter
+{
+public:
+	OReplayWriter();
+
+	void Add(EReplayEvent Type, const void* Data, uint32_t Size);
+
+	template<typename T>
+	void Add(EReplayEvent Type, const T& Payload);
+
+	void AddEdit(EReplayEvent Type, const std::string& Name, const void* State, uint32_t Size);
+
+	/** @brief Closes the frame, the events added since the last one are applied before it updates */
+	void CommitFrame(float DeltaTime);
+
+	bool Save(const std::string& Path) const;
+
+	uint32_t GetNumFrames() const { return NumFrames; }
+	size_t GetNumBytes() const { return Bytes.size(); }
+	const std::vector<uint8_t>& GetBytes() const { return Bytes; }
+
+private:
+	std::vector<uint8_t> Bytes;
+	uint32_t NumFrames = 0;
+};
+
+class OReplayReader
+{
+public:
+	bool Load(const std::string& Path);
+
+	/** @brief False when the header does not match or a record runs past the end */
+	bool Open(std::vector<uint8_t> InBytes);
+
+	/** @brief Events of the next frame, they point into the log and stay valid until it is opened again */
+	bool NextFrame(SReplayFrame& OutFrame, std::vector<SReplayRecord>& OutRecords);
+
+	void Rewind();
+
+	uint32_t GetNumFrames() const { return NumFrames; }
+	uint32_t GetFrameIndex() const { return FrameIndex; }
+
+private:
+	bool ReadRecord(size_t& InOutOffset, SReplayRecord& OutRecord) const;
+
+	std::vector<uint8_t> Bytes;
+	size_t Offset = 0;
+	uint32_t NumFrames = 0;
+	uint32_t FrameIndex = 0;
+};
+
+struct SReplayFrameTiming
+{
+	uint32_t Frame = 0;
+	double FrameMs = 0.0;
+	double UpdateMs = 0.0;
+	double RecordMs = 0.0;
+	double TickMs = 0.0;
+	uint64_t Instances = 0;
+	uint64_t Triangles = 0;
+};
+
+/** @brief One row per frame, the file is replaced */
+bool WriteReplayTimings(const std::string& Path, const std::vector<SReplayFrameTiming>& Timings);
+
+template<typename T>
+bool SReplayRecord::Read(T& Out) const
+{
+	static_assert(std::is_trivially_copyable_v<T>);
+	if (Size != sizeof(T))
+	{
+		return false;
+	}
+	std::memcpy(&Out, Data, sizeof(T));
+	return true;
+}
+
+template<typename T>
+void OReplayWriter::Add(EReplayEvent Type, const T& Payload)
+{
+	static_assert(std::is_trivially_copyable_v<T>);
+	Add(Type, &Payload, sizeof(T));
+}
@@ -0,0 +1,534 @@
+#include "SessionReplay.h"
+
+#include "Application.h"
+#include "Camera/Camera.h"
+#include "DebugDraw/DebugDraw.h"
+#include "Engine/Engine.h"
+#include "LightComponent/LightComponent.h"
+#include "Logger.h"
+#include "Material.h"
+#include "Profiler.h"
+#include "Window/Window.h"
+
+#include <format>
+
+namespace
+{
+uint8_t PackButtons(bool bLeft, bool bMiddle, bool bRight)
+{
+	return static_cast<uint8_t>(bLeft) | static_cast<uint8_t>(bMiddle) << 1 | static_cast<uint8_t>(bRight) << 2;
+}
+
+uint8_t PackModifiers(bool bControl, bool bShift, bool bAlt, bool bUIInFocus)
+{
+	return (bControl ? SReplayModifiers::Control : 0) | (bShift ? SReplayModifiers::Shift : 0) | (bAlt ? SReplayModifiers::Alt : 0)
+	       | (bUIInFocus ? SReplayModifiers::UIInFocus : 0);
+}
+
+SReplayMouse MakeMouse(bool bLeft, bool bMiddle, bool bRight, bool bControl, bool bShift, int X, int Y, bool bUIInFocus)
+{
+	SReplayMouse mouse;
+	mouse.X = X;
+	mouse.Y = Y;
+	mouse.Buttons = PackButtons(bLeft, bMiddle, bRight);
+	mouse.Modifiers = PackModifiers(bControl, bShift, false, bUIInFocus);
+	return mouse;
+}
+
+void Store(const DirectX::XMFLOAT3& Vector, float (&Out)[3])
+{
+	Out[0] = Vector.x;
+	Out[1] = Vector.y;
+	Out[2] = Vector.z;
+}
+
+DirectX::XMFLOAT3 Load(const float (&Vector)[3])
+{
+	return { Vector[0], Vector[1], Vector[2] };
+}
+
+string GetLightName(OLightComponent& Light)
+{
+	return std::format("{} {}", ToString(Light.GetLightType()), Light.GetLightIndex());
+}
+
+void Store(const DirectX::XMFLOAT4& Vector, float (&Out)[4])
+{
+	Out[0] = Vector.x;
+	Out[1] = Vector.y;
+	Out[2] = Vector.z;
+	Out[3] = Vector.w;
+}
+
+void Store(SColor Color, uint8_t (&Out)[4])
+{
+	Out[0] = Color.R;
+	Out[1] = Color.G;
+	Out[2] = Color.B;
+	Out[3] = Color.A;
+}
+
+SColor LoadColor(const uint8_t (&Color)[4])
+{
+	return { Color[0], Color[1], Color[2], Color[3] };
+}
+
+template<typename T>
+bool CopyState(T& Out, const uint8_t* State, uint32_t Size)
+{
+	if (Size != sizeof(T))
+	{
+		return false;
+	}
+	std::memcpy(&Out, State, sizeof(T));
+	return true;
+}
+} // namespace
+
+void OSessionReplay::StartCapture(const string& Path)
+{
+	Capture = make_unique<OReplayWriter>();
+	CapturePath = Path;
+	bHasCamera = false;
+	bFrameOpen = false;
+	LOG(Engine, Log, "Capturing the session to {}", TEXT(Path));
+}
+
+bool OSessionReplay::StopCapture()
+{
+	if (!Capture)
+	{
+		return false;
+	}
+	const bool bSaved = Capture->Save(CapturePath);
+	if (bSaved)
+	{
+		LOG(Engine, Log, "Captured {} frames in {} bytes to {}", Capture->GetNumFrames(), Capture->GetNumBytes(), TEXT(CapturePath));
+	}
+	else
+	{
+		LOG(Engine, Error, "Failed to write the capture to {}", TEXT(CapturePath));
+	}
+	Capture.reset();
+	bFrameOpen = false;
+	return bSaved;
+}
+
+bool OSessionReplay::StartReplay(const string& Path, const SReplaySettings& InSettings)
+{
+	auto reader = make_unique<OReplayReader>();
+	if (!reader->Load(Path))
+	{
+		LOG(Engine, Error, "Failed to read the replay {}", TEXT(Path));
+		return false;
+	}
+
+	// A session can not capture what it replays
+	StopCapture();
+	Replay = std::move(reader);
+	Settings = InSettings;
+	Timings.clear();
+	Timings.reserve(Replay->GetNumFrames());
+	LOG(Engine, Log, "Replaying {} frames from {}", Replay->GetNumFrames(), TEXT(Path));
+	return true;
+}
+
+void OSessionReplay::StopReplay()
+{
+	Replay.reset();
+	Records.clear();
+}
+
+uint32_t OSessionReplay::GetNumFrames() const
+{
+	return Replay ? Replay->GetNumFrames() : Capture ? Capture->GetNumFrames() : 0;
+}
+
+uint32_t OSessionReplay::GetFrameIndex() const
+{
+	return Replay ? Replay->GetFrameIndex() : GetNumFrames();
+}
+
+void OSessionReplay::RecordKey(const KeyEventArgs& Args)
+{
+	if (Capture)
+	{
+		SReplayKey key;
+		key.Key = static_cast<uint32_t>(Args.Key);
+		key.Char = Args.Char;
+		key.bPressed = Args.State == KeyEventArgs::Pressed;
+		key.Modifiers = PackModifiers(Args.Control, Args.Shift, Args.Alt, Args.IsUIInfocus);
+		Capture->Add(EReplayEvent::Key, key);
+	}
+}
+
+void OSessionReplay::RecordMouseMove(const MouseMotionEventArgs& Args)
+{
+	if (Capture)
+	{
+		Capture->Add(EReplayEvent::MouseMove, MakeMouse(Args.LeftButton, Args.MiddleButton, Args.RightButton, Args.Control, Args.Shift, Args.X, Args.Y, Args.IsUIInfocus));
+	}
+}
+
+void OSessionReplay::RecordMouseButton(const MouseButtonEventArgs& Args)
+{
+	if (Capture)
+	{
+		auto mouse = MakeMouse(Args.LeftButton, Args.MiddleButton, Args.RightButton, Args.Control, Args.Shift, Args.X, Args.Y, Args.IsUIInfocus);
+		mouse.Button = static_cast<uint8_t>(Args.Button);
+		mouse.bPressed = Args.State == MouseButtonEventArgs::Pressed;
+		Capture->Add(EReplayEvent::MouseButton, mouse);
+	}
+}
+
+void OSessionReplay::RecordMouseWheel(const MouseWheelEventArgs& Args)
+{
+	if (Capture)
+	{
+		auto mouse = MakeMouse(Args.LeftButton, Args.MiddleButton, Args.RightButton, Args.Control, Args.Shift, Args.X, Args.Y, Args.IsUIInfocus);
+		mouse.WheelDelta = Args.WheelDelta;
+		Capture->Add(EReplayEvent::MouseWheel, mouse);
+	}
+}
+
+void OSessionReplay::RecordResize(const ResizeEventArgs& Args)
+{
+	if (Capture)
+	{
+		Capture->Add(EReplayEvent::Resize, SReplayResize{ Args.Width, Args.Height });
+	}
+}
+
+void OSessionReplay::RecordMaterial(const SMaterial& Material)
+{
+	if (Capture)
+	{
+		Capture->AddEdit(EReplayEvent::Material, Material.Name, &Material.MaterialData, sizeof(Material.MaterialData));
+	}
+}
+
+void OSessionReplay::RecordLight(OLightComponent& Light)
+{
+	if (!Capture)
+	{
+		return;
+	}
+	switch (Light.GetLightType())
+	{
+	case ELightType::Directional:
+		Capture->AddEdit(EReplayEvent::Light, GetLightName(Light), &Cast<ODirectionalLightComponent>(&Light)->GetDirectionalLight(), sizeof(HLSL::DirectionalLight));
+		break;
+	case ELightType::Point:
+		Capture->AddEdit(EReplayEvent::Light, GetLightName(Light), &Cast<OPointLightComponent>(&Light)->GetPointLight(), sizeof(HLSL::PointLight));
+		break;
+	case ELightType::Spot:
+		Capture->AddEdit(EReplayEvent::Light, GetLightName(Light), &Cast<OSpotLightComponent>(&Light)->GetSpotLight(), sizeof(HLSL::SpotLight));
+		break;
+	}
+}
+
+void OSessionReplay::RecordDebugBox(const DirectX::XMFLOAT3& Center, const DirectX::XMFLOAT3& Extents, const DirectX::XMFLOAT4& Orientation, SColor Color, float Duration)
+{
+	if (bCaptureDebugDraw)
+	{
+		SReplayDebugBox& box = DebugBoxes.emplace_back();
+		Store(Center, box.Center);
+		Store(Extents, box.Extents);
+		Store(Orientation, box.Orientation);
+		Store(Color, box.Color);
+		box.Duration = Duration;
+	}
+}
+
+void OSessionReplay::RecordDebugFrustum(const DirectX::XMFLOAT4X4& InvViewProjection, SColor Color, float Duration)
+{
+	if (bCaptureDebugDraw)
+	{
+		SReplayDebugFrustum& frustum = DebugFrustums.emplace_back();
+		std::memcpy(frustum.InvViewProjection, &InvViewProjection, sizeof(frustum.InvViewProjection));
+		Store(Color, frustum.Color);
+		frustum.Duration = Duration;
+	}
+}
+
+void OSessionReplay::ApplyDebugDraw() const
+{
+#if ENABLE_DEBUG_DRAW
+	if (!Replay)
+	{
+		return;
+	}
+	for (const auto& record : Records)
+	{
+		SReplayDebugBox box;
+		SReplayDebugFrustum frustum;
+		if (record.Type == EReplayEvent::DebugBox && record.Read(box))
+		{
+			const DirectX::XMFLOAT4 orientation = { box.Orientation[0], box.Orientation[1], box.Orientation[2], box.Orientation[3] };
+			DEBUG_DRAW(Box(Load(box.Center), Load(box.Extents), orientation, LoadColor(box.Color), box.Duration));
+		}
+		else if (record.Type == EReplayEvent::DebugFrustum && record.Read(frustum))
+		{
+			DirectX::XMFLOAT4X4 invViewProjection;
+			std::memcpy(&invViewProjection, frustum.InvViewProjection, sizeof(frustum.InvViewProjection));
+			DEBUG_DRAW(Frustum(invViewProjection, LoadColor(frustum.Color), frustum.Duration));
+		}
+	}
+#endif
+}
+
+void OSessionReplay::BeginFrame(OEngine* Engine, float DeltaTime)
+{
+	PROFILE_SCOPE()
+	if (Capture)
+	{
+		const auto window = Engine->GetWindow().lock();
+		if (Capture->GetNumFrames() == 0)
+		{
+			Capture->Add(EReplayEvent::Resize, SReplayResize{ window->GetWidth(), window->GetHeight() });
+		}
+
+		// The camera the frame is viewed from, the update moves it for the next one
+		const auto camera = window->GetCamera().lock();
+		SReplayCamera state;
+		Store(camera->GetPosition3f(), state.Position);
+		Store(camera->GetLook3f(), state.Look);
+		Store(camera->GetRight3f(), state.Right);
+		Store(camera->GetUp3f(), state.Up);
+		if (!bHasCamera || !(state == LastCamera))
+		{
+			Capture->Add(EReplayEvent::Camera, state);
+			LastCamera = state;
+			bHasCamera = true;
+		}
+
+		// The debug draw commands of the update belong to this frame, it is closed when the frame ends
+		bFrameOpen = true;
+		bCaptureDebugDraw = true;
+		CaptureDeltaTime = DeltaTime;
+	}
+
+	if (!Replay)
+	{
+		return;
+	}
+
+	SReplayFrame frame;
+	if (!Replay->NextFrame(frame, Records))
+	{
+		FinishReplay();
+		return;
+	}
+	FrameStart = std::chrono::steady_clock::now();
+	for (const auto& record : Records)
+	{
+		Apply(Engine, record);
+	}
+}
+
+void OSessionReplay::EndFrame(OEngine* Engine)
+{
+	if (bCaptureDebugDraw)
+	{
+		if (Capture && bFrameOpen)
+		{
+			for (const auto& box : DebugBoxes)
+			{
+				Capture->Add(EReplayEvent::DebugBox, box);
+			}
+			for (const auto& frustum : DebugFrustums)
+			{
+				Capture->Add(EReplayEvent::DebugFrustum, frustum);
+			}
+			Capture->CommitFrame(CaptureDeltaTime);
+		}
+		bFrameOpen = false;
+		bCaptureDebugDraw = false;
+		DebugBoxes.clear();
+		DebugFrustums.clear();
+	}
+
+	if (!Replay)
+	{
+		return;
+	}
+	const auto& stats = Engine->GetFramePipeline().GetStats();
+	const auto& rendered = Engine->GetRenderedItems();
+	SReplayFrameTiming timing;
+	timing.Frame = Replay->GetFrameIndex() - 1;
+	timing.FrameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - FrameStart).count();
+	timing.UpdateMs = stats.UpdateMs;
+	timing.RecordMs = stats.RecordMs;
+	timing.TickMs = stats.TickMs;
+	timing.Instances = rendered.InstanceCount;
+	timing.Triangles = rendered.NumTriangles;
+	Timings.push_back(timing);
+}
+
+void OSessionReplay::Apply(OEngine* Engine, const SReplayRecord& Record)
+{
+	const auto window = Engine->GetWindow().lock();
+	const HWND hwnd = window->GetHWND();
+	switch (Record.Type)
+	{
+	case EReplayEvent::Key:
+	{
+		SReplayKey key;
+		if (Record.Read(key))
+		{
+			KeyEventArgs args(static_cast<KeyCode::Key>(key.Key),
+			                  key.Char,
+			                  key.bPressed ? KeyEventArgs::Pressed : KeyEventArgs::Released,
+			                  key.Modifiers & SReplayModifiers::Control,
+			                  key.Modifiers & SReplayModifiers::Shift,
+			                  key.Modifiers & SReplayModifiers::Alt,
+			                  hwnd);
+			args.IsUIInfocus = key.Modifiers & SReplayModifiers::UIInFocus;
+			key.bPressed ? window->OnKeyPressed(args) : window->OnKeyReleased(args);
+		}
+		break;
+	}
+	case EReplayEvent::MouseMove:
+	{
+		SReplayMouse mouse;
+		if (Record.Read(mouse))
+		{
+			MouseMotionEventArgs args(mouse.Buttons & 1, mouse.Buttons & 2, mouse.Buttons & 4, mouse.Modifiers & SReplayModifiers::Control, mouse.Modifiers & SReplayModifiers::Shift, mouse.X, mouse.Y, hwnd);
+			args.IsUIInfocus = mouse.Modifiers & SReplayModifiers::UIInFocus;
+			window->OnMouseMoved(args);
+		}
+		break;
+	}
+	case EReplayEvent::MouseButton:
+	{
+		SReplayMouse mouse;
+		if (Record.Read(mouse))
+		{
+			MouseButtonEventArgs args(static_cast<MouseButtonEventArgs::EMouseButton>(mouse.Button),
+			                          mouse.bPressed ? MouseButtonEventArgs::Pressed : MouseButtonEventArgs::Released,
+			                          mouse.Buttons & 1,
+			                          mouse.Buttons & 2,
+			                          mouse.Buttons & 4,
+			                          mouse.Modifiers & SReplayModifiers::Control,
+			                          mouse.Modifiers & SReplayModifiers::Shift,
+			                          mouse.X,
+			                          mouse.Y,
+			                          hwnd);
+			args.IsUIInfocus = mouse.Modifiers & SReplayModifiers::UIInFocus;
+			mouse.bPressed ? window->OnMouseButtonPressed(args) : window->OnMouseButtonReleased(args);
+		}
+		break;
+	}
+	case EReplayEvent::MouseWheel:
+	{
+		SReplayMouse mouse;
+		if (Record.Read(mouse))
+		{
+			MouseWheelEventArgs args(mouse.WheelDelta, mouse.Buttons & 1, mouse.Buttons & 2, mouse.Buttons & 4, mouse.Modifiers & SReplayModifiers::Control, mouse.Modifiers & SReplayModifiers::Shift, mouse.X, mouse.Y, hwnd);
+			args.IsUIInfocus = mouse.Modifiers & SReplayModifiers::UIInFocus;
+			window->OnMouseWheel(args);
+		}
+		break;
+	}
+	case EReplayEvent::Resize:
+	{
+		// The window is not resized, the timings of the frames are not comparable though
+		SReplayResize resize;
+		if (Record.Read(resize) && (resize.Width != window->GetWidth() || resize.Height != window->GetHeight()))
+		{
+			LOG(Engine, Warning, "Replay was captured at {}x{}, the window is {}x{}", resize.Width, resize.Height, window->GetWidth(), window->GetHeight());
+		}
+		break;
+	}
+	case EReplayEvent::Camera:
+	{
+		SReplayCamera state;
+		if (Record.Read(state))
+		{
+			window->GetCamera().lock()->SetBasis(Load(state.Position), Load(state.Look), Load(state.Right), Load(state.Up));
+		}
+		break;
+	}
+	case EReplayEvent::Material:
+	{
+		string name;
+		const uint8_t* state = nullptr;
+		uint32_t size = 0;
+		const auto material = Record.ReadEdit(name, state, size) ? Engine->GetMaterialManager()->FindMaterial(name).lock() : nullptr;
+		if (!material || !CopyState(material->MaterialData, state, size))
+		{
+			LOG(Engine, Warning, "Replayed material edit of {} does not match the scene", TEXT(name));
+			break;
+		}
+		Engine->GetMaterialManager()->OnMaterialChanged(name);
+		break;
+	}
+	case EReplayEvent::Light:
+	{
+		string name;
+		const uint8_t* state = nullptr;
+		uint32_t size = 0;
+		OLightComponent* light = nullptr;
+		if (Record.ReadEdit(name, state, size))
+		{
+			for (const auto component : Engine->GetLightComponents())
+			{
+				if (GetLightName(*component) == name)
+				{
+					light = component;
+					break;
+				}
+			}
+		}
+
+		bool bApplied = false;
+		if (light)
+		{
+			switch (light->GetLightType())
+			{
+			case ELightType::Directional:
+				bApplied = CopyState(Cast<ODirectionalLightComponent>(light)->GetDirectionalLight(), state, size);
+				break;
+			case ELightType::Point:
+				bApplied = CopyState(Cast<OPointLightComponent>(light)->GetPointLight(), state, size);
+				break;
+			case ELightType::Spot:
+				bApplied = CopyState(Cast<OSpotLightComponent>(light)->GetSpotLight(), state, size);
+				break;
+			}
+		}
+		if (!bApplied)
+		{
+			LOG(Engine, Warning, "Replayed light edit of {} does not match the scene", TEXT(name));
+			break;
+		}
+		light->MarkDirty();
+		break;
+	}
+	case EReplayEvent::DebugBox:
+	case EReplayEvent::DebugFrustum:
+		// Drawn by ApplyDebugDraw once the update started the debug draw of the frame
+		break;
+	default:
+		break;
+	}
+}
+
+void OSessionReplay::FinishReplay()
+{
+	double totalMs = 0.0;
+	for (const auto& timing : Timings)
+	{
+		totalMs += timing.FrameMs;
+	}
+	LOG(Engine, Log, "Replayed {} frames, {} ms per frame", Timings.size(), Timings.empty() ? 0.0 : totalMs / Timings.size());
+	if (!Settings.CsvPath.empty() && !WriteReplayTimings(Settings.CsvPath, Timings))
+	{
+		LOG(Engine, Error, "Failed to write the replay timings to {}", TEXT(Settings.CsvPath));
+	}
+	StopReplay();
+	if (Settings.bQuitWhenDone)
+	{
+		OApplication::Get()->Quit(0);
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include "Color.h"
+#include "Events.h"
+#include "ReplayLog.h"
+#include "Types.h"
+
+#include <DirectXMath.h>
+#include <chrono>
+
+class OEngine;
+class OLightComponent;
+struct SMaterial;
+
+struct SReplaySettings
+{
+	// Per frame timings are written here when the log ends, nothing is written when empty
+	string CsvPath;
+	float FixedDeltaTime = 1.0f / 60.0f;
+	bool bQuitWhenDone = false;
+};
+
+/**
+ * @brief Captures the input and the scene edits of a session into a replay log and plays a log back at a fixed timestep.
+ * The events of a frame are applied between frames, then the camera is set to the one captured for that frame. Debug boxes
+ * and frustums drawn through OEngine are captured during the update and drawn again after the replayed update starts its
+ * debug draw. While a log plays live input and live debug draw commands are dropped. UI toggles other than material and
+ * light edits are not part of the log.
+ */
+class OSessionReplay
+{
+public:
+	void StartCapture(const string& Path);
+
+	/** @brief Saves the frames closed so far */
+	bool StopCapture();
+
+	bool StartReplay(const string& Path, const SReplaySettings& InSettings);
+	void StopReplay();
+
+	bool IsCapturing() const { return Capture != nullptr; }
+	bool IsReplaying() const { return Replay != nullptr; }
+	bool AcceptsLiveInput() const { return Replay == nullptr; }
+	float GetFixedDeltaTime() const { return Replay ? Settings.FixedDeltaTime : 0.0f; }
+	uint32_t GetNumFrames() const;
+	uint32_t GetFrameIndex() const;
+
+	void RecordKey(const KeyEventArgs& Args);
+	void RecordMouseMove(const MouseMotionEventArgs& Args);
+	void RecordMouseButton(const MouseButtonEventArgs& Args);
+	void RecordMouseWheel(const MouseWheelEventArgs& Args);
+	void RecordResize(const ResizeEventArgs& Args);
+	void RecordMaterial(const SMaterial& Material);
+	void RecordLight(OLightComponent& Light);
+
+	// Update stage only, the commands are added to the log when the frame ends
+	void RecordDebugBox(const DirectX::XMFLOAT3& Center, const DirectX::XMFLOAT3& Extents, const DirectX::XMFLOAT4& Orientation, SColor Color, float Duration);
+	void RecordDebugFrustum(const DirectX::XMFLOAT4X4& InvViewProjection, SColor Color, float Duration);
+
+	/** @brief Update stage, after the debug draw dropped the primitives of the last frame */
+	void ApplyDebugDraw() const;
+
+	/** @brief Between frames before the scene changes, opens the captured frame or applies the next replayed one */
+	void BeginFrame(OEngine* Engine, float DeltaTime);
+
+	/** @brief After the frame was ticked, closes the captured frame or adds the timings of a replayed one */
+	void EndFrame(OEngine* Engine);
+
+private:
+	void Apply(OEngine* Engine, const SReplayRecord& Record);
+	void FinishReplay();
+
+	unique_ptr<OReplayWriter> Capture;
+	string CapturePath;
+	SReplayCamera LastCamera;
+	bool bHasCamera = false;
+
+	// A frame is added to the log when it ends, unless the capture was restarted in between
+	bool bFrameOpen = false;
+
+	// Written by the update, the UI may edit the log while it runs
+	bool bCaptureDebugDraw = false;
+	float CaptureDeltaTime = 0.0f;
+	vector<SReplayDebugBox> DebugBoxes;
+	vector<SReplayDebugFrustum> DebugFrustums;
+
+	unique_ptr<OReplayReader> Replay;
+	SReplaySettings Settings;
+	vector<SReplayRecord> Records;
+	vector<SReplayFrameTiming> Timings;
+	std::chrono::steady_clock::time_point FrameStart;
+};
@@ -1,15 +1,50 @@
-
 #include "Scene.h"
 
 #include "EngineHelper.h"
 #include "Geometry/Water/Water.h"
+#include "MeshGenerator/MeshPayload.h"
+
+#include <future>
+#include <set>
+
+namespace
+{
+using TClock = std::chrono::high_resolution_clock;
+
+float GetMilliseconds(TClock::time_point Start)
+{
+	return std::chrono::duration<float, std::milli>(TClock::now() - Start).count();
+}
+
+struct SParsedObject
+{
+	std::filesystem::path Path;
+	SMeshPayloadData Payload;
+	bool bParsed = false;
+	float Milliseconds = 0.0f;
+
+	// The logger is not thread safe, the loading thread writes these
+	vector<SLogEntry> Logs;
+};
+} // namespace
+
 void OScene::InitScene(const SSceneInfo& SceneInfo)
 {
 	Info = SceneInfo;
 }
 
-void OScene::Load() const
+void OScene::Load(const TSceneLoadProgress& OnProgress)
 {
+	PROFILE_SCOPE();
+	const auto loadStart = TClock::now();
+	LoadStats = {};
+	auto report = [&](const string& Stage, const string& Object, uint32_t Completed, uint32_t Total) {
+		if (OnProgress)
+		{
+			OnProgress({ Stage, Object, Completed, Total });
+		}
+	};
+
 	OEngine::Get()->BuildCubeRenderTarget();
 
 	//create objects
@@ -31,21 +66,110 @@ void OScene::Load() const
 	objectsParams.Material = FindMaterial("White");
 	objectsParams.NumberOfInstances = 1;
 	objectsParams.bFrustumCoolingEnabled = true;
+	objectsParams.bStaticShadowCaster = true;
 	objectsParams.Pickable = false;
 	objectsParams.Displayable = false;
 
+	// Parse, weld and simplify every object on the workers, nothing here touches the device
+	auto stageStart = TClock::now();
+	vector<std::future<SParsedObject>> parses;
 	for (auto& obj : Info.Objects)
 	{
 		auto path = std::filesystem::path(GetResourcePath(UTF8ToWString(obj)));
-		if (exists(path))
+		if (!exists(path))
 		{
-			CreateRenderItem(path.filename().string(), path.wstring(), EParserType::TinyObjLoader, ETextureMapType::None, objectsParams);
+			WIN_LOG(Engine, Error, "Object not found: {}", TEXT(obj));
+			continue;
 		}
-		else
+
+		parses.push_back(std::async(std::launch::async, [path]() {
+			const auto start = TClock::now();
+			SParsedObject result;
+			result.Path = path;
+			SLogUtils::DeferredLogs = &result.Logs;
+			result.bParsed = OMeshGenerator::ParseMesh(path.filename().string(), path.wstring(), EParserType::TinyObjLoader, ETextureMapType::None, result.Payload);
+			if (result.bParsed)
+			{
+				OMeshGenerator::OptimizeMesh(result.Payload);
+				OMeshGenerator::GenerateLODs(result.Payload);
+			}
+			result.Milliseconds = GetMilliseconds(start);
+			SLogUtils::DeferredLogs = nullptr;
+			return result;
+		}));
+	}
+
+	vector<SParsedObject> parsed;
+	parsed.reserve(parses.size());
+	const auto numObjects = static_cast<uint32_t>(parses.size());
+	for (auto& parse : parses)
+	{
+		auto& object = parsed.emplace_back(parse.get());
+		SLogUtils::Flush(object.Logs);
+		report("Parse", object.Path.filename().string(), static_cast<uint32_t>(parsed.size()), numObjects);
+	}
+	LoadStats.ParseMilliseconds = GetMilliseconds(stageStart);
+
+	// Every texture is cooked once no matter how many materials reference it
+	stageStart = TClock::now();
+	std::set<pair<wstring, ETextureType>> uniqueTextures;
+	for (const auto& object : parsed)
+	{
+		for (const auto& mesh : object.Payload.Data)
 		{
-			WIN_LOG(Engine, Error, "Object not found: {}", TEXT(obj));
+			const auto& material = mesh.Material;
+			for (const auto& [path, type] : { pair{ material.DiffuseMap, ETextureType::Diffuse },
+			                                  pair{ material.NormalMap, ETextureType::Normal },
+			                                  pair{ material.HeightMap, ETextureType::Height },
+			                                  pair{ material.AlphaMap, ETextureType::Alpha },
+			                                  pair{ material.AmbientMap, ETextureType::Diffuse },
+			                                  pair{ material.SpecularMap, ETextureType::Diffuse } })
+			{
+				if (!path.empty())
+				{
+					LoadStats.NumTextureRequests++;
+					uniqueTextures.emplace(path, type);
+				}
+			}
+		}
+	}
+
+	vector<pair<wstring, ETextureType>> textureRequests;
+	for (const auto& request : uniqueTextures)
+	{
+		if (!FindTextureByPath(request.first) && std::filesystem::exists(request.first))
+		{
+			textureRequests.push_back(request);
 		}
 	}
+	LoadStats.NumUniqueTextures = static_cast<uint32_t>(uniqueTextures.size());
+	report("Textures", "", 0, static_cast<uint32_t>(textureRequests.size()));
+	OEngine::Get()->GetTextureManager()->CookTextures(textureRequests);
+	report("Textures", "", static_cast<uint32_t>(textureRequests.size()), static_cast<uint32_t>(textureRequests.size()));
+	LoadStats.TextureMilliseconds = GetMilliseconds(stageStart);
+
+	// Materials, textures and buffers are recorded into one command list, InitScene executes it once
+	stageStart = TClock::now();
+	auto generator = OEngine::Get()->GetMeshGenerator();
+	uint32_t numBuilt = 0;
+	for (auto& object : parsed)
+	{
+		SSceneObjectTiming timing;
+		timing.Name = object.Path.filename().string();
+		timing.ParseMilliseconds = object.Milliseconds;
+		if (object.bParsed)
+		{
+			const auto start = TClock::now();
+			timing.NumVertices = object.Payload.TotalVertices;
+			timing.NumIndices = object.Payload.TotalIndices;
+			OEngine::Get()->BuildRenderItemFromMesh(generator->CreateMesh(object.Payload), objectsParams);
+			timing.BuildMilliseconds = GetMilliseconds(start);
+			timing.bLoaded = true;
+		}
+		LoadStats.Objects.push_back(timing);
+		report("Build", timing.Name, ++numBuilt, numObjects);
+	}
+	LoadStats.BuildMilliseconds = GetMilliseconds(stageStart);
 
 	for (const auto& dirLight : Info.DirLights)
 	{
@@ -74,4 +198,10 @@ void OScene::Load() const
 	                     params);
 
 	OEngine::Get()->BuildRenderObject<OWaterRenderObject>(ERenderGroup::RenderTargets);
-}
\ No newline at end of file
+	LoadStats.TotalMilliseconds = GetMilliseconds(loadStart);
+}
+
+const SSceneLoadStats& OScene::GetLoadStats() const
+{
+	return LoadStats;
+}
@@ -2,6 +2,8 @@
 #include "DirectX/Light/Light.h"
 #include "Types.h"
 
+#include <functional>
+
 struct SSceneInfo
 {
 	string Name;
@@ -11,12 +13,50 @@ struct SSceneInfo
 	vector<SSpotLightPayload> SpotLights;
 };
 
+struct SSceneObjectTiming
+{
+	string Name;
+	float ParseMilliseconds = 0.0f;
+	float BuildMilliseconds = 0.0f;
+	size_t NumVertices = 0;
+	size_t NumIndices = 0;
+	bool bLoaded = false;
+};
+
+struct SSceneLoadStats
+{
+	vector<SSceneObjectTiming> Objects;
+	uint32_t NumTextureRequests = 0;
+	uint32_t NumUniqueTextures = 0;
+
+	// Wall clock of every stage, parsing runs in parallel so it is less than the sum of the objects
+	float ParseMilliseconds = 0.0f;
+	float TextureMilliseconds = 0.0f;
+	float BuildMilliseconds = 0.0f;
+	float TotalMilliseconds = 0.0f;
+};
+
+struct SSceneLoadProgress
+{
+	string Stage;
+	string Object;
+	uint32_t NumCompleted = 0;
+	uint32_t NumTotal = 0;
+};
+
+using TSceneLoadProgress = std::function<void(const SSceneLoadProgress&)>;
+
 class OScene
 {
 public:
 	void InitScene(const SSceneInfo& SceneInfo);
-	void Load() const;
+
+	/** @brief Objects are parsed on worker threads, textures are cooked once per unique request and
+	 * the GPU resources are recorded into the current command list after all parses are done */
+	void Load(const TSceneLoadProgress& OnProgress = {});
+	const SSceneLoadStats& GetLoadStats() const;
 
 private:
 	SSceneInfo Info;
+	SSceneLoadStats LoadStats;
 };
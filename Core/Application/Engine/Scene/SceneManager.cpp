@@ -27,7 +27,16 @@ void OSceneManager::LoadScenes()
 	}
 	if (CurrentScene)
 	{
-		CurrentScene->Load();
+		CurrentScene->Load([](const SSceneLoadProgress& Progress) {
+			LOG(Engine, Log, "Scene loading: {} {} ({}/{})", TEXT(Progress.Stage), TEXT(Progress.Object), Progress.NumCompleted, Progress.NumTotal);
+		});
+
+		const auto& stats = CurrentScene->GetLoadStats();
+		for (const auto& object : stats.Objects)
+		{
+			LOG(Engine, Log, "Scene object {}: parse {} ms, build {} ms, {} vertices, {} indices", TEXT(object.Name), object.ParseMilliseconds, object.BuildMilliseconds, object.NumVertices, object.NumIndices);
+		}
+		LOG(Engine, Log, "Scene loaded in {} ms: parse {} ms, textures {} ms ({} unique of {} requests), build {} ms", stats.TotalMilliseconds, stats.ParseMilliseconds, stats.TextureMilliseconds, stats.NumUniqueTextures, stats.NumTextureRequests, stats.BuildMilliseconds);
 	}
 	else
 	{
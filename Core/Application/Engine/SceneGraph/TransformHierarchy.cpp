@@ -0,0 +1,506 @@
+#include "TransformHierarchy.h"
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define TRANSFORM_HIERARCHY_SSE 1
+#include <emmintrin.h>
+#else
+#define TRANSFORM_HIERARCHY_SSE 0
+#endif
+
+namespace
+{
+using TClock = std::chrono::high_resolution_clock;
+
+#if TRANSFORM_HIERARCHY_SSE
+// Four nodes side by side, lets the SIMD and the scalar path share the math below
+struct SLanes
+{
+	__m128 V;
+};
+
+SLanes operator+(SLanes A, SLanes B)
+{
+	return { _mm_add_ps(A.V, B.V) };
+}
+
+SLanes operator-(SLanes A, SLanes B)
+{
+	return { _mm_sub_ps(A.V, B.V) };
+}
+
+SLanes operator*(SLanes A, SLanes B)
+{
+	return { _mm_mul_ps(A.V, B.V) };
+}
+
+SLanes Splat(SLanes, float Value)
+{
+	return { _mm_set1_ps(Value) };
+}
+#else
+float Splat(float, float Value)
+{
+	return Value;
+}
+#endif
+
+/*
+ * Local = scale * rotation * translation as in XMMatrixAffineTransformation, World = Local * Parent.
+ * Local holds position, rotation and scale, Parent and OutWorld the first three columns of the rows.
+ */
+template<typename T>
+void ComposeWorld(const T Local[10], const T Parent[12], T OutWorld[12])
+{
+	const T one = Splat(T{}, 1.0f);
+	const T two = Splat(T{}, 2.0f);
+	const T& x = Local[3];
+	const T& y = Local[4];
+	const T& z = Local[5];
+	const T& w = Local[6];
+	const T xx = x * x, yy = y * y, zz = z * z;
+	const T xy = x * y, xz = x * z, yz = y * z;
+	const T xw = x * w, yw = y * w, zw = z * w;
+
+	T local[3][3] = {
+		{ Local[7] * (one - two * (yy + zz)), Local[7] * (two * (xy + zw)), Local[7] * (two * (xz - yw)) },
+		{ Local[8] * (two * (xy - zw)), Local[8] * (one - two * (xx + zz)), Local[8] * (two * (yz + xw)) },
+		{ Local[9] * (two * (xz + yw)), Local[9] * (two * (yz - xw)), Local[9] * (one - two * (xx + yy)) }
+	};
+
+	for (int column = 0; column < 3; column++)
+	{
+		for (int row = 0; row < 3; row++)
+		{
+			OutWorld[row * 3 + column] = local[row][0] * Parent[column] + local[row][1] * Parent[3 + column] + local[row][2] * Parent[6 + column];
+		}
+		OutWorld[9 + column] = Local[0] * Parent[column] + Local[1] * Parent[3 + column] + Local[2] * Parent[6 + column] + Parent[9 + column];
+	}
+}
+} // namespace
+
+uint32_t OTransformHierarchy::Add(uint32_t Parent, const SLocalTransform& Local)
+{
+	uint32_t node;
+	if (FreeNodes.empty())
+	{
+		node = static_cast<uint32_t>(NodeToSlot.size());
+		NodeToSlot.push_back(InvalidNode);
+	}
+	else
+	{
+		node = FreeNodes.back();
+		FreeNodes.pop_back();
+	}
+
+	const auto slot = static_cast<uint32_t>(Flags.size());
+	NodeToSlot[node] = slot;
+	SlotToNode.push_back(node);
+	Parents.push_back(IsValid(Parent) ? NodeToSlot[Parent] : InvalidNode);
+	World.emplace_back();
+	Flags.push_back(Alive | Dirty);
+	for (auto* stream : { &PositionX, &PositionY, &PositionZ, &RotationX, &RotationY, &RotationZ, &RotationW, &ScaleX, &ScaleY, &ScaleZ })
+	{
+		stream->push_back(0.0f);
+	}
+	SetLocal(node, Local);
+	bNeedsSort = true;
+	return node;
+}
+
+void OTransformHierarchy::Remove(uint32_t Node)
+{
+	if (!IsValid(Node))
+	{
+		return;
+	}
+
+	// The slot keeps its parent until the next sort moves the children up
+	Flags[NodeToSlot[Node]] = 0;
+	NodeToSlot[Node] = InvalidNode;
+	FreeNodes.push_back(Node);
+	bNeedsSort = true;
+}
+
+void OTransformHierarchy::SetParent(uint32_t Node, uint32_t Parent)
+{
+	if (!IsValid(Node))
+	{
+		return;
+	}
+
+	const uint32_t parentSlot = IsValid(Parent) ? NodeToSlot[Parent] : InvalidNode;
+	for (uint32_t ancestor = parentSlot; ancestor != InvalidNode; ancestor = Parents[ancestor])
+	{
+		if (ancestor == NodeToSlot[Node])
+		{
+			// Would make a cycle
+			return;
+		}
+	}
+
+	const uint32_t slot = NodeToSlot[Node];
+	Parents[slot] = parentSlot;
+	Flags[slot] |= Dirty;
+	bNeedsSort = true;
+}
+
+uint32_t OTransformHierarchy::GetParent(uint32_t Node) const
+{
+	if (!IsValid(Node))
+	{
+		return InvalidNode;
+	}
+	uint32_t parentSlot = Parents[NodeToSlot[Node]];
+	while (parentSlot != InvalidNode && !(Flags[parentSlot] & Alive))
+	{
+		parentSlot = Parents[parentSlot];
+	}
+	return parentSlot == InvalidNode ? InvalidNode : SlotToNode[parentSlot];
+}
+
+bool OTransformHierarchy::IsValid(uint32_t Node) const
+{
+	return Node < NodeToSlot.size() && NodeToSlot[Node] != InvalidNode;
+}
+
+void OTransformHierarchy::SetLocal(uint32_t Node, const SLocalTransform& Local)
+{
+	if (!IsValid(Node))
+	{
+		return;
+	}
+
+	const uint32_t slot = NodeToSlot[Node];
+	PositionX[slot] = Local.Position[0];
+	PositionY[slot] = Local.Position[1];
+	PositionZ[slot] = Local.Position[2];
+	RotationX[slot] = Local.Rotation[0];
+	RotationY[slot] = Local.Rotation[1];
+	RotationZ[slot] = Local.Rotation[2];
+	RotationW[slot] = Local.Rotation[3];
+	ScaleX[slot] = Local.Scale[0];
+	ScaleY[slot] = Local.Scale[1];
+	ScaleZ[slot] = Local.Scale[2];
+	Flags[slot] |= Dirty;
+}
+
+SLocalTransform OTransformHierarchy::GetLocal(uint32_t Node) const
+{
+	SLocalTransform result;
+	if (IsValid(Node))
+	{
+		const uint32_t slot = NodeToSlot[Node];
+		result.Position[0] = PositionX[slot];
+		result.Position[1] = PositionY[slot];
+		result.Position[2] = PositionZ[slot];
+		result.Rotation[0] = RotationX[slot];
+		result.Rotation[1] = RotationY[slot];
+		result.Rotation[2] = RotationZ[slot];
+		result.Rotation[3] = RotationW[slot];
+		result.Scale[0] = ScaleX[slot];
+		result.Scale[1] = ScaleY[slot];
+		result.Scale[2] = ScaleZ[slot];
+	}
+	return result;
+}
+
+const STransformMatrix& OTransformHierarchy::GetWorld(uint32_t Node) const
+{
+	static const STransformMatrix identity;
+	return IsValid(Node) ? World[NodeToSlot[Node]] : identity;
+}
+
+bool OTransformHierarchy::WasUpdated(uint32_t Node) const
+{
+	return IsValid(Node) && (Flags[NodeToSlot[Node]] & Updated) != 0;
+}
+
+void OTransformHierarchy::Update()
+{
+	const auto start = TClock::now();
+	Stats.bSorted = bNeedsSort;
+	if (bNeedsSort)
+	{
+		Sort();
+	}
+
+	for (auto& flags : Flags)
+	{
+		flags &= ~Updated;
+	}
+
+	const uint32_t maxThreads = NumThreads > 0 ? NumThreads : std::max(std::thread::hardware_concurrency(), 1u);
+	Stats.NumUpdated = 0;
+	Stats.NumThreads = 1;
+	for (size_t level = 0; level + 1 < LevelStarts.size(); level++)
+	{
+		const uint32_t first = LevelStarts[level];
+		const uint32_t last = LevelStarts[level + 1];
+		const uint32_t numThreads = std::clamp((last - first) / std::max(MinNodesPerThread, 1u), 1u, maxThreads);
+		Stats.NumThreads = std::max(Stats.NumThreads, numThreads);
+
+		// Whole groups of four per thread, the parents of the level are already final
+		const uint32_t nodesPerThread = ((last - first + numThreads - 1) / numThreads + 3) & ~3u;
+		std::vector<std::future<uint32_t>> futures;
+		for (uint32_t thread = 1; thread < numThreads; thread++)
+		{
+			const uint32_t rangeFirst = first + thread * nodesPerThread;
+			const uint32_t rangeLast = std::min(rangeFirst + nodesPerThread, last);
+			if (rangeFirst < rangeLast)
+			{
+				futures.push_back(std::async(std::launch::async, [this, rangeFirst, rangeLast]() {
+					uint32_t numUpdated = 0;
+					for (uint32_t slot = rangeFirst; slot < rangeLast; slot += 4)
+					{
+						numUpdated += UpdateGroup(slot, std::min(slot + 4, rangeLast));
+					}
+					return numUpdated;
+				}));
+			}
+		}
+		const uint32_t localLast = std::min(first + nodesPerThread, last);
+		for (uint32_t slot = first; slot < localLast; slot += 4)
+		{
+			Stats.NumUpdated += UpdateGroup(slot, std::min(slot + 4, localLast));
+		}
+		for (auto& future : futures)
+		{
+			Stats.NumUpdated += future.get();
+		}
+	}
+
+	Stats.NumNodes = static_cast<uint32_t>(Flags.size());
+	Stats.NumLevels = LevelStarts.empty() ? 0 : static_cast<uint32_t>(LevelStarts.size() - 1);
+	Stats.Milliseconds = std::chrono::duration<float, std::milli>(TClock::now() - start).count();
+}
+
+size_t OTransformHierarchy::GetNumNodes() const
+{
+	return Flags.size();
+}
+
+const SHierarchyStats& OTransformHierarchy::GetStats() const
+{
+	return Stats;
+}
+
+void OTransformHierarchy::Sort()
+{
+	const auto numSlots = static_cast<uint32_t>(Flags.size());
+	for (uint32_t slot = 0; slot < numSlots; slot++)
+	{
+		// Children of removed nodes go to the closest living ancestor
+		uint32_t parent = Parents[slot];
+		while (parent != InvalidNode && !(Flags[parent] & Alive))
+		{
+			parent = Parents[parent];
+		}
+		if (parent != Parents[slot] && (Flags[slot] & Alive))
+		{
+			Flags[slot] |= Dirty;
+		}
+		Parents[slot] = parent;
+	}
+
+	std::vector<uint32_t> depths(numSlots, InvalidNode);
+	std::vector<uint32_t> chain;
+	uint32_t maxDepth = 0;
+	for (uint32_t slot = 0; slot < numSlots; slot++)
+	{
+		if (!(Flags[slot] & Alive))
+		{
+			continue;
+		}
+
+		// Walk up to the first node with a known depth, then assign the depths on the way back
+		chain.clear();
+		uint32_t current = slot;
+		while (current != InvalidNode && depths[current] == InvalidNode)
+		{
+			chain.push_back(current);
+			current = Parents[current];
+		}
+		uint32_t depth = current == InvalidNode ? 0 : depths[current] + 1;
+		for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+		{
+			depths[*it] = depth++;
+		}
+		maxDepth = std::max(maxDepth, depths[slot]);
+	}
+
+	// Counting sort keeps the relative order of the nodes inside of a level
+	LevelStarts.assign(numSlots > 0 ? maxDepth + 2 : 1, 0);
+	for (uint32_t slot = 0; slot < numSlots; slot++)
+	{
+		if (Flags[slot] & Alive)
+		{
+			LevelStarts[depths[slot] + 1]++;
+		}
+	}
+	for (size_t level = 1; level < LevelStarts.size(); level++)
+	{
+		LevelStarts[level] += LevelStarts[level - 1];
+	}
+
+	std::vector<uint32_t> oldToNew(numSlots, InvalidNode);
+	std::vector<uint32_t> newToOld(LevelStarts.back());
+	std::vector<uint32_t> cursors(LevelStarts.begin(), LevelStarts.end() - 1);
+	for (uint32_t slot = 0; slot < numSlots; slot++)
+	{
+		if (Flags[slot] & Alive)
+		{
+			const uint32_t newSlot = cursors[depths[slot]]++;
+			oldToNew[slot] = newSlot;
+			newToOld[newSlot] = slot;
+		}
+	}
+
+	auto permute = [&newToOld](auto& Stream) {
+		std::remove_reference_t<decltype(Stream)> sorted(newToOld.size());
+		for (size_t slot = 0; slot < newToOld.size(); slot++)
+		{
+			sorted[slot] = Stream[newToOld[slot]];
+		}
+		Stream.swap(sorted);
+	};
+	for (auto* stream : { &PositionX, &PositionY, &PositionZ, &RotationX, &RotationY, &RotationZ, &RotationW, &ScaleX, &ScaleY, &ScaleZ })
+	{
+		permute(*stream);
+	}
+	permute(Parents);
+	permute(World);
+	permute(Flags);
+	permute(SlotToNode);
+
+	for (uint32_t slot = 0; slot < SlotToNode.size(); slot++)
+	{
+		if (Parents[slot] != InvalidNode)
+		{
+			Parents[slot] = oldToNew[Parents[slot]];
+		}
+		NodeToSlot[SlotToNode[slot]] = slot;
+	}
+	bNeedsSort = false;
+}
+
+uint32_t OTransformHierarchy::UpdateGroup(uint32_t First, uint32_t Last)
+{
+	uint32_t laneMask = 0;
+	for (uint32_t slot = First; slot < Last; slot++)
+	{
+		const uint32_t parent = Parents[slot];
+		if ((Flags[slot] & Dirty) || (parent != InvalidNode && (Flags[parent] & Updated)))
+		{
+			laneMask |= 1u << (slot - First);
+		}
+	}
+	if (laneMask == 0)
+	{
+		return 0;
+	}
+	ComposeGroup(First, Last - First, laneMask);
+
+	uint32_t numUpdated = 0;
+	for (uint32_t slot = First; slot < Last; slot++)
+	{
+		if (laneMask & (1u << (slot - First)))
+		{
+			Flags[slot] = (Flags[slot] & ~Dirty) | Updated;
+			numUpdated++;
+		}
+	}
+	return numUpdated;
+}
+
+void OTransformHierarchy::ComposeGroup(uint32_t First, uint32_t Count, uint32_t LaneMask)
+{
+	const std::vector<float>* streams[10] = { &PositionX, &PositionY, &PositionZ, &RotationX, &RotationY, &RotationZ, &RotationW, &ScaleX, &ScaleY, &ScaleZ };
+	static const STransformMatrix identity;
+
+	// Lanes past Count repeat the last node, they are computed and never written
+	float local[10][4];
+	float parent[12][4];
+	for (uint32_t lane = 0; lane < 4; lane++)
+	{
+		const uint32_t slot = First + std::min(lane, Count - 1);
+		if (!TRANSFORM_HIERARCHY_SSE || Count < 4)
+		{
+			for (int i = 0; i < 10; i++)
+			{
+				local[i][lane] = (*streams[i])[slot];
+			}
+		}
+		const auto& parentWorld = Parents[slot] == InvalidNode ? identity : World[Parents[slot]];
+		for (int row = 0; row < 4; row++)
+		{
+			for (int column = 0; column < 3; column++)
+			{
+				parent[row * 3 + column][lane] = parentWorld.M[row][column];
+			}
+		}
+	}
+
+	float world[12][4];
+#if TRANSFORM_HIERARCHY_SSE
+	SLanes localLanes[10];
+	SLanes parentLanes[12];
+	SLanes worldLanes[12];
+	for (int i = 0; i < 10; i++)
+	{
+		// Full groups read the local transforms straight from the streams
+		localLanes[i].V = Count == 4 ? _mm_loadu_ps(&(*streams[i])[First]) : _mm_loadu_ps(local[i]);
+	}
+	for (int i = 0; i < 12; i++)
+	{
+		parentLanes[i].V = _mm_loadu_ps(parent[i]);
+	}
+	ComposeWorld(localLanes, parentLanes, worldLanes);
+	for (int i = 0; i < 12; i++)
+	{
+		_mm_storeu_ps(world[i], worldLanes[i].V);
+	}
+#else
+	for (uint32_t lane = 0; lane < 4; lane++)
+	{
+		float localLane[10];
+		float parentLane[12];
+		float worldLane[12];
+		for (int i = 0; i < 10; i++)
+		{
+			localLane[i] = local[i][lane];
+		}
+		for (int i = 0; i < 12; i++)
+		{
+			parentLane[i] = parent[i][lane];
+		}
+		ComposeWorld(localLane, parentLane, worldLane);
+		for (int i = 0; i < 12; i++)
+		{
+			world[i][lane] = worldLane[i];
+		}
+	}
+#endif
+
+	for (uint32_t lane = 0; lane < Count; lane++)
+	{
+		if (!(LaneMask & (1u << lane)))
+		{
+			continue;
+		}
+		auto& result = World[First + lane];
+		for (int row = 0; row < 4; row++)
+		{
+			for (int column = 0; column < 3; column++)
+			{
+				result.M[row][column] = world[row * 3 + column][lane];
+			}
+			result.M[row][3] = row == 3 ? 1.0f : 0.0f;
+		}
+	}
+}
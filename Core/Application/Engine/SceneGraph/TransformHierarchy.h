@@ -0,0 +1,104 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Parent/child transforms stored as structure of arrays sorted by depth, so every parent is updated before its children.
+ * Setting a local transform only marks the node, world matrices of the marked subtrees are rebuilt by Update four nodes at a time.
+ * Nodes of one depth level never depend on each other and are split between threads.
+ * Matrices use the DirectXMath row vector convention (world = local * parent), the layout matches XMFLOAT4X4. No D3D dependencies.
+ */
+
+struct SLocalTransform
+{
+	float Position[3] = { 0.0f, 0.0f, 0.0f };
+
+	// Quaternion
+	float Rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	float Scale[3] = { 1.0f, 1.0f, 1.0f };
+};
+
+struct STransformMatrix
+{
+	float M[4][4] = { { 1.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f } };
+};
+
+struct SHierarchyStats
+{
+	uint32_t NumNodes = 0;
+	uint32_t NumLevels = 0;
+	uint32_t NumUpdated = 0;
+	uint32_t NumThreads = 0;
+	bool bSorted = false;
+	float Milliseconds = 0.0f;
+};
+
+class OTransformHierarchy
+{
+public:
+	static constexpr uint32_t InvalidNode = UINT32_MAX;
+
+	/** @brief Handles stay valid until the node is removed */
+	uint32_t Add(uint32_t Parent = InvalidNode, const SLocalTransform& Local = {});
+
+	/** @brief Children of the removed node are attached to its parent and keep their local transforms */
+	void Remove(uint32_t Node);
+	void SetParent(uint32_t Node, uint32_t Parent);
+	uint32_t GetParent(uint32_t Node) const;
+	bool IsValid(uint32_t Node) const;
+
+	void SetLocal(uint32_t Node, const SLocalTransform& Local);
+	SLocalTransform GetLocal(uint32_t Node) const;
+
+	/** @brief Result of the last Update */
+	const STransformMatrix& GetWorld(uint32_t Node) const;
+
+	/** @brief True if the last Update rebuilt the world matrix of the node */
+	bool WasUpdated(uint32_t Node) const;
+
+	/** @brief Rebuilds the world matrices of the marked nodes and of everything below them */
+	void Update();
+
+	size_t GetNumNodes() const;
+	const SHierarchyStats& GetStats() const;
+
+	// 0 - use all hardware threads
+	uint32_t NumThreads = 0;
+
+	// Level size under which the level stays on the calling thread
+	uint32_t MinNodesPerThread = 4096;
+
+private:
+	enum EFlags : uint8_t
+	{
+		Dirty = 1 << 0,
+		Updated = 1 << 1,
+		Alive = 1 << 2
+	};
+
+	// Depth sort after nodes were added, removed or reparented, also drops the removed slots
+	void Sort();
+
+	// Up to four nodes, returns how many of them were rebuilt
+	uint32_t UpdateGroup(uint32_t First, uint32_t Last);
+	void ComposeGroup(uint32_t First, uint32_t Count, uint32_t LaneMask);
+
+	// Indexed by slot
+	std::vector<float> PositionX, PositionY, PositionZ;
+	std::vector<float> RotationX, RotationY, RotationZ, RotationW;
+	std::vector<float> ScaleX, ScaleY, ScaleZ;
+	std::vector<uint32_t> Parents;
+	std::vector<STransformMatrix> World;
+	std::vector<uint8_t> Flags;
+	std::vector<uint32_t> SlotToNode;
+
+	// Indexed by node handle
+	std::vector<uint32_t> NodeToSlot;
+	std::vector<uint32_t> FreeNodes;
+
+	// First slot of every depth level, the last entry is the slot count
+	std::vector<uint32_t> LevelStarts;
+	bool bNeedsSort = false;
+	SHierarchyStats Stats;
+};
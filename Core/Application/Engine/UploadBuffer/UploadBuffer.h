@@ -31,6 +31,12 @@ public:
 		memcpy(&MappedData[ElementIdx * ElementByteSize], &Data, sizeof(Type));
 	}
 
+	// Structured buffers only, constant buffer elements are padded
+	void CopyData(int StartIdx, const Type* Data, size_t Count)
+	{
+		memcpy(&MappedData[StartIdx * ElementByteSize], Data, Count * sizeof(Type));
+	}
+
 	uint32_t SetFreeIndex()
 	{
 		auto old = CurrentOffset;
@@ -0,0 +1,161 @@
+#include "UploadManager.h"
+
+#include "CommandQueue/CommandQueue.h"
+#include "Exception.h"
+#include "Logger.h"
+#include "Profiler.h"
+
+OUploadManager::OUploadManager(ID3D12Device* InDevice, OCommandQueue* InQueue, uint64_t Size)
+    : Device(InDevice), Queue(InQueue)
+{
+	const auto uploadProperty = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+	const auto desc = CD3DX12_RESOURCE_DESC::Buffer(Size);
+	THROW_IF_FAILED(Device->CreateCommittedResource(&uploadProperty,
+	                                                D3D12_HEAP_FLAG_NONE,
+	                                                &desc,
+	                                                D3D12_RESOURCE_STATE_GENERIC_READ,
+	                                                nullptr,
+	                                                IID_PPV_ARGS(RingBuffer.GetAddressOf())));
+	RingBuffer->SetName(L"UploadRing");
+
+	// Upload heaps stay mapped for their whole life, the CPU only writes
+	const D3D12_RANGE readRange = { 0, 0 };
+	THROW_IF_FAILED(RingBuffer->Map(0, &readRange, reinterpret_cast<void**>(&MappedData)));
+	Ring.Init(Size);
+	Queue->OnCommandListExecuted.AddMember(this, &OUploadManager::Submit);
+}
+
+OUploadManager::~OUploadManager()
+{
+	if (RingBuffer)
+	{
+		RingBuffer->Unmap(0, nullptr);
+	}
+}
+
+SUploadAllocation OUploadManager::Allocate(uint64_t Size, uint64_t Alignment)
+{
+	PROFILE_SCOPE();
+	Retire();
+	auto offset = Ring.Allocate(Size, Alignment);
+
+	// Waiting only helps when the ring is held by lists already executed
+	while (offset == OUploadRing::InvalidOffset && Size <= Ring.GetSize() && Ring.GetNumInFlight() > 0)
+	{
+		Queue->WaitForFenceValue(Ring.GetOldestFence());
+		Retire();
+		offset = Ring.Allocate(Size, Alignment);
+	}
+
+	if (offset != OUploadRing::InvalidOffset)
+	{
+		return { RingBuffer.Get(), offset, MappedData + offset, RingBuffer->GetGPUVirtualAddress() + offset };
+	}
+
+	LOG(Render, Warning, "Upload of {} bytes does not fit the upload ring, using a dedicated buffer", TEXT(Size));
+	SDedicated dedicated{ Ring.GetOpenTicket().Batch, Size, nullptr };
+	const auto uploadProperty = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+	const auto desc = CD3DX12_RESOURCE_DESC::Buffer(Size);
+	THROW_IF_FAILED(Device->CreateCommittedResource(&uploadProperty,
+	                                                D3D12_HEAP_FLAG_NONE,
+	                                                &desc,
+	                                                D3D12_RESOURCE_STATE_GENERIC_READ,
+	                                                nullptr,
+	                                                IID_PPV_ARGS(dedicated.Resource.GetAddressOf())));
+
+	uint8_t* mapped = nullptr;
+	const D3D12_RANGE readRange = { 0, 0 };
+	THROW_IF_FAILED(dedicated.Resource->Map(0, &readRange, reinterpret_cast<void**>(&mapped)));
+	SUploadAllocation allocation{ dedicated.Resource.Get(), 0, mapped, dedicated.Resource->GetGPUVirtualAddress() };
+	DedicatedBytes += Size;
+	Dedicated.push_back(std::move(dedicated));
+	return allocation;
+}
+
+ComPtr<ID3D12Resource> OUploadManager::CreateDefaultBuffer(const void* Data, uint64_t Size, SUploadTicket* OutTicket)
+{
+	ComPtr<ID3D12Resource> defaultBuffer;
+	const auto property = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+	const auto buffer = CD3DX12_RESOURCE_DESC::Buffer(Size);
+	THROW_IF_FAILED(Device->CreateCommittedResource(&property,
+	                                                D3D12_HEAP_FLAG_NONE,
+	                                                &buffer,
+	                                                D3D12_RESOURCE_STATE_COPY_DEST,
+	                                                nullptr,
+	                                                IID_PPV_ARGS(defaultBuffer.GetAddressOf())));
+
+	const auto allocation = Allocate(Size);
+	memcpy(allocation.CPUAddress, Data, Size);
+
+	auto commandList = GetCommandList();
+	commandList->CopyBufferRegion(defaultBuffer.Get(), 0, allocation.Resource, allocation.Offset, Size);
+	const auto transition = CD3DX12_RESOURCE_BARRIER::Transition(defaultBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ);
+	commandList->ResourceBarrier(1, &transition);
+
+	if (OutTicket)
+	{
+		*OutTicket = Ring.GetOpenTicket();
+	}
+	return defaultBuffer;
+}
+
+SUploadTicket OUploadManager::UploadSubresources(ID3D12Resource* Destination, uint32_t FirstSubresource, uint32_t NumSubresources, const D3D12_SUBRESOURCE_DATA* Data)
+{
+	const uint64_t size = GetRequiredIntermediateSize(Destination, FirstSubresource, NumSubresources);
+	const auto allocation = Allocate(size, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+	UpdateSubresources(GetCommandList(), Destination, allocation.Resource, allocation.Offset, FirstSubresource, NumSubresources, Data);
+	return Ring.GetOpenTicket();
+}
+
+void OUploadManager::KeepAlive(ComPtr<ID3D12Resource> Resource)
+{
+	if (Resource)
+	{
+		Dedicated.push_back({ Ring.GetOpenTicket().Batch, 0, std::move(Resource) });
+	}
+}
+
+bool OUploadManager::IsComplete(SUploadTicket Ticket)
+{
+	Retire();
+	return Ring.IsComplete(Ticket);
+}
+
+bool OUploadManager::Wait(SUploadTicket Ticket)
+{
+	if (IsComplete(Ticket))
+	{
+		return true;
+	}
+	if (!Ring.IsSubmitted(Ticket))
+	{
+		LOG(Render, Warning, "Waiting for an upload whose command list was not executed");
+		return false;
+	}
+	Queue->WaitForFenceValue(Ring.GetFence(Ticket));
+	Retire();
+	return true;
+}
+
+void OUploadManager::Retire()
+{
+	Ring.Retire(Queue->GetFence()->GetCompletedValue());
+	std::erase_if(Dedicated, [this](const SDedicated& Entry) {
+		if (!Ring.IsComplete({ Entry.Batch }))
+		{
+			return false;
+		}
+		DedicatedBytes -= Entry.Size;
+		return true;
+	});
+}
+
+ID3D12GraphicsCommandList* OUploadManager::GetCommandList() const
+{
+	return Queue->GetCommandList().Get();
+}
+
+void OUploadManager::Submit(uint64_t Fence)
+{
+	Ring.Submit(Fence);
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "DirectX/DXHelper.h"
+#include "Types.h"
+#include "UploadRing.h"
+
+#include <d3dx12.h>
+
+class OCommandQueue;
+
+struct SUploadAllocation
+{
+	ID3D12Resource* Resource = nullptr;
+	uint64_t Offset = 0;
+	uint8_t* CPUAddress = nullptr;
+	D3D12_GPU_VIRTUAL_ADDRESS GPUAddress = 0;
+};
+
+/**
+ * @brief Staging memory of every GPU upload, one persistently mapped upload buffer shared as a ring.
+ * Copies are recorded on the command list of the queue the manager is bound to, the ring follows its fence.
+ * Uploads larger than the ring, or made while the list being recorded already holds the whole ring, get a
+ * dedicated upload buffer that is released the same way.
+ */
+class OUploadManager
+{
+public:
+	OUploadManager(ID3D12Device* Device, OCommandQueue* Queue, uint64_t Size);
+	~OUploadManager();
+
+	OUploadManager(const OUploadManager&) = delete;
+	OUploadManager& operator=(const OUploadManager&) = delete;
+
+	SUploadAllocation Allocate(uint64_t Size, uint64_t Alignment = 16);
+
+	/** @brief Default heap buffer filled with Data, readable as GENERIC_READ once the ticket completes */
+	ComPtr<ID3D12Resource> CreateDefaultBuffer(const void* Data, uint64_t Size, SUploadTicket* OutTicket = nullptr);
+
+	/** @brief Copies the subresources into Destination, which has to be in COPY_DEST */
+	SUploadTicket UploadSubresources(ID3D12Resource* Destination, uint32_t FirstSubresource, uint32_t NumSubresources, const D3D12_SUBRESOURCE_DATA* Data);
+
+	/** @brief Keeps a staging resource created elsewhere until the uploads recorded so far complete */
+	void KeepAlive(ComPtr<ID3D12Resource> Resource);
+
+	SUploadTicket GetOpenTicket() const { return Ring.GetOpenTicket(); }
+	bool IsComplete(SUploadTicket Ticket);
+
+	/** @brief Blocks until the upload completed, false when the command list holding it was not executed yet */
+	bool Wait(SUploadTicket Ticket);
+
+	void Retire();
+
+	ID3D12GraphicsCommandList* GetCommandList() const;
+	const OUploadRing& GetRing() const { return Ring; }
+	uint64_t GetDedicatedBytes() const { return DedicatedBytes; }
+
+private:
+	void Submit(uint64_t Fence);
+
+	struct SDedicated
+	{
+		uint64_t Batch;
+		uint64_t Size;
+		ComPtr<ID3D12Resource> Resource;
+	};
+
+	ID3D12Device* Device = nullptr;
+	OCommandQueue* Queue = nullptr;
+	OUploadRing Ring;
+	ComPtr<ID3D12Resource> RingBuffer;
+	uint8_t* MappedData = nullptr;
+	vector<SDedicated> Dedicated;
+	uint64_t DedicatedBytes = 0;
+};
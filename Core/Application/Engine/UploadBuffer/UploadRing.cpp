@@ -0,0 +1,74 @@
+#include "UploadRing.h"
+
+void OUploadRing::Init(uint64_t InSize)
+{
+	Size = InSize;
+	Head = 0;
+	Used = 0;
+	OpenBytes = 0;
+	OpenBatch = 1;
+	LastRetiredBatch = 0;
+	InFlight.clear();
+}
+
+uint64_t OUploadRing::Allocate(uint64_t InSize, uint64_t Alignment)
+{
+	const uint64_t size = InSize > 0 ? InSize : 1;
+	if (size > Size)
+	{
+		return InvalidOffset;
+	}
+
+	// The bytes in use always run from the oldest batch up to the head, skipped bytes belong to the batch that skipped them
+	uint64_t offset = (Head + Alignment - 1) & ~(Alignment - 1);
+	if (offset + size > Size)
+	{
+		offset = 0;
+	}
+	const uint64_t skipped = offset >= Head ? offset - Head : Size - Head;
+	if (Used + skipped + size > Size)
+	{
+		return InvalidOffset;
+	}
+
+	Head = offset + size;
+	Used += skipped + size;
+	OpenBytes += skipped + size;
+	return offset;
+}
+
+void OUploadRing::Submit(uint64_t Fence)
+{
+	InFlight.push_back({ OpenBatch, Fence, OpenBytes });
+	OpenBatch++;
+	OpenBytes = 0;
+}
+
+void OUploadRing::Retire(uint64_t CompletedFence)
+{
+	while (!InFlight.empty() && InFlight.front().Fence <= CompletedFence)
+	{
+		Used -= InFlight.front().Bytes;
+		LastRetiredBatch = InFlight.front().Batch;
+		InFlight.pop_front();
+	}
+
+	if (Used == 0)
+	{
+		Head = 0;
+	}
+}
+
+uint64_t OUploadRing::GetFence(SUploadTicket Ticket) const
+{
+	if (InFlight.empty() || Ticket.Batch < InFlight.front().Batch || Ticket.Batch >= OpenBatch)
+	{
+		return 0;
+	}
+	return InFlight[Ticket.Batch - InFlight.front().Batch].Fence;
+}
+
+uint64_t OUploadRing::GetOldestFence() const
+{
+	return InFlight.empty() ? 0 : InFlight.front().Fence;
+}
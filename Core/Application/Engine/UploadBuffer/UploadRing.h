@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+
+/*
+ * Offset allocator of the shared staging ring. Allocations of the command list being recorded form the open batch,
+ * Submit closes it with the fence the list was executed with and Retire gives its bytes back once the fence completes.
+ * Batches are identified by increasing numbers, an upload ticket is the batch its copy was recorded in. No D3D dependencies.
+ */
+
+struct SUploadTicket
+{
+	uint64_t Batch = 0;
+
+	bool IsValid() const { return Batch != 0; }
+};
+
+class OUploadRing
+{
+public:
+	static constexpr uint64_t InvalidOffset = UINT64_MAX;
+
+	void Init(uint64_t Size);
+
+	/** @brief Alignment has to be a power of two, InvalidOffset when the bytes in flight leave no room */
+	uint64_t Allocate(uint64_t Size, uint64_t Alignment);
+
+	/** @brief Closes the open batch, its uploads complete with Fence */
+	void Submit(uint64_t Fence);
+
+	/** @brief Releases the batches whose fence is not above CompletedFence */
+	void Retire(uint64_t CompletedFence);
+
+	SUploadTicket GetOpenTicket() const { return { OpenBatch }; }
+	bool IsSubmitted(SUploadTicket Ticket) const { return Ticket.Batch < OpenBatch; }
+	bool IsComplete(SUploadTicket Ticket) const { return Ticket.Batch <= LastRetiredBatch; }
+
+	/** @brief Fence of a submitted batch that is still in flight, 0 otherwise */
+	uint64_t GetFence(SUploadTicket Ticket) const;
+
+	/** @brief Fence of the oldest batch in flight, 0 when nothing is in flight */
+	uint64_t GetOldestFence() const;
+
+	uint64_t GetSize() const { return Size; }
+	uint64_t GetUsed() const { return Used; }
+	uint64_t GetOpenBytes() const { return OpenBytes; }
+	uint32_t GetNumInFlight() const { return static_cast<uint32_t>(InFlight.size()); }
+
+private:
+	struct SBatch
+	{
+		uint64_t Batch;
+		uint64_t Fence;
+		uint64_t Bytes;
+	};
+
+	uint64_t Size = 0;
+	uint64_t Head = 0;
+	uint64_t Used = 0;
+	uint64_t OpenBytes = 0;
+	uint64_t OpenBatch = 1;
+	uint64_t LastRetiredBatch = 0;
+	std::deque<SBatch> InFlight;
+};
@@ -129,9 +129,11 @@ void SShaderPipelineDesc::SetComputeResourceCBView(const string& Name, D3D12_GPU
 	switch (param.Type)
 	{
 	case D3D12_ROOT_PARAMETER_TYPE_SRV:
-	case D3D12_ROOT_PARAMETER_TYPE_UAV:
-	case D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE:
 		CmdList->SetComputeRootShaderResourceView(idx, Handle);
+		break;
+	case D3D12_ROOT_PARAMETER_TYPE_UAV:
+		CmdList->SetComputeRootUnorderedAccessView(idx, Handle);
+		break;
 	case D3D12_ROOT_PARAMETER_TYPE_CBV:
 		CmdList->SetComputeRootConstantBufferView(idx, Handle);
 		break;
@@ -149,9 +151,11 @@ void SShaderPipelineDesc::SetGraphicsResourceCBView(const string& Name, D3D12_GP
 	switch (param.Type)
 	{
 	case D3D12_ROOT_PARAMETER_TYPE_SRV:
-	case D3D12_ROOT_PARAMETER_TYPE_UAV:
 		CmdList->SetGraphicsRootShaderResourceView(idx, Handle);
 		break;
+	case D3D12_ROOT_PARAMETER_TYPE_UAV:
+		CmdList->SetGraphicsRootUnorderedAccessView(idx, Handle);
+		break;
 	case D3D12_ROOT_PARAMETER_TYPE_CBV:
 		CmdList->SetGraphicsRootConstantBufferView(idx, Handle);
 		break;
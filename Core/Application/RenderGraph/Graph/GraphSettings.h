@@ -2,8 +2,8 @@
 #include "Engine/Engine.h"
 #include "RenderGraph/Nodes/AABBVisualizer/AabbVisNode.h"
 #include "RenderGraph/Nodes/CopyNode/CopyRenderNode.h"
-#include "RenderGraph/Nodes/DebugGeometryNode/ODebugGeometryNode.h"
-#include "RenderGraph/Nodes/FrustrumDebugNode/FrustumDebugNode.h"
+#include "RenderGraph/Nodes/DebugDrawNode/DebugDrawNode.h"
+#include "RenderGraph/Nodes/LightCullingNode/LightCullingNode.h"
 #include "RenderGraph/Nodes/PostProcessNode/PostProcessNode.h"
 #include "RenderGraph/Nodes/PresentNode/PresentNode.h"
 #include "RenderGraph/Nodes/ReflectionNode/ReflectionNode.h"
@@ -29,13 +29,15 @@ static unordered_map<string, SNodeFactory> FactoryMap = {
 		{"UI", []() { return make_unique<OUIRenderNode>(); }},
 		{"Present", []() { return make_unique<OPresentNode>(); }},
 		{"Shadow", []() { return make_unique<OShadowMapNode>(); }},
+		{"LightCulling", []() { return make_unique<OLightCullingNode>(); }},
 		{"ShadowDebug", []() { return make_unique<OShadowDebugNode>(); }},
 		{"SSAO", []() { return make_unique<OSSAONode>(); }},
 		{"CopyTarget", []() { return make_unique<OCopyRenderNode>(OEngine::Get()->GetWindow().lock()); }},
 		{"TangentNormalDebug", []() { return make_unique<TangentNormalDebugNode>(); }},
-		{"FrustumDebug", []() { return make_unique<OFrustumDebugNode>(); }},
 		{"AABBVisualizer", []() { return make_unique<OAABBVisNode>(); }},
-		{"DebugBox", []() { return make_unique<ODebugGeometryNode>(); }}
+#if ENABLE_DEBUG_DRAW
+		{"DebugDraw", []() { return make_unique<ODebugDrawNode>(); }},
+#endif
 	}
 };
 
@@ -0,0 +1,144 @@
+#include "QueueScheduler.h"
+
+#include <algorithm>
+
+namespace
+{
+constexpr uint32_t None = UINT32_MAX;
+
+bool Intersects(const std::vector<std::string>& A, const std::vector<std::string>& B)
+{
+	return std::ranges::any_of(A, [&](const std::string& Name) { return std::ranges::find(B, Name) != B.end(); });
+}
+
+ERenderQueue GetOtherQueue(ERenderQueue Queue)
+{
+	return Queue == ERenderQueue::Direct ? ERenderQueue::Compute : ERenderQueue::Direct;
+}
+
+struct SQueueState
+{
+	uint32_t LastRecorded = None;
+	uint32_t LastSubmitted = None;
+
+	// Last pass of the other queue this queue already waited for
+	uint32_t Waited = None;
+	bool bOpen = false;
+};
+} // namespace
+
+bool OQueueScheduler::DependsOn(const SQueuePass& Pass, const SQueuePass& Earlier)
+{
+	if (!Pass.DeclaresResources() || !Earlier.DeclaresResources())
+	{
+		return true;
+	}
+	return Intersects(Pass.Reads, Earlier.Writes) || Intersects(Pass.Writes, Earlier.Writes) || Intersects(Pass.Writes, Earlier.Reads);
+}
+
+void OQueueScheduler::Plan(const std::vector<SQueuePass>& Passes)
+{
+	Steps.clear();
+	NumWaits = 0;
+	NumSubmits = 0;
+	bUsesCompute = false;
+
+	SQueueState queues[2];
+	auto state = [&](ERenderQueue Queue) -> SQueueState& { return queues[static_cast<uint32_t>(Queue)]; };
+
+	auto submit = [&](ERenderQueue Queue) {
+		auto& queue = state(Queue);
+		Steps.push_back({ EQueueAction::Submit, Queue, queue.LastRecorded });
+		queue.LastSubmitted = queue.LastRecorded;
+		queue.bOpen = false;
+		NumSubmits++;
+	};
+
+	// Fence values only grow, waiting for a later submission of the other queue covers the earlier ones
+	auto waitFor = [&](ERenderQueue Queue, uint32_t Pass) {
+		auto& self = state(Queue);
+		auto& other = state(GetOtherQueue(Queue));
+		if (self.Waited != None && self.Waited >= Pass)
+		{
+			return;
+		}
+		if (other.LastSubmitted == None || other.LastSubmitted < Pass)
+		{
+			submit(GetOtherQueue(Queue));
+		}
+		if (self.bOpen)
+		{
+			submit(Queue);
+		}
+		Steps.push_back({ EQueueAction::Wait, Queue, other.LastSubmitted });
+		self.Waited = other.LastSubmitted;
+		NumWaits++;
+	};
+
+	uint32_t lastDirect = None;
+	for (uint32_t idx = 0; idx < Passes.size(); idx++)
+	{
+		if (Passes[idx].Queue == ERenderQueue::Direct)
+		{
+			lastDirect = idx;
+		}
+	}
+
+	// The latest producer on the other queue is enough, the scan stops at what an earlier wait covers
+	auto findProducer = [&](uint32_t Index, uint32_t Waited) {
+		const auto otherQueue = GetOtherQueue(Passes[Index].Queue);
+		for (uint32_t earlier = Index; earlier-- > 0;)
+		{
+			if (Waited != None && earlier <= Waited)
+			{
+				break;
+			}
+			if (Passes[earlier].Queue == otherQueue && (Index == lastDirect || DependsOn(Passes[Index], Passes[earlier])))
+			{
+				return earlier;
+			}
+		}
+		return None;
+	};
+
+	// A producer ends its list, otherwise the wait would also hold back the passes recorded after it
+	std::vector<bool> endsList(Passes.size(), false);
+	uint32_t waited[2] = { None, None };
+	for (uint32_t idx = 0; idx < Passes.size(); idx++)
+	{
+		auto& queueWaited = waited[static_cast<uint32_t>(Passes[idx].Queue)];
+		const uint32_t producer = findProducer(idx, queueWaited);
+		if (producer != None)
+		{
+			endsList[producer] = true;
+			queueWaited = producer;
+		}
+	}
+
+	for (uint32_t idx = 0; idx < Passes.size(); idx++)
+	{
+		const auto& pass = Passes[idx];
+		const uint32_t producer = findProducer(idx, state(pass.Queue).Waited);
+		if (producer != None)
+		{
+			waitFor(pass.Queue, producer);
+		}
+
+		Steps.push_back({ EQueueAction::Record, pass.Queue, idx });
+		auto& queue = state(pass.Queue);
+		queue.LastRecorded = idx;
+		queue.bOpen = true;
+		bUsesCompute |= pass.Queue == ERenderQueue::Compute;
+		if (endsList[idx])
+		{
+			submit(pass.Queue);
+		}
+	}
+
+	// Compute work after the last direct pass still has to be joined into the direct queue
+	const auto& compute = state(ERenderQueue::Compute);
+	if (compute.LastRecorded != None && (lastDirect == None || compute.LastRecorded > lastDirect))
+	{
+		waitFor(ERenderQueue::Direct, compute.LastRecorded);
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Spreads the passes of a frame over the direct and the compute queue. A pass depends on every earlier pass that writes
+ * what it reads or uses what it writes, a pass that declares no resources depends on all passes before it and all passes
+ * after it depend on it. A dependency on the other queue submits the list holding the producer and makes the queue wait
+ * on the GPU for its fence, waits that an earlier wait of the same queue already covers are dropped. The work recorded
+ * before a wait is submitted first so it can overlap with the other queue. The last direct pass waits for all compute
+ * passes, so the fence signaled after it covers the whole frame. No D3D dependencies.
+ */
+
+enum class ERenderQueue : uint8_t
+{
+	Direct,
+	Compute
+};
+
+struct SQueuePass
+{
+	ERenderQueue Queue = ERenderQueue::Direct;
+	std::vector<std::string> Reads;
+	std::vector<std::string> Writes;
+
+	bool DeclaresResources() const { return !Reads.empty() || !Writes.empty(); }
+};
+
+enum class EQueueAction : uint8_t
+{
+	// Record the pass into the open list of the queue
+	Record,
+
+	// Close and execute the open list of the queue and signal its fence
+	Submit,
+
+	// The queue waits on the GPU for the last fence value the other queue signaled
+	Wait
+};
+
+struct SQueueStep
+{
+	EQueueAction Action = EQueueAction::Record;
+	ERenderQueue Queue = ERenderQueue::Direct;
+
+	// Record: the pass to record, Submit: the last pass in the list, Wait: the last pass of the other queue the wait covers
+	uint32_t Pass = 0;
+};
+
+class OQueueScheduler
+{
+public:
+	/** @brief Passes are in the order the CPU records them */
+	void Plan(const std::vector<SQueuePass>& Passes);
+
+	const std::vector<SQueueStep>& GetSteps() const { return Steps; }
+	uint32_t GetNumWaits() const { return NumWaits; }
+	uint32_t GetNumSubmits() const { return NumSubmits; }
+	bool UsesCompute() const { return bUsesCompute; }
+
+	static bool DependsOn(const SQueuePass& Pass, const SQueuePass& Earlier);
+
+private:
+	std::vector<SQueueStep> Steps;
+	uint32_t NumWaits = 0;
+	uint32_t NumSubmits = 0;
+	bool bUsesCompute = false;
+};
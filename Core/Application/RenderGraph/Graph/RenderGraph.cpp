@@ -7,9 +7,7 @@
 #include "Profiler.h"
 #include "RenderGraph/Nodes/AABBVisualizer/AabbVisNode.h"
 #include "RenderGraph/Nodes/CopyNode/CopyRenderNode.h"
-#include "RenderGraph/Nodes/DebugGeometryNode/ODebugGeometryNode.h"
 #include "RenderGraph/Nodes/DefaultNode/DefaultRenderNode.h"
-#include "RenderGraph/Nodes/FrustrumDebugNode/FrustumDebugNode.h"
 #include "RenderGraph/Nodes/PostProcessNode/PostProcessNode.h"
 #include "RenderGraph/Nodes/PresentNode/PresentNode.h"
 #include "RenderGraph/Nodes/ReflectionNode/ReflectionNode.h"
@@ -18,6 +16,7 @@
 #include "RenderGraph/Nodes/ShadowNode/ShadowMapNode.h"
 #include "RenderGraph/Nodes/TangentNormalDebugNode/TangentNormalDebugNode.h"
 #include "RenderGraph/Nodes/UINode/UiRenderNode.h"
+#include "TransientResourcePool.h"
 
 ORenderGraph::ORenderGraph()
 {
@@ -28,6 +27,7 @@ void ORenderGraph::Initialize(OGraphicsPipelineManager* PipelineManager, OComman
 {
 	this->PipelineManager = PipelineManager;
 	CommandQueue = OtherCommandQueue;
+	ComputeQueue = OEngine::Get()->GetCommandQueue(D3D12_COMMAND_LIST_TYPE_COMPUTE);
 	string head;
 	auto graph = Reader->LoadRenderGraph(head);
 	for (auto& node : graph)
@@ -37,10 +37,41 @@ void ORenderGraph::Initialize(OGraphicsPipelineManager* PipelineManager, OComman
 		{
 			Head = newNode.get();
 		}
-		newNode->Initialize(node, OtherCommandQueue, this, node.PSOType);
+		if (node.bAsyncCompute && !newNode->IsComputeEligible())
+		{
+			LOG(Render, Warning, "Node {} records graphics work and stays on the direct queue", TEXT(node.Name));
+			node.bAsyncCompute = false;
+		}
+		newNode->Initialize(node, node.bAsyncCompute ? ComputeQueue : OtherCommandQueue, this, node.PSOType);
 		Graph[node.Name] = newNode.get();
 		Nodes.push_back(move(newNode));
 	}
+	PlaceTransientResources();
+}
+
+void ORenderGraph::PlaceTransientResources()
+{
+	// Passes follow the execution order, disabled nodes keep theirs so toggling them needs no new placement
+	auto pool = OEngine::Get()->GetTransientResources();
+	uint32_t pass = 0;
+	for (auto node = Head; node != nullptr; node = GetNext(node))
+	{
+		pass += node->SetupTransientLifetimes(pool, pass);
+	}
+	pool->Compile();
+}
+
+void ORenderGraph::PlanQueues()
+{
+	vector<SQueuePass> passes(FrameNodes.size());
+	for (size_t idx = 0; idx < FrameNodes.size(); idx++)
+	{
+		passes[idx].Queue = FrameNodes[idx]->GetNodeInfo().bAsyncCompute ? ERenderQueue::Compute : ERenderQueue::Direct;
+		FrameNodes[idx]->DeclareResources(passes[idx]);
+	}
+	Scheduler.Plan(passes);
+	PlannedNodes = FrameNodes;
+	LOG(Render, Log, "Planned {} nodes with {} submissions and {} queue waits", TEXT(passes.size()), TEXT(Scheduler.GetNumSubmits()), TEXT(Scheduler.GetNumWaits()));
 }
 
 ORenderNode* ORenderGraph::GetHead() const
@@ -58,6 +89,26 @@ void ORenderGraph::ReloadShaders()
 	PipelineManager->ReloadShaders();
 }
 
+void ORenderGraph::PrepareFrame()
+{
+	PROFILE_SCOPE();
+
+	// Updates may enable or disable nodes, so the frame is planned once all of them ran
+	FrameNodes.clear();
+	for (auto node = Head; node != nullptr; node = GetNext(node))
+	{
+		node->Update();
+		if (node->GetNodeInfo().bEnable)
+		{
+			FrameNodes.push_back(node);
+		}
+	}
+	if (FrameNodes != PlannedNodes)
+	{
+		PlanQueues();
+	}
+}
+
 void ORenderGraph::Execute()
 {
 	PROFILE_SCOPE();
@@ -65,23 +116,35 @@ void ORenderGraph::Execute()
 	auto engine = OEngine::Get();
 	if (engine->GetDescriptorHeap())
 	{
-		auto currentNode = Head;
+		engine->GetGpuProfiler()->BeginFrame(engine->CurrentFrameResourceIndex);
 		engine->GetWindow().lock()->SetViewport(CommandQueue->GetCommandList().Get());
 		ORenderTargetBase* texture = OEngine::Get()->GetOffscreenRT().lock().get();
 		engine->SetDescriptorHeap(Default);
 		CommandQueue->SetAndClearRenderTarget(texture);
-		while (currentNode != nullptr)
+
+		if (Scheduler.UsesCompute())
 		{
-			currentNode->Update();
-			if (!currentNode->GetNodeInfo().bEnable)
+			// The previous frames may still read what the compute nodes write
+			ComputeQueue->WaitForQueue(CommandQueue, CommandQueue->GetLastFenceValue());
+		}
+
+		for (const auto& step : Scheduler.GetSteps())
+		{
+			switch (step.Action)
 			{
-				currentNode = GetNext(currentNode);
-				continue;
+			case EQueueAction::Record:
+				texture = ExecuteNode(FrameNodes[step.Pass], texture);
+				break;
+			case EQueueAction::Submit:
+				SubmitQueue(step.Queue, texture);
+				break;
+			case EQueueAction::Wait:
+			{
+				const auto other = GetQueue(step.Queue == ERenderQueue::Direct ? ERenderQueue::Compute : ERenderQueue::Direct);
+				GetQueue(step.Queue)->WaitForQueue(other, other->GetLastFenceValue());
+				break;
+			}
 			}
-			LOG(Render, Log, "Executing node: {}", TEXT(currentNode->GetNodeInfo().Name));
-			currentNode->SetupCommonResources();
-			texture = currentNode->Execute(texture);
-			currentNode = Graph[currentNode->GetNextNode()];
 		}
 	}
 	else
@@ -89,6 +152,57 @@ void ORenderGraph::Execute()
 		LOG(Render, Error, "SRVHeap is not initialized!");
 	}
 }
+
+ORenderTargetBase* ORenderGraph::ExecuteNode(ORenderNode* Node, ORenderTargetBase* RenderTarget)
+{
+	LOG(Render, Log, "Executing node: {}", TEXT(Node->GetNodeInfo().Name));
+	auto engine = OEngine::Get();
+	if (Node->GetNodeInfo().bAsyncCompute)
+	{
+		if (!bComputeListOpen)
+		{
+			ComputeQueue->TryResetCommandList();
+			ComputeQueue->ResetQueueState();
+			engine->SetDescriptorHeap(Default, ComputeQueue);
+			bComputeListOpen = true;
+		}
+
+		// Compute timestamps tick at their own frequency, the profiler only measures the direct queue
+		Node->SetupCommonResources();
+		return Node->Execute(RenderTarget);
+	}
+
+	auto gpuProfiler = engine->GetGpuProfiler();
+	auto commandList = CommandQueue->GetCommandList().Get();
+	gpuProfiler->BeginScope(commandList, Node->GetNodeInfo().Name);
+	Node->SetupCommonResources();
+	auto result = Node->Execute(RenderTarget);
+
+	// The present node resolves the queries and closes the list, the scope ends there
+	gpuProfiler->EndScope(commandList);
+	return result;
+}
+
+void ORenderGraph::SubmitQueue(ERenderQueue Queue, ORenderTargetBase* RenderTarget)
+{
+	if (Queue == ERenderQueue::Compute)
+	{
+		ComputeQueue->ExecuteCommandList();
+		bComputeListOpen = false;
+		return;
+	}
+
+	// The new direct list starts without the heap, viewport and render target the nodes expect
+	auto engine = OEngine::Get();
+	const auto target = CommandQueue->GetCurrentRenderTarget();
+	CommandQueue->ExecuteCommandList();
+	CommandQueue->TryResetCommandList();
+	CommandQueue->ResetQueueState();
+	engine->SetDescriptorHeap(Default);
+	engine->GetWindow().lock()->SetViewport(CommandQueue->GetCommandList().Get());
+	CommandQueue->SetRenderTarget(target ? target : RenderTarget);
+}
+
 void ORenderGraph::SetPSO(const string& Type) const
 {
 	CommandQueue->SetPipelineState(PipelineManager->FindPSO(Type));
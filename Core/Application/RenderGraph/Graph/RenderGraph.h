@@ -1,4 +1,5 @@
 #pragma once
+#include "QueueScheduler.h"
 #include "RenderGraph/Nodes/RenderNode.h"
 #include "RenderGraphReader/RenderGraphReader.h"
 #include "Types.h"
@@ -11,6 +12,9 @@ public:
 	ORenderGraph();
 	using ODependencyInfo = unordered_map<string, ORenderNode*>;
 	void Initialize(OGraphicsPipelineManager* PipelineManager, OCommandQueue* OtherCommandQueue);
+
+	/** @brief Runs the node updates and plans the queues, between frames while neither pipeline stage runs */
+	void PrepareFrame();
 	void Execute();
 	void SetPSO(const string& Type) const;
 	SPSODescriptionBase* FindPSOInfo(const string& Name) const;
@@ -20,10 +24,23 @@ public:
 	void ReloadShaders();
 
 private:
+	void PlaceTransientResources();
+	void PlanQueues();
+	ORenderTargetBase* ExecuteNode(ORenderNode* Node, ORenderTargetBase* RenderTarget);
+	void SubmitQueue(ERenderQueue Queue, ORenderTargetBase* RenderTarget);
+	OCommandQueue* GetQueue(ERenderQueue Queue) const { return Queue == ERenderQueue::Compute ? ComputeQueue : CommandQueue; }
+
 	unique_ptr<ORenderGraphReader> Reader;
 	vector<unique_ptr<ORenderNode>> Nodes;
 	ODependencyInfo Graph;
 	ORenderNode* Head = nullptr;
 	OCommandQueue* CommandQueue;
+	OCommandQueue* ComputeQueue = nullptr;
 	OGraphicsPipelineManager* PipelineManager;
+
+	// Enabled nodes in execution order, the queues are planned again when they change
+	vector<ORenderNode*> FrameNodes;
+	vector<ORenderNode*> PlannedNodes;
+	OQueueScheduler Scheduler;
+	bool bComputeListOpen = false;
 };
@@ -0,0 +1,124 @@
+#include "TransientPlanner.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+namespace
+{
+uint64_t AlignUp(uint64_t Value, uint64_t Alignment)
+{
+	return Alignment > 1 ? (Value + Alignment - 1) / Alignment * Alignment : Value;
+}
+} // namespace
+
+void OTransientPlanner::Plan(const std::vector<STransientRequest>& Requests)
+{
+	Placements.assign(Requests.size(), {});
+	Heaps.clear();
+	HeapResources.clear();
+	CommittedBytes = 0;
+	HeapBytes = 0;
+	PeakLiveBytes = 0;
+
+	// Largest first, so small resources fill the gaps the large ones leave between their lifetimes
+	std::vector<uint32_t> order(Requests.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t A, uint32_t B) {
+		if (Requests[A].Size != Requests[B].Size)
+		{
+			return Requests[A].Size > Requests[B].Size;
+		}
+		return Requests[A].FirstPass < Requests[B].FirstPass;
+	});
+
+	for (const uint32_t index : order)
+	{
+		const auto& request = Requests[index];
+		CommittedBytes += request.Size;
+
+		uint32_t heap = 0;
+		uint64_t offset = 0;
+		for (; heap < Heaps.size(); heap++)
+		{
+			if (Heaps[heap].Category != request.Category)
+			{
+				continue;
+			}
+			offset = FindOffset(Requests, heap, index);
+			if (offset + request.Size <= MaxHeapSize)
+			{
+				break;
+			}
+		}
+
+		if (heap == Heaps.size())
+		{
+			offset = 0;
+			Heaps.push_back({ request.Category, 0 });
+			HeapResources.emplace_back();
+		}
+
+		Placements[index] = { heap, offset, false };
+		Heaps[heap].Size = std::max(Heaps[heap].Size, offset + request.Size);
+		HeapResources[heap].push_back(index);
+	}
+
+	for (uint32_t heap = 0; heap < Heaps.size(); heap++)
+	{
+		HeapBytes += Heaps[heap].Size;
+		const auto& resources = HeapResources[heap];
+		for (size_t a = 0; a < resources.size(); a++)
+		{
+			for (size_t b = a + 1; b < resources.size(); b++)
+			{
+				auto& first = Placements[resources[a]];
+				auto& second = Placements[resources[b]];
+				if (first.Offset < second.Offset + Requests[resources[b]].Size && second.Offset < first.Offset + Requests[resources[a]].Size)
+				{
+					first.bAliased = true;
+					second.bAliased = true;
+				}
+			}
+		}
+	}
+
+	for (const auto& pass : Requests)
+	{
+		uint64_t live = 0;
+		for (const auto& request : Requests)
+		{
+			if (request.FirstPass <= pass.FirstPass && pass.FirstPass <= request.LastPass)
+			{
+				live += request.Size;
+			}
+		}
+		PeakLiveBytes = std::max(PeakLiveBytes, live);
+	}
+}
+
+uint64_t OTransientPlanner::FindOffset(const std::vector<STransientRequest>& Requests, uint32_t Heap, uint32_t Index) const
+{
+	// Only resources alive at the same time block bytes, the rest may be overwritten
+	std::vector<std::pair<uint64_t, uint64_t>> blocked;
+	for (const uint32_t other : HeapResources[Heap])
+	{
+		if (LifetimesOverlap(Requests[other], Requests[Index]))
+		{
+			blocked.emplace_back(Placements[other].Offset, Placements[other].Offset + Requests[other].Size);
+		}
+	}
+	std::sort(blocked.begin(), blocked.end());
+
+	const auto& request = Requests[Index];
+	uint64_t offset = 0;
+	for (const auto& [start, end] : blocked)
+	{
+		if (offset + request.Size <= start)
+		{
+			break;
+		}
+		offset = std::max(offset, AlignUp(end, request.Alignment));
+	}
+	return offset;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/*
+ * Packs transient resources into a few heaps. Two resources may share bytes only when they belong to the same heap
+ * category and their pass ranges do not overlap, every resource sharing bytes with another one needs an aliasing
+ * barrier before its first use in a frame. No D3D dependencies.
+ */
+
+struct STransientRequest
+{
+	uint64_t Size = 0;
+	uint64_t Alignment = 1;
+	uint32_t Category = 0;
+	uint32_t FirstPass = 0;
+	uint32_t LastPass = UINT32_MAX;
+};
+
+struct STransientPlacement
+{
+	uint32_t Heap = 0;
+	uint64_t Offset = 0;
+	bool bAliased = false;
+};
+
+struct STransientHeap
+{
+	uint32_t Category = 0;
+	uint64_t Size = 0;
+};
+
+class OTransientPlanner
+{
+public:
+	explicit OTransientPlanner(uint64_t MaxHeapSize)
+	    : MaxHeapSize(MaxHeapSize) {}
+
+	/** @brief Placements are in the order of the requests */
+	void Plan(const std::vector<STransientRequest>& Requests);
+
+	const std::vector<STransientPlacement>& GetPlacements() const { return Placements; }
+	const std::vector<STransientHeap>& GetHeaps() const { return Heaps; }
+
+	/** @brief Bytes the requests take as separate resources */
+	uint64_t GetCommittedBytes() const { return CommittedBytes; }
+
+	/** @brief Bytes of all heaps after aliasing */
+	uint64_t GetHeapBytes() const { return HeapBytes; }
+
+	/** @brief Largest sum of sizes alive in one pass, no packing does better */
+	uint64_t GetPeakLiveBytes() const { return PeakLiveBytes; }
+
+	static bool LifetimesOverlap(const STransientRequest& A, const STransientRequest& B)
+	{
+		return A.FirstPass <= B.LastPass && B.FirstPass <= A.LastPass;
+	}
+
+private:
+	uint64_t FindOffset(const std::vector<STransientRequest>& Requests, uint32_t Heap, uint32_t Index) const;
+
+	uint64_t MaxHeapSize = 0;
+	std::vector<STransientPlacement> Placements;
+	std::vector<STransientHeap> Heaps;
+	std::vector<std::vector<uint32_t>> HeapResources;
+	uint64_t CommittedBytes = 0;
+	uint64_t HeapBytes = 0;
+	uint64_t PeakLiveBytes = 0;
+};
@@ -0,0 +1,161 @@
+#include "TransientResourcePool.h"
+
+#include "Engine/RenderTarget/RenderObject/RenderObject.h"
+#include "Exception.h"
+#include "Logger.h"
+#include "Profiler.h"
+
+namespace
+{
+enum ETransientHeapCategory : uint32_t
+{
+	Buffers,
+	Textures,
+	RenderTargets
+};
+} // namespace
+
+OTransientResourcePool::OTransientResourcePool(ID3D12Device* Device, uint64_t MaxHeapSize)
+    : Device(Device), Planner(MaxHeapSize)
+{
+}
+
+TResourceInfo OTransientResourcePool::Declare(const weak_ptr<IRenderObject>& Owner, const wstring& Name, const D3D12_RESOURCE_DESC& Desc, D3D12_RESOURCE_STATES InitialState, const D3D12_CLEAR_VALUE* ClearValue)
+{
+	const auto owner = Owner.lock();
+	auto it = std::ranges::find_if(Entries, [&](const SEntry& Entry) { return Entry.OwnerKey == owner.get() && Entry.Name == Name; });
+	if (it == Entries.end())
+	{
+		SEntry entry;
+		entry.Owner = Owner;
+		entry.OwnerKey = owner.get();
+		entry.Name = Name;
+		entry.Info = make_shared<SResourceInfo>();
+		entry.Info->Context = Owner;
+		Entries.push_back(std::move(entry));
+		it = std::prev(Entries.end());
+	}
+
+	it->Desc = Desc;
+	it->InitialState = InitialState;
+	it->bHasClearValue = ClearValue != nullptr;
+	it->ClearValue = ClearValue ? *ClearValue : D3D12_CLEAR_VALUE{};
+	it->Info->Resource.Reset();
+	it->Info->CurrentState = InitialState;
+	return it->Info;
+}
+
+void OTransientResourcePool::SetLifetime(const IRenderObject* Owner, uint32_t FirstPass, uint32_t LastPass)
+{
+	for (auto& entry : Entries)
+	{
+		if (entry.OwnerKey == Owner)
+		{
+			entry.FirstPass = FirstPass;
+			entry.LastPass = LastPass;
+		}
+	}
+}
+
+void OTransientResourcePool::Compile()
+{
+	PROFILE_SCOPE();
+	std::erase_if(Entries, [](const SEntry& Entry) { return Entry.Owner.expired(); });
+	for (auto& entry : Entries)
+	{
+		entry.Info->Resource.Reset();
+	}
+	Heaps.clear();
+
+	vector<STransientRequest> requests;
+	requests.reserve(Entries.size());
+	for (const auto& entry : Entries)
+	{
+		const auto info = Device->GetResourceAllocationInfo(0, 1, &entry.Desc);
+		requests.push_back({ info.SizeInBytes, info.Alignment, GetHeapCategory(entry.Desc), entry.FirstPass, entry.LastPass });
+	}
+	Planner.Plan(requests);
+	const auto& placements = Planner.GetPlacements();
+
+	for (uint32_t heap = 0; heap < Planner.GetHeaps().size(); heap++)
+	{
+		uint64_t alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+		for (size_t idx = 0; idx < requests.size(); idx++)
+		{
+			if (placements[idx].Heap == heap)
+			{
+				alignment = std::max(alignment, requests[idx].Alignment);
+			}
+		}
+
+		const auto& planned = Planner.GetHeaps()[heap];
+		D3D12_HEAP_DESC desc = {};
+		desc.SizeInBytes = planned.Size;
+		desc.Properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+		desc.Alignment = alignment;
+		desc.Flags = planned.Category == Buffers    ? D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS
+		             : planned.Category == Textures ? D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES
+		                                            : D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+
+		ComPtr<ID3D12Heap> newHeap;
+		THROW_IF_FAILED(Device->CreateHeap(&desc, IID_PPV_ARGS(&newHeap)));
+		newHeap->SetName(L"TransientHeap");
+		Heaps.push_back(newHeap);
+	}
+
+	for (size_t idx = 0; idx < Entries.size(); idx++)
+	{
+		auto& entry = Entries[idx];
+		entry.bAliased = placements[idx].bAliased;
+		entry.Info->Name = entry.Owner.lock()->GetName() + L"_" + entry.Name;
+		THROW_IF_FAILED(Device->CreatePlacedResource(Heaps[placements[idx].Heap].Get(),
+		                                             placements[idx].Offset,
+		                                             &entry.Desc,
+		                                             entry.InitialState,
+		                                             entry.bHasClearValue ? &entry.ClearValue : nullptr,
+		                                             IID_PPV_ARGS(&entry.Info->Resource)));
+		entry.Info->Resource->SetName(entry.Info->Name.c_str());
+		entry.Info->CurrentState = entry.InitialState;
+	}
+
+	LOG(Render,
+	    Log,
+	    "Transient resources: {} in {} heaps, {} KB instead of {} KB committed, {} KB alive at peak",
+	    TEXT(Entries.size()),
+	    TEXT(Heaps.size()),
+	    TEXT(Planner.GetHeapBytes() / 1024),
+	    TEXT(Planner.GetCommittedBytes() / 1024),
+	    TEXT(Planner.GetPeakLiveBytes() / 1024));
+	OnCompiled.Broadcast();
+}
+
+void OTransientResourcePool::Activate(ID3D12GraphicsCommandList* CommandList, const IRenderObject* Owner) const
+{
+	// Several resources may have used the bytes before, a null resource before covers all of them
+	vector<D3D12_RESOURCE_BARRIER> barriers;
+	for (const auto& entry : Entries)
+	{
+		if (entry.OwnerKey == Owner && entry.bAliased && entry.Info->Resource)
+		{
+			barriers.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(nullptr, entry.Info->Resource.Get()));
+		}
+	}
+
+	if (!barriers.empty())
+	{
+		CommandList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+	}
+}
+
+uint32_t OTransientResourcePool::GetHeapCategory(const D3D12_RESOURCE_DESC& Desc)
+{
+	if (Desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+	{
+		return Buffers;
+	}
+	if (Desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+	{
+		return RenderTargets;
+	}
+	return Textures;
+}
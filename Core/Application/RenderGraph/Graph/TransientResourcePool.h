@@ -0,0 +1,58 @@
+#pragma once
+#include "Delegate.h"
+#include "DirectX/DXHelper.h"
+#include "DirectX/Resource.h"
+#include "TransientPlanner.h"
+#include "Types.h"
+
+#include <d3dx12.h>
+
+class IRenderObject;
+
+/**
+ * @brief Render targets that are only alive for part of a frame, placed in a few shared heaps.
+ * Owners declare their resources and get a resource info that is filled once the pool compiles. The render graph
+ * gives every owner the range of passes it is used in, resources of owners that got no range stay alive for the whole frame.
+ * Compiling recreates all placed resources, so it has to happen while the GPU is idle. Views are rebuilt in OnCompiled.
+ */
+class OTransientResourcePool
+{
+public:
+	OTransientResourcePool(ID3D12Device* Device, uint64_t MaxHeapSize);
+
+	/** @brief Declaring the same name again for an owner replaces its description and keeps the resource info */
+	TResourceInfo Declare(const weak_ptr<IRenderObject>& Owner, const wstring& Name, const D3D12_RESOURCE_DESC& Desc, D3D12_RESOURCE_STATES InitialState, const D3D12_CLEAR_VALUE* ClearValue = nullptr);
+	void SetLifetime(const IRenderObject* Owner, uint32_t FirstPass, uint32_t LastPass);
+	void Compile();
+
+	/** @brief Aliasing barriers for the resources of Owner before their first use in a frame, render and depth targets still have to be cleared or discarded */
+	void Activate(ID3D12GraphicsCommandList* CommandList, const IRenderObject* Owner) const;
+
+	uint64_t GetCommittedBytes() const { return Planner.GetCommittedBytes(); }
+	uint64_t GetHeapBytes() const { return Planner.GetHeapBytes(); }
+
+	SDelegate<void> OnCompiled;
+
+private:
+	struct SEntry
+	{
+		weak_ptr<IRenderObject> Owner;
+		const IRenderObject* OwnerKey = nullptr;
+		wstring Name;
+		D3D12_RESOURCE_DESC Desc = {};
+		D3D12_RESOURCE_STATES InitialState = D3D12_RESOURCE_STATE_COMMON;
+		D3D12_CLEAR_VALUE ClearValue = {};
+		bool bHasClearValue = false;
+		uint32_t FirstPass = 0;
+		uint32_t LastPass = UINT32_MAX;
+		bool bAliased = false;
+		TResourceInfo Info;
+	};
+
+	static uint32_t GetHeapCategory(const D3D12_RESOURCE_DESC& Desc);
+
+	ID3D12Device* Device = nullptr;
+	OTransientPlanner Planner;
+	vector<SEntry> Entries;
+	vector<ComPtr<ID3D12Heap>> Heaps;
+};
@@ -11,6 +11,12 @@ void OAABBVisNode::SetupCommonResources()
 	CommandQueue->SetResource(STRINGIFY_MACRO(CB_PASS), OEngine::Get()->CurrentFrameResource->PassCB->GetGPUAddress(), pso);
 }
 
+void OAABBVisNode::Update()
+{
+	ORenderNode::Update();
+	OEngine::Get()->bUploadInstanceBounds = GetNodeInfo().bEnable;
+}
+
 ORenderTargetBase* OAABBVisNode::Execute(ORenderTargetBase* RenderTarget)
 {
 	OEngine::Get()->DrawAABBOfRenderItems(FindPSOInfo(PSO));
@@ -5,5 +5,6 @@ class OAABBVisNode : public ORenderNode
 {
 public:
 	void SetupCommonResources() override;
+	void Update() override;
 	ORenderTargetBase* Execute(ORenderTargetBase* RenderTarget) override;
 };
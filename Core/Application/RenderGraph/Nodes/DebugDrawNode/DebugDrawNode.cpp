@@ -0,0 +1,20 @@
+#include "DebugDrawNode.h"
+
+#if ENABLE_DEBUG_DRAW
+#include "CommandQueue/CommandQueue.h"
+#include "Engine/Engine.h"
+
+void ODebugDrawNode::SetupCommonResources()
+{
+	auto pso = FindPSOInfo(PSO);
+	CommandQueue->SetPipelineState(pso);
+	CommandQueue->SetResource(STRINGIFY_MACRO(CB_PASS), OEngine::Get()->CurrentFrameResource->PassCB->GetGPUAddress(), pso);
+}
+
+ORenderTargetBase* ODebugDrawNode::Execute(ORenderTargetBase* RenderTarget)
+{
+	const auto engine = OEngine::Get();
+	ODebugDraw::Draw(CommandQueue->GetCommandList().Get(), engine->GetUploadManager(), engine->GetRecordPacket()->DebugVertices);
+	return RenderTarget;
+}
+#endif
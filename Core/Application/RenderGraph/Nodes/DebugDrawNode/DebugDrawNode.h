@@ -1,9 +1,12 @@
-
 #pragma once
+#include "Defines.h"
 #include "RenderGraph/Nodes/RenderNode.h"
-class ODebugGeometryNode : public ORenderNode
+
+#if ENABLE_DEBUG_DRAW
+class ODebugDrawNode : public ORenderNode
 {
 public:
 	void SetupCommonResources() override;
 	ORenderTargetBase* Execute(ORenderTargetBase* RenderTarget) override;
 };
+#endif
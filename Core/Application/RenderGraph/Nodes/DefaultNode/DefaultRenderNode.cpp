@@ -21,6 +21,9 @@ void ODefaultRenderNode::SetupCommonResources()
 	CommandQueue->SetResource(STRINGIFY_MACRO(DIRECTIONAL_LIGHTS), resource->DirectionalLightBuffer->GetGPUAddress(), pso);
 	CommandQueue->SetResource(STRINGIFY_MACRO(POINT_LIGHTS), resource->PointLightBuffer->GetGPUAddress(), pso);
 	CommandQueue->SetResource(STRINGIFY_MACRO(SPOT_LIGHTS), resource->SpotLightBuffer->GetGPUAddress(), pso);
+	const auto lighting = OEngine::Get()->GetClusteredLighting().lock();
+	CommandQueue->SetResource(STRINGIFY_MACRO(CLUSTER_LIGHT_GRID), lighting->GetGridAddress(resource), pso);
+	CommandQueue->SetResource(STRINGIFY_MACRO(CLUSTER_LIGHT_INDICES), lighting->GetIndicesAddress(resource), pso);
 	CommandQueue->SetResource(STRINGIFY_MACRO(SHADOW_MAPS), OEngine::Get()->GetRenderGroupStartAddress(ERenderGroup::ShadowTextures), pso);
 	CommandQueue->SetResource(STRINGIFY_MACRO(SSAO_MAP), OEngine::Get()->GetSSAORT().lock()->GetAmbientMap0SRV().GPUHandle, pso);
 }
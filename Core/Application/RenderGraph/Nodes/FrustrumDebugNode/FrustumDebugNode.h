@@ -1,9 +0,0 @@
-#pragma once
-#include "RenderGraph/Nodes/RenderNode.h"
-
-class OFrustumDebugNode : public ORenderNode
-{
-public:
-	ORenderTargetBase* Execute(ORenderTargetBase* RenderTarget) override;
-	void SetupCommonResources() override;
-};
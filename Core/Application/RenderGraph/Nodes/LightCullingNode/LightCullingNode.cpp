@@ -0,0 +1,25 @@
+#include "LightCullingNode.h"
+
+#include "Engine/Engine.h"
+#include "Profiler.h"
+#include "RenderGraph/Graph/QueueScheduler.h"
+
+ORenderTargetBase* OLightCullingNode::Execute(ORenderTargetBase* RenderTarget)
+{
+	PROFILE_SCOPE();
+	auto engine = OEngine::Get();
+	engine->GetClusteredLighting().lock()->Dispatch(CommandQueue, FindPSOInfo(PSO), engine->CurrentFrameResource);
+	return RenderTarget;
+}
+
+void OLightCullingNode::Update()
+{
+	ORenderNode::Update();
+	const auto lighting = OEngine::Get()->GetClusteredLighting().lock();
+	lighting->Mode = GetNodeInfo().bEnable ? EClusteredLightingMode::GPU : EClusteredLightingMode::CPU;
+}
+
+void OLightCullingNode::DeclareResources(SQueuePass& Pass) const
+{
+	Pass.Writes.push_back("ClusterLightGrid");
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include "RenderGraph/Nodes/RenderNode.h"
+
+// Builds the clustered light grid on the GPU, the lights are binned on the CPU while the node is disabled
+class OLightCullingNode : public ORenderNode
+{
+public:
+	ORenderTargetBase* Execute(ORenderTargetBase* RenderTarget) override;
+	void Update() override;
+	bool IsComputeEligible() const override { return true; }
+	void DeclareResources(SQueuePass& Pass) const override;
+};
@@ -4,6 +4,7 @@
 #include "CommandQueue/CommandQueue.h"
 #include "Engine/Engine.h"
 #include "Profiler.h"
+#include "RenderGraph/Graph/TransientResourcePool.h"
 #include "Window/Window.h"
 ORenderTargetBase* OPostProcessNode::Execute(ORenderTargetBase* RenderTarget)
 {
@@ -17,12 +18,23 @@ void OPostProcessNode::SetupCommonResources()
 	Window = OEngine::Get()->GetWindow();
 }
 
+uint32_t OPostProcessNode::SetupTransientLifetimes(OTransientResourcePool* Pool, uint32_t FirstPass)
+{
+	// Every filter is done with its targets before the next one starts, so they share memory
+	auto engine = OEngine::Get();
+	Pool->SetLifetime(engine->GetBlurFilter(), FirstPass, FirstPass);
+	Pool->SetLifetime(engine->GetBilateralBlurFilter(), FirstPass + 1, FirstPass + 1);
+	Pool->SetLifetime(engine->GetSobelFilter(), FirstPass + 2, FirstPass + 2);
+	return 3;
+}
+
 void OPostProcessNode::DrawSobel(ORenderTargetBase* RenderTarget)
 {
 	auto engine = OEngine::Get();
 	auto sobel = engine->GetSobelFilter();
 	if (sobel->IsEnabled())
 	{
+		engine->GetTransientResources()->Activate(CommandQueue->GetCommandList().Get(), sobel);
 		if (sobel->Execute(FindPSOInfo(SPSOTypes::SobelFilter), RenderTarget))
 		{
 			if (sobel->IsPureSobel())
@@ -40,6 +52,9 @@ void OPostProcessNode::DrawSobel(ORenderTargetBase* RenderTarget)
 void OPostProcessNode::DrawBlurFilter(ORenderTargetBase* RenderTarget)
 {
 	auto engine = OEngine::Get();
+	auto transients = engine->GetTransientResources();
+	auto commandList = CommandQueue->GetCommandList().Get();
+	transients->Activate(commandList, engine->GetBlurFilter());
 	if (engine->GetBlurFilter()->Execute(
 	        FindPSOInfo(SPSOTypes::HorizontalBlur),
 	        FindPSOInfo(SPSOTypes::VerticalBlur),
@@ -49,6 +64,7 @@ void OPostProcessNode::DrawBlurFilter(ORenderTargetBase* RenderTarget)
 	}
 
 	SetPSO(SPSOTypes::BilateralBlur);
+	transients->Activate(commandList, engine->GetBilateralBlurFilter());
 	if (engine->GetBilateralBlurFilter()->Execute(FindPSOInfo(SPSOTypes::BilateralBlur), RenderTarget->GetResource()))
 	{
 		engine->GetBilateralBlurFilter()->OutputTo(RenderTarget->GetResource());
@@ -8,6 +8,7 @@ class OPostProcessNode : public ORenderNode
 public:
 	virtual ORenderTargetBase* Execute(ORenderTargetBase* RenderTarget) override;
 	void SetupCommonResources() override;
+	uint32_t SetupTransientLifetimes(OTransientResourcePool* Pool, uint32_t FirstPass) override;
 
 private:
 	void DrawSobel(ORenderTargetBase* RenderTarget);
@@ -11,6 +11,7 @@ ORenderTargetBase* OPresentNode::Execute(ORenderTargetBase* RenderTarget)
 	PROFILE_SCOPE();
 	auto window = OEngine::Get()->GetWindow().lock();
 	CommandQueue->ResourceBarrier(window.get(), D3D12_RESOURCE_STATE_PRESENT);
+	OEngine::Get()->GetGpuProfiler()->Resolve(CommandQueue->GetCommandList().Get());
 	CommandQueue->ExecuteCommandList();
 	THROW_IF_FAILED(window->GetSwapChain()->Present(0, 0));
 	THROW_IF_FAILED(OEngine::Get()->GetDevice().lock()->GetDevice()->GetDeviceRemovedReason());
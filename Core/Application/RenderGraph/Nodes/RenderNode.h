@@ -5,9 +5,11 @@
 
 struct SFrameResource;
 struct SPSODescriptionBase;
+struct SQueuePass;
 class ORenderGraph;
 class ORenderTargetBase;
 class OCommandQueue;
+class OTransientResourcePool;
 
 class ORenderNode
 {
@@ -27,6 +29,15 @@ public:
 	void SetNodeEnabled(bool bEnable);
 	virtual void Update() {}
 
+	/** @brief Gives the transient resources the node uses a range of passes starting at FirstPass, returns the number of passes taken */
+	virtual uint32_t SetupTransientLifetimes(OTransientResourcePool* /*Pool*/, uint32_t /*FirstPass*/) { return 1; }
+
+	/** @brief Nodes that record only compute work may run on the compute queue */
+	virtual bool IsComputeEligible() const { return false; }
+
+	/** @brief Names of the GPU resources the node reads and writes, a node that declares none is ordered against every other node */
+	virtual void DeclareResources(SQueuePass& /*Pass*/) const {}
+
 protected:
 	OCommandQueue* CommandQueue = nullptr;
 	SPSOType PSO;
@@ -3,22 +3,41 @@
 #include "Engine/Engine.h"
 #include "EngineHelper.h"
 #include "Profiler.h"
+#include "RenderGraph/Graph/QueueScheduler.h"
 
 ORenderTargetBase* OShadowMapNode::Execute(ORenderTargetBase* RenderTarget)
 {
 	PROFILE_SCOPE();
 	auto pso = FindPSOInfo(PSO);
-	for (auto weak : OEngine::Get()->GetShadowMaps())
+
+	// The maps are bound through the views of the packet, the queue must not keep the previous target as bound
+	CommandQueue->UnsetRenderTarget();
+	for (const auto& draw : OEngine::Get()->GetRecordPacket()->ShadowMaps)
 	{
-		auto map = weak.lock();
-		if (map->ConsumeUpdate() && map->IsValid())
+		if (draw.bRenderStaticCache)
 		{
-			CommandQueue->SetRenderTarget(map.get());
-			CommandQueue->ResourceBarrier(map.get(), D3D12_RESOURCE_STATE_DEPTH_WRITE);
-			CommandQueue->SetResource("cbPass", map->GetPassConstantAddresss(), pso);
-			OEngine::Get()->DrawRenderItems(pso, SRenderLayers::Opaque, map->GetCulledInstancesInfo());
-			CommandQueue->ResourceBarrier(map.get(), D3D12_RESOURCE_STATE_GENERIC_READ);
+			CommandQueue->ResourceBarrier(draw.StaticCache.get(), D3D12_RESOURCE_STATE_DEPTH_WRITE);
+			CommandQueue->ClearDepthStencil(draw.StaticCacheDSV);
+			CommandQueue->SetRenderToDSVOnly(draw.StaticCacheDSV);
+			CommandQueue->SetResource("cbPass", draw.PassAddress, pso);
+			OEngine::Get()->DrawRenderItems(pso, SRenderLayers::Opaque, &draw.StaticInstances);
+			CommandQueue->ResourceBarrier(draw.StaticCache.get(), D3D12_RESOURCE_STATE_GENERIC_READ);
 		}
+
+		// Dynamic casters are composited on top of the cached static depth
+		if (draw.bUseStaticCache)
+		{
+			CommandQueue->CopyResourceTo(draw.Target.get(), draw.StaticCache.get());
+		}
+		CommandQueue->ResourceBarrier(draw.Target.get(), D3D12_RESOURCE_STATE_DEPTH_WRITE);
+		if (!draw.bUseStaticCache)
+		{
+			CommandQueue->ClearDepthStencil(draw.DSV);
+		}
+		CommandQueue->SetRenderToDSVOnly(draw.DSV);
+		CommandQueue->SetResource("cbPass", draw.PassAddress, pso);
+		OEngine::Get()->DrawRenderItems(pso, SRenderLayers::Opaque, &draw.Instances);
+		CommandQueue->ResourceBarrier(draw.Target.get(), D3D12_RESOURCE_STATE_GENERIC_READ);
 	}
 	OEngine::Get()->SetWindowViewport(); // TODO remove this to other place
 	CommandQueue->SetRenderTarget(RenderTarget);
@@ -34,3 +53,8 @@ void OShadowMapNode::SetupCommonResources()
 	CommandQueue->SetResource("cbPass", resource->PassCB->GetGPUAddress(), pso);
 	CommandQueue->SetResource("gMaterialData", resource->MaterialBuffer->GetGPUAddress(), pso);
 }
+
+void OShadowMapNode::DeclareResources(SQueuePass& Pass) const
+{
+	Pass.Writes.push_back("ShadowMaps");
+}
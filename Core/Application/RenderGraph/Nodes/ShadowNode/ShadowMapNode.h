@@ -5,5 +5,6 @@ class OShadowMapNode : public ODefaultRenderNode
 public:
 	ORenderTargetBase* Execute(ORenderTargetBase* RenderTarget) override;
 	void SetupCommonResources() override;
+	void DeclareResources(SQueuePass& Pass) const override;
 };
 
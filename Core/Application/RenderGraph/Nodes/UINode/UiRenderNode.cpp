@@ -2,11 +2,20 @@
 
 #include "Engine/Engine.h"
 
+void OUIRenderNode::Update()
+{
+	ORenderNode::Update();
+
+	// Widgets change the scene, they run between frames while neither pipeline stage does
+	if (GetNodeInfo().bEnable)
+	{
+		OEngine::Get()->GetUIManager().lock()->Draw();
+	}
+}
+
 ORenderTargetBase* OUIRenderNode::Execute(ORenderTargetBase* RenderTarget)
 {
-	auto manager = OEngine::Get()->GetUIManager().lock();
-	manager->Draw();
-	manager->PostRender(CommandQueue->GetCommandList().Get());
+	OEngine::Get()->GetUIManager().lock()->PostRender(CommandQueue->GetCommandList().Get());
 	return RenderTarget;
 }
 
@@ -5,5 +5,6 @@ class OUIRenderNode : public ORenderNode
 {
 public:
 	ORenderTargetBase* Execute(ORenderTargetBase* RenderTarget) override;
+	void Update() override;
 	void SetupCommonResources() override;
 };
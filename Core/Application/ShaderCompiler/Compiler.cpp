@@ -103,6 +103,7 @@ void OShaderCompiler::ResolveBoundResources(const ComPtr<ID3D12ShaderReflection>
 			ResolveTextures(bindDesc, OutPipelineInfo, ShaderType);
 			break;
 		case D3D_SIT_STRUCTURED:
+		case D3D_SIT_UAV_RWSTRUCTURED:
 			ResolveStructuredBuffer(bindDesc, OutPipelineInfo, ShaderType);
 			break;
 			// Handle other types as needed, for example, samplers
@@ -134,7 +135,7 @@ void OShaderCompiler::ResolveStructuredBuffer(const D3D12_SHADER_INPUT_BIND_DESC
 	CHECK(BindDesc.BindCount > 0);
 
 	D3D12_ROOT_PARAMETER1 rootParameter = {
-		.ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV,
+		.ParameterType = BindDesc.Type == D3D_SIT_UAV_RWSTRUCTURED ? D3D12_ROOT_PARAMETER_TYPE_UAV : D3D12_ROOT_PARAMETER_TYPE_SRV,
 		.Descriptor = {
 		    .ShaderRegister = BindDesc.BindPoint,
 		    .RegisterSpace = BindDesc.Space,
@@ -1,6 +1,7 @@
 
 #include "LightComponentWidget.h"
 
+#include "Engine/Engine.h"
 #include "Engine/RenderTarget/CSM/Csm.h"
 #include "LightComponent/LightComponent.h"
 
@@ -33,26 +34,54 @@ void OLightComponentWidget::Draw()
 				component->SetCascadeLambda(lambda);
 			}
 			ImGui::DragFloat3("Light Rotation Delta", &component->AnimationDelta.x, 0.1f, 1.f, 1.f);
-			ImGui::DragFloat("Radius Scale", &component->RadiusScale, 0.01f, 0.1f, 10.0f);
+			if (ImGui::DragFloat("Radius Scale", &component->RadiusScale, 0.01f, 0.1f, 10.0f))
+			{
+				component->InvalidateCascadeCache();
+			}
 			if (ImGui::Begin("Shadow Maps"))
 			{
-				for (const auto weak : component->GetCSM()->GetShadowMaps())
+				const auto& maps = component->GetCSM()->GetShadowMaps();
+				for (uint32_t cascadeIdx = 0; cascadeIdx < maps.size(); cascadeIdx++)
 				{
-					auto map = weak.lock();
+					auto map = maps[cascadeIdx].lock();
 					auto format = std::format("Shadow Map {}", map->GetShadowMapIndex());
 					auto enabledFormat = std::format("Enable Shadow Map {}", map->GetShadowMapIndex());
 					ImGui::SeparatorText(format.c_str());
-					ImGui::Checkbox(enabledFormat.c_str(), &map->bDrawShadowMap);
+					if (ImGui::Checkbox(enabledFormat.c_str(), &map->bDrawShadowMap))
+					{
+						component->MarkCascadesDirty();
+					}
+#if ENABLE_DEBUG_DRAW
 					auto boxName = std::format("Bounding Box for {}", map->GetShadowMapIndex());
 					ImGui::Checkbox(boxName.c_str(), &map->bDrawBoundingGeometry);
-					auto numRenderObjects = map->GetCulledInstancesInfo()->InstanceCount;
-					auto numTriangles = std::accumulate(map->GetCulledInstancesInfo()->Items.begin(),
-					                                    map->GetCulledInstancesInfo()->Items.end(),
-					                                    0,
-					                                    [](int32_t acc, auto pair) { return acc + pair.first.lock()->ChosenSubmesh.lock()->Vertices->size() / 3; });
+#endif
+					auto cacheName = std::format("Cache static casters for {}", map->GetShadowMapIndex());
+					bool useCache = map->UseStaticCache();
+					if (ImGui::Checkbox(cacheName.c_str(), &useCache))
+					{
+						map->SetUseStaticCache(useCache);
+						component->MarkCascadesDirty();
+					}
+
+					auto countTriangles = [](const SCulledInstancesInfo* Info) {
+						return std::accumulate(Info->Items.begin(),
+						                       Info->Items.end(),
+						                       0,
+						                       [](int32_t acc, auto pair) { return acc + pair.first.lock()->ChosenSubmesh.lock()->IndexCount / 3; });
+					};
 
-					ImGui::Text("Number of rendered meshes: %d", numRenderObjects);
-					ImGui::Text("Number of rendered triangles: %d", numTriangles);
+					if (map->UseStaticCache())
+					{
+						const auto& cascade = component->GetCascadeCache().GetCascade(cascadeIdx);
+						ImGui::Text("Static meshes: %d Dynamic meshes: %d", map->GetStaticInstancesInfo()->InstanceCount, map->GetDynamicInstancesInfo()->InstanceCount);
+						ImGui::Text("Static triangles: %d Dynamic triangles: %d", countTriangles(map->GetStaticInstancesInfo()), countTriangles(map->GetDynamicInstancesInfo()));
+						ImGui::Text("Cache rebuilds: %d Hits: %d Last invalidation: %s", cascade.NumRebuilds, cascade.NumHits, ToString(cascade.LastInvalidation));
+					}
+					else
+					{
+						ImGui::Text("Number of rendered meshes: %d", map->GetCulledInstancesInfo()->InstanceCount);
+						ImGui::Text("Number of rendered triangles: %d", countTriangles(map->GetCulledInstancesInfo()));
+					}
 					auto typeName = std::format("Bouding volume type: [{}]", WStringToUTF8(TEXT(map->GetBoundingGeometry()->GetType())));
 					ImGui::Text(typeName.c_str());
 					ImGui::Image(PtrCast(map->GetSRV().GPUHandle.ptr), ImVec2(250, 250));
@@ -85,6 +114,7 @@ void OLightComponentWidget::Draw()
 		if (dirty)
 		{
 			LightComponent->MarkDirty();
+			OEngine::Get()->GetSessionReplay()->RecordLight(*LightComponent);
 		}
 	}
 	else
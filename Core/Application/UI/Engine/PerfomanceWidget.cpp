@@ -2,19 +2,170 @@
 #include "PerfomanceWidget.h"
 
 #include "Engine/Engine.h"
+#include "FrameProfiler.h"
+
+#include <thread>
 void OPerfomanceWidget::Draw()
 {
 	if (ImGui::CollapsingHeader("Perfomance Info"))
 	{
 		ImGui::Text("FPS: %f", ImGui::GetIO().Framerate);
 		ImGui::Text("Number of rendered meshes: %d", OEngine::Get()->GetRenderedItems().Items.size());
-		size_t numTriangles = 0;
-		for (const auto& item : OEngine::Get()->GetRenderedItems().Items)
-		{
-			numTriangles += item.first.lock()->ChosenSubmesh.lock()->Vertices->size() / 3;
-		}
-		ImGui::Text("Number of rendered triangles: %d", numTriangles);
+		ImGui::Text("Number of rendered triangles: %llu", OEngine::Get()->GetRenderedItems().NumTriangles);
+		ImGui::Text("Number of triangles before LOD: %llu", OEngine::Get()->GetRenderedItems().NumTrianglesBeforeLOD);
 		ImGui::Checkbox("Enable Frustum Cooling", &OEngine::Get()->bFrustumCullingEnabled);
+		ImGui::Checkbox("Enable Occlusion Culling", &OEngine::Get()->bOcclusionCullingEnabled);
+		ImGui::Checkbox("Enable LOD", &OEngine::Get()->bLODEnabled);
 		ImGui::Checkbox("Enable Logs", &SLogUtils::bLogToConsole);
+
+		auto& pipeline = OEngine::Get()->GetFramePipeline();
+		bool bThreaded = pipeline.IsThreaded();
+		if (ImGui::Checkbox("Pipelined update and record", &bThreaded))
+		{
+			pipeline.SetThreaded(bThreaded);
+		}
+		const auto& pipelineStats = pipeline.GetStats();
+		ImGui::Text("Update: %.3f ms Record: %.3f ms Tick: %.3f ms", pipelineStats.UpdateMs, pipelineStats.RecordMs, pipelineStats.TickMs);
+
+		if (OEngine::Get()->bOcclusionCullingEnabled)
+		{
+			ImGui::SeparatorText("Occlusion Culling");
+			auto& culler = OEngine::Get()->GetOcclusionCuller();
+			const auto& stats = culler.GetStats();
+			ImGui::Text("Occluders: %d Triangles: %d Rasterized: %d", stats.NumOccluders, stats.NumOccluderTriangles, stats.NumRasterizedTriangles);
+			ImGui::Text("Tested: %d Occluded: %d", stats.NumTests, stats.NumOccluded);
+			ImGui::Text("Rasterization: %.3f ms", stats.RasterMilliseconds);
+
+			auto params = culler.GetParams();
+			int maxOccluders = params.MaxOccluders;
+			bool bChanged = ImGui::SliderFloat("Min occluder area", &params.MinOccluderArea, 0.0f, 0.5f);
+			bChanged |= ImGui::SliderInt("Max occluders", &maxOccluders, 1, 256);
+			if (bChanged)
+			{
+				params.MaxOccluders = maxOccluders;
+				culler.SetParams(params);
+			}
+		}
+
+		if (OEngine::Get()->bLODEnabled)
+		{
+			ImGui::SeparatorText("LOD");
+			ImGui::SliderFloat("Pixel error", &OEngine::Get()->LODPixelError, 0.1f, 16.0f);
+			ImGui::SliderFloat("Hysteresis", &OEngine::Get()->LODHysteresis, 0.0f, 0.9f);
+		}
+
+		if (const auto lighting = OEngine::Get()->GetClusteredLighting().lock())
+		{
+			ImGui::SeparatorText("Clustered Lighting");
+			auto& binner = lighting->GetBinner();
+			const auto& stats = binner.GetStats();
+			ImGui::Text("Mode: %s", lighting->Mode == EClusteredLightingMode::CPU ? "CPU" : "GPU");
+			ImGui::Text("Lights: %d Visible: %d", stats.NumLights, stats.NumVisibleLights);
+			ImGui::Text("Light indices: %d Max per cluster: %d Overflows: %d", stats.NumLightIndices, stats.MaxLightsInCluster, stats.NumOverflows);
+			ImGui::Text("Binning: %.3f ms on %d threads", stats.Milliseconds, stats.NumThreads);
+			int numThreads = binner.NumThreads;
+			if (ImGui::SliderInt("Binning threads (0 - all)", &numThreads, 0, std::thread::hardware_concurrency()))
+			{
+				binner.NumThreads = numThreads;
+			}
+		}
+
+		DrawReplay();
+		DrawProfiler();
+	}
+}
+
+void OPerfomanceWidget::DrawReplay()
+{
+	ImGui::SeparatorText("Capture and Replay");
+	auto replay = OEngine::Get()->GetSessionReplay();
+	ImGui::InputText("Replay log", ReplayPath, sizeof(ReplayPath));
+	ImGui::InputText("Replay timings", ReplayCsvPath, sizeof(ReplayCsvPath));
+	if (replay->IsReplaying())
+	{
+		ImGui::Text("Replaying frame %u of %u", replay->GetFrameIndex(), replay->GetNumFrames());
+		if (ImGui::Button("Stop replay"))
+		{
+			replay->StopReplay();
+		}
+		return;
+	}
+
+	if (replay->IsCapturing())
+	{
+		ImGui::Text("Captured frames: %u", replay->GetNumFrames());
+		if (ImGui::Button("Stop capture"))
+		{
+			replay->StopCapture();
+		}
+		return;
+	}
+
+	if (ImGui::Button("Start capture"))
+	{
+		replay->StartCapture(ReplayPath);
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Replay"))
+	{
+		SReplaySettings settings;
+		settings.CsvPath = ReplayCsvPath;
+		replay->StartReplay(ReplayPath, settings);
+	}
+}
+
+void OPerfomanceWidget::DrawProfiler()
+{
+	ImGui::SeparatorText("Profiler");
+	auto& profiler = OFrameProfiler::Get();
+	bool bEnabled = profiler.IsEnabled();
+	if (ImGui::Checkbox("Enable Profiler", &bEnabled))
+	{
+		profiler.SetEnabled(bEnabled);
+	}
+	if (!bEnabled)
+	{
+		return;
+	}
+
+	ImGui::Text("Frames: %llu Dropped events: %llu", profiler.GetNumFrames(), profiler.GetNumDroppedEvents());
+	ImGui::InputText("Trace file", TracePath, sizeof(TracePath));
+	ImGui::SameLine();
+	if (ImGui::Button("Export trace"))
+	{
+		if (!profiler.WriteChromeTrace(TracePath))
+		{
+			LOG(Engine, Error, "Failed to write the trace to {}", TEXT(TracePath));
+		}
+	}
+
+	constexpr auto flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingStretchProp;
+	if (ImGui::BeginTable("ProfilerStats", 6, flags, ImVec2(0.0f, 300.0f)))
+	{
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Scope");
+		ImGui::TableSetupColumn("Last ms");
+		ImGui::TableSetupColumn("Min ms");
+		ImGui::TableSetupColumn("Avg ms");
+		ImGui::TableSetupColumn("P99 ms");
+		ImGui::TableSetupColumn("Calls");
+		ImGui::TableHeadersRow();
+		for (const auto& stats : profiler.GetStats())
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::Text("%s%s", stats.bGpu ? "[GPU] " : "", stats.Name.c_str());
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", stats.LastMilliseconds);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", stats.MinMilliseconds);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", stats.AvgMilliseconds);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", stats.P99Milliseconds);
+			ImGui::TableNextColumn();
+			ImGui::Text("%u", stats.NumCalls);
+		}
+		ImGui::EndTable();
 	}
 }
\ No newline at end of file
@@ -3,4 +3,10 @@
 class OPerfomanceWidget : public IWidget
 {
 	void Draw() override;
+	void DrawProfiler();
+	void DrawReplay();
+
+	char TracePath[256] = "FrameTrace.json";
+	char ReplayPath[256] = "Session.dxrl";
+	char ReplayCsvPath[256] = "ReplayTimings.csv";
 };
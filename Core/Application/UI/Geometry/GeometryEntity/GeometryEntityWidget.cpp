@@ -13,6 +13,8 @@ void OGeometryEntityWidget::DrawSubmeshParameters()
 {
 	if (ImGui::CollapsingHeader("Submeshes"))
 	{
+		const auto& memory = GetGeometry()->Memory;
+		ImGui::Text("CPU: %.1f KB GPU: %.1f KB Released: %.1f KB", memory.CPUBytes / 1024.0, memory.GPUBytes / 1024.0, memory.ReleasedBytes / 1024.0);
 		if (ImGui::BeginListBox("##Submeshes"))
 		{
 			for (auto& Submesh : GetGeometry()->DrawArgs)
@@ -71,6 +73,10 @@ void OGeometryEntityWidget::DrawSubmeshParameters()
 					ImGui::EndListBox();
 				}
 			}
+			else
+			{
+				ImGui::Text("Vertices are only kept with full residency");
+			}
 		}
 	}
 }
@@ -105,7 +111,7 @@ void OGeometryEntityWidget::DrawInstanceParameters()
 			ImGui::EndListBox();
 			if (!SelectedInstance.empty())
 			{
-				MaterialPickerWidget->SetCurrentMaterial(FindMaterial(SelectedInstanceData->HlslData.MaterialIndex));
+				MaterialPickerWidget->SetCurrentMaterial(FindMaterial(SelectedInstanceData->Params.MaterialIndex));
 				OHierarchicalWidgetBase::Draw();
 			}
 		}
@@ -132,7 +138,7 @@ void OGeometryEntityWidget::Draw()
 	else
 	{
 		SelectedInstanceData = RenderItem.lock()->GetDefaultInstance();
-		MaterialPickerWidget->SetCurrentMaterial(FindMaterial(SelectedInstanceData->HlslData.MaterialIndex));
+		MaterialPickerWidget->SetCurrentMaterial(FindMaterial(SelectedInstanceData->Params.MaterialIndex));
 		OHierarchicalWidgetBase::Draw();
 	}
 }
@@ -143,40 +149,32 @@ void OGeometryEntityWidget::InitWidget()
 	using namespace DirectX;
 
 	// If the decompose fails, set the default values
-	Position = RenderItem.lock()->GetDefaultInstance()->HlslData.Position;
-	QuaternionToEulerAngles(RenderItem.lock()->GetDefaultInstance()->HlslData.Rotation, Rotation);
+	Position = RenderItem.lock()->GetDefaultInstance()->Params.Position;
+	QuaternionToEulerAngles(RenderItem.lock()->GetDefaultInstance()->Params.Rotation, Rotation);
 
-	Scale = RenderItem.lock()->GetDefaultInstance()->HlslData.Scale;
+	Scale = RenderItem.lock()->GetDefaultInstance()->Params.Scale;
 
 	TransformWidget = MakeWidget<OGeometryTransformWidget>(&Position, &Rotation, &Scale);
 	MaterialPickerWidget = MakeWidget<OMaterialPickerWidget>(Engine->GetMaterialManager());
 
 	TransformWidget->GetOnTransformUpdate().Add([this]() {
-		// Convert to XMVECTOR for operations
-		const XMVECTOR vPosition = XMLoadFloat3(&Position);
-		const XMVECTOR vRotation = XMLoadFloat3(&Rotation);
-		const XMVECTOR vScale = XMLoadFloat3(&Scale);
-
-		// Create individual transform matrices
-		const XMMATRIX matScale = XMMatrixScalingFromVector(vScale);
-		const XMMATRIX matRotation = XMMatrixRotationRollPitchYawFromVector(vRotation);
-		const XMMATRIX matTranslation = XMMatrixTranslationFromVector(vPosition);
-
-		// Combine into a single transform matrix
-		const XMMATRIX transformMatrix = matScale * matRotation * matTranslation;
-		XMStoreFloat4x4(&SelectedInstanceData->HlslData.World, transformMatrix);
-		SelectedInstanceData->HlslData.Position = Position;
-		SelectedInstanceData->HlslData.Rotation = { Rotation.x, Rotation.y, Rotation.z, 0 };
-		SelectedInstanceData->HlslData.Scale = Scale;
+		// The world matrix is rebuilt by the transform hierarchy together with everything attached to the instance
+		XMFLOAT4 rotation;
+		XMStoreFloat4(&rotation, XMQuaternionRotationRollPitchYawFromVector(XMLoadFloat3(&Rotation)));
+		Engine->SetInstanceTransform(*SelectedInstanceData, Position, rotation, Scale);
 		STransform transform;
 		transform.Position = Load(Position);
 		transform.Rotation = Load(Rotation);
 		transform.Scale = Load(Scale);
 		SelectedInstanceData->PositionChanged.Broadcast(transform);
+		if (!RenderItem.expired() && RenderItem.lock()->bStaticShadowCaster)
+		{
+			Engine->InvalidateStaticShadowCasters();
+		}
 	});
 
 	MaterialPickerWidget->GetOnMaterialUpdateDelegate().Add([this](const weak_ptr<SMaterial>& Material) {
-		SelectedInstanceData->HlslData.MaterialIndex = Material.lock()->MaterialCBIndex;
+		SelectedInstanceData->Params.MaterialIndex = Material.lock()->MaterialCBIndex;
 	});
 }
 
@@ -6,7 +6,7 @@
 class OGeometryTransformWidget : public IWidget
 {
 public:
-	DECLARE_DELEGATE(SGeometryUpdate, void);
+	DECLARE_DELEGATE(SGeometryUpdate);
 
 	OGeometryTransformWidget(DirectX::XMFLOAT3* OutPosition, DirectX::XMFLOAT3* OutRotation, DirectX::XMFLOAT3* OutScale)
 	{
@@ -97,7 +97,7 @@ void OGeometryManagerWidget::DrawComponentWidgets()
 					if (ImGui::Selectable(name.c_str()))
 					{
 						SelectedComponentName = comp->GetName();
-						SelectedComponent = comp.get();
+						SelectedComponent = comp;
 					}
 					it++;
 				}
@@ -46,6 +46,7 @@ void OMaterialManagerWidget::DrawProperty()
 		if (isMatChanged)
 		{
 			MaterialManager.lock()->OnMaterialChanged(CurrentMaterial->Name);
+			OEngine::Get()->GetSessionReplay()->RecordMaterial(*CurrentMaterial);
 		}
 		ImGui::SeparatorText("Diffuse Texture");
 		const auto& diffuse = CurrentMaterial->DiffuseMap;
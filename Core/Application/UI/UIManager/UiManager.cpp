@@ -45,6 +45,14 @@ void OUIManager::Draw()
 	ImGui_ImplDX12_NewFrame();
 	ImGui_ImplWin32_NewFrame();
 	ImGui::NewFrame();
+
+#if ENABLE_DEBUG_DRAW
+	const auto camera = OEngine::Get()->GetWindow().lock()->GetCamera().lock();
+	DirectX::XMFLOAT4X4 viewProjection;
+	DirectX::XMStoreFloat4x4(&viewProjection, camera->GetView() * camera->GetProj());
+	OEngine::Get()->GetDebugDraw()->DrawTextMarkers(ImGui::GetBackgroundDrawList(), viewProjection, IO->DisplaySize.x, IO->DisplaySize.y);
+#endif
+
 	ImGui::SetNextWindowPos(ImVec2(0, 0));
 	ImGui::SetNextWindowSize(ImVec2(MangerWidth, MangerHeight));
 	ImGui::Begin("Main Menu");
@@ -188,7 +188,8 @@ void OWindow::Update(const UpdateEventArgs& Event)
 {
 	Camera->UpdateViewMatrix();
 
-	if (Event.IsUIInfocus)
+	// Replays move the camera to the captured one between frames
+	if (Event.IsUIInfocus || !OEngine::Get()->GetSessionReplay()->AcceptsLiveInput())
 	{
 		return;
 	}
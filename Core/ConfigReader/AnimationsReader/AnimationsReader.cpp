@@ -3,6 +3,16 @@
 
 #include "Animations/Animations.h"
 #include "MathUtils.h"
+
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+constexpr uint32_t TracksMagic = 0x4d494e41; // ANIM
+constexpr uint32_t TracksVersion = 1;
+} // namespace
+
 OAnimationsReader::~OAnimationsReader()
 {
 }
@@ -10,33 +20,22 @@ vector<shared_ptr<OAnimation>> OAnimationsReader::ReadAnimations()
 {
 	ReloadConfig();
 	vector<shared_ptr<OAnimation>> result;
-	for (const auto& val : PTree.get_child("Animations") | std::views::values)
+	vector<SAnimationConfig> configs;
+	ReadRoot("Animations", configs);
+	for (const auto& config : configs)
 	{
-		auto name = GetAttribute(val, "Name");
 		vector<SAnimationFrame> frames;
-		for (const auto& frame : val.get_child("Frames") | std::views::values)
+		for (const auto& frame : config.Frames)
 		{
 			SAnimationFrame animFrame;
-			STransform transform;
-
-			DirectX::XMFLOAT3 position;
-			GetFloat3(frame, "Position", position);
-			transform.Position = Load(position);
-
-			DirectX::XMFLOAT3 rotation;
-			GetFloat3(frame, "Rotation", rotation);
-			transform.Rotation = Load(rotation);
-
-			DirectX::XMFLOAT3 scale;
-			GetFloat3(frame, "Scale", scale);
-			transform.Scale = Load(scale);
-
-			animFrame.Transform = transform;
-			animFrame.Duration = frame.get<float>("Duration");
+			animFrame.Transform.Position = Load(frame.Position);
+			animFrame.Transform.Rotation = Load(frame.Rotation);
+			animFrame.Transform.Scale = Load(frame.Scale);
+			animFrame.Duration = frame.Duration;
 			frames.push_back(animFrame);
 		}
 		auto animation = make_shared<OAnimation>();
-		animation->SetName(UTF8ToWString(name));
+		animation->SetName(UTF8ToWString(config.Name));
 		animation->SetFrames(frames);
 		result.push_back(animation);
 	}
@@ -45,38 +44,80 @@ vector<shared_ptr<OAnimation>> OAnimationsReader::ReadAnimations()
 
 void OAnimationsReader::SaveAnimations(const vector<shared_ptr<OAnimation>>& Animations)
 {
-	PTree.clear();
-	PTree.put("Animations", "");
-	auto animations = PTree.get_child("Animations");
+	vector<SAnimationConfig> configs;
 	for (const auto& anim : Animations)
 	{
-		boost::property_tree::ptree animTree;
-		animTree.put("Name", WStringToUTF8(anim->GetName()));
-		boost::property_tree::ptree frames;
+		auto& config = configs.emplace_back();
+		config.Name = WStringToUTF8(anim->GetName());
 		for (const auto& frame : anim->GetFrames())
 		{
-			boost::property_tree::ptree frameTree;
-			frameTree.put("Duration", frame.Duration);
-			auto pos = frame.Transform.GetFloat3Position();
-			frameTree.put("Position.X", pos.x);
-			frameTree.put("Position.Y", pos.y);
-			frameTree.put("Position.Z", pos.z);
+			auto& frameConfig = config.Frames.emplace_back();
+			frameConfig.Duration = frame.Duration;
+			frameConfig.Position = frame.Transform.GetFloat3Position();
+			frameConfig.Rotation = frame.Transform.GetFloat3Rotation();
+			frameConfig.Scale = frame.Transform.GetFloat3Scale();
+		}
+	}
+
+	OJsonWriter writer;
+	writer.BeginObject();
+	writer.Key("Animations");
+	WriteJson(writer, configs);
+	writer.EndObject();
+	SaveConfig(writer);
+}
 
-			auto rot = frame.Transform.GetFloat3Rotation();
-			frameTree.put("Rotation.X", rot.x);
-			frameTree.put("Rotation.Y", rot.y);
-			frameTree.put("Rotation.Z", rot.z);
+vector<SAnimationTrack> OAnimationsReader::ReadTracks() const
+{
+	vector<SAnimationTrack> result;
+	std::ifstream file(GetTracksPath(), std::ios::binary);
+	if (!file)
+	{
+		return result;
+	}
 
-			auto scale = frame.Transform.GetFloat3Scale();
-			frameTree.put("Scale.X", scale.x);
-			frameTree.put("Scale.Y", scale.y);
-			frameTree.put("Scale.Z", scale.z);
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	uint32_t count = 0;
+	file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+	file.read(reinterpret_cast<char*>(&version), sizeof(version));
+	file.read(reinterpret_cast<char*>(&count), sizeof(count));
+	if (!file || magic != TracksMagic || version != TracksVersion)
+	{
+		LOG(Animation, Warning, "Animation tracks {} have an unknown format", TEXT(GetTracksPath()));
+		return result;
+	}
 
-			frames.push_back(std::make_pair("", frameTree));
+	result.resize(count);
+	for (auto& track : result)
+	{
+		if (!track.Read(file))
+		{
+			LOG(Animation, Error, "Animation tracks {} are damaged", TEXT(GetTracksPath()));
+			return {};
 		}
-		animTree.add_child("Frames", frames);
-		animations.push_back(std::make_pair("", animTree));
 	}
-	PTree.put_child("Animations", animations);
-	write_json(FileName, PTree);
+	return result;
+}
+
+void OAnimationsReader::SaveTracks(const vector<SAnimationTrack>& Tracks) const
+{
+	std::ofstream file(GetTracksPath(), std::ios::binary | std::ios::trunc);
+	const auto count = static_cast<uint32_t>(Tracks.size());
+	file.write(reinterpret_cast<const char*>(&TracksMagic), sizeof(TracksMagic));
+	file.write(reinterpret_cast<const char*>(&TracksVersion), sizeof(TracksVersion));
+	file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+	for (const auto& track : Tracks)
+	{
+		track.Write(file);
+	}
+	if (!file)
+	{
+		LOG(Animation, Error, "Failed to write animation tracks {}", TEXT(GetTracksPath()));
+	}
+}
+
+string OAnimationsReader::GetTracksPath() const
+{
+	return std::filesystem::path(FileName).replace_extension(".anim").string();
 }
\ No newline at end of file
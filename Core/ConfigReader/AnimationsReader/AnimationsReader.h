@@ -2,7 +2,38 @@
 #include "ConfigReader.h"
 #include "Transform.h"
 
+struct SAnimationFrameConfig
+{
+	float Duration = 0.0f;
+	DirectX::XMFLOAT3 Position = { 0.0f, 0.0f, 0.0f };
+	DirectX::XMFLOAT3 Rotation = { 0.0f, 0.0f, 0.0f };
+	DirectX::XMFLOAT3 Scale = { 1.0f, 1.0f, 1.0f };
+};
+
+template<>
+struct TJsonSchema<SAnimationFrameConfig>
+{
+	static constexpr auto Fields = std::make_tuple(JsonField("Duration", &SAnimationFrameConfig::Duration),
+	                                               JsonOptional("Position", &SAnimationFrameConfig::Position),
+	                                               JsonOptional("Rotation", &SAnimationFrameConfig::Rotation),
+	                                               JsonOptional("Scale", &SAnimationFrameConfig::Scale));
+};
+
+struct SAnimationConfig
+{
+	string Name;
+	vector<SAnimationFrameConfig> Frames;
+};
+
+template<>
+struct TJsonSchema<SAnimationConfig>
+{
+	static constexpr auto Fields = std::make_tuple(JsonField("Name", &SAnimationConfig::Name),
+	                                               JsonField("Frames", &SAnimationConfig::Frames));
+};
+
 class OAnimation;
+struct SAnimationTrack;
 class OAnimationsReader : OConfigReader
 {
 public:
@@ -11,4 +42,11 @@ public:
 	~OAnimationsReader();
 	vector<shared_ptr<OAnimation>> ReadAnimations();
 	void SaveAnimations(const vector<shared_ptr<OAnimation>>& Animations);
+
+	/** @brief Binary tracks next to the JSON config, same name with the .anim extension. Empty if the file is missing or damaged */
+	vector<SAnimationTrack> ReadTracks() const;
+	void SaveTracks(const vector<SAnimationTrack>& Tracks) const;
+
+private:
+	string GetTracksPath() const;
 };
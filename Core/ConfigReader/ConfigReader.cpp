@@ -3,3 +3,58 @@
 //
 
 #include "ConfigReader.h"
+
+#include <filesystem>
+
+namespace
+{
+string GetCompiledPath(const string& FileName)
+{
+	return std::filesystem::path(FileName).replace_extension(".cjson").string();
+}
+} // namespace
+
+void OConfigReader::LoadConfig(const string& FileName)
+{
+	if (bIsLoaded)
+	{
+		return;
+	}
+
+	PROFILE_SCOPE();
+	const auto stamp = OJsonDocument::GetFileStamp(FileName);
+	const auto compiledPath = GetCompiledPath(FileName);
+	if (stamp == 0 || !Document.LoadCompiled(compiledPath, stamp))
+	{
+		if (!Document.ParseFile(FileName))
+		{
+			LOG(Config, Error, "Failed to parse {}: {}", TEXT(FileName), TEXT(Document.GetError()));
+		}
+		else if (!Document.SaveCompiled(compiledPath, stamp))
+		{
+			LOG(Config, Warning, "Failed to write the compiled config {}", TEXT(compiledPath));
+		}
+	}
+	CWIN_LOG(Document.IsEmpty(), Default, Error, "Config file is empty!")
+	bIsLoaded = true;
+}
+
+void OConfigReader::ReloadConfig()
+{
+	Document.Clear();
+	bIsLoaded = false;
+	LoadConfig(FileName);
+}
+
+void OConfigReader::SaveConfig(const OJsonWriter& Writer)
+{
+	// Release the mapping first and drop the compiled file, the reload compiles the new text
+	Document.Clear();
+	std::error_code error;
+	std::filesystem::remove(GetCompiledPath(FileName), error);
+	if (!Writer.SaveToFile(FileName))
+	{
+		LOG(Config, Error, "Failed to write {}", TEXT(FileName));
+	}
+	ReloadConfig();
+}
@@ -1,7 +1,14 @@
 #pragma once
+#include "Json/JsonSchema.h"
 #include "Logger.h"
-#include "boost/property_tree/json_parser.hpp"
-#include "boost/property_tree/ptree.hpp"
+
+template<>
+struct TJsonSchema<DirectX::XMFLOAT3>
+{
+	static constexpr auto Fields = std::make_tuple(JsonField("X", &DirectX::XMFLOAT3::x),
+	                                               JsonField("Y", &DirectX::XMFLOAT3::y),
+	                                               JsonField("Z", &DirectX::XMFLOAT3::z));
+};
 
 class OConfigReader
 {
@@ -12,110 +19,84 @@ public:
 		LoadConfig(FileName);
 	}
 
-	void LoadConfig(const string& FileName)
+	/** @brief Maps the compiled config next to the file when it is up to date, otherwise parses the file and compiles it */
+	void LoadConfig(const string& FileName);
+	void ReloadConfig();
+
+	static string GetAttribute(const OJsonValue& Node, const string& Key)
 	{
-		if (!bIsLoaded)
+		string result;
+		if (!Node.Find(Key).TryGet(result))
 		{
-			read_json(FileName, PTree);
-			CWIN_LOG(PTree.size() == 0, Default, Error, "Config file is empty!")
-			bIsLoaded = true;
+			LOG(Config, Error, "Key not found: {}", TEXT(Key));
 		}
+		return result;
 	}
 
-	void ReloadConfig()
-	{
-		PTree.clear();
-		bIsLoaded = false;
-		LoadConfig(FileName);
-	}
-
-	static auto GetAttribute(const boost::property_tree::ptree& Tree, const string& Value)
+	static bool GetFloat3(const OJsonValue& Node, const string& Key, DirectX::XMFLOAT3& Out)
 	{
-		return Tree.get<string>(Value);
-	}
-
-	static bool GetFloat3(const boost::property_tree::ptree& Tree, const string& Value, DirectX::XMFLOAT3& Out)
-	{
-		auto vec = Tree.get_child_optional(Value);
-		if (vec.has_value())
-		{
-			Out.x = vec->get<float>("X");
-			Out.y = vec->get<float>("Y");
-			Out.z = vec->get<float>("Z");
-			return true;
-		}
-		return false;
+		const auto vec = Node.Find(Key);
+		return vec && ReadJson(vec, Out);
 	}
 
 	template<typename T>
 	T GetRoot(const std::string& Key) const
 	{
 		CWIN_LOG(!bIsLoaded, Default, Error, "Config file not loaded!");
-		if (PTree.get_child_optional(Key) == boost::none)
+		T result{};
+		if (!Document.GetRoot().Find(Key).TryGet(result))
 		{
 			LOG(Debug, Error, "Key not found: {}", TEXT(Key));
 		}
-		return PTree.get<T>(Key);
+		return result;
 	}
 
-	auto GetRootChild(const std::string& Key) const
+	OJsonValue GetRootChild(const std::string& Key) const
 	{
 		CWIN_LOG(!bIsLoaded, Default, Error, "Config file not loaded!");
-		if (PTree.get_child_optional(Key) == boost::none)
-		{
-			LOG(Debug, Error, "Key not found: {}", TEXT(Key));
-		}
-
-		return PTree.get_child(Key);
+		return GetChild(Key, Document.GetRoot());
 	}
 
-	auto GetChild(const std::string& Key, const boost::property_tree::ptree& Tree) const
+	OJsonValue GetChild(const std::string& Key, const OJsonValue& Node) const
 	{
-		CWIN_LOG(!bIsLoaded, Default, Error, "Config file not loaded!");
-		if (Tree.get_child_optional(Key) == boost::none)
+		const auto child = Node.Find(Key);
+		if (!child)
 		{
 			LOG(Debug, Error, "Key not found: {}", TEXT(Key));
 		}
-
-		return Tree.get_child(Key);
+		return child;
 	}
 
+	/** @brief Binds a root value to a schema struct, the first field that does not match is logged */
 	template<typename T>
-	static T GetOptionalOr(const boost::property_tree::ptree& Tree, const std::string& Key, const T& Default)
+	bool ReadRoot(const std::string& Key, T& Out) const
 	{
-		if (auto Optional = Tree.get_optional<T>(Key))
+		string error;
+		if (!ReadJson(Document.GetRoot().Find(Key), Out, &error))
 		{
-			return Optional.get();
+			FailJsonRead(&error, Key);
+			LOG(Config, Error, "{} {}", TEXT(FileName), TEXT(error));
+			return false;
 		}
-		return Default;
+		return true;
 	}
 
 	template<typename T>
-	static T GetOptionalOr(const boost::optional<const boost::property_tree::ptree&>& Tree, const std::string& Key, const T& Default)
+	static T GetOptionalOr(const OJsonValue& Node, const std::string& Key, const T& Default)
 	{
-		if (Tree)
-		{
-			return GetOptionalOr<T>(Tree.get(), Key, Default);
-		}
-		return Default;
+		return Node.GetOr(Key, Default);
 	}
 
-	static string GetOptionalOr(const boost::property_tree::ptree& Tree, const std::string& Key, const char* Default)
+	static string GetOptionalOr(const OJsonValue& Node, const std::string& Key, const char* Default)
 	{
-		return GetOptionalOr<string>(Tree, Key, Default);
-	}
-
-	static string GetOptionalOr(const boost::optional<const boost::property_tree::ptree&>& Tree, const std::string& Key, const char* Default)
-	{
-		if (Tree)
-		{
-			return GetOptionalOr<string>(Tree.get(), Key, Default);
-		}
-		return Default;
+		return Node.GetOr(Key, Default);
 	}
 
 protected:
+	/** @brief Replaces the config file with the written document and loads it back */
+	void SaveConfig(const OJsonWriter& Writer);
+
 	string FileName;
-	boost::property_tree::ptree PTree;
+	OJsonDocument Document;
 	bool bIsLoaded = false;
 };
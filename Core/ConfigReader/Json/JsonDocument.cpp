@@ -0,0 +1,768 @@
+#include "JsonDocument.h"
+
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+constexpr uint32_t CompiledMagic = 0x4e4f534a; // 'JSON'
+constexpr uint32_t CompiledVersion = 1;
+constexpr uint32_t MaxDepth = 256;
+
+struct SCompiledHeader
+{
+	uint32_t Magic = CompiledMagic;
+	uint32_t Version = CompiledVersion;
+	uint64_t Stamp = 0;
+	uint32_t NumNodes = 0;
+	uint32_t TextSize = 0;
+};
+static_assert(sizeof(SCompiledHeader) % alignof(SJsonNode) == 0, "Nodes have to stay aligned after the header");
+
+bool IsWhitespace(char Char)
+{
+	return Char == ' ' || Char == '\n' || Char == '\r' || Char == '\t';
+}
+
+int HexDigit(char Char)
+{
+	if (Char >= '0' && Char <= '9')
+	{
+		return Char - '0';
+	}
+	if (Char >= 'a' && Char <= 'f')
+	{
+		return Char - 'a' + 10;
+	}
+	if (Char >= 'A' && Char <= 'F')
+	{
+		return Char - 'A' + 10;
+	}
+	return -1;
+}
+
+// Whole text has to be the number, hexadecimal integers are written as 0x...
+template<typename T>
+bool ParseNumber(std::string_view Text, T& Out)
+{
+	int base = 10;
+	if constexpr (std::is_integral_v<T>)
+	{
+		if (Text.size() > 2 && Text[0] == '0' && (Text[1] == 'x' || Text[1] == 'X'))
+		{
+			Text.remove_prefix(2);
+			base = 16;
+		}
+	}
+	if (Text.empty())
+	{
+		return false;
+	}
+
+	const char* last = Text.data() + Text.size();
+	std::from_chars_result result;
+	if constexpr (std::is_integral_v<T>)
+	{
+		result = std::from_chars(Text.data(), last, Out, base);
+	}
+	else
+	{
+		result = std::from_chars(Text.data(), last, Out);
+	}
+	return result.ec == std::errc() && result.ptr == last;
+}
+} // namespace
+
+class OJsonParser
+{
+public:
+	explicit OJsonParser(OJsonDocument& InDocument)
+	    : Document(InDocument), Data(InDocument.Buffer.data()), Size(InDocument.Buffer.size())
+	{
+	}
+
+	bool Run()
+	{
+		// Skip the UTF-8 byte order mark
+		if (Size >= 3 && std::memcmp(Data, "\xEF\xBB\xBF", 3) == 0)
+		{
+			Position = 3;
+		}
+
+		SkipWhitespace();
+		if (ParseValue(SJsonNode::None, 0) == SJsonNode::None)
+		{
+			return false;
+		}
+		SkipWhitespace();
+		return Position == Size || Fail("Unexpected data after the root value");
+	}
+
+private:
+	bool Fail(const char* Message)
+	{
+		size_t line = 1;
+		for (size_t index = 0; index < Position && index < Size; index++)
+		{
+			line += Data[index] == '\n';
+		}
+		Document.Error = std::string(Message) + " at line " + std::to_string(line);
+		return false;
+	}
+
+	void SkipWhitespace()
+	{
+		while (Position < Size && IsWhitespace(Data[Position]))
+		{
+			Position++;
+		}
+	}
+
+	char Peek() const { return Position < Size ? Data[Position] : '\0'; }
+
+	uint32_t AddNode(EJsonType Type, uint32_t Key, uint32_t KeyLength)
+	{
+		SJsonNode node;
+		node.Type = Type;
+		node.Key = Key;
+		node.KeyLength = KeyLength;
+		Document.Nodes.push_back(node);
+		return static_cast<uint32_t>(Document.Nodes.size() - 1);
+	}
+
+	uint32_t ParseValue(uint32_t Key, uint32_t KeyLength)
+	{
+		switch (Peek())
+		{
+		case '{':
+			return ParseContainer(EJsonType::Object, '}', Key, KeyLength);
+		case '[':
+			return ParseContainer(EJsonType::Array, ']', Key, KeyLength);
+		case '"':
+		{
+			uint32_t offset = 0;
+			uint32_t length = 0;
+			if (!ParseString(offset, length))
+			{
+				return SJsonNode::None;
+			}
+			const uint32_t node = AddNode(EJsonType::String, Key, KeyLength);
+			Document.Nodes[node].Text = offset;
+			Document.Nodes[node].Length = length;
+			return node;
+		}
+		case 't':
+			return ParseLiteral("true", EJsonType::Bool, Key, KeyLength);
+		case 'f':
+			return ParseLiteral("false", EJsonType::Bool, Key, KeyLength);
+		case 'n':
+			return ParseLiteral("null", EJsonType::Null, Key, KeyLength);
+		default:
+			return ParseNumberValue(Key, KeyLength);
+		}
+	}
+
+	uint32_t ParseContainer(EJsonType Type, char Close, uint32_t Key, uint32_t KeyLength)
+	{
+		if (++Depth > MaxDepth)
+		{
+			Fail("Nesting is too deep");
+			return SJsonNode::None;
+		}
+
+		const uint32_t node = AddNode(Type, Key, KeyLength);
+		Position++;
+		SkipWhitespace();
+
+		uint32_t previous = SJsonNode::None;
+		uint32_t count = 0;
+		if (Peek() == Close)
+		{
+			Position++;
+		}
+		else
+		{
+			while (true)
+			{
+				uint32_t childKey = SJsonNode::None;
+				uint32_t childKeyLength = 0;
+				if (Type == EJsonType::Object)
+				{
+					if (Peek() != '"')
+					{
+						Fail("Expected a key");
+						return SJsonNode::None;
+					}
+					if (!ParseString(childKey, childKeyLength))
+					{
+						return SJsonNode::None;
+					}
+					SkipWhitespace();
+					if (Peek() != ':')
+					{
+						Fail("Expected ':'");
+						return SJsonNode::None;
+					}
+					Position++;
+					SkipWhitespace();
+				}
+
+				const uint32_t child = ParseValue(childKey, childKeyLength);
+				if (child == SJsonNode::None)
+				{
+					return SJsonNode::None;
+				}
+
+				// Indices, the node table grows while the children are parsed
+				if (previous == SJsonNode::None)
+				{
+					Document.Nodes[node].Text = child;
+				}
+				else
+				{
+					Document.Nodes[previous].Next = child;
+				}
+				previous = child;
+				count++;
+
+				SkipWhitespace();
+				if (Peek() == ',')
+				{
+					Position++;
+					SkipWhitespace();
+				}
+				else if (Peek() == Close)
+				{
+					Position++;
+					break;
+				}
+				else
+				{
+					Fail(Type == EJsonType::Object ? "Expected ',' or '}'" : "Expected ',' or ']'");
+					return SJsonNode::None;
+				}
+			}
+		}
+
+		Document.Nodes[node].Length = count;
+		Depth--;
+		return node;
+	}
+
+	// Unescapes into the buffer itself, the result is never longer than the escaped text
+	bool ParseString(uint32_t& Offset, uint32_t& Length)
+	{
+		const size_t start = ++Position;
+		size_t write = start;
+		while (true)
+		{
+			if (Position >= Size)
+			{
+				return Fail("Unterminated string");
+			}
+
+			const char current = Data[Position];
+			if (current == '"')
+			{
+				break;
+			}
+			if (static_cast<unsigned char>(current) < 0x20)
+			{
+				return Fail("Control character in a string");
+			}
+			if (current != '\\')
+			{
+				Data[write++] = current;
+				Position++;
+				continue;
+			}
+
+			if (Position + 1 >= Size)
+			{
+				return Fail("Unterminated string");
+			}
+			const char escaped = Data[Position + 1];
+			Position += 2;
+			switch (escaped)
+			{
+			case '"':
+			case '\\':
+			case '/':
+				Data[write++] = escaped;
+				break;
+			case 'b':
+				Data[write++] = '\b';
+				break;
+			case 'f':
+				Data[write++] = '\f';
+				break;
+			case 'n':
+				Data[write++] = '\n';
+				break;
+			case 'r':
+				Data[write++] = '\r';
+				break;
+			case 't':
+				Data[write++] = '\t';
+				break;
+			case 'u':
+			{
+				uint32_t code = 0;
+				if (!ParseCodeUnit(code))
+				{
+					return false;
+				}
+				if (code >= 0xD800 && code <= 0xDBFF)
+				{
+					uint32_t low = 0;
+					if (Position + 1 >= Size || Data[Position] != '\\' || Data[Position + 1] != 'u')
+					{
+						return Fail("Unpaired surrogate");
+					}
+					Position += 2;
+					if (!ParseCodeUnit(low))
+					{
+						return false;
+					}
+					if (low < 0xDC00 || low > 0xDFFF)
+					{
+						return Fail("Unpaired surrogate");
+					}
+					code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+				}
+				else if (code >= 0xDC00 && code <= 0xDFFF)
+				{
+					return Fail("Unpaired surrogate");
+				}
+				write = WriteUtf8(code, write);
+				break;
+			}
+			default:
+				return Fail("Unknown escape sequence");
+			}
+		}
+
+		Offset = static_cast<uint32_t>(start);
+		Length = static_cast<uint32_t>(write - start);
+		Position++;
+		return true;
+	}
+
+	bool ParseCodeUnit(uint32_t& Out)
+	{
+		if (Position + 4 > Size)
+		{
+			return Fail("Truncated \\u escape");
+		}
+		Out = 0;
+		for (int digit = 0; digit < 4; digit++)
+		{
+			const int value = HexDigit(Data[Position++]);
+			if (value < 0)
+			{
+				return Fail("Invalid \\u escape");
+			}
+			Out = (Out << 4) | static_cast<uint32_t>(value);
+		}
+		return true;
+	}
+
+	size_t WriteUtf8(uint32_t Code, size_t Write)
+	{
+		if (Code < 0x80)
+		{
+			Data[Write++] = static_cast<char>(Code);
+		}
+		else if (Code < 0x800)
+		{
+			Data[Write++] = static_cast<char>(0xC0 | (Code >> 6));
+			Data[Write++] = static_cast<char>(0x80 | (Code & 0x3F));
+		}
+		else if (Code < 0x10000)
+		{
+			Data[Write++] = static_cast<char>(0xE0 | (Code >> 12));
+			Data[Write++] = static_cast<char>(0x80 | ((Code >> 6) & 0x3F));
+			Data[Write++] = static_cast<char>(0x80 | (Code & 0x3F));
+		}
+		else
+		{
+			Data[Write++] = static_cast<char>(0xF0 | (Code >> 18));
+			Data[Write++] = static_cast<char>(0x80 | ((Code >> 12) & 0x3F));
+			Data[Write++] = static_cast<char>(0x80 | ((Code >> 6) & 0x3F));
+			Data[Write++] = static_cast<char>(0x80 | (Code & 0x3F));
+		}
+		return Write;
+	}
+
+	uint32_t ParseLiteral(std::string_view Literal, EJsonType Type, uint32_t Key, uint32_t KeyLength)
+	{
+		if (Size - Position < Literal.size() || std::string_view(Data + Position, Literal.size()) != Literal)
+		{
+			Fail("Unexpected character");
+			return SJsonNode::None;
+		}
+
+		const uint32_t node = AddNode(Type, Key, KeyLength);
+		Document.Nodes[node].Text = static_cast<uint32_t>(Position);
+		Document.Nodes[node].Length = static_cast<uint32_t>(Literal.size());
+		Position += Literal.size();
+		return node;
+	}
+
+	uint32_t ParseNumberValue(uint32_t Key, uint32_t KeyLength)
+	{
+		const size_t start = Position;
+		while (Position < Size)
+		{
+			const char current = Data[Position];
+			if ((current < '0' || current > '9') && current != '-' && current != '+' && current != '.' && current != 'e' && current != 'E')
+			{
+				break;
+			}
+			Position++;
+		}
+
+		double number = 0.0;
+		const std::string_view text(Data + start, Position - start);
+		if (text.empty() || text[0] == '+' || !ParseNumber(text, number))
+		{
+			Position = start;
+			Fail("Unexpected character");
+			return SJsonNode::None;
+		}
+
+		const uint32_t node = AddNode(EJsonType::Number, Key, KeyLength);
+		Document.Nodes[node].Text = static_cast<uint32_t>(start);
+		Document.Nodes[node].Length = static_cast<uint32_t>(text.size());
+		Document.Nodes[node].Number = number;
+		return node;
+	}
+
+	OJsonDocument& Document;
+	char* Data = nullptr;
+	size_t Size = 0;
+	size_t Position = 0;
+	uint32_t Depth = 0;
+};
+
+OJsonValue::OIterator& OJsonValue::OIterator::operator++()
+{
+	Node = Document->GetNodes()[Node].Next;
+	return *this;
+}
+
+const SJsonNode* OJsonValue::GetNode() const
+{
+	return IsValid() ? Document->GetNodes() + Node : nullptr;
+}
+
+EJsonType OJsonValue::GetType() const
+{
+	const auto node = GetNode();
+	return node ? node->Type : EJsonType::Null;
+}
+
+std::string_view OJsonValue::GetKey() const
+{
+	const auto node = GetNode();
+	if (!node || node->Key == SJsonNode::None)
+	{
+		return {};
+	}
+	return { Document->GetText() + node->Key, node->KeyLength };
+}
+
+std::string_view OJsonValue::GetText() const
+{
+	const auto node = GetNode();
+	if (!node || node->Type == EJsonType::Array || node->Type == EJsonType::Object || node->Text == SJsonNode::None)
+	{
+		return {};
+	}
+	return { Document->GetText() + node->Text, node->Length };
+}
+
+OJsonValue OJsonValue::Find(std::string_view Path) const
+{
+	OJsonValue current = *this;
+	while (current.IsObject())
+	{
+		const size_t dot = Path.find('.');
+		const std::string_view key = Path.substr(0, dot);
+
+		OJsonValue found;
+		for (const auto child : current)
+		{
+			if (child.GetKey() == key)
+			{
+				found = child;
+				break;
+			}
+		}
+		if (dot == std::string_view::npos || !found)
+		{
+			return found;
+		}
+		current = found;
+		Path.remove_prefix(dot + 1);
+	}
+	return {};
+}
+
+uint32_t OJsonValue::GetSize() const
+{
+	const auto type = GetType();
+	return type == EJsonType::Array || type == EJsonType::Object ? GetNode()->Length : 0;
+}
+
+OJsonValue::OIterator OJsonValue::begin() const
+{
+	const auto type = GetType();
+	if (type != EJsonType::Array && type != EJsonType::Object)
+	{
+		return end();
+	}
+	return { Document, GetNode()->Text };
+}
+
+OJsonValue::OIterator OJsonValue::end() const
+{
+	return { Document, SJsonNode::None };
+}
+
+bool OJsonValue::TryGet(bool& Out) const
+{
+	const auto type = GetType();
+	if (type != EJsonType::Bool && type != EJsonType::String && type != EJsonType::Number)
+	{
+		return false;
+	}
+
+	const auto text = GetText();
+	if (text == "true" || text == "1")
+	{
+		Out = true;
+		return true;
+	}
+	if (text == "false" || text == "0")
+	{
+		Out = false;
+		return true;
+	}
+	return false;
+}
+
+bool OJsonValue::TryGet(double& Out) const
+{
+	const auto type = GetType();
+	if (type == EJsonType::Number)
+	{
+		Out = GetNode()->Number;
+		return true;
+	}
+	return type == EJsonType::String && ParseNumber(GetText(), Out);
+}
+
+bool OJsonValue::TryGet(float& Out) const
+{
+	double value = 0.0;
+	if (!TryGet(value))
+	{
+		return false;
+	}
+	Out = static_cast<float>(value);
+	return true;
+}
+
+bool OJsonValue::TryGet(int64_t& Out) const
+{
+	const auto type = GetType();
+	return (type == EJsonType::Number || type == EJsonType::String) && ParseNumber(GetText(), Out);
+}
+
+bool OJsonValue::TryGet(uint64_t& Out) const
+{
+	const auto type = GetType();
+	return (type == EJsonType::Number || type == EJsonType::String) && ParseNumber(GetText(), Out);
+}
+
+bool OJsonValue::TryGet(std::string& Out) const
+{
+	const auto type = GetType();
+	if (!IsValid() || type == EJsonType::Array || type == EJsonType::Object)
+	{
+		return false;
+	}
+	Out.assign(GetText());
+	return true;
+}
+
+bool OJsonDocument::Parse(std::string Text)
+{
+	Clear();
+	if (Text.size() >= SJsonNode::None)
+	{
+		Error = "Document is too large";
+		return false;
+	}
+
+	Buffer = std::move(Text);
+
+	// Configs average a value every 16 bytes or so, one reserve covers most of them
+	Nodes.reserve(Buffer.size() / 16 + 16);
+
+	OJsonParser parser(*this);
+	if (!parser.Run())
+	{
+		const auto error = std::move(Error);
+		Clear();
+		Error = error;
+		return false;
+	}
+
+	TextSize = static_cast<uint32_t>(Buffer.size());
+	NumNodes = static_cast<uint32_t>(Nodes.size());
+	return true;
+}
+
+bool OJsonDocument::ParseFile(const std::string& Path)
+{
+	std::ifstream file(Path, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		Clear();
+		Error = "Could not open " + Path;
+		return false;
+	}
+
+	std::string text(static_cast<size_t>(file.tellg()), '\0');
+	file.seekg(0);
+	if (!file.read(text.data(), static_cast<std::streamsize>(text.size())))
+	{
+		Clear();
+		Error = "Could not read " + Path;
+		return false;
+	}
+	return Parse(std::move(text));
+}
+
+bool OJsonDocument::SaveCompiled(const std::string& Path, uint64_t Stamp) const
+{
+	if (IsEmpty())
+	{
+		return false;
+	}
+
+	SCompiledHeader header;
+	header.Stamp = Stamp;
+	header.NumNodes = NumNodes;
+	header.TextSize = TextSize;
+
+	std::ofstream file(Path, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(GetNodes()), static_cast<std::streamsize>(NumNodes * sizeof(SJsonNode)));
+	file.write(GetText(), TextSize);
+	return static_cast<bool>(file);
+}
+
+bool OJsonDocument::LoadCompiled(const std::string& Path, uint64_t Stamp)
+{
+	Clear();
+	OMappedFile mapping;
+	if (!mapping.Open(Path) || mapping.GetSize() < sizeof(SCompiledHeader))
+	{
+		return false;
+	}
+
+	SCompiledHeader header;
+	std::memcpy(&header, mapping.GetData(), sizeof(header));
+	if (header.Magic != CompiledMagic || header.Version != CompiledVersion || header.Stamp != Stamp || header.NumNodes == 0
+	    || mapping.GetSize() != sizeof(header) + static_cast<uint64_t>(header.NumNodes) * sizeof(SJsonNode) + header.TextSize)
+	{
+		return false;
+	}
+
+	// Every reference has to stay inside the file and children and siblings always come later, so walking it terminates
+	const auto nodes = reinterpret_cast<const SJsonNode*>(mapping.GetData() + sizeof(header));
+	const auto inText = [&header](uint32_t Offset, uint32_t Length) {
+		return Offset == SJsonNode::None ? Length == 0 : static_cast<uint64_t>(Offset) + Length <= header.TextSize;
+	};
+	const auto isLater = [&header](uint32_t Node, uint32_t Index) {
+		return Node == SJsonNode::None || (Node > Index && Node < header.NumNodes);
+	};
+	for (uint32_t index = 0; index < header.NumNodes; index++)
+	{
+		const auto& node = nodes[index];
+		const bool bContainer = node.Type == EJsonType::Array || node.Type == EJsonType::Object;
+		if (node.Type > EJsonType::Object || !inText(node.Key, node.KeyLength) || !isLater(node.Next, index)
+		    || (bContainer ? !isLater(node.Text, index) : !inText(node.Text, node.Length)))
+		{
+			return false;
+		}
+	}
+
+	Mapping = std::move(mapping);
+	NumNodes = header.NumNodes;
+	TextSize = header.TextSize;
+	return true;
+}
+
+uint64_t OJsonDocument::GetFileStamp(const std::string& Path)
+{
+	std::error_code error;
+	const auto size = std::filesystem::file_size(Path, error);
+	if (error)
+	{
+		return 0;
+	}
+	const auto time = std::filesystem::last_write_time(Path, error);
+	if (error)
+	{
+		return 0;
+	}
+	return static_cast<uint64_t>(time.time_since_epoch().count()) * 0x9E3779B97F4A7C15ull ^ size;
+}
+
+void OJsonDocument::Clear()
+{
+	Buffer.clear();
+	Nodes.clear();
+	Mapping.Close();
+	TextSize = 0;
+	NumNodes = 0;
+	Error.clear();
+}
+
+OJsonValue OJsonDocument::GetRoot() const
+{
+	return { this, IsEmpty() ? SJsonNode::None : 0 };
+}
+
+SJsonStats OJsonDocument::GetStats() const
+{
+	SJsonStats stats;
+	stats.NumNodes = NumNodes;
+	stats.BufferSize = TextSize;
+	stats.bCompiled = Mapping.IsOpen();
+	return stats;
+}
+
+const char* OJsonDocument::GetText() const
+{
+	if (Mapping.IsOpen())
+	{
+		return reinterpret_cast<const char*>(Mapping.GetData() + sizeof(SCompiledHeader) + NumNodes * sizeof(SJsonNode));
+	}
+	return Buffer.data();
+}
+
+const SJsonNode* OJsonDocument::GetNodes() const
+{
+	if (Mapping.IsOpen())
+	{
+		return reinterpret_cast<const SJsonNode*>(Mapping.GetData() + sizeof(SCompiledHeader));
+	}
+	return Nodes.data();
+}
@@ -0,0 +1,187 @@
+#pragma once
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/*
+ * JSON parsed in place: strings are unescaped inside the source buffer and every value becomes one fixed size node
+ * that refers to the buffer by offset. A document is two allocations however large the file is.
+ * The node table and the buffer are also the compiled form, a compiled config is memory mapped and used as is.
+ * Values convert on access the way boost::property_tree did, a number reads as its text and "1" reads as a number.
+ * No D3D dependencies.
+ */
+
+enum class EJsonType : uint8_t
+{
+	Null,
+	Bool,
+	Number,
+	String,
+	Array,
+	Object
+};
+
+struct SJsonNode
+{
+	static constexpr uint32_t None = UINT32_MAX;
+
+	EJsonType Type = EJsonType::Null;
+	uint8_t Padding[3] = {};
+
+	// Offset and size of the key in the buffer, None outside of objects
+	uint32_t Key = None;
+	uint32_t KeyLength = 0;
+
+	// Text of scalars, the first child and the child count of arrays and objects
+	uint32_t Text = None;
+	uint32_t Length = 0;
+
+	// Next node of the same parent
+	uint32_t Next = None;
+	double Number = 0.0;
+};
+
+class OJsonDocument;
+class OJsonValue
+{
+public:
+	class OIterator
+	{
+	public:
+		OIterator(const OJsonDocument* InDocument, uint32_t InNode)
+		    : Document(InDocument), Node(InNode) {}
+
+		OJsonValue operator*() const { return OJsonValue(Document, Node); }
+		OIterator& operator++();
+		bool operator!=(const OIterator& Other) const { return Node != Other.Node; }
+
+	private:
+		const OJsonDocument* Document = nullptr;
+		uint32_t Node = SJsonNode::None;
+	};
+
+	OJsonValue() = default;
+	OJsonValue(const OJsonDocument* InDocument, uint32_t InNode)
+	    : Document(InDocument), Node(InNode) {}
+
+	bool IsValid() const { return Document != nullptr && Node != SJsonNode::None; }
+	explicit operator bool() const { return IsValid(); }
+	EJsonType GetType() const;
+	bool IsObject() const { return GetType() == EJsonType::Object; }
+	bool IsArray() const { return GetType() == EJsonType::Array; }
+
+	std::string_view GetKey() const;
+
+	/** @brief Text of scalars as written in the file, empty for arrays and objects */
+	std::string_view GetText() const;
+
+	/** @brief Child by key, dots separate nested keys. Invalid if missing */
+	OJsonValue Find(std::string_view Path) const;
+	OJsonValue operator[](std::string_view Path) const { return Find(Path); }
+
+	/** @brief Number of children of arrays and objects */
+	uint32_t GetSize() const;
+
+	OIterator begin() const;
+	OIterator end() const;
+
+	bool TryGet(bool& Out) const;
+	bool TryGet(double& Out) const;
+	bool TryGet(float& Out) const;
+	bool TryGet(int64_t& Out) const;
+	bool TryGet(uint64_t& Out) const;
+	bool TryGet(std::string& Out) const;
+
+	template<typename T>
+	bool TryGet(T& Out) const
+	{
+		static_assert(std::is_integral_v<T>, "Unsupported JSON value type");
+		if constexpr (std::is_signed_v<T>)
+		{
+			int64_t value = 0;
+			return TryGet(value) && (Out = static_cast<T>(value), true);
+		}
+		else
+		{
+			uint64_t value = 0;
+			return TryGet(value) && (Out = static_cast<T>(value), true);
+		}
+	}
+
+	/** @brief Value of the child, Default if it is missing or does not convert */
+	template<typename T>
+	T GetOr(std::string_view Path, const T& Default) const
+	{
+		T value;
+		const auto child = Find(Path);
+		return child && child.TryGet(value) ? value : Default;
+	}
+
+	std::string GetOr(std::string_view Path, const char* Default) const
+	{
+		return GetOr<std::string>(Path, Default);
+	}
+
+private:
+	const SJsonNode* GetNode() const;
+
+	const OJsonDocument* Document = nullptr;
+	uint32_t Node = SJsonNode::None;
+};
+
+struct SJsonStats
+{
+	uint32_t NumNodes = 0;
+	uint32_t BufferSize = 0;
+	bool bCompiled = false;
+};
+
+class OJsonDocument
+{
+public:
+	OJsonDocument() = default;
+	OJsonDocument(const OJsonDocument&) = delete;
+	OJsonDocument& operator=(const OJsonDocument&) = delete;
+	OJsonDocument(OJsonDocument&&) noexcept = default;
+	OJsonDocument& operator=(OJsonDocument&&) noexcept = default;
+
+	/** @brief Takes the text and parses it in place, the document is empty on failure */
+	bool Parse(std::string Text);
+	bool ParseFile(const std::string& Path);
+
+	/** @brief Compiled form of the document, Stamp identifies the source it was parsed from */
+	bool SaveCompiled(const std::string& Path, uint64_t Stamp) const;
+
+	/** @brief Maps a compiled document, fails if it is damaged or was compiled from another Stamp */
+	bool LoadCompiled(const std::string& Path, uint64_t Stamp);
+
+	/** @brief Size and modification time of a file, 0 if it does not exist */
+	static uint64_t GetFileStamp(const std::string& Path);
+
+	void Clear();
+	bool IsEmpty() const { return NumNodes == 0; }
+	OJsonValue GetRoot() const;
+	const std::string& GetError() const { return Error; }
+	SJsonStats GetStats() const;
+
+private:
+	friend class OJsonValue;
+	friend class OJsonParser;
+
+	const char* GetText() const;
+	const SJsonNode* GetNodes() const;
+
+	// Owned storage of a parsed document
+	std::string Buffer;
+	std::vector<SJsonNode> Nodes;
+
+	// Storage of a compiled document, the nodes and the text follow the header
+	OMappedFile Mapping;
+	uint32_t TextSize = 0;
+	uint32_t NumNodes = 0;
+	std::string Error;
+};
@@ -0,0 +1,169 @@
+#pragma once
+#include "JsonDocument.h"
+#include "JsonWriter.h"
+
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Typed binding between JSON and config structs. A struct is described once by specializing TJsonSchema:
+ *
+ *	template<>
+ *	struct TJsonSchema<STextureEntry>
+ *	{
+ *		static constexpr auto Fields = std::make_tuple(JsonField("Name", &STextureEntry::Name),
+ *		                                               JsonOptional("Type", &STextureEntry::Type));
+ *	};
+ *
+ * and ReadJson/WriteJson handle it along with numbers, bools, strings and vectors of any of them.
+ * Optional fields keep their value when the key is missing, required fields fail the read.
+ */
+
+template<typename T>
+struct TJsonSchema
+{
+};
+
+template<typename TStruct, typename TMember>
+struct TJsonField
+{
+	std::string_view Name;
+	TMember TStruct::*Member;
+	bool bOptional;
+};
+
+template<typename TStruct, typename TMember>
+constexpr TJsonField<TStruct, TMember> JsonField(std::string_view Name, TMember TStruct::*Member)
+{
+	return { Name, Member, false };
+}
+
+template<typename TStruct, typename TMember>
+constexpr TJsonField<TStruct, TMember> JsonOptional(std::string_view Name, TMember TStruct::*Member)
+{
+	return { Name, Member, true };
+}
+
+template<typename T, typename = void>
+struct THasJsonSchema : std::false_type
+{
+};
+
+template<typename T>
+struct THasJsonSchema<T, std::void_t<decltype(TJsonSchema<T>::Fields)>> : std::true_type
+{
+};
+
+template<typename T>
+struct TIsJsonVector : std::false_type
+{
+};
+
+template<typename T>
+struct TIsJsonVector<std::vector<T>> : std::true_type
+{
+};
+
+// Errors read as "Textures[3].Name: missing", the innermost failure writes ": message" and every level adds its part of the path
+inline bool FailJsonRead(std::string* Error, std::string_view Prefix, std::string_view Message = {})
+{
+	if (Error)
+	{
+		if (!Message.empty())
+		{
+			*Error = std::string(Prefix) + ": " + std::string(Message);
+		}
+		else
+		{
+			const bool bJoined = !Error->empty() && (Error->front() == '[' || Error->front() == ':');
+			*Error = std::string(Prefix) + (bJoined ? "" : ".") + *Error;
+		}
+	}
+	return false;
+}
+
+/** @brief Fills Out from Value, Error receives the path of the first field that failed */
+template<typename T>
+bool ReadJson(const OJsonValue& Value, T& Out, std::string* Error = nullptr)
+{
+	if constexpr (TIsJsonVector<T>::value)
+	{
+		if (!Value.IsArray())
+		{
+			return FailJsonRead(Error, "", "not an array");
+		}
+
+		Out.clear();
+		Out.resize(Value.GetSize());
+		size_t index = 0;
+		for (const auto item : Value)
+		{
+			if (!ReadJson(item, Out[index], Error))
+			{
+				return FailJsonRead(Error, "[" + std::to_string(index) + "]");
+			}
+			index++;
+		}
+		return true;
+	}
+	else if constexpr (THasJsonSchema<T>::value)
+	{
+		if (!Value.IsObject())
+		{
+			return FailJsonRead(Error, "", "not an object");
+		}
+
+		return std::apply(
+		    [&](const auto&... Fields) {
+			    const auto readField = [&](const auto& Field) {
+				    const auto child = Value.Find(Field.Name);
+				    if (!child)
+				    {
+					    return Field.bOptional || FailJsonRead(Error, Field.Name, "missing");
+				    }
+				    if (!ReadJson(child, Out.*Field.Member, Error))
+				    {
+					    return FailJsonRead(Error, Field.Name);
+				    }
+				    return true;
+			    };
+			    return (readField(Fields) && ...);
+		    },
+		    TJsonSchema<T>::Fields);
+	}
+	else
+	{
+		return Value.TryGet(Out) || FailJsonRead(Error, "", "unexpected value");
+	}
+}
+
+template<typename T>
+void WriteJson(OJsonWriter& Writer, const T& In)
+{
+	if constexpr (TIsJsonVector<T>::value)
+	{
+		Writer.BeginArray();
+		for (const auto& item : In)
+		{
+			WriteJson(Writer, item);
+		}
+		Writer.EndArray();
+	}
+	else if constexpr (THasJsonSchema<T>::value)
+	{
+		Writer.BeginObject();
+		std::apply(
+		    [&](const auto&... Fields) {
+			    ((Writer.Key(Fields.Name), WriteJson(Writer, In.*Fields.Member)), ...);
+		    },
+		    TJsonSchema<T>::Fields);
+		Writer.EndObject();
+	}
+	else
+	{
+		Writer.Value(In);
+	}
+}
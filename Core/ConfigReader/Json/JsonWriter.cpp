@@ -0,0 +1,181 @@
+#include "JsonWriter.h"
+
+#include <charconv>
+#include <fstream>
+
+namespace
+{
+constexpr size_t IndentSize = 4;
+}
+
+void OJsonWriter::BeginObject()
+{
+	BeginValue();
+	Output += '{';
+	Levels.emplace_back();
+}
+
+void OJsonWriter::EndObject()
+{
+	const bool bEmpty = Levels.back().bEmpty;
+	Levels.pop_back();
+	if (!bEmpty)
+	{
+		NewLine();
+	}
+	Output += '}';
+}
+
+void OJsonWriter::BeginArray()
+{
+	BeginValue();
+	Output += '[';
+	Levels.emplace_back();
+}
+
+void OJsonWriter::EndArray()
+{
+	const bool bEmpty = Levels.back().bEmpty;
+	Levels.pop_back();
+	if (!bEmpty)
+	{
+		NewLine();
+	}
+	Output += ']';
+}
+
+void OJsonWriter::Key(std::string_view Name)
+{
+	BeginValue();
+	WriteEscaped(Name);
+	Output += ": ";
+	bAfterKey = true;
+}
+
+bool OJsonWriter::SaveToFile(const std::string& Path) const
+{
+	std::ofstream file(Path, std::ios::binary | std::ios::trunc);
+	file.write(Output.data(), static_cast<std::streamsize>(Output.size()));
+	file.put('\n');
+	return static_cast<bool>(file);
+}
+
+void OJsonWriter::Clear()
+{
+	Output.clear();
+	Levels.clear();
+	bAfterKey = false;
+}
+
+// Separator and indentation before a key or a value that does not follow a key
+void OJsonWriter::BeginValue()
+{
+	if (bAfterKey)
+	{
+		bAfterKey = false;
+		return;
+	}
+	if (Levels.empty())
+	{
+		return;
+	}
+
+	if (!Levels.back().bEmpty)
+	{
+		Output += ',';
+	}
+	Levels.back().bEmpty = false;
+	NewLine();
+}
+
+void OJsonWriter::NewLine()
+{
+	Output += '\n';
+	Output.append(Levels.size() * IndentSize, ' ');
+}
+
+void OJsonWriter::WriteRaw(std::string_view Text)
+{
+	BeginValue();
+	Output += Text;
+}
+
+void OJsonWriter::WriteString(std::string_view Text)
+{
+	BeginValue();
+	WriteEscaped(Text);
+}
+
+void OJsonWriter::WriteEscaped(std::string_view Text)
+{
+	Output += '"';
+	for (const char character : Text)
+	{
+		switch (character)
+		{
+		case '"':
+			Output += "\\\"";
+			break;
+		case '\\':
+			Output += "\\\\";
+			break;
+		case '\n':
+			Output += "\\n";
+			break;
+		case '\r':
+			Output += "\\r";
+			break;
+		case '\t':
+			Output += "\\t";
+			break;
+		case '\b':
+			Output += "\\b";
+			break;
+		case '\f':
+			Output += "\\f";
+			break;
+		default:
+			if (static_cast<unsigned char>(character) < 0x20)
+			{
+				constexpr char digits[] = "0123456789abcdef";
+				Output += "\\u00";
+				Output += digits[character >> 4];
+				Output += digits[character & 0xF];
+			}
+			else
+			{
+				Output += character;
+			}
+		}
+	}
+	Output += '"';
+}
+
+void OJsonWriter::WriteFloat(double In)
+{
+	char buffer[32];
+	const auto result = std::to_chars(buffer, buffer + sizeof(buffer), In);
+	WriteRaw(std::string_view(buffer, result.ptr - buffer));
+}
+
+// Shortest text that reads back as the same float, 0.1f is written as 0.1
+void OJsonWriter::WriteFloat(float In)
+{
+	char buffer[32];
+	const auto result = std::to_chars(buffer, buffer + sizeof(buffer), In);
+	WriteRaw(std::string_view(buffer, result.ptr - buffer));
+}
+
+void OJsonWriter::WriteInteger(int64_t In)
+{
+	char buffer[24];
+	const auto result = std::to_chars(buffer, buffer + sizeof(buffer), In);
+	WriteRaw(std::string_view(buffer, result.ptr - buffer));
+}
+
+void OJsonWriter::WriteInteger(uint64_t In)
+{
+	char buffer[24];
+	const auto result = std::to_chars(buffer, buffer + sizeof(buffer), In);
+	WriteRaw(std::string_view(buffer, result.ptr - buffer));
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Streaming JSON writer, the whole document is built in one string and written with a single call.
+ * Output is indented the way boost::property_tree::write_json did it. No D3D dependencies.
+ */
+class OJsonWriter
+{
+public:
+	void BeginObject();
+	void EndObject();
+	void BeginArray();
+	void EndArray();
+
+	/** @brief Key of the next value, only inside objects */
+	void Key(std::string_view Name);
+
+	template<typename T>
+	void Value(const T& In)
+	{
+		if constexpr (std::is_same_v<T, bool>)
+		{
+			WriteRaw(In ? "true" : "false");
+		}
+		else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+		{
+			WriteString(In);
+		}
+		else if constexpr (std::is_floating_point_v<T>)
+		{
+			WriteFloat(In);
+		}
+		else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+		{
+			WriteInteger(static_cast<int64_t>(In));
+		}
+		else
+		{
+			static_assert(std::is_integral_v<T>, "Unsupported JSON value type");
+			WriteInteger(static_cast<uint64_t>(In));
+		}
+	}
+
+	void Null() { WriteRaw("null"); }
+
+	const std::string& GetString() const { return Output; }
+	bool SaveToFile(const std::string& Path) const;
+	void Clear();
+
+private:
+	struct SLevel
+	{
+		bool bEmpty = true;
+	};
+
+	void BeginValue();
+	void NewLine();
+	void WriteRaw(std::string_view Text);
+	void WriteString(std::string_view Text);
+	void WriteEscaped(std::string_view Text);
+	void WriteFloat(double In);
+	void WriteFloat(float In);
+	void WriteInteger(int64_t In);
+	void WriteInteger(uint64_t In);
+
+	std::string Output;
+	std::vector<SLevel> Levels;
+	bool bAfterKey = false;
+};
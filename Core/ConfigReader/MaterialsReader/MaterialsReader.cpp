@@ -1,93 +1,86 @@
 #include "MaterialsReader.h"
 
-vector<STexturePath> OMaterialsConfigParser::GetTexturePaths(const boost::property_tree::ptree& Node, const string& Key)
+#include <algorithm>
+
+STexturePath OMaterialsConfigParser::GetTexturePath(const vector<string>& Paths)
 {
-	vector<STexturePath> paths;
-	for (const auto& val : Node.get_child(Key) | std::views::values)
+	STexturePath path;
+	if (!Paths.empty())
 	{
-		STexturePath path;
-		path.Path = UTF8ToWString(val.data());
-		paths.push_back(path);
+		path.Path = UTF8ToWString(Paths.front());
 	}
-	return paths;
+	return path;
 }
 
 std::unordered_map<string, shared_ptr<SMaterial>> OMaterialsConfigParser::LoadMaterials()
 {
 	std::unordered_map<string, shared_ptr<SMaterial>> Materials;
 	LoadConfig(FileName);
-	for (const auto& val : PTree.get_child("Materials") | std::views::values)
+
+	vector<SMaterialConfig> configs;
+	ReadRoot("Materials", configs);
+	for (const auto& config : configs)
 	{
 		auto material = make_shared<SMaterial>();
-		material->Name = val.get<string>("Name");
-		auto& data = val.get_child("Data");
-
-		auto diffuse = GetTexturePaths(data, "DiffuseMapPaths");
-		auto normal = GetTexturePaths(data, "NormalMapPaths");
-		auto height = GetTexturePaths(data, "HeightMapPaths");
+		material->Name = config.Name;
+		material->DiffuseMap = GetTexturePath(config.Data.DiffuseMapPaths);
+		material->NormalMap = GetTexturePath(config.Data.NormalMapPaths);
+		material->HeightMap = GetTexturePath(config.Data.HeightMapPaths);
 
-		material->DiffuseMap = !diffuse.empty() ? diffuse.at(0) : STexturePath();
-		material->NormalMap = !normal.empty() ? normal.at(0) : STexturePath();
-		material->HeightMap = !height.empty() ? height.at(0) : STexturePath();
+		material->MaterialData.DiffuseAlbedo.x = config.Data.Diffuse.X;
+		material->MaterialData.DiffuseAlbedo.y = config.Data.Diffuse.Y;
+		material->MaterialData.DiffuseAlbedo.z = config.Data.Diffuse.Z;
 
-		auto& diffChild = data.get_child("Diffuse");
-		material->MaterialData.DiffuseAlbedo.x = diffChild.get<float>("x");
-		material->MaterialData.DiffuseAlbedo.y = diffChild.get<float>("y");
-		material->MaterialData.DiffuseAlbedo.z = diffChild.get<float>("z");
-
-		material->MaterialData.Roughness = data.get<float>("Roughness");
-		material->MaterialData.Reflection = data.get_optional<float>("Reflection").value_or(0.0f);
+		material->MaterialData.Roughness = config.Data.Roughness;
+		material->MaterialData.Reflection = config.Data.Reflection;
 		Materials[material->Name] = std::move(material);
 	}
 	return std::move(Materials);
 }
 
-void OMaterialsConfigParser::AddDataToNode(const SMaterial* Mat, boost::property_tree::ptree& OutNode)
+void OMaterialsConfigParser::AddDataToConfig(const SMaterial* Mat, SMaterialDataConfig& OutData)
 {
-	OutNode.put("Diffuse.x", Mat->MaterialData.DiffuseAlbedo.x);
-	OutNode.put("Diffuse.y", Mat->MaterialData.DiffuseAlbedo.y);
-	OutNode.put("Diffuse.z", Mat->MaterialData.DiffuseAlbedo.z);
+	OutData.Diffuse.X = Mat->MaterialData.DiffuseAlbedo.x;
+	OutData.Diffuse.Y = Mat->MaterialData.DiffuseAlbedo.y;
+	OutData.Diffuse.Z = Mat->MaterialData.DiffuseAlbedo.z;
 
-	OutNode.put("Roughness", Mat->MaterialData.Roughness);
+	OutData.Roughness = Mat->MaterialData.Roughness;
 }
 
 void OMaterialsConfigParser::AddMaterial(const SMaterial* Material)
 {
-	using namespace boost::property_tree;
-	LoadConfig(FileName);
-	auto name = Material->Name;
-
-	bool foundMat = false;
-	auto& items = PTree.get_child("Materials");
-	for (auto& item : items)
-	{
-		if (item.second.get<string>("Name") == name)
-		{
-			auto& matNode = item.second;
-			auto& data = matNode.get_child("Data");
-			matNode.put("Name", Material->Name);
-			AddDataToNode(Material, data);
-			foundMat = true;
-			break;
-		}
-	}
+	UpdateMaterials({ Material });
+}
 
-	if (!foundMat)
+void OMaterialsConfigParser::AddMaterials(const std::unordered_map<string, SMaterial*>& Materials)
+{
+	vector<const SMaterial*> materials;
+	for (const auto material : Materials | std::views::values)
 	{
-		ptree matNode;
-		matNode.put("Name", Material->Name);
-		ptree data;
-		AddDataToNode(Material, data);
-		matNode.add_child("Data", data);
-		items.push_back(std::make_pair("", matNode));
+		materials.push_back(material);
 	}
-	write_json(FileName, PTree);
+	UpdateMaterials(materials);
 }
 
-void OMaterialsConfigParser::AddMaterials(const std::unordered_map<string, SMaterial*>& Materials)
+void OMaterialsConfigParser::UpdateMaterials(const vector<const SMaterial*>& Materials)
 {
-	for (const auto& value : Materials | std::views::values)
+	LoadConfig(FileName);
+	vector<SMaterialConfig> configs;
+	ReadRoot("Materials", configs);
+	for (const auto material : Materials)
 	{
-		AddMaterial(value);
+		auto config = std::ranges::find(configs, material->Name, &SMaterialConfig::Name);
+		if (config == configs.end())
+		{
+			config = configs.insert(configs.end(), SMaterialConfig{ material->Name });
+		}
+		AddDataToConfig(material, config->Data);
 	}
+
+	OJsonWriter writer;
+	writer.BeginObject();
+	writer.Key("Materials");
+	WriteJson(writer, configs);
+	writer.EndObject();
+	SaveConfig(writer);
 }
@@ -4,6 +4,75 @@
 #include "Material.h"
 
 #include <ranges>
+
+struct SMaterialColorConfig
+{
+	float X = 1.0f;
+	float Y = 1.0f;
+	float Z = 1.0f;
+	float W = 1.0f;
+};
+
+template<>
+struct TJsonSchema<SMaterialColorConfig>
+{
+	static constexpr auto Fields = std::make_tuple(JsonField("x", &SMaterialColorConfig::X),
+	                                               JsonField("y", &SMaterialColorConfig::Y),
+	                                               JsonField("z", &SMaterialColorConfig::Z),
+	                                               JsonOptional("w", &SMaterialColorConfig::W));
+};
+
+struct SMaterialFresnelConfig
+{
+	float X = 0.1f;
+	float Y = 0.1f;
+	float Z = 0.1f;
+};
+
+template<>
+struct TJsonSchema<SMaterialFresnelConfig>
+{
+	static constexpr auto Fields = std::make_tuple(JsonField("x", &SMaterialFresnelConfig::X),
+	                                               JsonField("y", &SMaterialFresnelConfig::Y),
+	                                               JsonField("z", &SMaterialFresnelConfig::Z));
+};
+
+struct SMaterialDataConfig
+{
+	vector<string> HeightMapPaths;
+	vector<string> DiffuseMapPaths;
+	vector<string> NormalMapPaths;
+	SMaterialColorConfig Diffuse;
+	SMaterialFresnelConfig Fresnel;
+	float Roughness = 1.0f;
+	float Reflection = 0.0f;
+};
+
+template<>
+struct TJsonSchema<SMaterialDataConfig>
+{
+	static constexpr auto Fields = std::make_tuple(JsonOptional("HeightMapPaths", &SMaterialDataConfig::HeightMapPaths),
+	                                               JsonOptional("DiffuseMapPaths", &SMaterialDataConfig::DiffuseMapPaths),
+	                                               JsonOptional("NormalMapPaths", &SMaterialDataConfig::NormalMapPaths),
+	                                               JsonField("Diffuse", &SMaterialDataConfig::Diffuse),
+	                                               JsonOptional("Fresnel", &SMaterialDataConfig::Fresnel),
+	                                               JsonField("Roughness", &SMaterialDataConfig::Roughness),
+	                                               JsonOptional("Reflection", &SMaterialDataConfig::Reflection));
+};
+
+struct SMaterialConfig
+{
+	string Name;
+	SMaterialDataConfig Data;
+};
+
+template<>
+struct TJsonSchema<SMaterialConfig>
+{
+	static constexpr auto Fields = std::make_tuple(JsonField("Name", &SMaterialConfig::Name),
+	                                               JsonField("Data", &SMaterialConfig::Data));
+};
+
 class OMaterialsConfigParser : public OConfigReader
 {
 public:
@@ -12,9 +81,14 @@ public:
 
 	std::unordered_map<string, shared_ptr<SMaterial>> LoadMaterials();
 
-	void AddDataToNode(const SMaterial* Mat, boost::property_tree::ptree& OutNode);
-	/*Adds or modifies the material in the tree*/
+	/*Adds or modifies the material in the config*/
 	void AddMaterial(const SMaterial* Material);
+
+	/*Same for every material, the config is written once*/
 	void AddMaterials(const std::unordered_map<string, SMaterial*>& Materials);
-	static vector<STexturePath> GetTexturePaths(const boost::property_tree::ptree& Node, const string& Key);
-};
\ No newline at end of file
+
+private:
+	static void AddDataToConfig(const SMaterial* Mat, SMaterialDataConfig& OutData);
+	static STexturePath GetTexturePath(const vector<string>& Paths);
+	void UpdateMaterials(const vector<const SMaterial*>& Materials);
+};
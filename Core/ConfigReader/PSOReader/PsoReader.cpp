@@ -1,13 +1,19 @@
 #include "PsoReader.h"
 
-#include <ranges>
+#include "Defines.h"
 
 vector<unique_ptr<SPSODescriptionBase>> OPSOReader::LoadPSOs() const
 {
 	vector<unique_ptr<SPSODescriptionBase>> PSOs;
-	for (auto val : GetRootChild("PipelineStateObjects") | std::views::values)
+	for (const auto val : GetRootChild("PipelineStateObjects"))
 	{
-		auto type = val.get<string>("Type");
+#if !ENABLE_DEBUG_DRAW
+		if (GetOptionalOr(val, "DebugDrawOnly", false))
+		{
+			continue;
+		}
+#endif
+		auto type = GetAttribute(val, "Type");
 		if (type == "Graphics")
 		{
 			PSOs.push_back(LoadGraphicsPSO(val));
@@ -20,14 +26,14 @@ vector<unique_ptr<SPSODescriptionBase>> OPSOReader::LoadPSOs() const
 	return PSOs;
 }
 
-unique_ptr<SPSOGraphicsDescription> OPSOReader::LoadGraphicsPSO(const boost::property_tree::ptree& Node) const
+unique_ptr<SPSOGraphicsDescription> OPSOReader::LoadGraphicsPSO(const OJsonValue& Node) const
 {
 	auto PSODesc = make_unique<SPSOGraphicsDescription>();
 	PSODesc->Type = EPSOType::Graphics;
 	auto& desc = PSODesc->PSODesc;
-	PSODesc->Name = Node.get<string>("Name");
+	PSODesc->Name = GetAttribute(Node, "Name");
 	PSODesc->RootSignatureName = GetAttribute(Node, "RootSignature");
-	PSODesc->ShaderPipeline = GetShaderArray(Node.get_child("ShaderPipeline"));
+	PSODesc->ShaderPipeline = GetShaderArray(Node["ShaderPipeline"]);
 	desc.Flags = GetFlags(Node);
 	desc.SampleMask = GetOptionalOr(Node, "SampleMask", UINT_MAX);
 	GetTopologyType(Node, desc.PrimitiveTopologyType, PSODesc->PrimitiveTopologyType);
@@ -47,34 +53,34 @@ unique_ptr<SPSOGraphicsDescription> OPSOReader::LoadGraphicsPSO(const boost::pro
 	return PSODesc;
 }
 
-unique_ptr<SPSOComputeDescription> OPSOReader::LoadComputePSO(const boost::property_tree::ptree& Node) const
+unique_ptr<SPSOComputeDescription> OPSOReader::LoadComputePSO(const OJsonValue& Node) const
 {
 	auto PSODesc = make_unique<SPSOComputeDescription>();
 	PSODesc->Type = EPSOType::Compute;
 	auto& desc = PSODesc->PSODesc;
 	PSODesc->Name = GetAttribute(Node, "Name");
 	PSODesc->RootSignatureName = GetAttribute(Node, "RootSignature");
-	PSODesc->ShaderPipeline = GetShaderArray(Node.get_child("ShaderPipeline"));
+	PSODesc->ShaderPipeline = GetShaderArray(Node["ShaderPipeline"]);
 	ENSURE(PSODesc->ShaderPipeline.ComputeShaderName.empty() == false);
 	desc.Flags = GetFlags(Node);
 	return PSODesc;
 }
 
-DXGI_SAMPLE_DESC OPSOReader::GetSampleDescription(const boost::property_tree::ptree& Node)
+DXGI_SAMPLE_DESC OPSOReader::GetSampleDescription(const OJsonValue& Node)
 {
-	if (auto optional = Node.get_child_optional("SampleDesc"))
+	if (const auto optional = Node["SampleDesc"])
 	{
 		DXGI_SAMPLE_DESC desc;
-		desc.Count = optional.value().get<UINT>("Count");
-		desc.Quality = optional.value().get<UINT>("Quality");
+		desc.Count = GetOptionalOr<UINT>(optional, "Count", 1);
+		desc.Quality = GetOptionalOr<UINT>(optional, "Quality", 0);
 		return desc;
 	}
 	return { 1, 0 };
 }
 
-CD3DX12_BLEND_DESC OPSOReader::GetBlendDesc(const boost::property_tree::ptree& Node)
+CD3DX12_BLEND_DESC OPSOReader::GetBlendDesc(const OJsonValue& Node)
 {
-	if (const auto optional = Node.get_child_optional("BlendState"))
+	if (const auto optional = Node["BlendState"])
 	{
 		CD3DX12_BLEND_DESC desc = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
 		desc.AlphaToCoverageEnable = GetOptionalOr(optional, "AlphaToCoverageEnable", false);
@@ -82,9 +88,9 @@ CD3DX12_BLEND_DESC OPSOReader::GetBlendDesc(const boost::property_tree::ptree& N
 
 		for (uint32_t counter = 0; counter < D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT; counter++)
 		{
-			if (const auto renderTargetOptional = optional->get_child_optional("RenderTarget"))
+			if (const auto renderTargetOptional = optional["RenderTarget"])
 			{
-				for (const auto& val : *renderTargetOptional | std::views::values)
+				for (const auto val : renderTargetOptional)
 				{
 					auto& target = desc.RenderTarget[counter];
 					target.BlendEnable = GetOptionalOr(val, "BlendEnable", false);
@@ -226,12 +232,11 @@ D3D12_BLEND OPSOReader::GetBlend(const string& BlendString)
 	return D3D12_BLEND_ZERO;
 }
 
-CD3DX12_RASTERIZER_DESC OPSOReader::GetRasterizerDesc(const boost::property_tree::ptree& Node)
+CD3DX12_RASTERIZER_DESC OPSOReader::GetRasterizerDesc(const OJsonValue& Node)
 {
 	CD3DX12_RASTERIZER_DESC desc;
-	if (auto optional = Node.get_child_optional("RasterizerState"))
+	if (const auto value = Node["RasterizerState"])
 	{
-		const auto& value = optional.get();
 		desc.FrontCounterClockwise = GetOptionalOr(value, "FrontCounterClockwise", false);
 		desc.FillMode = GetFillMode(GetOptionalOr(value, "FillMode", "Solid"));
 		desc.CullMode = GetCullMode(GetOptionalOr(value, "CullMode", "Back"));
@@ -293,24 +298,24 @@ D3D12_FILL_MODE OPSOReader::GetFillMode(const string& FillModeString)
 	return D3D12_FILL_MODE_SOLID;
 }
 
-CD3DX12_DEPTH_STENCIL_DESC OPSOReader::GetDepthStencilDesc(const boost::property_tree::ptree& Node)
+CD3DX12_DEPTH_STENCIL_DESC OPSOReader::GetDepthStencilDesc(const OJsonValue& Node)
 {
 	CD3DX12_DEPTH_STENCIL_DESC desc;
-	if (auto optinal = Node.get_child_optional("DepthStencilState"))
+	if (const auto optinal = Node["DepthStencilState"])
 	{
-		desc.DepthEnable = GetOptionalOr(optinal.value(), "DepthEnable", true);
-		desc.DepthWriteMask = GetDepthWriteMask(GetOptionalOr(optinal.value(), "DepthWriteMask", "All"));
-		desc.DepthFunc = GetComparisonFunc(GetOptionalOr(optinal.value(), "DepthFunc", "Less"));
-		desc.StencilEnable = GetOptionalOr(optinal.value(), "StencilEnable", false);
-		desc.StencilReadMask = GetOptionalOr(optinal.value(), "StencilReadMask", 0);
-		desc.StencilWriteMask = GetOptionalOr(optinal.value(), "StencilWriteMask", 0);
-		desc.FrontFace = GetDepthStencilOp(optinal->get_child_optional("FrontFace"));
-		desc.BackFace = GetDepthStencilOp(optinal->get_child_optional("BackFace"));
+		desc.DepthEnable = GetOptionalOr(optinal, "DepthEnable", true);
+		desc.DepthWriteMask = GetDepthWriteMask(GetOptionalOr(optinal, "DepthWriteMask", "All"));
+		desc.DepthFunc = GetComparisonFunc(GetOptionalOr(optinal, "DepthFunc", "Less"));
+		desc.StencilEnable = GetOptionalOr(optinal, "StencilEnable", false);
+		desc.StencilReadMask = GetOptionalOr(optinal, "StencilReadMask", 0);
+		desc.StencilWriteMask = GetOptionalOr(optinal, "StencilWriteMask", 0);
+		desc.FrontFace = GetDepthStencilOp(optinal["FrontFace"]);
+		desc.BackFace = GetDepthStencilOp(optinal["BackFace"]);
 	}
 	return desc;
 }
 
-D3D12_DEPTH_STENCILOP_DESC OPSOReader::GetDepthStencilOp(const boost::optional<const boost::property_tree::ptree&>& Node)
+D3D12_DEPTH_STENCILOP_DESC OPSOReader::GetDepthStencilOp(const OJsonValue& Node)
 {
 	if (!Node)
 	{
@@ -441,41 +446,23 @@ D3D12_COLOR_WRITE_ENABLE OPSOReader::GetColorWriteEnable(const string& ColorWrit
 	return D3D12_COLOR_WRITE_ENABLE_ALL;
 }
 
-SShaderArrayText OPSOReader::GetShaderArray(const boost::property_tree::ptree& Node)
+SShaderArrayText OPSOReader::GetShaderArray(const OJsonValue& Node)
 {
 	SShaderArrayText shaderArray;
-	if (auto optional = Node.get_optional<string>("VertexShader"))
-	{
-		shaderArray.VertexShaderName = optional.value();
-	}
-	if (auto optional = Node.get_optional<string>("PixelShader"))
-	{
-		shaderArray.PixelShaderName = optional.value();
-	}
-	if (auto optional = Node.get_optional<string>("GeometryShader"))
-	{
-		shaderArray.GeometryShaderName = optional.value();
-	}
-	if (auto optional = Node.get_optional<string>("HullShader"))
-	{
-		shaderArray.HullShaderName = optional.value();
-	}
-	if (auto optional = Node.get_optional<string>("DomainShader"))
-	{
-		shaderArray.DomainShaderName = optional.value();
-	}
-	if (auto optional = Node.get_optional<string>("ComputeShader"))
-	{
-		shaderArray.ComputeShaderName = optional.value();
-	}
+	shaderArray.VertexShaderName = GetOptionalOr(Node, "VertexShader", "");
+	shaderArray.PixelShaderName = GetOptionalOr(Node, "PixelShader", "");
+	shaderArray.GeometryShaderName = GetOptionalOr(Node, "GeometryShader", "");
+	shaderArray.HullShaderName = GetOptionalOr(Node, "HullShader", "");
+	shaderArray.DomainShaderName = GetOptionalOr(Node, "DomainShader", "");
+	shaderArray.ComputeShaderName = GetOptionalOr(Node, "ComputeShader", "");
 	return shaderArray;
 }
 
-void OPSOReader::GetTopologyType(const boost::property_tree::ptree& Node, D3D12_PRIMITIVE_TOPOLOGY_TYPE& OutTopologyType, D3D_PRIMITIVE_TOPOLOGY& OutTopology)
+void OPSOReader::GetTopologyType(const OJsonValue& Node, D3D12_PRIMITIVE_TOPOLOGY_TYPE& OutTopologyType, D3D_PRIMITIVE_TOPOLOGY& OutTopology)
 {
-	if (auto optional = Node.get_optional<string>("PrimitiveTopology"))
+	if (const auto optional = Node["PrimitiveTopology"])
 	{
-		const auto string = optional.value();
+		const auto string = optional.GetText();
 		if (string == "TriangleList")
 		{
 			OutTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
@@ -512,28 +499,25 @@ void OPSOReader::GetTopologyType(const boost::property_tree::ptree& Node, D3D12_
 			OutTopology = D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
 			return;
 		}
-		LOG(Config, Error, "Unknown topology type: {}", TEXT(optional.value()));
+		LOG(Config, Error, "Unknown topology type: {}", TEXT(std::string(string)));
 	}
 }
 
-void OPSOReader::SetRenderTargetFormats(DXGI_FORMAT* Formats, const boost::property_tree::ptree& Node)
+void OPSOReader::SetRenderTargetFormats(DXGI_FORMAT* Formats, const OJsonValue& Node)
 {
 	uint32_t counter = 0;
 
-	if (auto node = Node.get_child_optional("RenderTargetFormats"))
+	for (const auto format : Node["RenderTargetFormats"])
 	{
-		for (auto& format : node.value() | std::views::values)
-		{
-			Formats[counter] = GetFormat(format.data());
-		}
+		Formats[counter] = GetFormat(string(format.GetText()));
 	}
 }
 
-DXGI_FORMAT OPSOReader::GetFormat(const boost::property_tree::ptree& Node)
+DXGI_FORMAT OPSOReader::GetFormat(const OJsonValue& Node)
 {
-	if (auto optional = Node.get_optional<string>("Format"))
+	if (const auto optional = Node["Format"])
 	{
-		return GetFormat(optional.value());
+		return GetFormat(string(optional.GetText()));
 	}
 	return SRenderConstants::DepthBufferDSVFormat;
 }
@@ -633,11 +617,11 @@ DXGI_FORMAT OPSOReader::GetFormat(const string& FormatString)
 	return DXGI_FORMAT_UNKNOWN;
 }
 
-D3D12_PIPELINE_STATE_FLAGS OPSOReader::GetFlags(const boost::property_tree::ptree& Node)
+D3D12_PIPELINE_STATE_FLAGS OPSOReader::GetFlags(const OJsonValue& Node)
 {
-	if (auto flag = Node.get_optional<string>("Flags"))
+	if (const auto flag = Node["Flags"])
 	{
-		const auto string = flag.value();
+		const auto string = flag.GetText();
 		if (string == "None")
 		{
 			return D3D12_PIPELINE_STATE_FLAG_NONE;
@@ -1,23 +1,37 @@
 #include "RenderGraphReader.h"
 
+#include "Defines.h"
 #include "Material.h"
 
-#include <ranges>
-
 vector<SNodeInfo> ORenderGraphReader::LoadRenderGraph(string& OutHead)
 {
-	vector<SNodeInfo> result;
-	auto node = PTree.get_child("RenderGraph");
-	OutHead = GetAttribute(node, "Head");
-	for (auto& node : node.get_child("Nodes") | std::views::values)
+	SRenderGraphConfig config;
+	ReadRoot("RenderGraph", config);
+	OutHead = config.Head;
+#if !ENABLE_DEBUG_DRAW
+	// Links through a dropped node go to the node after it
+	unordered_map<string, string> dropped;
+	for (const auto& node : config.Nodes)
+	{
+		if (node.bDebugDrawOnly)
+		{
+			dropped[node.Name] = node.NextNode;
+		}
+	}
+	auto skip = [&dropped](string Name) {
+		while (dropped.contains(Name))
+		{
+			Name = dropped[Name];
+		}
+		return Name;
+	};
+	std::erase_if(config.Nodes, [](const SNodeInfo& Node) { return Node.bDebugDrawOnly; });
+	for (auto& node : config.Nodes)
 	{
-		SNodeInfo info;
-		info.Name = node.get<string>("Name");
-		info.PSOType = node.get<string>("PSO");
-		info.NextNode = node.get<string>("NextNode");
-		info.RenderLayer = node.get<string>("RenderLayer");
-		info.bEnable = node.get<bool>("Enabled");
-		result.push_back(info);
+		node.NextNode = skip(node.NextNode);
 	}
-	return result;
+	OutHead = skip(OutHead);
+#endif
+	return std::move(config.Nodes);
 }
+
@@ -1,7 +1,32 @@
-
 #pragma once
 #include "ConfigReader.h"
 #include "RenderNodeInfo.h"
+
+template<>
+struct TJsonSchema<SNodeInfo>
+{
+	static constexpr auto Fields = std::make_tuple(JsonField("Name", &SNodeInfo::Name),
+	                                               JsonField("PSO", &SNodeInfo::PSOType),
+	                                               JsonField("NextNode", &SNodeInfo::NextNode),
+	                                               JsonField("RenderLayer", &SNodeInfo::RenderLayer),
+	                                               JsonField("Enabled", &SNodeInfo::bEnable),
+	                                               JsonOptional("AsyncCompute", &SNodeInfo::bAsyncCompute),
+	                                               JsonOptional("DebugDrawOnly", &SNodeInfo::bDebugDrawOnly));
+};
+
+struct SRenderGraphConfig
+{
+	string Head;
+	vector<SNodeInfo> Nodes;
+};
+
+template<>
+struct TJsonSchema<SRenderGraphConfig>
+{
+	static constexpr auto Fields = std::make_tuple(JsonField("Head", &SRenderGraphConfig::Head),
+	                                               JsonField("Nodes", &SRenderGraphConfig::Nodes));
+};
+
 enum class EMaterialType : uint8_t;
 class ORenderGraphReader : public OConfigReader
 {
@@ -2,46 +2,47 @@
 
 #include "DirectX/Light/Light.h"
 
+namespace
+{
+DirectX::XMFLOAT3 GetIntensity(const OJsonValue& Light)
+{
+	const auto intensity = Light["Intensity"];
+	return { intensity.GetOr("R", 0.0f), intensity.GetOr("G", 0.0f), intensity.GetOr("B", 0.0f) };
+}
+} // namespace
+
 SSceneSettings OSceneReader::LoadScene()
 {
 	SSceneSettings res;
 
-	res.CurrentScene = PTree.get_child("Scene").get<string>("CurrentScene");
+	res.CurrentScene = GetRoot<string>("Scene.CurrentScene");
 
-	for (const auto& scene : PTree.get_child("Scenes") | std::views::values)
+	for (const auto scene : GetRootChild("Scenes"))
 	{
 		SScenePayload payload;
-		payload.Name = scene.get<string>("Name");
-		payload.Skybox = scene.get<string>("Sky");
+		payload.Name = GetAttribute(scene, "Name");
+		payload.Skybox = GetAttribute(scene, "Sky");
 
-		for (auto obj : scene.get_child("Objects") | std::views::values)
+		for (const auto obj : scene["Objects"])
 		{
-			payload.Objects.push_back(obj.get<string>("ObjectName"));
+			payload.Objects.push_back(GetAttribute(obj, "ObjectName"));
 		}
 
-		for (auto light : scene.get_child("Lights"))
+		for (const auto light : scene["Lights"])
 		{
-			string type = light.second.get<string>("Type");
+			const string type = GetAttribute(light, "Type");
 			if (type == "Directional")
 			{
 				SDirectionalLightPayload dirLight;
-				GetFloat3(light.second, "Direction", dirLight.Direction); //todo optimize boilerplate
-				dirLight.Intensity = {
-					light.second.get_child("Intensity").get<float>("R"),
-					light.second.get_child("Intensity").get<float>("G"),
-					light.second.get_child("Intensity").get<float>("B")
-				};
+				GetFloat3(light, "Direction", dirLight.Direction);
+				dirLight.Intensity = GetIntensity(light);
 				payload.DirLights.push_back(dirLight);
 			}
 			else if (type == "Spot")
 			{
 				SSpotLightPayload spotLight;
-				GetFloat3(light.second, "Direction", spotLight.Direction);
-				spotLight.Intensity = {
-					light.second.get_child("Intensity").get<float>("R"),
-					light.second.get_child("Intensity").get<float>("G"),
-					light.second.get_child("Intensity").get<float>("B")
-				};
+				GetFloat3(light, "Direction", spotLight.Direction);
+				spotLight.Intensity = GetIntensity(light);
 				//Read position
 				payload.SpotLights.push_back(spotLight);
 			}
@@ -2,6 +2,48 @@
 #include "ConfigReader.h"
 #include "GraphicsPipeline/GraphicsPipeline.h"
 #include "Types.h"
+
+template<>
+struct TJsonSchema<SShaderMacro>
+{
+	static constexpr auto Fields = std::make_tuple(JsonField("Name", &SShaderMacro::Name),
+	                                               JsonField("Value", &SShaderMacro::Definition));
+};
+
+struct SShaderStageConfig
+{
+	string Type;
+	string EntryPoint;
+	string TargetProfile;
+	vector<SShaderMacro> Defines;
+};
+
+template<>
+struct TJsonSchema<SShaderStageConfig>
+{
+	static constexpr auto Fields = std::make_tuple(JsonField("Type", &SShaderStageConfig::Type),
+	                                               JsonField("EntryPoint", &SShaderStageConfig::EntryPoint),
+	                                               JsonField("TargetProfile", &SShaderStageConfig::TargetProfile),
+	                                               JsonOptional("Defines", &SShaderStageConfig::Defines));
+};
+
+struct SShaderConfig
+{
+	string Path;
+	string Name;
+	vector<SShaderStageConfig> Pipeline;
+	bool bDebugDrawOnly = false;
+};
+
+template<>
+struct TJsonSchema<SShaderConfig>
+{
+	static constexpr auto Fields = std::make_tuple(JsonField("Path", &SShaderConfig::Path),
+	                                               JsonField("Name", &SShaderConfig::Name),
+	                                               JsonField("Pipeline", &SShaderConfig::Pipeline),
+	                                               JsonOptional("DebugDrawOnly", &SShaderConfig::bDebugDrawOnly));
+};
+
 class OShaderReader : public OConfigReader
 {
 public:
@@ -10,7 +52,4 @@ public:
 	{
 	}
 	unordered_map<string, vector<SPipelineStage>> LoadShaders();
-
-private:
-	vector<SShaderMacro> FindDefines(const boost::property_tree::ptree& Tree);
 };
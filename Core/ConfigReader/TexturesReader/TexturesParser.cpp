@@ -6,58 +6,49 @@
 
 #include "../../Textures/Texture.h"
 
-#include <ranges>
-using namespace boost::property_tree;
+#include <algorithm>
 
 void OTexturesParser::AddTexture(STexture* Texture)
 {
-	auto& items = PTree.get_child("Textures");
-	auto name = Texture->Name;
-	auto path = WStringToUTF8(Texture->FileName);
-	bool hasfound = false;
-
-	for (auto& val : items | std::views::values)
-	{
-		if (val.get<string>("Name") == name)
-		{
-			hasfound = true;
-			auto& texNode = val;
-			texNode.put("Path", path);
-			texNode.put("ViewDimensions", Texture->ViewType);
-		}
-	}
-
-	if (!hasfound)
-	{
-		ptree texNode;
-		texNode.put("Name", name);
-		texNode.put("Path", path);
-		texNode.put("ViewDimensions", Texture->ViewType);
-		items.push_back(std::make_pair("", texNode));
-	}
-
-	write_json(FileName, PTree);
+	AddTextures({ Texture });
 }
 
 void OTexturesParser::AddTextures(const vector<STexture*>& Textures)
 {
-	for (auto tex : Textures)
+	vector<STextureConfig> entries;
+	ReadRoot("Textures", entries);
+	for (const auto texture : Textures)
 	{
-		AddTexture(tex);
+		auto entry = std::ranges::find(entries, texture->Name, &STextureConfig::Name);
+		if (entry == entries.end())
+		{
+			entry = entries.insert(entries.end(), STextureConfig{ texture->Name });
+		}
+		entry->Path = WStringToUTF8(texture->FileName);
+		entry->ViewDimensions = texture->ViewType;
+		entry->Type = WStringToUTF8(ToString(texture->Type));
 	}
+
+	OJsonWriter writer;
+	writer.BeginObject();
+	writer.Key("Textures");
+	WriteJson(writer, entries);
+	writer.EndObject();
+	SaveConfig(writer);
 }
 
 vector<STexture*> OTexturesParser::LoadTextures()
 {
 	vector<STexture*> textures;
-	auto& items = PTree.get_child("Textures");
-	for (auto& val : items | std::views::values)
+	vector<STextureConfig> entries;
+	ReadRoot("Textures", entries);
+	for (const auto& entry : entries)
 	{
 		auto tex = new STexture();
-		tex->Name = val.get<string>("Name");
-		tex->FileName = UTF8ToWString(val.get<string>("Path"));
-		tex->ViewType = val.get<string>("ViewDimensions");
-		tex->Type = GetTextureType(GetAttribute(val,"Type"));
+		tex->Name = entry.Name;
+		tex->FileName = UTF8ToWString(entry.Path);
+		tex->ViewType = entry.ViewDimensions;
+		tex->Type = GetTextureType(entry.Type);
 		textures.push_back(tex);
 	}
 	return textures;
@@ -85,8 +76,12 @@ ETextureType OTexturesParser::GetTextureType(const string& Type)
 	{
 		return ETextureType::Occlusion;
 	}
+	if (Type == "Alpha")
+	{
+		return ETextureType::Alpha;
+	}
 
 	LOG(Config, Error, "Texture type not found! {}", TEXT(Type))
 	return ETextureType::Diffuse;
 
-}
\ No newline at end of file
+}
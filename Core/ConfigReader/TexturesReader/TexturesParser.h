@@ -2,6 +2,23 @@
 #include "ConfigReader.h"
 #include "Texture.h"
 
+struct STextureConfig
+{
+	string Name;
+	string Path;
+	string ViewDimensions;
+	string Type = "Diffuse";
+};
+
+template<>
+struct TJsonSchema<STextureConfig>
+{
+	static constexpr auto Fields = std::make_tuple(JsonField("Name", &STextureConfig::Name),
+	                                               JsonField("Path", &STextureConfig::Path),
+	                                               JsonField("ViewDimensions", &STextureConfig::ViewDimensions),
+	                                               JsonOptional("Type", &STextureConfig::Type));
+};
+
 struct STexture;
 class OTexturesParser : public OConfigReader
 {
@@ -13,6 +30,8 @@ public:
 	}
 
 	void AddTexture(STexture* Texture);
+
+	/** @brief Adds or updates the textures by name, the config is written once */
 	void AddTextures(const vector<STexture*>& Textures);
 	vector<STexture*> LoadTextures();
 private:
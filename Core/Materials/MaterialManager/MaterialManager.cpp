@@ -40,9 +40,9 @@ SMaterial* OMaterialManager::CreateMaterial(const SMaterialPayloadData& Data)
 	mat->MaterialCBIndex = Materials.size();
 	mat->MaterialData = Data.MaterialSurface;
 	LoadTextureFromPath(Data.DiffuseMap, mat->DiffuseMap);
-	LoadTextureFromPath(Data.NormalMap, mat->NormalMap);
-	LoadTextureFromPath(Data.HeightMap, mat->HeightMap);
-	LoadTextureFromPath(Data.AlphaMap, mat->AlphaMap);
+	LoadTextureFromPath(Data.NormalMap, mat->NormalMap, ETextureType::Normal);
+	LoadTextureFromPath(Data.HeightMap, mat->HeightMap, ETextureType::Height);
+	LoadTextureFromPath(Data.AlphaMap, mat->AlphaMap, ETextureType::Alpha);
 	LoadTextureFromPath(Data.AmbientMap, mat->AmbientMap);
 	LoadTextureFromPath(Data.SpecularMap, mat->SpecularMap);
 	AddMaterial(name, std::move(mat));
@@ -135,7 +135,7 @@ vector<STexturePath> OMaterialManager::LoadTexturesFromPaths(const vector<wstrin
 	return result;
 }
 
-bool OMaterialManager::LoadTextureFromPath(const wstring& Path, STexturePath& OutTexture)
+bool OMaterialManager::LoadTextureFromPath(const wstring& Path, STexturePath& OutTexture, ETextureType Type)
 {
 	if (Path.empty())
 	{
@@ -151,7 +151,7 @@ bool OMaterialManager::LoadTextureFromPath(const wstring& Path, STexturePath& Ou
 
 	auto filename = path.filename().string();
 	OutTexture.Path = path.c_str();
-	OutTexture.Texture = FindOrCreateTexture(filename, path);
+	OutTexture.Texture = FindOrCreateTexture(filename, path, Type);
 	if (!OutTexture.Texture)
 	{
 		LOG(Engine, Warning, "Texture with path {} not found!", TEXT(path));
@@ -167,8 +167,8 @@ void OMaterialManager::LoadMaterialsFromCache()
 	{
 		auto& mat = val;
 		LoadTextureFromPath(mat->DiffuseMap.Path, mat->DiffuseMap);
-		LoadTextureFromPath(mat->NormalMap.Path, mat->NormalMap);
-		LoadTextureFromPath(mat->HeightMap.Path, mat->HeightMap);
+		LoadTextureFromPath(mat->NormalMap.Path, mat->NormalMap, ETextureType::Normal);
+		LoadTextureFromPath(mat->HeightMap.Path, mat->HeightMap, ETextureType::Height);
 		mat->MaterialCBIndex = it;
 		MaterialsIndicesMap[it] = val;
 		++it;
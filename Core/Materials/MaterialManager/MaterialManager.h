@@ -29,7 +29,7 @@ public:
 	void LoadMaterialsFromCache();
 	static void LoadTexturesFromPaths(vector<STexturePath>& OutTextures);
 	static vector<STexturePath> LoadTexturesFromPaths(const vector<wstring>& Paths);
-	static bool LoadTextureFromPath(const wstring& Path, STexturePath& OutTexture);
+	static bool LoadTextureFromPath(const wstring& Path, STexturePath& OutTexture, ETextureType Type = ETextureType::Diffuse);
 	void SaveMaterials() const;
 	void BuildMaterialsFromTextures(const std::unordered_map<string, unique_ptr<STexture>>& Textures);
 	OnMaterialsChanged MaterialsRebuld;
@@ -1,5 +1,6 @@
 #include "GeometryGenerator.h"
 
+#include "Engine/UploadBuffer/UploadManager.h"
 #include "Logger.h"
 #include "PathUtils.h"
 
@@ -689,7 +690,7 @@ OGeometryGenerator::SMeshData OGeometryGenerator::CreateQuad(float X, float Y, f
 	return meshData;
 }
 
-unique_ptr<SMeshGeometry> OGeometryGenerator::CreateSkullGeometry(string PathToModel, ID3D12Device* Device, ID3D12GraphicsCommandList* CommandList, OEngine* Engine)
+unique_ptr<SMeshGeometry> OGeometryGenerator::CreateSkullGeometry(string PathToModel, OUploadManager* Uploads)
 {
 	std::ifstream fin(PathToModel);
 	using namespace Utils::Math;
@@ -768,19 +769,8 @@ unique_ptr<SMeshGeometry> OGeometryGenerator::CreateSkullGeometry(string PathToM
 	THROW_IF_FAILED(D3DCreateBlob(ibByteSize, &geometry->IndexBufferCPU));
 	CopyMemory(geometry->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
 
-	geometry->VertexBufferGPU = Utils::CreateDefaultBuffer(
-	    Device,
-	    CommandList,
-	    vertices.data(),
-	    vbByteSize,
-	    geometry->VertexBufferUploader);
-
-	geometry->IndexBufferGPU = Utils::CreateDefaultBuffer(
-	    Device,
-	    CommandList,
-	    indices.data(),
-	    ibByteSize,
-	    geometry->IndexBufferUploader);
+	geometry->VertexBufferGPU = Uploads->CreateDefaultBuffer(vertices.data(), vbByteSize);
+	geometry->IndexBufferGPU = Uploads->CreateDefaultBuffer(indices.data(), ibByteSize, &geometry->UploadTicket);
 
 	geometry->VertexByteStride = sizeof(SVertex);
 	geometry->VertexBufferByteSize = vbByteSize;
@@ -797,10 +787,11 @@ unique_ptr<SMeshGeometry> OGeometryGenerator::CreateSkullGeometry(string PathToM
 	submesh->Indices = make_unique<vector<uint32_t>>(std::move(indices));
 
 	geometry->SetGeometry(geometry->Name, submesh);
+	geometry->SetResidency(EMeshResidency::Compact);
 	return std::move(geometry);
 }
 
-unique_ptr<SMeshGeometry> OGeometryGenerator::CreateWaterGeometry(float Width, float Depth, uint32_t RowCount, uint32_t ColumnCount, ID3D12Device* Device, ID3D12GraphicsCommandList* CommandList, size_t VertexCount)
+unique_ptr<SMeshGeometry> OGeometryGenerator::CreateWaterGeometry(float Width, float Depth, uint32_t RowCount, uint32_t ColumnCount, OUploadManager* Uploads, size_t VertexCount)
 {
 	SMeshData grid = CreateGrid(Width, Depth, RowCount, ColumnCount);
 	std::vector<SVertex> vertices(grid.Vertices.size());
@@ -838,17 +829,8 @@ unique_ptr<SMeshGeometry> OGeometryGenerator::CreateWaterGeometry(float Width, f
 	THROW_IF_FAILED(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
 	CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
 
-	geo->VertexBufferGPU = Utils::CreateDefaultBuffer(Device,
-	                                                  CommandList,
-	                                                  vertices.data(),
-	                                                  vbByteSize,
-	                                                  geo->VertexBufferUploader);
-
-	geo->IndexBufferGPU = Utils::CreateDefaultBuffer(Device,
-	                                                 CommandList,
-	                                                 indices.data(),
-	                                                 ibByteSize,
-	                                                 geo->IndexBufferUploader);
+	geo->VertexBufferGPU = Uploads->CreateDefaultBuffer(vertices.data(), vbByteSize);
+	geo->IndexBufferGPU = Uploads->CreateDefaultBuffer(indices.data(), ibByteSize, &geo->UploadTicket);
 
 	geo->VertexByteStride = sizeof(SVertex);
 	geo->VertexBufferByteSize = vbByteSize;
@@ -862,5 +844,6 @@ unique_ptr<SMeshGeometry> OGeometryGenerator::CreateWaterGeometry(float Width, f
 	submesh->Bounds = bounds;
 
 	geo->SetGeometry("Grid", submesh);
+	geo->SetResidency(EMeshResidency::Compact);
 	return move(geo);
 }
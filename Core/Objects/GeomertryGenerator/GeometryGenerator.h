@@ -1,6 +1,7 @@
 #pragma once
 #include "DirectX/MeshGeometry.h"
 #include "Material.h"
+#include "MeshSimplifier/MeshSimplifier.h"
 
 #include <DirectX/DXHelper.h>
 #include <Types.h>
@@ -17,6 +18,7 @@ enum class EGeometryType
 };
 
 class OEngine;
+class OUploadManager;
 class OGeometryGenerator
 {
 public:
@@ -32,8 +34,8 @@ public:
 	SMeshData CreateGrid(float Width, float Depth, uint32_t M, uint32_t N);
 	SMeshData CreateQuad(float X, float Y, float Width, float Height, float Depth);
 
-	unique_ptr<SMeshGeometry> CreateSkullGeometry(string PathToModel, ID3D12Device* Device, ID3D12GraphicsCommandList* CommandList, OEngine* Engine);
-	unique_ptr<SMeshGeometry> CreateWaterGeometry(float Width, float Depth, uint32_t RowCount, uint32_t ColumnCount, ID3D12Device* Device, ID3D12GraphicsCommandList* CommandList, size_t VertexCount);
+	unique_ptr<SMeshGeometry> CreateSkullGeometry(string PathToModel, OUploadManager* Uploads);
+	unique_ptr<SMeshGeometry> CreateWaterGeometry(float Width, float Depth, uint32_t RowCount, uint32_t ColumnCount, OUploadManager* Uploads, size_t VertexCount);
 
 private:
 	void BuildCylinderTopCap(float BottomRadius, float TopRadius, float Height, uint32_t SliceCount, uint32_t StackCount, SMeshData& MeshData);
@@ -83,6 +85,9 @@ struct OGeometryGenerator::SMeshData
 
 	SMaterialPayloadData Material;
 
+	// Filled by OMeshGenerator::GenerateLODs, every LOD indexes Vertices
+	vector<SMeshLOD> LODs;
+
 private:
 	vector<uint16_t> Indices16;
 };
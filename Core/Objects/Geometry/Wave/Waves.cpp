@@ -1,52 +1,310 @@
-
 #include "Waves.h"
 
-#include "Exception.h"
-#include "ppl.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define WAVES_SSE 1
+#include <emmintrin.h>
+#else
+#define WAVES_SSE 0
+#endif
+
+#if defined(__AVX__)
+#define WAVES_AVX 1
+#include <immintrin.h>
+#else
+#define WAVES_AVX 0
+#endif
+
+namespace
+{
+using TClock = std::chrono::high_resolution_clock;
 
-#include <pplwin.h>
+// Cells side by side, the SIMD and the scalar kernels share the math below
+struct SLanes1
+{
+	static constexpr int32_t Width = 1;
+	float V;
+};
 
-OWaves::OWaves(int32_t M, int32_t N, float dx, float dt, float Speed, float Damping)
+SLanes1 operator+(SLanes1 A, SLanes1 B)
 {
-	NumRows = M;
-	NumCols = N;
+	return { A.V + B.V };
+}
 
-	VertexCount = M * N;
-	TriangleCount = (M - 1) * (N - 1) * 2;
+SLanes1 operator-(SLanes1 A, SLanes1 B)
+{
+	return { A.V - B.V };
+}
 
-	TimeStep = dt;
-	SpatialStep = dx;
+SLanes1 operator*(SLanes1 A, SLanes1 B)
+{
+	return { A.V * B.V };
+}
 
-	float d = Damping * dt + 2.0f;
-	float e = (Speed * Speed) * (dt * dt) / (dx * dx);
+SLanes1 operator/(SLanes1 A, SLanes1 B)
+{
+	return { A.V / B.V };
+}
 
-	K1 = (Damping * dt - 2.0f) / d;
-	K2 = (4.0f - 8.0f * e) / d;
-	K3 = (2.0f * e) / d;
+SLanes1 Sqrt(SLanes1 A)
+{
+	return { std::sqrt(A.V) };
+}
 
-	PrevSolution.resize(VertexCount);
-	CurrentSolution.resize(VertexCount);
-	Normals.resize(VertexCount);
-	TangentX.resize(VertexCount);
+SLanes1 Load(SLanes1, const float* Data)
+{
+	return { *Data };
+}
 
-	// generate grid vertices in system memory
+void Store(float* Data, SLanes1 A)
+{
+	*Data = A.V;
+}
 
-	const float halfWidth = (N - 1) * dx * 0.5f;
-	const float halfDepth = (M - 1) * dx * 0.5f;
-	for (int i = 0; i < M; i++)
+SLanes1 Splat(SLanes1, float Value)
+{
+	return { Value };
+}
+
+#if WAVES_SSE
+struct SLanes4
+{
+	static constexpr int32_t Width = 4;
+	__m128 V;
+};
+
+SLanes4 operator+(SLanes4 A, SLanes4 B)
+{
+	return { _mm_add_ps(A.V, B.V) };
+}
+
+SLanes4 operator-(SLanes4 A, SLanes4 B)
+{
+	return { _mm_sub_ps(A.V, B.V) };
+}
+
+SLanes4 operator*(SLanes4 A, SLanes4 B)
+{
+	return { _mm_mul_ps(A.V, B.V) };
+}
+
+SLanes4 operator/(SLanes4 A, SLanes4 B)
+{
+	return { _mm_div_ps(A.V, B.V) };
+}
+
+SLanes4 Sqrt(SLanes4 A)
+{
+	return { _mm_sqrt_ps(A.V) };
+}
+
+SLanes4 Load(SLanes4, const float* Data)
+{
+	return { _mm_loadu_ps(Data) };
+}
+
+void Store(float* Data, SLanes4 A)
+{
+	_mm_storeu_ps(Data, A.V);
+}
+
+SLanes4 Splat(SLanes4, float Value)
+{
+	return { _mm_set1_ps(Value) };
+}
+#endif
+
+#if WAVES_AVX
+struct SLanes8
+{
+	static constexpr int32_t Width = 8;
+	__m256 V;
+};
+
+SLanes8 operator+(SLanes8 A, SLanes8 B)
+{
+	return { _mm256_add_ps(A.V, B.V) };
+}
+
+SLanes8 operator-(SLanes8 A, SLanes8 B)
+{
+	return { _mm256_sub_ps(A.V, B.V) };
+}
+
+SLanes8 operator*(SLanes8 A, SLanes8 B)
+{
+	return { _mm256_mul_ps(A.V, B.V) };
+}
+
+SLanes8 operator/(SLanes8 A, SLanes8 B)
+{
+	return { _mm256_div_ps(A.V, B.V) };
+}
+
+SLanes8 Sqrt(SLanes8 A)
+{
+	return { _mm256_sqrt_ps(A.V) };
+}
+
+SLanes8 Load(SLanes8, const float* Data)
+{
+	return { _mm256_loadu_ps(Data) };
+}
+
+void Store(float* Data, SLanes8 A)
+{
+	_mm256_storeu_ps(Data, A.V);
+}
+
+SLanes8 Splat(SLanes8, float Value)
+{
+	return { _mm256_set1_ps(Value) };
+}
+#endif
+
+struct SStepRow
+{
+	const float* Up;
+	const float* Row;
+	const float* Down;
+
+	// Holds the previous solution and receives the next one
+	float* Next;
+};
+
+struct SNormalRow
+{
+	const float* Up;
+	const float* Row;
+	const float* Down;
+	float* NormalX;
+	float* NormalY;
+	float* NormalZ;
+	float* TangentX;
+	float* TangentY;
+};
+
+// Same evaluation order as the scalar solver, the results do not depend on the lane width
+template<typename T>
+int32_t StepCells(const SStepRow& Row, int32_t J, int32_t Last, float K1, float K2, float K3)
+{
+	const T k1 = Splat(T{}, K1);
+	const T k2 = Splat(T{}, K2);
+	const T k3 = Splat(T{}, K3);
+	for (; J + T::Width <= Last; J += T::Width)
 	{
-		float z = halfDepth - i * dx;
-		for (int j = 0; j < N; j++)
-		{
-			float x = -halfWidth + j * dx;
+		const T neighbours = Load(T{}, Row.Down + J) + Load(T{}, Row.Up + J) + Load(T{}, Row.Row + J + 1) + Load(T{}, Row.Row + J - 1);
+		Store(Row.Next + J, k1 * Load(T{}, Row.Next + J) + k2 * Load(T{}, Row.Row + J) + k3 * neighbours);
+	}
+	return J;
+}
+
+template<typename T>
+int32_t NormalCells(const SNormalRow& Row, int32_t J, int32_t Last, float SpatialStep)
+{
+	const T twoDx = Splat(T{}, 2.0f * SpatialStep);
+	for (; J + T::Width <= Last; J += T::Width)
+	{
+		const T l = Load(T{}, Row.Row + J - 1);
+		const T r = Load(T{}, Row.Row + J + 1);
+		const T nx = l - r;
+		const T nz = Load(T{}, Row.Down + J) - Load(T{}, Row.Up + J);
+		const T normalLength = Sqrt(nx * nx + twoDx * twoDx + nz * nz);
+		Store(Row.NormalX + J, nx / normalLength);
+		Store(Row.NormalY + J, twoDx / normalLength);
+		Store(Row.NormalZ + J, nz / normalLength);
+
+		const T ty = r - l;
+		const T tangentLength = Sqrt(twoDx * twoDx + ty * ty);
+		Store(Row.TangentX + J, twoDx / tangentLength);
+		Store(Row.TangentY + J, ty / tangentLength);
+	}
+	return J;
+}
+
+void StepRow(const SStepRow& Row, int32_t NumCols, float K1, float K2, float K3)
+{
+	int32_t j = 1;
+#if WAVES_AVX
+	j = StepCells<SLanes8>(Row, j, NumCols - 1, K1, K2, K3);
+#endif
+#if WAVES_SSE
+	j = StepCells<SLanes4>(Row, j, NumCols - 1, K1, K2, K3);
+#endif
+	StepCells<SLanes1>(Row, j, NumCols - 1, K1, K2, K3);
+}
+
+void NormalRow(const SNormalRow& Row, int32_t NumCols, float SpatialStep)
+{
+	int32_t j = 1;
+#if WAVES_AVX
+	j = NormalCells<SLanes8>(Row, j, NumCols - 1, SpatialStep);
+#endif
+#if WAVES_SSE
+	j = NormalCells<SLanes4>(Row, j, NumCols - 1, SpatialStep);
+#endif
+	NormalCells<SLanes1>(Row, j, NumCols - 1, SpatialStep);
+}
 
-			PrevSolution[i * N + j] = { x, 0.0f, z };
-			CurrentSolution[i * N + j] = { x, 0.0f, z };
-			Normals[i * N + j] = { 0.0f, 1.0f, 0.0f };
-			TangentX[i * N + j] = { 1.0f, 0.0f, 0.0f };
+// Items are taken one at a time by the calling thread and NumThreads - 1 helpers
+template<typename TFunction>
+void ParallelFor(uint32_t NumItems, uint32_t NumThreads, const TFunction& Function)
+{
+	std::atomic<uint32_t> nextItem = 0;
+	auto work = [&]() {
+		for (uint32_t item = nextItem++; item < NumItems; item = nextItem++)
+		{
+			Function(item);
 		}
+	};
+
+	std::vector<std::future<void>> futures;
+	for (uint32_t thread = 1; thread < NumThreads; thread++)
+	{
+		futures.push_back(std::async(std::launch::async, work));
+	}
+	work();
+	for (auto& future : futures)
+	{
+		future.get();
 	}
 }
+} // namespace
+
+OWaves::OWaves(int32_t M, int32_t N, float Dx, float Dt, float Speed, float Damping)
+{
+	NumRows = M;
+	NumCols = N;
+
+	VertexCount = M * N;
+	TriangleCount = (M - 1) * (N - 1) * 2;
+
+	TimeStep = Dt;
+	SpatialStep = Dx;
+
+	float d = Damping * Dt + 2.0f;
+	float e = (Speed * Speed) * (Dt * Dt) / (Dx * Dx);
+
+	K1 = (Damping * Dt - 2.0f) / d;
+	K2 = (4.0f - 8.0f * e) / d;
+	K3 = (2.0f * e) / d;
+
+	Previous.assign(VertexCount, 0.0f);
+	Current.assign(VertexCount, 0.0f);
+	NormalX.assign(VertexCount, 0.0f);
+	NormalY.assign(VertexCount, 1.0f);
+	NormalZ.assign(VertexCount, 0.0f);
+	TangentX.assign(VertexCount, 1.0f);
+	TangentY.assign(VertexCount, 0.0f);
+}
 
 int32_t OWaves::GetRowCount() const
 {
@@ -66,7 +324,6 @@ int32_t OWaves::GetVertexCount() const
 int32_t OWaves::GetTriangleCount() const
 {
 	return TriangleCount;
-	;
 }
 
 float OWaves::GetWidth() const
@@ -79,109 +336,125 @@ float OWaves::GetDepth() const
 	return NumRows * SpatialStep;
 }
 
-const DirectX::XMFLOAT3& OWaves::GetPosition(int32_t I) const
+std::array<float, 3> OWaves::GetPosition(int32_t I) const
 {
-	return CurrentSolution[I];
+	const float halfWidth = (NumCols - 1) * SpatialStep * 0.5f;
+	const float halfDepth = (NumRows - 1) * SpatialStep * 0.5f;
+	return { -halfWidth + (I % NumCols) * SpatialStep, Current[I], halfDepth - (I / NumCols) * SpatialStep };
 }
 
-const DirectX::XMFLOAT3& OWaves::GetNormal(int32_t I) const
+std::array<float, 3> OWaves::GetNormal(int32_t I) const
 {
-	return Normals[I];
+	return { NormalX[I], NormalY[I], NormalZ[I] };
 }
 
-const DirectX::XMFLOAT3& OWaves::GetTangentX(int32_t I) const
+std::array<float, 3> OWaves::GetTangentX(int32_t I) const
 {
-	return TangentX[I];
+	return { TangentX[I], TangentY[I], 0.0f };
 }
 
-void OWaves::Update(float dt)
+void OWaves::Update(float Dt)
 {
-	static float t = 0;
+	const auto start = TClock::now();
+	Accumulator += Dt;
+	const auto numSteps = static_cast<uint32_t>(Accumulator / TimeStep);
+	Accumulator -= numSteps * TimeStep;
+
+	// Time past the last substep is dropped so a long frame does not make the next one longer
+	Stats.NumSteps = std::min(numSteps, MaxSubsteps);
+	Stats.NumDroppedSteps = numSteps - Stats.NumSteps;
+	Stats.NumThreads = 0;
+	for (uint32_t step = 0; step < Stats.NumSteps; step++)
+	{
+		Step(step + 1 == Stats.NumSteps);
+	}
+	Stats.Milliseconds = std::chrono::duration<float, std::milli>(TClock::now() - start).count();
+}
+
+void OWaves::Step(bool bComputeNormals)
+{
+	// Only interior rows are updated, the tiles cover rows 1 to NumRows - 2
+	const int32_t numInterior = NumRows - 2;
+	if (numInterior <= 0 || NumCols < 3)
+	{
+		return;
+	}
+
+	const int32_t rowsPerTile = std::max(RowsPerTile, 1);
+	const auto numTiles = static_cast<uint32_t>((numInterior + rowsPerTile - 1) / rowsPerTile);
+	const uint32_t maxThreads = NumThreads > 0 ? NumThreads : std::max(std::thread::hardware_concurrency(), 1u);
+	const uint32_t numThreads = std::clamp(static_cast<uint32_t>(numInterior) / std::max(MinRowsPerThread, 1u), 1u, std::min(maxThreads, numTiles));
+	Stats.NumThreads = numThreads;
+
+	// The next solution overwrites the previous one in place, prev_ij is read last
+	const float* current = Current.data();
+	float* next = Previous.data();
+	auto normalRow = [&](const float* Heights, int32_t I) {
+		const size_t row = static_cast<size_t>(I) * NumCols;
+		const SNormalRow normal{ Heights + row - NumCols, Heights + row, Heights + row + NumCols, NormalX.data() + row, NormalY.data() + row, NormalZ.data() + row, TangentX.data() + row, TangentY.data() + row };
+		NormalRow(normal, NumCols, SpatialStep);
+	};
+	auto tileRows = [&](uint32_t Tile) {
+		const int32_t first = 1 + static_cast<int32_t>(Tile) * rowsPerTile;
+		return std::pair{ first, std::min(first + rowsPerTile, NumRows - 1) };
+	};
+
+	ParallelFor(numTiles, numThreads, [&](uint32_t Tile) {
+		const auto [first, last] = tileRows(Tile);
+		for (int32_t i = first; i < last; i++)
+		{
+			const size_t row = static_cast<size_t>(i) * NumCols;
+			StepRow({ current + row - NumCols, current + row, current + row + NumCols, next + row }, NumCols, K1, K2, K3);
+
+			// A row is final once the row below it is, the first row of the tile waits for the tile above
+			if (bComputeNormals && i - 1 > first)
+			{
+				normalRow(next, i - 1);
+			}
+		}
+	});
 
-	t += dt;
+	// We just overwrote the previous buffer with the new data, so
+	// this data needs to become the current solution and the old
+	// current solution becomes the new previous solution.
+	std::swap(Previous, Current);
 
-	// Only update the simulation at the specified time step.
-	if (t >= TimeStep)
+	if (bComputeNormals)
 	{
-		// Only update interior points; we use zero boundary conditions.
-		concurrency::parallel_for(1,
-		                          NumRows - 1,
-		                          [this](int32_t I) {
-			                          for (int32_t j = 1; j < NumCols - 1; ++j)
-			                          {
-				                          // After this update we will be discarding the old previous
-				                          // buffer, so overwrite that buffer with the new update.
-				                          // Note how we can do this inplace (read/write to same element)
-				                          // because we won't need prev_ij again and the assignment happens last.
-
-				                          // Note j indexes x and i indexes z: h(x_j, z_i, t_k)
-				                          // Moreover, our +z axis goes "down"; this is just to
-				                          // keep consistent with our row indices going down.
-
-				                          PrevSolution[I * NumCols + j].y = K1 * PrevSolution[I * NumCols + j].y + K2 * CurrentSolution[I * NumCols + j].y + K3 * (CurrentSolution[(I + 1) * NumCols + j].y + CurrentSolution[(I - 1) * NumCols + j].y + CurrentSolution[I * NumCols + j + 1].y + CurrentSolution[I * NumCols + j - 1].y); // The new value depends on the old value and its four neighbors
-			                          }
-		                          });
-
-		// We just overwrote the previous buffer with the new data, so
-		// this data needs to become the current solution and the old
-		// current solution becomes the new previous solution.
-
-		std::swap(PrevSolution, CurrentSolution);
-		t = 0.0;
-
-		//
-		// Compute normals using finite difference scheme.
-		//
-		concurrency::parallel_for(1,
-		                          NumRows - 1,
-		                          [this](int32_t I) {
-			                          for (int32_t j = 1; j < NumCols - 1; ++j)
-			                          {
-				                          float l = CurrentSolution[I * NumCols + j - 1].y;
-				                          float r = CurrentSolution[I * NumCols + j + 1].y;
-				                          float t = CurrentSolution[(I - 1) * NumCols + j].y;
-				                          float b = CurrentSolution[(I + 1) * NumCols + j].y;
-
-				                          Normals[I * NumCols + j].x = -r + l;
-				                          Normals[I * NumCols + j].y = 2.0f * SpatialStep;
-				                          Normals[I * NumCols + j].z = b - t;
-
-				                          DirectX::XMVECTOR n = DirectX::XMVector3Normalize(XMLoadFloat3(&Normals[I * NumCols + j]));
-				                          XMStoreFloat3(&Normals[I * NumCols + j], n);
-
-				                          TangentX[I * NumCols + j] = { 2.0f * SpatialStep, r - l, 0.0f };
-				                          DirectX::XMVECTOR T = DirectX::XMVector3Normalize(XMLoadFloat3(&TangentX[I * NumCols + j]));
-				                          XMStoreFloat3(&TangentX[I * NumCols + j], T);
-			                          }
-		                          });
+		ParallelFor(numTiles, numThreads, [&](uint32_t Tile) {
+			const auto [first, last] = tileRows(Tile);
+			normalRow(Current.data(), first);
+			if (last - 1 > first)
+			{
+				normalRow(Current.data(), last - 1);
+			}
+		});
 	}
 }
 
 void OWaves::Disturb(int32_t I, int32_t J, float Magnitude, float Radius)
 {
-	CHECK_MSG(I > 1 && I < NumRows - 2, "I is out of bounds");
-	CHECK_MSG(J > 1 && J < NumCols - 2, "J is out of bounds");
-	CurrentSolution[I * NumCols + J].y += Magnitude;
+	if (I <= 1 || I >= NumRows - 2 || J <= 1 || J >= NumCols - 2)
+	{
+		throw std::runtime_error("Disturbed point is out of bounds");
+	}
+	Current[I * NumCols + J] += Magnitude;
 
-	float HalfMag = Magnitude;
+	float halfMagnitude = Magnitude;
 	for (int i = 1; i < Radius; ++i)
 	{
-		HalfMag *= 0.7;
+		halfMagnitude = static_cast<float>(halfMagnitude * 0.7);
 		const auto right = I * NumCols + J + i;
 		const auto left = I * NumCols + J - i;
 		const auto up = (I + i) * NumCols + J;
 		const auto down = (I - i) * NumCols + J;
 
-		if (right > 0 && right < CurrentSolution.size())
-			CurrentSolution[right].y += HalfMag;
-
-		if (left > 0 && left < CurrentSolution.size())
-			CurrentSolution[left].y += HalfMag;
-
-		if (up > 0 && up < CurrentSolution.size())
-			CurrentSolution[up].y += HalfMag;
-
-		if (down > 0 && down < CurrentSolution.size())
-			CurrentSolution[down].y += HalfMag;
+		for (const auto idx : { right, left, up, down })
+		{
+			if (idx > 0 && idx < VertexCount)
+			{
+				Current[idx] += halfMagnitude;
+			}
+		}
 	}
 }
@@ -1,20 +1,34 @@
 #pragma once
-#include <DirectXColors.h>
-#include <Types.h>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Height field waves on an M x N grid with zero boundary conditions, j indexes x and i indexes z.
+ * Heights, normals and x tangents are stored as structure of arrays, one row after the other. Update advances every
+ * instance in fixed time steps of its own, with at most MaxSubsteps steps per call. Rows are cut in tiles that are
+ * shared between threads, the normals of the last step are computed while the tile is still in cache. No D3D dependencies.
+ */
+
+struct SWaveStats
+{
+	uint32_t NumSteps = 0;
+
+	// Steps skipped because the frame took longer than MaxSubsteps steps
+	uint32_t NumDroppedSteps = 0;
+	uint32_t NumThreads = 0;
+	float Milliseconds = 0.0f;
+};
 
 class OWaves
 {
 public:
-	OWaves(int32_t M, int32_t N, float dx, float dt, float Speed, float Damping);
+	OWaves(int32_t M, int32_t N, float Dx, float Dt, float Speed, float Damping);
 
 	OWaves(const OWaves& rhs) = delete;
 
 	OWaves& operator=(const OWaves& rhs) = delete;
 
-	~OWaves()
-	{
-	}
-
 	int32_t GetRowCount() const;
 
 	int32_t GetColumnCount() const;
@@ -28,19 +42,35 @@ public:
 	float GetDepth() const;
 
 	// Returns the solution at the ith grid point.
-	const DirectX::XMFLOAT3& GetPosition(int32_t I) const;
+	std::array<float, 3> GetPosition(int32_t I) const;
 
 	// Returns the solution normal at the ith grid point.
-	const DirectX::XMFLOAT3& GetNormal(int32_t I) const;
+	std::array<float, 3> GetNormal(int32_t I) const;
 
 	// Returns the unit tangent vector at the ith grid point in the local x-axis direction.
-	const DirectX::XMFLOAT3& GetTangentX(int32_t I) const;
+	std::array<float, 3> GetTangentX(int32_t I) const;
 
-	void Update(float dt);
+	const float* GetHeights() const { return Current.data(); }
+
+	void Update(float Dt);
 
 	void Disturb(int32_t I, int32_t J, float Magnitude, float Radius = 50);
 
+	/** @brief Result of the last Update */
+	const SWaveStats& GetStats() const { return Stats; }
+
+	// 0 - use all hardware threads
+	uint32_t NumThreads = 0;
+
+	// Grid rows under which a step stays on the calling thread
+	uint32_t MinRowsPerThread = 256;
+
+	int32_t RowsPerTile = 32;
+	uint32_t MaxSubsteps = 4;
+
 private:
+	void Step(bool bComputeNormals);
+
 	int32_t NumRows;
 	int32_t NumCols;
 
@@ -53,12 +83,17 @@ private:
 
 	float TimeStep = 0.0f;
 	float SpatialStep = 0.0f;
+	float Accumulator = 0.0f;
 
-	vector<DirectX::XMFLOAT3> PrevSolution;
-	vector<DirectX::XMFLOAT3> CurrentSolution;
-	vector<DirectX::XMFLOAT3> Normals;
-	vector<DirectX::XMFLOAT3> TangentX;
-};
-
+	std::vector<float> Previous;
+	std::vector<float> Current;
+	std::vector<float> NormalX;
+	std::vector<float> NormalY;
+	std::vector<float> NormalZ;
 
+	// The tangent lies in the xy plane
+	std::vector<float> TangentX;
+	std::vector<float> TangentY;
 
+	SWaveStats Stats;
+};
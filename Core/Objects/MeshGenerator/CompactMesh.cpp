@@ -0,0 +1,100 @@
+#include "CompactMesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+constexpr float MaxQuantized = std::numeric_limits<uint16_t>::max();
+} // namespace
+
+void OCompactMesh::Build(const float* SourcePositions, uint32_t NumVertices, const uint32_t* SourceIndices, uint32_t NumSourceIndices)
+{
+	std::array<float, 3> max;
+	Min.fill(std::numeric_limits<float>::max());
+	max.fill(std::numeric_limits<float>::lowest());
+	for (uint32_t vertex = 0; vertex < NumVertices; vertex++)
+	{
+		for (uint32_t axis = 0; axis < 3; axis++)
+		{
+			Min[axis] = std::min(Min[axis], SourcePositions[vertex * 3 + axis]);
+			max[axis] = std::max(max[axis], SourcePositions[vertex * 3 + axis]);
+		}
+	}
+	for (uint32_t axis = 0; axis < 3; axis++)
+	{
+		if (NumVertices == 0)
+		{
+			Min[axis] = 0.0f;
+			max[axis] = 0.0f;
+		}
+		Step[axis] = (max[axis] - Min[axis]) / MaxQuantized;
+	}
+
+	Positions.resize(static_cast<size_t>(NumVertices) * 3);
+	for (uint32_t vertex = 0; vertex < NumVertices; vertex++)
+	{
+		for (uint32_t axis = 0; axis < 3; axis++)
+		{
+			const float offset = Step[axis] > 0.0f ? (SourcePositions[vertex * 3 + axis] - Min[axis]) / Step[axis] : 0.0f;
+			Positions[vertex * 3 + axis] = static_cast<uint16_t>(std::clamp(std::lround(offset), 0L, static_cast<long>(MaxQuantized)));
+		}
+	}
+
+	NumIndices = NumSourceIndices;
+	Indices16.clear();
+	Indices32.clear();
+	if (NumVertices <= std::numeric_limits<uint16_t>::max() + 1u)
+	{
+		Indices16.assign(SourceIndices, SourceIndices + NumSourceIndices);
+	}
+	else
+	{
+		Indices32.assign(SourceIndices, SourceIndices + NumSourceIndices);
+	}
+}
+
+std::array<float, 3> OCompactMesh::GetPosition(uint32_t Vertex) const
+{
+	std::array<float, 3> result;
+	for (uint32_t axis = 0; axis < 3; axis++)
+	{
+		result[axis] = Min[axis] + Positions[Vertex * 3 + axis] * Step[axis];
+	}
+	return result;
+}
+
+void OCompactMesh::Decode(std::vector<float>& OutPositions, std::vector<uint32_t>& OutIndices) const
+{
+	OutPositions.resize(Positions.size());
+	for (size_t idx = 0; idx < Positions.size(); idx++)
+	{
+		OutPositions[idx] = Min[idx % 3] + Positions[idx] * Step[idx % 3];
+	}
+	if (Indices32.empty())
+	{
+		OutIndices.assign(Indices16.begin(), Indices16.end());
+	}
+	else
+	{
+		OutIndices = Indices32;
+	}
+}
+
+std::array<float, 3> OCompactMesh::GetMaxError() const
+{
+	// Half a step from the quantization, a few ulps of the bounds from encoding and decoding in float
+	std::array<float, 3> result;
+	for (uint32_t axis = 0; axis < 3; axis++)
+	{
+		const float bounds = std::abs(Min[axis]) + Step[axis] * MaxQuantized;
+		result[axis] = Step[axis] * 0.5f + bounds * std::numeric_limits<float>::epsilon() * 4.0f;
+	}
+	return result;
+}
+
+uint64_t OCompactMesh::GetByteSize() const
+{
+	return sizeof(OCompactMesh) + Positions.capacity() * sizeof(uint16_t) + Indices16.capacity() * sizeof(uint16_t) + Indices32.capacity() * sizeof(uint32_t);
+}
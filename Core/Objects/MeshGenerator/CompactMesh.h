@@ -0,0 +1,38 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Positions and indices of a submesh for picking and occlusion. Positions are quantized to 16 bits per axis inside their
+ * bounds, indices take 16 bits while the vertices fit. A decoded position is about half a quantization step away from
+ * the original on every axis at most. No D3D dependencies.
+ */
+class OCompactMesh
+{
+public:
+	/** @brief Positions are xyz triples */
+	void Build(const float* SourcePositions, uint32_t NumVertices, const uint32_t* SourceIndices, uint32_t NumSourceIndices);
+
+	uint32_t GetNumVertices() const { return static_cast<uint32_t>(Positions.size() / 3); }
+	uint32_t GetNumIndices() const { return NumIndices; }
+
+	std::array<float, 3> GetPosition(uint32_t Vertex) const;
+	uint32_t GetIndex(uint32_t Index) const { return Indices32.empty() ? Indices16[Index] : Indices32[Index]; }
+
+	/** @brief Replaces the content of the vectors, positions are written as xyz triples */
+	void Decode(std::vector<float>& OutPositions, std::vector<uint32_t>& OutIndices) const;
+
+	/** @brief Largest distance between a decoded position and the original on every axis, float rounding included */
+	std::array<float, 3> GetMaxError() const;
+
+	uint64_t GetByteSize() const;
+
+private:
+	std::array<float, 3> Min = {};
+	std::array<float, 3> Step = {};
+	std::vector<uint16_t> Positions;
+	std::vector<uint16_t> Indices16;
+	std::vector<uint32_t> Indices32;
+	uint32_t NumIndices = 0;
+};
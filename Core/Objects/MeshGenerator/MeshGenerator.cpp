@@ -1,8 +1,8 @@
 
 #include "MeshGenerator.h"
 
-#include "CommandQueue/CommandQueue.h"
 #include "DirectX/Vertex.h"
+#include "Engine/UploadBuffer/UploadManager.h"
 #include "EngineHelper.h"
 #include "Logger.h"
 #include "MeshPayload.h"
@@ -90,13 +90,25 @@ unique_ptr<SMeshGeometry> OMeshGenerator::CreateMesh(const SMeshPayloadData& Dat
 		submesh->Vertices = make_unique<vector<XMFLOAT3>>(std::move(positions));
 		submesh->Indices = make_unique<vector<std::uint32_t>>(payload.Indices32);
 		submesh->IndexCount = payload.Indices32.size();
-		submesh->StartIndexLocation = vertCounter;
-		submesh->BaseVertexLocation = indexCounter;
+		submesh->StartIndexLocation = indexCounter;
+		submesh->BaseVertexLocation = vertCounter;
 		submesh->Name = payload.Name;
 		submesh->Material = CreateMaterial(payload.Material);
 		vertCounter += payload.Vertices.size();
 		indexCounter += payload.Indices32.size();
 		indices.insert(indices.end(), payload.Indices32.begin(), payload.Indices32.end());
+
+		// LODs follow the submesh in the index buffer and share its base vertex
+		const float radius = XMVectorGetX(XMVector3Length(XMLoadFloat3(&bounds.Extents)));
+		for (size_t lod = 0; lod < payload.LODs.size() && lod < SSubmeshGeometry::MaxLODs; lod++)
+		{
+			const auto& lodIndices = payload.LODs[lod].Indices;
+			submesh->LODs.push_back({ .IndexCount = static_cast<UINT>(lodIndices.size()),
+			                          .StartIndexLocation = static_cast<UINT>(indexCounter),
+			                          .Error = radius > 0.0f ? payload.LODs[lod].Error / radius : 0.0f });
+			indexCounter += lodIndices.size();
+			indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+		}
 		geo->SetGeometry(payload.Name, submesh);
 		numMeshes++;
 		LOG(Geometry, Log, "Mesh: {} has been created! Remaining Meshes: {}", TEXT(payload.Name), TEXT(Data.Data.size() - numMeshes));
@@ -111,22 +123,14 @@ unique_ptr<SMeshGeometry> OMeshGenerator::CreateMesh(const SMeshPayloadData& Dat
 	THROW_IF_FAILED(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
 	CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
 
-	geo->VertexBufferGPU = Utils::CreateDefaultBuffer(Device,
-	                                                  CommandQueue->GetCommandList().Get(),
-	                                                  vertices.data(),
-	                                                  vbByteSize,
-	                                                  geo->VertexBufferUploader);
-
-	geo->IndexBufferGPU = Utils::CreateDefaultBuffer(Device,
-	                                                 CommandQueue->GetCommandList().Get(),
-	                                                 indices.data(),
-	                                                 ibByteSize,
-	                                                 geo->IndexBufferUploader);
+	geo->VertexBufferGPU = Uploads->CreateDefaultBuffer(vertices.data(), vbByteSize);
+	geo->IndexBufferGPU = Uploads->CreateDefaultBuffer(indices.data(), ibByteSize, &geo->UploadTicket);
 
 	geo->VertexByteStride = sizeof(SVertex);
 	geo->VertexBufferByteSize = vbByteSize;
 	geo->IndexFormat = DXGI_FORMAT_R32_UINT;
 	geo->IndexBufferByteSize = ibByteSize;
+	geo->SetResidency(Residency);
 	return move(geo);
 }
 
@@ -139,11 +143,28 @@ unique_ptr<SMeshGeometry> OMeshGenerator::CreateMesh(const string& Name, const O
 		.TotalIndices = Data.Indices32.size()
 	};
 	payload.Data[0].Name = Name;
+	GenerateLODs(payload);
 	return CreateMesh(payload);
 }
 
 unique_ptr<SMeshGeometry> OMeshGenerator::CreateMesh(const string& Name, const wstring& Path, const EParserType Parser, ETextureMapType GenTexels)
 {
+	SMeshPayloadData meshData;
+	if (ParseMesh(Name, Path, Parser, GenTexels, meshData))
+	{
+		OptimizeMesh(meshData);
+		GenerateLODs(meshData);
+		return CreateMesh(meshData);
+	}
+	else
+	{
+		return nullptr;
+	}
+}
+
+bool OMeshGenerator::ParseMesh(const string& Name, const wstring& Path, EParserType Parser, ETextureMapType GenTexels, SMeshPayloadData& OutData)
+{
+	PROFILE_SCOPE();
 	unique_ptr<IMeshParser> parser = nullptr;
 	switch (Parser)
 	{
@@ -153,16 +174,81 @@ unique_ptr<SMeshGeometry> OMeshGenerator::CreateMesh(const string& Name, const w
 	case EParserType::TinyObjLoader:
 		parser = IMeshParser::CreateParser<OTinyObjParser>();
 	}
-	SMeshPayloadData meshData;
-	meshData.Name = Name;
-	const bool successful = parser->ParseMesh(Path, meshData, GenTexels);
+	OutData.Name = Name;
+	const bool successful = parser->ParseMesh(Path, OutData, GenTexels);
 	CWIN_LOG(!successful, Geometry, Error, "Failed to parse the mesh: {}", Path);
-	if (successful)
+	return successful;
+}
+
+void OMeshGenerator::OptimizeMesh(SMeshPayloadData& Data)
+{
+	PROFILE_SCOPE();
+	using TVertex = OGeometryGenerator::SGeometryExtendedVertex;
+	static_assert(sizeof(TVertex) == 11 * sizeof(float));
+
+	struct SVertexKey
 	{
-		return CreateMesh(meshData);
+		const TVertex* Vertex;
+		bool operator==(const SVertexKey& Other) const { return memcmp(Vertex, Other.Vertex, sizeof(TVertex)) == 0; }
+	};
+	struct SVertexHash
+	{
+		size_t operator()(const SVertexKey& Key) const
+		{
+			uint32_t words[11];
+			memcpy(words, Key.Vertex, sizeof(words));
+			size_t hash = 0xcbf29ce484222325ull;
+			for (const auto word : words)
+			{
+				hash = (hash ^ word) * 0x100000001b3ull;
+			}
+			return hash;
+		}
+	};
+
+	Data.TotalVertices = 0;
+	for (auto& mesh : Data.Data)
+	{
+		std::unordered_map<SVertexKey, uint32_t, SVertexHash> unique;
+		unique.reserve(mesh.Vertices.size());
+		vector<TVertex> vertices;
+		vertices.reserve(mesh.Vertices.size());
+		vector<uint32_t> remap(mesh.Vertices.size());
+
+		// Keys point into the source array, it stays untouched until the end
+		for (size_t i = 0; i < mesh.Vertices.size(); i++)
+		{
+			auto [it, inserted] = unique.try_emplace(SVertexKey{ &mesh.Vertices[i] }, static_cast<uint32_t>(vertices.size()));
+			if (inserted)
+			{
+				vertices.push_back(mesh.Vertices[i]);
+			}
+			remap[i] = it->second;
+		}
+
+		for (auto& index : mesh.Indices32)
+		{
+			index = remap[index];
+		}
+		mesh.Vertices = std::move(vertices);
+		Data.TotalVertices += mesh.Vertices.size();
 	}
-	else
+}
+
+void OMeshGenerator::GenerateLODs(SMeshPayloadData& Data, const SLODChainSettings& Settings)
+{
+	PROFILE_SCOPE();
+	using TVertex = OGeometryGenerator::SGeometryExtendedVertex;
+	for (auto& mesh : Data.Data)
 	{
-		return nullptr;
+		if (mesh.Vertices.empty())
+		{
+			continue;
+		}
+		mesh.LODs = MeshSimplifier::BuildLODChain(&mesh.Vertices[0].Position.x, mesh.Vertices.size(), sizeof(TVertex), mesh.Indices32.data(), mesh.Indices32.size(), Settings);
+		for (const auto& lod : mesh.LODs)
+		{
+			Data.TotalIndices += lod.Indices.size();
+		}
 	}
 }
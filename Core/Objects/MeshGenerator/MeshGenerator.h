@@ -4,7 +4,7 @@
 #include "DirectX/DXHelper.h"
 
 struct SMeshPayloadData;
-class OCommandQueue;
+class OUploadManager;
 enum class EParserType
 {
 	Custom,
@@ -14,9 +14,8 @@ enum class EParserType
 class OMeshGenerator
 {
 public:
-	OMeshGenerator(ID3D12Device* Device, OCommandQueue* CommandList)
-	    : Device(Device)
-	    , CommandQueue(CommandList)
+	explicit OMeshGenerator(OUploadManager* Uploads)
+	    : Uploads(Uploads)
 	{
 	}
 	unique_ptr<SMeshGeometry> CreateCubeMesh(string Name, float Width, float Height, float Depth, uint32_t NumSubdivisions);
@@ -31,8 +30,19 @@ public:
 	unique_ptr<SMeshGeometry> CreateMesh(const string& Name, const OGeometryGenerator::SMeshData& Data) const;
 	unique_ptr<SMeshGeometry> CreateMesh(const string& Name, const wstring& Path, EParserType Parser, ETextureMapType GenTexels);
 
+	// CPU half of the mesh import, no device access so it can run on a worker thread
+	static bool ParseMesh(const string& Name, const wstring& Path, EParserType Parser, ETextureMapType GenTexels, SMeshPayloadData& OutData);
+
+	// Welds duplicated vertices of every submesh and rebuilds the indices
+	static void OptimizeMesh(SMeshPayloadData& Data);
+
+	// Simplified index buffers for every submesh, run after OptimizeMesh so the seams are real attribute seams
+	static void GenerateLODs(SMeshPayloadData& Data, const SLODChainSettings& Settings = {});
+
+	// CPU geometry new meshes keep once their buffers are uploaded
+	EMeshResidency Residency = EMeshResidency::Compact;
+
 private:
 	OGeometryGenerator Generator;
-	ID3D12Device* Device;
-	OCommandQueue* CommandQueue;
+	OUploadManager* Uploads;
 };
@@ -0,0 +1,386 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+struct SVector3
+{
+	double X = 0, Y = 0, Z = 0;
+
+	SVector3 operator-(const SVector3& Other) const { return { X - Other.X, Y - Other.Y, Z - Other.Z }; }
+	double Dot(const SVector3& Other) const { return X * Other.X + Y * Other.Y + Z * Other.Z; }
+	SVector3 Cross(const SVector3& Other) const { return { Y * Other.Z - Z * Other.Y, Z * Other.X - X * Other.Z, X * Other.Y - Y * Other.X }; }
+	double Length() const { return std::sqrt(Dot(*this)); }
+};
+
+// Area weighted sum of squared distances to the planes of the triangles around a vertex
+struct SQuadric
+{
+	double A00 = 0, A01 = 0, A02 = 0, A11 = 0, A12 = 0, A22 = 0;
+	double B0 = 0, B1 = 0, B2 = 0;
+	double C = 0;
+	double Weight = 0;
+
+	void AddPlane(const SVector3& Normal, double Distance, double InWeight)
+	{
+		A00 += InWeight * Normal.X * Normal.X;
+		A01 += InWeight * Normal.X * Normal.Y;
+		A02 += InWeight * Normal.X * Normal.Z;
+		A11 += InWeight * Normal.Y * Normal.Y;
+		A12 += InWeight * Normal.Y * Normal.Z;
+		A22 += InWeight * Normal.Z * Normal.Z;
+		B0 += InWeight * Normal.X * Distance;
+		B1 += InWeight * Normal.Y * Distance;
+		B2 += InWeight * Normal.Z * Distance;
+		C += InWeight * Distance * Distance;
+		Weight += InWeight;
+	}
+
+	void Add(const SQuadric& Other)
+	{
+		A00 += Other.A00;
+		A01 += Other.A01;
+		A02 += Other.A02;
+		A11 += Other.A11;
+		A12 += Other.A12;
+		A22 += Other.A22;
+		B0 += Other.B0;
+		B1 += Other.B1;
+		B2 += Other.B2;
+		C += Other.C;
+		Weight += Other.Weight;
+	}
+
+	double Evaluate(const SVector3& P) const
+	{
+		const double rx = A00 * P.X + A01 * P.Y + A02 * P.Z;
+		const double ry = A01 * P.X + A11 * P.Y + A12 * P.Z;
+		const double rz = A02 * P.X + A12 * P.Y + A22 * P.Z;
+		return rx * P.X + ry * P.Y + rz * P.Z + 2.0 * (B0 * P.X + B1 * P.Y + B2 * P.Z) + C;
+	}
+};
+
+struct SCollapse
+{
+	uint32_t From;
+	uint32_t To;
+	double Cost;
+};
+
+struct SPositionKey
+{
+	uint32_t Bits[3];
+	bool operator==(const SPositionKey& Other) const { return std::memcmp(Bits, Other.Bits, sizeof(Bits)) == 0; }
+};
+
+struct SPositionHash
+{
+	size_t operator()(const SPositionKey& Key) const
+	{
+		size_t hash = 0xcbf29ce484222325ull;
+		for (const auto bits : Key.Bits)
+		{
+			hash = (hash ^ bits) * 0x100000001b3ull;
+		}
+		return hash;
+	}
+};
+
+SVector3 LoadPosition(const float* Positions, size_t Stride, uint32_t Index)
+{
+	float position[3];
+	std::memcpy(position, reinterpret_cast<const uint8_t*>(Positions) + Index * Stride, sizeof(position));
+	return { position[0], position[1], position[2] };
+}
+
+uint64_t GetEdgeKey(uint32_t A, uint32_t B)
+{
+	return A < B ? (static_cast<uint64_t>(A) << 32) | B : (static_cast<uint64_t>(B) << 32) | A;
+}
+} // namespace
+
+float MeshSimplifier::Simplify(const float* Positions, size_t NumVertices, size_t PositionStride, const uint32_t* Indices, size_t NumIndices, size_t TargetIndexCount, float MaxError, std::vector<uint32_t>& OutIndices)
+{
+	OutIndices.assign(Indices, Indices + NumIndices - NumIndices % 3);
+	for (const auto index : OutIndices)
+	{
+		if (index >= NumVertices)
+		{
+			return 0.0f;
+		}
+	}
+
+	// Vertices sharing a position collapse as one, the first vertex of the position stands for all of them
+	std::vector<uint32_t> canonical(NumVertices);
+	std::vector<SVector3> positions(NumVertices);
+	{
+		std::unordered_map<SPositionKey, uint32_t, SPositionHash> unique;
+		unique.reserve(NumVertices);
+		for (uint32_t i = 0; i < NumVertices; i++)
+		{
+			SPositionKey key;
+			std::memcpy(key.Bits, reinterpret_cast<const uint8_t*>(Positions) + i * PositionStride, sizeof(key.Bits));
+			canonical[i] = unique.try_emplace(key, i).first->second;
+			positions[i] = LoadPosition(Positions, PositionStride, i);
+		}
+	}
+
+	auto removeDegenerate = [&]() {
+		size_t write = 0;
+		for (size_t i = 0; i < OutIndices.size(); i += 3)
+		{
+			const uint32_t a = canonical[OutIndices[i]];
+			const uint32_t b = canonical[OutIndices[i + 1]];
+			const uint32_t c = canonical[OutIndices[i + 2]];
+			if (a != b && b != c && a != c)
+			{
+				std::memmove(&OutIndices[write], &OutIndices[i], 3 * sizeof(uint32_t));
+				write += 3;
+			}
+		}
+		OutIndices.resize(write);
+	};
+	removeDegenerate();
+
+	// Seams have several referenced vertices on one position, borders and non manifold edges are not shared by exactly two triangles
+	std::vector<uint8_t> locked(NumVertices, 0);
+	{
+		std::vector<uint32_t> representative(NumVertices, UINT32_MAX);
+		for (const auto index : OutIndices)
+		{
+			auto& first = representative[canonical[index]];
+			if (first == UINT32_MAX)
+			{
+				first = index;
+			}
+			else if (first != index)
+			{
+				locked[canonical[index]] = 1;
+			}
+		}
+
+		std::unordered_map<uint64_t, uint32_t> edges;
+		edges.reserve(OutIndices.size());
+		for (size_t i = 0; i < OutIndices.size(); i += 3)
+		{
+			for (int e = 0; e < 3; e++)
+			{
+				edges[GetEdgeKey(canonical[OutIndices[i + e]], canonical[OutIndices[i + (e + 1) % 3]])]++;
+			}
+		}
+		for (const auto& [key, count] : edges)
+		{
+			if (count != 2)
+			{
+				locked[key >> 32] = 1;
+				locked[key & 0xffffffff] = 1;
+			}
+		}
+	}
+
+	std::vector<SQuadric> quadrics(NumVertices);
+	for (size_t i = 0; i < OutIndices.size(); i += 3)
+	{
+		const uint32_t a = canonical[OutIndices[i]];
+		const uint32_t b = canonical[OutIndices[i + 1]];
+		const uint32_t c = canonical[OutIndices[i + 2]];
+		const SVector3 normal = (positions[b] - positions[a]).Cross(positions[c] - positions[a]);
+		const double length = normal.Length();
+		if (length <= 0.0)
+		{
+			continue;
+		}
+		const SVector3 unit = { normal.X / length, normal.Y / length, normal.Z / length };
+		const double distance = -unit.Dot(positions[a]);
+		const double area = 0.5 * length;
+		quadrics[a].AddPlane(unit, distance, area);
+		quadrics[b].AddPlane(unit, distance, area);
+		quadrics[c].AddPlane(unit, distance, area);
+	}
+
+	const double maxErrorSq = static_cast<double>(MaxError) * MaxError;
+	double resultErrorSq = 0.0;
+	std::vector<SCollapse> collapses;
+	std::vector<uint32_t> remap(NumVertices);
+	std::vector<uint8_t> touched(NumVertices);
+	std::vector<uint32_t> adjacencyOffsets(NumVertices + 1);
+	std::vector<uint32_t> adjacency;
+
+	while (OutIndices.size() > TargetIndexCount)
+	{
+		const size_t numTriangles = OutIndices.size() / 3;
+
+		// Interior edges are seen from both of their triangles with the opposite winding, that gives both directions
+		collapses.clear();
+		for (size_t i = 0; i < OutIndices.size(); i += 3)
+		{
+			for (int e = 0; e < 3; e++)
+			{
+				const uint32_t from = OutIndices[i + e];
+				const uint32_t to = OutIndices[i + (e + 1) % 3];
+				const uint32_t source = canonical[from];
+				const uint32_t target = canonical[to];
+				if (locked[source])
+				{
+					continue;
+				}
+				const double weight = quadrics[source].Weight + quadrics[target].Weight;
+				const double cost = quadrics[source].Evaluate(positions[target]) + quadrics[target].Evaluate(positions[target]);
+				collapses.push_back({ from, to, weight > 0.0 ? std::max(cost / weight, 0.0) : 0.0 });
+			}
+		}
+		std::ranges::sort(collapses, {}, &SCollapse::Cost);
+		if (collapses.empty() || collapses.front().Cost > maxErrorSq)
+		{
+			break;
+		}
+
+		// Triangles around every position
+		std::ranges::fill(adjacencyOffsets, 0);
+		for (const auto index : OutIndices)
+		{
+			adjacencyOffsets[canonical[index] + 1]++;
+		}
+		for (size_t i = 1; i < adjacencyOffsets.size(); i++)
+		{
+			adjacencyOffsets[i] += adjacencyOffsets[i - 1];
+		}
+		adjacency.resize(OutIndices.size());
+		{
+			std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < OutIndices.size(); i++)
+			{
+				adjacency[cursor[canonical[OutIndices[i]]]++] = static_cast<uint32_t>(i / 3);
+			}
+		}
+
+		// Greedy pass over the cheapest collapses, a position changes at most once per pass so the costs stay valid
+		for (uint32_t i = 0; i < NumVertices; i++)
+		{
+			remap[i] = i;
+		}
+		std::ranges::fill(touched, 0);
+		size_t numRemoved = 0;
+		size_t numCollapsed = 0;
+		for (const auto& collapse : collapses)
+		{
+			if (collapse.Cost > maxErrorSq || numTriangles - numRemoved <= TargetIndexCount / 3)
+			{
+				break;
+			}
+			const uint32_t source = canonical[collapse.From];
+			const uint32_t target = canonical[collapse.To];
+			if (touched[source] || touched[target])
+			{
+				continue;
+			}
+
+			// Moving the source onto the target must not flip any of the remaining triangles
+			bool bValid = true;
+			size_t numShared = 0;
+			for (uint32_t a = adjacencyOffsets[source]; a < adjacencyOffsets[source + 1] && bValid; a++)
+			{
+				const uint32_t* triangle = &OutIndices[static_cast<size_t>(adjacency[a]) * 3];
+				SVector3 corners[3];
+				SVector3 moved[3];
+				bool bShared = false;
+				for (int c = 0; c < 3; c++)
+				{
+					const uint32_t corner = canonical[triangle[c]];
+					bShared |= corner == target;
+					corners[c] = positions[corner];
+					moved[c] = corner == source ? positions[target] : corners[c];
+				}
+				if (bShared)
+				{
+					numShared++;
+					continue;
+				}
+				const SVector3 before = (corners[1] - corners[0]).Cross(corners[2] - corners[0]);
+				const SVector3 after = (moved[1] - moved[0]).Cross(moved[2] - moved[0]);
+				bValid = before.Dot(after) > 0.25 * before.Length() * after.Length();
+			}
+			if (!bValid || numShared == 0)
+			{
+				continue;
+			}
+
+			remap[collapse.From] = collapse.To;
+			quadrics[target].Add(quadrics[source]);
+			resultErrorSq = std::max(resultErrorSq, collapse.Cost);
+			numRemoved += numShared;
+			numCollapsed++;
+
+			touched[source] = 1;
+			touched[target] = 1;
+			for (uint32_t a = adjacencyOffsets[source]; a < adjacencyOffsets[source + 1]; a++)
+			{
+				const uint32_t* triangle = &OutIndices[static_cast<size_t>(adjacency[a]) * 3];
+				for (int c = 0; c < 3; c++)
+				{
+					touched[canonical[triangle[c]]] = 1;
+				}
+			}
+		}
+
+		if (numCollapsed == 0)
+		{
+			break;
+		}
+		for (auto& index : OutIndices)
+		{
+			index = remap[index];
+		}
+		removeDegenerate();
+	}
+	return static_cast<float>(std::sqrt(resultErrorSq));
+}
+
+std::vector<SMeshLOD> MeshSimplifier::BuildLODChain(const float* Positions, size_t NumVertices, size_t PositionStride, const uint32_t* Indices, size_t NumIndices, const SLODChainSettings& Settings)
+{
+	std::vector<SMeshLOD> lods;
+	if (NumVertices == 0 || NumIndices < 3)
+	{
+		return lods;
+	}
+
+	SVector3 min = LoadPosition(Positions, PositionStride, 0);
+	SVector3 max = min;
+	for (uint32_t i = 1; i < NumVertices; i++)
+	{
+		const SVector3 position = LoadPosition(Positions, PositionStride, i);
+		min = { std::min(min.X, position.X), std::min(min.Y, position.Y), std::min(min.Z, position.Z) };
+		max = { std::max(max.X, position.X), std::max(max.Y, position.Y), std::max(max.Z, position.Z) };
+	}
+	const float maxError = Settings.MaxError * static_cast<float>(0.5 * (max - min).Length());
+
+	std::vector<uint32_t> source(Indices, Indices + NumIndices);
+	float error = 0.0f;
+	while (lods.size() < Settings.MaxLODs)
+	{
+		const size_t numTriangles = source.size() / 3;
+		if (numTriangles <= Settings.MinTriangles)
+		{
+			break;
+		}
+		const size_t target = std::max<size_t>(static_cast<size_t>(numTriangles * Settings.Reduction), Settings.MinTriangles) * 3;
+
+		SMeshLOD lod;
+		const float stepError = Simplify(Positions, NumVertices, PositionStride, source.data(), source.size(), target, maxError - error, lod.Indices);
+
+		// Locked borders and seams can stop the simplification early, such a LOD is not worth the memory
+		if (lod.Indices.size() > source.size() * 9 / 10)
+		{
+			break;
+		}
+		error += stepError;
+		lod.Error = error;
+		source = lod.Indices;
+		lods.push_back(std::move(lod));
+	}
+	return lods;
+}
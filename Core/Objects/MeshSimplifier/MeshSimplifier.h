@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Quadric error edge collapse on indexed triangle lists.
+ * Vertices are only removed, never moved or created, so every LOD indexes the source vertex buffer.
+ * Vertices on open borders and attribute seams (same position, different vertex) are kept. No D3D dependencies.
+ */
+
+struct SMeshLOD
+{
+	std::vector<uint32_t> Indices;
+
+	// Object space distance from the source surface, grows along the chain
+	float Error = 0.0f;
+};
+
+struct SLODChainSettings
+{
+	uint32_t MaxLODs = 4;
+
+	// Target triangle count of a LOD relative to the previous one
+	float Reduction = 0.5f;
+	uint32_t MinTriangles = 64;
+
+	// Relative to the bounding sphere radius of the mesh, the chain stops at the first LOD above it
+	float MaxError = 0.1f;
+};
+
+namespace MeshSimplifier
+{
+/** @brief Collapses edges until TargetIndexCount is reached or the next collapse costs more than MaxError, returns the object space error */
+float Simplify(const float* Positions, size_t NumVertices, size_t PositionStride, const uint32_t* Indices, size_t NumIndices, size_t TargetIndexCount, float MaxError, std::vector<uint32_t>& OutIndices);
+
+/** @brief Every LOD is simplified from the previous one, the source mesh itself is not included */
+std::vector<SMeshLOD> BuildLODChain(const float* Positions, size_t NumVertices, size_t PositionStride, const uint32_t* Indices, size_t NumIndices, const SLODChainSettings& Settings = {});
+} // namespace MeshSimplifier
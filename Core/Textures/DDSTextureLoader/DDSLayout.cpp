@@ -0,0 +1,343 @@
+#include "DDSLayout.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+constexpr uint32_t MakeFourCC(char A, char B, char C, char D)
+{
+	return static_cast<uint32_t>(static_cast<uint8_t>(A)) | (static_cast<uint32_t>(static_cast<uint8_t>(B)) << 8)
+	       | (static_cast<uint32_t>(static_cast<uint8_t>(C)) << 16) | (static_cast<uint32_t>(static_cast<uint8_t>(D)) << 24);
+}
+
+constexpr uint32_t DDSMagic = MakeFourCC('D', 'D', 'S', ' ');
+
+constexpr uint32_t DDSFourCC = 0x4; // DDPF_FOURCC
+constexpr uint32_t DDSRGB = 0x40; // DDPF_RGB
+constexpr uint32_t DDSLuminance = 0x20000; // DDPF_LUMINANCE
+constexpr uint32_t DDSFlagsVolume = 0x800000; // DDSD_DEPTH
+constexpr uint32_t DDSCubeMap = 0x200; // DDSCAPS2_CUBEMAP
+constexpr uint32_t DDSCubeMapAllFaces = 0xfc00;
+constexpr uint32_t DDSMiscTextureCube = 0x4; // D3D11_RESOURCE_MISC_TEXTURECUBE
+
+// D3D12 hardware limits, the file metadata is not trusted beyond them
+constexpr uint32_t MaxMipLevels = 15;
+constexpr uint32_t MaxTexture1D = 16384;
+constexpr uint32_t MaxTexture2D = 16384;
+constexpr uint32_t MaxTexture3D = 2048;
+constexpr uint32_t MaxTextureCube = 16384;
+constexpr uint32_t MaxArraySize = 2048;
+
+#pragma pack(push, 1)
+struct SPixelFormat
+{
+	uint32_t Size;
+	uint32_t Flags;
+	uint32_t FourCC;
+	uint32_t RGBBitCount;
+	uint32_t RBitMask;
+	uint32_t GBitMask;
+	uint32_t BBitMask;
+	uint32_t ABitMask;
+};
+
+struct SHeader
+{
+	uint32_t Size;
+	uint32_t Flags;
+	uint32_t Height;
+	uint32_t Width;
+	uint32_t PitchOrLinearSize;
+	uint32_t Depth;
+	uint32_t MipMapCount;
+	uint32_t Reserved1[11];
+	SPixelFormat PixelFormat;
+	uint32_t Caps;
+	uint32_t Caps2;
+	uint32_t Caps3;
+	uint32_t Caps4;
+	uint32_t Reserved2;
+};
+
+struct SHeaderDX10
+{
+	uint32_t DXGIFormat;
+	uint32_t ResourceDimension;
+	uint32_t MiscFlag;
+	uint32_t ArraySize;
+	uint32_t MiscFlags2;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(SHeader) == 124);
+static_assert(sizeof(SHeaderDX10) == 20);
+
+// Subset of the legacy pixel formats the engine textures are authored in
+uint32_t GetLegacyFormat(const SPixelFormat& Format)
+{
+	if (Format.Flags & DDSFourCC)
+	{
+		switch (Format.FourCC)
+		{
+		case MakeFourCC('D', 'X', 'T', '1'):
+			return 71; // BC1_UNORM
+		case MakeFourCC('D', 'X', 'T', '2'):
+		case MakeFourCC('D', 'X', 'T', '3'):
+			return 74; // BC2_UNORM
+		case MakeFourCC('D', 'X', 'T', '4'):
+		case MakeFourCC('D', 'X', 'T', '5'):
+			return 77; // BC3_UNORM
+		case MakeFourCC('A', 'T', 'I', '1'):
+		case MakeFourCC('B', 'C', '4', 'U'):
+			return 80; // BC4_UNORM
+		case MakeFourCC('B', 'C', '4', 'S'):
+			return 81; // BC4_SNORM
+		case MakeFourCC('A', 'T', 'I', '2'):
+		case MakeFourCC('B', 'C', '5', 'U'):
+			return 83; // BC5_UNORM
+		case MakeFourCC('B', 'C', '5', 'S'):
+			return 84; // BC5_SNORM
+		case 111: // D3DFMT_R16F
+			return 54;
+		case 113: // D3DFMT_A16B16G16R16F
+			return 10;
+		case 114: // D3DFMT_R32F
+			return 41;
+		case 116: // D3DFMT_A32B32G32R32F
+			return 2;
+		default:
+			return 0;
+		}
+	}
+
+	if ((Format.Flags & DDSRGB) && Format.RGBBitCount == 32)
+	{
+		if (Format.RBitMask == 0x000000ff && Format.GBitMask == 0x0000ff00 && Format.BBitMask == 0x00ff0000 && Format.ABitMask == 0xff000000)
+		{
+			return 28; // R8G8B8A8_UNORM
+		}
+		if (Format.RBitMask == 0x00ff0000 && Format.GBitMask == 0x0000ff00 && Format.BBitMask == 0x000000ff)
+		{
+			return Format.ABitMask == 0xff000000 ? 87 : 88; // B8G8R8A8_UNORM, B8G8R8X8_UNORM
+		}
+	}
+
+	if ((Format.Flags & DDSLuminance) && Format.RGBBitCount == 8 && Format.RBitMask == 0xff)
+	{
+		return 61; // R8_UNORM
+	}
+	return 0;
+}
+} // namespace
+
+const char* ToString(EDDSParseResult Result)
+{
+	switch (Result)
+	{
+	case EDDSParseResult::Ok:
+		return "Ok";
+	case EDDSParseResult::InvalidHeader:
+		return "InvalidHeader";
+	case EDDSParseResult::Truncated:
+		return "Truncated";
+	case EDDSParseResult::Unsupported:
+		return "Unsupported";
+	}
+	return "Unknown";
+}
+
+uint32_t DDSLayout::GetBitsPerPixel(uint32_t DXGIFormat)
+{
+	if (DXGIFormat >= 1 && DXGIFormat <= 4)
+		return 128; // R32G32B32A32
+	if (DXGIFormat >= 5 && DXGIFormat <= 8)
+		return 96; // R32G32B32
+	if (DXGIFormat >= 9 && DXGIFormat <= 22)
+		return 64; // R16G16B16A16, R32G32, R32G8X24
+	if (DXGIFormat >= 23 && DXGIFormat <= 47)
+		return 32; // R10G10B10A2, R11G11B10, R8G8B8A8, R16G16, R32, R24G8
+	if (DXGIFormat >= 48 && DXGIFormat <= 59)
+		return 16; // R8G8, R16
+	if (DXGIFormat >= 60 && DXGIFormat <= 65)
+		return 8; // R8, A8
+	if (DXGIFormat == 67)
+		return 32; // R9G9B9E5_SHAREDEXP
+	if ((DXGIFormat >= 70 && DXGIFormat <= 72) || (DXGIFormat >= 79 && DXGIFormat <= 81))
+		return 4; // BC1, BC4
+	if ((DXGIFormat >= 73 && DXGIFormat <= 78) || (DXGIFormat >= 82 && DXGIFormat <= 84) || (DXGIFormat >= 94 && DXGIFormat <= 99))
+		return 8; // BC2, BC3, BC5, BC6H, BC7
+	if (DXGIFormat == 85 || DXGIFormat == 86 || DXGIFormat == 115)
+		return 16; // B5G6R5, B5G5R5A1, B4G4R4A4
+	if (DXGIFormat >= 87 && DXGIFormat <= 93)
+		return 32; // B8G8R8A8, B8G8R8X8, R10G10B10_XR_BIAS_A2
+	return 0;
+}
+
+bool DDSLayout::IsBlockCompressed(uint32_t DXGIFormat)
+{
+	return (DXGIFormat >= 70 && DXGIFormat <= 84) || (DXGIFormat >= 94 && DXGIFormat <= 99);
+}
+
+void DDSLayout::GetSurfaceInfo(uint32_t Width, uint32_t Height, uint32_t DXGIFormat, size_t& OutRowPitch, size_t& OutSlicePitch, uint32_t& OutNumRows)
+{
+	if (IsBlockCompressed(DXGIFormat))
+	{
+		// Bits per pixel of a 4x4 block format map to bytes per block times two
+		const size_t blockBytes = GetBitsPerPixel(DXGIFormat) * 2;
+		const size_t blocksWide = std::max<size_t>(1, (static_cast<size_t>(Width) + 3) / 4);
+		OutNumRows = std::max<uint32_t>(1, (Height + 3) / 4);
+		OutRowPitch = blocksWide * blockBytes;
+	}
+	else
+	{
+		OutNumRows = Height;
+		OutRowPitch = (static_cast<size_t>(Width) * GetBitsPerPixel(DXGIFormat) + 7) / 8;
+	}
+	OutSlicePitch = OutRowPitch * OutNumRows;
+}
+
+EDDSParseResult DDSLayout::Parse(const uint8_t* Data, size_t Size, SDDSLayout& OutLayout)
+{
+	OutLayout = {};
+	if (!Data || Size < sizeof(uint32_t) + sizeof(SHeader))
+	{
+		return EDDSParseResult::Truncated;
+	}
+
+	uint32_t magic;
+	std::memcpy(&magic, Data, sizeof(magic));
+	SHeader header;
+	std::memcpy(&header, Data + sizeof(uint32_t), sizeof(header));
+	if (magic != DDSMagic || header.Size != sizeof(SHeader) || header.PixelFormat.Size != sizeof(SPixelFormat))
+	{
+		return EDDSParseResult::InvalidHeader;
+	}
+
+	OutLayout.Width = header.Width;
+	OutLayout.Height = std::max(header.Height, 1u);
+	OutLayout.MipCount = std::max(header.MipMapCount, 1u);
+	size_t dataOffset = sizeof(uint32_t) + sizeof(SHeader);
+
+	if ((header.PixelFormat.Flags & DDSFourCC) && header.PixelFormat.FourCC == MakeFourCC('D', 'X', '1', '0'))
+	{
+		if (Size < dataOffset + sizeof(SHeaderDX10))
+		{
+			return EDDSParseResult::Truncated;
+		}
+
+		SHeaderDX10 headerDX10;
+		std::memcpy(&headerDX10, Data + dataOffset, sizeof(headerDX10));
+		dataOffset += sizeof(SHeaderDX10);
+		OutLayout.bDX10Header = true;
+
+		if (headerDX10.ArraySize == 0)
+		{
+			return EDDSParseResult::InvalidHeader;
+		}
+		OutLayout.ArraySize = headerDX10.ArraySize;
+		OutLayout.DXGIFormat = headerDX10.DXGIFormat;
+
+		switch (headerDX10.ResourceDimension)
+		{
+		case static_cast<uint32_t>(EDDSDimension::Texture1D):
+			OutLayout.Dimension = EDDSDimension::Texture1D;
+			OutLayout.Height = 1;
+			break;
+		case static_cast<uint32_t>(EDDSDimension::Texture2D):
+			OutLayout.Dimension = EDDSDimension::Texture2D;
+			if (headerDX10.MiscFlag & DDSMiscTextureCube)
+			{
+				OutLayout.ArraySize *= 6;
+				OutLayout.bCubeMap = true;
+			}
+			break;
+		case static_cast<uint32_t>(EDDSDimension::Texture3D):
+			if (!(header.Flags & DDSFlagsVolume) || OutLayout.ArraySize > 1)
+			{
+				return EDDSParseResult::InvalidHeader;
+			}
+			OutLayout.Dimension = EDDSDimension::Texture3D;
+			OutLayout.Depth = std::max(header.Depth, 1u);
+			break;
+		default:
+			return EDDSParseResult::InvalidHeader;
+		}
+	}
+	else
+	{
+		OutLayout.DXGIFormat = GetLegacyFormat(header.PixelFormat);
+		if (header.Flags & DDSFlagsVolume)
+		{
+			OutLayout.Dimension = EDDSDimension::Texture3D;
+			OutLayout.Depth = std::max(header.Depth, 1u);
+		}
+		else if (header.Caps2 & DDSCubeMap)
+		{
+			if ((header.Caps2 & DDSCubeMapAllFaces) != DDSCubeMapAllFaces)
+			{
+				return EDDSParseResult::Unsupported;
+			}
+			OutLayout.ArraySize = 6;
+			OutLayout.bCubeMap = true;
+		}
+	}
+
+	if (OutLayout.DXGIFormat == 0 || GetBitsPerPixel(OutLayout.DXGIFormat) == 0)
+	{
+		return EDDSParseResult::Unsupported;
+	}
+
+	const uint32_t maxExtent = std::max({ OutLayout.Width, OutLayout.Height, OutLayout.Depth });
+	const uint32_t maxDimension = OutLayout.Dimension == EDDSDimension::Texture1D ? MaxTexture1D
+	                              : OutLayout.Dimension == EDDSDimension::Texture3D ? MaxTexture3D
+	                              : OutLayout.bCubeMap                              ? MaxTextureCube
+	                                                                                : MaxTexture2D;
+	if (OutLayout.Width == 0 || maxExtent > maxDimension || OutLayout.ArraySize > MaxArraySize || OutLayout.MipCount > MaxMipLevels)
+	{
+		return EDDSParseResult::InvalidHeader;
+	}
+
+	// A chain longer than the extent allows would repeat 1x1 levels
+	uint32_t fullChain = 1;
+	while ((maxExtent >> fullChain) > 0)
+	{
+		fullChain++;
+	}
+	if (OutLayout.MipCount > fullChain)
+	{
+		return EDDSParseResult::InvalidHeader;
+	}
+
+	OutLayout.Subresources.reserve(static_cast<size_t>(OutLayout.ArraySize) * OutLayout.MipCount);
+	size_t offset = dataOffset;
+	for (uint32_t slice = 0; slice < OutLayout.ArraySize; slice++)
+	{
+		uint32_t width = OutLayout.Width;
+		uint32_t height = OutLayout.Height;
+		uint32_t depth = OutLayout.Depth;
+		for (uint32_t mip = 0; mip < OutLayout.MipCount; mip++)
+		{
+			SDDSSubresource subresource;
+			subresource.Offset = offset;
+			subresource.Width = width;
+			subresource.Height = height;
+			subresource.Depth = depth;
+			GetSurfaceInfo(width, height, OutLayout.DXGIFormat, subresource.RowPitch, subresource.SlicePitch, subresource.NumRows);
+
+			const size_t byteSize = subresource.SlicePitch * depth;
+			if (byteSize > Size || offset > Size - byteSize)
+			{
+				OutLayout.Subresources.clear();
+				return EDDSParseResult::Truncated;
+			}
+			offset += byteSize;
+			OutLayout.Subresources.push_back(subresource);
+
+			width = std::max(width >> 1, 1u);
+			height = std::max(height >> 1, 1u);
+			depth = std::max(depth >> 1, 1u);
+		}
+	}
+	return EDDSParseResult::Ok;
+}
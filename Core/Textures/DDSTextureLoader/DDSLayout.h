@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ * In place validation of a DDS file: headers and the location of every subresource inside the file.
+ * No D3D dependencies, formats are kept as raw DXGI_FORMAT values.
+ */
+
+enum class EDDSParseResult : uint8_t
+{
+	Ok,
+	InvalidHeader,
+	Truncated,
+	// Valid DDS the layout parser does not handle (palettized, packed or legacy formats), use the full loader
+	Unsupported
+};
+
+const char* ToString(EDDSParseResult Result);
+
+enum class EDDSDimension : uint8_t
+{
+	Texture1D = 2,
+	Texture2D = 3,
+	Texture3D = 4
+};
+
+struct SDDSSubresource
+{
+	// Offset from the beginning of the file
+	size_t Offset = 0;
+	size_t RowPitch = 0;
+	size_t SlicePitch = 0;
+	uint32_t NumRows = 0;
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	uint32_t Depth = 0;
+};
+
+struct SDDSLayout
+{
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	uint32_t Depth = 1;
+	uint32_t MipCount = 1;
+
+	// Cube maps count every face
+	uint32_t ArraySize = 1;
+	uint32_t DXGIFormat = 0;
+	EDDSDimension Dimension = EDDSDimension::Texture2D;
+	bool bCubeMap = false;
+	bool bDX10Header = false;
+
+	// ArraySize * MipCount entries, array slice major like D3D subresource indices
+	std::vector<SDDSSubresource> Subresources;
+
+	const SDDSSubresource& GetSubresource(uint32_t Mip, uint32_t Slice) const { return Subresources[Slice * MipCount + Mip]; }
+};
+
+namespace DDSLayout
+{
+/** @brief Validates the file and fills the subresource table, nothing is copied */
+EDDSParseResult Parse(const uint8_t* Data, size_t Size, SDDSLayout& OutLayout);
+
+// 0 for formats the layout parser does not handle
+uint32_t GetBitsPerPixel(uint32_t DXGIFormat);
+bool IsBlockCompressed(uint32_t DXGIFormat);
+
+void GetSurfaceInfo(uint32_t Width, uint32_t Height, uint32_t DXGIFormat, size_t& OutRowPitch, size_t& OutSlicePitch, uint32_t& OutNumRows);
+} // namespace DDSLayout
@@ -20,10 +20,13 @@
 
 #include "DDSTextureLoader.h"
 
+#include "DDSLayout.h"
 #include "DirectX/DXHelper.h"
 #include "DirectX/Resource.h"
 #include "DirectXUtils.h"
+#include "Engine/UploadBuffer/UploadManager.h"
 #include "Logger.h"
+#include "MappedFile.h"
 #include "PathUtils.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include <STB/stb_image.h>
@@ -2533,8 +2536,121 @@ _Use_decl_annotations_
 	return hr;
 }
 
-HRESULT DirectX::LoadTextureFromNonDDS(const std::filesystem::path& FilePath, ID3D12Device* Device, ID3D12GraphicsCommandList* List, ComPtr<ID3D12Resource>& Texture,
-                                       ComPtr<ID3D12Resource>& TextureUploadHeap)
+HRESULT DirectX::CreateDDSTextureFromFileMapped12(ID3D12Device* Device, OUploadManager* Uploads, const std::filesystem::path& FilePath, ComPtr<ID3D12Resource>& Texture,
+                                                  uint32_t FirstMip, uint32_t NumMips)
+{
+	PROFILE_SCOPE();
+	Texture = nullptr;
+	if (!Device || !Uploads)
+	{
+		return E_INVALIDARG;
+	}
+	auto List = Uploads->GetCommandList();
+
+	OMappedFile file;
+	if (!file.Open(FilePath))
+	{
+		return HRESULT_FROM_WIN32(ERROR_OPEN_FAILED);
+	}
+
+	SDDSLayout layout;
+	const auto result = DDSLayout::Parse(file.GetData(), file.GetSize(), layout);
+	if (result == EDDSParseResult::Unsupported && FirstMip == 0)
+	{
+		file.Close();
+		ComPtr<ID3D12Resource> uploadHeap;
+		const auto hr = CreateDDSTextureFromFile12(Device, List, FilePath.wstring().c_str(), Texture, uploadHeap);
+		Uploads->KeepAlive(uploadHeap);
+		return hr;
+	}
+	if (result != EDDSParseResult::Ok)
+	{
+		LOG(Engine, Error, "Invalid DDS file {}: {}", FilePath.wstring(), TEXT(ToString(result)));
+		return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+	}
+	if (FirstMip >= layout.MipCount)
+	{
+		return E_INVALIDARG;
+	}
+	NumMips = std::min(NumMips, layout.MipCount - FirstMip);
+
+	// Block compressed textures need the top level to be a multiple of the block size
+	const auto& top = layout.GetSubresource(FirstMip, 0);
+	if (DDSLayout::IsBlockCompressed(layout.DXGIFormat) && (top.Width % 4 != 0 || top.Height % 4 != 0))
+	{
+		return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+	}
+
+	const bool bVolume = layout.Dimension == EDDSDimension::Texture3D;
+	D3D12_RESOURCE_DESC desc = {};
+	desc.Dimension = static_cast<D3D12_RESOURCE_DIMENSION>(layout.Dimension);
+	desc.Width = top.Width;
+	desc.Height = top.Height;
+	desc.DepthOrArraySize = static_cast<UINT16>(bVolume ? top.Depth : layout.ArraySize);
+	desc.MipLevels = static_cast<UINT16>(NumMips);
+	desc.Format = static_cast<DXGI_FORMAT>(layout.DXGIFormat);
+	desc.SampleDesc.Count = 1;
+	desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+
+	const auto defaultHeap = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+	HRESULT hr = Device->CreateCommittedResource(&defaultHeap, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&Texture));
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	const uint32_t numSlices = bVolume ? 1 : layout.ArraySize;
+	const UINT numSubresources = numSlices * NumMips;
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprints(numSubresources);
+	std::vector<UINT> numRows(numSubresources);
+	std::vector<UINT64> rowSizes(numSubresources);
+	UINT64 uploadSize = 0;
+	Device->GetCopyableFootprints(&desc, 0, numSubresources, 0, footprints.data(), numRows.data(), rowSizes.data(), &uploadSize);
+
+	const auto staging = Uploads->Allocate(uploadSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+	uint8_t* mapped = staging.CPUAddress;
+
+	// Rows go from the mapping to the upload ring directly, the footprint pitch is 256 byte aligned
+	for (uint32_t slice = 0; slice < numSlices; slice++)
+	{
+		for (uint32_t mip = 0; mip < NumMips; mip++)
+		{
+			const uint32_t index = slice * NumMips + mip;
+			const auto& source = layout.GetSubresource(FirstMip + mip, slice);
+			const auto& footprint = footprints[index];
+			const size_t rowSize = std::min<size_t>(rowSizes[index], source.RowPitch);
+			for (uint32_t z = 0; z < footprint.Footprint.Depth; z++)
+			{
+				const uint8_t* src = file.GetData() + source.Offset + z * source.SlicePitch;
+				uint8_t* dst = mapped + footprint.Offset + static_cast<size_t>(z) * footprint.Footprint.RowPitch * numRows[index];
+				if (footprint.Footprint.RowPitch == source.RowPitch)
+				{
+					memcpy(dst, src, source.RowPitch * numRows[index]);
+					continue;
+				}
+				for (uint32_t row = 0; row < numRows[index]; row++)
+				{
+					memcpy(dst + static_cast<size_t>(row) * footprint.Footprint.RowPitch, src + row * source.RowPitch, rowSize);
+				}
+			}
+		}
+	}
+
+	for (UINT index = 0; index < numSubresources; index++)
+	{
+		auto footprint = footprints[index];
+		footprint.Offset += staging.Offset;
+		const CD3DX12_TEXTURE_COPY_LOCATION dst(Texture.Get(), index);
+		const CD3DX12_TEXTURE_COPY_LOCATION src(staging.Resource, footprint);
+		List->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+	}
+
+	const auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(Texture.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	List->ResourceBarrier(1, &barrier);
+	return S_OK;
+}
+
+HRESULT DirectX::LoadTextureFromNonDDS(const std::filesystem::path& FilePath, ID3D12Device* Device, OUploadManager* Uploads, ComPtr<ID3D12Resource>& Texture)
 {
 	// Load the image
 	stbi_set_flip_vertically_on_load(true);
@@ -2577,33 +2693,27 @@ HRESULT DirectX::LoadTextureFromNonDDS(const std::filesystem::path& FilePath, ID
 	initData.SlicePitch = initData.RowPitch * height;
 
 	// Create texture
-	HRESULT hr = CreateD3DResources12(
-	    Device,
-	    List,
-	    D3D12_RESOURCE_DIMENSION_TEXTURE2D,
-	    width,
-	    height,
-	    1, // depth
-	    1, // mipLevels
-	    1, // arraySize
-	    DXGI_FORMAT_R8G8B8A8_UNORM,
-	    false, // isCubeMap
-	    false, // forceSRGB
-	    &initData,
-	    Texture,
-	    TextureUploadHeap);
+	const auto desc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1);
+	const auto defaultHeap = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+	HRESULT hr = Device->CreateCommittedResource(&defaultHeap, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&Texture));
+	if (SUCCEEDED(hr))
+	{
+		Uploads->UploadSubresources(Texture.Get(), 0, 1, &initData);
+		const auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(Texture.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		Uploads->GetCommandList()->ResourceBarrier(1, &barrier);
+	}
 	stbi_image_free(data);
 	return hr;
 }
 
-HRESULT DirectX::LoadTexture(const std::filesystem::path& FilePath, ID3D12Device* Device, ID3D12GraphicsCommandList* List, Microsoft::WRL::ComPtr<ID3D12Resource>& Texture, Microsoft::WRL::ComPtr<ID3D12Resource>& TextureUploadHeap, bool IsDDS)
+HRESULT DirectX::LoadTexture(const std::filesystem::path& FilePath, ID3D12Device* Device, OUploadManager* Uploads, Microsoft::WRL::ComPtr<ID3D12Resource>& Texture, bool IsDDS)
 {
 	if (IsDDS)
 	{
-		return CreateDDSTextureFromFile12(Device, List, FilePath.wstring().c_str(), Texture, TextureUploadHeap);
+		return CreateDDSTextureFromFileMapped12(Device, Uploads, FilePath, Texture);
 	}
 	else
 	{
-		return LoadTextureFromNonDDS(FilePath, Device, List, Texture, TextureUploadHeap);
+		return LoadTextureFromNonDDS(FilePath, Device, Uploads, Texture);
 	}
 }
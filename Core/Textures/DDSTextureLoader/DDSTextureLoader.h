@@ -50,6 +50,7 @@ namespace std::filesystem
 class path;
 }
 class IRenderObject;
+class OUploadManager;
 namespace DirectX
 {
 enum DDS_ALPHA_MODE
@@ -166,9 +167,13 @@ HRESULT CreateDDSTextureFromFileEx(_In_ ID3D11Device* d3dDevice,
                                    _Outptr_opt_ ID3D11ShaderResourceView** textureView,
                                    _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr);
 
-HRESULT LoadTextureFromNonDDS(const std::filesystem::path& FilePath, ID3D12Device* Device, ID3D12GraphicsCommandList* List, Microsoft::WRL::ComPtr<ID3D12Resource>& Texture,
-                              Microsoft::WRL::ComPtr<ID3D12Resource>& TextureUploadHeap);
+// Copies the mips straight from a memory mapping of the file into the upload ring.
+// FirstMip/NumMips select a range of the chain, the created texture starts at FirstMip
+HRESULT CreateDDSTextureFromFileMapped12(ID3D12Device* Device, OUploadManager* Uploads, const std::filesystem::path& FilePath, Microsoft::WRL::ComPtr<ID3D12Resource>& Texture,
+                                         uint32_t FirstMip = 0, uint32_t NumMips = UINT32_MAX);
 
-HRESULT LoadTexture(const std::filesystem::path& FilePath, ID3D12Device* Device, ID3D12GraphicsCommandList* List, Microsoft::WRL::ComPtr<ID3D12Resource>& Texture,
-                    Microsoft::WRL::ComPtr<ID3D12Resource>& TextureUploadHeap, bool IsDDS = false);
+HRESULT LoadTextureFromNonDDS(const std::filesystem::path& FilePath, ID3D12Device* Device, OUploadManager* Uploads, Microsoft::WRL::ComPtr<ID3D12Resource>& Texture);
+
+// The copies are recorded on the command list of Uploads, the texture is readable once its open ticket completes
+HRESULT LoadTexture(const std::filesystem::path& FilePath, ID3D12Device* Device, OUploadManager* Uploads, Microsoft::WRL::ComPtr<ID3D12Resource>& Texture, bool IsDDS = false);
 } // namespace DirectX
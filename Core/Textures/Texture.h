@@ -1,5 +1,7 @@
 #pragma once
+#include "Engine/RenderTarget/RenderObject/DescriptorAllocator.h"
 #include "Engine/RenderTarget/RenderObject/RenderObject.h"
+#include "Engine/UploadBuffer/UploadRing.h"
 #include "Windows.h"
 
 #include <Types.h>
@@ -17,7 +19,7 @@ struct STextureViewType
 	RENDER_TYPE(TextureCube);
 };
 
-ENUM(ETextureType, Diffuse, Normal, Height, Occlusion, Roughness)
+ENUM(ETextureType, Diffuse, Normal, Height, Occlusion, Roughness, Alpha)
 
 inline wstring ToString(ETextureType Type)
 {
@@ -33,6 +35,8 @@ inline wstring ToString(ETextureType Type)
 		return L"Occlusion";
 	case ETextureType::Roughness:
 		return L"Roughness";
+	case ETextureType::Alpha:
+		return L"Alpha";
 	default:
 		return L"Unknown";
 	}
@@ -44,11 +48,14 @@ struct STexture
 	wstring FileName;
 
 	SResourceInfo Resource;
-	SResourceInfo UploadHeap;
+
+	// The texture holds its data once the ticket completes
+	SUploadTicket UploadTicket;
 	string ViewType = STextureViewType::Texture2D;
 	//Index for accessing the texture in the local array in shader
 	int64_t TextureIndex = -1;
 	SDescriptorPair SRV;
+	SDescriptorID DescriptorID;
 	ETextureType Type = ETextureType::Diffuse;
 	virtual D3D12_SHADER_RESOURCE_VIEW_DESC GetSRVDesc() const;
 };
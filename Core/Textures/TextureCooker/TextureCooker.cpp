@@ -0,0 +1,1102 @@
+#include "TextureCooker.h"
+
+#include <STB/stb_image.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <future>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define TEXTURE_COOKER_SSE 1
+#include <emmintrin.h>
+#else
+#define TEXTURE_COOKER_SSE 0
+#endif
+
+namespace
+{
+constexpr float Pi = 3.14159265358979f;
+
+#if TEXTURE_COOKER_SSE
+using TPixel = __m128;
+
+TPixel LoadPixel(const float* Pixel)
+{
+	return _mm_loadu_ps(Pixel);
+}
+
+TPixel ZeroPixel()
+{
+	return _mm_setzero_ps();
+}
+
+TPixel MulAdd(TPixel Acc, TPixel Pixel, float Weight)
+{
+	return _mm_add_ps(Acc, _mm_mul_ps(Pixel, _mm_set1_ps(Weight)));
+}
+
+void StorePixel(float* Dest, TPixel Pixel)
+{
+	_mm_storeu_ps(Dest, Pixel);
+}
+#else
+struct TPixel
+{
+	float V[4];
+};
+
+TPixel LoadPixel(const float* Pixel)
+{
+	return { { Pixel[0], Pixel[1], Pixel[2], Pixel[3] } };
+}
+
+TPixel ZeroPixel()
+{
+	return { { 0, 0, 0, 0 } };
+}
+
+TPixel MulAdd(TPixel Acc, TPixel Pixel, float Weight)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		Acc.V[i] += Pixel.V[i] * Weight;
+	}
+	return Acc;
+}
+
+void StorePixel(float* Dest, TPixel Pixel)
+{
+	std::memcpy(Dest, Pixel.V, sizeof(Pixel.V));
+}
+#endif
+
+float SRGBToLinear(float Value)
+{
+	return Value <= 0.04045f ? Value / 12.92f : std::pow((Value + 0.055f) / 1.055f, 2.4f);
+}
+
+float LinearToSRGB(float Value)
+{
+	return Value <= 0.0031308f ? Value * 12.92f : 1.055f * std::pow(Value, 1.0f / 2.4f) - 0.055f;
+}
+
+const std::array<float, 256>& GetSRGBToLinearTable()
+{
+	static const std::array<float, 256> table = []() {
+		std::array<float, 256> result{};
+		for (int i = 0; i < 256; i++)
+		{
+			result[i] = SRGBToLinear(i / 255.0f);
+		}
+		return result;
+	}();
+	return table;
+}
+
+uint8_t ToUnorm8(float Value)
+{
+	return static_cast<uint8_t>(std::clamp(Value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+// Float RGBA image in the space the filter works in
+struct SFloatImage
+{
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	std::vector<float> Pixels;
+
+	const float* At(int32_t X, int32_t Y) const
+	{
+		X = std::clamp(X, 0, static_cast<int32_t>(Width) - 1);
+		Y = std::clamp(Y, 0, static_cast<int32_t>(Height) - 1);
+		return &Pixels[(static_cast<size_t>(Y) * Width + X) * 4];
+	}
+};
+
+SFloatImage ToFloatImage(const STextureImage& Image, const SCookSettings& Settings)
+{
+	const auto& table = GetSRGBToLinearTable();
+	SFloatImage result{ Image.Width, Image.Height, std::vector<float>(Image.Pixels.size()) };
+	for (size_t i = 0; i < Image.Pixels.size(); i += 4)
+	{
+		for (size_t c = 0; c < 3; c++)
+		{
+			const uint8_t value = Image.Pixels[i + c];
+			if (Settings.bNormalMap)
+			{
+				result.Pixels[i + c] = value / 255.0f * 2.0f - 1.0f;
+			}
+			else
+			{
+				result.Pixels[i + c] = Settings.bSRGB ? table[value] : value / 255.0f;
+			}
+		}
+		result.Pixels[i + 3] = Image.Pixels[i + 3] / 255.0f;
+	}
+	return result;
+}
+
+STextureImage ToTextureImage(const SFloatImage& Image, const SCookSettings& Settings)
+{
+	STextureImage result{ Image.Width, Image.Height, std::vector<uint8_t>(Image.Pixels.size()) };
+	for (size_t i = 0; i < Image.Pixels.size(); i += 4)
+	{
+		const float* pixel = &Image.Pixels[i];
+		if (Settings.bNormalMap)
+		{
+			const float length = std::sqrt(pixel[0] * pixel[0] + pixel[1] * pixel[1] + pixel[2] * pixel[2]);
+			const float invLength = length > 0.0f ? 1.0f / length : 0.0f;
+			for (size_t c = 0; c < 3; c++)
+			{
+				result.Pixels[i + c] = ToUnorm8(pixel[c] * invLength * 0.5f + 0.5f);
+			}
+		}
+		else
+		{
+			for (size_t c = 0; c < 3; c++)
+			{
+				result.Pixels[i + c] = ToUnorm8(Settings.bSRGB ? LinearToSRGB(std::clamp(pixel[c], 0.0f, 1.0f)) : pixel[c]);
+			}
+		}
+		result.Pixels[i + 3] = ToUnorm8(pixel[3]);
+	}
+	return result;
+}
+
+float BesselI0(float X)
+{
+	float sum = 1.0f;
+	float term = 1.0f;
+	for (int k = 1; k < 16; k++)
+	{
+		term *= (X * 0.5f / k) * (X * 0.5f / k);
+		sum += term;
+	}
+	return sum;
+}
+
+// Taps of a 2x downsample centered between source pixels 2x and 2x + 1
+constexpr int32_t KaiserTaps = 6;
+const std::array<float, KaiserTaps>& GetKaiserWeights()
+{
+	static const std::array<float, KaiserTaps> weights = []() {
+		constexpr float radius = 1.5f;
+		constexpr float alpha = 4.0f;
+		std::array<float, KaiserTaps> result{};
+		float sum = 0.0f;
+		for (int32_t k = 0; k < KaiserTaps; k++)
+		{
+			// Distance in destination texels
+			const float t = (static_cast<float>(k - KaiserTaps / 2 + 1) - 0.5f) * 0.5f;
+			const float sinc = std::sin(Pi * t) / (Pi * t);
+			const float ratio = t / radius;
+			const float window = BesselI0(alpha * std::sqrt(std::max(0.0f, 1.0f - ratio * ratio))) / BesselI0(alpha);
+			result[k] = sinc * window;
+			sum += result[k];
+		}
+		for (auto& weight : result)
+		{
+			weight /= sum;
+		}
+		return result;
+	}();
+	return weights;
+}
+
+SFloatImage DownsampleBox(const SFloatImage& Source)
+{
+	SFloatImage result{ std::max(Source.Width / 2, 1u), std::max(Source.Height / 2, 1u), {} };
+	result.Pixels.resize(static_cast<size_t>(result.Width) * result.Height * 4);
+	for (uint32_t y = 0; y < result.Height; y++)
+	{
+		for (uint32_t x = 0; x < result.Width; x++)
+		{
+			const int32_t sx = x * 2;
+			const int32_t sy = y * 2;
+			TPixel acc = ZeroPixel();
+			acc = MulAdd(acc, LoadPixel(Source.At(sx, sy)), 0.25f);
+			acc = MulAdd(acc, LoadPixel(Source.At(sx + 1, sy)), 0.25f);
+			acc = MulAdd(acc, LoadPixel(Source.At(sx, sy + 1)), 0.25f);
+			acc = MulAdd(acc, LoadPixel(Source.At(sx + 1, sy + 1)), 0.25f);
+			StorePixel(&result.Pixels[(static_cast<size_t>(y) * result.Width + x) * 4], acc);
+		}
+	}
+	return result;
+}
+
+SFloatImage DownsampleKaiser(const SFloatImage& Source)
+{
+	const auto& weights = GetKaiserWeights();
+	const uint32_t width = std::max(Source.Width / 2, 1u);
+	const uint32_t height = std::max(Source.Height / 2, 1u);
+
+	// A dimension that is already 1 is copied instead of filtered
+	const bool bFilterX = Source.Width > 1;
+	const bool bFilterY = Source.Height > 1;
+
+	SFloatImage horizontal{ width, Source.Height, std::vector<float>(static_cast<size_t>(width) * Source.Height * 4) };
+	for (uint32_t y = 0; y < Source.Height; y++)
+	{
+		for (uint32_t x = 0; x < width; x++)
+		{
+			TPixel acc = ZeroPixel();
+			if (bFilterX)
+			{
+				for (int32_t k = 0; k < KaiserTaps; k++)
+				{
+					acc = MulAdd(acc, LoadPixel(Source.At(x * 2 + k - KaiserTaps / 2 + 1, y)), weights[k]);
+				}
+			}
+			else
+			{
+				acc = LoadPixel(Source.At(x, y));
+			}
+			StorePixel(&horizontal.Pixels[(static_cast<size_t>(y) * width + x) * 4], acc);
+		}
+	}
+
+	SFloatImage result{ width, height, std::vector<float>(static_cast<size_t>(width) * height * 4) };
+	for (uint32_t y = 0; y < height; y++)
+	{
+		for (uint32_t x = 0; x < width; x++)
+		{
+			TPixel acc = ZeroPixel();
+			if (bFilterY)
+			{
+				for (int32_t k = 0; k < KaiserTaps; k++)
+				{
+					acc = MulAdd(acc, LoadPixel(horizontal.At(x, y * 2 + k - KaiserTaps / 2 + 1)), weights[k]);
+				}
+			}
+			else
+			{
+				acc = LoadPixel(horizontal.At(x, y));
+			}
+			StorePixel(&result.Pixels[(static_cast<size_t>(y) * width + x) * 4], acc);
+		}
+	}
+	return result;
+}
+
+// Endpoints of the principal axis of the block colors
+template<int N>
+void FindEndpoints(const float (&Pixels)[16][N], float (&OutLow)[N], float (&OutHigh)[N])
+{
+	float mean[N] = {};
+	float low[N], high[N];
+	for (int c = 0; c < N; c++)
+	{
+		low[c] = 255.0f;
+		high[c] = 0.0f;
+	}
+	for (const auto& pixel : Pixels)
+	{
+		for (int c = 0; c < N; c++)
+		{
+			mean[c] += pixel[c] / 16.0f;
+			low[c] = std::min(low[c], pixel[c]);
+			high[c] = std::max(high[c], pixel[c]);
+		}
+	}
+
+	float covariance[N][N] = {};
+	for (const auto& pixel : Pixels)
+	{
+		for (int i = 0; i < N; i++)
+		{
+			for (int j = 0; j < N; j++)
+			{
+				covariance[i][j] += (pixel[i] - mean[i]) * (pixel[j] - mean[j]);
+			}
+		}
+	}
+
+	float axis[N];
+	for (int c = 0; c < N; c++)
+	{
+		axis[c] = high[c] - low[c];
+	}
+	for (int iteration = 0; iteration < 8; iteration++)
+	{
+		float next[N] = {};
+		float length = 0.0f;
+		for (int i = 0; i < N; i++)
+		{
+			for (int j = 0; j < N; j++)
+			{
+				next[i] += covariance[i][j] * axis[j];
+			}
+			length = std::max(length, std::abs(next[i]));
+		}
+		if (length <= 1e-6f)
+		{
+			break;
+		}
+		for (int c = 0; c < N; c++)
+		{
+			axis[c] = next[c] / length;
+		}
+	}
+
+	float axisLengthSq = 0.0f;
+	for (int c = 0; c < N; c++)
+	{
+		axisLengthSq += axis[c] * axis[c];
+	}
+	if (axisLengthSq <= 1e-12f)
+	{
+		// Solid block
+		std::memcpy(OutLow, mean, sizeof(mean));
+		std::memcpy(OutHigh, mean, sizeof(mean));
+		return;
+	}
+
+	float minT = 1e30f;
+	float maxT = -1e30f;
+	for (const auto& pixel : Pixels)
+	{
+		float t = 0.0f;
+		for (int c = 0; c < N; c++)
+		{
+			t += (pixel[c] - mean[c]) * axis[c];
+		}
+		minT = std::min(minT, t);
+		maxT = std::max(maxT, t);
+	}
+	for (int c = 0; c < N; c++)
+	{
+		OutLow[c] = std::clamp(mean[c] + axis[c] * minT / axisLengthSq, 0.0f, 255.0f);
+		OutHigh[c] = std::clamp(mean[c] + axis[c] * maxT / axisLengthSq, 0.0f, 255.0f);
+	}
+}
+
+uint16_t To565(const float (&Color)[3])
+{
+	const auto r = static_cast<uint16_t>(std::lround(Color[0] * 31.0f / 255.0f));
+	const auto g = static_cast<uint16_t>(std::lround(Color[1] * 63.0f / 255.0f));
+	const auto b = static_cast<uint16_t>(std::lround(Color[2] * 31.0f / 255.0f));
+	return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void From565(uint16_t Color, int32_t (&OutColor)[3])
+{
+	const int32_t r = (Color >> 11) & 31;
+	const int32_t g = (Color >> 5) & 63;
+	const int32_t b = Color & 31;
+	OutColor[0] = (r << 3) | (r >> 2);
+	OutColor[1] = (g << 2) | (g >> 4);
+	OutColor[2] = (b << 3) | (b >> 2);
+}
+
+// LSB first bit stream of a BC7 block
+struct SBitWriter
+{
+	uint8_t* Data;
+	uint32_t Position = 0;
+
+	void Write(uint32_t Value, uint32_t NumBits)
+	{
+		for (uint32_t i = 0; i < NumBits; i++, Position++)
+		{
+			if (Value & (1u << i))
+			{
+				Data[Position >> 3] |= static_cast<uint8_t>(1u << (Position & 7));
+			}
+		}
+	}
+};
+
+std::vector<uint8_t> ReadFile(const std::filesystem::path& Path)
+{
+	std::ifstream file(Path, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		return {};
+	}
+	const auto size = static_cast<size_t>(file.tellg());
+	std::vector<uint8_t> bytes(size);
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(size));
+	return bytes;
+}
+
+bool DecodeImage(const std::vector<uint8_t>& Bytes, STextureImage& OutImage)
+{
+	// Matches DirectX::LoadTextureFromNonDDS, per thread since cooks run on workers
+	stbi_set_flip_vertically_on_load_thread(1);
+
+	int width, height, channels;
+	uint8_t* data = stbi_load_from_memory(Bytes.data(), static_cast<int>(Bytes.size()), &width, &height, &channels, STBI_rgb_alpha);
+	if (!data)
+	{
+		return false;
+	}
+	OutImage.Width = width;
+	OutImage.Height = height;
+	OutImage.Pixels.assign(data, data + static_cast<size_t>(width) * height * 4);
+	stbi_image_free(data);
+	return true;
+}
+
+struct SDDSPixelFormat
+{
+	uint32_t Size;
+	uint32_t Flags;
+	uint32_t FourCC;
+	uint32_t RGBBitCount;
+	uint32_t RBitMask;
+	uint32_t GBitMask;
+	uint32_t BBitMask;
+	uint32_t ABitMask;
+};
+
+struct SDDSHeader
+{
+	uint32_t Size;
+	uint32_t Flags;
+	uint32_t Height;
+	uint32_t Width;
+	uint32_t PitchOrLinearSize;
+	uint32_t Depth;
+	uint32_t MipMapCount;
+	uint32_t Reserved1[11];
+	SDDSPixelFormat PixelFormat;
+	uint32_t Caps;
+	uint32_t Caps2;
+	uint32_t Caps3;
+	uint32_t Caps4;
+	uint32_t Reserved2;
+};
+
+struct SDDSHeaderDX10
+{
+	uint32_t DXGIFormat;
+	uint32_t ResourceDimension;
+	uint32_t MiscFlag;
+	uint32_t ArraySize;
+	uint32_t MiscFlags2;
+};
+
+static_assert(sizeof(SDDSHeader) == 124);
+} // namespace
+
+const char* ToString(ECookedFormat Format)
+{
+	switch (Format)
+	{
+	case ECookedFormat::RGBA8:
+		return "RGBA8";
+	case ECookedFormat::BC1:
+		return "BC1";
+	case ECookedFormat::BC3:
+		return "BC3";
+	case ECookedFormat::BC4:
+		return "BC4";
+	case ECookedFormat::BC5:
+		return "BC5";
+	case ECookedFormat::BC7:
+		return "BC7";
+	}
+	return "Unknown";
+}
+
+bool ParseCookedFormat(std::string_view Name, ECookedFormat& OutFormat)
+{
+	for (auto format : { ECookedFormat::RGBA8, ECookedFormat::BC1, ECookedFormat::BC3, ECookedFormat::BC4, ECookedFormat::BC5, ECookedFormat::BC7 })
+	{
+		const std::string_view formatName = ToString(format);
+		if (std::ranges::equal(Name, formatName, [](char A, char B) { return std::toupper(A) == std::toupper(B); }))
+		{
+			OutFormat = format;
+			return true;
+		}
+	}
+	return false;
+}
+
+uint32_t GetDXGIFormat(ECookedFormat Format)
+{
+	switch (Format)
+	{
+	case ECookedFormat::RGBA8:
+		return 28; // DXGI_FORMAT_R8G8B8A8_UNORM
+	case ECookedFormat::BC1:
+		return 71; // DXGI_FORMAT_BC1_UNORM
+	case ECookedFormat::BC3:
+		return 77; // DXGI_FORMAT_BC3_UNORM
+	case ECookedFormat::BC4:
+		return 80; // DXGI_FORMAT_BC4_UNORM
+	case ECookedFormat::BC5:
+		return 83; // DXGI_FORMAT_BC5_UNORM
+	case ECookedFormat::BC7:
+		return 98; // DXGI_FORMAT_BC7_UNORM
+	}
+	return 0;
+}
+
+uint32_t GetBlockByteSize(ECookedFormat Format)
+{
+	switch (Format)
+	{
+	case ECookedFormat::BC1:
+	case ECookedFormat::BC4:
+		return 8;
+	case ECookedFormat::BC3:
+	case ECookedFormat::BC5:
+	case ECookedFormat::BC7:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+SCookSettings GetCookSettingsForType(std::string_view TypeName)
+{
+	SCookSettings settings;
+	if (TypeName == "Normal")
+	{
+		settings.Format = ECookedFormat::BC5;
+		settings.bSRGB = false;
+		settings.bNormalMap = true;
+	}
+	else if (TypeName == "Height" || TypeName == "Occlusion" || TypeName == "Roughness" || TypeName == "Alpha")
+	{
+		settings.Format = ECookedFormat::BC4;
+		settings.bSRGB = false;
+	}
+	return settings;
+}
+
+size_t SCookedTexture::GetByteSize() const
+{
+	size_t size = 0;
+	for (const auto& mip : Mips)
+	{
+		size += mip.Data.size();
+	}
+	return size;
+}
+
+std::vector<STextureImage> TextureCooker::GenerateMips(const STextureImage& Source, const SCookSettings& Settings)
+{
+	std::vector<STextureImage> mips = { Source };
+	if (!Settings.bGenerateMips)
+	{
+		return mips;
+	}
+
+	// Every level is filtered from the previous one in linear space
+	SFloatImage current = ToFloatImage(Source, Settings);
+	while (current.Width > 1 || current.Height > 1)
+	{
+		current = Settings.Filter == EMipFilter::Kaiser ? DownsampleKaiser(current) : DownsampleBox(current);
+		mips.push_back(ToTextureImage(current, Settings));
+	}
+	return mips;
+}
+
+void TextureCooker::EncodeBC1Block(const uint8_t (&Rgba)[64], uint8_t* OutBlock)
+{
+	float pixels[16][3];
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			pixels[i][c] = Rgba[i * 4 + c];
+		}
+	}
+
+	float low[3], high[3];
+	FindEndpoints(pixels, low, high);
+
+	// Inset the endpoints to reduce the error of the extremes
+	for (int c = 0; c < 3; c++)
+	{
+		const float inset = (high[c] - low[c]) / 16.0f;
+		low[c] += inset;
+		high[c] -= inset;
+	}
+
+	uint16_t color0 = To565(high);
+	uint16_t color1 = To565(low);
+	if (color0 < color1)
+	{
+		std::swap(color0, color1);
+	}
+
+	uint32_t indices = 0;
+	if (color0 != color1)
+	{
+		int32_t palette[4][3];
+		From565(color0, palette[0]);
+		From565(color1, palette[1]);
+		for (int c = 0; c < 3; c++)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			int32_t bestError = INT32_MAX;
+			uint32_t bestIndex = 0;
+			for (uint32_t p = 0; p < 4; p++)
+			{
+				int32_t error = 0;
+				for (int c = 0; c < 3; c++)
+				{
+					const int32_t delta = Rgba[i * 4 + c] - palette[p][c];
+					error += delta * delta;
+				}
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = p;
+				}
+			}
+			indices |= bestIndex << (i * 2);
+		}
+	}
+
+	OutBlock[0] = color0 & 0xff;
+	OutBlock[1] = color0 >> 8;
+	OutBlock[2] = color1 & 0xff;
+	OutBlock[3] = color1 >> 8;
+	for (int i = 0; i < 4; i++)
+	{
+		OutBlock[4 + i] = (indices >> (i * 8)) & 0xff;
+	}
+}
+
+void TextureCooker::EncodeBC4Block(const uint8_t (&Values)[16], uint8_t* OutBlock)
+{
+	const auto [minIt, maxIt] = std::minmax_element(std::begin(Values), std::end(Values));
+	const int32_t high = *maxIt;
+	const int32_t low = *minIt;
+
+	OutBlock[0] = static_cast<uint8_t>(high);
+	OutBlock[1] = static_cast<uint8_t>(low);
+
+	uint64_t indices = 0;
+	if (high != low)
+	{
+		// 8 value mode: 0 - high, 1 - low, 2..7 interpolated from high to low
+		int32_t palette[8] = { high, low };
+		for (int32_t i = 2; i < 8; i++)
+		{
+			palette[i] = ((8 - i) * high + (i - 1) * low) / 7;
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			int32_t bestError = INT32_MAX;
+			uint64_t bestIndex = 0;
+			for (uint64_t p = 0; p < 8; p++)
+			{
+				const int32_t error = std::abs(Values[i] - palette[p]);
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = p;
+				}
+			}
+			indices |= bestIndex << (i * 3);
+		}
+	}
+
+	for (int i = 0; i < 6; i++)
+	{
+		OutBlock[2 + i] = (indices >> (i * 8)) & 0xff;
+	}
+}
+
+void TextureCooker::EncodeBC7Block(const uint8_t (&Rgba)[64], uint8_t* OutBlock)
+{
+	// Mode 6 only: one subset, 7 bit RGBA endpoints with a unique p-bit each and 4 bit indices
+	static constexpr int32_t weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	float pixels[16][4];
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			pixels[i][c] = Rgba[i * 4 + c];
+		}
+	}
+
+	float endpoints[2][4];
+	FindEndpoints(pixels, endpoints[0], endpoints[1]);
+
+	int32_t quantized[2][4];
+	int32_t pbits[2];
+	int32_t colors[2][4];
+	for (int e = 0; e < 2; e++)
+	{
+		int32_t bestError = INT32_MAX;
+		for (int32_t p = 0; p < 2; p++)
+		{
+			int32_t error = 0;
+			int32_t candidate[4];
+			for (int c = 0; c < 4; c++)
+			{
+				candidate[c] = std::clamp(static_cast<int32_t>(std::lround((endpoints[e][c] - p) / 2.0f)), 0, 127);
+				const int32_t delta = ((candidate[c] << 1) | p) - static_cast<int32_t>(endpoints[e][c]);
+				error += delta * delta;
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				pbits[e] = p;
+				std::memcpy(quantized[e], candidate, sizeof(candidate));
+			}
+		}
+		for (int c = 0; c < 4; c++)
+		{
+			colors[e][c] = (quantized[e][c] << 1) | pbits[e];
+		}
+	}
+
+	int32_t palette[16][4];
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			palette[i][c] = ((64 - weights[i]) * colors[0][c] + weights[i] * colors[1][c] + 32) >> 6;
+		}
+	}
+
+	uint32_t indices[16];
+	for (int i = 0; i < 16; i++)
+	{
+		int32_t bestError = INT32_MAX;
+		indices[i] = 0;
+		for (uint32_t p = 0; p < 16; p++)
+		{
+			int32_t error = 0;
+			for (int c = 0; c < 4; c++)
+			{
+				const int32_t delta = Rgba[i * 4 + c] - palette[p][c];
+				error += delta * delta;
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				indices[i] = p;
+			}
+		}
+	}
+
+	// The anchor index is stored without its top bit
+	if (indices[0] & 8)
+	{
+		std::swap(quantized[0], quantized[1]);
+		std::swap(pbits[0], pbits[1]);
+		for (auto& index : indices)
+		{
+			index = 15 - index;
+		}
+	}
+
+	std::memset(OutBlock, 0, 16);
+	SBitWriter writer{ OutBlock };
+	writer.Write(1u << 6, 7);
+	for (int c = 0; c < 4; c++)
+	{
+		writer.Write(quantized[0][c], 7);
+		writer.Write(quantized[1][c], 7);
+	}
+	writer.Write(pbits[0], 1);
+	writer.Write(pbits[1], 1);
+	writer.Write(indices[0], 3);
+	for (int i = 1; i < 16; i++)
+	{
+		writer.Write(indices[i], 4);
+	}
+}
+
+SCookedMip TextureCooker::Compress(const STextureImage& Image, ECookedFormat Format, uint32_t NumThreads)
+{
+	SCookedMip mip;
+	mip.Width = Image.Width;
+	mip.Height = Image.Height;
+
+	const uint32_t blockSize = GetBlockByteSize(Format);
+	if (blockSize == 0)
+	{
+		mip.RowPitch = Image.Width * 4;
+		mip.Data = Image.Pixels;
+		return mip;
+	}
+
+	const uint32_t blocksX = std::max((Image.Width + 3) / 4, 1u);
+	const uint32_t blocksY = std::max((Image.Height + 3) / 4, 1u);
+	mip.RowPitch = blocksX * blockSize;
+	mip.Data.resize(static_cast<size_t>(mip.RowPitch) * blocksY);
+
+	auto encodeRows = [&](uint32_t FirstRow, uint32_t LastRow) {
+		uint8_t rgba[64];
+		uint8_t channel0[16];
+		uint8_t channel1[16];
+		for (uint32_t by = FirstRow; by < LastRow; by++)
+		{
+			for (uint32_t bx = 0; bx < blocksX; bx++)
+			{
+				// Blocks on the border repeat the last texel
+				for (uint32_t i = 0; i < 16; i++)
+				{
+					const uint32_t x = std::min(bx * 4 + i % 4, Image.Width - 1);
+					const uint32_t y = std::min(by * 4 + i / 4, Image.Height - 1);
+					std::memcpy(&rgba[i * 4], &Image.Pixels[(static_cast<size_t>(y) * Image.Width + x) * 4], 4);
+				}
+
+				uint8_t* block = &mip.Data[static_cast<size_t>(by) * mip.RowPitch + bx * blockSize];
+				switch (Format)
+				{
+				case ECookedFormat::BC1:
+					EncodeBC1Block(rgba, block);
+					break;
+				case ECookedFormat::BC3:
+					for (int i = 0; i < 16; i++)
+					{
+						channel0[i] = rgba[i * 4 + 3];
+					}
+					EncodeBC4Block(channel0, block);
+					EncodeBC1Block(rgba, block + 8);
+					break;
+				case ECookedFormat::BC4:
+					for (int i = 0; i < 16; i++)
+					{
+						channel0[i] = rgba[i * 4];
+					}
+					EncodeBC4Block(channel0, block);
+					break;
+				case ECookedFormat::BC5:
+					for (int i = 0; i < 16; i++)
+					{
+						channel0[i] = rgba[i * 4];
+						channel1[i] = rgba[i * 4 + 1];
+					}
+					EncodeBC4Block(channel0, block);
+					EncodeBC4Block(channel1, block + 8);
+					break;
+				case ECookedFormat::BC7:
+					EncodeBC7Block(rgba, block);
+					break;
+				default:
+					break;
+				}
+			}
+		}
+	};
+
+	uint32_t numThreads = NumThreads > 0 ? NumThreads : std::max(std::thread::hardware_concurrency(), 1u);
+	if (blocksX * blocksY < 256)
+	{
+		numThreads = 1;
+	}
+	numThreads = std::min(numThreads, blocksY);
+
+	// Block rows never overlap, each thread writes its own part of the output
+	const uint32_t rowsPerThread = (blocksY + numThreads - 1) / numThreads;
+	std::vector<std::future<void>> futures;
+	for (uint32_t thread = 1; thread < numThreads; thread++)
+	{
+		const uint32_t first = thread * rowsPerThread;
+		const uint32_t last = std::min(first + rowsPerThread, blocksY);
+		if (first < last)
+		{
+			futures.push_back(std::async(std::launch::async, encodeRows, first, last));
+		}
+	}
+	encodeRows(0, std::min(rowsPerThread, blocksY));
+	for (auto& future : futures)
+	{
+		future.get();
+	}
+	return mip;
+}
+
+SCookedTexture TextureCooker::Cook(const STextureImage& Source, const SCookSettings& Settings)
+{
+	SCookedTexture texture;
+	texture.Format = Settings.Format;
+
+	// BC5 drops alpha, normal maps that carry data there (water shininess) keep it with BC7
+	if (texture.Format == ECookedFormat::BC5)
+	{
+		for (size_t i = 3; i < Source.Pixels.size(); i += 4)
+		{
+			if (Source.Pixels[i] != 255)
+			{
+				texture.Format = ECookedFormat::BC7;
+				break;
+			}
+		}
+	}
+
+	// D3D12 requires the top level of a block compressed texture to be a multiple of 4
+	if (GetBlockByteSize(texture.Format) != 0 && (Source.Width % 4 != 0 || Source.Height % 4 != 0))
+	{
+		texture.Format = ECookedFormat::RGBA8;
+	}
+
+	for (const auto& mip : GenerateMips(Source, Settings))
+	{
+		texture.Mips.push_back(Compress(mip, texture.Format, Settings.NumThreads));
+	}
+	return texture;
+}
+
+bool TextureCooker::LoadSourceImage(const std::filesystem::path& Path, STextureImage& OutImage)
+{
+	const auto bytes = ReadFile(Path);
+	return !bytes.empty() && DecodeImage(bytes, OutImage);
+}
+
+bool TextureCooker::WriteDDS(const std::filesystem::path& Path, const SCookedTexture& Texture)
+{
+	if (Texture.Mips.empty())
+	{
+		return false;
+	}
+
+	constexpr uint32_t ddsMagic = 0x20534444; // "DDS "
+	constexpr uint32_t fourCCDX10 = 0x30315844; // "DX10"
+	const auto& top = Texture.Mips.front();
+	const bool bCompressed = GetBlockByteSize(Texture.Format) != 0;
+
+	SDDSHeader header{};
+	header.Size = sizeof(SDDSHeader);
+	header.Flags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | (bCompressed ? 0x80000 : 0x8); // CAPS | HEIGHT | WIDTH | PIXELFORMAT | MIPMAPCOUNT | LINEARSIZE or PITCH
+	header.Height = top.Height;
+	header.Width = top.Width;
+	header.PitchOrLinearSize = bCompressed ? static_cast<uint32_t>(top.Data.size()) : top.RowPitch;
+	header.MipMapCount = static_cast<uint32_t>(Texture.Mips.size());
+	header.PixelFormat.Size = sizeof(SDDSPixelFormat);
+	header.PixelFormat.Flags = 0x4; // FOURCC
+	header.PixelFormat.FourCC = fourCCDX10;
+	header.Caps = 0x1000 | (Texture.Mips.size() > 1 ? 0x400008 : 0); // TEXTURE | MIPMAP | COMPLEX
+
+	SDDSHeaderDX10 headerDX10{};
+	headerDX10.DXGIFormat = GetDXGIFormat(Texture.Format);
+	headerDX10.ResourceDimension = 3; // D3D12_RESOURCE_DIMENSION_TEXTURE2D
+	headerDX10.ArraySize = 1;
+
+	std::ofstream file(Path, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		return false;
+	}
+	file.write(reinterpret_cast<const char*>(&ddsMagic), sizeof(ddsMagic));
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(&headerDX10), sizeof(headerDX10));
+	for (const auto& mip : Texture.Mips)
+	{
+		file.write(reinterpret_cast<const char*>(mip.Data.data()), static_cast<std::streamsize>(mip.Data.size()));
+	}
+	return file.good();
+}
+
+uint64_t TextureCooker::Hash(const void* Data, size_t Size, uint64_t Seed)
+{
+	// FNV-1a
+	auto bytes = static_cast<const uint8_t*>(Data);
+	uint64_t hash = Seed;
+	for (size_t i = 0; i < Size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+OTextureCooker::OTextureCooker(std::filesystem::path InCacheDirectory)
+    : CacheDirectory(std::move(InCacheDirectory))
+{
+}
+
+std::filesystem::path OTextureCooker::CookFile(const std::filesystem::path& Source, const SCookSettings& Settings)
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+	auto finish = [&](std::filesystem::path Result, uint32_t SCookStats::*Counter) {
+		std::lock_guard lock(StatsLock);
+		Stats.*Counter += 1;
+		Stats.Milliseconds += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		return Result;
+	};
+
+	const auto bytes = ReadFile(Source);
+	if (bytes.empty())
+	{
+		return finish({}, &SCookStats::NumFailed);
+	}
+
+	// Thread count does not change the output
+	const uint8_t settingsKey[] = {
+		static_cast<uint8_t>(Settings.Format),
+		static_cast<uint8_t>(Settings.Filter),
+		Settings.bGenerateMips,
+		Settings.bSRGB,
+		Settings.bNormalMap,
+		static_cast<uint8_t>(Version)
+	};
+	const uint64_t key = TextureCooker::Hash(settingsKey, sizeof(settingsKey), TextureCooker::Hash(bytes.data(), bytes.size()));
+	auto cachePath = GetCachePath(Source, key);
+
+	std::error_code error;
+	if (std::filesystem::exists(cachePath, error))
+	{
+		return finish(cachePath, &SCookStats::NumCacheHits);
+	}
+
+	STextureImage image;
+	if (!DecodeImage(bytes, image))
+	{
+		return finish({}, &SCookStats::NumFailed);
+	}
+
+	const auto texture = TextureCooker::Cook(image, Settings);
+
+	// Written aside and renamed, an interrupted cook never leaves a truncated cache entry
+	std::filesystem::create_directories(CacheDirectory, error);
+	auto tempPath = cachePath;
+	tempPath += ".tmp";
+	if (!TextureCooker::WriteDDS(tempPath, texture))
+	{
+		return finish({}, &SCookStats::NumFailed);
+	}
+	std::filesystem::rename(tempPath, cachePath, error);
+	if (error)
+	{
+		std::filesystem::remove(tempPath, error);
+		return finish({}, &SCookStats::NumFailed);
+	}
+
+	{
+		std::lock_guard lock(StatsLock);
+		Stats.SourceBytes += image.Pixels.size();
+		Stats.CookedBytes += texture.GetByteSize();
+	}
+	return finish(cachePath, &SCookStats::NumCooked);
+}
+
+std::filesystem::path OTextureCooker::GetCachePath(const std::filesystem::path& Source, uint64_t Key) const
+{
+	return CacheDirectory / std::format("{}_{:016x}.dds", Source.stem().string(), Key);
+}
+
+const std::filesystem::path& OTextureCooker::GetCacheDirectory() const
+{
+	return CacheDirectory;
+}
+
+SCookStats OTextureCooker::GetStats() const
+{
+	std::lock_guard lock(StatsLock);
+	return Stats;
+}
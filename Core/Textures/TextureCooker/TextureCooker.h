@@ -0,0 +1,131 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Offline cooking of the STB loaded textures: mip chain generation and BCn block compression.
+ * The result is cached as a DDS with the DX10 header, keyed by the hash of the source file and the cook settings.
+ * No D3D dependencies, the same code runs in the engine and in the headless batch tool.
+ */
+
+enum class ECookedFormat : uint8_t
+{
+	RGBA8,
+	BC1,
+	BC3,
+	BC4,
+	BC5,
+	BC7
+};
+
+enum class EMipFilter : uint8_t
+{
+	Box,
+	Kaiser
+};
+
+const char* ToString(ECookedFormat Format);
+bool ParseCookedFormat(std::string_view Name, ECookedFormat& OutFormat);
+
+// DXGI_FORMAT value written into the DX10 header
+uint32_t GetDXGIFormat(ECookedFormat Format);
+
+// Bytes per 4x4 block, 0 for uncompressed formats
+uint32_t GetBlockByteSize(ECookedFormat Format);
+
+struct SCookSettings
+{
+	ECookedFormat Format = ECookedFormat::BC7;
+	EMipFilter Filter = EMipFilter::Kaiser;
+	bool bGenerateMips = true;
+
+	// Color data is filtered in linear space, the stored format stays UNORM
+	bool bSRGB = true;
+
+	// Every mip is renormalized, only RG are meaningful after BC5 compression
+	bool bNormalMap = false;
+
+	// 0 - use all hardware threads
+	uint32_t NumThreads = 0;
+};
+
+/** @brief Default settings by the texture type name (Diffuse, Normal, Height, ...) */
+SCookSettings GetCookSettingsForType(std::string_view TypeName);
+
+struct STextureImage
+{
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+
+	// RGBA8, rows are tightly packed
+	std::vector<uint8_t> Pixels;
+};
+
+struct SCookedMip
+{
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	uint32_t RowPitch = 0;
+	std::vector<uint8_t> Data;
+};
+
+struct SCookedTexture
+{
+	ECookedFormat Format = ECookedFormat::RGBA8;
+	std::vector<SCookedMip> Mips;
+
+	size_t GetByteSize() const;
+};
+
+namespace TextureCooker
+{
+std::vector<STextureImage> GenerateMips(const STextureImage& Source, const SCookSettings& Settings);
+SCookedMip Compress(const STextureImage& Image, ECookedFormat Format, uint32_t NumThreads);
+SCookedTexture Cook(const STextureImage& Source, const SCookSettings& Settings);
+
+bool LoadSourceImage(const std::filesystem::path& Path, STextureImage& OutImage);
+bool WriteDDS(const std::filesystem::path& Path, const SCookedTexture& Texture);
+
+uint64_t Hash(const void* Data, size_t Size, uint64_t Seed = 0xcbf29ce484222325ull);
+
+// Block encoders, the input is a 4x4 block in row order
+void EncodeBC1Block(const uint8_t (&Rgba)[64], uint8_t* OutBlock);
+void EncodeBC4Block(const uint8_t (&Values)[16], uint8_t* OutBlock);
+void EncodeBC7Block(const uint8_t (&Rgba)[64], uint8_t* OutBlock);
+} // namespace TextureCooker
+
+struct SCookStats
+{
+	uint32_t NumCooked = 0;
+	uint32_t NumCacheHits = 0;
+	uint32_t NumFailed = 0;
+	size_t SourceBytes = 0;
+	size_t CookedBytes = 0;
+	float Milliseconds = 0.0f;
+};
+
+class OTextureCooker
+{
+public:
+	explicit OTextureCooker(std::filesystem::path InCacheDirectory);
+
+	/** @brief Returns the cached DDS of the source, cooks it if the cache is missing or stale. Returns an empty path on failure.
+	 * Thread safe for distinct source and settings pairs */
+	std::filesystem::path CookFile(const std::filesystem::path& Source, const SCookSettings& Settings);
+
+	std::filesystem::path GetCachePath(const std::filesystem::path& Source, uint64_t Key) const;
+	const std::filesystem::path& GetCacheDirectory() const;
+	SCookStats GetStats() const;
+
+	// Bumped whenever the cooked output changes for the same input
+	static constexpr uint32_t Version = 1;
+
+private:
+	std::filesystem::path CacheDirectory;
+	mutable std::mutex StatsLock;
+	SCookStats Stats;
+};
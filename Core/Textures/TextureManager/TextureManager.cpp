@@ -3,18 +3,23 @@
 #include "Application.h"
 #include "CommandQueue/CommandQueue.h"
 #include "DDSTextureLoader/DDSTextureLoader.h"
+#include "DirectX/DXHelper.h"
+#include "Engine/Engine.h"
+#include "Engine/UploadBuffer/UploadManager.h"
 #include "Exception.h"
 #include "Logger.h"
 
 #include <filesystem>
+#include <future>
 #include <numeric>
 #include <ranges>
 #include <unordered_set>
 
-OTextureManager::OTextureManager(ID3D12Device* Device, OCommandQueue* Queue)
-    : Device(Device), CommandQueue(Queue)
+OTextureManager::OTextureManager(ID3D12Device* Device, OCommandQueue* Queue, OUploadManager* Uploads)
+    : Device(Device), CommandQueue(Queue), Uploads(Uploads)
 {
 	Parser = make_unique<OTexturesParser>(OApplication::Get()->GetConfigPath("TexturesConfigPath"));
+	Cooker = make_unique<OTextureCooker>(OApplication::Get()->GetConfigPath("TextureCacheDirectory"));
 }
 
 uint32_t OTextureManager::GetNum2DTextures() const
@@ -56,11 +61,11 @@ void OTextureManager::LoadLocalTextures()
 	for (const auto& texture : Parser->LoadTextures())
 	{
 		TexturesHeapIndicesTable.insert(texture->TextureIndex);
-		THROW_IF_FAILED(DirectX::CreateDDSTextureFromFile12(Device,
-		                                                    CommandQueue->GetCommandList().Get(),
-		                                                    OApplication::Get()->GetResourcePath(texture->FileName).c_str(),
-		                                                    texture->Resource.Resource,
-		                                                    texture->UploadHeap.Resource));
+		THROW_IF_FAILED(DirectX::CreateDDSTextureFromFileMapped12(Device,
+		                                                          Uploads,
+		                                                          OApplication::Get()->GetResourcePath(texture->FileName),
+		                                                          texture->Resource.Resource));
+		texture->UploadTicket = Uploads->GetOpenTicket();
 		auto weak = weak_from_this();
 		texture->Resource.Init(weak, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 		texture->Resource.Resource->SetName(texture->FileName.c_str());
@@ -74,6 +79,10 @@ void OTextureManager::LoadLocalTextures()
 
 void OTextureManager::RemoveAllTextures()
 {
+	for (const auto& texture : Textures | std::views::values)
+	{
+		OEngine::Get()->RemoveTextureDescriptor(texture.get());
+	}
 	TexturesHeapIndicesTable.clear();
 	Textures.clear();
 	TexturesPath.clear();
@@ -108,6 +117,7 @@ void OTextureManager::AddTexture(unique_ptr<STexture> Texture)
 		return;
 	}
 
+	OEngine::Get()->AddTextureDescriptor(Texture.get());
 	TexturesPath[Texture->FileName] = Texture.get();
 	Textures[Texture->Name] = move(Texture);
 }
@@ -119,6 +129,7 @@ void OTextureManager::RemoveTexture(const string& Name)
 		return;
 	}
 	auto texture = Textures.at(Name).get();
+	OEngine::Get()->RemoveTextureDescriptor(texture);
 	TexturesPath.erase(texture->FileName);
 	Textures.erase(Name);
 }
@@ -130,11 +141,62 @@ void OTextureManager::RemoveTexture(const wstring& Path)
 		return;
 	}
 	auto texture = TexturesPath.at(Path);
+	OEngine::Get()->RemoveTextureDescriptor(texture);
 	TexturesPath.erase(Path);
 	Textures.erase(texture->Name);
 }
 
-STexture* OTextureManager::CreateTexture(const string& Name, wstring FileName)
+std::filesystem::path OTextureManager::CookTexture(const std::filesystem::path& Path, ETextureType Type)
+{
+	PROFILE_SCOPE();
+	const auto settings = GetCookSettingsForType(WStringToUTF8(ToString(Type)));
+	auto cooked = Cooker->CookFile(Path, settings);
+	if (cooked.empty())
+	{
+		LOG(Engine, Warning, "Failed to cook texture: {}, loading the source", Path.wstring());
+	}
+	return cooked;
+}
+
+void OTextureManager::CookTextures(const vector<pair<wstring, ETextureType>>& Requests)
+{
+	PROFILE_SCOPE();
+	if (!bCookTextures || Requests.empty())
+	{
+		return;
+	}
+
+	std::atomic<size_t> next = 0;
+	auto cook = [&]() {
+		for (size_t idx = next++; idx < Requests.size(); idx = next++)
+		{
+			const auto& [path, type] = Requests[idx];
+			if (std::filesystem::path(path).extension() == ".dds")
+			{
+				continue;
+			}
+
+			// Textures are spread across the threads, one texture is compressed on one thread
+			auto settings = GetCookSettingsForType(WStringToUTF8(ToString(type)));
+			settings.NumThreads = 1;
+			Cooker->CookFile(path, settings);
+		}
+	};
+
+	const size_t numThreads = std::min<size_t>(Requests.size(), std::max(std::thread::hardware_concurrency(), 1u));
+	vector<std::future<void>> futures;
+	for (size_t idx = 1; idx < numThreads; idx++)
+	{
+		futures.push_back(std::async(std::launch::async, cook));
+	}
+	cook();
+	for (auto& future : futures)
+	{
+		future.get();
+	}
+}
+
+STexture* OTextureManager::CreateTexture(const string& Name, wstring FileName, ETextureType Type)
 {
 	auto name = Name;
 	if (Textures.contains(name))
@@ -157,9 +219,20 @@ STexture* OTextureManager::CreateTexture(const string& Name, wstring FileName)
 	auto texture = make_unique<STexture>();
 	texture->Name = name;
 	texture->FileName = FileName;
+	texture->Type = Type;
+
+	auto loadPath = path;
+	if (bCookTextures && path.extension() != ".dds")
+	{
+		if (auto cooked = CookTexture(path, Type); !cooked.empty())
+		{
+			loadPath = cooked;
+		}
+	}
 
-	auto res = DirectX::LoadTexture(FileName, Device, CommandQueue->GetCommandList().Get(), texture->Resource.Resource, texture->UploadHeap.Resource, path.extension() == ".dds");
+	auto res = DirectX::LoadTexture(loadPath, Device, Uploads, texture->Resource.Resource, loadPath.extension() == ".dds");
 	CWIN_LOG(!SUCCEEDED(res), Engine, Error, "Failed to load texture from file: {}", FileName);
+	texture->UploadTicket = Uploads->GetOpenTicket();
 	texture->Resource.Init(weak_from_this(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 	texture->Resource.Resource->SetName(path.filename().c_str());
 	if (texture->Type == ETextureType::Height)
@@ -174,10 +247,10 @@ STexture* OTextureManager::CreateTexture(const string& Name, wstring FileName)
 	return result;
 }
 
-STexture* OTextureManager::CreateTexture(const wstring& FileName)
+STexture* OTextureManager::CreateTexture(const wstring& FileName, ETextureType Type)
 {
 	auto path = std::filesystem::path(FileName);
-	return CreateTexture(path.filename().stem().string(), FileName);
+	return CreateTexture(path.filename().stem().string(), FileName, Type);
 }
 
 STexture* OTextureManager::FindTextureByName(string Name) const
@@ -199,22 +272,22 @@ STexture* OTextureManager::FindTextureByPath(wstring Path) const
 	return TexturesPath.at(Path);
 }
 
-STexture* OTextureManager::FindOrCreateTexture(wstring FileName)
+STexture* OTextureManager::FindOrCreateTexture(wstring FileName, ETextureType Type)
 {
 	if (auto texture = FindTextureByPath(FileName); texture)
 	{
 		return texture;
 	}
-	return CreateTexture(FileName);
+	return CreateTexture(FileName, Type);
 }
 
-STexture* OTextureManager::FindOrCreateTexture(string Name, wstring FileName)
+STexture* OTextureManager::FindOrCreateTexture(string Name, wstring FileName, ETextureType Type)
 {
 	if (auto texture = FindTextureByPath(FileName); texture)
 	{
 		return texture;
 	}
-	return CreateTexture(Name, FileName);
+	return CreateTexture(Name, FileName, Type);
 }
 
 void OTextureManager::InitRenderObject()
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Texture.h"
+#include "TextureCooker/TextureCooker.h"
 #include "TexturesReader/TexturesParser.h"
 
 #include <unordered_map>
@@ -8,20 +9,24 @@
 
 class OCommandQueue;
 class OEngine;
+class OUploadManager;
 class OTextureManager : public IRenderObject
 {
 public:
 	using TTexturesMap = std::unordered_map<string, unique_ptr<STexture>>;
 	using TTexturesMapPath = std::unordered_map<wstring, STexture*>;
-	OTextureManager(ID3D12Device* Device, OCommandQueue* CommandList);
+	OTextureManager(ID3D12Device* Device, OCommandQueue* CommandList, OUploadManager* Uploads);
 
-	STexture* CreateTexture(const string& Name, wstring FileName);
-	STexture* CreateTexture(const wstring& FileName);
+	STexture* CreateTexture(const string& Name, wstring FileName, ETextureType Type = ETextureType::Diffuse);
+	STexture* CreateTexture(const wstring& FileName, ETextureType Type = ETextureType::Diffuse);
 
 	STexture* FindTextureByName(string Name) const;
 	STexture* FindTextureByPath(wstring Path) const;
-	STexture* FindOrCreateTexture(wstring FileName);
-	STexture* FindOrCreateTexture(string Name, wstring FileName);
+	STexture* FindOrCreateTexture(wstring FileName, ETextureType Type = ETextureType::Diffuse);
+	STexture* FindOrCreateTexture(string Name, wstring FileName, ETextureType Type = ETextureType::Diffuse);
+
+	// Cooks the sources on worker threads, the following CreateTexture calls only load the cached result
+	void CookTextures(const vector<pair<wstring, ETextureType>>& Requests);
 	void InitRenderObject() override;
 	TTexturesMap& GetTextures() { return Textures; }
 	uint32_t GetNum2DTextures() const;
@@ -32,17 +37,24 @@ public:
 	wstring GetName() const override;
 	const uint32_t MaxNumberOf2DTextures = 50;
 
+	// Non DDS textures are loaded from the cooked cache with mips and block compression
+	bool bCookTextures = true;
+	const OTextureCooker* GetCooker() const { return Cooker.get(); }
+
 private:
 	void AddTexture(unique_ptr<STexture> Texture);
 	void RemoveAllTextures();
 	void RemoveTexture(const string& Name);
 	void RemoveTexture(const wstring& Path);
+	std::filesystem::path CookTexture(const std::filesystem::path& Path, ETextureType Type);
 
 private:
 	wstring Name = L"TextureManager";
 	unique_ptr<OTexturesParser> Parser;
+	unique_ptr<OTextureCooker> Cooker;
 	ID3D12Device* Device;
 	OCommandQueue* CommandQueue;
+	OUploadManager* Uploads;
 	inline static std::unordered_set<uint32_t> TexturesHeapIndicesTable = {};
 	TTexturesMap Textures;
 	TTexturesMapPath TexturesPath;
@@ -3,3 +3,10 @@
 #define ENABLE_PROFILER 0
 #define DEBUG false
 #define ENABLE_DEBUG_LAYER 0
+
+// Debug draw calls are compiled out of release builds
+#if defined(_DEBUG)
+#define ENABLE_DEBUG_DRAW 1
+#else
+#define ENABLE_DEBUG_DRAW 0
+#endif
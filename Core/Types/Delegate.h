@@ -0,0 +1,274 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Type erased handler of a delegate. Small callables are stored inline, larger ones are moved to the heap.
+ */
+template<typename ReturnType, typename... Args>
+class TDelegateHandler
+{
+public:
+	static constexpr size_t InlineSize = 4 * sizeof(void*);
+
+	TDelegateHandler() = default;
+	TDelegateHandler(const TDelegateHandler&) = delete;
+	TDelegateHandler& operator=(const TDelegateHandler&) = delete;
+
+	template<typename Func>
+	    requires(!std::is_same_v<std::decay_t<Func>, TDelegateHandler>)
+	explicit TDelegateHandler(Func&& Function)
+	{
+		using TFunc = std::decay_t<Func>;
+		if constexpr (sizeof(TFunc) <= InlineSize && alignof(TFunc) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<TFunc>)
+		{
+			new (Storage) TFunc(std::forward<Func>(Function));
+			Invoke = [](void* Self, Args... Arg) -> ReturnType {
+				return (*std::launder(static_cast<TFunc*>(Self)))(std::forward<Args>(Arg)...);
+			};
+			Manage = [](void* Self, void* Destination) {
+				auto function = std::launder(static_cast<TFunc*>(Self));
+				if (Destination)
+				{
+					new (Destination) TFunc(std::move(*function));
+				}
+				function->~TFunc();
+			};
+		}
+		else
+		{
+			new (Storage) TFunc*(new TFunc(std::forward<Func>(Function)));
+			Invoke = [](void* Self, Args... Arg) -> ReturnType {
+				return (**std::launder(static_cast<TFunc**>(Self)))(std::forward<Args>(Arg)...);
+			};
+			Manage = [](void* Self, void* Destination) {
+				auto function = *std::launder(static_cast<TFunc**>(Self));
+				if (Destination)
+				{
+					new (Destination) TFunc*(function);
+				}
+				else
+				{
+					delete function;
+				}
+			};
+		}
+	}
+
+	TDelegateHandler(TDelegateHandler&& Other) noexcept
+	{
+		*this = std::move(Other);
+	}
+
+	TDelegateHandler& operator=(TDelegateHandler&& Other) noexcept
+	{
+		if (this != &Other)
+		{
+			Reset();
+			if (Other.Manage)
+			{
+				Other.Manage(Other.Storage, Storage);
+				Invoke = std::exchange(Other.Invoke, nullptr);
+				Manage = std::exchange(Other.Manage, nullptr);
+			}
+		}
+		return *this;
+	}
+
+	~TDelegateHandler()
+	{
+		Reset();
+	}
+
+	void Reset()
+	{
+		if (Manage)
+		{
+			Manage(Storage, nullptr);
+			Invoke = nullptr;
+			Manage = nullptr;
+		}
+	}
+
+	template<typename... LocArgs>
+	ReturnType operator()(LocArgs&&... Arg)
+	{
+		return Invoke(Storage, std::forward<LocArgs>(Arg)...);
+	}
+
+private:
+	alignas(std::max_align_t) std::byte Storage[InlineSize];
+	ReturnType (*Invoke)(void*, Args...) = nullptr;
+
+	// Moves the callable to Destination and destroys the source, only destroys if Destination is null
+	void (*Manage)(void*, void*) = nullptr;
+};
+
+/**
+ * @brief Multicast delegate for use on one thread. The first InlineHandlers handlers live inside the delegate,
+ * so adding a few small handlers does not allocate and broadcasting neither locks nor allocates.
+ * Handlers added while broadcasting are called from the next broadcast, RemoveAll while broadcasting takes effect once it ends.
+ */
+template<typename ReturnType, typename... Args>
+struct SDelegate
+{
+	static constexpr uint32_t InlineHandlers = 2;
+	using THandler = TDelegateHandler<ReturnType, Args...>;
+
+	SDelegate() = default;
+	SDelegate(const SDelegate&) = delete;
+	SDelegate& operator=(const SDelegate&) = delete;
+	SDelegate(SDelegate&& Other) noexcept { *this = std::move(Other); }
+	SDelegate& operator=(SDelegate&& Other) noexcept
+	{
+		if (this != &Other)
+		{
+			for (uint32_t i = 0; i < InlineHandlers; i++)
+			{
+				Inline[i] = std::move(Other.Inline[i]);
+			}
+			Overflow = std::move(Other.Overflow);
+			Pending = std::move(Other.Pending);
+			NumHandlers = std::exchange(Other.NumHandlers, 0);
+		}
+		return *this;
+	}
+
+	template<typename Func>
+	void Add(Func&& Function)
+	{
+		THandler handler(std::forward<Func>(Function));
+		if (BroadcastDepth > 0)
+		{
+			Pending.push_back(std::move(handler));
+			return;
+		}
+		Push(std::move(handler));
+	}
+
+	template<typename Obj, typename Func>
+	void AddMember(Obj* Object, Func&& Function)
+	{
+		Add([Object, Function](Args... Arg) -> ReturnType {
+			return (Object->*Function)(std::forward<Args>(Arg)...);
+		});
+	}
+
+	void RemoveAll()
+	{
+		Pending.clear();
+		if (BroadcastDepth > 0)
+		{
+			bClearPending = true;
+			return;
+		}
+		Clear();
+	}
+
+	template<typename... LocArgs>
+	void Broadcast(LocArgs&&... Arg)
+	{
+		BroadcastDepth++;
+		const uint32_t numHandlers = NumHandlers;
+		for (uint32_t i = 0; i < numHandlers && !bClearPending; i++)
+		{
+			// Every handler sees the same arguments, they are never moved from
+			(i < InlineHandlers ? Inline[i] : Overflow[i - InlineHandlers])(Arg...);
+		}
+		BroadcastDepth--;
+
+		if (BroadcastDepth == 0)
+		{
+			if (bClearPending)
+			{
+				bClearPending = false;
+				Clear();
+			}
+			for (auto& handler : Pending)
+			{
+				Push(std::move(handler));
+			}
+			Pending.clear();
+		}
+	}
+
+	uint32_t GetNumHandlers() const { return NumHandlers; }
+
+private:
+	void Clear()
+	{
+		for (uint32_t i = 0; i < InlineHandlers; i++)
+		{
+			Inline[i].Reset();
+		}
+		Overflow.clear();
+		NumHandlers = 0;
+	}
+
+	void Push(THandler&& Handler)
+	{
+		if (NumHandlers < InlineHandlers)
+		{
+			Inline[NumHandlers] = std::move(Handler);
+		}
+		else
+		{
+			Overflow.push_back(std::move(Handler));
+		}
+		NumHandlers++;
+	}
+
+	THandler Inline[InlineHandlers];
+	std::vector<THandler> Overflow;
+	std::vector<THandler> Pending;
+	uint32_t NumHandlers = 0;
+	uint16_t BroadcastDepth = 0;
+	bool bClearPending = false;
+};
+
+/**
+ * @brief SDelegate guarded by a mutex, for the few delegates that are used from several threads.
+ * Handlers run under the lock, so they must not add handlers to the same delegate.
+ */
+template<typename ReturnType, typename... Args>
+struct SThreadSafeDelegate
+{
+	template<typename Func>
+	void Add(Func&& Function)
+	{
+		std::scoped_lock lock(Mutex);
+		Delegate.Add(std::forward<Func>(Function));
+	}
+
+	template<typename Obj, typename Func>
+	void AddMember(Obj* Object, Func&& Function)
+	{
+		std::scoped_lock lock(Mutex);
+		Delegate.AddMember(Object, std::forward<Func>(Function));
+	}
+
+	void RemoveAll()
+	{
+		std::scoped_lock lock(Mutex);
+		Delegate.RemoveAll();
+	}
+
+	template<typename... LocArgs>
+	void Broadcast(LocArgs&&... Arg)
+	{
+		std::scoped_lock lock(Mutex);
+		Delegate.Broadcast(std::forward<LocArgs>(Arg)...);
+	}
+
+private:
+	std::mutex Mutex;
+	SDelegate<ReturnType, Args...> Delegate;
+};
+
+#define DECLARE_DELEGATE(Type, ...) \
+	using Type = SDelegate<void, __VA_ARGS__>;
@@ -1,5 +1,6 @@
 #include "FrameResource.h"
 
+#include "Engine/UploadBuffer/UploadManager.h"
 #include "Statics.h"
 
 SFrameResource::SFrameResource(weak_ptr<ODevice> Device, weak_ptr<IRenderObject> Owner)
@@ -95,6 +96,25 @@ void SFrameResource::SetSpotLight(UINT LightCount)
 		LOG(Engine, Warning, "Point light count is 0");
 	}
 }
+void SFrameResource::SetClusteredLights(UINT LightCount, UINT ClusterCount, UINT IndexCount)
+{
+	// Buffers only grow, the content is rewritten every frame
+	auto ensure = [this]<typename T>(TUploadBuffer<T>& Buffer, UINT Count, const wstring& Name) {
+		Count = std::max(Count, 1u);
+		if (!Buffer)
+		{
+			Buffer = make_unique<OUploadBuffer<T>>(Device, Count, false, Owner, Name);
+		}
+		else if (Buffer->MaxOffset < Count)
+		{
+			Buffer->RebuildBuffer(Count);
+		}
+	};
+	ensure(ClusterLightBuffer, LightCount, L"_ClusterLightBuffer");
+	ensure(ClusterGridBuffer, ClusterCount, L"_ClusterGridBuffer");
+	ensure(ClusterLightIndexBuffer, IndexCount, L"_ClusterLightIndexBuffer");
+}
+
 void SFrameResource::SetSSAO()
 {
 	if (SsaoCB == nullptr)
@@ -111,10 +131,16 @@ void SFrameResource::SetFrusturmCorners()
 	}
 }
 
-void SFrameResource::RebuildInstanceBuffers(UINT InstanceCount) const
+void SFrameResource::RebuildInstanceBuffers(UINT InstanceCount, OUploadManager* Uploads) const
 {
 	for (const auto& val : InstanceBuffers | std::views::values)
 	{
+		Uploads->KeepAlive(val->UploadBuffer->Resource);
+		val->RebuildBuffer(InstanceCount);
+	}
+	for (const auto& val : InstanceExtraBuffers | std::views::values)
+	{
+		Uploads->KeepAlive(val->UploadBuffer->Resource);
 		val->RebuildBuffer(InstanceCount);
 	}
 }
@@ -128,6 +154,7 @@ OUploadBuffer<HLSL::InstanceData>* SFrameResource::AddNewInstanceBuffer(const ws
 	}
 
 	InstanceBuffers[Id] = make_unique<OUploadBuffer<HLSL::InstanceData>>(Device, InstanceCount, false, Owner, Name);
+	InstanceExtraBuffers[Id] = make_unique<OUploadBuffer<HLSL::InstanceExtraData>>(Device, InstanceCount, false, Owner, Name + L"_Extra");
 	LOG(Engine, Log, "Adding new instance buffer: {}, New Size: {}", Name, TEXT(InstanceBuffers.size()));
 
 	return InstanceBuffers[Id].get();
@@ -10,6 +10,8 @@
 #include <d3d12.h>
 #include <wrl/client.h>
 
+class OUploadManager;
+
 struct SSsaoConstants
 {
 	DirectX::XMFLOAT4X4 Proj;
@@ -48,17 +50,29 @@ struct SFrameResource
 	void SetDirectionalLight(UINT LightCount);
 	void SetPointLight(UINT LightCount);
 	void SetSpotLight(UINT LightCount);
+	void SetClusteredLights(UINT LightCount, UINT ClusterCount, UINT IndexCount);
 	void SetSSAO();
 	void SetFrusturmCorners();
-	void RebuildInstanceBuffers(UINT InstanceCount) const;
+
+	/** @brief The GPU may still read the old buffers, they are released once the work recorded so far completes */
+	void RebuildInstanceBuffers(UINT InstanceCount, OUploadManager* Uploads) const;
 	OUploadBuffer<HLSL::InstanceData>* AddNewInstanceBuffer(const wstring& Name, UINT InstanceCount, TUUID Id);
 	TUploadBuffer<SPassConstants> PassCB = nullptr;
 	TUploadBuffer<HLSL::MaterialData> MaterialBuffer = nullptr;
 	unordered_map<TUUID, TUploadBuffer<HLSL::InstanceData>> InstanceBuffers;
+
+	// Same ids and sizes as InstanceBuffers
+	unordered_map<TUUID, TUploadBuffer<HLSL::InstanceExtraData>> InstanceExtraBuffers;
 	TUploadBuffer<SSsaoConstants> SsaoCB = nullptr;
 	TUploadBuffer<HLSL::DirectionalLight> DirectionalLightBuffer;
 	TUploadBuffer<HLSL::PointLight> PointLightBuffer;
 	TUploadBuffer<HLSL::SpotLight> SpotLightBuffer;
+	TUploadBuffer<HLSL::ClusterLight> ClusterLightBuffer;
+	TUploadBuffer<HLSL::ClusterLightGrid> ClusterGridBuffer;
+	TUploadBuffer<uint32_t> ClusterLightIndexBuffer;
+
+	// The light grid of this frame is built by the light culling pass instead of the buffers above
+	bool bClusterLightsOnGPU = false;
 	TUploadBuffer<HLSL::FrustrumCorners> FrusturmCornersBuffer;
 	TUploadBuffer<HLSL::CameraMatrixBuffer> CameraMatrixBuffer;
 	// Fence value to mark commands up to this fence point. This lets us
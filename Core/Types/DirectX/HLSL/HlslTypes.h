@@ -31,6 +31,15 @@ namespace HLSL
 #define F0_COEFF 0.16f
 #define MAX_CSM_PER_FRAME 3
 
+#define CLUSTER_TILES_X 16
+#define CLUSTER_TILES_Y 9
+#define CLUSTER_SLICES_Z 24
+#define CLUSTER_MAX_LIGHTS 128
+#define CLUSTER_THREADS 64
+#define CLUSTER_SPOT_LIGHT_BIT 0x80000000
+
+#define INSTANCE_FLAG_EXTRA_DATA 0x1
+
 #define STRINGIFY(x) #x
 #define STRINGIFY_MACRO(x) STRINGIFY(x)
 #define CB_SSAO cbSsao
@@ -48,9 +57,15 @@ namespace HLSL
 #define CAMERA_MATRIX cbCameraMatrix
 #define AABBData gAABBData
 #define INSTANCE_DATA gInstanceData
+#define INSTANCE_EXTRA_DATA gInstanceExtraData
 #define NORMAL_MAP gNormalMap
 #define RANDOM_VEC_MAP gRandomVecMap
 #define DEPTH_MAP gDepthMap
+#define CLUSTER_LIGHTS gClusterLights
+#define CLUSTER_LIGHT_GRID gClusterLightGrid
+#define CLUSTER_LIGHT_INDICES gClusterLightIndices
+#define CLUSTER_LIGHT_GRID_UAV gClusterLightGridUAV
+#define CLUSTER_LIGHT_INDICES_UAV gClusterLightIndicesUAV
 struct TextureData
 {
 	uint bIsEnabled;
@@ -87,44 +102,57 @@ struct MaterialData
 	TextureData AmbientMap;
 };
 
+// Uploaded for every visible instance in every view, keep it small
 struct InstanceData
 {
 #ifndef HLSL
 	InstanceData()
 	{
-		DirectX::XMStoreFloat4x4(&World, DirectX::XMMatrixIdentity());
-		DirectX::XMStoreFloat4x4(&TexTransform, DirectX::XMMatrixIdentity());
-		Position = { 0.0f, 0.0f, 0.0f };
-		Rotation = { 0.0f, 0.0f, 0.0f, 1.0f };
-		Scale = { 1.0f, 1.0f, 1.0f };
+		World[0] = { 1.0f, 0.0f, 0.0f, 0.0f };
+		World[1] = { 0.0f, 1.0f, 0.0f, 0.0f };
+		World[2] = { 0.0f, 0.0f, 1.0f, 0.0f };
 		MaterialIndex = 0;
-		BoundingBoxCenter = { 0.0f, 0.0f, 0.0f };
-		BoundingBoxExtents = { 0.0f, 0.0f, 0.0f };
+		OverrideColor = 0xffffffff;
+		Flags = 0;
+		pad = 0;
 	}
+#endif
+
+	// Columns of the affine world matrix, the fourth one is always (0, 0, 0, 1)
+	float4 World[3];
+	uint MaterialIndex;
 
-	bool IsTransformEqual(const InstanceData& Other) const
+	// RGBA8
+	uint OverrideColor;
+	uint Flags;
+	uint pad;
+};
+
+// Rarely used fields, stored at the index of the instance and valid only with INSTANCE_FLAG_EXTRA_DATA
+struct InstanceExtraData
+{
+#ifndef HLSL
+	InstanceExtraData()
 	{
-		return Other.Position == Position && Other.Rotation == Rotation && Other.Scale == Scale;
+		DirectX::XMStoreFloat4x4(&TexTransform, DirectX::XMMatrixIdentity());
+		DirectX::XMStoreFloat4x4(&InvViewProjection, DirectX::XMMatrixIdentity());
+		BoundingBoxCenter = { 0.0f, 0.0f, 0.0f };
+		BoundingBoxExtents = { 0.0f, 0.0f, 0.0f };
 	}
 #endif
 
-	float4x4 World;
 	float4x4 TexTransform;
-	uint MaterialIndex;
-	float3 Position;
-	float pad;
-	float4 Rotation;
-	float3 Scale;
-	float pad3;
+	float4x4 InvViewProjection;
 	float3 BoundingBoxCenter;
-	float pad4;
+	float pad;
 	float3 BoundingBoxExtents;
-	float pad5;
-	float3 OverrideColor;
-	float pad6;
-	float4x4 InvViewProjection;
+	float pad2;
 };
 
+#ifndef HLSL
+static_assert(sizeof(InstanceData) == 64, "InstanceData has to match the HLSL layout");
+#endif
+
 struct SpotLight
 {
 	float3 Position;
@@ -152,6 +180,21 @@ struct PointLight
 	float4x4 Transform;
 };
 
+// View space bounding sphere of a point or spot light, Index has CLUSTER_SPOT_LIGHT_BIT set for spot lights
+struct ClusterLight
+{
+	float3 Position;
+	float Radius;
+	uint Index;
+	float3 pad;
+};
+
+struct ClusterLightGrid
+{
+	uint Offset;
+	uint Count;
+};
+
 struct CameraMatrixBuffer
 {
 	float4x4 gCamViewProj;
@@ -0,0 +1,93 @@
+#include "MeshGeometry.h"
+
+#include <ranges>
+
+bool SSubmeshGeometry::GetCollisionGeometry(SCollisionGeometry& OutGeometry, std::vector<float>& ScratchPositions, std::vector<uint32_t>& ScratchIndices) const
+{
+	if (Vertices && Indices)
+	{
+		OutGeometry = { &Vertices->data()->x, static_cast<uint32_t>(Vertices->size()), Indices->data(), static_cast<uint32_t>(Indices->size()) };
+		return true;
+	}
+	if (Compact)
+	{
+		Compact->Decode(ScratchPositions, ScratchIndices);
+		OutGeometry = { ScratchPositions.data(), Compact->GetNumVertices(), ScratchIndices.data(), Compact->GetNumIndices() };
+		return true;
+	}
+	return false;
+}
+
+uint64_t SSubmeshGeometry::GetCPUBytes() const
+{
+	uint64_t bytes = 0;
+	if (Vertices)
+	{
+		bytes += Vertices->capacity() * sizeof(DirectX::XMFLOAT3);
+	}
+	if (Indices)
+	{
+		bytes += Indices->capacity() * sizeof(uint32_t);
+	}
+	if (Compact)
+	{
+		bytes += Compact->GetByteSize();
+	}
+	return bytes;
+}
+
+void SMeshGeometry::SetResidency(EMeshResidency NewResidency)
+{
+	if (NewResidency > Residency)
+	{
+		LOG(Geometry, Warning, "Mesh {} can not get back the CPU geometry it released", TEXT(Name));
+		return;
+	}
+
+	UpdateMemory();
+	const uint64_t before = Memory.CPUBytes;
+	if (NewResidency < EMeshResidency::Full)
+	{
+		VertexBufferCPU = nullptr;
+		IndexBufferCPU = nullptr;
+	}
+	for (const auto& submesh : DrawArgs | std::views::values)
+	{
+		if (NewResidency == EMeshResidency::Compact && !submesh->Compact && submesh->Vertices && submesh->Indices)
+		{
+			submesh->Compact = make_unique<OCompactMesh>();
+			submesh->Compact->Build(&submesh->Vertices->data()->x, static_cast<uint32_t>(submesh->Vertices->size()), submesh->Indices->data(), static_cast<uint32_t>(submesh->Indices->size()));
+		}
+		if (NewResidency < EMeshResidency::Full)
+		{
+			submesh->Vertices = nullptr;
+			submesh->Indices = nullptr;
+		}
+		if (NewResidency == EMeshResidency::GPUOnly)
+		{
+			submesh->Compact = nullptr;
+		}
+	}
+	Residency = NewResidency;
+	UpdateMemory();
+	Memory.ReleasedBytes += before - Memory.CPUBytes;
+	LOG(Geometry, Log, "Mesh {} keeps {} bytes on the CPU, released {} bytes", TEXT(Name), TEXT(Memory.CPUBytes), TEXT(Memory.ReleasedBytes));
+}
+
+void SMeshGeometry::UpdateMemory()
+{
+	Memory.GPUBytes = static_cast<uint64_t>(VertexBufferByteSize) + IndexBufferByteSize;
+	Memory.CPUBytes = 0;
+	if (VertexBufferCPU)
+	{
+		Memory.CPUBytes += VertexBufferCPU->GetBufferSize();
+	}
+	if (IndexBufferCPU)
+	{
+		Memory.CPUBytes += IndexBufferCPU->GetBufferSize();
+	}
+	for (const auto& submesh : DrawArgs | std::views::values)
+	{
+		Memory.CPUBytes += submesh->GetCPUBytes();
+	}
+}
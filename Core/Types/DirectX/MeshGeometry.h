@@ -1,19 +1,76 @@
 #pragma once
 
 #include "DXHelper.h"
+#include "Engine/UploadBuffer/UploadRing.h"
 #include "Logger.h"
 #include "Material.h"
+#include "MeshGenerator/CompactMesh.h"
+
+enum class EMeshResidency : uint8_t
+{
+	// Only the GPU buffers, the mesh can not be picked and does not occlude
+	GPUOnly,
+
+	// Quantized positions and indices for picking and occlusion
+	Compact,
+
+	// Float positions, indices and the vertex and index blobs, the geometry widget edits these
+	Full
+};
+
+struct SMeshMemory
+{
+	uint64_t GPUBytes = 0;
+	uint64_t CPUBytes = 0;
+
+	// CPU bytes released when the residency was lowered
+	uint64_t ReleasedBytes = 0;
+};
+
+// Positions as xyz triples and indices, either owned by the submesh or decoded into scratch vectors
+struct SCollisionGeometry
+{
+	const float* Positions = nullptr;
+	uint32_t NumVertices = 0;
+	const uint32_t* Indices = nullptr;
+	uint32_t NumIndices = 0;
+};
+
+struct SSubmeshLOD
+{
+	UINT IndexCount = 0;
+	UINT StartIndexLocation = 0;
+
+	// Simplification error relative to the bounding sphere radius
+	float Error = 0.0f;
+};
 
 struct SSubmeshGeometry
 {
+	static constexpr uint32_t MaxLODs = 4;
+
 	UINT IndexCount = 0;
 	UINT StartIndexLocation = 0;
 	UINT BaseVertexLocation = 0;
 	DirectX::BoundingBox Bounds;
 	std::string Name;
+	// Kept with EMeshResidency::Full only
 	std::unique_ptr<std::vector<DirectX::XMFLOAT3>> Vertices = nullptr;
 	std::unique_ptr<std::vector<uint32_t>> Indices = nullptr;
+
+	// Kept with EMeshResidency::Compact
+	std::unique_ptr<OCompactMesh> Compact = nullptr;
 	SMaterial* Material = nullptr;
+
+	// Simplified index ranges sharing the vertices of the submesh, from the most detailed one
+	std::vector<SSubmeshLOD> LODs;
+
+	bool HasCollisionGeometry() const { return (Vertices && Indices) || Compact; }
+
+	/** @brief False when the residency dropped the CPU geometry, the compact copy is decoded into the scratch vectors */
+	bool GetCollisionGeometry(SCollisionGeometry& OutGeometry, std::vector<float>& ScratchPositions, std::vector<uint32_t>& ScratchIndices) const;
+
+	uint64_t GetCPUBytes() const;
 };
 
 struct SMeshGeometry
@@ -25,8 +82,11 @@ struct SMeshGeometry
 	ComPtr<ID3D12Resource> VertexBufferGPU = nullptr;
 	ComPtr<ID3D12Resource> IndexBufferGPU = nullptr;
 
-	ComPtr<ID3D12Resource> VertexBufferUploader = nullptr;
-	ComPtr<ID3D12Resource> IndexBufferUploader = nullptr;
+	// Completes once both buffers hold their data, the staging memory is released by the upload ring
+	SUploadTicket UploadTicket;
+
+	EMeshResidency Residency = EMeshResidency::Full;
+	SMeshMemory Memory;
 
 	UINT VertexByteStride = 0;
 	UINT VertexBufferByteSize = 0;
@@ -77,11 +137,11 @@ struct SMeshGeometry
 		return ibv;
 	}
 
-	void DisposeUploaders()
-	{
-		VertexBufferUploader = nullptr;
-		IndexBufferUploader = nullptr;
-	}
+	/** @brief Releases the CPU copies the residency does not keep, a residency that was released can not be raised again */
+	void SetResidency(EMeshResidency NewResidency);
+
+	/** @brief Refreshes Memory from the buffers and copies the mesh holds */
+	void UpdateMemory();
 
 	std::unordered_map<std::string, shared_ptr<SSubmeshGeometry>> DrawArgs;
 };
\ No newline at end of file
@@ -48,4 +48,9 @@ struct SPassConstants
 	float cbPerPassPad3; // Padding to ensure the cbuffer ends on a 16-byte boundary
 	float cbPerPassPad4; // Padding to ensure the cbuffer ends on a 16-byte boundary
 	bool SSAOEnabled = true;
+
+	// slice = log(viewZ) * ClusterDepthScale - ClusterDepthBias
+	float ClusterDepthScale = 0.0f;
+	float ClusterDepthBias = 0.0f;
+	UINT NumClusterLights = 0;
 };
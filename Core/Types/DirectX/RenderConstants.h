@@ -67,6 +67,9 @@ struct SRenderConstants
 
 	inline static constexpr uint32_t NumFrameResources = 3;
 	inline static constexpr uint32_t MaxLights = 16;
+	inline static constexpr uint32_t NumTransientSRVs = 256;
+	inline static constexpr uint64_t UploadRingSize = 64ull << 20;
+	inline static constexpr uint64_t TransientHeapSize = 256ull << 20;
 	inline static constexpr uint32_t RenderBuffersCount = 2;
 	inline static constexpr DirectX::XMUINT2 CubeMapDefaultResolution = { 1024, 1024 };
 	inline static constexpr float CameraNearZ = 0.1f;
@@ -117,8 +120,6 @@ struct SRenderLayers
 	RENDER_TYPE(Water);
 	RENDER_TYPE(LightObjects);
 	RENDER_TYPE(Debug);
-	RENDER_TYPE(DebugBox);
-	RENDER_TYPE(FrustumDebug);
 	RENDER_TYPE(ShadowDebug);
 	RENDER_TYPE(OneFullscreenQuad);
 };
@@ -151,6 +152,7 @@ struct SPSOTypes
 	RENDER_TYPE(DrawNormals);
 	RENDER_TYPE(SSAO);
 	RENDER_TYPE(SSAOBlur);
+	RENDER_TYPE(ClusteredLightCulling);
 };
 struct SShaderTypes
 {
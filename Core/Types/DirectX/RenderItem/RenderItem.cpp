@@ -3,13 +3,7 @@
 
 #include "Engine/Engine.h"
 
-void ORenderItem::Update(const UpdateEventArgs& Arg)
-{
-	for (auto& Component : Components)
-	{
-		Component->Tick(Arg);
-	}
-}
+#include <algorithm>
 
 bool ORenderItem::IsValid() const
 {
@@ -23,9 +17,52 @@ bool ORenderItem::IsValidChecked() const
 	return bIsValid;
 }
 
+bool SInstanceParams::NeedsExtraData() const
+{
+	return InvViewProjection.has_value() || !DirectX::XMMatrixIsIdentity(Load(TexTransform));
+}
+
+HLSL::InstanceData SInstanceParams::Pack(bool bWithExtraData) const
+{
+	HLSL::InstanceData result;
+	for (int column = 0; column < 3; column++)
+	{
+		result.World[column] = { World.m[0][column], World.m[1][column], World.m[2][column], World.m[3][column] };
+	}
+	result.MaterialIndex = MaterialIndex;
+
+	auto toUnorm8 = [](float Value) {
+		return static_cast<uint32_t>(std::clamp(Value, 0.0f, 1.0f) * 255.0f + 0.5f);
+	};
+	result.OverrideColor = toUnorm8(OverrideColor.x) | toUnorm8(OverrideColor.y) << 8 | toUnorm8(OverrideColor.z) << 16 | 0xff000000;
+	result.Flags = bWithExtraData ? INSTANCE_FLAG_EXTRA_DATA : 0;
+	return result;
+}
+
+HLSL::InstanceExtraData SInstanceParams::PackExtraData() const
+{
+	HLSL::InstanceExtraData result;
+	Put(result.TexTransform, Transpose(Load(TexTransform)));
+	if (InvViewProjection)
+	{
+		result.InvViewProjection = *InvViewProjection;
+	}
+	result.BoundingBoxCenter = BoundingBoxCenter;
+	result.BoundingBoxExtents = BoundingBoxExtents;
+	return result;
+}
+
 void ORenderItem::AddInstance(const SInstanceData& Instance)
 {
 	Instances.push_back(Instance);
+	if (bRegistered)
+	{
+		OEngine::Get()->OnInstanceCountChanged(1);
+	}
+	if (Instance.Lifetime.has_value())
+	{
+		OEngine::Get()->TrackInstanceLifetimes(this);
+	}
 }
 
 SInstanceData* ORenderItem::GetDefaultInstance()
@@ -40,7 +77,7 @@ SInstanceData* ORenderItem::GetDefaultInstance()
 	}
 }
 
-const vector<unique_ptr<OComponentBase>>& ORenderItem::GetComponents() const
+const vector<OComponentBase*>& ORenderItem::GetComponents() const
 {
 	return Components;
 }
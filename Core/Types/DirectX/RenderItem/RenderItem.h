@@ -1,38 +1,95 @@
 #pragma once
 #include "../../Materials/Material.h"
 #include "Color.h"
+#include "Components/ComponentPool.h"
 #include "Components/LightComponent/LightComponent.h"
 #include "Components/RenderItemComponentBase.h"
 #include "DirectX/MeshGeometry.h"
+#include "Engine/SceneGraph/TransformHierarchy.h"
 #include "Logger.h"
 #include "Transform.h"
 
+#include <array>
+#include <utility>
+
 struct SFrameResource;
 
 struct SRenderItemGeometry
 {
 };
 
+// Full description of an instance, packed into HLSL::InstanceData on upload
+struct SInstanceParams
+{
+	// Not transposed, the upload packs it
+	DirectX::XMFLOAT4X4 World = Utils::Math::Identity4x4();
+	DirectX::XMFLOAT4X4 TexTransform = Utils::Math::Identity4x4();
+	DirectX::XMFLOAT3 Position = { 0.0f, 0.0f, 0.0f };
+	DirectX::XMFLOAT4 Rotation = { 0.0f, 0.0f, 0.0f, 1.0f };
+	DirectX::XMFLOAT3 Scale = { 1.0f, 1.0f, 1.0f };
+	uint32_t MaterialIndex = 0;
+	DirectX::XMFLOAT3 OverrideColor = { 1.0f, 1.0f, 1.0f };
+	DirectX::XMFLOAT3 BoundingBoxCenter = { 0.0f, 0.0f, 0.0f };
+	DirectX::XMFLOAT3 BoundingBoxExtents = { 0.0f, 0.0f, 0.0f };
+
+	// Only set for the debug frustums, transposed like the pass constants it comes from
+	std::optional<DirectX::XMFLOAT4X4> InvViewProjection;
+
+	bool IsTransformEqual(const SInstanceParams& Other) const
+	{
+		return Other.Position == Position && Other.Rotation == Rotation && Other.Scale == Scale;
+	}
+
+	// True if the instance cannot be drawn without its InstanceExtraData
+	bool NeedsExtraData() const;
+	HLSL::InstanceData Pack(bool bWithExtraData) const;
+	HLSL::InstanceExtraData PackExtraData() const;
+};
+
 struct SInstanceData
 {
 	DECLARE_DELEGATE(SPositionChanged, STransform);
 	SInstanceData() = default;
 	SInstanceData(const SInstanceData& In)
 	{
-		HlslData = In.HlslData;
+		Params = In.Params;
 		Lifetime = In.Lifetime;
 	}
 
 	SInstanceData& operator=(const SInstanceData& In)
 	{
-		HlslData = In.HlslData;
+		Params = In.Params;
+		Lifetime = In.Lifetime;
+		return *this;
+	}
+
+	// Copies are new instances and get their own transform node, moves keep it and the subscribers
+	SInstanceData(SInstanceData&& In) noexcept
+	    : PositionChanged(std::move(In.PositionChanged))
+	{
+		Params = In.Params;
+		Lifetime = In.Lifetime;
+		TransformNode = std::exchange(In.TransformNode, OTransformHierarchy::InvalidNode);
+	}
+
+	SInstanceData& operator=(SInstanceData&& In) noexcept
+	{
+		Params = In.Params;
 		Lifetime = In.Lifetime;
+		PositionChanged = std::move(In.PositionChanged);
+		TransformNode = std::exchange(In.TransformNode, OTransformHierarchy::InvalidNode);
 		return *this;
 	}
 
-	HLSL::InstanceData HlslData;
+	SInstanceParams Params;
 	std::optional<float> Lifetime;
 	SPositionChanged PositionChanged;
+
+	// LOD picked by the last camera culling, 0 is the full detail submesh
+	uint8_t LOD = 0;
+
+	// Node in the engine transform hierarchy, Params.World is written from it when set
+	uint32_t TransformNode = OTransformHierarchy::InvalidNode;
 };
 
 /**
@@ -42,14 +99,17 @@ struct ORenderItem
 {
 	ORenderItem() = default;
 	ORenderItem(ORenderItem&&) = default;
-	ORenderItem(const ORenderItem&) = default;
 
-	void Update(const UpdateEventArgs& Arg);
+	// A copy would list the components of the original, which the pools release with it
+	ORenderItem(const ORenderItem&) = delete;
+	ORenderItem& operator=(const ORenderItem&) = delete;
+
 	bool IsValid() const;
 	bool IsValidChecked() const;
 
+	// The pool owns the component, the item only lists it
 	template<typename T, typename... Args>
-	T* AddComponent(Args&&... Arg);
+	T* AddComponent(TComponentPool<T>& Pool, Args&&... Arg);
 	void AddInstance(const SInstanceData& Instance);
 	SRenderLayer RenderLayer = "NONE";
 
@@ -57,19 +117,25 @@ struct ORenderItem
 	bool bTraceable = true;
 	bool bFrustumCoolingEnabled = true;
 
+	// Static casters are rendered once into the cached shadow layer
+	bool bStaticShadowCaster = false;
+
 	weak_ptr<SMaterial> DefaultMaterial;
 	weak_ptr<SMeshGeometry> Geometry;
 	weak_ptr<SSubmeshGeometry> ChosenSubmesh;
 	DirectX::BoundingBox Bounds;
 	vector<SInstanceData> Instances;
 
+	// Set while the engine lists the item, the engine keeps the total of instances of its items
+	bool bRegistered = false;
+
 	/*UI*/
 	bool bIsDisplayable = true;
 	SInstanceData* GetDefaultInstance();
-	const vector<unique_ptr<OComponentBase>>& GetComponents() const;
+	const vector<OComponentBase*>& GetComponents() const;
 
 private:
-	vector<unique_ptr<OComponentBase>> Components;
+	vector<OComponentBase*> Components;
 };
 
 struct SCulledRenderItem
@@ -77,22 +143,48 @@ struct SCulledRenderItem
 	weak_ptr<ORenderItem> Item;
 	UINT StartInstanceLocation = 0;
 	UINT VisibleInstanceCount = 0;
+
+	// Visible instances are grouped by LOD, 0 is the full detail submesh
+	std::array<UINT, SSubmeshGeometry::MaxLODs + 1> LODInstanceCounts = {};
 };
 
+struct SLODSelection
+{
+	DirectX::XMFLOAT3 EyePosition;
+
+	// Proj._22 of the camera, a bounding sphere covers Radius * ProjScale / Distance of half the screen height
+	float ProjScale = 1.0f;
+	float ViewportHeight = 1.0f;
+
+	// Simplification error allowed on the screen
+	float PixelError = 1.0f;
+
+	// A coarser LOD is taken only once its error drops below (1 - Hysteresis) * PixelError
+	float Hysteresis = 0.25f;
+};
+
+ENUM(EShadowCasterFilter,
+     All,
+     Static,
+     Dynamic)
+
 struct SCulledInstancesInfo
 {
 	unordered_map<weak_ptr<ORenderItem>, SCulledRenderItem> Items = {};
 	TUUID BufferId;
 	uint32_t InstanceCount = 0;
+
+	// Visible triangles at full detail and with the selected LODs
+	uint64_t NumTrianglesBeforeLOD = 0;
+	uint64_t NumTriangles = 0;
 };
 
 template<typename T, typename... Args>
-T* ORenderItem::AddComponent(Args&&... Arg)
+T* ORenderItem::AddComponent(TComponentPool<T>& Pool, Args&&... Arg)
 {
-	auto component = make_unique<T>(std::forward<Args>(Arg)...);
-	auto res = component.get();
-	Components.push_back(move(component));
-	Components.back()->Init(this);
+	auto res = Pool.Create(std::forward<Args>(Arg)...);
+	Components.push_back(res);
+	res->Init(this);
 	return res;
 }
 
@@ -111,6 +203,7 @@ struct SRenderItemParams
 	weak_ptr<SMaterial> Material;
 	size_t NumberOfInstances = 1;
 	bool bFrustumCoolingEnabled = false;
+	bool bStaticShadowCaster = false;
 	bool Pickable = false;
 	void SetPosition(DirectX::XMFLOAT3 P);
 	void SetScale(DirectX::XMFLOAT3 S);
@@ -1,7 +1,7 @@
 #pragma once
+#include "Delegate.h"
 #include "KeyCodes.h"
 #include "Timer/Timer.h"
-#include "boost/signals2.hpp"
 
 // Super class for all event args
 class EventArgs
@@ -156,37 +156,3 @@ public:
 	void* Data1;
 	void* Data2;
 };
-
-template<typename ReturnType, typename... Args>
-struct SDelegate
-{
-	void Add(std::function<ReturnType(Args...)> Func)
-	{
-		Signal.connect(Func);
-	}
-
-	template<typename Obj, typename Func>
-	void AddMember(Obj* object, Func&& func)
-	{
-		Signal.connect([=](Args... args) -> ReturnType {
-			return (object->*func)(std::forward<Args>(args)...);
-		});
-	}
-
-	void RemoveAll()
-	{
-		Signal.disconnect_all_slots();
-	}
-
-	template<typename... LocArgs>
-	ReturnType Broadcast(LocArgs&&... args)
-	{
-		return Signal(args...);
-	}
-
-private:
-	boost::signals2::signal<ReturnType(Args...)> Signal;
-};
-
-#define DECLARE_DELEGATE(Type, ...) \
-	using Type = SDelegate<void, __VA_ARGS__>;
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <boost/uuid/uuid.hpp>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 
 #ifndef DEBUG
 #define DEBUG 0
@@ -67,10 +68,21 @@ struct SLogCategories
 #define TEXT(Argument) \
 	ToString(Argument)
 
+struct SLogEntry
+{
+	wstring Category;
+	wstring String;
+	ELogType Type = ELogType::Log;
+	bool Debug = false;
+};
+
 struct SLogUtils
 {
 	static bool bLogToConsole;
 
+	// Set on worker threads, their messages are kept here and written by the thread that owns the buffer
+	static inline thread_local vector<SLogEntry>* DeferredLogs = nullptr;
+
 	static inline map<wstring, bool> LogCategories = {
 		{ SLogCategories::Default, true },
 		{ SLogCategories::Render, true },
@@ -82,8 +94,12 @@ struct SLogUtils
 		{ SLogCategories::Config, true }
 	};
 
+	// The update and record stages of the frame pipeline log from their own threads
+	static inline std::mutex LogMutex;
+
 	static void AddCategory(wstring Category)
 	{
+		std::lock_guard lock(LogMutex);
 		LogCategories.insert({ Category, true });
 	}
 
@@ -95,6 +111,13 @@ struct SLogUtils
 			return;
 		}
 
+		if (DeferredLogs)
+		{
+			DeferredLogs->push_back({ std::move(Category), String, Type, Debug });
+			return;
+		}
+
+		std::lock_guard lock(LogMutex);
 		if (!LogCategories.contains(Category))
 		{
 			LogCategories.insert({ Category, true });
@@ -131,6 +154,14 @@ struct SLogUtils
 		}
 	}
 
+	static void Flush(const vector<SLogEntry>& Entries) noexcept
+	{
+		for (const auto& entry : Entries)
+		{
+			Log(entry.Category, entry.String, entry.Type, entry.Debug);
+		}
+	}
+
 	template<typename... ArgTypes>
 	static std::wstring Format(std::wstring_view Str, ArgTypes&&... Args)
 	{
@@ -8,4 +8,10 @@ struct SNodeInfo
 	string NextNode;
 	string RenderLayer;
 	bool bEnable;
+
+	// Runs on the compute queue when the node only records compute work
+	bool bAsyncCompute = false;
+
+	// Dropped from the graph in builds without debug draw
+	bool bDebugDrawOnly = false;
 };
\ No newline at end of file
@@ -15,9 +15,16 @@ public:
 	void Stop();
 	void Tick();
 
+	// Ticks advance by Seconds instead of the measured time and the time restarts at 0, so runs see the same times.
+	// Setting 0 measures again, continuing from the time reached.
+	void SetFixedDeltaTime(double Seconds);
+	double GetFixedDeltaTime() const { return FixedDeltaTime; }
+
 private:
 	double SecondsPerCount = 0.0;
 	double DeltaTime = -1.0;
+	double FixedDeltaTime = 0.0;
+	double FixedTime = 0.0;
 
 	int64_t BaseTime = 0;
 	int64_t PausedTime = 0;
@@ -37,6 +44,10 @@ inline STimer::STimer()
 
 inline float STimer::GetTime() const
 {
+	if (FixedDeltaTime > 0.0)
+	{
+		return (float)FixedTime;
+	}
 	if (bIsStopped)
 	{
 		return (float)(((StopTime - PausedTime) - BaseTime) * SecondsPerCount);
@@ -101,7 +112,8 @@ inline void STimer::Tick()
 	QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
 	CurrTime = currTime;
 
-	DeltaTime = (CurrTime - PrevTime) * SecondsPerCount;
+	DeltaTime = FixedDeltaTime > 0.0 ? FixedDeltaTime : (CurrTime - PrevTime) * SecondsPerCount;
+	FixedTime += FixedDeltaTime;
 
 	PrevTime = CurrTime;
 
@@ -109,4 +121,18 @@ inline void STimer::Tick()
 	{
 		DeltaTime = 0.0;
 	}
-}
\ No newline at end of file
+}
+
+inline void STimer::SetFixedDeltaTime(double Seconds)
+{
+	Seconds = Seconds > 0.0 ? Seconds : 0.0;
+	if (Seconds > 0.0 && FixedDeltaTime == 0.0)
+	{
+		FixedTime = 0.0;
+	}
+	else if (Seconds == 0.0 && FixedDeltaTime > 0.0)
+	{
+		PausedTime = CurrTime - BaseTime - (int64_t)(FixedTime / SecondsPerCount);
+	}
+	FixedDeltaTime = Seconds;
+}
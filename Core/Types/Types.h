@@ -1,9 +1,13 @@
 #pragma once
 
 #include "boost/enable_shared_from_this.hpp"
-#include "boost/signals2.hpp"
+#include "boost/function.hpp"
+#include "boost/make_shared.hpp"
+#include "boost/optional.hpp"
+#include "boost/shared_ptr.hpp"
 #include "boost/unordered_map.hpp"
 #include "boost/unordered_set.hpp"
+#include "boost/weak_ptr.hpp"
 
 #include <algorithm> // For std::min and std::max.
 #include <cassert>
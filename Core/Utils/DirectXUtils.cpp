@@ -44,59 +44,6 @@ ComPtr<ID3DBlob> Utils::LoadBinary(const wstring& FileName)
 	return blob;
 }
 
-Microsoft::WRL::ComPtr<ID3D12Resource> Utils::CreateDefaultBuffer(ID3D12Device* Device, ID3D12GraphicsCommandList* CommandList, const void* InitData, UINT64 ByteSize, ComPtr<ID3D12Resource>& UploadBuffer)
-{
-	ComPtr<ID3D12Resource> defaultBuffer;
-
-	const auto property = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-	const auto buffer = CD3DX12_RESOURCE_DESC::Buffer(ByteSize);
-	// Create the actual default buffer resource.
-	THROW_IF_FAILED(Device->CreateCommittedResource(&property,
-	                                                D3D12_HEAP_FLAG_NONE,
-	                                                &buffer,
-	                                                D3D12_RESOURCE_STATE_COMMON,
-	                                                nullptr,
-	                                                IID_PPV_ARGS(defaultBuffer.GetAddressOf())));
-
-	const auto uploadProperty = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-	// In order to copy CPU memory data into our default buffer, we need to create
-	// an intermediate upload heap.
-	THROW_IF_FAILED(Device->CreateCommittedResource(
-	    &uploadProperty,
-	    D3D12_HEAP_FLAG_NONE,
-	    &buffer,
-	    D3D12_RESOURCE_STATE_GENERIC_READ,
-	    nullptr,
-	    IID_PPV_ARGS(UploadBuffer.GetAddressOf())));
-
-	D3D12_SUBRESOURCE_DATA subResourceData = {};
-	subResourceData.pData = InitData;
-	subResourceData.RowPitch = ByteSize;
-	subResourceData.SlicePitch = subResourceData.RowPitch;
-
-	auto commonCpyTransition = CD3DX12_RESOURCE_BARRIER::Transition(
-	    defaultBuffer.Get(),
-	    D3D12_RESOURCE_STATE_COMMON,
-	    D3D12_RESOURCE_STATE_COPY_DEST);
-
-	auto cpyDestGenericReadTransition = CD3DX12_RESOURCE_BARRIER::Transition(
-	    defaultBuffer.Get(),
-	    D3D12_RESOURCE_STATE_COPY_DEST,
-	    D3D12_RESOURCE_STATE_GENERIC_READ);
-	// Schedule to copy the data to the default buffer resource.  At a high level, the helper function UpdateSubresources
-	// will copy the CPU memory into the intermediate upload heap.  Then, using ID3D12CommandList::CopySubresourceRegion,
-	// the intermediate upload heap data will be copied to mBuffer.
-	CommandList->ResourceBarrier(1, &commonCpyTransition);
-
-	UpdateSubresources(CommandList, defaultBuffer.Get(), UploadBuffer.Get(), 0, 0, 1, &subResourceData);
-
-	CommandList->ResourceBarrier(1, &cpyDestGenericReadTransition);
-
-	// Note: uploadBuffer has to be kept alive after the above function calls because
-	// the command list has not been executed yet that performs the actual copy.
-	// The caller can Release the uploadBuffer after it knows the copy has been executed.
-	return defaultBuffer;
-}
 vector<CD3DX12_STATIC_SAMPLER_DESC> Utils::GetStaticSamplers()
 {
 	//clang-format off
@@ -21,13 +21,6 @@ ComPtr<ID3DBlob> CompileShader(const std::wstring& FileName,
 
 ComPtr<ID3DBlob> LoadBinary(const wstring& FileName);
 
-Microsoft::WRL::ComPtr<ID3D12Resource> CreateDefaultBuffer(
-    ID3D12Device* Device,
-    ID3D12GraphicsCommandList* CommandList,
-    const void* InitData,
-    UINT64 ByteSize,
-    ComPtr<ID3D12Resource>& UploadBuffer);
-
 vector<CD3DX12_STATIC_SAMPLER_DESC> GetStaticSamplers();
 D3D12_RESOURCE_STATES ResourceBarrier(ID3D12GraphicsCommandList* List, SResourceInfo* Resource, D3D12_RESOURCE_STATES Before, D3D12_RESOURCE_STATES After);
 D3D12_RESOURCE_STATES ResourceBarrier(ID3D12GraphicsCommandList* List, SResourceInfo* Resource, D3D12_RESOURCE_STATES After);
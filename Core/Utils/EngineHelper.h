@@ -46,14 +46,14 @@ inline STexture* FindTextureByPath(const wstring& FileName)
 	return OEngine::Get()->GetTextureManager()->FindTextureByPath(FileName);
 }
 
-inline STexture* FindOrCreateTexture(const string& Name, const wstring& FileName)
+inline STexture* FindOrCreateTexture(const string& Name, const wstring& FileName, ETextureType Type = ETextureType::Diffuse)
 {
-	return OEngine::Get()->GetTextureManager()->FindOrCreateTexture(Name, FileName);
+	return OEngine::Get()->GetTextureManager()->FindOrCreateTexture(Name, FileName, Type);
 }
 
-inline STexture* FindOrCreateTexture(const wstring& FileName)
+inline STexture* FindOrCreateTexture(const wstring& FileName, ETextureType Type = ETextureType::Diffuse)
 {
-	return OEngine::Get()->GetTextureManager()->FindOrCreateTexture(FileName);
+	return OEngine::Get()->GetTextureManager()->FindOrCreateTexture(FileName, Type);
 }
 
 inline auto CreateRenderItem(const string& MeshName, const wstring& Path, EParserType ParserType, ETextureMapType TexelGenerator, const SRenderItemParams& Params)
@@ -0,0 +1,141 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+OMappedFile::~OMappedFile()
+{
+	Close();
+}
+
+OMappedFile::OMappedFile(OMappedFile&& Other) noexcept
+{
+	MoveFrom(Other);
+}
+
+OMappedFile& OMappedFile::operator=(OMappedFile&& Other) noexcept
+{
+	if (this != &Other)
+	{
+		Close();
+		MoveFrom(Other);
+	}
+	return *this;
+}
+
+void OMappedFile::MoveFrom(OMappedFile& Other)
+{
+	Data = std::exchange(Other.Data, nullptr);
+	Size = std::exchange(Other.Size, 0);
+#if defined(_WIN32)
+	File = std::exchange(Other.File, nullptr);
+	Mapping = std::exchange(Other.Mapping, nullptr);
+#endif
+}
+
+#if defined(_WIN32)
+bool OMappedFile::Open(const std::filesystem::path& Path)
+{
+	Close();
+	const HANDLE file = CreateFileW(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	File = file;
+
+	LARGE_INTEGER size{};
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+
+	Mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!Mapping)
+	{
+		Close();
+		return false;
+	}
+
+	Data = static_cast<const uint8_t*>(MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!Data)
+	{
+		Close();
+		return false;
+	}
+	Size = static_cast<size_t>(size.QuadPart);
+	return true;
+}
+
+void OMappedFile::Close()
+{
+	if (Data)
+	{
+		UnmapViewOfFile(Data);
+	}
+	if (Mapping)
+	{
+		CloseHandle(Mapping);
+	}
+	if (File)
+	{
+		CloseHandle(File);
+	}
+	Data = nullptr;
+	Size = 0;
+	Mapping = nullptr;
+	File = nullptr;
+}
+#else
+bool OMappedFile::Open(const std::filesystem::path& Path)
+{
+	Close();
+	const int file = open(Path.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	struct stat info{};
+	if (fstat(file, &info) != 0 || info.st_size == 0)
+	{
+		close(file);
+		return false;
+	}
+
+	// The mapping keeps its own reference to the file
+	void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+	madvise(data, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+
+	Data = static_cast<const uint8_t*>(data);
+	Size = static_cast<size_t>(info.st_size);
+	return true;
+}
+
+void OMappedFile::Close()
+{
+	if (Data)
+	{
+		munmap(const_cast<uint8_t*>(Data), Size);
+	}
+	Data = nullptr;
+	Size = 0;
+}
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+/*
+ * Read only memory mapping of a whole file. The mapping stays valid while the object lives.
+ */
+class OMappedFile
+{
+public:
+	OMappedFile() = default;
+	~OMappedFile();
+
+	OMappedFile(const OMappedFile&) = delete;
+	OMappedFile& operator=(const OMappedFile&) = delete;
+	OMappedFile(OMappedFile&& Other) noexcept;
+	OMappedFile& operator=(OMappedFile&& Other) noexcept;
+
+	bool Open(const std::filesystem::path& Path);
+	void Close();
+
+	bool IsOpen() const { return Data != nullptr; }
+	const uint8_t* GetData() const { return Data; }
+	size_t GetSize() const { return Size; }
+
+private:
+	void MoveFrom(OMappedFile& Other);
+
+	const uint8_t* Data = nullptr;
+	size_t Size = 0;
+
+#if defined(_WIN32)
+	void* File = nullptr;
+	void* Mapping = nullptr;
+#endif
+};
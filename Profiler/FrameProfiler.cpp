@@ -0,0 +1,433 @@
+#include "FrameProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <set>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__x86_64__)
+#define FRAME_PROFILER_RDTSC 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#define FRAME_PROFILER_RDTSC 0
+#endif
+
+struct OFrameProfiler::SThreadBuffer
+{
+	// Power of two, the owning thread writes and EndFrame reads
+	static constexpr uint64_t Capacity = 1 << 14;
+
+	std::vector<SProfileEvent> Events = std::vector<SProfileEvent>(Capacity);
+	std::atomic<uint64_t> Write = 0;
+	std::atomic<uint64_t> Read = 0;
+	std::atomic<uint64_t> NumDropped = 0;
+
+	// Cleared when the thread exits, the buffer is reused by a new thread once drained
+	std::atomic<bool> bInUse = true;
+	uint32_t Index = 0;
+};
+
+struct SThreadBufferHandle
+{
+	OFrameProfiler::SThreadBuffer* Buffer = nullptr;
+
+	~SThreadBufferHandle()
+	{
+		if (Buffer)
+		{
+			OFrameProfiler::Get().ReleaseThreadBuffer(Buffer);
+		}
+	}
+};
+
+namespace
+{
+thread_local SThreadBufferHandle ThreadBuffer;
+thread_local uint16_t ScopeDepth = 0;
+
+// Blocks opened while the profiler was off carry no name and are not recorded
+thread_local std::vector<std::pair<const char*, uint64_t>> OpenBlocks;
+
+void AppendEscaped(std::string& Out, std::string_view Text)
+{
+	for (const char c : Text)
+	{
+		if (c == '"' || c == '\\')
+		{
+			Out += '\\';
+			Out += c;
+		}
+		else if (static_cast<unsigned char>(c) < 0x20)
+		{
+			char code[8];
+			std::snprintf(code, sizeof(code), "\\u%04x", c);
+			Out += code;
+		}
+		else
+		{
+			Out += c;
+		}
+	}
+}
+} // namespace
+
+OFrameProfiler& OFrameProfiler::Get()
+{
+	static OFrameProfiler profiler;
+	return profiler;
+}
+
+OFrameProfiler::OFrameProfiler()
+{
+	CalibrationTicks = Now();
+	CalibrationNanoseconds = SteadyNanoseconds();
+
+	// Rough rate for the first frame, EndFrame refines it over a longer interval
+	while (SteadyNanoseconds() - CalibrationNanoseconds < 1000000)
+	{
+	}
+	UpdateCalibration();
+	FrameStart = Now();
+}
+
+void OFrameProfiler::SetEnabled(bool bEnable)
+{
+	if (bEnable && !IsEnabled())
+	{
+		FrameStart = Now();
+	}
+	bEnabled.store(bEnable, std::memory_order_relaxed);
+}
+
+uint64_t OFrameProfiler::Now()
+{
+#if FRAME_PROFILER_RDTSC
+	return __rdtsc();
+#else
+	return SteadyNanoseconds();
+#endif
+}
+
+uint64_t OFrameProfiler::SteadyNanoseconds()
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint64_t OFrameProfiler::TicksToNanoseconds(uint64_t Ticks) const
+{
+	const double delta = static_cast<double>(static_cast<int64_t>(Ticks - CalibrationTicks)) * NanosecondsPerTick;
+	return CalibrationNanoseconds + static_cast<int64_t>(delta);
+}
+
+uint64_t OFrameProfiler::NanosecondsToTicks(uint64_t Nanoseconds) const
+{
+	const double delta = static_cast<double>(static_cast<int64_t>(Nanoseconds - CalibrationNanoseconds)) / NanosecondsPerTick;
+	return CalibrationTicks + static_cast<int64_t>(delta);
+}
+
+void OFrameProfiler::UpdateCalibration()
+{
+	const uint64_t ticks = Now();
+	const uint64_t nanoseconds = SteadyNanoseconds();
+	if (ticks > CalibrationTicks && nanoseconds > CalibrationNanoseconds)
+	{
+		NanosecondsPerTick = static_cast<double>(nanoseconds - CalibrationNanoseconds) / static_cast<double>(ticks - CalibrationTicks);
+	}
+}
+
+OFrameProfiler::SThreadBuffer* OFrameProfiler::GetThreadBuffer()
+{
+	if (ThreadBuffer.Buffer)
+	{
+		return ThreadBuffer.Buffer;
+	}
+
+	std::scoped_lock lock(ThreadsMutex);
+	for (const auto& buffer : Threads)
+	{
+		if (!buffer->bInUse.load(std::memory_order_acquire) && buffer->Read.load(std::memory_order_relaxed) == buffer->Write.load(std::memory_order_relaxed))
+		{
+			buffer->bInUse.store(true, std::memory_order_relaxed);
+			ThreadBuffer.Buffer = buffer.get();
+			return ThreadBuffer.Buffer;
+		}
+	}
+	Threads.push_back(std::make_unique<SThreadBuffer>());
+	Threads.back()->Index = static_cast<uint32_t>(Threads.size() - 1);
+	ThreadBuffer.Buffer = Threads.back().get();
+	return ThreadBuffer.Buffer;
+}
+
+void OFrameProfiler::ReleaseThreadBuffer(SThreadBuffer* Buffer)
+{
+	std::scoped_lock lock(ThreadsMutex);
+	Buffer->bInUse.store(false, std::memory_order_release);
+}
+
+void OFrameProfiler::Record(const char* Name, uint64_t Start, uint64_t End, uint16_t Depth)
+{
+	auto buffer = GetThreadBuffer();
+	const uint64_t write = buffer->Write.load(std::memory_order_relaxed);
+	if (write - buffer->Read.load(std::memory_order_acquire) >= SThreadBuffer::Capacity)
+	{
+		buffer->NumDropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	auto& event = buffer->Events[write & (SThreadBuffer::Capacity - 1)];
+	event.Name = Name;
+	event.Start = Start;
+	event.End = End;
+	event.ThreadIndex = buffer->Index;
+	event.Depth = Depth;
+	event.bGpu = false;
+	buffer->Write.store(write + 1, std::memory_order_release);
+}
+
+void OFrameProfiler::AddGpuScope(const char* Name, uint64_t StartNanoseconds, uint64_t EndNanoseconds, uint32_t Queue)
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	SProfileEvent event;
+	event.Name = InternName(Name);
+	event.Start = NanosecondsToTicks(StartNanoseconds);
+	event.End = NanosecondsToTicks(EndNanoseconds);
+	event.ThreadIndex = Queue;
+	event.bGpu = true;
+	std::scoped_lock lock(GpuMutex);
+	PendingGpuEvents.push_back(event);
+}
+
+void OFrameProfiler::BeginBlock(const char* Name)
+{
+	if (!IsEnabled())
+	{
+		OpenBlocks.emplace_back(nullptr, 0);
+		return;
+	}
+	OpenBlocks.emplace_back(InternName(Name), Now());
+	ScopeDepth++;
+}
+
+void OFrameProfiler::EndBlock()
+{
+	if (OpenBlocks.empty())
+	{
+		return;
+	}
+
+	const auto [name, start] = OpenBlocks.back();
+	OpenBlocks.pop_back();
+	if (name)
+	{
+		ScopeDepth--;
+		Record(name, start, Now(), ScopeDepth);
+	}
+}
+
+const char* OFrameProfiler::InternName(std::string_view Name)
+{
+	std::scoped_lock lock(NamesMutex);
+	return Names.emplace(Name).first->c_str();
+}
+
+void OFrameProfiler::EndFrame()
+{
+	const uint64_t now = Now();
+	UpdateCalibration();
+
+	// Everything recorded since the last frame, also drained while disabled so old scopes do not show up later
+	std::vector<SProfileEvent> events;
+	{
+		std::scoped_lock lock(ThreadsMutex);
+		for (const auto& buffer : Threads)
+		{
+			const uint64_t read = buffer->Read.load(std::memory_order_relaxed);
+			const uint64_t write = buffer->Write.load(std::memory_order_acquire);
+			for (uint64_t i = read; i < write; i++)
+			{
+				events.push_back(buffer->Events[i & (SThreadBuffer::Capacity - 1)]);
+			}
+			buffer->Read.store(write, std::memory_order_release);
+			NumDroppedEvents += buffer->NumDropped.exchange(0, std::memory_order_relaxed);
+		}
+	}
+	{
+		std::scoped_lock lock(GpuMutex);
+		events.insert(events.end(), PendingGpuEvents.begin(), PendingGpuEvents.end());
+		PendingGpuEvents.clear();
+	}
+
+	if (!IsEnabled())
+	{
+		FrameStart = now;
+		return;
+	}
+
+	SProfileEvent frame;
+	frame.Name = "Frame";
+	frame.Start = FrameStart;
+	frame.End = now;
+	frame.ThreadIndex = GetThreadBuffer()->Index;
+	events.push_back(frame);
+	NumFrames++;
+
+	for (const auto& event : events)
+	{
+		auto& history = History[event.Name];
+		if (history.LastFrame != NumFrames)
+		{
+			history.LastFrame = NumFrames;
+			history.FrameTicks = 0;
+			history.NumCalls = 0;
+		}
+		history.bGpu = event.bGpu;
+		history.FrameTicks += event.End - event.Start;
+		history.NumCalls++;
+	}
+
+	const size_t historyFrames = std::max(HistoryFrames, 1u);
+	for (auto& [name, history] : History)
+	{
+		if (history.LastFrame != NumFrames)
+		{
+			continue;
+		}
+		const auto milliseconds = static_cast<float>(static_cast<double>(history.FrameTicks) * NanosecondsPerTick * 1.0e-6);
+		if (history.Milliseconds.size() < historyFrames)
+		{
+			history.Milliseconds.push_back(milliseconds);
+			history.Next = static_cast<uint32_t>(history.Milliseconds.size() % historyFrames);
+		}
+		else
+		{
+			history.Milliseconds[history.Next % history.Milliseconds.size()] = milliseconds;
+			history.Next = static_cast<uint32_t>((history.Next + 1) % history.Milliseconds.size());
+		}
+	}
+
+	TraceHistory.push_back(std::move(events));
+	while (TraceHistory.size() > TraceFrames)
+	{
+		TraceHistory.pop_front();
+	}
+	FrameStart = now;
+}
+
+std::vector<SProfileScopeStats> OFrameProfiler::GetStats() const
+{
+	std::vector<SProfileScopeStats> result;
+	std::vector<float> sorted;
+	for (const auto& [name, history] : History)
+	{
+		if (history.Milliseconds.empty())
+		{
+			continue;
+		}
+
+		SProfileScopeStats stats;
+		stats.Name = name;
+		stats.bGpu = history.bGpu;
+		stats.NumCalls = history.NumCalls;
+		stats.NumFrames = static_cast<uint32_t>(history.Milliseconds.size());
+		stats.LastMilliseconds = history.Milliseconds[(history.Next + history.Milliseconds.size() - 1) % history.Milliseconds.size()];
+
+		sorted = history.Milliseconds;
+		std::ranges::sort(sorted);
+		stats.MinMilliseconds = sorted.front();
+		stats.P99Milliseconds = sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)];
+		double sum = 0.0;
+		for (const float value : sorted)
+		{
+			sum += value;
+		}
+		stats.AvgMilliseconds = static_cast<float>(sum / static_cast<double>(sorted.size()));
+		result.push_back(std::move(stats));
+	}
+	std::ranges::sort(result, std::greater{}, &SProfileScopeStats::AvgMilliseconds);
+	return result;
+}
+
+std::string OFrameProfiler::ExportChromeTrace() const
+{
+	uint64_t base = UINT64_MAX;
+	for (const auto& frame : TraceHistory)
+	{
+		for (const auto& event : frame)
+		{
+			base = std::min(base, event.Start);
+		}
+	}
+
+	std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	json += R"({"name":"process_name","ph":"M","pid":0,"tid":0,"args":{"name":"CPU"}},)"
+	        "\n"
+	        R"({"name":"process_name","ph":"M","pid":1,"tid":0,"args":{"name":"GPU"}})";
+
+	std::set<std::pair<bool, uint32_t>> threads;
+	char number[64];
+	for (const auto& frame : TraceHistory)
+	{
+		for (const auto& event : frame)
+		{
+			threads.emplace(event.bGpu, event.ThreadIndex);
+			const double start = static_cast<double>(TicksToNanoseconds(event.Start) - TicksToNanoseconds(base)) * 1.0e-3;
+			const double duration = static_cast<double>(event.End - event.Start) * NanosecondsPerTick * 1.0e-3;
+			json += ",\n{\"name\":\"";
+			AppendEscaped(json, event.Name);
+			std::snprintf(number, sizeof(number), "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f", start, duration);
+			json += number;
+			std::snprintf(number, sizeof(number), ",\"pid\":%d,\"tid\":%u}", event.bGpu ? 1 : 0, event.ThreadIndex);
+			json += number;
+		}
+	}
+
+	for (const auto& [bGpu, index] : threads)
+	{
+		std::snprintf(number, sizeof(number), ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,", bGpu ? 1 : 0, index);
+		json += number;
+		std::snprintf(number, sizeof(number), "\"args\":{\"name\":\"%s %u\"}}", bGpu ? "Queue" : "Thread", index);
+		json += number;
+	}
+	json += "\n]}\n";
+	return json;
+}
+
+bool OFrameProfiler::WriteChromeTrace(const std::string& Path) const
+{
+	std::ofstream file(Path, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+	const auto json = ExportChromeTrace();
+	file.write(json.data(), static_cast<std::streamsize>(json.size()));
+	return static_cast<bool>(file);
+}
+
+SProfileScope::SProfileScope(const char* InName)
+{
+	if (OFrameProfiler::Get().IsEnabled())
+	{
+		Name = InName;
+		Start = OFrameProfiler::Now();
+		ScopeDepth++;
+	}
+}
+
+SProfileScope::~SProfileScope()
+{
+	if (Name)
+	{
+		ScopeDepth--;
+		OFrameProfiler::Get().Record(Name, Start, OFrameProfiler::Now(), ScopeDepth);
+	}
+}
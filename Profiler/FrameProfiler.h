@@ -0,0 +1,143 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * Built-in frame profiler, compiled into every build and switched on at runtime.
+ * Every thread records its scopes into its own ring buffer without locking, EndFrame drains the buffers on the main thread.
+ * Times are raw ticks of the cheapest clock available (RDTSC on x86, the steady clock elsewhere) and are converted to the steady clock on export.
+ * GPU scopes are reported by the renderer in steady clock nanoseconds. No D3D dependencies.
+ */
+
+struct SProfileEvent
+{
+	const char* Name = nullptr;
+	uint64_t Start = 0;
+	uint64_t End = 0;
+	uint32_t ThreadIndex = 0;
+	uint16_t Depth = 0;
+	bool bGpu = false;
+};
+
+struct SProfileScopeStats
+{
+	std::string Name;
+	bool bGpu = false;
+
+	// Per frame totals over the history, calls are for the last frame the scope ran in
+	float LastMilliseconds = 0.0f;
+	float MinMilliseconds = 0.0f;
+	float AvgMilliseconds = 0.0f;
+	float P99Milliseconds = 0.0f;
+	uint32_t NumCalls = 0;
+	uint32_t NumFrames = 0;
+};
+
+class OFrameProfiler
+{
+public:
+	static OFrameProfiler& Get();
+
+	void SetEnabled(bool bEnable);
+	bool IsEnabled() const { return bEnabled.load(std::memory_order_relaxed); }
+
+	static uint64_t Now();
+	uint64_t TicksToNanoseconds(uint64_t Ticks) const;
+	uint64_t NanosecondsToTicks(uint64_t Nanoseconds) const;
+
+	// Steady clock in nanoseconds, the timebase GPU scopes are reported in
+	static uint64_t SteadyNanoseconds();
+
+	/** @brief Closes the current frame, collects the scopes recorded by all threads and updates the statistics */
+	void EndFrame();
+
+	void Record(const char* Name, uint64_t Start, uint64_t End, uint16_t Depth);
+	void AddGpuScope(const char* Name, uint64_t StartNanoseconds, uint64_t EndNanoseconds, uint32_t Queue = 0);
+
+	// Blocks with names built at runtime, the name is copied
+	void BeginBlock(const char* Name);
+	void EndBlock();
+
+	/** @brief Returns a pointer valid for the lifetime of the profiler */
+	const char* InternName(std::string_view Name);
+
+	std::vector<SProfileScopeStats> GetStats() const;
+
+	/** @brief Chrome trace event format, opens in chrome://tracing and Perfetto */
+	std::string ExportChromeTrace() const;
+	bool WriteChromeTrace(const std::string& Path) const;
+
+	uint64_t GetNumFrames() const { return NumFrames; }
+	uint64_t GetNumDroppedEvents() const { return NumDroppedEvents; }
+
+	// Frames kept for the statistics and for the trace
+	uint32_t HistoryFrames = 240;
+	uint32_t TraceFrames = 16;
+
+	struct SThreadBuffer;
+
+private:
+	OFrameProfiler();
+
+	SThreadBuffer* GetThreadBuffer();
+	void ReleaseThreadBuffer(SThreadBuffer* Buffer);
+	void UpdateCalibration();
+
+	struct SScopeHistory
+	{
+		bool bGpu = false;
+		uint32_t NumCalls = 0;
+		uint64_t FrameTicks = 0;
+		uint64_t LastFrame = 0;
+		std::vector<float> Milliseconds;
+		uint32_t Next = 0;
+	};
+
+	std::atomic<bool> bEnabled = false;
+
+	mutable std::mutex ThreadsMutex;
+	std::vector<std::unique_ptr<SThreadBuffer>> Threads;
+
+	std::mutex NamesMutex;
+	std::unordered_set<std::string> Names;
+
+	std::mutex GpuMutex;
+	std::vector<SProfileEvent> PendingGpuEvents;
+
+	// Ticks to steady clock nanoseconds, refined every frame
+	uint64_t CalibrationTicks = 0;
+	uint64_t CalibrationNanoseconds = 0;
+	double NanosecondsPerTick = 1.0;
+
+	std::unordered_map<std::string_view, SScopeHistory> History;
+	std::deque<std::vector<SProfileEvent>> TraceHistory;
+	uint64_t FrameStart = 0;
+	uint64_t NumFrames = 0;
+	uint64_t NumDroppedEvents = 0;
+
+	friend struct SThreadBufferHandle;
+};
+
+/**
+ * @brief Records the enclosing scope, costs a relaxed load while the profiler is off
+ */
+struct SProfileScope
+{
+	explicit SProfileScope(const char* InName);
+	~SProfileScope();
+
+	SProfileScope(const SProfileScope&) = delete;
+	SProfileScope& operator=(const SProfileScope&) = delete;
+
+private:
+	const char* Name = nullptr;
+	uint64_t Start = 0;
+};
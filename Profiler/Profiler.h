@@ -1,13 +1,25 @@
 #pragma once
 #include "Defines.h"
+#include "FrameProfiler.h"
 #include "easy/profiler.h"
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+// The built-in profiler is always compiled in and toggled at runtime, easy_profiler records alongside it when enabled
 #if ENABLE_PROFILER
-#define PROFILE_SCOPE() EASY_FUNCTION()
-#define PROFILE_BLOCK_START(name) EASY_BLOCK(name)
-#define PROFILE_BLOCK_END() EASY_END_BLOCK
+#define PROFILE_SCOPE()                                                  \
+	EASY_FUNCTION()                                                      \
+	SProfileScope PROFILE_CONCAT(ProfileScope, __LINE__)(__FUNCTION__);
+#define PROFILE_BLOCK_START(name)          \
+	EASY_BLOCK(name)                       \
+	OFrameProfiler::Get().BeginBlock(name);
+#define PROFILE_BLOCK_END() \
+	EASY_END_BLOCK          \
+	OFrameProfiler::Get().EndBlock();
 #else
-#define PROFILE_SCOPE()
-#define PROFILE_BLOCK_START(name)
-#define PROFILE_BLOCK_END()
+#define PROFILE_SCOPE() SProfileScope PROFILE_CONCAT(ProfileScope, __LINE__)(__FUNCTION__);
+#define PROFILE_BLOCK_START(name) OFrameProfiler::Get().BeginBlock(name);
+#define PROFILE_BLOCK_END() OFrameProfiler::Get().EndBlock();
 #endif
-#define DUMP_PROFILE_TO_FILE(filename) profiler::dumpBlocksToFile(#filename);
\ No newline at end of file
+#define DUMP_PROFILE_TO_FILE(filename) profiler::dumpBlocksToFile(#filename);
@@ -21,8 +21,8 @@ GSInput VS(uint InstanceID
 [maxvertexcount(24)]
 void GS(point GSInput input[1], inout LineStream<GSOutput> OutputStream) {
 	uint instanceID = input[0].InstanceID;
-	float3 center = gInstanceData[instanceID].BoundingBoxCenter;
-	float3 extents = gInstanceData[instanceID].BoundingBoxExtents;
+	float3 center = gInstanceExtraData[instanceID].BoundingBoxCenter;
+	float3 extents = gInstanceExtraData[instanceID].BoundingBoxExtents;
 
 	// Define the 8 corners of the box
 	float3 corners[8] = {
@@ -42,8 +42,8 @@ VertexOut VS(VertexIn Vin, uint InstanceID
 	VertexOut vout = (VertexOut)0.0f;
 
 	InstanceData inst = gInstanceData[InstanceID];
-	float4x4 world = inst.World;
-	float4x4 texTransform = inst.TexTransform;
+	float4x4 world = GetInstanceWorld(inst);
+	float4x4 texTransform = GetInstanceTexTransform(inst, InstanceID);
 	uint matIndex = inst.MaterialIndex;
 	vout.MaterialIndex = matIndex;
 	MaterialData matData = gMaterialData[matIndex];
@@ -119,14 +119,20 @@ float4 PS(VertexOut pin)
         idx++;
     }
 
-	//FindSpotLightShadowPosition(float4(pin.PosW, 1.0f), shadowPositionH, lightIndex);
-	//for (uint k = 0; k < gNumSpotLights; k++)
-	//{
-	//	SpotLight light = gSpotLights[k];
-	//	//TODO fix brdf for spotlights
-	//	directLighting += shadowFactor[idx] * ComputeSpotLight_BlinnPhong(gSpotLights[k], mat, pin.PosW, bumpedNormalW, toEyeW) * light.Intensity;
-	//	idx++;
-	//}
+	// Only the lights binned into the cluster of this pixel are evaluated
+	ClusterLightGrid cluster = gClusterLightGrid[GetClusterIndex(pin.PosH.xy, pin.PosH.w)];
+	for (uint k = 0; k < cluster.Count; k++)
+	{
+		uint lightIdx = gClusterLightIndices[cluster.Offset + k];
+		if (lightIdx & CLUSTER_SPOT_LIGHT_BIT)
+		{
+			directLighting += ComputeSpotLight_BRDF(gSpotLights[lightIdx & ~CLUSTER_SPOT_LIGHT_BIT], mat, pin.PosW, bumpedNormalW, toEyeW);
+		}
+		else
+		{
+			directLighting += ComputePointLight_BRDF(gPointLights[lightIdx], mat, pin.PosW, bumpedNormalW, toEyeW);
+		}
+	}
 
 	//SSAO
 	float ambientAccess = 1;
@@ -0,0 +1,52 @@
+#include "Common.hlsl"
+
+StructuredBuffer<ClusterLight> gClusterLights : register(t0, space5);
+RWStructuredBuffer<ClusterLightGrid> gClusterLightGridUAV : register(u0);
+RWStructuredBuffer<uint> gClusterLightIndicesUAV : register(u1);
+
+float GetSliceDepth(uint Slice)
+{
+	return exp((Slice + gClusterDepthBias) / gClusterDepthScale);
+}
+
+// Every cluster owns a fixed range of CLUSTER_MAX_LIGHTS indices, no atomics are needed
+[numthreads(CLUSTER_THREADS, 1, 1)] void ClusterCS(uint3 DispatchThreadID
+                                                  : SV_DispatchThreadID) {
+	uint clusterIdx = DispatchThreadID.x;
+	if (clusterIdx >= CLUSTER_TILES_X * CLUSTER_TILES_Y * CLUSTER_SLICES_Z)
+	{
+		return;
+	}
+
+	uint tileX = clusterIdx % CLUSTER_TILES_X;
+	uint tileY = (clusterIdx / CLUSTER_TILES_X) % CLUSTER_TILES_Y;
+	uint slice = clusterIdx / (CLUSTER_TILES_X * CLUSTER_TILES_Y);
+
+	float zNear = GetSliceDepth(slice);
+	float zFar = GetSliceDepth(slice + 1);
+
+	float2 ndcMin = float2(-1.0f + 2.0f * tileX / CLUSTER_TILES_X, 1.0f - 2.0f * (tileY + 1) / CLUSTER_TILES_Y);
+	float2 ndcMax = float2(-1.0f + 2.0f * (tileX + 1) / CLUSTER_TILES_X, 1.0f - 2.0f * tileY / CLUSTER_TILES_Y);
+	float2 projScale = float2(gProj[0][0], gProj[1][1]);
+
+	float3 boxMin = float3(min(ndcMin * zNear, ndcMin * zFar) / projScale, zNear);
+	float3 boxMax = float3(max(ndcMax * zNear, ndcMax * zFar) / projScale, zFar);
+
+	uint offset = clusterIdx * CLUSTER_MAX_LIGHTS;
+	uint count = 0;
+	for (uint i = 0; i < gNumClusterLights && count < CLUSTER_MAX_LIGHTS; i++)
+	{
+		ClusterLight light = gClusterLights[i];
+		float3 d = max(boxMin - light.Position, 0.0f) + max(light.Position - boxMax, 0.0f);
+		if (dot(d, d) <= light.Radius * light.Radius)
+		{
+			gClusterLightIndicesUAV[offset + count] = light.Index;
+			count++;
+		}
+	}
+
+	ClusterLightGrid cell;
+	cell.Offset = offset;
+	cell.Count = count;
+	gClusterLightGridUAV[clusterIdx] = cell;
+}
@@ -15,6 +15,10 @@ StructuredBuffer<SpotLight> gSpotLights : register(t2, space4);
 StructuredBuffer<PointLight> gPointLights : register(t3, space4);
 StructuredBuffer<DirectionalLight> gDirectionalLights : register(t4, space4);
 
+StructuredBuffer<ClusterLightGrid> gClusterLightGrid : register(t5, space4);
+StructuredBuffer<uint> gClusterLightIndices : register(t6, space4);
+StructuredBuffer<InstanceExtraData> gInstanceExtraData : register(t7, space4);
+
 
 cbuffer CB_PASS : register(b0)
 {
@@ -48,8 +52,37 @@ cbuffer CB_PASS : register(b0)
 	float cbPerPassPad3; // Padding to ensure the cbuffer ends on a 16-byte boundary
 	float cbPerPassPad4; // Padding to ensure the cbuffer ends on a 16-byte boundary
 	bool gSSAOEnabled;
+	float gClusterDepthScale;
+	float gClusterDepthBias;
+	uint gNumClusterLights;
 };
 
+uint GetClusterIndex(float2 PixelPos, float ViewZ)
+{
+	uint slice = uint(clamp(floor(log(ViewZ) * gClusterDepthScale - gClusterDepthBias), 0.0f, CLUSTER_SLICES_Z - 1));
+	uint2 tile = min(uint2(PixelPos * gInvRenderTargetSize * float2(CLUSTER_TILES_X, CLUSTER_TILES_Y)), uint2(CLUSTER_TILES_X - 1, CLUSTER_TILES_Y - 1));
+	return (slice * CLUSTER_TILES_Y + tile.y) * CLUSTER_TILES_X + tile.x;
+}
+
+float4x4 GetInstanceWorld(InstanceData Inst)
+{
+	return transpose(float4x4(Inst.World[0], Inst.World[1], Inst.World[2], float4(0.0f, 0.0f, 0.0f, 1.0f)));
+}
+
+float3 GetInstanceColor(InstanceData Inst)
+{
+	return float3(Inst.OverrideColor & 0xff, (Inst.OverrideColor >> 8) & 0xff, (Inst.OverrideColor >> 16) & 0xff) / 255.0f;
+}
+
+float4x4 GetInstanceTexTransform(InstanceData Inst, uint InstanceID)
+{
+	if (Inst.Flags & INSTANCE_FLAG_EXTRA_DATA)
+	{
+		return gInstanceExtraData[InstanceID].TexTransform;
+	}
+	return float4x4(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+}
+
 
 bool IsTangentValid(float3 TangentW)
 {
@@ -249,7 +282,10 @@ BumpedData SampleNormalMap(float3 NormalW, float3 TangentW, MaterialData MatData
   	if(MatData.NormalMap.bIsEnabled == 1)
   	{
 		data.NormalMapSample = gTextureMaps[MatData.NormalMap.TextureIndex].Sample(gsamAnisotropicWrap, TexC);
-		data.BumpedNormalW = NormalSampleToWorldSpace(data.NormalMapSample.rgb, NormalW, TangentW);
+		// z is rebuilt from xy, cooked BC5 normal maps store two channels only
+		float2 normalXY = data.NormalMapSample.xy * 2.0f - 1.0f;
+		float3 normalSample = float3(data.NormalMapSample.xy, sqrt(saturate(1.0f - dot(normalXY, normalXY))) * 0.5f + 0.5f);
+		data.BumpedNormalW = NormalSampleToWorldSpace(normalSample, NormalW, TangentW);
   	}
   	return data;
 }
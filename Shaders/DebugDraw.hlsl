@@ -0,0 +1,27 @@
+#include "Common.hlsl"
+
+struct VertexInput
+{
+	float3 PosW : POSITION;
+	float3 Color : COLOR;
+};
+
+struct VertexOutput
+{
+	float4 PosH : SV_POSITION;
+	nointerpolation float3 Color : COLOR;
+};
+
+// Debug draw lines arrive in world space
+VertexOutput VS(VertexInput Input)
+{
+	VertexOutput output = (VertexOutput)0;
+	output.PosH = mul(float4(Input.PosW, 1.0f), gViewProj);
+	output.Color = Input.Color;
+	return output;
+}
+
+float4 PS(VertexOutput Input) : SV_Target
+{
+	return float4(Input.Color, 1);
+}
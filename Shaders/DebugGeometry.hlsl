@@ -13,14 +13,14 @@ PixelInput VS(VertexInput Vin,uint InstanceID : SV_InstanceID) {
 	PixelInput vout;
 
 	InstanceData inst = gInstanceData[InstanceID];
-	float4x4 world = inst.World;
+	float4x4 world = GetInstanceWorld(inst);
 
 	// Transform to world space.
 	float4 posW = mul(float4(Vin.PosL, 1.0f), world);
 
 	// Transform to homogeneous clip space.
 	vout.PosH = mul(posW, gViewProj);
-	vout.Color  = inst.OverrideColor;
+	vout.Color  = GetInstanceColor(inst);
 	return vout;
 }
 
@@ -152,7 +152,20 @@ float3 ComputeSpotLight_BRDF(SpotLight L, Material Mat,float3 Position, float3 N
 	float spotFactor = pow(max(dot(-lightVec, L.Direction), 0.0f), L.SpotPower);
 	lightStrength *= spotFactor;
 
-	return BRDF(ToEye, lightVec, Normal, Mat);
+	return BRDF(ToEye, lightVec, Normal, Mat) * lightStrength;
+}
+
+float3 ComputePointLight_BRDF(PointLight L, Material Mat, float3 Position, float3 Normal, float3 ToEye)
+{
+	float3 lightVec = L.Position - Position;
+	float d = length(lightVec);
+	if (d > L.FalloffEnd)
+		return 0.0f;
+	lightVec /= d;
+
+	float NoL = max(dot(lightVec, Normal), 0.0f);
+	float3 lightStrength = L.Intensity * NoL * CalcAttenuation(d, L.FalloffStart, L.FalloffEnd);
+	return BRDF(ToEye, lightVec, Normal, Mat) * lightStrength;
 }
 
 
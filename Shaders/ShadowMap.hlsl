@@ -21,7 +21,7 @@ VertexOut VS(VertexIn vin,uint InstanceID : SV_InstanceID)
 	VertexOut vout = (VertexOut)0.0f;
 
     InstanceData inst = gInstanceData[InstanceID];
-	float4x4 world = inst.World;
+	float4x4 world = GetInstanceWorld(inst);
 	uint matIndex = inst.MaterialIndex;
 	vout.MaterialIndex = matIndex;
 	MaterialData matData = gMaterialData[matIndex];
@@ -33,7 +33,7 @@ VertexOut VS(VertexIn vin,uint InstanceID : SV_InstanceID)
     vout.PosH = mul(posW, gViewProj);
 
 	// Output vertex attributes for interpolation across triangle.
-	float4 texC = mul(float4(vin.TexC, 0.0f, 1.0f), inst.TexTransform);
+	float4 texC = mul(float4(vin.TexC, 0.0f, 1.0f), GetInstanceTexTransform(inst, InstanceID));
 	vout.TexC = mul(texC, matData.MatTransform).xy;
 
     return vout;
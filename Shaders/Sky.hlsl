@@ -19,7 +19,7 @@ VertexOut VS(VertexIn vin, uint InstanceID
 	InstanceData inst = gInstanceData[InstanceID];
 	VertexOut vout;
 	vout.PositionL = vin.Position;
-	float4 posW = mul(float4(vin.Position, 1.0f), inst.World);
+	float4 posW = mul(float4(vin.Position, 1.0f), GetInstanceWorld(inst));
 	posW.xyz += gEyePosW;
 	vout.PositionH = mul(posW, gViewProj).xyww;
 	return vout;
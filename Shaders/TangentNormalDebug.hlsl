@@ -28,7 +28,7 @@ GSInput VS(VertexIn Vin, uint InstanceID
 	GSInput gin = (GSInput)0.0f;
 
 	InstanceData inst = gInstanceData[InstanceID];
-	float4x4 world = inst.World;
+	float4x4 world = GetInstanceWorld(inst);
 
 	float4 posW = mul(float4(Vin.PosL, 1.0f), world);
 	gin.PosW = posW.xyz;
@@ -27,8 +27,8 @@ VertexOut VS(VertexIn Vin, uint InstanceID
 	VertexOut vout = (VertexOut)0.0f;
 
 	InstanceData inst = gInstanceData[InstanceID];
-	float4x4 world = inst.World;
-	float4x4 texTransform = inst.TexTransform;
+	float4x4 world = GetInstanceWorld(inst);
+	float4x4 texTransform = GetInstanceTexTransform(inst, InstanceID);
 	uint matIndex = inst.MaterialIndex;
 	vout.MaterialIndex = matIndex;
 	MaterialData matData = gMaterialData[matIndex];
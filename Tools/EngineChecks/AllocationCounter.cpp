@@ -0,0 +1,125 @@
+#include "CheckFixtures.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+/*
+ * Replaced global allocation functions counting every allocation. They live alone in this unit so no caller inlines
+ * them, and every new has its matching delete, sized and aligned included.
+ */
+
+namespace
+{
+std::atomic<uint64_t> NumAllocations = 0;
+std::atomic<uint64_t> NumAllocatedBytes = 0;
+
+void* Allocate(size_t Size)
+{
+	NumAllocations.fetch_add(1, std::memory_order_relaxed);
+	NumAllocatedBytes.fetch_add(Size, std::memory_order_relaxed);
+	if (void* memory = std::malloc(Size ? Size : 1))
+	{
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+// Released only through FreeAligned, the MSVC runtime keeps aligned blocks apart from malloc
+void* AllocateAligned(size_t Size, std::align_val_t Alignment)
+{
+	NumAllocations.fetch_add(1, std::memory_order_relaxed);
+	NumAllocatedBytes.fetch_add(Size, std::memory_order_relaxed);
+	const auto alignment = static_cast<size_t>(Alignment);
+	Size = (std::max<size_t>(Size, 1) + alignment - 1) / alignment * alignment;
+#ifdef _WIN32
+	void* memory = _aligned_malloc(Size, alignment);
+#else
+	void* memory = std::aligned_alloc(alignment, Size);
+#endif
+	if (!memory)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void FreeAligned(void* Memory)
+{
+#ifdef _WIN32
+	_aligned_free(Memory);
+#else
+	std::free(Memory);
+#endif
+}
+} // namespace
+
+SAllocations GetAllocations()
+{
+	return { NumAllocations.load(std::memory_order_relaxed), NumAllocatedBytes.load(std::memory_order_relaxed) };
+}
+
+void* operator new(size_t Size)
+{
+	return Allocate(Size);
+}
+
+void* operator new[](size_t Size)
+{
+	return Allocate(Size);
+}
+
+void* operator new(size_t Size, std::align_val_t Alignment)
+{
+	return AllocateAligned(Size, Alignment);
+}
+
+void* operator new[](size_t Size, std::align_val_t Alignment)
+{
+	return AllocateAligned(Size, Alignment);
+}
+
+void operator delete(void* Memory) noexcept
+{
+	std::free(Memory);
+}
+
+void operator delete[](void* Memory) noexcept
+{
+	std::free(Memory);
+}
+
+void operator delete(void* Memory, size_t) noexcept
+{
+	std::free(Memory);
+}
+
+void operator delete[](void* Memory, size_t) noexcept
+{
+	std::free(Memory);
+}
+
+void operator delete(void* Memory, std::align_val_t) noexcept
+{
+	FreeAligned(Memory);
+}
+
+void operator delete[](void* Memory, std::align_val_t) noexcept
+{
+	FreeAligned(Memory);
+}
+
+void operator delete(void* Memory, size_t, std::align_val_t) noexcept
+{
+	FreeAligned(Memory);
+}
+
+void operator delete[](void* Memory, size_t, std::align_val_t) noexcept
+{
+	FreeAligned(Memory);
+}
@@ -0,0 +1,247 @@
+#include "AnimationRuntime.h"
+#include "CheckFixtures.h"
+#include "CheckRegistry.h"
+#include "SceneGraph/TransformHierarchy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * Thousands of instances playing random tracks through the batched runtime, compared with sampling one object at a time
+ * the way OAnimation does it: key search from the start, quaternions rebuilt from Euler angles and a slerp per call.
+ * Also checks the sampled poses against the raw keys and the binary track round trip.
+ */
+
+namespace
+{
+constexpr float Pi = 3.14159265f;
+
+struct SEulerKey
+{
+	float Time = 0.0f;
+	float Position[3] = {};
+
+	// Radians, pitch yaw roll
+	float Euler[3] = {};
+	float Scale[3] = { 1.0f, 1.0f, 1.0f };
+};
+
+// Same convention as XMQuaternionRotationRollPitchYaw
+void EulerToQuaternion(const float Euler[3], float Out[4])
+{
+	const float sp = std::sin(Euler[0] * 0.5f), cp = std::cos(Euler[0] * 0.5f);
+	const float sy = std::sin(Euler[1] * 0.5f), cy = std::cos(Euler[1] * 0.5f);
+	const float sr = std::sin(Euler[2] * 0.5f), cr = std::cos(Euler[2] * 0.5f);
+	Out[0] = cr * sp * cy + sr * cp * sy;
+	Out[1] = cr * cp * sy - sr * sp * cy;
+	Out[2] = sr * cp * cy - cr * sp * sy;
+	Out[3] = cr * cp * cy + sr * sp * sy;
+}
+
+void Slerp(const float From[4], const float To[4], float Alpha, float Out[4])
+{
+	float dot = From[0] * To[0] + From[1] * To[1] + From[2] * To[2] + From[3] * To[3];
+	const float sign = dot < 0.0f ? -1.0f : 1.0f;
+	dot *= sign;
+	float fromWeight = 1.0f - Alpha;
+	float toWeight = Alpha;
+	if (dot < 0.9995f)
+	{
+		const float angle = std::acos(dot);
+		const float inverseSin = 1.0f / std::sin(angle);
+		fromWeight = std::sin((1.0f - Alpha) * angle) * inverseSin;
+		toWeight = std::sin(Alpha * angle) * inverseSin;
+	}
+	for (int component = 0; component < 4; component++)
+	{
+		Out[component] = From[component] * fromWeight + To[component] * toWeight * sign;
+	}
+}
+
+// One object at a time as OAnimation::PerfomAnimation does
+SLocalTransform SampleObject(const std::vector<SEulerKey>& Keys, float Time)
+{
+	size_t key = 0;
+	while (key + 1 < Keys.size() && Keys[key + 1].Time <= Time)
+	{
+		key++;
+	}
+	const size_t next = std::min(key + 1, Keys.size() - 1);
+	const float span = Keys[next].Time - Keys[key].Time;
+	const float alpha = span > 0.0f ? (Time - Keys[key].Time) / span : 0.0f;
+
+	SLocalTransform local;
+	float from[4];
+	float to[4];
+	EulerToQuaternion(Keys[key].Euler, from);
+	EulerToQuaternion(Keys[next].Euler, to);
+	Slerp(from, to, alpha, local.Rotation);
+	for (int component = 0; component < 3; component++)
+	{
+		local.Position[component] = Keys[key].Position[component] + (Keys[next].Position[component] - Keys[key].Position[component]) * alpha;
+		local.Scale[component] = Keys[key].Scale[component] + (Keys[next].Scale[component] - Keys[key].Scale[component]) * alpha;
+	}
+	return local;
+}
+
+// The chord between the quaternions, an acos of their dot product loses everything below a degree in float
+float AngleBetween(const float A[4], const float B[4])
+{
+	const float sign = A[0] * B[0] + A[1] * B[1] + A[2] * B[2] + A[3] * B[3] < 0.0f ? -1.0f : 1.0f;
+	float chord = 0.0f;
+	for (int component = 0; component < 4; component++)
+	{
+		const float difference = A[component] - sign * B[component];
+		chord += difference * difference;
+	}
+	return 4.0f * std::asin(std::min(std::sqrt(chord) * 0.5f, 1.0f));
+}
+
+void RunCompression(OCheckContext& Context, EAnimationCompression Compression)
+{
+	const auto numPlayers = std::max(static_cast<uint32_t>(Context.GetUInt("players", Context.IsBenchmarking() ? 10000 : 1000)), 1u);
+	const auto numTracks = std::max(static_cast<uint32_t>(Context.GetUInt("tracks", 64)), 1u);
+	const auto numKeys = std::max(static_cast<uint32_t>(Context.GetUInt("keys", 32)), 2u);
+	const auto numFrames = static_cast<uint32_t>(Context.GetUInt("frames", 100));
+	const auto compression = Compression;
+	OAnimationRuntime runtime;
+	runtime.NumThreads = static_cast<uint32_t>(Context.GetUInt("threads", 0));
+
+	// Smooth random paths, a third of the tracks keep their scale
+	std::mt19937 random(42);
+	std::uniform_real_distribution step(-1.0f, 1.0f);
+	std::vector<std::vector<SEulerKey>> eulerTracks(numTracks);
+	size_t rawBytes = 0;
+	size_t trackBytes = 0;
+	for (uint32_t track = 0; track < numTracks; track++)
+	{
+		std::vector<SAnimationKey> keys;
+		SEulerKey key;
+		for (uint32_t index = 0; index < numKeys; index++)
+		{
+			key.Time = static_cast<float>(index) * (0.1f + 0.05f * static_cast<float>(track % 4));
+			for (int component = 0; component < 3; component++)
+			{
+				key.Position[component] += step(random) * 2.0f;
+				key.Euler[component] += step(random) * 0.4f;
+				key.Scale[component] = track % 3 == 0 ? 1.0f : 1.0f + 0.2f * step(random);
+			}
+			eulerTracks[track].push_back(key);
+
+			SAnimationKey runtimeKey;
+			runtimeKey.Time = key.Time;
+			std::copy_n(key.Position, 3, runtimeKey.Position);
+			std::copy_n(key.Scale, 3, runtimeKey.Scale);
+			EulerToQuaternion(key.Euler, runtimeKey.Rotation);
+			keys.push_back(runtimeKey);
+		}
+		rawBytes += keys.size() * sizeof(SEulerKey);
+		auto built = SAnimationTrack::Build("Track" + std::to_string(track), keys, compression);
+		trackBytes += built.GetSizeInBytes();
+		runtime.AddTrack(std::move(built));
+	}
+	const char* compressionName = compression == EAnimationCompression::None ? "uncompressed" : "quantized";
+	if (Context.IsBenchmarking())
+	{
+		std::printf("%u tracks of %u keys: %zu bytes as keys, %zu bytes as %s tracks\n", numTracks, numKeys, rawBytes, trackBytes, compressionName);
+	}
+
+	// The binary track format has to give back the same tracks
+	std::stringstream binary;
+	for (const auto& track : runtime.GetTracks())
+	{
+		track.Write(binary);
+	}
+	bool bRoundTrip = true;
+	for (const auto& track : runtime.GetTracks())
+	{
+		SAnimationTrack read;
+		bRoundTrip = bRoundTrip && read.Read(binary) && read.Name == track.Name && read.Times == track.Times
+		             && read.Positions == track.Positions && read.Rotations == track.Rotations && read.Scales == track.Scales
+		             && read.QuantizedPositions == track.QuantizedPositions && read.QuantizedRotations == track.QuantizedRotations
+		             && read.QuantizedScales == track.QuantizedScales;
+	}
+	Context.Check(bRoundTrip, std::string(compressionName) + ": the binary track format round trips");
+
+	// Sampled poses against the raw keys, nlerp and quantization are the only differences
+	OTransformHierarchy hierarchy;
+	std::vector<uint32_t> nodes;
+	std::vector<uint32_t> playerTracks;
+	std::vector<float> startTimes;
+	for (uint32_t player = 0; player < numPlayers; player++)
+	{
+		const uint32_t track = player % numTracks;
+		nodes.push_back(hierarchy.Add());
+		playerTracks.push_back(track);
+		startTimes.push_back(std::uniform_real_distribution(0.0f, eulerTracks[track].back().Time)(random));
+		runtime.Play(track, nodes.back(), true, 1.0f, startTimes.back());
+	}
+	runtime.Update(0.0f, hierarchy);
+
+	float maxPositionError = 0.0f;
+	float maxAngleError = 0.0f;
+	for (uint32_t player = 0; player < numPlayers; player++)
+	{
+		const auto sampled = hierarchy.GetLocal(nodes[player]);
+		const auto expected = SampleObject(eulerTracks[playerTracks[player]], startTimes[player]);
+		for (int component = 0; component < 3; component++)
+		{
+			maxPositionError = std::max(maxPositionError, std::abs(sampled.Position[component] - expected.Position[component]));
+		}
+		maxAngleError = std::max(maxAngleError, AngleBetween(sampled.Rotation, expected.Rotation));
+	}
+
+	// Positions move up to 2 per key on each axis, 16 bits over the track bounds stay well inside this
+	Context.Check(maxPositionError < 0.05f && maxAngleError < 1.0f * Pi / 180.0f,
+	              std::string(compressionName) + ": sampled poses match the keys (position " + std::to_string(maxPositionError) + ", rotation "
+	                  + std::to_string(maxAngleError * 180.0f / Pi) + " degrees)");
+	if (!Context.IsBenchmarking() || numFrames == 0)
+	{
+		return;
+	}
+
+	const float deltaTime = 1.0f / 60.0f;
+	double runtimeMilliseconds = 0.0;
+	double objectMilliseconds = 0.0;
+	uint32_t numThreads = 0;
+	float checksum = 0.0f;
+	for (uint32_t frame = 0; frame < numFrames; frame++)
+	{
+		runtime.Update(deltaTime, hierarchy);
+		runtimeMilliseconds += runtime.GetStats().Milliseconds;
+		numThreads = std::max(numThreads, runtime.GetStats().NumThreads);
+
+		objectMilliseconds += MeasureMilliseconds([&]() {
+			for (uint32_t player = 0; player < numPlayers; player++)
+			{
+				const auto& keys = eulerTracks[playerTracks[player]];
+				startTimes[player] = std::fmod(startTimes[player] + deltaTime, keys.back().Time);
+				const auto local = SampleObject(keys, startTimes[player]);
+				checksum += local.Position[0];
+			}
+		});
+	}
+	std::printf("Runtime %.3f ms per frame for %u players, up to %u threads\n", runtimeMilliseconds / numFrames, numPlayers, numThreads);
+	std::printf("One object at a time %.3f ms per frame (checksum %g)\n", objectMilliseconds / numFrames, checksum);
+}
+} // namespace
+
+CHECK_SUITE(Animation,
+            "Batched animation sampling against the raw keys and one object at a time, binary track round trip",
+            "--players <n> (default 10000) --tracks <n> (64) --keys <n> (32) --frames <n> (100) --threads <n> (0 - all) --compression <none|quantized> (default both)")
+{
+	const auto compression = Context.GetString("compression", "");
+	if (compression.empty() || compression == "none")
+	{
+		RunCompression(Context, EAnimationCompression::None);
+	}
+	if (compression.empty() || compression == "quantized")
+	{
+		RunCompression(Context, EAnimationCompression::Quantized);
+	}
+}
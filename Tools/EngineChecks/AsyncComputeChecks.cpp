@@ -0,0 +1,384 @@
+#include "CheckFixtures.h"
+#include "CheckRegistry.h"
+#include "QueueScheduler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * OQueueScheduler against a mock pair of queues. The steps are replayed into per queue lists of submissions and GPU waits,
+ * then the GPU is simulated with a duration per pass. Fails when a pass starts before a pass it depends on finished,
+ * a wait names a fence value that is never signaled, the queues deadlock, a pass is recorded twice or never, work of
+ * the frame is still running when the frame fence is signaled or the compute passes of the engine graphs do not overlap
+ * with their direct passes. The timing is the frame time of the engine graphs with and without the compute queue.
+ */
+
+namespace
+{
+struct SSettings
+{
+	uint32_t Graphs = 5000;
+	uint32_t Passes = 24;
+	uint32_t Seed = 1;
+};
+
+struct SFailures
+{
+	uint32_t Count = 0;
+
+	void Fail(const char* Message, uint64_t Value)
+	{
+		if (Count++ < 10)
+		{
+			std::printf("  FAILED: %s (%ju)\n", Message, static_cast<uintmax_t>(Value));
+		}
+	}
+};
+
+// Written apart from OQueueScheduler::DependsOn so the check does not share its mistakes
+bool MustOrder(const SQueuePass& Later, const SQueuePass& Earlier)
+{
+	if (Later.Reads.empty() && Later.Writes.empty())
+	{
+		return true;
+	}
+	if (Earlier.Reads.empty() && Earlier.Writes.empty())
+	{
+		return true;
+	}
+	for (const auto& write : Earlier.Writes)
+	{
+		if (std::ranges::count(Later.Reads, write) + std::ranges::count(Later.Writes, write) > 0)
+		{
+			return true;
+		}
+	}
+	for (const auto& read : Earlier.Reads)
+	{
+		if (std::ranges::count(Later.Writes, read) > 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+struct SMockOp
+{
+	// Passes executed before the fence is signaled, a wait has none
+	std::vector<uint32_t> Passes;
+	uint64_t Value = 0;
+	bool bWait = false;
+};
+
+struct SMockQueue
+{
+	std::vector<SMockOp> Ops;
+	std::vector<uint32_t> Open;
+	uint64_t FenceValue = 0;
+};
+
+struct SFrameResult
+{
+	double FrameTime = 0.0;
+	double SerialTime = 0.0;
+	bool bValid = false;
+};
+
+SFrameResult Simulate(const std::vector<SQueuePass>& Passes, const std::vector<double>& Durations, const OQueueScheduler& Scheduler, SFailures& Failures)
+{
+	SFrameResult result;
+	SMockQueue queues[2];
+	std::vector<uint32_t> numRecorded(Passes.size(), 0);
+	for (const auto& step : Scheduler.GetSteps())
+	{
+		auto& queue = queues[static_cast<uint32_t>(step.Queue)];
+		auto& other = queues[1 - static_cast<uint32_t>(step.Queue)];
+		switch (step.Action)
+		{
+		case EQueueAction::Record:
+			if (step.Pass >= Passes.size() || Passes[step.Pass].Queue != step.Queue)
+			{
+				Failures.Fail("pass recorded on the wrong queue", step.Pass);
+				return result;
+			}
+			numRecorded[step.Pass]++;
+			queue.Open.push_back(step.Pass);
+			break;
+		case EQueueAction::Submit:
+			if (queue.Open.empty())
+			{
+				Failures.Fail("empty submission", step.Pass);
+			}
+			queue.Ops.push_back({ std::move(queue.Open), ++queue.FenceValue, false });
+			queue.Open.clear();
+			break;
+		case EQueueAction::Wait:
+			if (other.FenceValue == 0)
+			{
+				Failures.Fail("wait before the other queue signaled", step.Pass);
+			}
+			queue.Ops.push_back({ {}, other.FenceValue, true });
+			break;
+		}
+	}
+
+	// The present node submits whatever the direct queue holds and signals the frame fence after it
+	auto& direct = queues[static_cast<uint32_t>(ERenderQueue::Direct)];
+	if (!direct.Open.empty())
+	{
+		direct.Ops.push_back({ std::move(direct.Open), ++direct.FenceValue, false });
+	}
+	direct.Ops.push_back({ {}, ++direct.FenceValue, false });
+	if (!queues[static_cast<uint32_t>(ERenderQueue::Compute)].Open.empty())
+	{
+		Failures.Fail("compute work never submitted", 0);
+		return result;
+	}
+	for (uint32_t idx = 0; idx < Passes.size(); idx++)
+	{
+		if (numRecorded[idx] != 1)
+		{
+			Failures.Fail("pass not recorded exactly once", idx);
+			return result;
+		}
+	}
+
+	// Both queues run until they block on a fence the other queue has not reached yet
+	std::vector<double> start(Passes.size(), 0.0);
+	std::vector<double> finish(Passes.size(), 0.0);
+	std::vector<double> signalTimes[2];
+	double time[2] = { 0.0, 0.0 };
+	size_t next[2] = { 0, 0 };
+	bool bProgress = true;
+	while (bProgress)
+	{
+		bProgress = false;
+		for (uint32_t q = 0; q < 2; q++)
+		{
+			while (next[q] < queues[q].Ops.size())
+			{
+				const auto& op = queues[q].Ops[next[q]];
+				if (op.bWait)
+				{
+					const auto& signaled = signalTimes[1 - q];
+					if (signaled.size() < op.Value)
+					{
+						break;
+					}
+					time[q] = std::max(time[q], signaled[op.Value - 1]);
+				}
+				else
+				{
+					for (const uint32_t pass : op.Passes)
+					{
+						start[pass] = time[q];
+						time[q] += Durations[pass];
+						finish[pass] = time[q];
+					}
+					signalTimes[q].push_back(time[q]);
+				}
+				next[q]++;
+				bProgress = true;
+			}
+		}
+	}
+	if (next[0] != queues[0].Ops.size() || next[1] != queues[1].Ops.size())
+	{
+		Failures.Fail("queues deadlocked", next[0] + next[1]);
+		return result;
+	}
+
+	for (uint32_t pass = 0; pass < Passes.size(); pass++)
+	{
+		for (uint32_t earlier = 0; earlier < pass; earlier++)
+		{
+			if (MustOrder(Passes[pass], Passes[earlier]) && start[pass] < finish[earlier])
+			{
+				Failures.Fail("pass started before its dependency finished", pass * 1000 + earlier);
+				return result;
+			}
+		}
+	}
+
+	const auto& directSignals = signalTimes[static_cast<uint32_t>(ERenderQueue::Direct)];
+	const double frameEnd = directSignals.empty() ? 0.0 : directSignals.back();
+	for (uint32_t pass = 0; pass < Passes.size(); pass++)
+	{
+		result.SerialTime += Durations[pass];
+		if (finish[pass] > frameEnd)
+		{
+			Failures.Fail("work still running after the frame fence", pass);
+			return result;
+		}
+	}
+	result.FrameTime = frameEnd;
+	result.bValid = true;
+	return result;
+}
+
+struct SNamedPass
+{
+	const char* Name;
+	double Milliseconds;
+	SQueuePass Pass;
+};
+
+void RunFrame(OCheckContext& Context, const std::string& Title, const std::vector<SNamedPass>& Frame, bool bAsync)
+{
+	std::vector<SQueuePass> passes;
+	std::vector<double> durations;
+	for (const auto& named : Frame)
+	{
+		passes.push_back(named.Pass);
+		if (!bAsync)
+		{
+			passes.back().Queue = ERenderQueue::Direct;
+		}
+		durations.push_back(named.Milliseconds);
+	}
+
+	OQueueScheduler scheduler;
+	scheduler.Plan(passes);
+	SFailures failures;
+	const auto result = Simulate(passes, durations, scheduler, failures);
+	const auto name = Title + (bAsync ? " async: " : " direct: ");
+	Context.Check(result.bValid && failures.Count == 0, name + "passes run in dependency order and finish before the frame fence");
+	if (bAsync)
+	{
+		Context.Check(result.FrameTime < result.SerialTime, name + "compute passes overlap with direct passes");
+	}
+	else
+	{
+		Context.Check(scheduler.GetNumSubmits() == 0 && scheduler.GetNumWaits() == 0 && !scheduler.UsesCompute(), name + "a direct only frame keeps its submissions");
+	}
+	if (Context.IsBenchmarking())
+	{
+		std::printf("  %-34s %-6s frame %6.2f ms, serial %6.2f ms, %u submits, %u waits\n",
+		            Title.c_str(),
+		            bAsync ? "async" : "direct",
+		            result.FrameTime,
+		            result.SerialTime,
+		            scheduler.GetNumSubmits(),
+		            scheduler.GetNumWaits());
+	}
+}
+
+void RunEngineFrames(OCheckContext& Context)
+{
+	if (Context.IsBenchmarking())
+	{
+		std::printf("Engine frames with illustrative pass times\n");
+	}
+	const auto direct = ERenderQueue::Direct;
+	const auto compute = ERenderQueue::Compute;
+
+	// The graph as configured, only the shadow and light culling nodes declare their resources
+	const std::vector<SNamedPass> configured = {
+		{ "Shadow", 1.2, { direct, {}, { "ShadowMaps" } } },
+		{ "LightCulling", 0.6, { compute, {}, { "ClusterLightGrid" } } },
+		{ "OpaqueDynamicReflections", 0.8, { direct, {}, {} } },
+		{ "Opaque", 2.0, { direct, {}, {} } },
+		{ "Sky", 0.2, { direct, {}, {} } },
+		{ "AlphaTested", 0.4, { direct, {}, {} } },
+		{ "Transparent", 0.5, { direct, {}, {} } },
+		{ "PostProcess", 0.9, { direct, {}, {} } },
+		{ "CopyTarget", 0.1, { direct, {}, {} } },
+		{ "UI", 0.2, { direct, {}, {} } },
+		{ "Present", 0.05, { direct, {}, {} } },
+	};
+	RunFrame(Context, "configured graph", configured, false);
+	RunFrame(Context, "configured graph", configured, true);
+
+	// Every pass declares its resources and the screen space passes run as compute
+	const std::vector<SNamedPass> declared = {
+		{ "DepthNormals", 0.7, { direct, {}, { "Depth", "Normals" } } },
+		{ "Shadow", 1.2, { direct, {}, { "ShadowMaps" } } },
+		{ "LightCulling", 0.6, { compute, { "Depth" }, { "ClusterLightGrid" } } },
+		{ "SSAO", 0.9, { compute, { "Depth", "Normals" }, { "AmbientMap" } } },
+		{ "SSAOBlur", 0.4, { compute, { "AmbientMap" }, { "AmbientBlurred" } } },
+		{ "Opaque", 2.0, { direct, { "ShadowMaps", "ClusterLightGrid", "Depth" }, { "SceneColor" } } },
+		{ "Transparent", 0.5, { direct, { "ShadowMaps", "ClusterLightGrid", "Depth" }, { "SceneColor" } } },
+		{ "Composite", 0.3, { direct, { "AmbientBlurred" }, { "SceneColor" } } },
+		{ "Present", 0.05, { direct, {}, {} } },
+	};
+	RunFrame(Context, "declared graph", declared, false);
+	RunFrame(Context, "declared graph", declared, true);
+}
+
+void RunRandomGraphs(OCheckContext& Context, const SSettings& Settings)
+{
+	const char* names[] = { "A", "B", "C", "D", "E", "F", "G" };
+	std::mt19937 random(Settings.Seed);
+	std::uniform_int_distribution<uint32_t> percent(0, 99);
+	std::uniform_int_distribution<uint32_t> nameIndex(0, std::size(names) - 1);
+	std::uniform_real_distribution<double> duration(0.05, 2.0);
+
+	double frameTime = 0.0;
+	double serialTime = 0.0;
+	uint64_t numWaits = 0;
+	OQueueScheduler scheduler;
+	SFailures failures;
+	uint32_t numGraphs = 0;
+	for (uint32_t graph = 0; graph < Settings.Graphs && failures.Count == 0; graph++)
+	{
+		std::vector<SQueuePass> passes(Settings.Passes);
+		std::vector<double> durations(Settings.Passes);
+		for (uint32_t idx = 0; idx < Settings.Passes; idx++)
+		{
+			auto& pass = passes[idx];
+			pass.Queue = percent(random) < 40 ? ERenderQueue::Compute : ERenderQueue::Direct;
+			if (percent(random) >= 10)
+			{
+				for (uint32_t read = percent(random) % 3; read > 0; read--)
+				{
+					pass.Reads.push_back(names[nameIndex(random)]);
+				}
+				for (uint32_t write = 1 + percent(random) % 2; write > 0; write--)
+				{
+					pass.Writes.push_back(names[nameIndex(random)]);
+				}
+			}
+			durations[idx] = duration(random);
+		}
+
+		scheduler.Plan(passes);
+		const auto result = Simulate(passes, durations, scheduler, failures);
+		if (!result.bValid)
+		{
+			std::printf("  graph %u\n", graph);
+			break;
+		}
+		numGraphs++;
+		frameTime += result.FrameTime;
+		serialTime += result.SerialTime;
+		numWaits += scheduler.GetNumWaits();
+	}
+	Context.Check(failures.Count == 0 && numGraphs == Settings.Graphs, std::to_string(Settings.Graphs) + " random graphs run in dependency order without deadlocks");
+	if (!Context.IsBenchmarking())
+	{
+		return;
+	}
+	std::printf("Random graphs: %u graphs, %u passes\n", Settings.Graphs, Settings.Passes);
+	std::printf("  frame time %.1f%% of serial, %.2f waits per graph\n",
+	            serialTime > 0.0 ? 100.0 * frameTime / serialTime : 0.0,
+	            static_cast<double>(numWaits) / Settings.Graphs);
+}
+} // namespace
+
+CHECK_SUITE(AsyncCompute,
+            "Queue scheduling of the engine and random render graphs against mock direct and compute queues, frame time",
+            "--graphs <n> (default 5000) --passes <n> (24) --seed <n> (1)")
+{
+	SSettings settings;
+	settings.Graphs = static_cast<uint32_t>(std::max<uint64_t>(Context.GetUInt("graphs", settings.Graphs), 1));
+	settings.Passes = static_cast<uint32_t>(std::max<uint64_t>(Context.GetUInt("passes", settings.Passes), 1));
+	settings.Seed = static_cast<uint32_t>(std::max<uint64_t>(Context.GetUInt("seed", settings.Seed), 1));
+
+	RunEngineFrames(Context);
+	RunRandomGraphs(Context, settings);
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+/*
+ * Fixtures shared by the check suites: timing, heap allocation counting and scratch directories.
+ */
+
+struct SAllocations
+{
+	uint64_t Count = 0;
+	uint64_t Bytes = 0;
+};
+
+/** @brief Allocations through the global operator new since the start, counted by AllocationCounter.cpp */
+SAllocations GetAllocations();
+
+template<typename TFunc>
+SAllocations CountAllocations(TFunc&& Func)
+{
+	const auto before = GetAllocations();
+	Func();
+	const auto after = GetAllocations();
+	return { after.Count - before.Count, after.Bytes - before.Bytes };
+}
+
+template<typename TFunc>
+double MeasureMilliseconds(TFunc&& Func)
+{
+	const auto start = std::chrono::steady_clock::now();
+	Func();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/** @brief Mean time of one call */
+template<typename TFunc>
+double MeasureNanoseconds(uint64_t Iterations, TFunc&& Func)
+{
+	const double milliseconds = MeasureMilliseconds([&]() {
+		for (uint64_t i = 0; i < Iterations; i++)
+		{
+			Func();
+		}
+	});
+	return milliseconds * 1.0e6 / static_cast<double>(std::max<uint64_t>(Iterations, 1));
+}
+
+template<typename TFunc>
+double MedianMilliseconds(uint32_t Iterations, TFunc&& Func)
+{
+	std::vector<double> times;
+	for (uint32_t i = 0; i < std::max(Iterations, 1u); i++)
+	{
+		times.push_back(MeasureMilliseconds(Func));
+	}
+	std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+	return times[times.size() / 2];
+}
+
+/** @brief Empty directory under the system temporary directory, removed with everything in it */
+class OScratchDirectory
+{
+public:
+	explicit OScratchDirectory(const std::string& Name)
+	    : Path(std::filesystem::temp_directory_path() / ("EngineChecks" + Name))
+	{
+		std::error_code error;
+		std::filesystem::remove_all(Path, error);
+		std::filesystem::create_directories(Path, error);
+	}
+
+	~OScratchDirectory()
+	{
+		std::error_code error;
+		std::filesystem::remove_all(Path, error);
+	}
+
+	OScratchDirectory(const OScratchDirectory&) = delete;
+	OScratchDirectory& operator=(const OScratchDirectory&) = delete;
+
+	std::filesystem::path operator/(const std::string& Name) const { return Path / Name; }
+	const std::filesystem::path& GetPath() const { return Path; }
+
+private:
+	std::filesystem::path Path;
+};
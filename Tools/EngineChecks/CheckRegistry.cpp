@@ -0,0 +1,63 @@
+#include "CheckRegistry.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+OCheckContext::OCheckContext(const std::unordered_map<std::string, std::string>& InOptions, bool bInBenchmarking)
+    : Options(InOptions), bBenchmarking(bInBenchmarking)
+{
+}
+
+bool OCheckContext::Check(bool bCondition, const std::string& Description)
+{
+	NumChecks++;
+	if (!bCondition)
+	{
+		std::printf("FAILED: %s\n", Description.c_str());
+		NumFailures++;
+	}
+	return bCondition;
+}
+
+bool OCheckContext::HasOption(const std::string& Name) const
+{
+	return Options.contains(Name);
+}
+
+std::string OCheckContext::GetString(const std::string& Name, const std::string& Default) const
+{
+	const auto option = Options.find(Name);
+	return option != Options.end() ? option->second : Default;
+}
+
+uint64_t OCheckContext::GetUInt(const std::string& Name, uint64_t Default) const
+{
+	const auto option = Options.find(Name);
+	return option != Options.end() ? std::strtoull(option->second.c_str(), nullptr, 10) : Default;
+}
+
+double OCheckContext::GetFloat(const std::string& Name, double Default) const
+{
+	const auto option = Options.find(Name);
+	return option != Options.end() ? std::strtod(option->second.c_str(), nullptr) : Default;
+}
+
+bool OCheckRegistry::Add(const SCheckSuite& Suite)
+{
+	auto& suites = GetMutableSuites();
+	suites.insert(std::ranges::upper_bound(suites, std::string(Suite.Name), {}, [](const SCheckSuite& Other) { return std::string(Other.Name); }), Suite);
+	return true;
+}
+
+const std::vector<SCheckSuite>& OCheckRegistry::GetSuites()
+{
+	return GetMutableSuites();
+}
+
+std::vector<SCheckSuite>& OCheckRegistry::GetMutableSuites()
+{
+	// Suites register from static initializers of other translation units
+	static std::vector<SCheckSuite> suites;
+	return suites;
+}
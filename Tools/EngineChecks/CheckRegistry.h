@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Runner shared by the checks of the engine units without D3D dependencies. Every unit registers one suite that checks
+ * the unit against a reference and then reports its timings, the timings are skipped with --checks-only.
+ * Options given after the suite names reach every selected suite, a suite reads the ones it knows.
+ */
+
+class OCheckContext
+{
+public:
+	OCheckContext(const std::unordered_map<std::string, std::string>& InOptions, bool bInBenchmarking);
+
+	/** @brief Counts the check, prints the description and counts a failure when the condition does not hold */
+	bool Check(bool bCondition, const std::string& Description);
+
+	uint32_t GetNumChecks() const { return NumChecks; }
+	uint32_t GetNumFailures() const { return NumFailures; }
+	bool IsBenchmarking() const { return bBenchmarking; }
+
+	bool HasOption(const std::string& Name) const;
+	std::string GetString(const std::string& Name, const std::string& Default) const;
+	uint64_t GetUInt(const std::string& Name, uint64_t Default) const;
+	double GetFloat(const std::string& Name, double Default) const;
+
+private:
+	const std::unordered_map<std::string, std::string>& Options;
+	bool bBenchmarking = true;
+	uint32_t NumChecks = 0;
+	uint32_t NumFailures = 0;
+};
+
+using FCheckSuite = void (*)(OCheckContext& Context);
+
+struct SCheckSuite
+{
+	const char* Name = nullptr;
+	const char* Description = nullptr;
+
+	// Options the suite reads, printed by --list
+	const char* Options = nullptr;
+	FCheckSuite Run = nullptr;
+};
+
+class OCheckRegistry
+{
+public:
+	static bool Add(const SCheckSuite& Suite);
+
+	/** @brief Sorted by name */
+	static const std::vector<SCheckSuite>& GetSuites();
+
+private:
+	static std::vector<SCheckSuite>& GetMutableSuites();
+};
+
+#define CHECK_SUITE(Name, Description, Options)                                                     \
+	static void Run##Name(OCheckContext& Context);                                                  \
+	static const bool b##Name##Registered = OCheckRegistry::Add({ #Name, Description, Options, &Run##Name }); \
+	static void Run##Name(OCheckContext& Context)
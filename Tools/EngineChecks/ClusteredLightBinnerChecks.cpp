@@ -0,0 +1,237 @@
+#include "CheckFixtures.h"
+#include "CheckRegistry.h"
+#include "LightCulling/ClusteredLightBinner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * OClusteredLightBinner against a brute force test of every light sphere against every cluster. The reference builds the
+ * cluster bounds on its own in double precision. A light must not be binned where its sphere grown by a small margin misses
+ * the cluster AABB, and has to be binned where the sphere shrunk by the margin reaches a point of the froxel itself.
+ */
+
+namespace
+{
+struct SBounds
+{
+	double Min[3];
+	double Max[3];
+};
+
+SBounds GetClusterBounds(const SClusterGridParams& Params, uint32_t X, uint32_t Y, uint32_t Slice)
+{
+	const double range = static_cast<double>(Params.FarZ) / Params.NearZ;
+	const double zNear = Params.NearZ * std::pow(range, static_cast<double>(Slice) / Params.SlicesZ);
+	const double zFar = Params.NearZ * std::pow(range, static_cast<double>(Slice + 1) / Params.SlicesZ);
+	const double left = -1.0 + 2.0 * X / Params.TilesX;
+	const double right = -1.0 + 2.0 * (X + 1) / Params.TilesX;
+	const double top = 1.0 - 2.0 * Y / Params.TilesY;
+	const double bottom = 1.0 - 2.0 * (Y + 1) / Params.TilesY;
+
+	// The frustum widens with depth, the AABB spans the slice from its near to its far face
+	SBounds bounds;
+	bounds.Min[0] = std::min(left * zNear, left * zFar) / Params.ProjScaleX;
+	bounds.Max[0] = std::max(right * zNear, right * zFar) / Params.ProjScaleX;
+	bounds.Min[1] = std::min(bottom * zNear, bottom * zFar) / Params.ProjScaleY;
+	bounds.Max[1] = std::max(top * zNear, top * zFar) / Params.ProjScaleY;
+	bounds.Min[2] = zNear;
+	bounds.Max[2] = zFar;
+	return bounds;
+}
+
+bool SphereTouches(const SClusterLight& Light, double Radius, const SBounds& Bounds)
+{
+	double distanceSq = 0.0;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		const double outside = std::max(Bounds.Min[axis] - Light.Position[axis], 0.0) + std::max(Light.Position[axis] - Bounds.Max[axis], 0.0);
+		distanceSq += outside * outside;
+	}
+	return Radius > 0.0 && distanceSq <= Radius * Radius;
+}
+
+// Points spread over the froxel itself, the AABB is much larger than the froxel far from the screen center
+bool SphereReachesCluster(const SClusterGridParams& Params, const SClusterLight& Light, double Radius, uint32_t X, uint32_t Y, uint32_t Slice)
+{
+	constexpr int numSamples = 6;
+	const double range = static_cast<double>(Params.FarZ) / Params.NearZ;
+	for (int k = 0; k < numSamples; k++)
+	{
+		const double z = Params.NearZ * std::pow(range, (Slice + k / (numSamples - 1.0)) / Params.SlicesZ);
+		for (int j = 0; j < numSamples; j++)
+		{
+			const double ndcY = 1.0 - 2.0 * (Y + j / (numSamples - 1.0)) / Params.TilesY;
+			for (int i = 0; i < numSamples; i++)
+			{
+				const double ndcX = -1.0 + 2.0 * (X + i / (numSamples - 1.0)) / Params.TilesX;
+				const double dx = ndcX * z / Params.ProjScaleX - Light.Position[0];
+				const double dy = ndcY * z / Params.ProjScaleY - Light.Position[1];
+				const double dz = z - Light.Position[2];
+				if (dx * dx + dy * dy + dz * dz <= Radius * Radius)
+				{
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+// Lights around the camera, some behind it, some past the far plane and a few covering most of the screen
+std::vector<SClusterLight> MakeLights(uint32_t NumLights, float FarZ, uint32_t Seed)
+{
+	std::mt19937 random(Seed);
+	std::uniform_real_distribution side(-1.0f, 1.0f);
+	std::uniform_real_distribution depth(-20.0f, FarZ * 1.05f);
+	std::uniform_real_distribution radius(0.5f, 40.0f);
+	std::vector<SClusterLight> lights(NumLights);
+	for (uint32_t idx = 0; idx < NumLights; idx++)
+	{
+		auto& light = lights[idx];
+		light.Position[2] = depth(random) * std::abs(side(random));
+		light.Position[0] = side(random) * std::max(light.Position[2], 10.0f);
+		light.Position[1] = side(random) * std::max(light.Position[2], 10.0f) * 0.6f;
+		light.Radius = idx % 64 == 0 ? 200.0f : radius(random);
+		light.Index = idx * 3 + 1;
+	}
+	return lights;
+}
+
+// Lights of one cluster, sorted because the binner only promises the set
+std::vector<uint32_t> GetBinned(const OClusteredLightBinner& Binner, uint32_t Cluster)
+{
+	const auto& cell = Binner.GetCells()[Cluster];
+	std::vector<uint32_t> indices(Binner.GetLightIndices().begin() + cell.Offset, Binner.GetLightIndices().begin() + cell.Offset + cell.Count);
+	std::ranges::sort(indices);
+	return indices;
+}
+
+void CheckAgainstReference(OCheckContext& Context, const SClusterGridParams& Params, const std::vector<SClusterLight>& Lights, uint32_t NumThreads)
+{
+	OClusteredLightBinner binner;
+	binner.NumThreads = NumThreads;
+	binner.MinLightsPerThread = 1;
+	binner.SetGridParams(Params);
+	binner.Bin(Lights);
+
+	uint32_t numMissing = 0;
+	uint32_t numExtra = 0;
+	bool bCompact = true;
+	uint32_t expectedOffset = 0;
+	for (uint32_t slice = 0; slice < Params.SlicesZ; slice++)
+	{
+		for (uint32_t y = 0; y < Params.TilesY; y++)
+		{
+			for (uint32_t x = 0; x < Params.TilesX; x++)
+			{
+				const uint32_t cluster = Params.GetClusterIndex(x, y, slice);
+				const auto bounds = GetClusterBounds(Params, x, y, slice);
+				const auto binned = GetBinned(binner, cluster);
+				bCompact &= binner.GetCells()[cluster].Offset == expectedOffset;
+				expectedOffset += binner.GetCells()[cluster].Count;
+				for (const auto& light : Lights)
+				{
+					const double margin = 1e-3 * std::max(1.0, std::abs(static_cast<double>(light.Position[2])) + light.Radius);
+					const bool bBinned = std::ranges::binary_search(binned, light.Index);
+					numMissing += !bBinned && SphereTouches(light, light.Radius, bounds) && SphereReachesCluster(Params, light, light.Radius - margin, x, y, slice);
+					numExtra += bBinned && !SphereTouches(light, light.Radius + margin, bounds);
+				}
+			}
+		}
+	}
+
+	const auto name = std::to_string(Lights.size()) + " lights on " + std::to_string(NumThreads) + " threads: ";
+	Context.Check(numMissing == 0, name + "every light touching a cluster is binned (" + std::to_string(numMissing) + " missing)");
+	Context.Check(numExtra == 0, name + "no light is binned into a cluster it misses (" + std::to_string(numExtra) + " extra)");
+	Context.Check(bCompact && expectedOffset == binner.GetLightIndices().size() && binner.GetStats().NumLightIndices == expectedOffset, name + "cells are packed back to back");
+	Context.Check(binner.GetStats().NumOverflows == 0, name + "no cluster overflows with room for every light");
+}
+} // namespace
+
+CHECK_SUITE(ClusteredLightBinner,
+            "Clustered light binning against a brute force sphere and cluster AABB test, binning time",
+            "--lights <n> (default 1024) --iterations <n> (50) --threads <n> (0 - all)")
+{
+	SClusterGridParams params;
+	params.FarZ = 500.0f;
+	params.ProjScaleX = 1.0f / std::tan(0.25f * 3.14159265f) / (16.0f / 9.0f);
+	params.ProjScaleY = 1.0f / std::tan(0.25f * 3.14159265f);
+	params.MaxLightsPerCluster = 1024;
+
+	for (const uint32_t numLights : { 1u, 40u, 300u })
+	{
+		const auto lights = MakeLights(numLights, params.FarZ, numLights);
+		CheckAgainstReference(Context, params, lights, 1);
+		CheckAgainstReference(Context, params, lights, 4);
+	}
+
+	// Clusters keep their first MaxLightsPerCluster lights and count the rest as overflows
+	{
+		auto capped = params;
+		capped.MaxLightsPerCluster = 4;
+		std::vector<SClusterLight> lights(10);
+		for (uint32_t idx = 0; idx < lights.size(); idx++)
+		{
+			lights[idx] = { { 0.0f, 0.0f, 50.0f }, 1000.0f, idx };
+		}
+		OClusteredLightBinner binner;
+		binner.SetGridParams(capped);
+		binner.Bin(lights);
+		const bool bCapped = std::ranges::all_of(binner.GetCells(), [](const SClusterCell& Cell) { return Cell.Count == 4; });
+		Context.Check(bCapped && binner.GetStats().NumOverflows == capped.GetNumClusters() && binner.GetStats().MaxLightsInCluster == 10, "full clusters keep MaxLightsPerCluster lights and report the overflow");
+	}
+
+	// Lights behind the camera, past the far plane or without a radius never reach the grid
+	{
+		const std::vector<SClusterLight> lights = { { { 0.0f, 0.0f, -10.0f }, 5.0f, 0 }, { { 0.0f, 0.0f, 600.0f }, 50.0f, 1 }, { { 0.0f, 0.0f, 10.0f }, 0.0f, 2 } };
+		OClusteredLightBinner binner;
+		binner.SetGridParams(params);
+		binner.Bin(lights);
+		Context.Check(binner.GetStats().NumVisibleLights == 0 && binner.GetLightIndices().empty(), "lights outside the view volume are not binned");
+	}
+
+	bool bSlicesMatch = true;
+	for (uint32_t slice = 0; slice < params.SlicesZ; slice++)
+	{
+		const float middle = std::sqrt(params.GetSliceDepth(slice) * params.GetSliceDepth(slice + 1));
+		bSlicesMatch &= params.GetSlice(middle) == static_cast<int32_t>(slice);
+	}
+	Context.Check(bSlicesMatch && params.GetSlice(params.NearZ * 0.5f) == -1 && params.GetSlice(params.FarZ) == static_cast<int32_t>(params.SlicesZ), "GetSlice inverts GetSliceDepth");
+
+	if (!Context.IsBenchmarking())
+	{
+		return;
+	}
+	const auto numLights = static_cast<uint32_t>(Context.GetUInt("lights", 1024));
+	const auto iterations = static_cast<uint32_t>(Context.GetUInt("iterations", 50));
+	const auto numThreads = static_cast<uint32_t>(Context.GetUInt("threads", 0));
+	params.MaxLightsPerCluster = 128;
+	const auto lights = MakeLights(numLights, params.FarZ, 1);
+	std::printf("%ux%ux%u clusters, %u lights, %u hardware threads\n", params.TilesX, params.TilesY, params.SlicesZ, numLights, std::thread::hardware_concurrency());
+	std::vector<uint32_t> threadCounts = { 1 };
+	if (numThreads != 1)
+	{
+		threadCounts.push_back(numThreads);
+	}
+	for (const uint32_t threads : threadCounts)
+	{
+		OClusteredLightBinner binner;
+		binner.NumThreads = threads;
+		binner.SetGridParams(params);
+		const double milliseconds = MedianMilliseconds(iterations, [&]() { binner.Bin(lights); });
+		const auto& stats = binner.GetStats();
+		std::printf("  %u threads: %.3f ms, %u visible lights, %u indices, %u max per cluster, %u overflows\n",
+		            stats.NumThreads,
+		            milliseconds,
+		            stats.NumVisibleLights,
+		            stats.NumLightIndices,
+		            stats.MaxLightsInCluster,
+		            stats.NumOverflows);
+	}
+}
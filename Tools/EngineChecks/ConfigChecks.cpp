@@ -0,0 +1,165 @@
+#include "CheckFixtures.h"
+#include "CheckRegistry.h"
+#include "JsonDocument.h"
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+/*
+ * Startup config loading: every JSON config read with boost::property_tree the way OConfigReader used to, parsed in place
+ * by OJsonDocument and mapped from its compiled form. Checks that the three give the same tree and reports the time and the
+ * heap allocations of one load.
+ */
+
+namespace
+{
+struct SMeasure
+{
+	double Microseconds = 0.0;
+	uint64_t Allocations = 0;
+	uint64_t Bytes = 0;
+};
+
+// Median time of the iterations, allocations of a single load
+template<typename TLoad>
+SMeasure Measure(uint32_t Iterations, TLoad&& Load)
+{
+	SMeasure measure;
+	measure.Microseconds = 1000.0 * MedianMilliseconds(Iterations, [&]() {
+		const auto allocations = CountAllocations(Load);
+		measure.Allocations = allocations.Count;
+		measure.Bytes = allocations.Bytes;
+	});
+	return measure;
+}
+
+// Same keys, order and scalar text, property_tree keeps numbers and literals as their text
+bool IsSame(const OJsonValue& Value, const boost::property_tree::ptree& Tree)
+{
+	if (Value.IsArray() || Value.IsObject())
+	{
+		if (Value.GetSize() != Tree.size())
+		{
+			return false;
+		}
+		auto child = Tree.begin();
+		for (const auto item : Value)
+		{
+			if (item.GetKey() != child->first || !IsSame(item, child->second))
+			{
+				return false;
+			}
+			++child;
+		}
+		return true;
+	}
+	return Tree.empty() && Value.GetText() == Tree.data();
+}
+} // namespace
+
+CHECK_SUITE(Config,
+            "JSON configs parsed in place and loaded compiled against boost::property_tree, load time and allocations",
+            "--configs <dir> (default Resources/Config) --iterations <n> (200)")
+{
+	const std::filesystem::path configs = Context.GetString("configs", "Resources/Config");
+	const uint32_t iterations = Context.IsBenchmarking() ? std::max(static_cast<uint32_t>(Context.GetUInt("iterations", 200)), 1u) : 1;
+
+	std::vector<std::filesystem::path> files;
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(configs, error))
+	{
+		if (entry.path().extension() == ".json")
+		{
+			files.push_back(entry.path());
+		}
+	}
+	std::ranges::sort(files);
+	if (!Context.Check(!files.empty(), "JSON configs are found in " + configs.string()))
+	{
+		return;
+	}
+
+	// The compiled forms go to a temporary directory, the engine keeps them next to the configs
+	const OScratchDirectory compiledDirectory("Config");
+	if (Context.IsBenchmarking())
+	{
+		std::printf("%-24s %7s | %21s | %21s | %21s\n", "", "", "property_tree", "in place", "compiled");
+		std::printf("%-24s %7s | %9s %11s | %9s %11s | %9s %11s\n", "Config", "Bytes", "us", "allocs", "us", "allocs", "us", "allocs");
+	}
+
+	SMeasure totals[3];
+	for (const auto& file : files)
+	{
+		const auto path = file.string();
+		const auto compiledPath = (compiledDirectory / file.filename().string()).replace_extension(".cjson").string();
+		const auto stamp = OJsonDocument::GetFileStamp(path);
+
+		boost::property_tree::ptree tree;
+		OJsonDocument parsed;
+		OJsonDocument compiled;
+		const auto name = file.filename().string();
+		if (!Context.Check(parsed.ParseFile(path), name + " parses " + parsed.GetError())
+		    || !Context.Check(parsed.SaveCompiled(compiledPath, stamp), name + " compiles to " + compiledPath))
+		{
+			continue;
+		}
+
+		const SMeasure measures[3] = {
+			Measure(iterations,
+			        [&] {
+				        tree.clear();
+				        boost::property_tree::read_json(path, tree);
+			        }),
+			Measure(iterations, [&] { parsed.ParseFile(path); }),
+			Measure(iterations, [&] { compiled.LoadCompiled(compiledPath, stamp); })
+		};
+
+		Context.Check(IsSame(parsed.GetRoot(), tree), name + ": the parsed tree matches property_tree");
+		Context.Check(compiled.GetStats().bCompiled && IsSame(compiled.GetRoot(), tree), name + ": the compiled tree matches property_tree");
+		Context.Check(!OJsonDocument().LoadCompiled(compiledPath, stamp + 1), name + ": a compiled form of another source is rejected");
+		if (!Context.IsBenchmarking())
+		{
+			continue;
+		}
+
+		std::printf("%-24s %7ju | %9.1f %11ju | %9.1f %11ju | %9.1f %11ju\n",
+		            name.c_str(),
+		            static_cast<uintmax_t>(std::filesystem::file_size(file, error)),
+		            measures[0].Microseconds,
+		            static_cast<uintmax_t>(measures[0].Allocations),
+		            measures[1].Microseconds,
+		            static_cast<uintmax_t>(measures[1].Allocations),
+		            measures[2].Microseconds,
+		            static_cast<uintmax_t>(measures[2].Allocations));
+		for (int method = 0; method < 3; method++)
+		{
+			totals[method].Microseconds += measures[method].Microseconds;
+			totals[method].Allocations += measures[method].Allocations;
+			totals[method].Bytes += measures[method].Bytes;
+		}
+	}
+
+	if (!Context.IsBenchmarking())
+	{
+		return;
+	}
+	std::printf("%-24s %7s | %9.1f %11ju | %9.1f %11ju | %9.1f %11ju\n",
+	            "Total",
+	            "",
+	            totals[0].Microseconds,
+	            static_cast<uintmax_t>(totals[0].Allocations),
+	            totals[1].Microseconds,
+	            static_cast<uintmax_t>(totals[1].Allocations),
+	            totals[2].Microseconds,
+	            static_cast<uintmax_t>(totals[2].Allocations));
+	std::printf("Allocated bytes per load: property_tree %ju, in place %ju, compiled %ju\n",
+	            static_cast<uintmax_t>(totals[0].Bytes),
+	            static_cast<uintmax_t>(totals[1].Bytes),
+	            static_cast<uintmax_t>(totals[2].Bytes));
+}
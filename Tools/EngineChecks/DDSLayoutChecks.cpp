@@ -0,0 +1,422 @@
+#include "CheckFixtures.h"
+#include "CheckRegistry.h"
+#include "DDSTextureLoader/DDSLayout.h"
+#include "MappedFile.h"
+#include "TextureCooker/TextureCooker.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/*
+ * Synthetic DDS files with the DX10 and the legacy header. The subresource table is compared against offsets and pitches
+ * worked out by hand, every shorter prefix of a valid file has to be rejected as truncated.
+ */
+
+namespace
+{
+constexpr uint32_t MakeFourCC(char A, char B, char C, char D)
+{
+	return static_cast<uint32_t>(static_cast<uint8_t>(A)) | (static_cast<uint32_t>(static_cast<uint8_t>(B)) << 8)
+	       | (static_cast<uint32_t>(static_cast<uint8_t>(C)) << 16) | (static_cast<uint32_t>(static_cast<uint8_t>(D)) << 24);
+}
+
+// Header fields of a synthetic file, everything else in the header stays zero
+struct SSyntheticDDS
+{
+	uint32_t Width = 1;
+	uint32_t Height = 1;
+	uint32_t Depth = 0;
+	uint32_t MipCount = 1;
+	uint32_t Flags = 0x1007; // CAPS | HEIGHT | WIDTH | PIXELFORMAT
+	uint32_t Caps2 = 0;
+
+	uint32_t PixelFlags = 0;
+	uint32_t FourCC = 0;
+	uint32_t RGBBitCount = 0;
+	uint32_t Masks[4] = {};
+
+	bool bDX10 = false;
+	uint32_t DXGIFormat = 0;
+	uint32_t ResourceDimension = 3;
+	uint32_t MiscFlag = 0;
+	uint32_t ArraySize = 1;
+
+	size_t DataSize = 0;
+};
+
+std::vector<uint8_t> Build(const SSyntheticDDS& Desc)
+{
+	std::vector<uint32_t> words(1 + 31 + (Desc.bDX10 ? 5 : 0), 0);
+	words[0] = MakeFourCC('D', 'D', 'S', ' ');
+	words[1] = 124;
+	words[2] = Desc.Flags;
+	words[3] = Desc.Height;
+	words[4] = Desc.Width;
+	words[6] = Desc.Depth;
+	words[7] = Desc.MipCount;
+	words[19] = 32;
+	words[20] = Desc.bDX10 ? 0x4 : Desc.PixelFlags;
+	words[21] = Desc.bDX10 ? MakeFourCC('D', 'X', '1', '0') : Desc.FourCC;
+	words[22] = Desc.RGBBitCount;
+	std::memcpy(&words[23], Desc.Masks, sizeof(Desc.Masks));
+	words[27] = 0x1000; // DDSCAPS_TEXTURE
+	words[28] = Desc.Caps2;
+	if (Desc.bDX10)
+	{
+		words[32] = Desc.DXGIFormat;
+		words[33] = Desc.ResourceDimension;
+		words[34] = Desc.MiscFlag;
+		words[35] = Desc.ArraySize;
+	}
+
+	std::vector<uint8_t> file(words.size() * sizeof(uint32_t) + Desc.DataSize);
+	std::memcpy(file.data(), words.data(), words.size() * sizeof(uint32_t));
+	for (size_t i = words.size() * sizeof(uint32_t); i < file.size(); i++)
+	{
+		file[i] = static_cast<uint8_t>(i);
+	}
+	return file;
+}
+
+struct SExpectedSubresource
+{
+	uint32_t Mip;
+	uint32_t Slice;
+	size_t Offset;
+	size_t RowPitch;
+	size_t SlicePitch;
+	uint32_t NumRows;
+	uint32_t Width;
+	uint32_t Height;
+	uint32_t Depth;
+};
+
+struct SLayoutCase
+{
+	const char* Name;
+	SSyntheticDDS Desc;
+	uint32_t DXGIFormat;
+	uint32_t ArraySize;
+	EDDSDimension Dimension;
+	bool bCubeMap;
+	std::vector<SExpectedSubresource> Expected;
+};
+
+std::vector<SLayoutCase> GetLayoutCases()
+{
+	std::vector<SLayoutCase> cases;
+
+	// BC1 8x8, 2x2 blocks of 8 bytes, every mip below 4x4 still takes a whole block
+	SSyntheticDDS bc1;
+	bc1.bDX10 = true;
+	bc1.DXGIFormat = 71;
+	bc1.Width = 8;
+	bc1.Height = 8;
+	bc1.MipCount = 3;
+	bc1.ArraySize = 2;
+	bc1.DataSize = 2 * (32 + 8 + 8);
+	cases.push_back({ "DX10 BC1 array",
+	                  bc1,
+	                  71,
+	                  2,
+	                  EDDSDimension::Texture2D,
+	                  false,
+	                  { { 0, 0, 148, 16, 32, 2, 8, 8, 1 },
+	                    { 1, 0, 180, 8, 8, 1, 4, 4, 1 },
+	                    { 2, 0, 188, 8, 8, 1, 2, 2, 1 },
+	                    { 0, 1, 196, 16, 32, 2, 8, 8, 1 },
+	                    { 2, 1, 236, 8, 8, 1, 2, 2, 1 } } });
+
+	// R16G16B16A16_FLOAT 4x4x4 volume, every depth slice of a mip is stored back to back
+	SSyntheticDDS volume;
+	volume.bDX10 = true;
+	volume.DXGIFormat = 10;
+	volume.ResourceDimension = 4;
+	volume.Flags |= 0x800000;
+	volume.Width = 4;
+	volume.Height = 4;
+	volume.Depth = 4;
+	volume.MipCount = 2;
+	volume.DataSize = 512 + 64;
+	cases.push_back({ "DX10 volume",
+	                  volume,
+	                  10,
+	                  1,
+	                  EDDSDimension::Texture3D,
+	                  false,
+	                  { { 0, 0, 148, 32, 128, 4, 4, 4, 4 }, { 1, 0, 660, 16, 32, 2, 2, 2, 2 } } });
+
+	// BC7 cube from the misc flag, 16x8 is 4x2 blocks of 16 bytes per face
+	SSyntheticDDS cube;
+	cube.bDX10 = true;
+	cube.DXGIFormat = 98;
+	cube.MiscFlag = 0x4;
+	cube.Width = 16;
+	cube.Height = 8;
+	cube.DataSize = 6 * 128;
+	cases.push_back({ "DX10 BC7 cube",
+	                  cube,
+	                  98,
+	                  6,
+	                  EDDSDimension::Texture2D,
+	                  true,
+	                  { { 0, 0, 148, 64, 128, 2, 16, 8, 1 }, { 0, 5, 788, 64, 128, 2, 16, 8, 1 } } });
+
+	// R8 1D ignores the height in the header
+	SSyntheticDDS line;
+	line.bDX10 = true;
+	line.DXGIFormat = 61;
+	line.ResourceDimension = 2;
+	line.Width = 10;
+	line.Height = 7;
+	line.MipCount = 4;
+	line.DataSize = 10 + 5 + 2 + 1;
+	cases.push_back({ "DX10 1D",
+	                  line,
+	                  61,
+	                  1,
+	                  EDDSDimension::Texture1D,
+	                  false,
+	                  { { 0, 0, 148, 10, 10, 1, 10, 1, 1 }, { 1, 0, 158, 5, 5, 1, 5, 1, 1 }, { 3, 0, 165, 1, 1, 1, 1, 1, 1 } } });
+
+	// Legacy R8G8B8A8 from the RGB masks, odd sizes are not padded
+	SSyntheticDDS rgba;
+	rgba.PixelFlags = 0x41; // RGB | ALPHAPIXELS
+	rgba.RGBBitCount = 32;
+	rgba.Masks[0] = 0x000000ff;
+	rgba.Masks[1] = 0x0000ff00;
+	rgba.Masks[2] = 0x00ff0000;
+	rgba.Masks[3] = 0xff000000;
+	rgba.Width = 5;
+	rgba.Height = 3;
+	rgba.MipCount = 3;
+	rgba.DataSize = 60 + 8 + 4;
+	cases.push_back({ "legacy RGBA8",
+	                  rgba,
+	                  28,
+	                  1,
+	                  EDDSDimension::Texture2D,
+	                  false,
+	                  { { 0, 0, 128, 20, 60, 3, 5, 3, 1 }, { 1, 0, 188, 8, 8, 1, 2, 1, 1 }, { 2, 0, 196, 4, 4, 1, 1, 1, 1 } } });
+
+	// Legacy B8G8R8X8 without the alpha mask
+	SSyntheticDDS bgrx = rgba;
+	bgrx.PixelFlags = 0x40;
+	bgrx.Masks[0] = 0x00ff0000;
+	bgrx.Masks[2] = 0x000000ff;
+	bgrx.Masks[3] = 0;
+	cases.push_back({ "legacy BGRX8", bgrx, 88, 1, EDDSDimension::Texture2D, false, { { 0, 0, 128, 20, 60, 3, 5, 3, 1 } } });
+
+	// Legacy DXT5 cube with all faces, 4x4 is a single 16 byte block per face
+	SSyntheticDDS dxt5;
+	dxt5.PixelFlags = 0x4;
+	dxt5.FourCC = MakeFourCC('D', 'X', 'T', '5');
+	dxt5.Caps2 = 0x200 | 0xfc00;
+	dxt5.Width = 4;
+	dxt5.Height = 4;
+	dxt5.MipCount = 2;
+	dxt5.DataSize = 6 * 32;
+	cases.push_back({ "legacy DXT5 cube",
+	                  dxt5,
+	                  77,
+	                  6,
+	                  EDDSDimension::Texture2D,
+	                  true,
+	                  { { 0, 0, 128, 16, 16, 1, 4, 4, 1 }, { 1, 0, 144, 16, 16, 1, 2, 2, 1 }, { 0, 3, 224, 16, 16, 1, 4, 4, 1 } } });
+
+	// Legacy A32B32G32R32F from the D3DFMT code in the FourCC field
+	SSyntheticDDS float4;
+	float4.PixelFlags = 0x4;
+	float4.FourCC = 116;
+	float4.Width = 3;
+	float4.Height = 2;
+	float4.DataSize = 96;
+	cases.push_back({ "legacy RGBA32F", float4, 2, 1, EDDSDimension::Texture2D, false, { { 0, 0, 128, 48, 96, 2, 3, 2, 1 } } });
+	return cases;
+}
+
+struct SRejectCase
+{
+	const char* Name;
+	EDDSParseResult Expected;
+	std::vector<uint8_t> File;
+};
+
+std::vector<SRejectCase> GetRejectCases(const SSyntheticDDS& Valid, const SSyntheticDDS& Legacy)
+{
+	std::vector<SRejectCase> cases;
+	auto badMagic = Build(Valid);
+	badMagic[0] = 'X';
+	cases.push_back({ "bad magic", EDDSParseResult::InvalidHeader, badMagic });
+
+	auto badSize = Build(Valid);
+	badSize[4] = 100;
+	cases.push_back({ "bad header size", EDDSParseResult::InvalidHeader, badSize });
+
+	auto desc = Valid;
+	desc.ArraySize = 0;
+	cases.push_back({ "zero array size", EDDSParseResult::InvalidHeader, Build(desc) });
+
+	desc = Valid;
+	desc.ResourceDimension = 7;
+	cases.push_back({ "unknown dimension", EDDSParseResult::InvalidHeader, Build(desc) });
+
+	desc = Valid;
+	desc.ResourceDimension = 4;
+	cases.push_back({ "volume without the depth flag", EDDSParseResult::InvalidHeader, Build(desc) });
+
+	desc = Valid;
+	desc.Width = 0;
+	cases.push_back({ "zero width", EDDSParseResult::InvalidHeader, Build(desc) });
+
+	desc = Valid;
+	desc.Width = 32768;
+	cases.push_back({ "width over the hardware limit", EDDSParseResult::InvalidHeader, Build(desc) });
+
+	desc = Valid;
+	desc.MipCount = 16;
+	cases.push_back({ "more mips than the hardware allows", EDDSParseResult::InvalidHeader, Build(desc) });
+
+	desc = Valid;
+	desc.MipCount = desc.MipCount + 2;
+	desc.DataSize = 1 << 12;
+	cases.push_back({ "mip chain longer than the extent", EDDSParseResult::InvalidHeader, Build(desc) });
+
+	desc = Valid;
+	desc.DXGIFormat = 0;
+	cases.push_back({ "unknown DXGI format", EDDSParseResult::Unsupported, Build(desc) });
+
+	desc = Legacy;
+	desc.FourCC = MakeFourCC('U', 'Y', 'V', 'Y');
+	cases.push_back({ "unknown FourCC", EDDSParseResult::Unsupported, Build(desc) });
+
+	desc = Legacy;
+	desc.Caps2 = 0x200 | 0x400;
+	desc.DataSize *= 6;
+	cases.push_back({ "cube with missing faces", EDDSParseResult::Unsupported, Build(desc) });
+	return cases;
+}
+
+// Offsets follow the cooked mips back to back after the DX10 header
+bool MatchesCooked(const SDDSLayout& Layout, const SCookedTexture& Texture)
+{
+	if (Layout.MipCount != Texture.Mips.size() || Layout.Subresources.size() != Texture.Mips.size())
+	{
+		return false;
+	}
+	size_t offset = 4 + 124 + 20;
+	for (uint32_t mip = 0; mip < Layout.MipCount; mip++)
+	{
+		const auto& subresource = Layout.GetSubresource(mip, 0);
+		const auto& cooked = Texture.Mips[mip];
+		if (subresource.Offset != offset || subresource.RowPitch != cooked.RowPitch || subresource.SlicePitch != cooked.Data.size()
+		    || subresource.Width != cooked.Width || subresource.Height != cooked.Height)
+		{
+			return false;
+		}
+		offset += cooked.Data.size();
+	}
+	return true;
+}
+} // namespace
+
+CHECK_SUITE(DDSLayout,
+            "DDS header parsing and subresource layout of synthetic DX10 and legacy files, truncated and invalid files rejected",
+            "--iterations <n> (default 200000)")
+{
+	const auto cases = GetLayoutCases();
+	for (const auto& layoutCase : cases)
+	{
+		const auto file = Build(layoutCase.Desc);
+		const std::string name = layoutCase.Name;
+		SDDSLayout layout;
+		const auto result = DDSLayout::Parse(file.data(), file.size(), layout);
+		if (!Context.Check(result == EDDSParseResult::Ok, name + " parses (" + ToString(result) + ")"))
+		{
+			continue;
+		}
+
+		Context.Check(layout.DXGIFormat == layoutCase.DXGIFormat && layout.bDX10Header == layoutCase.Desc.bDX10, name + " format and header");
+		Context.Check(layout.ArraySize == layoutCase.ArraySize && layout.bCubeMap == layoutCase.bCubeMap && layout.Dimension == layoutCase.Dimension,
+		              name + " dimension, array size and cube flag");
+		Context.Check(layout.Subresources.size() == static_cast<size_t>(layout.ArraySize) * layout.MipCount, name + " has a subresource per mip and slice");
+
+		bool bMatches = true;
+		for (const auto& expected : layoutCase.Expected)
+		{
+			const auto& subresource = layout.GetSubresource(expected.Mip, expected.Slice);
+			bMatches &= subresource.Offset == expected.Offset && subresource.RowPitch == expected.RowPitch && subresource.SlicePitch == expected.SlicePitch
+			            && subresource.NumRows == expected.NumRows && subresource.Width == expected.Width && subresource.Height == expected.Height
+			            && subresource.Depth == expected.Depth;
+		}
+		const auto& last = layout.Subresources.back();
+		bMatches &= last.Offset + last.SlicePitch * last.Depth == file.size();
+		Context.Check(bMatches, name + " offsets and pitches");
+
+		// Every prefix is short of some subresource or the header
+		uint32_t numAccepted = 0;
+		for (size_t size = 0; size < file.size(); size++)
+		{
+			SDDSLayout truncated;
+			numAccepted += DDSLayout::Parse(file.data(), size, truncated) != EDDSParseResult::Truncated || !truncated.Subresources.empty();
+		}
+		Context.Check(numAccepted == 0, name + " truncated to any length is rejected (" + std::to_string(numAccepted) + " are not)");
+	}
+
+	SDDSLayout empty;
+	Context.Check(DDSLayout::Parse(nullptr, 0, empty) == EDDSParseResult::Truncated, "no data is truncated");
+	for (const auto& rejectCase : GetRejectCases(cases[0].Desc, cases[6].Desc))
+	{
+		SDDSLayout layout;
+		const auto result = DDSLayout::Parse(rejectCase.File.data(), rejectCase.File.size(), layout);
+		Context.Check(result == rejectCase.Expected, std::string(rejectCase.Name) + " is " + ToString(rejectCase.Expected) + " (" + ToString(result) + ")");
+	}
+
+	// The cooker writes what the loader reads, through the same mapping the loader uses
+	{
+		STextureImage image;
+		image.Width = 64;
+		image.Height = 32;
+		image.Pixels.resize(static_cast<size_t>(image.Width) * image.Height * 4);
+		for (size_t i = 0; i < image.Pixels.size(); i++)
+		{
+			image.Pixels[i] = static_cast<uint8_t>(i * 7);
+		}
+
+		OScratchDirectory scratch("DDSLayout");
+		for (const auto format : { ECookedFormat::RGBA8, ECookedFormat::BC1, ECookedFormat::BC7 })
+		{
+			SCookSettings settings;
+			settings.Format = format;
+			settings.NumThreads = 1;
+			const auto texture = TextureCooker::Cook(image, settings);
+			const auto path = scratch / (std::string(ToString(format)) + ".dds");
+			const std::string name = std::string("cooked ") + ToString(format);
+
+			OMappedFile file;
+			if (!Context.Check(TextureCooker::WriteDDS(path, texture) && file.Open(path), name + " is written and mapped"))
+			{
+				continue;
+			}
+			SDDSLayout layout;
+			const auto result = DDSLayout::Parse(file.GetData(), file.GetSize(), layout);
+			Context.Check(result == EDDSParseResult::Ok && layout.DXGIFormat == GetDXGIFormat(texture.Format) && MatchesCooked(layout, texture),
+			              name + " layout matches the cooked mips");
+		}
+	}
+
+	if (!Context.IsBenchmarking())
+	{
+		return;
+	}
+	const auto iterations = Context.GetUInt("iterations", 200000);
+	for (const auto& layoutCase : cases)
+	{
+		const auto file = Build(layoutCase.Desc);
+		SDDSLayout layout;
+		const double nanoseconds = MeasureNanoseconds(iterations, [&]() { DDSLayout::Parse(file.data(), file.size(), layout); });
+		std::printf("%-20s %3zu subresources %8.1f ns per parse\n", layoutCase.Name, layout.Subresources.size(), nanoseconds);
+	}
+}
@@ -0,0 +1,301 @@
+#include "CheckFixtures.h"
+#include "CheckRegistry.h"
+#include "RenderTarget/RenderObject/DescriptorAllocator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * ODescriptorAllocator against a fake heap: every descriptor records the texture written to it and the last frame that read it.
+ * Textures are added and removed at random while frames are in flight and the check fails when a live range overlaps another
+ * one, a descriptor is rewritten before the frames reading it completed, a stale handle still resolves or a transient range
+ * overlaps one that is still in flight. The timing is add and remove at runtime.
+ */
+
+namespace
+{
+constexpr int64_t NoOwner = -1;
+
+struct SFakeDescriptor
+{
+	int64_t Owner = NoOwner;
+	uint64_t LastReadFence = 0;
+};
+
+struct STexture
+{
+	SDescriptorID ID;
+	int64_t Name = NoOwner;
+};
+
+struct SFakeHeap
+{
+	std::vector<SFakeDescriptor> Descriptors;
+	uint32_t NumErrors = 0;
+
+	void Fail(const char* Message, uint32_t Index)
+	{
+		if (NumErrors++ < 10)
+		{
+			std::printf("  FAILED: %s at descriptor %u\n", Message, Index);
+		}
+	}
+
+	// CreateShaderResourceView, the GPU must be done with the previous view of the descriptor
+	void Write(uint32_t Index, uint32_t Count, int64_t Owner, uint64_t CompletedFence)
+	{
+		for (uint32_t idx = Index; idx < Index + Count; idx++)
+		{
+			if (idx >= Descriptors.size())
+			{
+				Fail("range out of the heap", idx);
+				return;
+			}
+			auto& descriptor = Descriptors[idx];
+			if (descriptor.Owner != NoOwner)
+			{
+				Fail("overlap with a live range", idx);
+			}
+			if (descriptor.LastReadFence > CompletedFence)
+			{
+				Fail("rewritten while in flight", idx);
+			}
+			descriptor.Owner = Owner;
+		}
+	}
+
+	void Read(uint32_t Index, uint32_t Count, int64_t Owner, uint64_t Fence)
+	{
+		for (uint32_t idx = Index; idx < Index + Count; idx++)
+		{
+			if (Descriptors[idx].Owner != Owner)
+			{
+				Fail("handle resolves to another range", idx);
+			}
+			Descriptors[idx].LastReadFence = Fence;
+		}
+	}
+
+	void Clear(uint32_t Index, uint32_t Count)
+	{
+		for (uint32_t idx = Index; idx < Index + Count; idx++)
+		{
+			Descriptors[idx].Owner = NoOwner;
+		}
+	}
+};
+
+struct SSettings
+{
+	uint32_t Frames = 20000;
+	uint32_t Persistent = 312;
+	uint32_t Transient = 256;
+	uint32_t Latency = 3;
+	uint32_t Seed = 1;
+};
+
+void RunSimulation(OCheckContext& Context, const SSettings& Settings)
+{
+	constexpr uint32_t baseIndex = 16;
+	ODescriptorAllocator allocator;
+	allocator.Init(baseIndex, Settings.Persistent, Settings.Transient);
+
+	SFakeHeap heap;
+	heap.Descriptors.resize(baseIndex + Settings.Persistent + Settings.Transient);
+
+	std::mt19937 random(Settings.Seed);
+	std::vector<STexture> textures;
+	std::vector<SDescriptorID> staleIDs;
+	std::vector<std::pair<uint64_t, std::vector<std::pair<uint32_t, uint32_t>>>> transientInFlight;
+	int64_t nextName = 0;
+	uint64_t completedFence = 0;
+	uint64_t numAdded = 0;
+	uint64_t numRemoved = 0;
+	uint64_t numFull = 0;
+	uint64_t numTransient = 0;
+	uint64_t numTransientFull = 0;
+
+	for (uint64_t fence = 1; fence <= Settings.Frames; fence++)
+	{
+		// The fake GPU completes the frames that fell out of the latency window
+		if (fence > Settings.Latency)
+		{
+			completedFence = fence - Settings.Latency;
+		}
+		allocator.Retire(completedFence);
+		std::erase_if(transientInFlight, [&](const auto& Frame) {
+			if (Frame.first > completedFence)
+			{
+				return false;
+			}
+			for (const auto& [index, count] : Frame.second)
+			{
+				heap.Clear(index, count);
+			}
+			return true;
+		});
+
+		// Streaming keeps the region between a third and full, bursts of removals make holes to merge
+		const uint32_t numChanges = random() % 8;
+		for (uint32_t change = 0; change < numChanges; change++)
+		{
+			const bool bAdd = textures.empty() || random() % 100 < (textures.size() < Settings.Persistent / 3 ? 80u : 50u);
+			if (bAdd)
+			{
+				const uint32_t count = random() % 10 == 0 ? 1 + random() % 6 : 1;
+				STexture texture;
+				texture.ID = allocator.Allocate(count);
+				texture.Name = nextName++;
+				if (!allocator.IsValid(texture.ID))
+				{
+					numFull++;
+					continue;
+				}
+				heap.Write(allocator.GetIndex(texture.ID), count, texture.Name, completedFence);
+				textures.push_back(texture);
+				numAdded++;
+			}
+			else
+			{
+				const size_t victim = random() % textures.size();
+				const auto texture = textures[victim];
+				heap.Clear(allocator.GetIndex(texture.ID), allocator.GetCount(texture.ID));
+				allocator.Free(texture.ID);
+				staleIDs.push_back(texture.ID);
+				textures[victim] = textures.back();
+				textures.pop_back();
+				numRemoved++;
+			}
+		}
+
+		for (const auto& id : staleIDs)
+		{
+			if (allocator.IsValid(id) || allocator.GetIndex(id) != ODescriptorAllocator::InvalidIndex)
+			{
+				heap.Fail("stale handle resolves", id.Slot);
+			}
+		}
+		if (staleIDs.size() > 4096)
+		{
+			staleIDs.erase(staleIDs.begin(), staleIDs.begin() + 2048);
+		}
+
+		// The frame reads every live texture and some transient tables
+		for (const auto& texture : textures)
+		{
+			heap.Read(allocator.GetIndex(texture.ID), allocator.GetCount(texture.ID), texture.Name, fence);
+		}
+
+		std::vector<std::pair<uint32_t, uint32_t>> transient;
+		const uint32_t numTables = random() % 6;
+		for (uint32_t table = 0; table < numTables; table++)
+		{
+			const uint32_t count = 1 + random() % 24;
+			const uint32_t index = allocator.AllocateTransient(count);
+			if (index == ODescriptorAllocator::InvalidIndex)
+			{
+				numTransientFull++;
+				continue;
+			}
+			if (index < baseIndex + Settings.Persistent)
+			{
+				heap.Fail("transient range in the persistent part", index);
+			}
+			heap.Write(index, count, -2 - static_cast<int64_t>(fence), completedFence);
+			heap.Read(index, count, -2 - static_cast<int64_t>(fence), fence);
+			transient.emplace_back(index, count);
+			numTransient++;
+		}
+		transientInFlight.emplace_back(fence, std::move(transient));
+		allocator.EndFrame(fence);
+	}
+
+	// Everything back and merged into one range once the GPU drains
+	for (const auto& texture : textures)
+	{
+		heap.Clear(allocator.GetIndex(texture.ID), allocator.GetCount(texture.ID));
+		allocator.Free(texture.ID);
+	}
+	allocator.EndFrame(Settings.Frames + 1);
+	allocator.Retire(Settings.Frames + 1);
+	Context.Check(heap.NumErrors == 0, "no overlap, rewrite in flight or stale handle in " + std::to_string(Settings.Frames) + " frames");
+	Context.Check(allocator.GetNumFree() == Settings.Persistent && allocator.GetNumLive() == 0 && allocator.GetNumTransientUsed() == 0, "no descriptor leaks once the GPU drains");
+	Context.Check(allocator.IsValid(allocator.Allocate(Settings.Persistent)), "the free ranges merge into one");
+	if (!Context.IsBenchmarking())
+	{
+		return;
+	}
+	std::printf("Simulated %u frames, %u in flight: %ju adds, %ju removes, %ju adds rejected when full, %ju transient tables, %ju rejected\n",
+	            Settings.Frames,
+	            Settings.Latency,
+	            static_cast<uintmax_t>(numAdded),
+	            static_cast<uintmax_t>(numRemoved),
+	            static_cast<uintmax_t>(numFull),
+	            static_cast<uintmax_t>(numTransient),
+	            static_cast<uintmax_t>(numTransientFull));
+}
+
+// Add and remove of single descriptors at runtime with a quarter of the region live
+void MeasureRuntimeChurn(uint32_t NumDescriptors, uint32_t Seed)
+{
+	ODescriptorAllocator allocator;
+	allocator.Init(0, NumDescriptors);
+
+	std::mt19937 random(Seed);
+	std::vector<SDescriptorID> live;
+	for (uint32_t idx = 0; idx < NumDescriptors / 4; idx++)
+	{
+		live.push_back(allocator.Allocate());
+	}
+	std::shuffle(live.begin(), live.end(), random);
+
+	constexpr uint32_t numOperations = 2000000;
+	uint64_t fence = 0;
+	uint32_t operation = 0;
+	uint64_t checksum = 0;
+	const double nanoseconds = MeasureNanoseconds(numOperations, [&]() {
+		auto& id = live[operation % live.size()];
+		allocator.Free(id);
+		id = allocator.Allocate();
+		checksum += allocator.GetIndex(id);
+		if (operation++ % 32 == 31)
+		{
+			allocator.EndFrame(++fence);
+			allocator.Retire(fence > 2 ? fence - 2 : 0);
+		}
+	});
+	std::printf("%9u descriptors: %6.1f ns per remove and add (checksum %ju)\n",
+	            NumDescriptors,
+	            nanoseconds,
+	            static_cast<uintmax_t>(checksum % 1000));
+}
+} // namespace
+
+CHECK_SUITE(DescriptorAllocator,
+            "Descriptor allocator against a fake heap with frames in flight, runtime add and remove cost",
+            "--frames <n> (default 20000) --persistent <n> (312) --transient <n> (256) --latency <n> (3) --seed <n> (1)")
+{
+	SSettings settings;
+	auto get = [&](const char* Name, uint32_t& Out) {
+		Out = std::max(static_cast<uint32_t>(Context.GetUInt(Name, Out)), 1u);
+	};
+	get("frames", settings.Frames);
+	get("persistent", settings.Persistent);
+	get("transient", settings.Transient);
+	get("latency", settings.Latency);
+	get("seed", settings.Seed);
+
+	RunSimulation(Context, settings);
+	if (!Context.IsBenchmarking())
+	{
+		return;
+	}
+	for (const uint32_t numDescriptors : { 312u, 4096u, 1000000u })
+	{
+		MeasureRuntimeChurn(numDescriptors, settings.Seed);
+	}
+}
@@ -0,0 +1,294 @@
+#include "CheckFixtures.h"
+#include "CheckRegistry.h"
+#include "FramePipeline/FramePipeline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * OFramePipeline against a mock engine. The update stage fills a slot with the data of its frame, the record stage checks
+ * the slot while spending its time and hands it to a mock GPU that holds it for a few ticks. Between ticks the mock waits
+ * for the GPU to release the slot the next update writes, like the engine waits for the frame resource fence. Fails when
+ * an update writes a slot that is being recorded, still read by the GPU or holding a frame that was not recorded yet, a
+ * slot changes while it is recorded, or frames are recorded twice, never or out of order, also while threading is toggled
+ * between ticks. The timing is the tick time with and without threading for a few update and record costs.
+ */
+
+namespace
+{
+struct SSettings
+{
+	uint32_t Frames = 3000;
+	uint32_t TimedFrames = 200;
+	uint32_t Seed = 1;
+};
+
+// Both stages report, the update from the worker thread
+struct SFailures
+{
+	std::atomic<uint32_t> Count = 0;
+
+	void Fail(const char* Message, uint64_t Value)
+	{
+		if (Count++ < 10)
+		{
+			std::printf("  FAILED: %s (%ju)\n", Message, static_cast<uintmax_t>(Value));
+		}
+	}
+};
+
+void Spin(uint32_t Microseconds)
+{
+	const auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(Microseconds);
+	while (std::chrono::steady_clock::now() < end)
+	{
+	}
+}
+
+enum class ESlotState : uint32_t
+{
+	Free,
+	Updating,
+	Updated,
+	Recording
+};
+
+struct SMockSlot
+{
+	std::atomic<ESlotState> State = ESlotState::Free;
+	uint64_t Frame = 0;
+	uint64_t Fence = 0;
+	std::vector<uint64_t> Data = std::vector<uint64_t>(1024);
+};
+
+class OMockEngine
+{
+public:
+	OMockEngine(uint32_t Depth, uint32_t InGPULatency, uint32_t InSeed)
+	    : Slots(Depth), GPULatency(InGPULatency), Seed(InSeed)
+	{
+		Pipeline.Initialize(Depth);
+	}
+
+	void Tick(uint32_t UpdateMicroseconds, uint32_t RecordMicroseconds)
+	{
+		// The engine waits for the fence of the frame resource before the update may write it
+		while (Completed < Slots[Pipeline.GetNextUpdateSlot()].Fence)
+		{
+			Completed++;
+			NumGPUWaits++;
+		}
+		Pipeline.Tick([&](uint32_t Slot) { Update(Slot, UpdateMicroseconds); }, [&](uint32_t Slot) { Record(Slot, RecordMicroseconds); });
+
+		// The GPU finishes a submission once GPULatency newer ones are queued
+		if (Submitted > GPULatency)
+		{
+			Completed = std::max(Completed, Submitted - GPULatency);
+		}
+	}
+
+	void Drain()
+	{
+		Pipeline.Drain([&](uint32_t Slot) { Record(Slot, 0); });
+	}
+
+	OFramePipeline Pipeline;
+	SFailures Failures;
+	uint64_t NumGPUWaits = 0;
+	std::vector<uint64_t> RecordedFrames;
+
+	// Updates never overlap each other, only the update stage touches it
+	std::set<std::thread::id> UpdateThreads;
+
+private:
+	uint64_t Value(uint64_t Frame, size_t Index) const { return (Frame * 0x9E3779B97F4A7C15ull) ^ (Index * 0xC2B2AE3D27D4EB4Full) ^ Seed; }
+
+	void Update(uint32_t Slot, uint32_t Microseconds)
+	{
+		UpdateThreads.insert(std::this_thread::get_id());
+		auto& slot = Slots[Slot];
+		const auto state = slot.State.exchange(ESlotState::Updating);
+		if (state == ESlotState::Recording)
+		{
+			Failures.Fail("update wrote the slot being recorded", Slot);
+		}
+		else if (state == ESlotState::Updated)
+		{
+			Failures.Fail("update overwrote a frame that was not recorded", slot.Frame);
+		}
+		if (Completed < slot.Fence)
+		{
+			Failures.Fail("update wrote a slot the GPU still reads", slot.Fence);
+		}
+
+		slot.Frame = NextFrame++;
+		for (size_t idx = 0; idx < slot.Data.size(); idx++)
+		{
+			slot.Data[idx] = Value(slot.Frame, idx);
+		}
+		Spin(Microseconds);
+		slot.State = ESlotState::Updated;
+	}
+
+	void Record(uint32_t Slot, uint32_t Microseconds)
+	{
+		auto& slot = Slots[Slot];
+		auto expected = ESlotState::Updated;
+		if (!slot.State.compare_exchange_strong(expected, ESlotState::Recording))
+		{
+			Failures.Fail("recorded a slot that was not updated", Slot);
+			return;
+		}
+		if (slot.Frame != RecordedFrames.size())
+		{
+			Failures.Fail("frame recorded out of order", slot.Frame);
+		}
+		RecordedFrames.push_back(slot.Frame);
+
+		const uint64_t frame = slot.Frame;
+		auto check = [&]() {
+			for (size_t idx = 0; idx < slot.Data.size(); idx++)
+			{
+				if (slot.Data[idx] != Value(frame, idx))
+				{
+					return false;
+				}
+			}
+			return slot.Frame == frame;
+		};
+		const bool bIntactBefore = check();
+		Spin(Microseconds);
+		if (!bIntactBefore || !check())
+		{
+			Failures.Fail("slot changed while it was recorded", frame);
+		}
+		slot.Fence = ++Submitted;
+		slot.State = ESlotState::Free;
+	}
+
+	std::vector<SMockSlot> Slots;
+	uint64_t NextFrame = 0;
+	uint64_t Submitted = 0;
+	uint64_t Completed = 0;
+	uint32_t GPULatency = 0;
+	uint64_t Seed = 0;
+};
+
+void CheckAllRecorded(OCheckContext& Context, const OMockEngine& Engine, const std::string& Title)
+{
+	bool bInOrder = Engine.Pipeline.GetNumRecorded() == Engine.Pipeline.GetNumUpdated() && Engine.RecordedFrames.size() == Engine.Pipeline.GetNumUpdated();
+	for (size_t idx = 0; idx < Engine.RecordedFrames.size(); idx++)
+	{
+		bInOrder &= Engine.RecordedFrames[idx] == idx;
+	}
+	Context.Check(Engine.Failures.Count == 0, Title + ": updates never write a slot being recorded or read by the GPU");
+	Context.Check(bInOrder, Title + ": every frame is recorded once and in order");
+	if (Context.IsBenchmarking())
+	{
+		std::printf("  %-44s %6ju frames %6ju GPU waits\n", Title.c_str(), static_cast<uintmax_t>(Engine.RecordedFrames.size()), static_cast<uintmax_t>(Engine.NumGPUWaits));
+	}
+}
+
+void Validate(OCheckContext& Context, const SSettings& Settings)
+{
+	for (const uint32_t depth : { 1u, 2u, 3u, 4u })
+	{
+		for (uint32_t latency = 0; latency < depth; latency++)
+		{
+			OMockEngine engine(depth, latency, Settings.Seed);
+			for (uint32_t frame = 0; frame < Settings.Frames; frame++)
+			{
+				engine.Tick(frame % 7 == 0 ? 50 : 0, frame % 5 == 0 ? 50 : 0);
+			}
+			engine.Drain();
+			const std::string title = "depth " + std::to_string(depth) + " with " + std::to_string(latency) + " frames on the GPU";
+			CheckAllRecorded(Context, engine, title);
+			if (depth == 1)
+			{
+				Context.Check(!engine.Pipeline.GetStats().bThreaded, "one slot never runs threaded");
+			}
+			else
+			{
+				const bool bOneWorker = engine.UpdateThreads.size() == 1 && !engine.UpdateThreads.contains(std::this_thread::get_id());
+				Context.Check(bOneWorker, title + ": every update runs on the same worker thread");
+			}
+		}
+	}
+
+	// Threading is switched between ticks the way the performance widget does it
+	OMockEngine engine(3, 1, Settings.Seed);
+	for (uint32_t frame = 0; frame < Settings.Frames; frame++)
+	{
+		if (frame % 97 == 0 || frame % 101 == 0)
+		{
+			engine.Pipeline.SetThreaded(!engine.Pipeline.IsThreaded());
+		}
+		engine.Tick(frame % 3 == 0 ? 30 : 0, frame % 4 == 0 ? 30 : 0);
+	}
+	engine.Drain();
+	CheckAllRecorded(Context, engine, "depth 3 toggling threads");
+	Context.Check(engine.UpdateThreads.size() == 2, "toggled updates run on the calling thread or the one worker");
+
+	// A failed update reaches the caller once the frame being recorded is done, the worker takes the next update
+	OFramePipeline pipeline;
+	pipeline.Initialize(2);
+	bool bRethrown = false;
+	try
+	{
+		pipeline.Tick([](uint32_t) { throw std::runtime_error("update"); }, [](uint32_t) {});
+	}
+	catch (const std::runtime_error&)
+	{
+		bRethrown = true;
+	}
+	uint32_t numUpdates = 0;
+	pipeline.Tick([&](uint32_t) { numUpdates++; }, [](uint32_t) {});
+	Context.Check(bRethrown && numUpdates == 1, "an exception of the update is rethrown by the tick and the worker keeps running");
+}
+
+void Benchmark(const SSettings& Settings)
+{
+	std::printf("Tick time, %u hardware threads\n", std::thread::hardware_concurrency());
+	const uint32_t costs[][2] = { { 2000, 2000 }, { 3000, 1000 }, { 1000, 3000 }, { 4000, 500 } };
+	for (const auto& [update, record] : costs)
+	{
+		double ms[2] = {};
+		for (const bool bThreaded : { false, true })
+		{
+			OMockEngine engine(3, 1, Settings.Seed);
+			engine.Pipeline.SetThreaded(bThreaded);
+			ms[bThreaded] = MeasureNanoseconds(Settings.TimedFrames, [&]() { engine.Tick(update, record); }) / 1.0e6;
+		}
+		std::printf("  update %4.1f ms record %4.1f ms: serial %5.2f ms threaded %5.2f ms (%3.0f%% of the sum)\n",
+		            update / 1000.0,
+		            record / 1000.0,
+		            ms[0],
+		            ms[1],
+		            100.0 * ms[1] / ((update + record) / 1000.0));
+	}
+}
+} // namespace
+
+CHECK_SUITE(FramePipeline,
+            "Frame pipeline slot protocol against a mock engine and GPU fence, serial against overlapped tick times",
+            "--frames <n> (default 3000) --timed <n> (200) --seed <n> (1)")
+{
+	SSettings settings;
+	settings.Frames = static_cast<uint32_t>(std::max<uint64_t>(Context.GetUInt("frames", Context.IsBenchmarking() ? settings.Frames : 500), 1));
+	settings.TimedFrames = static_cast<uint32_t>(std::max<uint64_t>(Context.GetUInt("timed", settings.TimedFrames), 1));
+	settings.Seed = static_cast<uint32_t>(std::max<uint64_t>(Context.GetUInt("seed", settings.Seed), 1));
+
+	Validate(Context, settings);
+	if (Context.IsBenchmarking())
+	{
+		Benchmark(settings);
+	}
+}
@@ -0,0 +1,274 @@
+#include "CheckFixtures.h"
+#include "CheckRegistry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * Packs and copies the visible instances of one view the way the culling pass does, once with the old instance record and once with the compact one.
+ * The records mirror HLSL::InstanceData before and after the change, the destination stands in for the mapped upload buffer.
+ */
+
+namespace
+{
+struct SFloat3
+{
+	float X, Y, Z;
+};
+
+struct SFloat4
+{
+	float X, Y, Z, W;
+};
+
+struct SMatrix
+{
+	float M[4][4];
+};
+
+// What the engine keeps on the CPU for every instance
+struct SSourceInstance
+{
+	SMatrix World;
+	SMatrix TexTransform;
+	SFloat3 Position;
+	SFloat4 Rotation;
+	SFloat3 Scale;
+	uint32_t MaterialIndex;
+	SFloat3 OverrideColor;
+	SFloat3 BoundingBoxCenter;
+	SFloat3 BoundingBoxExtents;
+	bool bNeedsExtraData;
+};
+
+struct SLegacyInstance
+{
+	SMatrix World;
+	SMatrix TexTransform;
+	uint32_t MaterialIndex;
+	SFloat3 Position;
+	float Pad;
+	SFloat4 Rotation;
+	SFloat3 Scale;
+	float Pad3;
+	SFloat3 BoundingBoxCenter;
+	float Pad4;
+	SFloat3 BoundingBoxExtents;
+	float Pad5;
+	SFloat3 OverrideColor;
+	float Pad6;
+	SMatrix InvViewProjection;
+};
+
+struct SCompactInstance
+{
+	SFloat4 World[3];
+	uint32_t MaterialIndex;
+	uint32_t OverrideColor;
+	uint32_t Flags;
+	uint32_t Pad;
+};
+
+struct SCompactExtraData
+{
+	SMatrix TexTransform;
+	SMatrix InvViewProjection;
+	SFloat3 BoundingBoxCenter;
+	float Pad;
+	SFloat3 BoundingBoxExtents;
+	float Pad2;
+};
+
+static_assert(sizeof(SLegacyInstance) == 292);
+static_assert(sizeof(SCompactInstance) == 64);
+
+struct SResult
+{
+	double Milliseconds = 0.0;
+	size_t Bytes = 0;
+};
+
+SMatrix Transposed(const SMatrix& In)
+{
+	SMatrix result;
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			result.M[i][j] = In.M[j][i];
+		}
+	}
+	return result;
+}
+
+uint32_t ToUnorm8(float Value)
+{
+	return static_cast<uint32_t>(std::clamp(Value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+size_t PackLegacy(const SSourceInstance& Source, uint8_t* Destination, size_t Index, uint8_t*)
+{
+	SLegacyInstance data = {};
+	data.World = Transposed(Source.World);
+	data.TexTransform = Transposed(Source.TexTransform);
+	data.MaterialIndex = Source.MaterialIndex;
+	data.Position = Source.Position;
+	data.Rotation = Source.Rotation;
+	data.Scale = Source.Scale;
+	data.BoundingBoxCenter = Source.BoundingBoxCenter;
+	data.BoundingBoxExtents = Source.BoundingBoxExtents;
+	data.OverrideColor = Source.OverrideColor;
+	std::memcpy(Destination + Index * sizeof(data), &data, sizeof(data));
+	return sizeof(data);
+}
+
+size_t PackCompact(const SSourceInstance& Source, uint8_t* Destination, size_t Index, uint8_t* ExtraDestination)
+{
+	SCompactInstance data;
+	for (int column = 0; column < 3; column++)
+	{
+		data.World[column] = { Source.World.M[0][column], Source.World.M[1][column], Source.World.M[2][column], Source.World.M[3][column] };
+	}
+	data.MaterialIndex = Source.MaterialIndex;
+	data.OverrideColor = ToUnorm8(Source.OverrideColor.X) | ToUnorm8(Source.OverrideColor.Y) << 8 | ToUnorm8(Source.OverrideColor.Z) << 16 | 0xff000000;
+	data.Flags = Source.bNeedsExtraData ? 1 : 0;
+	data.Pad = 0;
+	std::memcpy(Destination + Index * sizeof(data), &data, sizeof(data));
+	if (!Source.bNeedsExtraData)
+	{
+		return sizeof(data);
+	}
+
+	SCompactExtraData extra = {};
+	extra.TexTransform = Transposed(Source.TexTransform);
+	extra.BoundingBoxCenter = Source.BoundingBoxCenter;
+	extra.BoundingBoxExtents = Source.BoundingBoxExtents;
+	std::memcpy(ExtraDestination + Index * sizeof(extra), &extra, sizeof(extra));
+	return sizeof(data) + sizeof(extra);
+}
+
+template<typename TPack>
+SResult Run(const std::vector<SSourceInstance>& Instances, uint32_t NumFrames, std::vector<uint8_t>& Destination, std::vector<uint8_t>& ExtraDestination, TPack&& Pack)
+{
+	SResult result;
+	result.Milliseconds = MeasureMilliseconds([&]() {
+		for (uint32_t frame = 0; frame < NumFrames; frame++)
+		{
+			for (size_t i = 0; i < Instances.size(); i++)
+			{
+				result.Bytes += Pack(Instances[i], Destination.data(), i, ExtraDestination.data());
+			}
+		}
+	});
+	return result;
+}
+
+void Print(const char* Name, const SResult& Result, uint32_t NumFrames)
+{
+	const double bytesPerFrame = static_cast<double>(Result.Bytes) / NumFrames;
+	const double msPerFrame = Result.Milliseconds / NumFrames;
+	std::printf("%-8s %8.2f MB per frame, %7.3f ms per frame, %6.2f GB/s\n", Name, bytesPerFrame / (1024.0 * 1024.0), msPerFrame, bytesPerFrame / (msPerFrame * 1.0e6));
+}
+
+std::vector<SSourceInstance> MakeInstances(uint32_t NumInstances, float ExtraFraction)
+{
+	std::mt19937 random(42);
+	std::uniform_real_distribution position(-1000.0f, 1000.0f);
+	std::uniform_real_distribution unit(0.0f, 1.0f);
+	std::vector<SSourceInstance> instances(NumInstances);
+	for (auto& instance : instances)
+	{
+		const float angle = unit(random) * 6.2831853f;
+		const float scale = 0.5f + unit(random);
+		instance.World = { { { std::cos(angle) * scale, 0.0f, -std::sin(angle) * scale, 0.0f },
+		                     { 0.0f, scale, 0.0f, 0.0f },
+		                     { std::sin(angle) * scale, 0.0f, std::cos(angle) * scale, 0.0f },
+		                     { position(random), position(random), position(random), 1.0f } } };
+		instance.TexTransform = { { { 1.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f } } };
+		instance.Position = { instance.World.M[3][0], instance.World.M[3][1], instance.World.M[3][2] };
+		instance.Rotation = { 0.0f, std::sin(angle * 0.5f), 0.0f, std::cos(angle * 0.5f) };
+		instance.Scale = { scale, scale, scale };
+		instance.MaterialIndex = static_cast<uint32_t>(unit(random) * 64.0f);
+		instance.OverrideColor = { unit(random), unit(random), unit(random) };
+		instance.BoundingBoxCenter = { 0.0f, 0.0f, 0.0f };
+		instance.BoundingBoxExtents = { 1.0f, 1.0f, 1.0f };
+		instance.bNeedsExtraData = unit(random) < ExtraFraction;
+	}
+
+	return instances;
+}
+} // namespace
+
+CHECK_SUITE(InstanceBandwidth,
+            "Packing of the visible instances into the old and the compact instance record",
+            "--instances <n> (default 100000) --frames <n> (100) --extra <0..1> (0)")
+{
+	const auto numInstances = static_cast<uint32_t>(Context.GetUInt("instances", Context.IsBenchmarking() ? 100000 : 1000));
+	const auto numFrames = static_cast<uint32_t>(Context.GetUInt("frames", 100));
+	const float extraFraction = Context.GetFloat("extra", 0.0f);
+
+	// Compact records keep the affine part of the world matrix and the color to 8 bits, extra data only where flagged
+	{
+		const auto instances = MakeInstances(1000, 0.5f);
+		std::vector<uint8_t> destination(instances.size() * sizeof(SCompactInstance));
+		std::vector<uint8_t> extraDestination(instances.size() * sizeof(SCompactExtraData));
+		const auto result = Run(instances, 1, destination, extraDestination, PackCompact);
+
+		size_t expectedBytes = 0;
+		bool bWorldExact = true;
+		bool bColorClose = true;
+		bool bFlagsMatch = true;
+		for (size_t i = 0; i < instances.size(); i++)
+		{
+			const auto& source = instances[i];
+			SCompactInstance packed;
+			std::memcpy(&packed, destination.data() + i * sizeof(packed), sizeof(packed));
+			for (int column = 0; column < 3; column++)
+			{
+				const SFloat4& row = packed.World[column];
+				bWorldExact &= row.X == source.World.M[0][column] && row.Y == source.World.M[1][column] && row.Z == source.World.M[2][column] && row.W == source.World.M[3][column];
+			}
+			const float color[3] = { source.OverrideColor.X, source.OverrideColor.Y, source.OverrideColor.Z };
+			for (int channel = 0; channel < 3; channel++)
+			{
+				const float unpacked = static_cast<float>(packed.OverrideColor >> (channel * 8) & 0xff) / 255.0f;
+				bColorClose &= std::abs(unpacked - color[channel]) <= 0.5f / 255.0f + 1e-6f;
+			}
+			bFlagsMatch &= packed.MaterialIndex == source.MaterialIndex && packed.Flags == (source.bNeedsExtraData ? 1u : 0u);
+			expectedBytes += sizeof(SCompactInstance) + (source.bNeedsExtraData ? sizeof(SCompactExtraData) : 0);
+		}
+		Context.Check(bWorldExact, "the compact record keeps the world matrix columns");
+		Context.Check(bColorClose, "the override color round trips within half a step of 8 bits");
+		Context.Check(bFlagsMatch, "material index and extra data flag are packed");
+		Context.Check(result.Bytes == expectedBytes, "only instances needing it write the extra data");
+	}
+	if (!Context.IsBenchmarking() || numFrames == 0)
+	{
+		return;
+	}
+
+	const auto instances = MakeInstances(numInstances, extraFraction);
+	std::vector<uint8_t> destination(numInstances * sizeof(SLegacyInstance));
+	std::vector<uint8_t> extraDestination(numInstances * sizeof(SCompactExtraData));
+
+	// Touch the pages once so the first layout does not pay for the page faults
+	std::memset(destination.data(), 0, destination.size());
+	std::memset(extraDestination.data(), 0, extraDestination.size());
+
+	const auto legacy = Run(instances, numFrames, destination, extraDestination, PackLegacy);
+	const auto compact = Run(instances, numFrames, destination, extraDestination, PackCompact);
+
+	std::printf("%u instances, %u frames, %.0f%% with extra data\n", numInstances, numFrames, extraFraction * 100.0f);
+	Print("Legacy", legacy, numFrames);
+	Print("Compact", compact, numFrames);
+	if (compact.Bytes > 0 && compact.Milliseconds > 0.0)
+	{
+		std::printf("Compact uploads %.2fx less and packs %.2fx faster\n", static_cast<double>(legacy.Bytes) / compact.Bytes, legacy.Milliseconds / compact.Milliseconds);
+	}
+}
@@ -0,0 +1,174 @@
+#include "CheckRegistry.h"
+#include "LightCulling/LightSlots.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/*
+ * OLightSlots driven the way OEngine::UpdateLightSlots and UpdateLightCB use it: one buffer per light type and frame
+ * resource, a light writes its slot while it is dirty and moved lights are dirtied again. After lights are removed from the
+ * middle of the list every frame resource has to hold the data of the light packed into each slot.
+ */
+
+namespace
+{
+constexpr uint32_t NumFrameResources = 3;
+constexpr uint32_t NumTypes = 3;
+
+struct SLight
+{
+	SLightSlotKey Key;
+	uint32_t Data = 0;
+	int NumFramesDirty = NumFrameResources;
+};
+
+struct SScene
+{
+	std::vector<SLight> Lights;
+	OLightSlots Slots;
+	std::vector<SLightSlotKey> Keys;
+
+	// Per frame resource and type, the value written into every slot
+	std::vector<uint32_t> Buffers[NumFrameResources][NumTypes];
+	uint32_t Frame = 0;
+	uint32_t NumWrites = 0;
+
+	void Update()
+	{
+		Keys.clear();
+		for (const auto& light : Lights)
+		{
+			Keys.push_back(light.Key);
+		}
+		Slots.Assign(Keys);
+
+		auto& buffers = Buffers[Frame++ % NumFrameResources];
+		for (uint32_t i = 0; i < Lights.size(); i++)
+		{
+			auto& light = Lights[i];
+			if (Slots.IsMoved(i))
+			{
+				light.NumFramesDirty = NumFrameResources;
+			}
+			if (light.NumFramesDirty > 0)
+			{
+				light.NumFramesDirty--;
+				auto& buffer = buffers[light.Key.Type];
+				const uint32_t slot = Slots.GetSlot(i);
+				buffer.resize(std::max<size_t>(buffer.size(), slot + 1), UINT32_MAX);
+				buffer[slot] = light.Data;
+				NumWrites++;
+			}
+		}
+	}
+
+	// Slots past the light count are not read by the shaders
+	bool IsConsistent() const
+	{
+		for (const auto& frame : Buffers)
+		{
+			uint32_t numSlots[NumTypes] = {};
+			for (const auto& light : Lights)
+			{
+				const uint32_t slot = numSlots[light.Key.Type]++;
+				const auto& buffer = frame[light.Key.Type];
+				if (slot >= buffer.size() || buffer[slot] != light.Data)
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	void Settle()
+	{
+		for (uint32_t i = 0; i < NumFrameResources; i++)
+		{
+			Update();
+		}
+	}
+};
+} // namespace
+
+CHECK_SUITE(LightSlots,
+            "Per type light buffer slots, removed lights in the middle of the list leave no stale slots",
+            "--lights <n> (default 1024)")
+{
+	SScene scene;
+	uint32_t nextId = 0;
+	auto addLight = [&](uint32_t Type) {
+		SLight light;
+		light.Key = { Type, nextId };
+		light.Data = 1000 + nextId++;
+		scene.Lights.push_back(light);
+	};
+
+	// Point and spot lights interleaved after a directional light
+	addLight(0);
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		addLight(1);
+		addLight(2);
+	}
+	scene.Settle();
+	Context.Check(scene.IsConsistent(), "every frame resource holds the lights in list order");
+
+	const uint32_t writesBefore = scene.NumWrites;
+	scene.Update();
+	Context.Check(scene.NumWrites == writesBefore, "clean lights that keep their slot are not written again");
+
+	// The second point light, the later point lights move down one slot
+	scene.Lights.erase(scene.Lights.begin() + 3);
+	scene.Update();
+	uint32_t numDirty = 0;
+	bool bOthersClean = true;
+	for (uint32_t i = 0; i < scene.Lights.size(); i++)
+	{
+		const auto& light = scene.Lights[i];
+		const bool bShouldMove = light.Key.Type == 1 && i >= 3;
+		numDirty += bShouldMove && light.NumFramesDirty == NumFrameResources - 1;
+		bOthersClean &= bShouldMove || light.NumFramesDirty == 0;
+	}
+	Context.Check(numDirty == 2, "the point lights after the removed one are written again");
+	Context.Check(bOthersClean, "lights before it and lights of other types stay clean");
+	scene.Settle();
+	Context.Check(scene.IsConsistent(), "every frame resource holds the remaining lights in their new slots");
+	Context.Check(scene.Slots.GetNumSlots(1) == 3 && scene.Slots.GetNumSlots(2) == 4, "the slot counts follow the light counts");
+
+	// The first light of each type goes, a new light takes the freed id at the end of the list
+	scene.Lights.erase(scene.Lights.begin() + 1, scene.Lights.begin() + 3);
+	scene.Lights.push_back({ { 1, 3 }, 5000 });
+	scene.Update();
+	scene.Settle();
+	Context.Check(scene.IsConsistent(), "lights removed at the front and a reused id leave no stale slot");
+
+	scene.Lights.clear();
+	scene.Update();
+	Context.Check(scene.Slots.GetNumSlots(0) == 0 && scene.Slots.GetNumSlots(1) == 0, "an empty list has no slots");
+
+	if (!Context.IsBenchmarking())
+	{
+		return;
+	}
+	const auto numLights = static_cast<uint32_t>(Context.GetUInt("lights", 1024));
+	std::vector<SLightSlotKey> keys;
+	for (uint32_t i = 0; i < numLights; i++)
+	{
+		keys.push_back({ i % NumTypes, i });
+	}
+	OLightSlots slots;
+	constexpr uint32_t numRuns = 1000;
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t run = 0; run < numRuns; run++)
+	{
+		// Swapped lights change their slots like removals do
+		std::swap(keys[0], keys[run % numLights]);
+		slots.Assign(keys);
+	}
+	const auto end = std::chrono::steady_clock::now();
+	std::printf("Assign %u lights: %.3f us\n", numLights, std::chrono::duration<double, std::micro>(end - start).count() / numRuns);
+}
@@ -0,0 +1,217 @@
+#include "CheckFixtures.h"
+#include "CheckRegistry.h"
+#include "CompactMesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * OCompactMesh on grids from a few hundred to a few million vertices. Fails when an index changes, a decoded position is
+ * further from the original than GetMaxError allows, GetPosition and Decode disagree, or a ray through the center of a
+ * triangle misses the decoded triangle. The report is the CPU bytes a mesh keeps with full and compact residency and the
+ * time to decode it for picking and occlusion.
+ */
+
+namespace
+{
+// sizeof(SVertex): position, normal, texture coordinates and tangent
+constexpr uint64_t VertexBlobStride = 44;
+
+struct SSettings
+{
+	uint32_t Rays = 2000;
+	uint32_t Seed = 1;
+};
+
+struct SFailures
+{
+	uint32_t Count = 0;
+
+	void Fail(const char* Message, uint64_t Value)
+	{
+		if (Count++ < 10)
+		{
+			std::printf("  FAILED: %s (%ju)\n", Message, static_cast<uintmax_t>(Value));
+		}
+	}
+};
+
+struct SMesh
+{
+	std::vector<float> Positions;
+	std::vector<uint32_t> Indices;
+};
+
+// Rows x Columns vertices over Size meters with a rolling height, two triangles per cell
+SMesh MakeGrid(uint32_t Rows, uint32_t Columns, float Size, float Height, std::mt19937& Random)
+{
+	SMesh mesh;
+	std::uniform_real_distribution<float> jitter(-0.1f, 0.1f);
+	const float dx = Size / std::max(Columns - 1, 1u);
+	const float dz = Size / std::max(Rows - 1, 1u);
+	for (uint32_t row = 0; row < Rows; row++)
+	{
+		for (uint32_t column = 0; column < Columns; column++)
+		{
+			const float x = column * dx - Size * 0.5f + jitter(Random) * dx;
+			const float z = row * dz - Size * 0.5f + jitter(Random) * dz;
+			mesh.Positions.insert(mesh.Positions.end(), { x, Height * std::sin(x * 0.05f) * std::cos(z * 0.05f), z });
+		}
+	}
+	for (uint32_t row = 0; row + 1 < Rows; row++)
+	{
+		for (uint32_t column = 0; column + 1 < Columns; column++)
+		{
+			const uint32_t v = row * Columns + column;
+			mesh.Indices.insert(mesh.Indices.end(), { v, v + Columns, v + 1, v + 1, v + Columns, v + Columns + 1 });
+		}
+	}
+	return mesh;
+}
+
+// Moller-Trumbore, returns the distance along the ray or a negative value on a miss
+float IntersectTriangle(const float* Origin, const float* Dir, const float* V0, const float* V1, const float* V2)
+{
+	const float e1[3] = { V1[0] - V0[0], V1[1] - V0[1], V1[2] - V0[2] };
+	const float e2[3] = { V2[0] - V0[0], V2[1] - V0[1], V2[2] - V0[2] };
+	const float p[3] = { Dir[1] * e2[2] - Dir[2] * e2[1], Dir[2] * e2[0] - Dir[0] * e2[2], Dir[0] * e2[1] - Dir[1] * e2[0] };
+	const float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+	if (std::abs(det) < 1e-12f)
+	{
+		return -1.0f;
+	}
+	const float invDet = 1.0f / det;
+	const float s[3] = { Origin[0] - V0[0], Origin[1] - V0[1], Origin[2] - V0[2] };
+	const float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+	const float q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+	const float v = (Dir[0] * q[0] + Dir[1] * q[1] + Dir[2] * q[2]) * invDet;
+	if (u < 0.0f || v < 0.0f || u + v > 1.0f)
+	{
+		return -1.0f;
+	}
+	return (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * invDet;
+}
+
+void Validate(OCheckContext& Context, const std::string& Title, const SMesh& Mesh, const SSettings& Settings, std::mt19937& Random)
+{
+	SFailures failures;
+	const uint32_t numVertices = static_cast<uint32_t>(Mesh.Positions.size() / 3);
+	const uint32_t numIndices = static_cast<uint32_t>(Mesh.Indices.size());
+	OCompactMesh compact;
+	compact.Build(Mesh.Positions.data(), numVertices, Mesh.Indices.data(), numIndices);
+
+	std::vector<float> positions;
+	std::vector<uint32_t> indices;
+	const double decodeMs = MeasureMilliseconds([&]() { compact.Decode(positions, indices); });
+
+	if (compact.GetNumVertices() != numVertices || compact.GetNumIndices() != numIndices || positions.size() != Mesh.Positions.size() || indices.size() != numIndices)
+	{
+		Context.Check(false, Title + ": vertex and index counts are kept");
+		return;
+	}
+	if (indices != Mesh.Indices)
+	{
+		failures.Fail("indices changed", numIndices);
+	}
+	for (uint32_t idx = 0; idx < numIndices; idx += 97)
+	{
+		if (compact.GetIndex(idx) != Mesh.Indices[idx])
+		{
+			failures.Fail("GetIndex", idx);
+			break;
+		}
+	}
+
+	const auto maxError = compact.GetMaxError();
+	float worst = 0.0f;
+	for (uint32_t vertex = 0; vertex < numVertices; vertex++)
+	{
+		const auto position = compact.GetPosition(vertex);
+		for (uint32_t axis = 0; axis < 3; axis++)
+		{
+			const float original = Mesh.Positions[vertex * 3 + axis];
+			const float error = std::abs(positions[vertex * 3 + axis] - original);
+			worst = std::max(worst, error);
+			if (error > maxError[axis] || position[axis] != positions[vertex * 3 + axis])
+			{
+				failures.Fail("decoded position", vertex);
+				vertex = numVertices;
+				break;
+			}
+		}
+	}
+
+	// Rays straight down through the centers of the original triangles
+	uint32_t numMisses = 0;
+	if (numIndices >= 3)
+	{
+		std::uniform_int_distribution<uint32_t> triangle(0, numIndices / 3 - 1);
+		const float dir[3] = { 0.0f, -1.0f, 0.0f };
+		for (uint32_t ray = 0; ray < Settings.Rays; ray++)
+		{
+			const uint32_t first = triangle(Random) * 3;
+			float origin[3] = { 0.0f, 1000.0f, 0.0f };
+			for (uint32_t corner = 0; corner < 3; corner++)
+			{
+				origin[0] += Mesh.Positions[Mesh.Indices[first + corner] * 3] / 3.0f;
+				origin[2] += Mesh.Positions[Mesh.Indices[first + corner] * 3 + 2] / 3.0f;
+			}
+			const float* v0 = &positions[indices[first] * 3];
+			const float* v1 = &positions[indices[first + 1] * 3];
+			const float* v2 = &positions[indices[first + 2] * 3];
+			if (IntersectTriangle(origin, dir, v0, v1, v2) < 0.0f)
+			{
+				numMisses++;
+			}
+		}
+	}
+	if (numMisses > 0)
+	{
+		failures.Fail("picking rays missed the decoded triangle", numMisses);
+	}
+	Context.Check(failures.Count == 0, Title + ": indices, decoded positions and picking rays match the original mesh");
+	if (!Context.IsBenchmarking())
+	{
+		return;
+	}
+
+	const uint64_t blobBytes = numVertices * VertexBlobStride + numIndices * sizeof(uint32_t);
+	const uint64_t submeshBytes = numVertices * 3ull * sizeof(float) + numIndices * sizeof(uint32_t);
+	const uint64_t fullBytes = blobBytes + submeshBytes;
+	std::printf("  %-22s %8u vertices full %9.1f KB compact %8.1f KB (%4.1f%%) error %.2e decode %7.3f ms\n",
+	            Title.c_str(),
+	            numVertices,
+	            fullBytes / 1024.0,
+	            compact.GetByteSize() / 1024.0,
+	            fullBytes > 0 ? 100.0 * compact.GetByteSize() / fullBytes : 0.0,
+	            worst,
+	            decodeMs);
+}
+} // namespace
+
+CHECK_SUITE(MeshResidency,
+            "Compact picking meshes against the original grids, full against compact residency bytes and decode time",
+            "--rays <n> (default 2000) --seed <n> (1)")
+{
+	SSettings settings;
+	settings.Rays = static_cast<uint32_t>(std::max<uint64_t>(Context.GetUInt("rays", settings.Rays), 1));
+	settings.Seed = static_cast<uint32_t>(std::max<uint64_t>(Context.GetUInt("seed", settings.Seed), 1));
+
+	std::mt19937 random(settings.Seed);
+	if (Context.IsBenchmarking())
+	{
+		std::printf("Full residency keeps the vertex and index blobs and the submesh positions and indices\n");
+	}
+	Validate(Context, "empty", {}, settings, random);
+	Validate(Context, "flat 16x16", MakeGrid(16, 16, 10.0f, 0.0f, random), settings, random);
+	Validate(Context, "grid 64x64", MakeGrid(64, 64, 50.0f, 4.0f, random), settings, random);
+	Validate(Context, "grid 256x256", MakeGrid(256, 256, 200.0f, 10.0f, random), settings, random);
+	Validate(Context, "grid 256x257", MakeGrid(256, 257, 200.0f, 10.0f, random), settings, random);
+	Validate(Context, "terrain 1024x1024", MakeGrid(1024, 1024, 2000.0f, 50.0f, random), settings, random);
+	Validate(Context, "terrain 2048x2048", MakeGrid(2048, 2048, 4000.0f, 80.0f, random), settings, random);
+}
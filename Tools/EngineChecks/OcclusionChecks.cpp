@@ -0,0 +1,301 @@
+#include "CheckFixtures.h"
+#include "CheckRegistry.h"
+#include "OcclusionCulling/SoftwareOcclusion.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+
+/*
+ * City block scene: a grid of buildings in front of the camera and small props scattered between them.
+ * The buildings are the occluders, every building and prop is tested against the depth buffer. A prop reported as
+ * occluded has to be hidden from the eye by the rasterized buildings at its center and every corner.
+ */
+
+namespace
+{
+struct SBox
+{
+	float Center[3];
+	float Extents[3];
+};
+
+SOcclusionMatrix Multiply(const SOcclusionMatrix& A, const SOcclusionMatrix& B)
+{
+	SOcclusionMatrix result;
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			for (int k = 0; k < 4; k++)
+			{
+				result.M[i][j] += A.M[i][k] * B.M[k][j];
+			}
+		}
+	}
+	return result;
+}
+
+// Left handed look along +z from Eye rotated by Yaw, projection as in XMMatrixPerspectiveFovLH
+SOcclusionMatrix BuildViewProj(const float Eye[3], float Yaw, float Aspect)
+{
+	const float s = std::sin(Yaw);
+	const float c = std::cos(Yaw);
+	SOcclusionMatrix view;
+	view.M[0][0] = c;
+	view.M[0][2] = s;
+	view.M[1][1] = 1.0f;
+	view.M[2][0] = -s;
+	view.M[2][2] = c;
+	view.M[3][0] = -(Eye[0] * c - Eye[2] * s);
+	view.M[3][1] = -Eye[1];
+	view.M[3][2] = -(Eye[0] * s + Eye[2] * c);
+	view.M[3][3] = 1.0f;
+
+	const float nearZ = 0.1f;
+	const float farZ = 2000.0f;
+	const float height = 1.0f / std::tan(0.25f * 3.14159265f);
+	SOcclusionMatrix proj;
+	proj.M[0][0] = height / Aspect;
+	proj.M[1][1] = height;
+	proj.M[2][2] = farZ / (farZ - nearZ);
+	proj.M[2][3] = 1.0f;
+	proj.M[3][2] = -nearZ * farZ / (farZ - nearZ);
+	return Multiply(view, proj);
+}
+
+// Unit cube around the origin, outward faces are clockwise
+void BuildCube(std::vector<float>& OutPositions, std::vector<uint32_t>& OutIndices)
+{
+	OutPositions.clear();
+	for (int i = 0; i < 8; i++)
+	{
+		OutPositions.push_back(i & 1 ? 1.0f : -1.0f);
+		OutPositions.push_back(i & 2 ? 1.0f : -1.0f);
+		OutPositions.push_back(i & 4 ? 1.0f : -1.0f);
+	}
+	OutIndices = { 0, 2, 3, 0, 3, 1, 4, 5, 7, 4, 7, 6, 0, 4, 6, 0, 6, 2, 1, 3, 7, 1, 7, 5, 0, 1, 5, 0, 5, 4, 2, 6, 7, 2, 7, 3 };
+}
+
+// Slab test of the segment from From to To against the box
+bool SegmentHitsBox(const float From[3], const float To[3], const SBox& Box)
+{
+	float enter = 0.0f;
+	float exit = 1.0f;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		const float direction = To[axis] - From[axis];
+		const float low = Box.Center[axis] - Box.Extents[axis];
+		const float high = Box.Center[axis] + Box.Extents[axis];
+		if (std::abs(direction) < 1e-6f)
+		{
+			if (From[axis] < low || From[axis] > high)
+			{
+				return false;
+			}
+			continue;
+		}
+		float t0 = (low - From[axis]) / direction;
+		float t1 = (high - From[axis]) / direction;
+		if (t0 > t1)
+		{
+			std::swap(t0, t1);
+		}
+		enter = std::max(enter, t0);
+		exit = std::min(exit, t1);
+		if (enter > exit)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool IsHidden(const float Eye[3], const SBox& Box, const std::vector<const SBox*>& Occluders)
+{
+	for (int corner = 0; corner < 9; corner++)
+	{
+		float point[3];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const float sign = corner == 8 ? 0.0f : (corner >> axis & 1 ? 1.0f : -1.0f);
+			point[axis] = Box.Center[axis] + sign * Box.Extents[axis];
+		}
+		if (std::ranges::none_of(Occluders, [&](const SBox* Occluder) { return SegmentHitsBox(Eye, point, *Occluder); }))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool WriteDepth(const std::string& Path, const OSoftwareOcclusionCuller& Culler)
+{
+	FILE* file = std::fopen(Path.c_str(), "wb");
+	if (!file)
+	{
+		return false;
+	}
+	const auto& params = Culler.GetParams();
+	std::fprintf(file, "P5\n%u %u\n255\n", params.Width, params.Height);
+
+	// Perspective depth is squeezed towards 1, remap it to make the nearby occluders readable
+	std::vector<uint8_t> pixels;
+	pixels.reserve(Culler.GetDepth().size());
+	for (const float depth : Culler.GetDepth())
+	{
+		pixels.push_back(static_cast<uint8_t>(std::pow(std::min(std::max(depth, 0.0f), 1.0f), 64.0f) * 255.0f));
+	}
+	const bool bWritten = std::fwrite(pixels.data(), 1, pixels.size(), file) == pixels.size();
+	std::fclose(file);
+	return bWritten;
+}
+} // namespace
+
+CHECK_SUITE(Occlusion,
+            "Software occlusion culling of a city block scene, occluded props checked against ray casts",
+            "--frames <n> (default 100) --buildings <n> (12) --props <n> (10000) --width <n> (256) --height <n> (128) --dump <file.pgm>")
+{
+	const auto numFrames = static_cast<uint32_t>(Context.GetUInt("frames", Context.IsBenchmarking() ? 100 : 8));
+	const auto numBuildings = static_cast<uint32_t>(Context.GetUInt("buildings", 12));
+	const auto numProps = static_cast<uint32_t>(Context.GetUInt("props", 10000));
+	const auto dumpPath = Context.GetString("dump", "");
+	SOcclusionParams params;
+	params.Width = static_cast<uint32_t>(Context.GetUInt("width", params.Width));
+	params.Height = static_cast<uint32_t>(Context.GetUInt("height", params.Height));
+
+	const float spacing = 40.0f;
+	std::vector<SBox> buildings;
+	std::mt19937 random(42);
+	std::uniform_real_distribution height(10.0f, 60.0f);
+	for (uint32_t z = 0; z < numBuildings; z++)
+	{
+		for (uint32_t x = 0; x < numBuildings; x++)
+		{
+			const float h = height(random);
+			const float centerX = (static_cast<float>(x) - 0.5f * static_cast<float>(numBuildings)) * spacing;
+			const float centerZ = static_cast<float>(z + 1) * spacing;
+			buildings.push_back({ { centerX, h, centerZ }, { 15.0f, h, 15.0f } });
+		}
+	}
+
+	const float extent = 0.5f * static_cast<float>(numBuildings) * spacing;
+	std::uniform_real_distribution propX(-extent, extent);
+	std::uniform_real_distribution propZ(0.0f, 2.0f * extent);
+	std::vector<SBox> props;
+	for (uint32_t i = 0; i < numProps; i++)
+	{
+		props.push_back({ { propX(random), 1.0f, propZ(random) }, { 1.0f, 1.0f, 1.0f } });
+	}
+
+	std::vector<float> cubePositions;
+	std::vector<uint32_t> cubeIndices;
+	BuildCube(cubePositions, cubeIndices);
+
+	OSoftwareOcclusionCuller culler;
+	culler.SetParams(params);
+	const float eye[3] = { 0.0f, 2.0f, 0.0f };
+
+	// Without occluders nothing is hidden, a box around the eye crosses the near plane and is always visible
+	{
+		const auto viewProj = BuildViewProj(eye, 0.0f, static_cast<float>(params.Width) / params.Height);
+		culler.Clear();
+		culler.Finalize();
+		bool bVisible = true;
+		for (const auto& prop : props)
+		{
+			bVisible &= culler.IsVisible(viewProj, prop.Center, prop.Extents);
+		}
+		Context.Check(bVisible, "nothing is occluded by an empty depth buffer");
+	}
+
+	double totalRaster = 0.0;
+	double totalTest = 0.0;
+	double totalFrame = 0.0;
+	uint64_t totalOccluded = 0;
+	uint64_t totalTests = 0;
+	uint32_t totalOccluders = 0;
+	uint32_t numWrong = 0;
+	std::vector<bool> visible(props.size());
+	for (uint32_t frame = 0; frame < numFrames; frame++)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		const auto viewProj = BuildViewProj(eye, 0.3f * std::sin(static_cast<float>(frame) * 0.05f), static_cast<float>(params.Width) / params.Height);
+
+		// Same selection as the engine: the largest buildings on the screen become occluders
+		culler.Clear();
+		std::vector<std::pair<float, uint32_t>> candidates;
+		for (uint32_t i = 0; i < buildings.size(); i++)
+		{
+			const float area = culler.GetScreenArea(viewProj, buildings[i].Center, buildings[i].Extents);
+			if (area >= params.MinOccluderArea)
+			{
+				candidates.emplace_back(area, i);
+			}
+		}
+		std::ranges::sort(candidates, std::greater{});
+		std::vector<const SBox*> occluders;
+		for (uint32_t i = 0; i < candidates.size() && i < params.MaxOccluders; i++)
+		{
+			const auto& building = buildings[candidates[i].second];
+			occluders.push_back(&building);
+			SOcclusionMatrix world;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				world.M[axis][axis] = building.Extents[axis];
+				world.M[3][axis] = building.Center[axis];
+			}
+			world.M[3][3] = 1.0f;
+			culler.RasterizeOccluder(Multiply(world, viewProj), cubePositions.data(), 8, cubeIndices.data(), static_cast<uint32_t>(cubeIndices.size()));
+		}
+		culler.Finalize();
+
+		const auto testStart = std::chrono::steady_clock::now();
+		for (const auto& building : buildings)
+		{
+			culler.IsVisible(viewProj, building.Center, building.Extents);
+		}
+		for (size_t i = 0; i < props.size(); i++)
+		{
+			visible[i] = culler.IsVisible(viewProj, props[i].Center, props[i].Extents);
+		}
+
+		const auto end = std::chrono::steady_clock::now();
+		totalTest += std::chrono::duration<double, std::milli>(end - testStart).count();
+		totalFrame += std::chrono::duration<double, std::milli>(end - start).count();
+		const auto& stats = culler.GetStats();
+		totalRaster += stats.RasterMilliseconds;
+		totalOccluded += stats.NumOccluded;
+		totalTests += stats.NumTests;
+		totalOccluders += stats.NumOccluders;
+
+		// The reference is slow, a few frames are enough to catch a culler hiding visible props
+		if (frame < 8)
+		{
+			for (size_t i = 0; i < props.size(); i++)
+			{
+				numWrong += !visible[i] && !IsHidden(eye, props[i], occluders);
+			}
+		}
+	}
+
+	Context.Check(numWrong == 0, "occluded props are hidden by the occluders from the eye (" + std::to_string(numWrong) + " are not)");
+	Context.Check(numFrames == 0 || numBuildings < 4 || totalOccluded > 0, "the buildings hide some props");
+
+	if (!dumpPath.empty())
+	{
+		Context.Check(WriteDepth(dumpPath, culler), "the depth buffer is written to " + dumpPath);
+	}
+	if (!Context.IsBenchmarking() || numFrames == 0)
+	{
+		return;
+	}
+	const auto& resolution = culler.GetParams();
+	std::printf("%ux%u depth, %u frames, %.1f occluders per frame\n", resolution.Width, resolution.Height, numFrames, static_cast<double>(totalOccluders) / numFrames);
+	std::printf("Raster %.3f ms, tests %.3f ms, frame %.3f ms\n", totalRaster / numFrames, totalTest / numFrames, totalFrame / numFrames);
+	std::printf("Occluded %.1f%% of %llu tests\n", totalTests ? 100.0 * static_cast<double>(totalOccluded) / static_cast<double>(totalTests) : 0.0, static_cast<unsigned long long>(totalTests / numFrames));
+}
@@ -0,0 +1,158 @@
+#include "CheckFixtures.h"
+#include "CheckRegistry.h"
+#include "FrameProfiler.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Scope cost with the profiler off and on, followed by a few frames of nested scopes on several threads.
+ * The statistics and the exported trace are checked against what was recorded.
+ */
+
+namespace
+{
+double MeasureScopeNanoseconds(uint64_t NumScopes)
+{
+	const double nanoseconds = MeasureNanoseconds(NumScopes, []() { SProfileScope scope("OverheadScope"); });
+
+	// Keep the buffers from overflowing
+	OFrameProfiler::Get().EndFrame();
+	return nanoseconds;
+}
+
+void Work(uint32_t Iterations)
+{
+	for (uint32_t i = 0; i < Iterations; i++)
+	{
+		SProfileScope outer("Outer");
+		for (int j = 0; j < 2; j++)
+		{
+			SProfileScope inner("Inner");
+			volatile double sum = 0.0;
+			for (int k = 0; k < 2000; k++)
+			{
+				sum = sum + k * 0.5;
+			}
+		}
+	}
+}
+
+const SProfileScopeStats* Find(const std::vector<SProfileScopeStats>& Stats, const std::string& Name)
+{
+	for (const auto& stats : Stats)
+	{
+		if (stats.Name == Name)
+		{
+			return &stats;
+		}
+	}
+	return nullptr;
+}
+} // namespace
+
+CHECK_SUITE(Profiler,
+            "Frame profiler statistics and trace of nested scopes on several threads, scope overhead",
+            "--scopes <n> (default 1000000) --threads <n> (4) --trace <file.json>")
+{
+	const uint64_t numScopes = std::max<uint64_t>(Context.GetUInt("scopes", 1000000), 1);
+	const uint32_t numThreads = std::max(static_cast<uint32_t>(Context.GetUInt("threads", 4)), 1u);
+	const auto tracePath = Context.GetString("trace", "");
+
+	auto& profiler = OFrameProfiler::Get();
+	if (Context.IsBenchmarking())
+	{
+		const double disabled = MeasureScopeNanoseconds(numScopes);
+		profiler.SetEnabled(true);
+		const double enabled = MeasureScopeNanoseconds(std::min<uint64_t>(numScopes, 10000));
+		std::printf("Scope cost: %.2f ns disabled, %.2f ns enabled\n", disabled, enabled);
+	}
+	profiler.SetEnabled(true);
+
+	// Fresh threads every frame, like the std::async workers of the engine
+	constexpr uint32_t numFrames = 8;
+	constexpr uint32_t iterations = 50;
+	for (uint32_t frame = 0; frame < numFrames; frame++)
+	{
+		std::vector<std::thread> threads;
+		for (uint32_t thread = 1; thread < numThreads; thread++)
+		{
+			threads.emplace_back(Work, iterations);
+		}
+		{
+			SProfileScope scope("Sleep");
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+		profiler.BeginBlock(("Block " + std::to_string(frame % 2)).c_str());
+		Work(iterations);
+		profiler.EndBlock();
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+		profiler.AddGpuScope("GpuPass", OFrameProfiler::SteadyNanoseconds() - 500000, OFrameProfiler::SteadyNanoseconds());
+		profiler.EndFrame();
+	}
+
+	const auto stats = profiler.GetStats();
+	if (Context.IsBenchmarking())
+	{
+		std::printf("%-16s %10s %10s %10s %10s %8s\n", "Scope", "Last ms", "Min ms", "Avg ms", "P99 ms", "Calls");
+		for (const auto& scope : stats)
+		{
+			std::printf("%-16s %10.3f %10.3f %10.3f %10.3f %8u\n", scope.Name.c_str(), scope.LastMilliseconds, scope.MinMilliseconds, scope.AvgMilliseconds, scope.P99Milliseconds, scope.NumCalls);
+		}
+	}
+
+	const auto outer = Find(stats, "Outer");
+	const auto inner = Find(stats, "Inner");
+	const auto sleep = Find(stats, "Sleep");
+	const auto frame = Find(stats, "Frame");
+	const auto gpu = Find(stats, "GpuPass");
+	Context.Check(outer && outer->NumCalls == numThreads * iterations, "every Outer scope of every thread is recorded");
+	Context.Check(inner && inner->NumCalls == 2 * numThreads * iterations, "nested scopes are recorded");
+	Context.Check(outer && inner && inner->AvgMilliseconds <= outer->AvgMilliseconds, "nested scopes are shorter than their parents");
+	Context.Check(sleep && sleep->MinMilliseconds >= 1.5f && sleep->AvgMilliseconds < 50.0f, "the timebase matches the steady clock");
+	Context.Check(frame && frame->NumFrames == profiler.GetNumFrames() && frame->NumFrames >= numFrames, "one Frame entry per frame");
+	Context.Check(gpu && gpu->bGpu && gpu->AvgMilliseconds > 0.4f && gpu->AvgMilliseconds < 0.6f, "GPU scopes keep their duration");
+	Context.Check(Find(stats, "Block 0") && Find(stats, "Block 1"), "blocks with runtime names are recorded");
+	for (const auto& scope : stats)
+	{
+		Context.Check(scope.MinMilliseconds <= scope.AvgMilliseconds && scope.AvgMilliseconds <= scope.P99Milliseconds + 1e-6f, scope.Name + ": min <= avg <= p99");
+	}
+	Context.Check(profiler.GetNumDroppedEvents() == 0, "no events dropped");
+
+	const auto trace = profiler.ExportChromeTrace();
+	int depth = 0;
+	bool bBalanced = true;
+	bool bInString = false;
+	for (size_t i = 0; i < trace.size(); i++)
+	{
+		const char c = trace[i];
+		if (bInString)
+		{
+			i += c == '\\';
+			bInString = c != '"';
+			continue;
+		}
+		bInString = c == '"';
+		depth += (c == '{' || c == '[') - (c == '}' || c == ']');
+		bBalanced &= depth >= 0;
+	}
+	Context.Check(bBalanced && depth == 0 && trace.find("\"ph\":\"X\"") != std::string::npos, "the trace is well formed");
+
+	// Nothing is recorded while the profiler is off
+	profiler.SetEnabled(false);
+	const uint64_t framesBefore = profiler.GetNumFrames();
+	Work(1);
+	profiler.EndFrame();
+	Context.Check(profiler.GetNumFrames() == framesBefore, "disabled frames are not counted");
+
+	if (!tracePath.empty())
+	{
+		Context.Check(profiler.WriteChromeTrace(tracePath), "the trace is written to " + tracePath);
+	}
+}
@@ -0,0 +1,258 @@
+#include "CheckFixtures.h"
+#include "CheckRegistry.h"
+#include "Replay/ReplayLog.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/*
+ * OReplayWriter and OReplayReader on a log of input events, camera transforms, scene edits and debug draw commands.
+ * Every frame has to read back with the records in the order they were written and the payloads unchanged. A log cut
+ * inside a record or with a broken header, record type or size has to be rejected as a whole. The report is the log size
+ * and the time to write and read a long session.
+ */
+
+namespace
+{
+struct SExpectedRecord
+{
+	EReplayEvent Type;
+	std::vector<uint8_t> Payload;
+};
+
+template<typename T>
+SExpectedRecord MakeRecord(EReplayEvent Type, const T& Payload)
+{
+	const auto bytes = reinterpret_cast<const uint8_t*>(&Payload);
+	return { Type, std::vector<uint8_t>(bytes, bytes + sizeof(T)) };
+}
+
+// Frames with a varying number of events, one record of every type over the first frames
+std::vector<std::vector<SExpectedRecord>> MakeSession(uint32_t NumFrames)
+{
+	std::vector<std::vector<SExpectedRecord>> frames(NumFrames);
+	for (uint32_t frame = 0; frame < NumFrames; frame++)
+	{
+		auto& records = frames[frame];
+		if (frame == 0)
+		{
+			records.push_back(MakeRecord(EReplayEvent::Resize, SReplayResize{ 1920, 1080 }));
+		}
+		SReplayCamera camera;
+		camera.Position[0] = static_cast<float>(frame);
+		camera.Look[2] = 1.0f;
+		records.push_back(MakeRecord(EReplayEvent::Camera, camera));
+
+		SReplayKey key;
+		key.Key = 'W';
+		key.bPressed = frame % 2;
+		key.Modifiers = SReplayModifiers::Shift;
+		records.push_back(MakeRecord(EReplayEvent::Key, key));
+
+		for (uint32_t i = 0; i < frame % 4; i++)
+		{
+			SReplayMouse mouse;
+			mouse.X = static_cast<int32_t>(frame * 3 + i);
+			mouse.Y = -static_cast<int32_t>(i);
+			mouse.Buttons = 1;
+			records.push_back(MakeRecord(EReplayEvent::MouseMove, mouse));
+		}
+		if (frame % 5 == 1)
+		{
+			SReplayDebugBox box;
+			box.Center[1] = static_cast<float>(frame);
+			box.Extents[0] = box.Extents[1] = box.Extents[2] = 0.5f;
+			box.Orientation[3] = 1.0f;
+			box.Color[0] = box.Color[3] = 255;
+			box.Duration = 2.0f;
+			records.push_back(MakeRecord(EReplayEvent::DebugBox, box));
+
+			SReplayDebugFrustum frustum;
+			for (int i = 0; i < 4; i++)
+			{
+				frustum.InvViewProjection[i * 5] = 1.0f;
+			}
+			frustum.Color[1] = 255;
+			records.push_back(MakeRecord(EReplayEvent::DebugFrustum, frustum));
+		}
+	}
+	return frames;
+}
+
+// Edits carry the name before the state, the material edit is the only record with a name
+constexpr uint32_t EditFrame = 2;
+const std::string EditName = "bricks";
+constexpr float EditState[4] = { 0.25f, 0.5f, 0.75f, 1.0f };
+
+OReplayWriter WriteSession(const std::vector<std::vector<SExpectedRecord>>& Frames)
+{
+	OReplayWriter writer;
+	for (uint32_t frame = 0; frame < Frames.size(); frame++)
+	{
+		for (const auto& record : Frames[frame])
+		{
+			writer.Add(record.Type, record.Payload.data(), static_cast<uint32_t>(record.Payload.size()));
+		}
+		if (frame == EditFrame)
+		{
+			writer.AddEdit(EReplayEvent::Material, EditName, EditState, sizeof(EditState));
+		}
+		writer.CommitFrame(1.0f / 60.0f + static_cast<float>(frame) * 1.0e-4f);
+	}
+	return writer;
+}
+
+// Reads every frame back and compares it with what was written
+bool ReadsBack(OReplayReader& Reader, const std::vector<std::vector<SExpectedRecord>>& Frames)
+{
+	SReplayFrame frame;
+	std::vector<SReplayRecord> records;
+	for (uint32_t index = 0; index < Frames.size(); index++)
+	{
+		if (!Reader.NextFrame(frame, records) || frame.DeltaTime != 1.0f / 60.0f + static_cast<float>(index) * 1.0e-4f)
+		{
+			return false;
+		}
+		const auto& expected = Frames[index];
+		const size_t numEdits = index == EditFrame ? 1 : 0;
+		if (records.size() != expected.size() + numEdits)
+		{
+			return false;
+		}
+		for (size_t i = 0; i < expected.size(); i++)
+		{
+			const auto& record = records[i];
+			if (record.Type != expected[i].Type || record.Size != expected[i].Payload.size()
+			    || std::memcmp(record.Data, expected[i].Payload.data(), record.Size) != 0)
+			{
+				return false;
+			}
+		}
+		if (numEdits > 0)
+		{
+			std::string name;
+			const uint8_t* state = nullptr;
+			uint32_t size = 0;
+			const auto& edit = records.back();
+			if (edit.Type != EReplayEvent::Material || !edit.ReadEdit(name, state, size) || name != EditName || size != sizeof(EditState)
+			    || std::memcmp(state, EditState, size) != 0)
+			{
+				return false;
+			}
+		}
+	}
+	return !Reader.NextFrame(frame, records) && Reader.GetFrameIndex() == Frames.size();
+}
+} // namespace
+
+CHECK_SUITE(ReplayLog,
+            "Replay log write and read round trip, truncated and corrupt logs are rejected",
+            "--frames <n> (default 100000)")
+{
+	const auto frames = MakeSession(64);
+	auto writer = WriteSession(frames);
+	Context.Check(writer.GetNumFrames() == frames.size(), "the writer counts the committed frames");
+
+	OReplayReader reader;
+	Context.Check(reader.Open(writer.GetBytes()) && reader.GetNumFrames() == frames.size(), "the log opens with every frame");
+	Context.Check(ReadsBack(reader, frames), "every frame reads back with its records in order and unchanged");
+	reader.Rewind();
+	Context.Check(ReadsBack(reader, frames), "a rewound log reads back the same frames");
+
+	{
+		const OScratchDirectory scratch("ReplayLog");
+		const auto path = (scratch / "session.dxrl").string();
+		OReplayReader loaded;
+		Context.Check(writer.Save(path) && loaded.Load(path) && ReadsBack(loaded, frames), "a saved log loads back the same frames");
+		Context.Check(!loaded.Load((scratch / "missing.dxrl").string()), "a missing file does not load");
+	}
+
+	// A large payload needs a multi byte size
+	{
+		OReplayWriter large;
+		std::vector<uint8_t> payload(70000, 7);
+		large.Add(EReplayEvent::Material, payload.data(), static_cast<uint32_t>(payload.size()));
+		large.CommitFrame(0.0f);
+		OReplayReader largeReader;
+		SReplayFrame frame;
+		std::vector<SReplayRecord> records;
+		Context.Check(largeReader.Open(large.GetBytes()) && largeReader.NextFrame(frame, records) && records.size() == 1 && records[0].Size == payload.size(),
+		              "a payload over 16 KB keeps its size");
+	}
+
+	// Events after the last frame record belong to a frame that was never closed
+	{
+		auto open = WriteSession(frames);
+		open.Add(EReplayEvent::Key, SReplayKey{});
+		OReplayReader openReader;
+		Context.Check(openReader.Open(open.GetBytes()) && ReadsBack(openReader, frames), "events of an unclosed frame are not replayed");
+	}
+
+	SReplayKey key;
+	SReplayRecord wrongSize{ EReplayEvent::Key, writer.GetBytes().data(), sizeof(SReplayKey) - 1 };
+	Context.Check(!wrongSize.Read(key), "a payload of another size does not read as the record");
+	const uint8_t shortName[] = { 10, 0, 'a', 'b' };
+	SReplayRecord brokenEdit{ EReplayEvent::Material, shortName, sizeof(shortName) };
+	std::string name;
+	const uint8_t* state = nullptr;
+	uint32_t size = 0;
+	Context.Check(!brokenEdit.ReadEdit(name, state, size), "an edit whose name runs past the payload is rejected");
+
+	const auto& bytes = writer.GetBytes();
+	const size_t headerSize = 8;
+	bool bTruncatedValid = true;
+	for (size_t length = 0; length < bytes.size(); length++)
+	{
+		// Cut exactly between records the closed frames before the cut are still a valid log
+		OReplayReader truncated;
+		if (truncated.Open(std::vector<uint8_t>(bytes.begin(), bytes.begin() + length)))
+		{
+			const std::vector closed(frames.begin(), frames.begin() + truncated.GetNumFrames());
+			bTruncatedValid &= length >= headerSize && ReadsBack(truncated, closed);
+		}
+	}
+	Context.Check(bTruncatedValid, "a log cut at any point opens only with the frames closed before the cut");
+
+	OReplayReader cut;
+	SReplayFrame cutFrame;
+	std::vector<SReplayRecord> cutRecords;
+	Context.Check(!cut.Open(std::vector<uint8_t>(bytes.begin(), bytes.end() - 1)), "a log cut inside the last record is rejected");
+	Context.Check(cut.GetNumFrames() == 0 && !cut.NextFrame(cutFrame, cutRecords), "a rejected log has no frames");
+
+	auto corrupt = [&](size_t Offset, uint8_t Value) {
+		auto copy = bytes;
+		copy[Offset] = Value;
+		OReplayReader corruptReader;
+		return corruptReader.Open(std::move(copy));
+	};
+	Context.Check(!corrupt(0, 'X'), "a log with another magic is rejected");
+	Context.Check(!corrupt(4, 2), "a log of another version is rejected");
+	Context.Check(!corrupt(headerSize, static_cast<uint8_t>(EReplayEvent::Count)), "a record of an unknown type is rejected");
+	Context.Check(!corrupt(headerSize + 1, 0xff), "a record size running past the log is rejected");
+	OReplayReader empty;
+	Context.Check(!empty.Open({}), "an empty file is rejected");
+
+	if (!Context.IsBenchmarking())
+	{
+		return;
+	}
+	const auto numFrames = static_cast<uint32_t>(Context.GetUInt("frames", 100000));
+	const auto session = MakeSession(numFrames);
+	OReplayWriter longWriter;
+	const double writeMs = MeasureMilliseconds([&]() { longWriter = WriteSession(session); });
+	OReplayReader longReader;
+	SReplayFrame frame;
+	std::vector<SReplayRecord> records;
+	size_t numRecords = 0;
+	const double readMs = MeasureMilliseconds([&]() {
+		longReader.Open(longWriter.GetBytes());
+		while (longReader.NextFrame(frame, records))
+		{
+			numRecords += records.size();
+		}
+	});
+	std::printf("%u frames, %zu records, %.1f bytes per frame\n", numFrames, numRecords, static_cast<double>(longWriter.GetNumBytes()) / numFrames);
+	std::printf("Write %.2f ms, open and read %.2f ms\n", writeMs, readMs);
+}
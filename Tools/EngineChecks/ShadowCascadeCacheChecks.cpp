@@ -0,0 +1,245 @@
+#include "CheckFixtures.h"
+#include "CheckRegistry.h"
+#include "RenderTarget/CSM/ShadowCascadeCache.h"
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+
+/*
+ * Cascade cache keys against a reference in double precision: a cascade reused from the cache has to lie inside the
+ * padded square the cached layer was rendered with, in the look at basis of the light. Random camera walks count the
+ * rebuilds the padding saves.
+ */
+
+namespace
+{
+using SVec3 = std::array<double, 3>;
+
+SVec3 ToDouble(const std::array<float, 3>& V)
+{
+	return { V[0], V[1], V[2] };
+}
+
+double Dot(const SVec3& A, const SVec3& B)
+{
+	return A[0] * B[0] + A[1] * B[1] + A[2] * B[2];
+}
+
+SVec3 Normalize(const SVec3& A)
+{
+	const double length = std::sqrt(Dot(A, A));
+	return { A[0] / length, A[1] / length, A[2] / length };
+}
+
+// Axes of XMMatrixLookAtLH with the world up the light view is built with
+void LookAtAxes(const SVec3& Direction, SVec3& OutRight, SVec3& OutUp)
+{
+	const auto z = Normalize(Direction);
+	OutRight = Normalize({ z[2], 0.0, -z[0] });
+	OutUp = { z[1] * OutRight[2] - z[2] * OutRight[1], z[2] * OutRight[0] - z[0] * OutRight[2], z[0] * OutRight[1] - z[1] * OutRight[0] };
+}
+
+// The orthographic square of the new cascade fits into the square the cached layer was rendered with
+bool FitsCachedLayer(const SShadowCascadeKey& Cached, double PaddedRadius, const SShadowCascadeKey& Key)
+{
+	SVec3 right, up;
+	LookAtAxes(ToDouble(Cached.LightDirection), right, up);
+	const SVec3 delta = { double(Key.Center[0]) - Cached.Center[0], double(Key.Center[1]) - Cached.Center[1], double(Key.Center[2]) - Cached.Center[2] };
+	const double slack = PaddedRadius - Key.Radius;
+	return std::abs(Dot(delta, right)) <= slack && std::abs(Dot(delta, up)) <= slack;
+}
+
+std::array<float, 3> RandomDirection(std::mt19937& Random)
+{
+	// Away from the vertical, the look at basis of the light is undefined there
+	std::uniform_real_distribution angle(0.0f, 6.2831853f);
+	std::uniform_real_distribution height(-0.95f, -0.2f);
+	const float y = height(Random);
+	const float a = angle(Random);
+	const float horizontal = std::sqrt(1.0f - y * y);
+	return { horizontal * std::cos(a), y, horizontal * std::sin(a) };
+}
+
+struct SFailures
+{
+	uint32_t Count = 0;
+
+	void Fail(const std::string& Message)
+	{
+		if (Count++ < 10)
+		{
+			std::printf("  %s\n", Message.c_str());
+		}
+	}
+};
+} // namespace
+
+CHECK_SUITE(ShadowCascadeCache,
+            "Shadow cascade cache keys and invalidation against a padded square containment test, rebuilds of camera walks",
+            "--keys <n> (default 100000) --frames <n> (10000) --seed <n> (1)")
+{
+	const auto numKeys = static_cast<uint32_t>(Context.GetUInt("keys", Context.IsBenchmarking() ? 100000 : 20000));
+	const auto numFrames = static_cast<uint32_t>(Context.GetUInt("frames", Context.IsBenchmarking() ? 10000 : 2000));
+	std::mt19937 random(static_cast<uint32_t>(Context.GetUInt("seed", 1)));
+
+	SShadowCascadeCacheSettings settings;
+	settings.MapSize = 2048;
+	OShadowCascadeCache cache(3, settings);
+
+	SShadowCascadeKey key;
+	key.LightDirection = { 0.3f, -0.8f, 0.5f };
+	key.Center = { 10.0f, 2.0f, -5.0f };
+	key.Radius = 40.0f;
+	key.StaticGeneration = 7;
+
+	Context.Check(cache.Evaluate(0, key) == EShadowCacheInvalidation::Empty, "an empty cascade is rebuilt");
+	Context.Check(cache.Evaluate(3, key) == EShadowCacheInvalidation::Forced, "a cascade out of range is always rebuilt");
+	Context.Check(cache.NeedsRebuild(0, key) && cache.GetCascade(0).LastInvalidation == EShadowCacheInvalidation::Empty, "the empty cascade is recorded");
+
+	const float padded = cache.Commit(0, key);
+	const float texel = 2.0f * padded / static_cast<float>(settings.MapSize);
+	Context.Check(std::abs(padded - key.Radius - settings.TexelThreshold * texel) < 1e-3f, "the padding is the texel threshold in texels of the padded map");
+	Context.Check(cache.GetCascade(0).bValid && cache.GetCascade(0).NumRebuilds == 1 && cache.GetCascade(0).PaddedRadius == padded, "commit stores the key");
+	Context.Check(!cache.NeedsRebuild(0, key) && !cache.NeedsRebuild(0, key) && cache.GetCascade(0).NumHits == 2, "the same key hits twice");
+	Context.Check(cache.Evaluate(1, key) == EShadowCacheInvalidation::Empty, "cascades are cached apart");
+
+	auto changed = key;
+	changed.StaticGeneration++;
+	Context.Check(cache.Evaluate(0, changed) == EShadowCacheInvalidation::StaticCasters, "a static caster change rebuilds");
+
+	changed = key;
+	changed.LightDirection = { 0.3f, -0.8f, 0.52f };
+	Context.Check(cache.Evaluate(0, changed) == EShadowCacheInvalidation::LightDirection, "a light direction change rebuilds");
+	changed.LightDirection = { 0.6f, -1.6f, 1.0f };
+	Context.Check(cache.Evaluate(0, changed) == EShadowCacheInvalidation::None, "the light direction is compared normalized");
+
+	changed = key;
+	changed.Radius = key.Radius * 1.01f;
+	Context.Check(cache.Evaluate(0, changed) == EShadowCacheInvalidation::Radius, "a radius change rebuilds");
+	changed.Radius = key.Radius * 1.0001f;
+	Context.Check(cache.Evaluate(0, changed) == EShadowCacheInvalidation::None, "a radius change within the tolerance hits");
+
+	// Moving along the light is covered by the depth range, moving across it by the padding
+	changed = key;
+	const float along = 500.0f;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		changed.Center[axis] += along * key.LightDirection[axis] / std::sqrt(0.09f + 0.64f + 0.25f);
+	}
+	Context.Check(cache.Evaluate(0, changed) == EShadowCacheInvalidation::None, "moving along the light hits");
+
+	SVec3 right, up;
+	LookAtAxes(ToDouble(key.LightDirection), right, up);
+	for (const float texels : { 0.5f * settings.TexelThreshold, 1.5f * settings.TexelThreshold })
+	{
+		changed = key;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			changed.Center[axis] += static_cast<float>(right[axis]) * texels * texel;
+		}
+		const bool bMoved = texels > settings.TexelThreshold;
+		Context.Check(cache.Evaluate(0, changed) == (bMoved ? EShadowCacheInvalidation::Moved : EShadowCacheInvalidation::None),
+		              "moving " + std::to_string(texels) + " texels across the light " + (bMoved ? "rebuilds" : "hits"));
+		Context.Check(std::abs(cache.GetTexelDrift(0, changed.Center) - texels) < 0.01f, "the drift of " + std::to_string(texels) + " texels is measured");
+	}
+
+	changed = key;
+	changed.StaticGeneration++;
+	changed.Radius *= 2.0f;
+	Context.Check(cache.Evaluate(0, changed) == EShadowCacheInvalidation::StaticCasters, "static casters are reported before the other reasons");
+
+	cache.Commit(1, key);
+	cache.Invalidate(0);
+	Context.Check(cache.Evaluate(0, key) == EShadowCacheInvalidation::Empty && cache.Evaluate(1, key) == EShadowCacheInvalidation::None, "invalidate drops one cascade");
+	cache.InvalidateAll();
+	Context.Check(cache.Evaluate(1, key) == EShadowCacheInvalidation::Empty, "invalidate all drops every cascade");
+
+	// Random keys around a cached one, a hit has to fit the cached layer and a small move has to hit
+	SFailures unsafe;
+	SFailures needless;
+	std::uniform_real_distribution unit(-1.0f, 1.0f);
+	std::uniform_real_distribution radius(1.0f, 500.0f);
+	for (uint32_t i = 0; i < numKeys; i++)
+	{
+		SShadowCascadeKey cached;
+		cached.LightDirection = RandomDirection(random);
+		cached.Center = { 1000.0f * unit(random), 100.0f * unit(random), 1000.0f * unit(random) };
+		cached.Radius = radius(random);
+		cache.Invalidate(0);
+		const float cachedPadded = cache.Commit(0, cached);
+		const float cachedTexel = 2.0f * cachedPadded / static_cast<float>(settings.MapSize);
+
+		auto next = cached;
+		const float reach = 2.0f * settings.TexelThreshold * cachedTexel;
+		next.Center = { cached.Center[0] + reach * unit(random), cached.Center[1] + reach * unit(random), cached.Center[2] + reach * unit(random) };
+		if (i % 4 == 0)
+		{
+			next.Radius = cached.Radius * (1.0f + settings.RadiusTolerance * unit(random));
+		}
+
+		const auto reason = cache.Evaluate(0, next);
+		if (reason == EShadowCacheInvalidation::None && !FitsCachedLayer(cached, cachedPadded * (1.0 + 1e-5), next))
+		{
+			unsafe.Fail("key " + std::to_string(i) + " hits but leaves the cached layer");
+		}
+
+		// Well inside the threshold only the float error of the drift is left
+		SVec3 basisRight, basisUp;
+		LookAtAxes(ToDouble(cached.LightDirection), basisRight, basisUp);
+		const SVec3 delta = { double(next.Center[0]) - cached.Center[0], double(next.Center[1]) - cached.Center[1], double(next.Center[2]) - cached.Center[2] };
+		const double drift = std::max(std::abs(Dot(delta, basisRight)), std::abs(Dot(delta, basisUp))) / cachedTexel;
+		if (next.Radius == cached.Radius && drift < 0.99 * settings.TexelThreshold && reason != EShadowCacheInvalidation::None)
+		{
+			needless.Fail("key " + std::to_string(i) + " drifted " + std::to_string(drift) + " texels and was rebuilt for " + ToString(reason));
+		}
+	}
+	Context.Check(unsafe.Count == 0, "cached cascades cover the requested cascade (" + std::to_string(unsafe.Count) + " do not)");
+	Context.Check(needless.Count == 0, "cascades within the texel threshold are reused (" + std::to_string(needless.Count) + " are not)");
+
+	// Camera walks: the camera moves a little every frame and turns now and then
+	SFailures walkUnsafe;
+	uint32_t numRebuilds = 0;
+	OShadowCascadeCache walkCache(1, settings);
+	SShadowCascadeKey walk = key;
+	std::array<float, 3> velocity = { 0.05f, 0.0f, 0.02f };
+	for (uint32_t frame = 0; frame < numFrames; frame++)
+	{
+		if (frame % 250 == 0)
+		{
+			velocity = { 0.1f * unit(random), 0.01f * unit(random), 0.1f * unit(random) };
+		}
+		for (int axis = 0; axis < 3; axis++)
+		{
+			walk.Center[axis] += velocity[axis];
+		}
+		if (walkCache.NeedsRebuild(0, walk))
+		{
+			walkCache.Commit(0, walk);
+			numRebuilds++;
+		}
+		else if (!FitsCachedLayer(walkCache.GetCascade(0).Key, walkCache.GetCascade(0).PaddedRadius * (1.0 + 1e-5), walk))
+		{
+			walkUnsafe.Fail("frame " + std::to_string(frame) + " reuses a layer that does not cover the cascade");
+		}
+	}
+	Context.Check(walkUnsafe.Count == 0, "every reused frame of the walk is covered (" + std::to_string(walkUnsafe.Count) + " are not)");
+	Context.Check(numFrames < 100 || numRebuilds < numFrames / 4, "the walk rebuilds on fewer than a quarter of the frames (" + std::to_string(numRebuilds) + ")");
+	Context.Check(walkCache.GetCascade(0).NumRebuilds == numRebuilds && walkCache.GetCascade(0).NumHits == numFrames - numRebuilds, "hits and rebuilds are counted");
+
+	if (!Context.IsBenchmarking())
+	{
+		return;
+	}
+	std::printf("Walk of %u frames: %u rebuilds, %.1f%% of the frames reuse the cached layer\n",
+	            numFrames,
+	            numRebuilds,
+	            numFrames ? 100.0 * (numFrames - numRebuilds) / numFrames : 0.0);
+	const double nanoseconds = MeasureNanoseconds(numKeys, [&]() {
+		walk.Center[0] += 1e-4f;
+		walkCache.Evaluate(0, walk);
+	});
+	std::printf("Evaluate %.1f ns\n", nanoseconds);
+}
@@ -0,0 +1,271 @@
+#define STB_IMAGE_IMPLEMENTATION
+
+#include "CheckFixtures.h"
+#include "CheckRegistry.h"
+#include "TextureCooker/TextureCooker.h"
+
+#include <STB/stb_image.h>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+/*
+ * Mip chains, block sizes and the error of the BC1 and BC4 encoders against a reference decoder,
+ * then the cache of OTextureCooker on a TGA source. Times cooking a 1024x1024 texture per format.
+ */
+
+namespace
+{
+STextureImage MakeImage(uint32_t Width, uint32_t Height, uint32_t Seed)
+{
+	std::mt19937 random(Seed);
+	std::uniform_int_distribution noise(-6, 6);
+	STextureImage image;
+	image.Width = Width;
+	image.Height = Height;
+	image.Pixels.resize(static_cast<size_t>(Width) * Height * 4);
+	for (uint32_t y = 0; y < Height; y++)
+	{
+		for (uint32_t x = 0; x < Width; x++)
+		{
+			uint8_t* pixel = &image.Pixels[(static_cast<size_t>(y) * Width + x) * 4];
+			pixel[0] = static_cast<uint8_t>(std::clamp<int>(x * 255 / std::max(Width - 1, 1u) + noise(random), 0, 255));
+			pixel[1] = static_cast<uint8_t>(std::clamp<int>(y * 255 / std::max(Height - 1, 1u) + noise(random), 0, 255));
+			pixel[2] = static_cast<uint8_t>(128 + 100 * std::sin(0.1f * static_cast<float>(x + y)));
+			pixel[3] = 255;
+		}
+	}
+	return image;
+}
+
+void Decode565(uint16_t Color, int32_t (&OutColor)[3])
+{
+	OutColor[0] = ((Color >> 11) & 31) * 255 / 31;
+	OutColor[1] = ((Color >> 5) & 63) * 255 / 63;
+	OutColor[2] = (Color & 31) * 255 / 31;
+}
+
+// Reference decoders of the four color BC1 mode and the eight value BC4 mode
+void DecodeBC1Block(const uint8_t* Block, int32_t (&OutRgb)[16][3])
+{
+	const uint16_t color0 = Block[0] | Block[1] << 8;
+	const uint16_t color1 = Block[2] | Block[3] << 8;
+	int32_t palette[4][3];
+	Decode565(color0, palette[0]);
+	Decode565(color1, palette[1]);
+	for (int c = 0; c < 3; c++)
+	{
+		palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+		palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+	}
+	const uint32_t indices = Block[4] | Block[5] << 8 | Block[6] << 16 | static_cast<uint32_t>(Block[7]) << 24;
+	for (int i = 0; i < 16; i++)
+	{
+		const uint32_t index = color0 == color1 ? 0 : (indices >> (i * 2)) & 3;
+		std::copy(std::begin(palette[index]), std::end(palette[index]), OutRgb[i]);
+	}
+}
+
+void DecodeBC4Block(const uint8_t* Block, int32_t (&OutValues)[16])
+{
+	const int32_t high = Block[0];
+	const int32_t low = Block[1];
+	int32_t palette[8] = { high, low };
+	for (int32_t i = 2; i < 8; i++)
+	{
+		palette[i] = ((8 - i) * high + (i - 1) * low) / 7;
+	}
+	uint64_t indices = 0;
+	for (int i = 0; i < 6; i++)
+	{
+		indices |= static_cast<uint64_t>(Block[2 + i]) << (i * 8);
+	}
+	for (int i = 0; i < 16; i++)
+	{
+		OutValues[i] = high == low ? high : palette[(indices >> (i * 3)) & 7];
+	}
+}
+
+// Root mean square error per channel of the decoded texture, border blocks repeat the last texel as the encoder does
+double GetBC1Error(const STextureImage& Image, const SCookedMip& Mip)
+{
+	double sum = 0.0;
+	for (uint32_t by = 0; by < (Image.Height + 3) / 4; by++)
+	{
+		for (uint32_t bx = 0; bx < (Image.Width + 3) / 4; bx++)
+		{
+			int32_t rgb[16][3];
+			DecodeBC1Block(&Mip.Data[by * Mip.RowPitch + bx * 8], rgb);
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				const uint32_t x = std::min(bx * 4 + i % 4, Image.Width - 1);
+				const uint32_t y = std::min(by * 4 + i / 4, Image.Height - 1);
+				for (int c = 0; c < 3; c++)
+				{
+					const double delta = Image.Pixels[(static_cast<size_t>(y) * Image.Width + x) * 4 + c] - rgb[i][c];
+					sum += delta * delta;
+				}
+			}
+		}
+	}
+	return std::sqrt(sum / (static_cast<double>((Image.Width + 3) / 4 * ((Image.Height + 3) / 4)) * 48.0));
+}
+
+int32_t GetBC4MaxError(const STextureImage& Image, const SCookedMip& Mip)
+{
+	int32_t maxError = 0;
+	for (uint32_t by = 0; by < (Image.Height + 3) / 4; by++)
+	{
+		for (uint32_t bx = 0; bx < (Image.Width + 3) / 4; bx++)
+		{
+			int32_t values[16];
+			DecodeBC4Block(&Mip.Data[by * Mip.RowPitch + bx * 8], values);
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				const uint32_t x = std::min(bx * 4 + i % 4, Image.Width - 1);
+				const uint32_t y = std::min(by * 4 + i / 4, Image.Height - 1);
+				maxError = std::max(maxError, std::abs(Image.Pixels[(static_cast<size_t>(y) * Image.Width + x) * 4] - values[i]));
+			}
+		}
+	}
+	return maxError;
+}
+
+// Uncompressed 32 bit TGA with the origin at the top left
+bool WriteTGA(const std::filesystem::path& Path, const STextureImage& Image)
+{
+	uint8_t header[18] = {};
+	header[2] = 2;
+	header[12] = Image.Width & 0xff;
+	header[13] = Image.Width >> 8;
+	header[14] = Image.Height & 0xff;
+	header[15] = Image.Height >> 8;
+	header[16] = 32;
+	header[17] = 0x28;
+
+	std::vector<uint8_t> bgra = Image.Pixels;
+	for (size_t i = 0; i < bgra.size(); i += 4)
+	{
+		std::swap(bgra[i], bgra[i + 2]);
+	}
+	std::ofstream file(Path, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(bgra.data()), static_cast<std::streamsize>(bgra.size()));
+	return file.good();
+}
+} // namespace
+
+CHECK_SUITE(TextureCooker, "Mip chains, BCn block sizes and encoder error, the cook cache", "--size <n> (default 1024)")
+{
+	// Every level halves down to 1x1, a constant image stays constant through both filters
+	for (const auto filter : { EMipFilter::Box, EMipFilter::Kaiser })
+	{
+		SCookSettings settings;
+		settings.Filter = filter;
+		STextureImage flat;
+		flat.Width = 96;
+		flat.Height = 20;
+		flat.Pixels.assign(static_cast<size_t>(flat.Width) * flat.Height * 4, 0);
+		for (size_t i = 0; i < flat.Pixels.size(); i++)
+		{
+			flat.Pixels[i] = i % 4 == 3 ? 255 : 90;
+		}
+		const auto mips = TextureCooker::GenerateMips(flat, settings);
+		Context.Check(mips.size() == 7, "96x20 has 7 mips");
+		bool bSizes = true;
+		bool bConstant = true;
+		for (uint32_t level = 0; level < mips.size(); level++)
+		{
+			bSizes &= mips[level].Width == std::max(flat.Width >> level, 1u) && mips[level].Height == std::max(flat.Height >> level, 1u);
+			bSizes &= mips[level].Pixels.size() == static_cast<size_t>(mips[level].Width) * mips[level].Height * 4;
+			for (size_t i = 0; i < mips[level].Pixels.size(); i++)
+			{
+				bConstant &= std::abs(mips[level].Pixels[i] - flat.Pixels[i % 4]) <= 1;
+			}
+		}
+		Context.Check(bSizes, "mip sizes halve down to 1x1");
+		Context.Check(bConstant, filter == EMipFilter::Box ? "box filtering keeps a constant image" : "kaiser filtering keeps a constant image");
+
+		settings.bGenerateMips = false;
+		Context.Check(TextureCooker::GenerateMips(flat, settings).size() == 1, "no mips without mip generation");
+	}
+
+	// Partial blocks on the border are padded, the row pitch is whole blocks
+	const auto odd = MakeImage(10, 7, 1);
+	for (const auto format : { ECookedFormat::RGBA8, ECookedFormat::BC1, ECookedFormat::BC3, ECookedFormat::BC4, ECookedFormat::BC5, ECookedFormat::BC7 })
+	{
+		const auto mip = TextureCooker::Compress(odd, format, 1);
+		const uint32_t blockSize = GetBlockByteSize(format);
+		const size_t expected = blockSize == 0 ? odd.Pixels.size() : static_cast<size_t>(3 * blockSize) * 2;
+		Context.Check(mip.Data.size() == expected && mip.RowPitch == (blockSize == 0 ? 40 : 3 * blockSize), std::string(ToString(format)) + " block layout of a 10x7 image");
+	}
+
+	const auto image = MakeImage(128, 128, 2);
+	const auto bc1 = TextureCooker::Compress(image, ECookedFormat::BC1, 1);
+	const auto bc4 = TextureCooker::Compress(image, ECookedFormat::BC4, 1);
+	const double bc1Error = GetBC1Error(image, bc1);
+	const int32_t bc4Error = GetBC4MaxError(image, bc4);
+	Context.Check(bc1Error < 8.0, "BC1 error of a noisy gradient stays below 8");
+	Context.Check(bc4Error <= 10, "BC4 error of a noisy gradient stays within half a palette step");
+	Context.Check(TextureCooker::Compress(image, ECookedFormat::BC7, 8).Data == TextureCooker::Compress(image, ECookedFormat::BC7, 1).Data, "threads do not change the output");
+
+	uint8_t solid[64];
+	uint8_t block[8];
+	for (int i = 0; i < 64; i++)
+	{
+		solid[i] = i % 4 == 3 ? 255 : 200;
+	}
+	TextureCooker::EncodeBC1Block(solid, block);
+	int32_t rgb[16][3];
+	DecodeBC1Block(block, rgb);
+	Context.Check(std::abs(rgb[5][0] - 200) <= 4 && std::abs(rgb[5][1] - 200) <= 2, "a solid BC1 block is within the 565 quantization");
+
+	// Fallbacks of Cook: BC5 with alpha keeps it in BC7, a top level off the block grid stays uncompressed
+	SCookSettings normalSettings = GetCookSettingsForType("Normal");
+	auto withAlpha = MakeImage(16, 16, 3);
+	withAlpha.Pixels[3] = 10;
+	Context.Check(TextureCooker::Cook(withAlpha, normalSettings).Format == (normalSettings.Format == ECookedFormat::BC5 ? ECookedFormat::BC7 : normalSettings.Format), "BC5 with alpha is cooked as BC7");
+	Context.Check(TextureCooker::Cook(odd, SCookSettings{}).Format == ECookedFormat::RGBA8, "a 10x7 top level is not block compressed");
+
+	// The second cook of the same source and settings is a cache hit, other settings cook again
+	OScratchDirectory scratch("TextureCooker");
+	const auto source = scratch / "Gradient.tga";
+	Context.Check(WriteTGA(source, image), "the TGA source is written");
+	STextureImage loaded;
+	Context.Check(TextureCooker::LoadSourceImage(source, loaded) && loaded.Pixels == image.Pixels, "the TGA source loads back");
+
+	OTextureCooker cooker(scratch / "Cooked");
+	SCookSettings settings;
+	settings.Format = ECookedFormat::BC1;
+	const auto cooked = cooker.CookFile(source, settings);
+	const auto cached = cooker.CookFile(source, settings);
+	settings.Format = ECookedFormat::BC7;
+	const auto other = cooker.CookFile(source, settings);
+	const auto stats = cooker.GetStats();
+	Context.Check(!cooked.empty() && cooked == cached && other != cooked, "cache paths are keyed by the settings");
+	Context.Check(stats.NumCooked == 2 && stats.NumCacheHits == 1 && stats.NumFailed == 0, "the second cook is a cache hit");
+
+	std::error_code error;
+	settings.Format = ECookedFormat::BC1;
+	const auto expectedSize = 4 + 124 + 20 + TextureCooker::Cook(image, settings).GetByteSize();
+	Context.Check(std::filesystem::file_size(cooked, error) == expectedSize, "the cached DDS holds the headers and every mip");
+	Context.Check(cooker.CookFile(scratch / "Missing.tga", settings).empty() && cooker.GetStats().NumFailed == 1, "a missing source fails");
+
+	if (!Context.IsBenchmarking())
+	{
+		return;
+	}
+	const auto size = static_cast<uint32_t>(Context.GetUInt("size", 1024));
+	const auto large = MakeImage(size, size, 4);
+	std::printf("%ux%u with mips, BC1 error %.2f, BC4 max error %d\n", size, size, bc1Error, bc4Error);
+	std::printf("%-8s %10s %12s\n", "Format", "Cook ms", "Cooked MB");
+	for (const auto format : { ECookedFormat::RGBA8, ECookedFormat::BC1, ECookedFormat::BC4, ECookedFormat::BC5, ECookedFormat::BC7 })
+	{
+		SCookSettings cookSettings;
+		cookSettings.Format = format;
+		SCookedTexture texture;
+		const double milliseconds = MeasureMilliseconds([&]() { texture = TextureCooker::Cook(large, cookSettings); });
+		std::printf("%-8s %10.2f %12.2f\n", ToString(format), milliseconds, static_cast<double>(texture.GetByteSize()) / (1024.0 * 1024.0));
+	}
+}
@@ -0,0 +1,161 @@
+#include "CheckFixtures.h"
+#include "CheckRegistry.h"
+#include "SceneGraph/TransformHierarchy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * Deep, wide and random trees with a fraction of the nodes moved every frame.
+ * The hierarchy is compared against a full recomputation of every node, which is what copying the transforms every frame costs.
+ */
+
+namespace
+{
+SLocalTransform RandomLocal(std::mt19937& Random)
+{
+	std::uniform_real_distribution offset(-2.0f, 2.0f);
+	std::uniform_real_distribution angle(-3.14159265f, 3.14159265f);
+	std::uniform_real_distribution scale(0.9f, 1.1f);
+
+	SLocalTransform local;
+	const float half = 0.5f * angle(Random);
+	local.Position[0] = offset(Random);
+	local.Position[1] = offset(Random);
+	local.Position[2] = offset(Random);
+	local.Rotation[1] = std::sin(half);
+	local.Rotation[3] = std::cos(half);
+	local.Scale[0] = local.Scale[1] = local.Scale[2] = scale(Random);
+	return local;
+}
+
+// Straightforward double precision reference of the same composition
+void ComposeReference(const SLocalTransform& Local, const double Parent[4][4], double OutWorld[4][4])
+{
+	const double x = Local.Rotation[0], y = Local.Rotation[1], z = Local.Rotation[2], w = Local.Rotation[3];
+	const double local[4][3] = {
+		{ Local.Scale[0] * (1 - 2 * (y * y + z * z)), Local.Scale[0] * 2 * (x * y + z * w), Local.Scale[0] * 2 * (x * z - y * w) },
+		{ Local.Scale[1] * 2 * (x * y - z * w), Local.Scale[1] * (1 - 2 * (x * x + z * z)), Local.Scale[1] * 2 * (y * z + x * w) },
+		{ Local.Scale[2] * 2 * (x * z + y * w), Local.Scale[2] * 2 * (y * z - x * w), Local.Scale[2] * (1 - 2 * (x * x + y * y)) },
+		{ Local.Position[0], Local.Position[1], Local.Position[2] }
+	};
+	for (int row = 0; row < 4; row++)
+	{
+		for (int column = 0; column < 4; column++)
+		{
+			OutWorld[row][column] = local[row][0] * Parent[0][column] + local[row][1] * Parent[1][column] + local[row][2] * Parent[2][column] + (row == 3 ? Parent[3][column] : 0.0);
+		}
+	}
+}
+
+void RunShape(OCheckContext& Context, const std::string& Shape, uint32_t NumNodes, float DirtyFraction, uint32_t NumFrames)
+{
+	OTransformHierarchy hierarchy;
+	hierarchy.NumThreads = static_cast<uint32_t>(Context.GetUInt("threads", 0));
+
+	// Parents are always created before their children, the reference relies on it
+	std::mt19937 random(42);
+	std::vector<uint32_t> nodes;
+	std::vector<uint32_t> parentIndices;
+	std::vector<SLocalTransform> locals;
+	for (uint32_t i = 0; i < NumNodes; i++)
+	{
+		uint32_t parent = UINT32_MAX;
+		if (Shape == "deep")
+		{
+			// 16 chains
+			parent = i >= 16 ? i - 16 : UINT32_MAX;
+		}
+		else if (Shape == "wide")
+		{
+			parent = i > 0 ? 0 : UINT32_MAX;
+		}
+		else if (i > 0)
+		{
+			parent = std::uniform_int_distribution<uint32_t>(i > 64 ? i - 64 : 0, i - 1)(random);
+		}
+		locals.push_back(RandomLocal(random));
+		parentIndices.push_back(parent);
+		nodes.push_back(hierarchy.Add(parent == UINT32_MAX ? OTransformHierarchy::InvalidNode : nodes[parent], locals.back()));
+	}
+	hierarchy.Update();
+	const auto initial = hierarchy.GetStats();
+	hierarchy.Update();
+	Context.Check(hierarchy.GetStats().NumUpdated == 0, Shape + ": an update without moved nodes rebuilds nothing");
+
+	const auto numDirty = static_cast<uint32_t>(DirtyFraction * static_cast<float>(NumNodes));
+	std::uniform_int_distribution<uint32_t> pick(0, NumNodes - 1);
+	double hierarchyMilliseconds = 0.0;
+	double fullMilliseconds = 0.0;
+	uint64_t numUpdated = 0;
+	uint32_t numThreads = 0;
+	std::vector<double> reference(static_cast<size_t>(NumNodes) * 16);
+	for (uint32_t frame = 0; frame < std::max(NumFrames, 1u); frame++)
+	{
+		for (uint32_t i = 0; i < numDirty; i++)
+		{
+			const uint32_t index = pick(random);
+			locals[index] = RandomLocal(random);
+			hierarchy.SetLocal(nodes[index], locals[index]);
+		}
+		hierarchy.Update();
+		hierarchyMilliseconds += hierarchy.GetStats().Milliseconds;
+		numUpdated += hierarchy.GetStats().NumUpdated;
+		numThreads = std::max(numThreads, hierarchy.GetStats().NumThreads);
+
+		// Every node recomputed whether it moved or not
+		fullMilliseconds += MeasureMilliseconds([&]() {
+			for (uint32_t i = 0; i < NumNodes; i++)
+			{
+				static const double identity[4][4] = { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 } };
+				const auto* parent = parentIndices[i] == UINT32_MAX ? identity : reinterpret_cast<const double(*)[4]>(&reference[parentIndices[i] * 16]);
+				ComposeReference(locals[i], parent, reinterpret_cast<double(*)[4]>(&reference[i * 16]));
+			}
+		});
+	}
+
+	double maxError = 0.0;
+	for (uint32_t i = 0; i < NumNodes; i++)
+	{
+		const auto& world = hierarchy.GetWorld(nodes[i]);
+		for (int row = 0; row < 4; row++)
+		{
+			for (int column = 0; column < 4; column++)
+			{
+				maxError = std::max(maxError, std::abs(world.M[row][column] - reference[i * 16 + row * 4 + column]));
+			}
+		}
+	}
+
+	// Float accumulates along deep chains, anything above this is a wrong matrix rather than rounding
+	Context.Check(maxError < 1e-2 * std::max(1.0, static_cast<double>(initial.NumLevels)), Shape + ": world matrices match the reference (max difference " + std::to_string(maxError) + ")");
+	if (!Context.IsBenchmarking() || NumFrames == 0)
+	{
+		return;
+	}
+	std::printf("%s tree: %u nodes, %u levels, first update %.3f ms\n", Shape.c_str(), initial.NumNodes, initial.NumLevels, initial.Milliseconds);
+	std::printf("Hierarchy %.3f ms per frame, %.0f nodes rebuilt, up to %u threads\n", hierarchyMilliseconds / NumFrames, static_cast<double>(numUpdated) / NumFrames, numThreads);
+	std::printf("Full recompute %.3f ms per frame\n", fullMilliseconds / NumFrames);
+}
+} // namespace
+
+CHECK_SUITE(TransformHierarchy,
+            "Dirty world matrix rebuild of deep, wide and random trees against a full recomputation",
+            "--shape <deep|wide|random> (default all) --nodes <n> (100000) --dirty <0..1> (0.01) --frames <n> (100) --threads <n> (0 - all)")
+{
+	const auto numNodes = std::max(static_cast<uint32_t>(Context.GetUInt("nodes", Context.IsBenchmarking() ? 100000 : 5000)), 1u);
+	const float dirtyFraction = Context.GetFloat("dirty", 0.01f);
+	const auto numFrames = static_cast<uint32_t>(Context.GetUInt("frames", Context.IsBenchmarking() ? 100 : 4));
+	const auto shape = Context.GetString("shape", "");
+	for (const char* name : { "deep", "wide", "random" })
+	{
+		if (shape.empty() || shape == name)
+		{
+			RunShape(Context, name, numNodes, dirtyFraction, numFrames);
+		}
+	}
+}
@@ -0,0 +1,213 @@
+#include "CheckFixtures.h"
+#include "CheckRegistry.h"
+#include "TransientPlanner.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * OTransientPlanner on the post process targets of the engine and on random render graphs. Fails when two resources alive
+ * in the same pass share bytes, a placement is misaligned or leaves its heap, categories mix in one heap or the aliased
+ * flags are wrong. Reports the memory of committed targets against the aliased heaps.
+ */
+
+namespace
+{
+constexpr uint64_t MaxHeapSize = 256ull << 20;
+constexpr uint64_t TextureAlignment = 64ull << 10;
+
+struct SSettings
+{
+	uint32_t Graphs = 2000;
+	uint32_t Resources = 48;
+	uint32_t Seed = 1;
+};
+
+struct SFailures
+{
+	uint32_t Count = 0;
+
+	void Fail(const char* Message, uint64_t Value)
+	{
+		if (Count++ < 10)
+		{
+			std::printf("  FAILED: %s (%ju)\n", Message, static_cast<uintmax_t>(Value));
+		}
+	}
+};
+
+uint64_t AlignUp(uint64_t Value, uint64_t Alignment)
+{
+	return (Value + Alignment - 1) / Alignment * Alignment;
+}
+
+void Validate(const OTransientPlanner& Planner, const std::vector<STransientRequest>& Requests, SFailures& Failures)
+{
+	const auto& placements = Planner.GetPlacements();
+	const auto& heaps = Planner.GetHeaps();
+	if (placements.size() != Requests.size())
+	{
+		Failures.Fail("placement count", placements.size());
+		return;
+	}
+
+	uint64_t heapBytes = 0;
+	for (const auto& heap : heaps)
+	{
+		heapBytes += heap.Size;
+	}
+	if (heapBytes != Planner.GetHeapBytes() || heapBytes < Planner.GetPeakLiveBytes())
+	{
+		Failures.Fail("heap bytes", heapBytes);
+	}
+
+	for (size_t a = 0; a < Requests.size(); a++)
+	{
+		const auto& placement = placements[a];
+		if (placement.Heap >= heaps.size())
+		{
+			Failures.Fail("heap out of range", a);
+			continue;
+		}
+		if (placement.Offset % Requests[a].Alignment != 0)
+		{
+			Failures.Fail("misaligned placement", placement.Offset);
+		}
+		if (placement.Offset + Requests[a].Size > heaps[placement.Heap].Size)
+		{
+			Failures.Fail("placement leaves its heap", a);
+		}
+		if (heaps[placement.Heap].Category != Requests[a].Category)
+		{
+			Failures.Fail("categories mixed in one heap", a);
+		}
+
+		bool bShares = false;
+		for (size_t b = 0; b < Requests.size(); b++)
+		{
+			if (a == b || placements[b].Heap != placement.Heap)
+			{
+				continue;
+			}
+			const bool bBytesOverlap = placement.Offset < placements[b].Offset + Requests[b].Size && placements[b].Offset < placement.Offset + Requests[a].Size;
+			if (bBytesOverlap && OTransientPlanner::LifetimesOverlap(Requests[a], Requests[b]))
+			{
+				Failures.Fail("resources alive at once share bytes", a);
+			}
+			bShares |= bBytesOverlap;
+		}
+		if (bShares != placement.bAliased)
+		{
+			Failures.Fail("aliased flag", a);
+		}
+	}
+}
+
+void RunEngineTargets(OCheckContext& Context)
+{
+	// Blur, bilateral blur and Sobel filter targets, one RGBA8 UAV texture each, in the passes the post process node gives them
+	struct SFilter
+	{
+		const char* Name;
+		uint32_t NumTargets;
+	};
+	const SFilter filters[] = { { "Blur", 3 }, { "BilateralBlur", 2 }, { "Sobel", 2 } };
+
+	for (const auto& [width, height] : { std::pair{ 1920ull, 1080ull }, std::pair{ 3840ull, 2160ull } })
+	{
+		std::vector<STransientRequest> requests;
+		for (uint32_t pass = 0; pass < std::size(filters); pass++)
+		{
+			for (uint32_t target = 0; target < filters[pass].NumTargets; target++)
+			{
+				requests.push_back({ AlignUp(width * height * 4, TextureAlignment), TextureAlignment, 1, pass, pass });
+			}
+		}
+
+		OTransientPlanner planner(MaxHeapSize);
+		planner.Plan(requests);
+		SFailures failures;
+		Validate(planner, requests, failures);
+		const auto resolution = std::to_string(width) + "x" + std::to_string(height);
+		Context.Check(failures.Count == 0, "post process targets " + resolution + " are placed without overlaps");
+		Context.Check(planner.GetHeapBytes() < planner.GetCommittedBytes(), "post process targets " + resolution + " of different passes share memory");
+		if (!Context.IsBenchmarking())
+		{
+			continue;
+		}
+		std::printf("Post process targets %jux%ju: committed %.1f MB, aliased %.1f MB in %zu heaps\n",
+		            static_cast<uintmax_t>(width),
+		            static_cast<uintmax_t>(height),
+		            planner.GetCommittedBytes() / 1048576.0,
+		            planner.GetHeapBytes() / 1048576.0,
+		            planner.GetHeaps().size());
+	}
+}
+
+std::vector<STransientRequest> RandomGraph(std::mt19937& Random, uint32_t NumResources)
+{
+	const uint32_t numPasses = 4 + Random() % 28;
+	std::vector<STransientRequest> requests(NumResources);
+	for (auto& request : requests)
+	{
+		request.Alignment = Random() % 8 == 0 ? 4ull << 20 : TextureAlignment;
+		request.Size = AlignUp(TextureAlignment + Random() % (48ull << 20), request.Alignment);
+		request.Category = Random() % 3;
+		request.FirstPass = Random() % numPasses;
+		request.LastPass = Random() % 16 == 0 ? UINT32_MAX : std::min(numPasses - 1, request.FirstPass + static_cast<uint32_t>(Random() % 6));
+	}
+	return requests;
+}
+
+void RunRandomGraphs(OCheckContext& Context, const SSettings& Settings)
+{
+	SFailures failures;
+	std::mt19937 random(Settings.Seed);
+	OTransientPlanner planner(MaxHeapSize);
+	uint64_t committed = 0;
+	uint64_t aliased = 0;
+	uint64_t peak = 0;
+	double nanoseconds = 0;
+
+	for (uint32_t graph = 0; graph < Settings.Graphs; graph++)
+	{
+		const auto requests = RandomGraph(random, Settings.Resources);
+		nanoseconds += MeasureNanoseconds(1, [&]() { planner.Plan(requests); });
+
+		Validate(planner, requests, failures);
+		committed += planner.GetCommittedBytes();
+		aliased += planner.GetHeapBytes();
+		peak += planner.GetPeakLiveBytes();
+	}
+	Context.Check(failures.Count == 0, std::to_string(Settings.Graphs) + " random graphs are placed without overlaps, in aligned, unmixed heaps");
+	if (!Context.IsBenchmarking())
+	{
+		return;
+	}
+
+	std::printf("Random graphs: %u graphs of %u resources, committed %.1f MB, aliased %.1f MB, alive at peak %.1f MB on average\n",
+	            Settings.Graphs,
+	            Settings.Resources,
+	            committed / 1048576.0 / Settings.Graphs,
+	            aliased / 1048576.0 / Settings.Graphs,
+	            peak / 1048576.0 / Settings.Graphs);
+	std::printf("Plan: %.1f us per graph\n", nanoseconds / 1000.0 / Settings.Graphs);
+}
+} // namespace
+
+CHECK_SUITE(TransientAliasing,
+            "Transient resource placement of the post process targets and random render graphs, committed against aliased memory",
+            "--graphs <n> (default 2000) --resources <n> (48) --seed <n> (1)")
+{
+	SSettings settings;
+	settings.Graphs = static_cast<uint32_t>(std::max<uint64_t>(Context.GetUInt("graphs", settings.Graphs), 1));
+	settings.Resources = static_cast<uint32_t>(std::max<uint64_t>(Context.GetUInt("resources", settings.Resources), 1));
+	settings.Seed = static_cast<uint32_t>(std::max<uint64_t>(Context.GetUInt("seed", settings.Seed), 1));
+
+	RunEngineTargets(Context);
+	RunRandomGraphs(Context, settings);
+}
@@ -0,0 +1,195 @@
+#include "CheckFixtures.h"
+#include "CheckRegistry.h"
+#include "UploadBuffer/UploadRing.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * OUploadRing against a fake GPU that completes command lists a few submissions late. Streams mesh and texture sized uploads
+ * and fails when an allocation is misaligned, leaves the ring, overlaps bytes still in flight or a ticket completes before
+ * its fence. Reports the staging memory the ring needs against the per upload buffers that used to stay alive.
+ */
+
+namespace
+{
+struct SSettings
+{
+	uint32_t Submits = 20000;
+	uint64_t RingSize = 64ull << 20;
+	uint32_t Latency = 3;
+	uint32_t Seed = 1;
+};
+
+struct SLiveRange
+{
+	uint64_t End;
+	uint64_t Batch;
+};
+
+// Sizes of a streaming scene: small meshes, a few large meshes and block compressed textures with mips
+uint64_t RandomUploadSize(std::mt19937& Random, uint64_t& OutAlignment)
+{
+	const uint32_t kind = Random() % 100;
+	if (kind < 60)
+	{
+		OutAlignment = 16;
+		return 1024 + Random() % (256 << 10);
+	}
+	if (kind < 70)
+	{
+		OutAlignment = 16;
+		return (1 << 20) + Random() % (8 << 20);
+	}
+	OutAlignment = 512;
+	const uint64_t side = 256ull << (Random() % 4);
+	return side * side * 4 / 3;
+}
+
+void RunSimulation(OCheckContext& Context, const SSettings& Settings)
+{
+	uint32_t numErrors = 0;
+	auto fail = [&](const char* Message, uint64_t Value) {
+		if (numErrors++ < 10)
+		{
+			std::printf("  FAILED: %s (%ju)\n", Message, static_cast<uintmax_t>(Value));
+		}
+	};
+
+	OUploadRing ring;
+	ring.Init(Settings.RingSize);
+
+	std::mt19937 random(Settings.Seed);
+	std::map<uint64_t, SLiveRange> live;
+	std::vector<std::pair<uint64_t, uint64_t>> fences;
+	uint64_t completedFence = 0;
+	uint64_t numUploads = 0;
+	uint64_t numDedicated = 0;
+	uint64_t uploadedBytes = 0;
+	uint64_t dedicatedBytes = 0;
+	uint64_t peakUsed = 0;
+
+	for (uint64_t fence = 1; fence <= Settings.Submits; fence++)
+	{
+		if (fence > Settings.Latency)
+		{
+			completedFence = fence - Settings.Latency;
+		}
+		ring.Retire(completedFence);
+
+		// Tickets complete exactly when the fence of their batch does
+		for (const auto& [batch, batchFence] : fences)
+		{
+			if (ring.IsComplete({ batch }) != (batchFence <= completedFence))
+			{
+				fail("ticket state does not follow its fence", batch);
+			}
+		}
+		std::erase_if(fences, [&](const auto& Entry) { return Entry.second <= completedFence; });
+		std::erase_if(live, [&](const auto& Entry) { return ring.IsComplete({ Entry.second.Batch }); });
+
+		const uint32_t numUploadsInList = random() % 12;
+		for (uint32_t upload = 0; upload < numUploadsInList; upload++)
+		{
+			uint64_t alignment = 16;
+			const uint64_t size = RandomUploadSize(random, alignment);
+			const uint64_t offset = ring.Allocate(size, alignment);
+			uploadedBytes += size;
+			numUploads++;
+			if (offset == OUploadRing::InvalidOffset)
+			{
+				// The manager waits for the oldest list or falls back to a dedicated buffer
+				numDedicated++;
+				dedicatedBytes += size;
+				continue;
+			}
+
+			if (offset % alignment != 0)
+			{
+				fail("misaligned allocation", offset);
+			}
+			if (offset + size > Settings.RingSize)
+			{
+				fail("allocation leaves the ring", offset);
+			}
+			const auto next = live.lower_bound(offset);
+			if (next != live.end() && next->first < offset + size)
+			{
+				fail("overlaps bytes in flight", offset);
+			}
+			if (next != live.begin() && std::prev(next)->second.End > offset)
+			{
+				fail("overlaps bytes in flight", offset);
+			}
+			live[offset] = { offset + size, ring.GetOpenTicket().Batch };
+		}
+
+		peakUsed = std::max(peakUsed, ring.GetUsed());
+		const auto ticket = ring.GetOpenTicket();
+		ring.Submit(fence);
+		if (!ring.IsSubmitted(ticket) || ring.GetFence(ticket) != fence)
+		{
+			fail("submitted ticket lost its fence", ticket.Batch);
+		}
+		fences.emplace_back(ticket.Batch, fence);
+	}
+
+	ring.Retire(Settings.Submits);
+	Context.Check(numErrors == 0, "no misaligned, overlapping or out of ring allocation and tickets follow their fences in " + std::to_string(Settings.Submits) + " command lists");
+	Context.Check(ring.GetUsed() == 0 && ring.GetNumInFlight() == 0, "no staging bytes leak once the GPU drains");
+	if (!Context.IsBenchmarking())
+	{
+		return;
+	}
+	std::printf("Simulated %u command lists, %u in flight, %ju MB ring\n", Settings.Submits, Settings.Latency, static_cast<uintmax_t>(Settings.RingSize >> 20));
+	std::printf("  %ju uploads, %.1f MB staged, %ju dedicated fallbacks (%.1f MB)\n",
+	            static_cast<uintmax_t>(numUploads),
+	            uploadedBytes / 1048576.0,
+	            static_cast<uintmax_t>(numDedicated),
+	            dedicatedBytes / 1048576.0);
+	std::printf("  Staging memory: ring peak %.1f MB, kept alive by per upload buffers %.1f MB\n", peakUsed / 1048576.0, uploadedBytes / 1048576.0);
+}
+
+void MeasureAllocate(uint32_t Seed)
+{
+	OUploadRing ring;
+	ring.Init(64ull << 20);
+	std::mt19937 random(Seed);
+
+	constexpr uint32_t numAllocations = 4000000;
+	uint64_t fence = 0;
+	uint32_t allocation = 0;
+	uint64_t checksum = 0;
+	const double nanoseconds = MeasureNanoseconds(numAllocations, [&]() {
+		checksum += ring.Allocate(256 + (random() & 4095), allocation & 1 ? 16 : 512);
+		if (allocation++ % 32 == 31)
+		{
+			ring.Submit(++fence);
+			ring.Retire(fence > 3 ? fence - 3 : 0);
+		}
+	});
+	std::printf("Allocate: %.1f ns per upload (checksum %ju)\n", nanoseconds, static_cast<uintmax_t>(checksum % 1000));
+}
+} // namespace
+
+CHECK_SUITE(UploadRing,
+            "Upload ring against a fake GPU fence with streaming sized uploads, staging memory and allocation cost",
+            "--submits <n> (default 20000) --ring <MB> (64) --latency <n> (3) --seed <n> (1)")
+{
+	SSettings settings;
+	settings.Submits = static_cast<uint32_t>(std::max<uint64_t>(Context.GetUInt("submits", settings.Submits), 1));
+	settings.RingSize = std::max<uint64_t>(Context.GetUInt("ring", settings.RingSize >> 20), 1) << 20;
+	settings.Latency = static_cast<uint32_t>(std::max<uint64_t>(Context.GetUInt("latency", settings.Latency), 1));
+	settings.Seed = static_cast<uint32_t>(std::max<uint64_t>(Context.GetUInt("seed", settings.Seed), 1));
+
+	RunSimulation(Context, settings);
+	if (Context.IsBenchmarking())
+	{
+		MeasureAllocate(settings.Seed);
+	}
+}
@@ -0,0 +1,286 @@
+#include "CheckFixtures.h"
+#include "CheckRegistry.h"
+#include "Wave/Waves.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * OWaves against the scalar array of structures solver it replaced, step by step on odd grid sizes with small tiles.
+ * Fails when heights, normals or tangents drift from the reference, when the thread count changes the result or when
+ * the fixed time step accumulator does not step, bound or separate instances as expected. Then times one step with
+ * normals on square grids for the reference, one thread and all threads.
+ */
+
+namespace
+{
+constexpr float SpatialStep = 0.25f;
+constexpr float TimeStep = 0.03f;
+constexpr float Speed = 3.25f;
+constexpr float Damping = 0.4f;
+
+// The solver as it was before the structure of arrays rewrite, without the shared timer
+class OReferenceWaves
+{
+public:
+	struct SFloat3
+	{
+		float X, Y, Z;
+	};
+
+	OReferenceWaves(int32_t M, int32_t N, float Dx, float Dt, float InSpeed, float InDamping)
+	    : NumRows(M), NumCols(N), SpatialStep(Dx)
+	{
+		float d = InDamping * Dt + 2.0f;
+		float e = (InSpeed * InSpeed) * (Dt * Dt) / (Dx * Dx);
+		K1 = (InDamping * Dt - 2.0f) / d;
+		K2 = (4.0f - 8.0f * e) / d;
+		K3 = (2.0f * e) / d;
+
+		const float halfWidth = (N - 1) * Dx * 0.5f;
+		const float halfDepth = (M - 1) * Dx * 0.5f;
+		for (int32_t i = 0; i < M; i++)
+		{
+			for (int32_t j = 0; j < N; j++)
+			{
+				Prev.push_back({ -halfWidth + j * Dx, 0.0f, halfDepth - i * Dx });
+				Normals.push_back({ 0.0f, 1.0f, 0.0f });
+				TangentX.push_back({ 1.0f, 0.0f, 0.0f });
+			}
+		}
+		Current = Prev;
+	}
+
+	void Step()
+	{
+		for (int32_t i = 1; i < NumRows - 1; i++)
+		{
+			for (int32_t j = 1; j < NumCols - 1; ++j)
+			{
+				Prev[i * NumCols + j].Y = K1 * Prev[i * NumCols + j].Y + K2 * Current[i * NumCols + j].Y + K3 * (Current[(i + 1) * NumCols + j].Y + Current[(i - 1) * NumCols + j].Y + Current[i * NumCols + j + 1].Y + Current[i * NumCols + j - 1].Y);
+			}
+		}
+		std::swap(Prev, Current);
+
+		for (int32_t i = 1; i < NumRows - 1; i++)
+		{
+			for (int32_t j = 1; j < NumCols - 1; ++j)
+			{
+				const float l = Current[i * NumCols + j - 1].Y;
+				const float r = Current[i * NumCols + j + 1].Y;
+				const float t = Current[(i - 1) * NumCols + j].Y;
+				const float b = Current[(i + 1) * NumCols + j].Y;
+				Normals[i * NumCols + j] = Normalize({ -r + l, 2.0f * SpatialStep, b - t });
+				TangentX[i * NumCols + j] = Normalize({ 2.0f * SpatialStep, r - l, 0.0f });
+			}
+		}
+	}
+
+	void Disturb(int32_t I, int32_t J, float Magnitude, float Radius = 50)
+	{
+		Current[I * NumCols + J].Y += Magnitude;
+		float halfMag = Magnitude;
+		for (int i = 1; i < Radius; ++i)
+		{
+			halfMag *= 0.7;
+			for (const int32_t idx : { I * NumCols + J + i, I * NumCols + J - i, (I + i) * NumCols + J, (I - i) * NumCols + J })
+			{
+				if (idx > 0 && idx < static_cast<int32_t>(Current.size()))
+				{
+					Current[idx].Y += halfMag;
+				}
+			}
+		}
+	}
+
+	static SFloat3 Normalize(SFloat3 V)
+	{
+		const float length = std::sqrt(V.X * V.X + V.Y * V.Y + V.Z * V.Z);
+		return { V.X / length, V.Y / length, V.Z / length };
+	}
+
+	int32_t NumRows;
+	int32_t NumCols;
+	float SpatialStep;
+	float K1, K2, K3;
+	std::vector<SFloat3> Prev;
+	std::vector<SFloat3> Current;
+	std::vector<SFloat3> Normals;
+	std::vector<SFloat3> TangentX;
+};
+
+bool Near(float A, float B, float Tolerance)
+{
+	return std::abs(A - B) <= Tolerance * std::max(1.0f, std::abs(B));
+}
+
+// Largest differences from the reference, grid positions only have to match
+struct SDifference
+{
+	bool bGridMatches = true;
+	double Height = 0.0;
+	double Vector = 0.0;
+};
+
+void Compare(const OWaves& Waves, const OReferenceWaves& Reference, SDifference& Difference)
+{
+	for (int32_t idx = 0; idx < Waves.GetVertexCount(); idx++)
+	{
+		const auto position = Waves.GetPosition(idx);
+		const auto normal = Waves.GetNormal(idx);
+		const auto tangent = Waves.GetTangentX(idx);
+		const auto& expected = Reference.Current[idx];
+		const auto& expectedNormal = Reference.Normals[idx];
+		const auto& expectedTangent = Reference.TangentX[idx];
+		Difference.bGridMatches &= Near(position[0], expected.X, 1e-6f) && Near(position[2], expected.Z, 1e-6f);
+		Difference.Height = std::max(Difference.Height, static_cast<double>(std::abs(position[1] - expected.Y)));
+		for (const float error : { normal[0] - expectedNormal.X, normal[1] - expectedNormal.Y, normal[2] - expectedNormal.Z, tangent[0] - expectedTangent.X, tangent[1] - expectedTangent.Y, tangent[2] - expectedTangent.Z })
+		{
+			Difference.Vector = std::max(Difference.Vector, static_cast<double>(std::abs(error)));
+		}
+	}
+}
+
+void RunRegression(OCheckContext& Context)
+{
+	// Odd sizes leave scalar tails after the SIMD lanes, small tiles put many rows on tile edges
+	for (const uint32_t threads : { 1u, 4u })
+	{
+		OWaves waves(83, 131, SpatialStep, TimeStep, Speed, Damping);
+		OReferenceWaves reference(83, 131, SpatialStep, TimeStep, Speed, Damping);
+		waves.NumThreads = threads;
+		waves.MinRowsPerThread = 1;
+		waves.RowsPerTile = 7;
+
+		SDifference difference;
+		bool bSteppedOnce = true;
+		for (uint32_t step = 0; step < 400; step++)
+		{
+			if (step % 40 == 0)
+			{
+				const int32_t i = 2 + static_cast<int32_t>(step * 7) % 79;
+				const int32_t j = 2 + static_cast<int32_t>(step * 13) % 127;
+				waves.Disturb(i, j, 0.5f, 8);
+				reference.Disturb(i, j, 0.5f, 8);
+			}
+
+			waves.Update(TimeStep);
+			reference.Step();
+			bSteppedOnce &= waves.GetStats().NumSteps == 1;
+			if (step % 50 == 49)
+			{
+				Compare(waves, reference, difference);
+			}
+		}
+
+		const auto name = "83x131 on " + std::to_string(threads) + " threads: ";
+		Context.Check(bSteppedOnce, name + "one time step steps once");
+		Context.Check(difference.bGridMatches, name + "grid positions match the scalar solver");
+		Context.Check(difference.Height <= 1e-5, name + "heights match the scalar solver (" + std::to_string(difference.Height) + ")");
+		Context.Check(difference.Vector <= 1e-5, name + "normals and tangents match the scalar solver (" + std::to_string(difference.Vector) + ")");
+	}
+}
+
+void RunThreadDeterminism(OCheckContext& Context)
+{
+	OWaves single(127, 200, SpatialStep, TimeStep, Speed, Damping);
+	OWaves threaded(127, 200, SpatialStep, TimeStep, Speed, Damping);
+	single.NumThreads = 1;
+	threaded.NumThreads = 8;
+	threaded.MinRowsPerThread = 1;
+	threaded.RowsPerTile = 5;
+	for (auto* waves : { &single, &threaded })
+	{
+		waves->Disturb(60, 100, 1.0f);
+		waves->Disturb(20, 30, -0.5f, 10);
+		for (uint32_t step = 0; step < 100; step++)
+		{
+			waves->Update(TimeStep);
+		}
+	}
+
+	bool bSame = true;
+	for (int32_t idx = 0; idx < single.GetVertexCount() && bSame; idx++)
+	{
+		bSame = single.GetPosition(idx) == threaded.GetPosition(idx) && single.GetNormal(idx) == threaded.GetNormal(idx) && single.GetTangentX(idx) == threaded.GetTangentX(idx);
+	}
+	Context.Check(bSame, "the thread count does not change the result");
+}
+
+void RunTimeSteps(OCheckContext& Context)
+{
+	// A time step exact in binary keeps the accumulator exact
+	constexpr float step = 0.25f;
+	OWaves waves(16, 16, SpatialStep, step, Speed, Damping);
+	OWaves other(16, 16, SpatialStep, step, Speed, Damping);
+	waves.MaxSubsteps = 4;
+
+	waves.Update(step * 3.5f);
+	Context.Check(waves.GetStats().NumSteps == 3 && waves.GetStats().NumDroppedSteps == 0, "three and a half steps step three times");
+	waves.Update(step * 0.5f);
+	Context.Check(waves.GetStats().NumSteps == 1, "the remainder is carried to the next update");
+	waves.Update(step * 0.5f);
+	Context.Check(waves.GetStats().NumSteps == 0, "half a step does not step");
+
+	// The half step left in the first instance is not seen by the second
+	other.Update(step * 0.5f);
+	Context.Check(other.GetStats().NumSteps == 0, "instances keep their own time");
+
+	waves.Update(step * 100.0f);
+	Context.Check(waves.GetStats().NumSteps == 4 && waves.GetStats().NumDroppedSteps == 96, "substeps of a long frame are bounded");
+	waves.Update(step * 0.25f);
+	Context.Check(waves.GetStats().NumSteps == 0, "dropped time is not carried to the next update");
+}
+
+template<typename TStep>
+double MillisecondsPerStep(uint32_t Steps, const TStep& Step)
+{
+	Step();
+	return MeasureNanoseconds(Steps, Step) / 1.0e6;
+}
+
+void RunBenchmark(uint32_t MaxSize, uint32_t Steps, uint32_t Threads)
+{
+	const uint32_t threads = Threads > 0 ? Threads : std::max(std::thread::hardware_concurrency(), 1u);
+	std::printf("Milliseconds per step with normals, %u threads:\n", threads);
+	std::printf("  %-12s %12s %12s %12s %10s\n", "Grid", "Scalar AoS", "SoA 1 thread", "SoA threads", "Speedup");
+	for (uint32_t size = 256; size <= MaxSize; size *= 2)
+	{
+		const auto side = static_cast<int32_t>(size);
+		OReferenceWaves reference(side, side, SpatialStep, TimeStep, Speed, Damping);
+		OWaves single(side, side, SpatialStep, TimeStep, Speed, Damping);
+		OWaves threaded(side, side, SpatialStep, TimeStep, Speed, Damping);
+		single.NumThreads = 1;
+		threaded.NumThreads = threads;
+		reference.Disturb(side / 2, side / 2, 1.0f);
+		single.Disturb(side / 2, side / 2, 1.0f);
+		threaded.Disturb(side / 2, side / 2, 1.0f);
+
+		const double referenceMs = MillisecondsPerStep(Steps, [&]() { reference.Step(); });
+		const double singleMs = MillisecondsPerStep(Steps, [&]() { single.Update(TimeStep); });
+		const double threadedMs = MillisecondsPerStep(Steps, [&]() { threaded.Update(TimeStep); });
+		const std::string grid = std::to_string(size) + "x" + std::to_string(size);
+		std::printf("  %-12s %12.3f %12.3f %12.3f %9.1fx\n", grid.c_str(), referenceMs, singleMs, threadedMs, referenceMs / threadedMs);
+	}
+}
+} // namespace
+
+CHECK_SUITE(WaveSolver,
+            "Wave solver against the scalar solver it replaced, thread determinism and fixed time steps, step time up to 2048x2048",
+            "--max-size <n> (default 2048) --steps <n> (20) --threads <n> (0 - all)")
+{
+	RunRegression(Context);
+	RunThreadDeterminism(Context);
+	RunTimeSteps(Context);
+	if (Context.IsBenchmarking())
+	{
+		RunBenchmark(static_cast<uint32_t>(Context.GetUInt("max-size", 2048)),
+		             static_cast<uint32_t>(std::max<uint64_t>(Context.GetUInt("steps", 20), 1)),
+		             static_cast<uint32_t>(Context.GetUInt("threads", 0)));
+	}
+}
@@ -0,0 +1,114 @@
+#include "CheckRegistry.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+void PrintUsage()
+{
+	std::printf("Usage: EngineChecks [suite...] [options]\n"
+	            "  Runs the named suites, all of them when none is named. Options go after the suite names.\n"
+	            "  --list          Lists the suites and the options they read\n"
+	            "  --checks-only   Skips the timings\n"
+	            "  --<name> [v]    Option read by the selected suites\n");
+}
+
+void PrintSuites()
+{
+	for (const auto& suite : OCheckRegistry::GetSuites())
+	{
+		std::printf("%-24s %s\n", suite.Name, suite.Description);
+		if (suite.Options && *suite.Options)
+		{
+			std::printf("%-24s %s\n", "", suite.Options);
+		}
+	}
+}
+} // namespace
+
+int main(int Argc, char** Argv)
+{
+	std::vector<std::string> names;
+	std::unordered_map<std::string, std::string> options;
+	bool bBenchmarking = true;
+	for (int i = 1; i < Argc; i++)
+	{
+		const std::string arg = Argv[i];
+		if (arg == "--help" || arg == "-h")
+		{
+			PrintUsage();
+			return EXIT_SUCCESS;
+		}
+		if (arg == "--list")
+		{
+			PrintSuites();
+			return EXIT_SUCCESS;
+		}
+		if (arg == "--checks-only")
+		{
+			bBenchmarking = false;
+		}
+		else if (arg.starts_with("--"))
+		{
+			// Flags have no value, the next argument is a value unless it is an option itself
+			const bool bHasValue = i + 1 < Argc && !std::string(Argv[i + 1]).starts_with("--");
+			options[arg.substr(2)] = bHasValue ? Argv[++i] : "";
+		}
+		else if (options.empty())
+		{
+			names.push_back(arg);
+		}
+		else
+		{
+			PrintUsage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	const auto& suites = OCheckRegistry::GetSuites();
+	for (const auto& name : names)
+	{
+		if (std::ranges::none_of(suites, [&](const SCheckSuite& Suite) { return name == Suite.Name; }))
+		{
+			std::printf("Unknown suite %s\n", name.c_str());
+			PrintSuites();
+			return EXIT_FAILURE;
+		}
+	}
+
+	uint32_t numSuites = 0;
+	uint32_t numChecks = 0;
+	std::vector<std::string> failedSuites;
+	for (const auto& suite : suites)
+	{
+		if (!names.empty() && std::ranges::find(names, suite.Name) == names.end())
+		{
+			continue;
+		}
+		std::printf("== %s\n", suite.Name);
+		std::fflush(stdout);
+
+		OCheckContext context(options, bBenchmarking);
+		suite.Run(context);
+		numSuites++;
+		numChecks += context.GetNumChecks();
+		if (context.GetNumFailures() > 0)
+		{
+			std::printf("%s: %u of %u checks failed\n", suite.Name, context.GetNumFailures(), context.GetNumChecks());
+			failedSuites.push_back(suite.Name);
+		}
+		std::printf("\n");
+	}
+
+	std::printf("%u suites, %u checks, %zu suites failed\n", numSuites, numChecks, failedSuites.size());
+	for (const auto& name : failedSuites)
+	{
+		std::printf("  %s\n", name.c_str());
+	}
+	return failedSuites.empty() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,765 @@
+#include "FrameProfiler.h"
+#include "JsonDocument.h"
+#include "LightCulling/ClusteredLightBinner.h"
+#include "LightCulling/LightSlots.h"
+#include "OcclusionCulling/SoftwareOcclusion.h"
+#include "Replay/ReplayLog.h"
+#include "SceneGraph/TransformHierarchy.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * Times the engine units without D3D dependencies on a synthetic scene, frame after frame as OEngine::OnUpdate calls them:
+ * the transform hierarchy, the light buffer slots, the software occlusion culler and the clustered light binner. The
+ * engine itself does not run, its update and render graph are built on the D3D12 device and a Win32 window, so there
+ * are no frustum culling, buffer upload or draw stages and the timings are not engine frame times. The render graph is
+ * read from the engine config with OJsonDocument, the lights are binned when it has a light culling node. Like the engine
+ * the lists are kept current while the node is disabled, it can be enabled from the UI.
+ * The measured frames can be captured to a replay log and driven by one, the camera and the material edits of a frame
+ * come from the log as in the engine, per frame timings are written in the same CSV layout as an engine replay.
+ */
+
+namespace
+{
+// Mirror of the material record the engine captures, only its size matters
+struct SMaterialRecord
+{
+	float Albedo[20];
+	float MatTransform[16];
+	uint32_t Textures[12];
+};
+
+enum class ELayer : uint8_t
+{
+	Opaque,
+	AlphaTested,
+	Transparent
+};
+
+struct SInstance
+{
+	uint32_t Node = OTransformHierarchy::InvalidNode;
+	float Phase = 0.0f;
+	bool bDynamic = false;
+};
+
+struct SItem
+{
+	ELayer Layer = ELayer::Opaque;
+	float Center[3] = {};
+	float Extents[3] = {};
+	std::vector<SInstance> Instances;
+};
+
+struct SLight
+{
+	uint32_t Node = OTransformHierarchy::InvalidNode;
+	uint32_t Id = 0;
+	float Radius = 10.0f;
+	float Phase = 0.0f;
+	bool bDynamic = false;
+};
+
+struct SNode
+{
+	std::string Name;
+	std::string PSO;
+	std::string NextNode;
+	bool bEnabled = true;
+	bool bDebugDrawOnly = false;
+};
+
+struct SSettings
+{
+	uint32_t NumFrames = 200;
+	uint32_t NumWarmupFrames = 20;
+	uint32_t NumItems = 200;
+	uint32_t NumInstances = 50;
+	uint32_t NumLights = 256;
+	uint32_t NumMaterials = 64;
+	float DynamicFraction = 0.1f;
+	bool bOcclusion = true;
+	uint32_t Seed = 1;
+	std::string GraphPath = "Resources/Config/RenderGraphConfig.json";
+	std::string CsvPath;
+	std::string TracePath;
+	std::string CapturePath;
+	std::string ReplayPath;
+	std::string FrameCsvPath;
+};
+
+// What drives a frame, made up from the frame index or read from a replay log
+struct SFrameInput
+{
+	float Time = 0.0f;
+	SReplayCamera Camera;
+
+	// None when past the materials
+	uint32_t EditedMaterial = UINT32_MAX;
+};
+
+void PrintUsage()
+{
+	std::printf("Usage: HeadlessFrameBenchmark [options]\n"
+	            "  Times the engine units without D3D dependencies on a synthetic scene\n"
+	            "  --frames <n>      Measured frames (default 200)\n"
+	            "  --items <n>       Render items (default 200)\n"
+	            "  --instances <n>   Instances per item (default 50)\n"
+	            "  --lights <n>      Point lights (default 256)\n"
+	            "  --materials <n>   Materials edited in turn by the frames (default 64)\n"
+	            "  --dynamic <f>     Fraction of instances and lights moving every frame (default 0.1)\n"
+	            "  --no-occlusion    Disable the software occlusion culling\n"
+	            "  --seed <n>        Scene seed (default 1)\n"
+	            "  --graph <path>    Render graph config (default Resources/Config/RenderGraphConfig.json)\n"
+	            "  --csv <path>      Append the stage timings to a CSV file\n"
+	            "  --trace <path>    Write the Chrome trace of the last frames\n"
+	            "  --capture <path>  Write the measured frames to a replay log\n"
+	            "  --replay <path>   Measure the frames of a replay log instead of --frames\n"
+	            "  --frame-csv <path> Write the timings of every measured frame to a CSV file\n");
+}
+
+SOcclusionMatrix Multiply(const SOcclusionMatrix& A, const SOcclusionMatrix& B)
+{
+	SOcclusionMatrix result;
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			for (int k = 0; k < 4; k++)
+			{
+				result.M[i][j] += A.M[i][k] * B.M[k][j];
+			}
+		}
+	}
+	return result;
+}
+
+SOcclusionMatrix ToOcclusionMatrix(const STransformMatrix& Matrix)
+{
+	SOcclusionMatrix result;
+	static_assert(sizeof(result.M) == sizeof(Matrix.M));
+	std::memcpy(result.M, Matrix.M, sizeof(result.M));
+	return result;
+}
+
+// Left handed look along +z from Eye rotated by Yaw
+SOcclusionMatrix BuildView(const float Eye[3], float Yaw)
+{
+	const float s = std::sin(Yaw);
+	const float c = std::cos(Yaw);
+	SOcclusionMatrix view;
+	view.M[0][0] = c;
+	view.M[0][2] = s;
+	view.M[1][1] = 1.0f;
+	view.M[2][0] = -s;
+	view.M[2][2] = c;
+	view.M[3][0] = -(Eye[0] * c - Eye[2] * s);
+	view.M[3][1] = -Eye[1];
+	view.M[3][2] = -(Eye[0] * s + Eye[2] * c);
+	view.M[3][3] = 1.0f;
+	return view;
+}
+
+// As XMMatrixPerspectiveFovLH
+SOcclusionMatrix BuildProj(float FovY, float Aspect, float NearZ, float FarZ)
+{
+	const float height = 1.0f / std::tan(0.5f * FovY);
+	SOcclusionMatrix proj;
+	proj.M[0][0] = height / Aspect;
+	proj.M[1][1] = height;
+	proj.M[2][2] = FarZ / (FarZ - NearZ);
+	proj.M[2][3] = 1.0f;
+	proj.M[3][2] = -NearZ * FarZ / (FarZ - NearZ);
+	return proj;
+}
+void TransformPoint(const float Point[3], const float M[4][4], float Out[3])
+{
+	for (int i = 0; i < 3; i++)
+	{
+		Out[i] = Point[0] * M[0][i] + Point[1] * M[1][i] + Point[2] * M[2][i] + M[3][i];
+	}
+}
+
+// Box around the origin the size of the bounds, outward faces are clockwise
+void BuildBox(const SItem& Item, std::vector<float>& OutPositions, std::vector<uint32_t>& OutIndices)
+{
+	OutPositions.clear();
+	for (int i = 0; i < 8; i++)
+	{
+		OutPositions.push_back(Item.Center[0] + (i & 1 ? Item.Extents[0] : -Item.Extents[0]));
+		OutPositions.push_back(Item.Center[1] + (i & 2 ? Item.Extents[1] : -Item.Extents[1]));
+		OutPositions.push_back(Item.Center[2] + (i & 4 ? Item.Extents[2] : -Item.Extents[2]));
+	}
+	OutIndices = { 0, 2, 3, 0, 3, 1, 4, 5, 7, 4, 7, 6, 0, 4, 6, 0, 6, 2, 1, 3, 7, 1, 7, 5, 0, 1, 5, 0, 5, 4, 2, 6, 7, 2, 7, 3 };
+}
+
+SLocalTransform MakeLocal(float X, float Y, float Z, float Yaw)
+{
+	SLocalTransform local;
+	local.Position[0] = X;
+	local.Position[1] = Y;
+	local.Position[2] = Z;
+	local.Rotation[1] = std::sin(0.5f * Yaw);
+	local.Rotation[3] = std::cos(0.5f * Yaw);
+	return local;
+}
+
+// Nodes in execution order, the debug draw nodes are dropped as ORenderGraphReader does in builds without debug draw
+bool LoadRenderGraph(const std::string& Path, std::vector<SNode>& OutNodes)
+{
+	OJsonDocument document;
+	if (!document.ParseFile(Path))
+	{
+		std::printf("Failed to read %s (%s)\n", Path.c_str(), document.GetError().c_str());
+		return false;
+	}
+
+	const auto graph = document.GetRoot().Find("RenderGraph");
+	const auto nodes = graph.Find("Nodes");
+	if (!nodes.IsArray())
+	{
+		std::printf("Failed to read %s (no RenderGraph.Nodes)\n", Path.c_str());
+		return false;
+	}
+
+	std::vector<SNode> all;
+	for (const auto node : nodes)
+	{
+		SNode info;
+		info.Name = node.GetOr("Name", "");
+		info.PSO = node.GetOr("PSO", "");
+		info.NextNode = node.GetOr("NextNode", "");
+		info.bEnabled = node.GetOr("Enabled", true);
+		info.bDebugDrawOnly = node.GetOr("DebugDrawOnly", false);
+		all.push_back(info);
+	}
+
+	// Execution order follows NextNode like ORenderGraph::Execute
+	OutNodes.clear();
+	std::string current = graph.GetOr("Head", "");
+	while (!current.empty() && OutNodes.size() < all.size())
+	{
+		const auto found = std::ranges::find(all, current, &SNode::Name);
+		if (found == all.end())
+		{
+			break;
+		}
+		if (!found->bDebugDrawOnly)
+		{
+			OutNodes.push_back(*found);
+		}
+		current = found->NextNode;
+	}
+	return true;
+}
+
+class OHeadlessFrame
+{
+public:
+	OHeadlessFrame(const SSettings& InSettings, bool bInBinLights)
+	    : Settings(InSettings), bBinLights(bInBinLights)
+	{
+		BuildScene();
+
+		SClusterGridParams grid;
+		grid.ProjScaleX = Proj.M[0][0];
+		grid.ProjScaleY = Proj.M[1][1];
+		grid.NearZ = NearZ;
+		grid.FarZ = FarZ;
+		Binner.SetGridParams(grid);
+	}
+
+	SFrameInput MakeInput(uint32_t Frame) const
+	{
+		SFrameInput input;
+		input.Time = static_cast<float>(Frame) / 60.0f;
+
+		// Look along +z rotated by the yaw, as BuildView
+		const float yaw = 0.3f * std::sin(input.Time * 0.5f);
+		std::copy(std::begin(Eye), std::end(Eye), input.Camera.Position);
+		input.Camera.Look[0] = std::sin(yaw);
+		input.Camera.Look[2] = std::cos(yaw);
+		input.Camera.Right[0] = std::cos(yaw);
+		input.Camera.Right[2] = -std::sin(yaw);
+		input.Camera.Up[1] = 1.0f;
+
+		// One material changes every frame, as when editing in the UI
+		if (Settings.NumMaterials > 0)
+		{
+			input.EditedMaterial = Frame % Settings.NumMaterials;
+		}
+		return input;
+	}
+
+	SReplayFrameTiming RunFrame(const SFrameInput& Input)
+	{
+		using SClock = std::chrono::steady_clock;
+		const auto start = SClock::now();
+		Time = Input.Time;
+		OnUpdate(Input);
+		OFrameProfiler::Get().EndFrame();
+		const auto end = SClock::now();
+
+		SReplayFrameTiming timing;
+		timing.FrameMs = std::chrono::duration<double, std::milli>(end - start).count();
+		timing.UpdateMs = timing.FrameMs;
+		timing.Instances = NumFrameVisibleInstances;
+		return timing;
+	}
+
+	uint64_t GetNumVisibleInstances() const { return NumVisibleInstances; }
+	const OSoftwareOcclusionCuller& GetOcclusionCuller() const { return OcclusionCuller; }
+	const OClusteredLightBinner& GetBinner() const { return Binner; }
+
+private:
+	void BuildScene()
+	{
+		std::mt19937 random(Settings.Seed);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		const float side = std::sqrt(static_cast<float>(std::max(Settings.NumItems * Settings.NumInstances, 1u))) * 6.0f;
+
+		Items.resize(Settings.NumItems);
+		for (auto& item : Items)
+		{
+			const float layer = unit(random);
+			item.Layer = layer < 0.75f ? ELayer::Opaque : layer < 0.9f ? ELayer::AlphaTested : ELayer::Transparent;
+
+			// A few large buildings to occlude the rest
+			const bool bBuilding = item.Layer == ELayer::Opaque && unit(random) < 0.02f;
+			item.Extents[0] = bBuilding ? 5.0f + 10.0f * unit(random) : 0.5f + 2.5f * unit(random);
+			item.Extents[1] = bBuilding ? 10.0f + 20.0f * unit(random) : 0.5f + 2.5f * unit(random);
+			item.Extents[2] = bBuilding ? 5.0f + 10.0f * unit(random) : 0.5f + 2.5f * unit(random);
+			item.Center[1] = item.Extents[1];
+
+			item.Instances.resize(Settings.NumInstances);
+			for (auto& instance : item.Instances)
+			{
+				instance.bDynamic = unit(random) < Settings.DynamicFraction;
+				instance.Phase = 6.2831853f * unit(random);
+				instance.Node = Hierarchy.Add(OTransformHierarchy::InvalidNode, MakeLocal((unit(random) - 0.5f) * side, 0.0f, unit(random) * side, instance.Phase));
+			}
+		}
+
+		Lights.resize(Settings.NumLights);
+		for (uint32_t i = 0; i < Lights.size(); i++)
+		{
+			auto& light = Lights[i];
+			light.Id = i;
+			light.bDynamic = unit(random) < Settings.DynamicFraction;
+			light.Phase = 6.2831853f * unit(random);
+			light.Radius = 5.0f + 15.0f * unit(random);
+			light.Node = Hierarchy.Add(OTransformHierarchy::InvalidNode, MakeLocal((unit(random) - 0.5f) * side, 2.0f + 8.0f * unit(random), unit(random) * side, 0.0f));
+		}
+
+		Eye[0] = 0.0f;
+		Eye[1] = 15.0f;
+		Eye[2] = -60.0f;
+		Proj = BuildProj(0.25f * 3.14159265f, 16.0f / 9.0f, NearZ, FarZ);
+	}
+
+	void OnUpdate(const SFrameInput& Input)
+	{
+		SProfileScope scope("OnUpdate");
+		UpdateTransforms();
+		UpdateLightSlots();
+
+		View = BuildView(Input.Camera.Position, std::atan2(Input.Camera.Look[0], Input.Camera.Look[2]));
+		ViewProj = Multiply(View, Proj);
+		UpdateOcclusionCulling();
+		TestOcclusion();
+		if (bBinLights)
+		{
+			UpdateClusteredLighting();
+		}
+	}
+
+	void UpdateTransforms()
+	{
+		SProfileScope scope("UpdateTransforms");
+		for (const auto& item : Items)
+		{
+			for (const auto& instance : item.Instances)
+			{
+				if (instance.bDynamic)
+				{
+					auto local = Hierarchy.GetLocal(instance.Node);
+					local.Position[1] = std::sin(Time + instance.Phase);
+					Hierarchy.SetLocal(instance.Node, local);
+				}
+			}
+		}
+		for (const auto& light : Lights)
+		{
+			if (light.bDynamic)
+			{
+				auto local = Hierarchy.GetLocal(light.Node);
+				local.Position[0] += 0.1f * std::cos(Time + light.Phase);
+				Hierarchy.SetLocal(light.Node, local);
+			}
+		}
+		Hierarchy.Update();
+	}
+
+	// All lights are point lights
+	void UpdateLightSlots()
+	{
+		SProfileScope scope("UpdateLightSlots");
+		LightSlotKeys.clear();
+		for (const auto& light : Lights)
+		{
+			LightSlotKeys.push_back({ 0, light.Id });
+		}
+		LightSlots.Assign(LightSlotKeys);
+	}
+
+	void UpdateOcclusionCulling()
+	{
+		SProfileScope scope("UpdateOcclusionCulling");
+		OcclusionCuller.Clear();
+		if (!Settings.bOcclusion)
+		{
+			return;
+		}
+
+		struct SCandidate
+		{
+			const SItem* Item;
+			SOcclusionMatrix LocalToClip;
+			float Area;
+		};
+		std::vector<SCandidate> candidates;
+		const auto& params = OcclusionCuller.GetParams();
+		for (const auto& item : Items)
+		{
+			if (item.Layer != ELayer::Opaque)
+			{
+				continue;
+			}
+			for (const auto& instance : item.Instances)
+			{
+				const auto localToClip = Multiply(ToOcclusionMatrix(Hierarchy.GetWorld(instance.Node)), ViewProj);
+				const float area = OcclusionCuller.GetScreenArea(localToClip, item.Center, item.Extents);
+				if (area >= params.MinOccluderArea)
+				{
+					candidates.push_back({ &item, localToClip, area });
+				}
+			}
+		}
+		std::ranges::sort(candidates, std::greater{}, &SCandidate::Area);
+
+		std::vector<float> positions;
+		std::vector<uint32_t> indices;
+		for (size_t i = 0; i < candidates.size() && i < params.MaxOccluders; i++)
+		{
+			BuildBox(*candidates[i].Item, positions, indices);
+			OcclusionCuller.RasterizeOccluder(candidates[i].LocalToClip, positions.data(), 8, indices.data(), static_cast<uint32_t>(indices.size()));
+		}
+		OcclusionCuller.Finalize();
+	}
+
+	// Every instance is tested, the culler leaves the ones outside of the screen to the frustum culling
+	void TestOcclusion()
+	{
+		SProfileScope scope("TestOcclusion");
+		NumFrameVisibleInstances = 0;
+		for (const auto& item : Items)
+		{
+			for (const auto& instance : item.Instances)
+			{
+				const auto localToClip = Multiply(ToOcclusionMatrix(Hierarchy.GetWorld(instance.Node)), ViewProj);
+				NumFrameVisibleInstances += OcclusionCuller.IsVisible(localToClip, item.Center, item.Extents);
+			}
+		}
+		NumVisibleInstances += NumFrameVisibleInstances;
+	}
+
+	// The index list refers to the light buffer slots as in OClusteredLighting::Update
+	void UpdateClusteredLighting()
+	{
+		SProfileScope scope("UpdateClusteredLighting");
+		ClusterLights.clear();
+		for (uint32_t i = 0; i < Lights.size(); i++)
+		{
+			const auto& world = Hierarchy.GetWorld(Lights[i].Node);
+			auto& light = ClusterLights.emplace_back();
+			TransformPoint(world.M[3], View.M, light.Position);
+			light.Radius = Lights[i].Radius;
+			light.Index = LightSlots.GetSlot(i);
+		}
+		Binner.Bin(ClusterLights);
+	}
+
+	SSettings Settings;
+	bool bBinLights = true;
+
+	std::vector<SItem> Items;
+	std::vector<SLight> Lights;
+	OTransformHierarchy Hierarchy;
+	OLightSlots LightSlots;
+	std::vector<SLightSlotKey> LightSlotKeys;
+	OSoftwareOcclusionCuller OcclusionCuller;
+	OClusteredLightBinner Binner;
+	std::vector<SClusterLight> ClusterLights;
+
+	uint64_t NumFrameVisibleInstances = 0;
+	uint64_t NumVisibleInstances = 0;
+
+	float Time = 0.0f;
+	float Eye[3] = {};
+	SOcclusionMatrix View;
+	SOcclusionMatrix Proj;
+	SOcclusionMatrix ViewProj;
+	static constexpr float NearZ = 0.1f;
+	static constexpr float FarZ = 2000.0f;
+};
+
+void CaptureFrame(OReplayWriter& Capture, const SFrameInput& Input, float DeltaTime)
+{
+	SProfileScope scope("CaptureFrame");
+	Capture.Add(EReplayEvent::Camera, Input.Camera);
+	if (Input.EditedMaterial != UINT32_MAX)
+	{
+		SMaterialRecord record = {};
+		record.Textures[0] = Input.EditedMaterial;
+		Capture.AddEdit(EReplayEvent::Material, std::to_string(Input.EditedMaterial), &record, sizeof(record));
+	}
+	Capture.CommitFrame(DeltaTime);
+}
+
+// The records of the next frame of the log over the input of the previous one, edits of unknown materials are skipped
+bool ReplayFrame(OReplayReader& Replay, SFrameInput& InOutInput, float& OutDeltaTime)
+{
+	SProfileScope scope("ReplayFrame");
+	SReplayFrame replayFrame;
+	std::vector<SReplayRecord> records;
+	if (!Replay.NextFrame(replayFrame, records))
+	{
+		return false;
+	}
+
+	OutDeltaTime = replayFrame.DeltaTime;
+	InOutInput.EditedMaterial = UINT32_MAX;
+	for (const auto& record : records)
+	{
+		std::string name;
+		const uint8_t* state = nullptr;
+		uint32_t size = 0;
+		if (record.Type == EReplayEvent::Camera)
+		{
+			record.Read(InOutInput.Camera);
+		}
+		else if (record.Type == EReplayEvent::Material && record.ReadEdit(name, state, size))
+		{
+			char* end = nullptr;
+			const auto index = std::strtoul(name.c_str(), &end, 10);
+			if (end != name.c_str() && *end == '\0')
+			{
+				InOutInput.EditedMaterial = static_cast<uint32_t>(index);
+			}
+		}
+	}
+	return true;
+}
+} // namespace
+
+int main(int Argc, char** Argv)
+{
+	SSettings settings;
+	for (int i = 1; i < Argc; i++)
+	{
+		const std::string arg = Argv[i];
+		const bool bHasValue = i + 1 < Argc;
+		if (arg == "--frames" && bHasValue)
+		{
+			settings.NumFrames = std::max(static_cast<uint32_t>(std::strtoul(Argv[++i], nullptr, 10)), 1u);
+		}
+		else if (arg == "--items" && bHasValue)
+		{
+			settings.NumItems = static_cast<uint32_t>(std::strtoul(Argv[++i], nullptr, 10));
+		}
+		else if (arg == "--instances" && bHasValue)
+		{
+			settings.NumInstances = static_cast<uint32_t>(std::strtoul(Argv[++i], nullptr, 10));
+		}
+		else if (arg == "--lights" && bHasValue)
+		{
+			settings.NumLights = static_cast<uint32_t>(std::strtoul(Argv[++i], nullptr, 10));
+		}
+		else if (arg == "--materials" && bHasValue)
+		{
+			settings.NumMaterials = static_cast<uint32_t>(std::strtoul(Argv[++i], nullptr, 10));
+		}
+		else if (arg == "--dynamic" && bHasValue)
+		{
+			settings.DynamicFraction = std::strtof(Argv[++i], nullptr);
+		}
+		else if (arg == "--no-occlusion")
+		{
+			settings.bOcclusion = false;
+		}
+		else if (arg == "--seed" && bHasValue)
+		{
+			settings.Seed = static_cast<uint32_t>(std::strtoul(Argv[++i], nullptr, 10));
+		}
+		else if (arg == "--graph" && bHasValue)
+		{
+			settings.GraphPath = Argv[++i];
+		}
+		else if (arg == "--csv" && bHasValue)
+		{
+			settings.CsvPath = Argv[++i];
+		}
+		else if (arg == "--trace" && bHasValue)
+		{
+			settings.TracePath = Argv[++i];
+		}
+		else if (arg == "--capture" && bHasValue)
+		{
+			settings.CapturePath = Argv[++i];
+		}
+		else if (arg == "--replay" && bHasValue)
+		{
+			settings.ReplayPath = Argv[++i];
+		}
+		else if (arg == "--frame-csv" && bHasValue)
+		{
+			settings.FrameCsvPath = Argv[++i];
+		}
+		else
+		{
+			PrintUsage();
+			return arg == "--help" || arg == "-h" ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	OReplayReader replay;
+	const bool bReplay = !settings.ReplayPath.empty();
+	if (bReplay)
+	{
+		if (!replay.Load(settings.ReplayPath) || replay.GetNumFrames() == 0)
+		{
+			std::printf("Failed to read %s\n", settings.ReplayPath.c_str());
+			return EXIT_FAILURE;
+		}
+		settings.NumFrames = replay.GetNumFrames();
+	}
+
+	std::vector<SNode> nodes;
+	if (!LoadRenderGraph(settings.GraphPath, nodes))
+	{
+		return EXIT_FAILURE;
+	}
+	const bool bBinLights = std::ranges::any_of(nodes, [](const SNode& Node) { return Node.PSO == "ClusteredLightCulling"; });
+	const auto numEnabled = std::ranges::count_if(nodes, &SNode::bEnabled);
+
+	OHeadlessFrame frame(settings, bBinLights);
+	for (uint32_t i = 0; i < settings.NumWarmupFrames; i++)
+	{
+		frame.RunFrame(frame.MakeInput(i));
+	}
+
+	auto& profiler = OFrameProfiler::Get();
+	profiler.HistoryFrames = settings.NumFrames;
+	profiler.SetEnabled(true);
+	const uint64_t visibleBefore = frame.GetNumVisibleInstances();
+	OReplayWriter capture;
+	std::vector<SReplayFrameTiming> timings;
+	// Replayed frames continue the time of the warmup frames as the captured ones did
+	SFrameInput replayInput = frame.MakeInput(settings.NumWarmupFrames);
+	for (uint32_t i = 0; i < settings.NumFrames; i++)
+	{
+		SFrameInput input = frame.MakeInput(settings.NumWarmupFrames + i);
+		float deltaTime = 1.0f / 60.0f;
+		if (bReplay)
+		{
+			ReplayFrame(replay, replayInput, deltaTime);
+			input = replayInput;
+			replayInput.Time += deltaTime;
+		}
+		if (!settings.CapturePath.empty())
+		{
+			CaptureFrame(capture, input, deltaTime);
+		}
+
+		auto timing = frame.RunFrame(input);
+		timing.Frame = i;
+		timings.push_back(timing);
+	}
+	profiler.SetEnabled(false);
+
+	std::printf("Engine units without D3D dependencies on a synthetic scene, not engine frame times\n");
+	std::printf("Scene: %u items x %u instances, %u lights, render graph of %zu nodes (%td enabled), light culling %s\n",
+	            settings.NumItems,
+	            settings.NumInstances,
+	            settings.NumLights,
+	            nodes.size(),
+	            numEnabled,
+	            bBinLights ? "on" : "off");
+	std::printf("%-28s %10s %10s %10s %10s\n", "Stage", "Avg ms", "Min ms", "P99 ms", "Calls");
+	const auto stats = profiler.GetStats();
+	for (const auto& stage : stats)
+	{
+		std::printf("%-28s %10.3f %10.3f %10.3f %10u\n", stage.Name.c_str(), stage.AvgMilliseconds, stage.MinMilliseconds, stage.P99Milliseconds, stage.NumCalls);
+	}
+
+	const auto& occlusion = frame.GetOcclusionCuller().GetStats();
+	std::printf("Per frame: %.0f instances not occluded\n", static_cast<double>(frame.GetNumVisibleInstances() - visibleBefore) / settings.NumFrames);
+	std::printf("Occlusion: %u occluders, %u of %u tested occluded\n", occlusion.NumOccluders, occlusion.NumOccluded, occlusion.NumTests);
+	if (bBinLights)
+	{
+		const auto& binning = frame.GetBinner().GetStats();
+		std::printf("Light binning: %u of %u lights visible, %u indices, %u in the fullest cluster\n",
+		            binning.NumVisibleLights,
+		            binning.NumLights,
+		            binning.NumLightIndices,
+		            binning.MaxLightsInCluster);
+	}
+
+	if (!settings.CsvPath.empty())
+	{
+		std::ifstream existing(settings.CsvPath);
+		const bool bWriteHeader = !existing.good() || existing.peek() == std::ifstream::traits_type::eof();
+		existing.close();
+
+		std::ofstream csv(settings.CsvPath, std::ios::app);
+		if (bWriteHeader)
+		{
+			csv << "items,instances,lights,stage,avg_ms,min_ms,p99_ms\n";
+		}
+		for (const auto& stage : stats)
+		{
+			csv << settings.NumItems << ',' << settings.NumInstances << ',' << settings.NumLights << ',' << stage.Name << ','
+			    << stage.AvgMilliseconds << ',' << stage.MinMilliseconds << ',' << stage.P99Milliseconds << '\n';
+		}
+		if (!csv)
+		{
+			std::printf("Failed to write %s\n", settings.CsvPath.c_str());
+			return EXIT_FAILURE;
+		}
+	}
+	if (!settings.CapturePath.empty() && !capture.Save(settings.CapturePath))
+	{
+		std::printf("Failed to write %s\n", settings.CapturePath.c_str());
+		return EXIT_FAILURE;
+	}
+	if (!settings.FrameCsvPath.empty() && !WriteReplayTimings(settings.FrameCsvPath, timings))
+	{
+		std::printf("Failed to write %s\n", settings.FrameCsvPath.c_str());
+		return EXIT_FAILURE;
+	}
+	if (!settings.TracePath.empty() && !profiler.WriteChromeTrace(settings.TracePath))
+	{
+		std::printf("Failed to write %s\n", settings.TracePath.c_str());
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,180 @@
+#define STB_IMAGE_IMPLEMENTATION
+
+#include "TextureCooker/TextureCooker.h"
+
+#include <STB/stb_image.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace
+{
+void PrintUsage()
+{
+	std::printf("Usage: TextureCooker <files or directories...> [options]\n"
+	            "  --out <dir>                    Cache directory (default Resources/Cooked)\n"
+	            "  --type <name>                  Diffuse, Normal, Height, Occlusion, Roughness, Alpha (default Diffuse)\n"
+	            "  --format <name>                RGBA8, BC1, BC3, BC4, BC5, BC7 (overrides the type default)\n"
+	            "  --filter <box|kaiser>          Mip filter (default kaiser)\n"
+	            "  --threads <n>                  Compression threads, 0 - all (default 0)\n"
+	            "  --linear                       Filter color data without the sRGB conversion\n"
+	            "  --normal                       Renormalize mips as a normal map\n"
+	            "  --no-mips                      Cook the top level only\n");
+}
+
+bool IsSourceImage(const std::filesystem::path& Path)
+{
+	auto extension = Path.extension().string();
+	std::ranges::transform(extension, extension.begin(), [](char C) { return static_cast<char>(std::tolower(C)); });
+	return extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".bmp" || extension == ".tga";
+}
+
+void CollectSources(const std::filesystem::path& Path, std::vector<std::filesystem::path>& OutSources)
+{
+	std::error_code error;
+	if (std::filesystem::is_directory(Path, error))
+	{
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(Path, error))
+		{
+			if (entry.is_regular_file() && IsSourceImage(entry.path()))
+			{
+				OutSources.push_back(entry.path());
+			}
+		}
+	}
+	else if (std::filesystem::is_regular_file(Path, error))
+	{
+		OutSources.push_back(Path);
+	}
+	else
+	{
+		std::fprintf(stderr, "Skipping %s: not found\n", Path.string().c_str());
+	}
+}
+} // namespace
+
+int main(int Argc, char** Argv)
+{
+	std::vector<std::filesystem::path> inputs;
+	std::filesystem::path output = "Resources/Cooked";
+	std::string type = "Diffuse";
+	std::optional<ECookedFormat> format;
+	std::optional<EMipFilter> filter;
+	std::optional<uint32_t> numThreads;
+	bool bLinear = false;
+	bool bNormal = false;
+	bool bNoMips = false;
+
+	for (int i = 1; i < Argc; i++)
+	{
+		const std::string arg = Argv[i];
+		const bool bHasValue = i + 1 < Argc;
+		if (arg == "--out" && bHasValue)
+		{
+			output = Argv[++i];
+		}
+		else if (arg == "--type" && bHasValue)
+		{
+			type = Argv[++i];
+		}
+		else if (arg == "--format" && bHasValue)
+		{
+			ECookedFormat parsed;
+			if (!ParseCookedFormat(Argv[++i], parsed))
+			{
+				std::fprintf(stderr, "Unknown format: %s\n", Argv[i]);
+				return EXIT_FAILURE;
+			}
+			format = parsed;
+		}
+		else if (arg == "--filter" && bHasValue)
+		{
+			const std::string value = Argv[++i];
+			if (value != "box" && value != "kaiser")
+			{
+				std::fprintf(stderr, "Unknown filter: %s\n", value.c_str());
+				return EXIT_FAILURE;
+			}
+			filter = value == "box" ? EMipFilter::Box : EMipFilter::Kaiser;
+		}
+		else if (arg == "--threads" && bHasValue)
+		{
+			numThreads = static_cast<uint32_t>(std::strtoul(Argv[++i], nullptr, 10));
+		}
+		else if (arg == "--linear")
+		{
+			bLinear = true;
+		}
+		else if (arg == "--normal")
+		{
+			bNormal = true;
+		}
+		else if (arg == "--no-mips")
+		{
+			bNoMips = true;
+		}
+		else if (arg == "--help" || arg == "-h" || arg.starts_with("--"))
+		{
+			PrintUsage();
+			return arg.starts_with("--") && arg != "--help" ? EXIT_FAILURE : EXIT_SUCCESS;
+		}
+		else
+		{
+			inputs.emplace_back(arg);
+		}
+	}
+
+	if (inputs.empty())
+	{
+		PrintUsage();
+		return EXIT_FAILURE;
+	}
+
+	auto settings = GetCookSettingsForType(type);
+	settings.Format = format.value_or(settings.Format);
+	settings.Filter = filter.value_or(settings.Filter);
+	settings.NumThreads = numThreads.value_or(settings.NumThreads);
+	settings.bSRGB = settings.bSRGB && !bLinear && !bNormal;
+	settings.bNormalMap = settings.bNormalMap || bNormal;
+	settings.bGenerateMips = !bNoMips;
+
+	std::vector<std::filesystem::path> sources;
+	for (const auto& input : inputs)
+	{
+		CollectSources(input, sources);
+	}
+
+	OTextureCooker cooker(output);
+	for (const auto& source : sources)
+	{
+		const auto before = cooker.GetStats();
+		const auto cooked = cooker.CookFile(source, settings);
+		const auto after = cooker.GetStats();
+		if (cooked.empty())
+		{
+			std::printf("FAILED  %s\n", source.string().c_str());
+		}
+		else
+		{
+			std::printf("%s  %s -> %s (%.1f ms)\n",
+			            after.NumCacheHits > before.NumCacheHits ? "CACHED" : "COOKED",
+			            source.string().c_str(),
+			            cooked.string().c_str(),
+			            after.Milliseconds - before.Milliseconds);
+		}
+	}
+
+	const auto stats = cooker.GetStats();
+	std::printf("\n%u cooked, %u cached, %u failed, %s: %.2f MB -> %.2f MB in %.1f ms\n",
+	            stats.NumCooked,
+	            stats.NumCacheHits,
+	            stats.NumFailed,
+	            ToString(settings.Format),
+	            stats.SourceBytes / (1024.0 * 1024.0),
+	            stats.CookedBytes / (1024.0 * 1024.0),
+	            stats.Milliseconds);
+	return stats.NumFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -3,8 +3,10 @@
 #include "Profiler.h"
 
 #include <Application.h>
+#include <Engine/Engine.h>
 #include <Shlwapi.h>
 #include <Windows.h>
+#include <shellapi.h>
 
 int CALLBACK wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR lpCmdLine, int nCmdShow)
 {
@@ -21,6 +23,47 @@ int CALLBACK wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR lpCmdL
 	const auto application = OApplication::Get();
 	application->InitApplication(hInstance);
 
+	// --capture <log>, --replay <log> [--replay-csv <csv>] [--replay-dt <seconds>]
+	int argc = 0;
+	if (LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc))
+	{
+		string capturePath;
+		string replayPath;
+		SReplaySettings replaySettings;
+		replaySettings.bQuitWhenDone = true;
+		for (int i = 1; i + 1 < argc; i++)
+		{
+			const wstring arg = argv[i];
+			if (arg == L"--capture")
+			{
+				capturePath = WStringToUTF8(argv[++i]);
+			}
+			else if (arg == L"--replay")
+			{
+				replayPath = WStringToUTF8(argv[++i]);
+			}
+			else if (arg == L"--replay-csv")
+			{
+				replaySettings.CsvPath = WStringToUTF8(argv[++i]);
+			}
+			else if (arg == L"--replay-dt")
+			{
+				replaySettings.FixedDeltaTime = std::wcstof(argv[++i], nullptr);
+			}
+		}
+		LocalFree(argv);
+
+		const auto replay = OEngine::Get()->GetSessionReplay();
+		if (!replayPath.empty())
+		{
+			replay->StartReplay(replayPath, replaySettings);
+		}
+		else if (!capturePath.empty())
+		{
+			replay->StartCapture(capturePath);
+		}
+	}
+
 	returnCode = application->Run();
 	application->Destory();
 	DUMP_PROFILE_TO_FILE(ProfilerResult.prof);